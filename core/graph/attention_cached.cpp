@@ -10,6 +10,8 @@
 #ifdef USE_CUSTOM_KERNELS
 #include "../kernels/primitives/attention_decode_primitive.h"
 #include "../kernels/primitives/attention_prefill_primitive.h"
+#include "../kernels/primitives/qkv_rope_store_primitive.h"
+#include "../kernels/primitives/rope_apply_primitive.h"
 #endif
 
 namespace mlxr {
@@ -23,7 +25,7 @@ CachedAttention::CachedAttention(int hidden_size, int num_heads,
                                  int num_kv_heads, int max_seq_len,
                                  int layer_idx,
                                  std::shared_ptr<runtime::kv::Pager> pager)
-    : attention_(hidden_size, num_heads, max_seq_len),
+    : attention_(hidden_size, num_heads, max_seq_len, num_kv_heads),
       hidden_size_(hidden_size),
       num_heads_(num_heads),
       num_kv_heads_(num_kv_heads),
@@ -56,16 +58,6 @@ Tensor CachedAttention::forward_prefill(const Tensor& x, int seq_id,
   int batch = x_shape[0];
   int seq_len = x_shape[1];
 
-  // Project to Q, K, V
-  auto q = attention_.q_proj().forward(x);
-  auto k = attention_.k_proj().forward(x);
-  auto v = attention_.v_proj().forward(x);
-
-  // Reshape to [batch, seq_len, num_heads, head_dim]
-  q = q.reshape({batch, seq_len, num_heads_, head_dim_});
-  k = k.reshape({batch, seq_len, num_kv_heads_, head_dim_});
-  v = v.reshape({batch, seq_len, num_kv_heads_, head_dim_});
-
 #ifdef USE_CUSTOM_KERNELS
   // Use custom Metal kernel for fused RoPE + attention + KV storage
   if (is_cache_enabled() && seq_id >= 0) {
@@ -81,16 +73,19 @@ Tensor CachedAttention::forward_prefill(const Tensor& x, int seq_id,
     pager_->allocate_blocks_for_sequence(seq_id, seq_len);
 
     // Get page table from sequence
-    const auto& page_table_vec = seq->page_table();
-    int max_blocks = page_table_vec.size();
+    int max_blocks = static_cast<int>(seq->page_table().size());
     int block_size = pager_->arena().config().block_size_tokens;
 
-    // Build page table array [batch, max_blocks]
-    auto page_table = pager_->build_page_table_array(seq_id, max_blocks);
+    // Build page table array [batch, max_blocks] of stack-local indices
+    // (table entries must index the stacked cache array below, not the
+    // global arena)
+    std::vector<int> block_ids;
+    auto page_table = pager_->build_batched_page_table_array(
+        {seq_id}, max_blocks, &block_ids);
 
     // ZERO-COPY: Get raw block arrays without slicing/stacking
-    auto k_block_arrays = pager_->arena().get_k_block_arrays(page_table_vec);
-    auto v_block_arrays = pager_->arena().get_v_block_arrays(page_table_vec);
+    auto k_block_arrays = pager_->arena().get_k_block_arrays(block_ids);
+    auto v_block_arrays = pager_->arena().get_v_block_arrays(block_ids);
 
     // Stack block arrays to create format: [pages, layers, block_size, heads,
     // dim] This creates a view that shares the original block buffers
@@ -105,24 +100,34 @@ Tensor CachedAttention::forward_prefill(const Tensor& x, int seq_id,
     // Get model config for num_layers
     int num_layers = pager_->arena().config().num_layers;
 
-    // Call fused Metal kernel with block format
-    // Input: x [batch, seq_len, hidden_size]
-    // Q, K, V: [batch, seq_len, num_heads/num_kv_heads, head_dim]
-    // RoPE tables: [max_seq_len, head_dim/2]
-    // Cache: [num_pages, num_layers, block_size, num_kv_heads, head_dim] (BLOCK
-    // FORMAT) Page table: [batch, max_blocks] NOTE: Kernel indexes with
-    // layer_idx and modifies blocks IN-PLACE, no write-back needed!
-    auto attn_output_arr = kernels::attention_prefill_fused(
-        x.array(), q.array(), k.array(), v.array(), rope_cos.array(),
+    // Front half: fused QKV GEMM + RoPE + KV block write in one kernel.
+    // The unrotated projections never touch device memory and K/V are
+    // streamed straight into the destination blocks
+    auto qkv = kernels::qkv_rope_store(
+        x.array(), attention_.q_proj().weight().array(),
+        attention_.k_proj().weight().array(),
+        attention_.v_proj().weight().array(), rope_cos.array(),
         rope_sin.array(),
         k_cache_arr,  // Modified in-place by kernel
         v_cache_arr,  // Modified in-place by kernel
         page_table.array(), num_heads_, num_kv_heads_, head_dim_, hidden_size_,
-        block_size, max_blocks,
-        num_layers,  // NEW: total layers in model
-        layer_idx_,  // NEW: current layer index
-        true,        // NEW: use_block_format=true
-        0            // position_offset
+        block_size, max_blocks, num_layers, layer_idx_,
+        true,  // use_block_format
+        0      // position_offset
+    );
+
+    // Back half: attention over the pre-rotated tensors. inputs_rotated
+    // tells the kernel to skip its own per-pair RoPE and cache stores
+    // (both already done by the front half)
+    auto attn_output_arr = kernels::attention_prefill_fused(
+        x.array(), qkv[0], qkv[1], qkv[2], rope_cos.array(), rope_sin.array(),
+        k_cache_arr, v_cache_arr, page_table.array(), num_heads_,
+        num_kv_heads_, head_dim_, hidden_size_, block_size, max_blocks,
+        num_layers,  // total layers in model
+        layer_idx_,  // current layer index
+        true,        // use_block_format
+        0,           // position_offset
+        true         // inputs_rotated
     );
 
     // No write-back needed! Metal kernel modifies block buffers in-place via
@@ -145,6 +150,17 @@ Tensor CachedAttention::forward_prefill(const Tensor& x, int seq_id,
   std::cout
       << "[AttentionCached] PREFILL: Using MLX fallback path (cache_enabled="
       << is_cache_enabled() << ", seq_id=" << seq_id << ")" << std::endl;
+
+  // Project to Q, K, V (the Metal path fuses these into qkv_rope_store)
+  auto q = attention_.q_proj().forward(x);
+  auto k = attention_.k_proj().forward(x);
+  auto v = attention_.v_proj().forward(x);
+
+  // Reshape to [batch, seq_len, num_heads, head_dim]
+  q = q.reshape({batch, seq_len, num_heads_, head_dim_});
+  k = k.reshape({batch, seq_len, num_kv_heads_, head_dim_});
+  v = v.reshape({batch, seq_len, num_kv_heads_, head_dim_});
+
   // Apply rotary embeddings
   auto [q_rot, k_rot] = attention_.rope().forward(q, k, 0);
 
@@ -218,6 +234,47 @@ Tensor CachedAttention::forward_prefill(const Tensor& x, int seq_id,
   return output;
 }
 
+Tensor CachedAttention::forward_prefill_packed(
+    const Tensor& x, const std::vector<int>& seq_ids,
+    const std::vector<int>& cu_seqlens) {
+  int batch = static_cast<int>(seq_ids.size());
+  auto x_shape = x.shape();
+
+  if (x_shape[0] != 1) {
+    throw std::invalid_argument(
+        "Packed prefill expects [1, total_tokens, hidden_size]");
+  }
+  if (static_cast<int>(cu_seqlens.size()) != batch + 1 ||
+      cu_seqlens.front() != 0 || cu_seqlens.back() != x_shape[1]) {
+    throw std::invalid_argument(
+        "cu_seqlens must cover the packed token stream");
+  }
+
+  if (batch == 1) {
+    return forward_prefill(x, seq_ids[0], nullptr);
+  }
+
+  // Per-segment attention over contiguous slices of the packed stream.
+  // Each segment reuses the single-sequence prefill (including the
+  // fused Metal path) at exactly its own length — the ragged layout
+  // means a 4K prompt and an 80-token prompt in the same batch each
+  // cost only their own tokens
+  std::vector<Tensor> segment_outputs;
+  segment_outputs.reserve(batch);
+
+  for (int b = 0; b < batch; ++b) {
+    int start = cu_seqlens[b];
+    int len = cu_seqlens[b + 1] - start;
+    auto segment = Tensor(mlx::core::slice(x.array(), {0, start, 0},
+                                           {1, start + len, x_shape[2]},
+                                           {1, 1, 1}));
+    segment_outputs.push_back(forward_prefill(segment, seq_ids[b], nullptr));
+  }
+
+  // Stitch segments back into the packed stream
+  return concatenate(segment_outputs, 1);
+}
+
 Tensor CachedAttention::forward_decode(const Tensor& x, int seq_id, int pos) {
   auto x_shape = x.shape();
   int batch = x_shape[0];
@@ -232,15 +289,27 @@ Tensor CachedAttention::forward_decode(const Tensor& x, int seq_id, int pos) {
   k_cur = k_cur.reshape({batch, 1, num_kv_heads_, head_dim_});
   v_cur = v_cur.reshape({batch, 1, num_kv_heads_, head_dim_});
 
-  // Apply rotary embeddings with position offset
-  auto [q_rot, k_rot] = attention_.rope().forward(q, k_cur, pos);
-
 #ifdef USE_CUSTOM_KERNELS
   // Use custom Metal kernel for fused paged KV access + attention
   if (is_cache_enabled() && seq_id >= 0) {
     std::cout << "[AttentionCached] DECODE: Using Metal kernel path for layer "
               << layer_idx_ << ", pos=" << pos << std::endl;
 
+    // Rotate with the standalone RoPE kernel against the shared
+    // precomputed tables. This is the same adjacent-pair rotation (and
+    // the same tables) the fused prefill kernel applied when it filled
+    // this sequence's cache, so prefill- and decode-written K entries
+    // stay in one consistent layout
+    const auto& rope_cos = attention_.rope().cos_table();
+    const auto& rope_sin = attention_.rope().sin_table();
+    std::vector<int> pos_data(batch, pos);
+    auto positions_arr =
+        mlx::core::array(pos_data.data(), {batch, 1}, mlx::core::int32);
+    auto q_rot = Tensor(kernels::rope_apply(q.array(), rope_cos.array(),
+                                            rope_sin.array(), positions_arr));
+    auto k_rot = Tensor(kernels::rope_apply(k_cur.array(), rope_cos.array(),
+                                            rope_sin.array(), positions_arr));
+
     // Store current K, V in cache first
     store_kv(k_rot, v_cur, seq_id, pos);
 
@@ -250,16 +319,19 @@ Tensor CachedAttention::forward_decode(const Tensor& x, int seq_id, int pos) {
     }
 
     // Get page table from sequence
-    const auto& page_table_vec = seq->page_table();
-    int max_blocks = page_table_vec.size();
+    int max_blocks = static_cast<int>(seq->page_table().size());
     int block_size = pager_->arena().config().block_size_tokens;
 
-    // Build page table array [batch, max_blocks]
-    auto page_table = pager_->build_page_table_array(seq_id, max_blocks);
+    // Build page table array [batch, max_blocks] of stack-local indices
+    // (table entries must index the stacked cache array below, not the
+    // global arena)
+    std::vector<int> block_ids;
+    auto page_table = pager_->build_batched_page_table_array(
+        {seq_id}, max_blocks, &block_ids);
 
     // ZERO-COPY: Get raw block arrays without slicing/stacking
-    auto k_block_arrays = pager_->arena().get_k_block_arrays(page_table_vec);
-    auto v_block_arrays = pager_->arena().get_v_block_arrays(page_table_vec);
+    auto k_block_arrays = pager_->arena().get_k_block_arrays(block_ids);
+    auto v_block_arrays = pager_->arena().get_v_block_arrays(block_ids);
 
     // Stack block arrays to create format: [pages, layers, block_size, heads,
     // dim] This creates a view that shares the original block buffers
@@ -313,6 +385,10 @@ Tensor CachedAttention::forward_decode(const Tensor& x, int seq_id, int pos) {
   std::cout
       << "[AttentionCached] DECODE: Using MLX fallback path (cache_enabled="
       << is_cache_enabled() << ", seq_id=" << seq_id << ")" << std::endl;
+
+  // Apply rotary embeddings with position offset
+  auto [q_rot, k_rot] = attention_.rope().forward(q, k_cur, pos);
+
   // Load cached K, V if available
   Tensor k_full, v_full;
 
@@ -386,6 +462,260 @@ Tensor CachedAttention::forward_decode(const Tensor& x, int seq_id, int pos) {
   return output;
 }
 
+Tensor CachedAttention::forward_decode_batch(
+    const Tensor& x, const std::vector<int>& seq_ids,
+    const std::vector<int>& positions,
+    const runtime::kv::BatchDecodePlan* plan) {
+  auto x_shape = x.shape();
+  int batch = x_shape[0];
+
+  if (static_cast<int>(seq_ids.size()) != batch ||
+      static_cast<int>(positions.size()) != batch) {
+    throw std::invalid_argument(
+        "seq_ids/positions size must match batch dimension");
+  }
+
+  // Single-sequence batches take the existing decode path (which can use
+  // the fused Metal kernel when available) - unless a recorded plan is
+  // supplied, in which case the packed path below replays it for free
+  if (batch == 1 && plan == nullptr) {
+    return forward_decode(x, seq_ids[0], positions[0]);
+  }
+
+  // Project to Q, K, V for all sequences in ONE batched matmul each
+  auto q = attention_.q_proj().forward(x);
+  auto k_cur = attention_.k_proj().forward(x);
+  auto v_cur = attention_.v_proj().forward(x);
+
+  // Reshape to [batch, 1, num_heads, head_dim]
+  q = q.reshape({batch, 1, num_heads_, head_dim_});
+  k_cur = k_cur.reshape({batch, 1, num_kv_heads_, head_dim_});
+  v_cur = v_cur.reshape({batch, 1, num_kv_heads_, head_dim_});
+
+#ifdef USE_CUSTOM_KERNELS
+  // Single-dispatch fused path: every sequence's page table is packed
+  // into one [batch, max_blocks] buffer and the kernel processes the
+  // whole batch in one grid (one threadgroup per query head), so the
+  // encoder overhead is paid once instead of once per sequence and
+  // threadgroups load-balance across different context lengths
+  bool all_cached = is_cache_enabled();
+  for (int b = 0; all_cached && b < batch; ++b) {
+    all_cached = seq_ids[b] >= 0;
+  }
+  if (all_cached) {
+    // One RoPE dispatch for the whole batch: the kernel's per-token
+    // position buffer carries each sequence's own position, and the
+    // shared precomputed tables cover every row. Only the KV store
+    // remains per row (each sequence writes into its own page table)
+    const auto& rope_cos = attention_.rope().cos_table();
+    const auto& rope_sin = attention_.rope().sin_table();
+    auto positions_arr =
+        mlx::core::array(positions.data(), {batch, 1}, mlx::core::int32);
+    auto q_rot = Tensor(kernels::rope_apply(q.array(), rope_cos.array(),
+                                            rope_sin.array(), positions_arr));
+    auto k_rot = Tensor(kernels::rope_apply(k_cur.array(), rope_cos.array(),
+                                            rope_sin.array(), positions_arr));
+
+    auto k_shape4 = k_cur.shape();
+    for (int b = 0; b < batch; ++b) {
+      auto k_row = Tensor(mlx::core::slice(k_rot.array(), {b, 0, 0, 0},
+                                           {b + 1, 1, k_shape4[2], k_shape4[3]},
+                                           {1, 1, 1, 1}));
+      auto v_row = Tensor(mlx::core::slice(v_cur.array(), {b, 0, 0, 0},
+                                           {b + 1, 1, k_shape4[2], k_shape4[3]},
+                                           {1, 1, 1, 1}));
+      store_kv(k_row, v_row, seq_ids[b], positions[b]);
+    }
+
+    int block_size = pager_->arena().config().block_size_tokens;
+    int num_layers = pager_->arena().config().num_layers;
+
+    // Page-table packing: replay the recorded plan when one is supplied
+    // (the model records it once per step and shares it across every
+    // layer), otherwise pack for this call only
+    int max_blocks;
+    Tensor page_table;
+    std::vector<int> local_block_ids;
+    const std::vector<int>* block_ids = &local_block_ids;
+
+    if (plan != nullptr && plan->valid) {
+      max_blocks = plan->max_blocks;
+      page_table = plan->page_table;
+      block_ids = &plan->block_ids;
+    } else {
+      // Widest page table across the batch sets the row stride
+      max_blocks = 0;
+      for (int b = 0; b < batch; ++b) {
+        runtime::kv::Sequence* seq = pager_->get_sequence(seq_ids[b]);
+        if (!seq) {
+          throw std::runtime_error("Sequence not found: " +
+                                   std::to_string(seq_ids[b]));
+        }
+        int num_blocks = static_cast<int>(seq->page_table().size());
+        if (num_blocks > max_blocks) {
+          max_blocks = num_blocks;
+        }
+      }
+
+      // Pack all page tables into one buffer of stack-local indices and
+      // gather the referenced blocks once (shared prefix blocks dedup)
+      page_table = pager_->build_batched_page_table_array(seq_ids, max_blocks,
+                                                          &local_block_ids);
+    }
+
+    // Cache contents change every step (store_kv above), so the stacked
+    // arrays are rebuilt even when the plan is replayed
+    auto k_cache_arr =
+        mlx::core::stack(pager_->arena().get_k_block_arrays(*block_ids), 0);
+    auto v_cache_arr =
+        mlx::core::stack(pager_->arena().get_v_block_arrays(*block_ids), 0);
+
+    // Batched query [batch, num_heads, head_dim]
+    auto q_squeezed = mlx::core::squeeze(q_rot.array(), 1);
+
+    // Per-row context lengths - per-step binding, taken from the plan
+    // when available so it is built once per step instead of per layer
+    Tensor seq_lengths;
+    if (plan != nullptr && plan->valid) {
+      seq_lengths = plan->seq_lengths;
+    } else {
+      std::vector<int> seq_lens(batch);
+      for (int b = 0; b < batch; ++b) {
+        seq_lens[b] = positions[b] + 1;
+      }
+      seq_lengths =
+          Tensor(mlx::core::array(seq_lens.data(), {batch}, mlx::core::int32));
+    }
+
+    // ONE dispatch for the whole decode batch
+    auto attn_output_arr = kernels::attention_decode_fused(
+        q_squeezed, k_cache_arr, v_cache_arr, page_table.array(),
+        seq_lengths.array(),
+        num_heads_, num_kv_heads_, head_dim_, block_size, max_blocks,
+        num_layers, layer_idx_,
+        true,   // use_block_format
+        false,  // use_sliding_window
+        0       // sliding_window_size
+    );
+
+    // [batch, num_heads, head_dim] -> [batch, 1, hidden_size]
+    attn_output_arr = mlx::core::expand_dims(attn_output_arr, 1);
+    auto attn_output =
+        Tensor(attn_output_arr).reshape({batch, 1, hidden_size_});
+
+    return attention_.o_proj().forward(attn_output);
+  }
+#endif
+
+  // Per-sequence RoPE + cached attention. Each sequence has its own
+  // position and page table, so the attention core runs per row, but all
+  // rows contribute to the same lazy graph (one evaluation downstream).
+  std::vector<Tensor> row_outputs;
+  row_outputs.reserve(batch);
+
+  auto q_shape = q.shape();
+  auto k_shape = k_cur.shape();
+
+  for (int b = 0; b < batch; ++b) {
+    // Slice row b: [1, 1, num_heads, head_dim]
+    auto q_row = Tensor(mlx::core::slice(q.array(), {b, 0, 0, 0},
+                                         {b + 1, 1, q_shape[2], q_shape[3]},
+                                         {1, 1, 1, 1}));
+    auto k_row = Tensor(mlx::core::slice(k_cur.array(), {b, 0, 0, 0},
+                                         {b + 1, 1, k_shape[2], k_shape[3]},
+                                         {1, 1, 1, 1}));
+    auto v_row = Tensor(mlx::core::slice(v_cur.array(), {b, 0, 0, 0},
+                                         {b + 1, 1, k_shape[2], k_shape[3]},
+                                         {1, 1, 1, 1}));
+
+    // Apply rotary embeddings at this sequence's position
+    auto [q_rot, k_rot] = attention_.rope().forward(q_row, k_row, positions[b]);
+
+    row_outputs.push_back(
+        decode_attend_row(q_rot, k_rot, v_row, seq_ids[b], positions[b]));
+  }
+
+  // Stack rows back into [batch, 1, hidden_size]
+  auto attn_output = concatenate(row_outputs, 0);
+
+  // Output projection as a single batched matmul
+  auto output = attention_.o_proj().forward(attn_output);
+
+  return output;
+}
+
+Tensor CachedAttention::decode_attend_row(const Tensor& q_rot,
+                                          const Tensor& k_rot,
+                                          const Tensor& v_cur, int seq_id,
+                                          int pos) {
+  // Load cached K, V if available
+  Tensor k_full, v_full;
+
+  if (is_cache_enabled() && seq_id >= 0) {
+    // Store current K, V
+    store_kv(k_rot, v_cur, seq_id, pos);
+
+    // Load full K, V from cache
+    auto [k_cached, v_cached] = load_kv(seq_id, pos + 1);
+    k_full = k_cached;
+    v_full = v_cached;
+  } else {
+    // No cache - just use current tokens
+    k_full = k_rot;
+    v_full = v_cur;
+  }
+
+  // Expand KV heads if using GQA
+  if (num_kv_heads_ < num_heads_) {
+    int num_groups = num_heads_ / num_kv_heads_;
+    auto k_shape = k_full.shape();
+    auto v_shape = v_full.shape();
+
+    std::vector<Tensor> k_repeated;
+    std::vector<Tensor> v_repeated;
+
+    for (int i = 0; i < num_kv_heads_; ++i) {
+      for (int j = 0; j < num_groups; ++j) {
+        auto k_slice = mlx::core::slice(
+            k_full.array(), {0, 0, i, 0},
+            {k_shape[0], k_shape[1], i + 1, k_shape[3]}, {1, 1, 1, 1});
+        auto v_slice = mlx::core::slice(
+            v_full.array(), {0, 0, i, 0},
+            {v_shape[0], v_shape[1], i + 1, v_shape[3]}, {1, 1, 1, 1});
+        k_repeated.push_back(Tensor(k_slice));
+        v_repeated.push_back(Tensor(v_slice));
+      }
+    }
+
+    k_full = concatenate(k_repeated, 2);
+    v_full = concatenate(v_repeated, 2);
+  }
+
+  // Transpose to [batch=1, num_heads, seq_len, head_dim]
+  auto q_t = q_rot.transpose({0, 2, 1, 3});
+  k_full = k_full.transpose({0, 2, 1, 3});
+  v_full = v_full.transpose({0, 2, 1, 3});
+
+  // Compute attention: Q @ K^T / sqrt(head_dim)
+  auto k_full_t = k_full.transpose({0, 1, 3, 2});
+  auto scores = matmul(q_t, k_full_t);
+
+  float scale = 1.0f / std::sqrt(static_cast<float>(head_dim_));
+  scores = scores * scale;
+
+  // Apply softmax
+  auto attn_weights = Tensor(mlx::core::softmax(scores.array(), /*axis=*/-1));
+
+  // Apply attention to values
+  auto attn_output = matmul(attn_weights, v_full);
+
+  // Transpose back: [1, 1, num_heads, head_dim]
+  attn_output = attn_output.transpose({0, 2, 1, 3});
+
+  // Reshape to [1, 1, hidden_size]
+  return attn_output.reshape({1, 1, hidden_size_});
+}
+
 void CachedAttention::store_kv(const Tensor& k, const Tensor& v, int seq_id,
                                int start_pos) {
   if (!is_cache_enabled()) {
@@ -440,9 +770,8 @@ void CachedAttention::store_kv(const Tensor& k, const Tensor& v, int seq_id,
 
     // For now, we'll store the entire K, V tensors in the block
     // (In production, we'd do more efficient slice updates)
-    block->k_data = k;
-    block->v_data = v;
-    block->dirty = true;
+    // Arena handles quantization of the payload when enabled
+    pager_->arena().store_block_kv(block_id, k, v);
 
     // Touch block for LRU
     pager_->arena().touch_block(block_id);
@@ -477,7 +806,8 @@ std::pair<Tensor, Tensor> CachedAttention::load_kv(int seq_id, int seq_len) {
   pager_->arena().touch_block(block_id);
 
   // Return K, V (simplified - should slice to seq_len)
-  return {block->k_data, block->v_data};
+  // Arena dequantizes the payload when quantized storage is enabled
+  return pager_->arena().load_block_kv(block_id);
 }
 
 void CachedAttention::clear_cache(int seq_id) {
@@ -523,5 +853,47 @@ Tensor CachedTransformerBlock::forward(const Tensor& x, int seq_id,
   return output;
 }
 
+Tensor CachedTransformerBlock::forward_decode_batch(
+    const Tensor& x, const std::vector<int>& seq_ids,
+    const std::vector<int>& positions,
+    const runtime::kv::BatchDecodePlan* plan) {
+  // Same pre-norm structure as forward(); norms and MLP run batched,
+  // attention handles per-sequence page tables internally.
+
+  // Attention block with residual
+  auto normed = input_layernorm_.forward(x);
+  auto attn_out =
+      attention_.forward_decode_batch(normed, seq_ids, positions, plan);
+  auto x_after_attn = x + attn_out;
+
+  // MLP block with residual
+  normed = post_attention_layernorm_.forward(x_after_attn);
+  auto mlp_out = mlp_.forward(normed);
+  auto output = x_after_attn + mlp_out;
+
+  return output;
+}
+
+Tensor CachedTransformerBlock::forward_prefill_packed(
+    const Tensor& x, const std::vector<int>& seq_ids,
+    const std::vector<int>& cu_seqlens) {
+  // Same pre-norm structure as forward(); norms and the MLP — the bulk
+  // of prefill FLOPs — run on the packed stream with zero padding,
+  // attention splits per segment internally.
+
+  // Attention block with residual
+  auto normed = input_layernorm_.forward(x);
+  auto attn_out = attention_.forward_prefill_packed(normed, seq_ids,
+                                                    cu_seqlens);
+  auto x_after_attn = x + attn_out;
+
+  // MLP block with residual
+  normed = post_attention_layernorm_.forward(x_after_attn);
+  auto mlp_out = mlp_.forward(normed);
+  auto output = x_after_attn + mlp_out;
+
+  return output;
+}
+
 }  // namespace graph
 }  // namespace mlxr
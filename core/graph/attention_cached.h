@@ -71,6 +71,45 @@ class CachedAttention {
    */
   Tensor forward_decode(const Tensor& x, int seq_id, int pos);
 
+  /**
+   * @brief Batched decode forward pass across multiple sequences
+   * @param x Input tensor [batch, 1, hidden_size] (one token per sequence)
+   * @param seq_ids Sequence IDs, one per batch row
+   * @param positions Current position per sequence
+   * @param plan Optional recorded dispatch plan (see BatchDecodePlan);
+   * when provided, the fused path replays the plan's packed page table
+   * instead of repacking it, and uses the plan's per-step seq_lengths
+   * @return Attention output [batch, 1, hidden_size]
+   *
+   * QKV and output projections run as single batched matmuls; the
+   * per-sequence attention over each page table is stitched into the
+   * same lazy graph so the whole batch evaluates in one dispatch.
+   */
+  Tensor forward_decode_batch(const Tensor& x, const std::vector<int>& seq_ids,
+                              const std::vector<int>& positions,
+                              const runtime::kv::BatchDecodePlan* plan =
+                                  nullptr);
+
+  /**
+   * @brief Ragged batched prefill over a packed token stream
+   * @param x Packed input [1, total_tokens, hidden_size]: every
+   * sequence's prompt concatenated along the token axis, no padding
+   * @param seq_ids Sequence IDs, one per segment
+   * @param cu_seqlens Cumulative segment lengths (seq_ids.size() + 1
+   * entries, cu_seqlens[0] == 0, back() == total_tokens)
+   * @return Packed attention output [1, total_tokens, hidden_size]
+   *
+   * Attention runs per segment — each sequence has its own page table
+   * and causal span — but segments are contiguous slices of the packed
+   * stream, so no FLOPs are spent on padding and the caller keeps every
+   * non-attention op (norms, MLP, projections, LM head) on the packed
+   * stream. All segment graphs are lazy; one downstream evaluation
+   * covers the batch.
+   */
+  Tensor forward_prefill_packed(const Tensor& x,
+                                const std::vector<int>& seq_ids,
+                                const std::vector<int>& cu_seqlens);
+
   /**
    * @brief Clear KV cache for a sequence
    * @param seq_id Sequence ID
@@ -89,6 +128,21 @@ class CachedAttention {
   int layer_idx() const { return layer_idx_; }
 
  private:
+  /**
+   * @brief Attention over cached KV for a single decode row
+   * @param q_rot Rotated query [1, 1, num_heads, head_dim]
+   * @param k_rot Rotated key [1, 1, num_kv_heads, head_dim]
+   * @param v_cur Value [1, 1, num_kv_heads, head_dim]
+   * @param seq_id Sequence ID
+   * @param pos Current position in sequence
+   * @return Attention output [1, 1, hidden_size] (before output projection)
+   *
+   * Stores the current K, V into the paged cache, loads the cached
+   * history, and computes attention. Shared by the batched decode path.
+   */
+  Tensor decode_attend_row(const Tensor& q_rot, const Tensor& k_rot,
+                           const Tensor& v_cur, int seq_id, int pos);
+
   /**
    * @brief Store K, V tensors into KV cache
    * @param k Key tensor [batch, seq_len, num_kv_heads, head_dim]
@@ -155,6 +209,30 @@ class CachedTransformerBlock {
   Tensor forward(const Tensor& x, int seq_id = -1, int start_pos = 0,
                  const Tensor* mask = nullptr);
 
+  /**
+   * @brief Batched decode forward pass across multiple sequences
+   * @param x Input tensor [batch, 1, hidden_size]
+   * @param seq_ids Sequence IDs, one per batch row
+   * @param positions Current position per sequence
+   * @param plan Optional recorded dispatch plan shared across layers
+   * @return Output tensor [batch, 1, hidden_size]
+   */
+  Tensor forward_decode_batch(const Tensor& x, const std::vector<int>& seq_ids,
+                              const std::vector<int>& positions,
+                              const runtime::kv::BatchDecodePlan* plan =
+                                  nullptr);
+
+  /**
+   * @brief Ragged batched prefill over a packed token stream
+   * @param x Packed input [1, total_tokens, hidden_size]
+   * @param seq_ids Sequence IDs, one per segment
+   * @param cu_seqlens Cumulative segment lengths (seq_ids.size() + 1)
+   * @return Output [1, total_tokens, hidden_size]
+   */
+  Tensor forward_prefill_packed(const Tensor& x,
+                                const std::vector<int>& seq_ids,
+                                const std::vector<int>& cu_seqlens);
+
   /**
    * @brief Get cached attention layer
    */
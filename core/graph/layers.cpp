@@ -5,6 +5,7 @@
 
 #include "layers.h"
 
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 
@@ -12,7 +13,10 @@
 #include "model.h"  // For KVCache definition
 
 #ifdef USE_CUSTOM_KERNELS
+#include "primitives/q_gemm_dequant_primitive.h"
 #include "primitives/rmsnorm_primitive.h"
+#include "primitives/rope_tables.h"
+#include "primitives/swiglu_mlp_primitive.h"
 #endif
 
 namespace mlxr {
@@ -83,7 +87,97 @@ Linear::Linear(int in_features, int out_features, bool bias)
   }
 }
 
+#ifdef USE_CUSTOM_KERNELS
+namespace {
+
+// Map GGUF type names (as reported by registry::gguf_type_name) to the
+// q_gemm kernel's variant enum. Returns -1 for unsupported formats
+int quant_type_id_from_name(const std::string& name) {
+  using kernels::QuantType;
+  if (name == "Q4_0") return static_cast<int>(QuantType::Q4_0);
+  if (name == "Q4_1") return static_cast<int>(QuantType::Q4_1);
+  if (name == "Q5_0") return static_cast<int>(QuantType::Q5_0);
+  if (name == "Q5_1") return static_cast<int>(QuantType::Q5_1);
+  if (name == "Q8_0") return static_cast<int>(QuantType::Q8_0);
+  if (name == "Q8_1") return static_cast<int>(QuantType::Q8_1);
+  if (name == "Q2_K") return static_cast<int>(QuantType::Q2_K);
+  if (name == "Q3_K") return static_cast<int>(QuantType::Q3_K);
+  if (name == "Q4_K") return static_cast<int>(QuantType::Q4_K);
+  if (name == "Q5_K") return static_cast<int>(QuantType::Q5_K);
+  if (name == "Q6_K") return static_cast<int>(QuantType::Q6_K);
+  if (name == "Q8_K") return static_cast<int>(QuantType::Q8_K);
+  if (name == "IQ2_XXS") return static_cast<int>(QuantType::IQ2_XXS);
+  if (name == "IQ2_XS") return static_cast<int>(QuantType::IQ2_XS);
+  if (name == "IQ3_XXS") return static_cast<int>(QuantType::IQ3_XXS);
+  if (name == "IQ3_S") return static_cast<int>(QuantType::IQ3_S);
+  return -1;
+}
+
+}  // anonymous namespace
+#endif  // USE_CUSTOM_KERNELS
+
+void Linear::set_quantized_weight(const Tensor& packed,
+                                  const std::string& quant_type,
+                                  int group_size) {
+#ifdef USE_CUSTOM_KERNELS
+  int id = quant_type_id_from_name(quant_type);
+  if (id < 0) {
+    throw std::invalid_argument("Unsupported quantization type: " +
+                                quant_type);
+  }
+
+  quant_weight_ = packed;
+  quant_type_id_ = id;
+  group_size_ = group_size > 0
+                    ? group_size
+                    : kernels::QGemmDequantPrimitive::get_default_group_size(
+                          static_cast<kernels::QuantType>(id));
+#else
+  (void)packed;
+  (void)group_size;
+  throw std::runtime_error(
+      "Quantized weight " + quant_type +
+      " requires the custom-kernels build (USE_CUSTOM_KERNELS)");
+#endif
+}
+
 Tensor Linear::forward(const Tensor& x) {
+#ifdef USE_CUSTOM_KERNELS
+  if (quant_type_id_ >= 0) {
+    // Quantized path: flatten to [M, K], run the fused dequant matmul on
+    // the packed GGUF blocks, then restore the leading dimensions. The
+    // fp16 weight matrix is never materialized
+    auto x_arr = x.array();
+    if (x_arr.dtype() != mlx::core::float16) {
+      x_arr = mlx::core::astype(x_arr, mlx::core::float16);
+    }
+
+    int K = in_features_;
+    int M = static_cast<int>(x_arr.size()) / K;
+    auto x2d = mlx::core::reshape(x_arr, {M, K});
+
+    // With activation quantization on, the int8 variant quantizes the
+    // rows on-GPU (absmax scales) and streams half the activation bytes
+    auto out = int8_activations_
+                   ? kernels::q_gemm_dequant_int8(
+                         x2d, quant_weight_.array(), M, out_features_, K,
+                         static_cast<kernels::QuantType>(quant_type_id_),
+                         group_size_, has_bias_ ? &bias_.array() : nullptr)
+                   : kernels::q_gemm_dequant(
+                         x2d, quant_weight_.array(), M, out_features_, K,
+                         static_cast<kernels::QuantType>(quant_type_id_),
+                         group_size_, has_bias_ ? &bias_.array() : nullptr);
+
+    auto out_shape = x.array().shape();
+    out_shape.back() = out_features_;
+    Tensor quant_result(mlx::core::reshape(out, out_shape));
+    if (!lora_bindings_.empty()) {
+      quant_result = apply_lora_stack(x, std::move(quant_result));
+    }
+    return quant_result;
+  }
+#endif
+
   // Compute y = xW^T + b
   // x shape: [..., in_features]
   // weight shape: [out_features, in_features]
@@ -95,9 +189,43 @@ Tensor Linear::forward(const Tensor& x) {
     result = result + bias_;
   }
 
+  if (!lora_bindings_.empty()) {
+    result = apply_lora_stack(x, std::move(result));
+  }
+
   return result;
 }
 
+Tensor Linear::apply_lora_stack(const Tensor& x, Tensor base) const {
+  for (const auto& binding : lora_bindings_) {
+    const auto& delta = *binding.delta;
+    // y += scale * B(Ax): a is [rank, in], b is [out, rank], so both
+    // matmuls stay skinny regardless of the base projection's size
+    auto low_rank = matmul(matmul(x, delta.a.transpose()), delta.b.transpose());
+    base = base + low_rank * delta.scale;
+  }
+  return base;
+}
+
+void Linear::attach_lora(std::shared_ptr<const LoRAAdapter> adapter,
+                         const LoRALayerWeights* delta) {
+  if (!delta) {
+    return;
+  }
+  lora_bindings_.push_back({std::move(adapter), delta});
+}
+
+size_t Linear::detach_lora(const LoRAAdapter* adapter) {
+  size_t before = lora_bindings_.size();
+  lora_bindings_.erase(
+      std::remove_if(lora_bindings_.begin(), lora_bindings_.end(),
+                     [adapter](const LoRABinding& binding) {
+                       return binding.adapter.get() == adapter;
+                     }),
+      lora_bindings_.end());
+  return before - lora_bindings_.size();
+}
+
 Tensor& Linear::weight() { return weight_; }
 
 const Tensor& Linear::weight() const { return weight_; }
@@ -119,6 +247,16 @@ RotaryEmbedding::RotaryEmbedding(int dim, int max_seq_len, float base)
 }
 
 void RotaryEmbedding::compute_freqs() {
+#ifdef USE_CUSTOM_KERNELS
+  // Fetch the process-wide precomputed tables instead of rebuilding
+  // them per layer: every RotaryEmbedding with the same (dim, base,
+  // max_seq_len) — all layers of a model, and all resident models of
+  // the same architecture — shares one cos/sin pair, which is also
+  // exactly what the fused Metal kernels bind
+  const auto& tables = kernels::rope_tables(dim_, max_seq_len_, base_);
+  cos_cached_ = Tensor(tables.cos);
+  sin_cached_ = Tensor(tables.sin);
+#else
   // Compute frequency bands
   // freqs = 1.0 / (base^(torch.arange(0, dim, 2) / dim))
   std::vector<float> freqs_data;
@@ -149,6 +287,7 @@ void RotaryEmbedding::compute_freqs() {
   // Compute cos and sin
   cos_cached_ = Tensor(mlx::core::cos(angles.array()));
   sin_cached_ = Tensor(mlx::core::sin(angles.array()));
+#endif
 }
 
 std::pair<Tensor, Tensor> RotaryEmbedding::forward(const Tensor& q,
@@ -398,6 +537,32 @@ MLP::MLP(int hidden_size, int intermediate_size)
       down_proj_(intermediate_size, hidden_size, false) {}
 
 Tensor MLP::forward(const Tensor& x) {
+#ifdef USE_CUSTOM_KERNELS
+  // Fused path: one dispatch computes swish(x @ Wg^T) ⊙ (x @ Wu^T) then
+  // the down projection, so the two [M, intermediate_size] activations
+  // never round-trip through unified memory. Dense fp16 weights only —
+  // quantized projections keep the per-projection q_gemm path below,
+  // which fuses dequantization into each matmul instead
+  if (!gate_proj_.is_quantized() && !up_proj_.is_quantized() &&
+      !down_proj_.is_quantized() &&
+      gate_proj_.weight().array().dtype() == mlx::core::float16) {
+    auto x_arr = x.array();
+    if (x_arr.dtype() != mlx::core::float16) {
+      x_arr = mlx::core::astype(x_arr, mlx::core::float16);
+    }
+
+    int K = hidden_size_;
+    int M = static_cast<int>(x_arr.size()) / K;
+    auto x2d = mlx::core::reshape(x_arr, {M, K});
+
+    auto out = kernels::swiglu_mlp(x2d, gate_proj_.weight().array(),
+                                   up_proj_.weight().array(),
+                                   down_proj_.weight().array());
+
+    return Tensor(mlx::core::reshape(out, x.array().shape()));
+  }
+#endif
+
   // SwiGLU activation: swish(gate(x)) * up(x)
   // where swish(x) = x * sigmoid(x)
 
@@ -8,8 +8,10 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "lora.h"
 #include "tensor.h"
 
 namespace mlxr {
@@ -70,6 +72,11 @@ class Linear {
    * @brief Apply linear transformation
    * @param x Input tensor [..., in_features]
    * @return Output tensor [..., out_features]
+   *
+   * Dense weights go through a plain matmul. When a quantized weight is
+   * installed (see set_quantized_weight), the packed blocks are fed to the
+   * fused q_gemm_dequant kernel instead — the weight matrix is never
+   * materialized at fp16.
    */
   Tensor forward(const Tensor& x);
 
@@ -79,6 +86,66 @@ class Linear {
   Tensor& weight();
   const Tensor& weight() const;
 
+  /**
+   * @brief Install a packed quantized weight (GGUF block layout)
+   *
+   * @param packed Raw quantized blocks as a uint8 tensor, laid out exactly
+   *               as in the GGUF file for a [out_features, in_features]
+   *               weight
+   * @param quant_type GGUF type name (e.g. "Q4_K", "Q8_0")
+   * @param group_size Elements per quantization group (0 = format default)
+   *
+   * Requires the custom-kernels build; throws otherwise.
+   */
+  void set_quantized_weight(const Tensor& packed,
+                            const std::string& quant_type, int group_size = 0);
+
+  /**
+   * @brief Whether a quantized weight is installed
+   */
+  bool is_quantized() const { return quant_type_id_ >= 0; }
+
+  /**
+   * @brief Enable dynamic INT8 activation quantization
+   *
+   * When enabled and a quantized weight is installed, forward quantizes
+   * activations per row to INT8 (absmax scales, computed on-GPU) and
+   * dispatches the int8 q_gemm variant, halving activation traffic on
+   * bandwidth-bound decode. No effect on dense layers.
+   */
+  void set_activation_quantization(bool enabled) {
+    int8_activations_ = enabled;
+  }
+
+  /**
+   * @brief Whether INT8 activation quantization is enabled
+   */
+  bool activation_quantization() const { return int8_activations_; }
+
+  /**
+   * @brief Attach a LoRA delta to this projection
+   *
+   * forward() adds scale * B(Ax) on top of the base output; the base
+   * weight (dense or quantized) is untouched. The shared_ptr keeps the
+   * adapter's factors alive while bound. Multiple adapters stack
+   * additively in attach order.
+   * @param adapter Adapter owning the factors
+   * @param delta Factors for this projection (from LoRAAdapter::find)
+   */
+  void attach_lora(std::shared_ptr<const LoRAAdapter> adapter,
+                   const LoRALayerWeights* delta);
+
+  /**
+   * @brief Detach every delta bound from an adapter
+   * @return Number of bindings removed
+   */
+  size_t detach_lora(const LoRAAdapter* adapter);
+
+  /**
+   * @brief Number of attached LoRA deltas
+   */
+  size_t num_lora() const { return lora_bindings_.size(); }
+
   /**
    * @brief Get bias parameter (if exists)
    */
@@ -91,6 +158,29 @@ class Linear {
   bool has_bias_;
   Tensor weight_;
   Tensor bias_;
+
+  // Quantized weight state (quant_type_id_ < 0 means dense)
+  Tensor quant_weight_;    // Packed GGUF blocks (uint8)
+  int quant_type_id_ = -1; // kernels::QuantType value
+  int group_size_ = 0;     // Elements per quantization group
+  bool int8_activations_ = false;  // Dynamic INT8 activation quantization
+
+  // Attached LoRA deltas, applied additively after the base projection.
+  // Each binding pins its adapter so the bound factors stay alive
+  struct LoRABinding {
+    std::shared_ptr<const LoRAAdapter> adapter;
+    const LoRALayerWeights* delta;
+  };
+  std::vector<LoRABinding> lora_bindings_;
+
+  /**
+   * @brief Add every attached low-rank delta to the base output
+   *
+   * Two skinny matmuls per delta; MLX evaluates them lazily in the same
+   * graph as the base projection, so the update fuses into the step's
+   * single evaluation instead of a separate dispatch
+   */
+  Tensor apply_lora_stack(const Tensor& x, Tensor base) const;
 };
 
 /**
@@ -244,6 +334,7 @@ class MLP {
   Linear& down_proj();
 
  private:
+  // Used by the fused-kernel dispatch; unused in plain MLX builds
   [[maybe_unused]] int hidden_size_;
   [[maybe_unused]] int intermediate_size_;
 
@@ -0,0 +1,131 @@
+/**
+ * @file lora.cpp
+ * @brief Implementation of runtime LoRA adapter loading
+ */
+
+#include "lora.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+#include "mlx/mlx.h"
+
+namespace mlxr {
+namespace graph {
+
+bool LoRAAdapter::parse_tensor_name(const std::string& tensor_name,
+                                    int& layer_idx, std::string& module,
+                                    bool& is_b) {
+  // Which factor is this?
+  size_t lora_pos = tensor_name.find(".lora_A");
+  if (lora_pos != std::string::npos) {
+    is_b = false;
+  } else {
+    lora_pos = tensor_name.find(".lora_B");
+    if (lora_pos == std::string::npos) {
+      return false;
+    }
+    is_b = true;
+  }
+
+  // Block index: PEFT checkpoints say "layers.N", our internal naming
+  // says "blocks.N" (both markers are 7 characters)
+  size_t layer_pos = tensor_name.find("layers.");
+  if (layer_pos == std::string::npos) {
+    layer_pos = tensor_name.find("blocks.");
+  }
+  if (layer_pos == std::string::npos || layer_pos >= lora_pos) {
+    return false;
+  }
+
+  size_t digit_start = layer_pos + 7;
+  size_t digit_end = digit_start;
+  while (digit_end < lora_pos &&
+         std::isdigit(static_cast<unsigned char>(tensor_name[digit_end]))) {
+    ++digit_end;
+  }
+  if (digit_end == digit_start) {
+    return false;
+  }
+  layer_idx = std::stoi(tensor_name.substr(digit_start, digit_end - digit_start));
+
+  // Module is the segment immediately before ".lora_X"
+  size_t module_start = tensor_name.rfind('.', lora_pos - 1);
+  if (module_start == std::string::npos || module_start + 1 >= lora_pos) {
+    return false;
+  }
+  module = tensor_name.substr(module_start + 1, lora_pos - module_start - 1);
+  return !module.empty();
+}
+
+std::shared_ptr<LoRAAdapter> LoRAAdapter::load(
+    const std::string& path, const std::string& name, float scale,
+    const std::vector<std::string>& target_modules) {
+  try {
+    auto loaded = mlx::core::load_safetensors(path);
+    auto& weights_map = loaded.first;
+
+    std::shared_ptr<LoRAAdapter> adapter(
+        new LoRAAdapter(name, scale > 0.0f ? scale : 1.0f));
+
+    for (const auto& weight_pair : weights_map) {
+      int layer_idx = 0;
+      std::string module;
+      bool is_b = false;
+      if (!parse_tensor_name(weight_pair.first, layer_idx, module, is_b)) {
+        continue;  // Embeddings, head, classifier, etc.
+      }
+      if (!target_modules.empty() &&
+          std::find(target_modules.begin(), target_modules.end(), module) ==
+              target_modules.end()) {
+        continue;
+      }
+
+      std::string key = std::to_string(layer_idx) + "." + module;
+      auto& entry = adapter->modules_[key];
+      entry.scale = adapter->scale_;
+      if (is_b) {
+        entry.b = Tensor(weight_pair.second);
+      } else {
+        entry.a = Tensor(weight_pair.second);
+        // lora_A is [rank, in_features]
+        adapter->rank_ =
+            std::max(adapter->rank_, weight_pair.second.shape()[0]);
+      }
+    }
+
+    // Drop projections missing one of the factors (truncated checkpoint)
+    for (auto it = adapter->modules_.begin(); it != adapter->modules_.end();) {
+      if (it->second.a.ndim() != 2 || it->second.b.ndim() != 2) {
+        std::cerr << "LoRA adapter " << name << ": incomplete factor pair for "
+                  << it->first << ", skipping" << std::endl;
+        it = adapter->modules_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    if (adapter->modules_.empty()) {
+      std::cerr << "LoRA adapter " << name << ": no lora_A/lora_B pairs in "
+                << path << std::endl;
+      return nullptr;
+    }
+
+    return adapter;
+
+  } catch (const std::exception& e) {
+    std::cerr << "Failed to load LoRA adapter from " << path << ": "
+              << e.what() << std::endl;
+    return nullptr;
+  }
+}
+
+const LoRALayerWeights* LoRAAdapter::find(int layer_idx,
+                                          const std::string& module) const {
+  auto it = modules_.find(std::to_string(layer_idx) + "." + module);
+  return it == modules_.end() ? nullptr : &it->second;
+}
+
+}  // namespace graph
+}  // namespace mlxr
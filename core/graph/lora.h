@@ -0,0 +1,106 @@
+/**
+ * @file lora.h
+ * @brief Runtime LoRA adapters applied as low-rank updates over base weights
+ *
+ * An adapter contributes y = Wx + scale * B(Ax) per targeted projection.
+ * The base weight W is never modified and no merged copy is materialized,
+ * so one resident base model can serve several fine-tuned variants:
+ * attaching or detaching an adapter only binds or unbinds the low-rank
+ * factors on the affected Linear layers.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensor.h"
+
+namespace mlxr {
+namespace graph {
+
+/**
+ * @brief Low-rank factors for one adapted projection
+ *
+ * a is the down-projection [rank, in_features], b the up-projection
+ * [out_features, rank], matching the PEFT lora_A / lora_B layout.
+ */
+struct LoRALayerWeights {
+  Tensor a;
+  Tensor b;
+  float scale = 1.0f;
+};
+
+/**
+ * @brief A loaded LoRA adapter: low-rank deltas keyed by layer and module
+ *
+ * Loads PEFT-style safetensors checkpoints
+ * (base_model.model.model.layers.N.self_attn.q_proj.lora_A.weight) and
+ * exposes per-projection lookup for attachment. The adapter owns its
+ * tensors; Linear layers bind pointers into it, so a shared_ptr to the
+ * adapter must outlive every binding (CachedLlamaModel keeps one per
+ * attached adapter).
+ */
+class LoRAAdapter {
+ public:
+  /**
+   * @brief Load an adapter from a safetensors checkpoint
+   * @param path Path to the adapter .safetensors file
+   * @param name Adapter name (used as the detach key)
+   * @param scale Multiplier applied to every delta (alpha/rank from the
+   *        registry; values <= 0 fall back to 1.0)
+   * @param target_modules Module names to keep (e.g. {"q_proj","v_proj"});
+   *        empty keeps every module present in the checkpoint
+   * @return Loaded adapter, or nullptr on parse/IO failure
+   */
+  static std::shared_ptr<LoRAAdapter> load(
+      const std::string& path, const std::string& name, float scale,
+      const std::vector<std::string>& target_modules = {});
+
+  /**
+   * @brief Look up the delta for one projection
+   * @param layer_idx Transformer block index
+   * @param module Projection name ("q_proj", "k_proj", "v_proj", "o_proj",
+   *        "gate_proj", "up_proj", "down_proj")
+   * @return Factors for that projection, or nullptr if not adapted
+   */
+  const LoRALayerWeights* find(int layer_idx, const std::string& module) const;
+
+  /**
+   * @brief Parse a checkpoint tensor name into (layer, module, A-or-B)
+   *
+   * Accepts PEFT naming with or without the "base_model.model." prefix and
+   * with "self_attn"/"attention" or "layers"/"blocks" spellings. Returns
+   * false for tensors that are not lora_A/lora_B projection weights
+   * (embeddings, head, classifier, etc.), which load() skips.
+   * @param tensor_name Name as stored in the safetensors file
+   * @param layer_idx Output block index
+   * @param module Output projection name
+   * @param is_b Output: true for lora_B, false for lora_A
+   */
+  static bool parse_tensor_name(const std::string& tensor_name, int& layer_idx,
+                                std::string& module, bool& is_b);
+
+  const std::string& name() const { return name_; }
+  int rank() const { return rank_; }
+
+  /**
+   * @brief Number of adapted projections across all layers
+   */
+  size_t num_modules() const { return modules_.size(); }
+
+ private:
+  LoRAAdapter(std::string name, float scale)
+      : name_(std::move(name)), scale_(scale) {}
+
+  std::string name_;
+  float scale_;
+  int rank_ = 0;
+  // Keyed "layer.module" (e.g. "0.q_proj")
+  std::unordered_map<std::string, LoRALayerWeights> modules_;
+};
+
+}  // namespace graph
+}  // namespace mlxr
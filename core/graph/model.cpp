@@ -5,8 +5,10 @@
 
 #include "model.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
 
@@ -28,6 +30,24 @@ static bool ends_with(const std::string& str, const std::string& suffix) {
          0;
 }
 
+// Route a weight into a Linear layer: entries flagged in quant_info carry
+// packed GGUF blocks and go through the quantized path, everything else is
+// a plain dense assignment. int8_activations additionally enables dynamic
+// activation quantization on the layers that take the quantized path
+static void assign_linear_weight(Linear& linear, const Tensor& tensor,
+                                 const std::string& name,
+                                 const WeightQuantMap& quant_info,
+                                 bool int8_activations) {
+  auto it = quant_info.find(name);
+  if (it != quant_info.end()) {
+    linear.set_quantized_weight(tensor, it->second.quant_type,
+                                it->second.group_size);
+    linear.set_activation_quantization(int8_activations);
+  } else {
+    linear.weight() = tensor;
+  }
+}
+
 static bool starts_with(const std::string& str, const std::string& prefix) {
   if (prefix.length() > str.length()) return false;
   return str.compare(0, prefix.length(), prefix) == 0;
@@ -335,8 +355,11 @@ std::string LlamaModel::map_weight_name(const std::string& hf_name) const {
 }
 
 bool LlamaModel::assign_weights(
-    const std::unordered_map<std::string, Tensor>& weights) {
+    const std::unordered_map<std::string, Tensor>& weights,
+    const WeightQuantMap& quant_info) {
   int weights_assigned = 0;
+  bool lm_head_seen = false;
+  bool embed_seen = false;
 
   for (const auto& [name, tensor] : weights) {
     std::string mapped_name = map_weight_name(name);
@@ -345,6 +368,7 @@ bool LlamaModel::assign_weights(
       // Token embeddings
       if (mapped_name == "embed_tokens.weight") {
         embed_tokens_ = tensor;
+        embed_seen = true;
         weights_assigned++;
         continue;
       }
@@ -359,6 +383,7 @@ bool LlamaModel::assign_weights(
       // LM head
       if (mapped_name == "lm_head.weight") {
         lm_head_ = tensor;
+        lm_head_seen = true;
         weights_assigned++;
         continue;
       }
@@ -386,16 +411,20 @@ bool LlamaModel::assign_weights(
         }
         // Attention weights
         else if (layer_suffix == "attention.q_proj.weight") {
-          block.attention().q_proj().weight() = tensor;
+          assign_linear_weight(block.attention().q_proj(), tensor, name,
+                               quant_info, config_.int8_activations);
           weights_assigned++;
         } else if (layer_suffix == "attention.k_proj.weight") {
-          block.attention().k_proj().weight() = tensor;
+          assign_linear_weight(block.attention().k_proj(), tensor, name,
+                               quant_info, config_.int8_activations);
           weights_assigned++;
         } else if (layer_suffix == "attention.v_proj.weight") {
-          block.attention().v_proj().weight() = tensor;
+          assign_linear_weight(block.attention().v_proj(), tensor, name,
+                               quant_info, config_.int8_activations);
           weights_assigned++;
         } else if (layer_suffix == "attention.o_proj.weight") {
-          block.attention().o_proj().weight() = tensor;
+          assign_linear_weight(block.attention().o_proj(), tensor, name,
+                               quant_info, config_.int8_activations);
           weights_assigned++;
         }
         // Post-attention layernorm
@@ -405,13 +434,16 @@ bool LlamaModel::assign_weights(
         }
         // MLP weights
         else if (layer_suffix == "mlp.gate_proj.weight") {
-          block.mlp().gate_proj().weight() = tensor;
+          assign_linear_weight(block.mlp().gate_proj(), tensor, name,
+                               quant_info, config_.int8_activations);
           weights_assigned++;
         } else if (layer_suffix == "mlp.up_proj.weight") {
-          block.mlp().up_proj().weight() = tensor;
+          assign_linear_weight(block.mlp().up_proj(), tensor, name,
+                               quant_info, config_.int8_activations);
           weights_assigned++;
         } else if (layer_suffix == "mlp.down_proj.weight") {
-          block.mlp().down_proj().weight() = tensor;
+          assign_linear_weight(block.mlp().down_proj(), tensor, name,
+                               quant_info, config_.int8_activations);
           weights_assigned++;
         }
 
@@ -429,6 +461,18 @@ bool LlamaModel::assign_weights(
     }
   }
 
+  // Tied embeddings: checkpoints that share the input embedding with the
+  // output head simply omit lm_head.weight. Alias the embedding table
+  // instead of keeping a second vocab x hidden buffer - MLX arrays share
+  // storage on assignment, and the output projection already multiplies
+  // by a transposed view, so no copy is ever materialized
+  if (embed_seen && !lm_head_seen) {
+    lm_head_ = embed_tokens_;
+    weights_assigned++;
+    std::cout << "Tied embeddings detected: LM head shares the embedding "
+              << "table" << std::endl;
+  }
+
   std::cout << "Successfully assigned " << weights_assigned << " weights"
             << std::endl;
 
@@ -519,10 +563,24 @@ CachedLlamaModel::CachedLlamaModel(const ModelConfig& config,
   std::cout
       << "[CachedLlamaModel] Initialized with Metal attention kernels enabled"
       << std::endl;
+
+  if (config_.num_cpu_layers > 0) {
+    std::cout << "[CachedLlamaModel] Split placement: layers "
+              << first_cpu_layer() << "-" << (config_.num_layers - 1)
+              << " and the LM head execute on the CPU stream" << std::endl;
+  }
 }
 
+// Out of line so the unique_ptr<BatchDecodePlan> member can be destroyed
+// with the complete type in scope
+CachedLlamaModel::~CachedLlamaModel() = default;
+
 Tensor CachedLlamaModel::forward(const Tensor& input_ids, int seq_id,
                                  int start_pos, const Tensor* mask) {
+  // Streamed load: the embedding table is assigned before layer 0's
+  // latch opens, so this wait also covers the lookup below
+  wait_for_layer(0);
+
   // input_ids shape: [batch, seq_len]
   auto shape = input_ids.shape();
   int batch = shape[0];
@@ -538,12 +596,22 @@ Tensor CachedLlamaModel::forward(const Tensor& input_ids, int seq_id,
 
   // Pass through cached transformer blocks
   // These will use Metal kernels for attention!
+  // Split placement: layers past first_cpu_layer (and the head after
+  // them) execute on the CPU stream. MLX inserts the cross-stream
+  // dependency for the hidden-state handoff automatically
+  const int first_cpu_layer = this->first_cpu_layer();
+  std::optional<mlx::core::StreamContext> cpu_context;
   for (int i = 0; i < static_cast<int>(cached_blocks_.size()); ++i) {
+    if (i >= first_cpu_layer && !cpu_context) {
+      cpu_context.emplace(mlx::core::default_stream(mlx::core::Device::cpu));
+    }
+    wait_for_layer(i);
     hidden_states =
         cached_blocks_[i].forward(hidden_states, seq_id, start_pos, mask);
   }
 
   // Final normalization
+  wait_for_layer(config_.num_layers);
   hidden_states = norm_.forward(hidden_states);
 
   // Project to vocabulary
@@ -557,6 +625,140 @@ Tensor CachedLlamaModel::forward(const Tensor& input_ids, int seq_id,
   return output;
 }
 
+Tensor CachedLlamaModel::forward_decode_batch(const Tensor& input_ids,
+                                              const std::vector<int>& seq_ids,
+                                              const std::vector<int>& positions) {
+  // input_ids shape: [batch, 1]
+  auto shape = input_ids.shape();
+  int batch = shape[0];
+
+  if (static_cast<int>(seq_ids.size()) != batch ||
+      static_cast<int>(positions.size()) != batch) {
+    throw std::invalid_argument(
+        "seq_ids/positions size must match batch dimension");
+  }
+
+  // Streamed load: layer 0's latch also covers the embedding table
+  wait_for_layer(0);
+
+  // Embedding lookup for the whole batch
+  auto input_ids_arr = input_ids.array();
+  auto embed_arr = embed_tokens_.array();
+  auto flat_ids = mlx::core::reshape(input_ids_arr, {batch});
+  auto flat_embeds = mlx::core::take(embed_arr, flat_ids, 0);
+  auto hidden_states =
+      Tensor(mlx::core::reshape(flat_embeds, {batch, 1, config_.hidden_size}));
+
+  // Record the dispatch plan once per step and replay it in every layer.
+  // The packed page table only changes when a sequence crosses a block
+  // boundary, so steady-state steps replay the previous recording and
+  // just rebind the per-step context lengths.
+  const runtime::kv::BatchDecodePlan* plan = nullptr;
+#ifdef USE_CUSTOM_KERNELS
+  if (!decode_plan_) {
+    decode_plan_ = std::make_unique<runtime::kv::BatchDecodePlan>();
+  }
+
+  // Grow page tables up front: store_kv would allocate this step's block
+  // lazily inside layer 0, but the recording below must already cover it
+  for (int b = 0; b < batch; ++b) {
+    pager_->allocate_blocks_for_sequence(seq_ids[b], positions[b] + 1);
+  }
+  pager_->refresh_batch_decode_plan(seq_ids, decode_plan_.get());
+
+  std::vector<int> seq_lens(batch);
+  for (int b = 0; b < batch; ++b) {
+    seq_lens[b] = positions[b] + 1;
+  }
+  decode_plan_->seq_lengths =
+      Tensor(mlx::core::array(seq_lens.data(), {batch}, mlx::core::int32));
+  plan = decode_plan_.get();
+#endif
+
+  // Pass through cached transformer blocks with per-sequence page tables.
+  // Split placement routes the trailing layers (and the head below) to
+  // the CPU stream, same as the single-sequence path
+  const int first_cpu_layer = this->first_cpu_layer();
+  std::optional<mlx::core::StreamContext> cpu_context;
+  for (int i = 0; i < static_cast<int>(cached_blocks_.size()); ++i) {
+    if (i >= first_cpu_layer && !cpu_context) {
+      cpu_context.emplace(mlx::core::default_stream(mlx::core::Device::cpu));
+    }
+    wait_for_layer(i);
+    hidden_states =
+        cached_blocks_[i].forward_decode_batch(hidden_states, seq_ids,
+                                               positions, plan);
+  }
+
+  // Final normalization
+  wait_for_layer(config_.num_layers);
+  hidden_states = norm_.forward(hidden_states);
+
+  // Project to vocabulary
+  auto output = matmul(hidden_states, lm_head_.transpose());
+
+  // Single evaluation for the whole batch - this is the point of the
+  // batched path: one graph dispatch instead of one per request
+  mlx::core::eval(output.array());
+
+  return output;
+}
+
+Tensor CachedLlamaModel::forward_prefill_packed(
+    const Tensor& input_ids, const std::vector<int>& seq_ids,
+    const std::vector<int>& cu_seqlens) {
+  // input_ids shape: [1, total_tokens]
+  auto shape = input_ids.shape();
+  int total_tokens = shape[1];
+
+  if (shape[0] != 1) {
+    throw std::invalid_argument(
+        "Packed prefill expects input_ids [1, total_tokens]");
+  }
+  if (cu_seqlens.size() != seq_ids.size() + 1 || cu_seqlens.front() != 0 ||
+      cu_seqlens.back() != total_tokens) {
+    throw std::invalid_argument(
+        "cu_seqlens must cover the packed token stream");
+  }
+
+  // Streamed load: layer 0's latch also covers the embedding table
+  wait_for_layer(0);
+
+  // One embedding lookup for the whole packed stream
+  auto input_ids_arr = input_ids.array();
+  auto embed_arr = embed_tokens_.array();
+  auto flat_ids = mlx::core::reshape(input_ids_arr, {total_tokens});
+  auto flat_embeds = mlx::core::take(embed_arr, flat_ids, 0);
+  auto hidden_states = Tensor(mlx::core::reshape(
+      flat_embeds, {1, total_tokens, config_.hidden_size}));
+
+  // Pass through cached transformer blocks; only the attention core
+  // splits per segment, everything else stays packed. Split placement
+  // routes trailing layers to the CPU stream, same as the other paths
+  const int first_cpu_layer = this->first_cpu_layer();
+  std::optional<mlx::core::StreamContext> cpu_context;
+  for (int i = 0; i < static_cast<int>(cached_blocks_.size()); ++i) {
+    if (i >= first_cpu_layer && !cpu_context) {
+      cpu_context.emplace(mlx::core::default_stream(mlx::core::Device::cpu));
+    }
+    wait_for_layer(i);
+    hidden_states = cached_blocks_[i].forward_prefill_packed(
+        hidden_states, seq_ids, cu_seqlens);
+  }
+
+  // Final normalization
+  wait_for_layer(config_.num_layers);
+  hidden_states = norm_.forward(hidden_states);
+
+  // Project to vocabulary
+  auto output = matmul(hidden_states, lm_head_.transpose());
+
+  // Single evaluation for the whole packed batch
+  mlx::core::eval(output.array());
+
+  return output;
+}
+
 bool CachedLlamaModel::load_weights(const std::string& path) {
   if (ends_with(path, ".safetensors")) {
     return load_safetensors(path);
@@ -579,8 +781,57 @@ bool CachedLlamaModel::load_weights_from_dir(const std::string& dir_path) {
 }
 
 bool CachedLlamaModel::load_from_weight_map(
-    const std::unordered_map<std::string, Tensor>& weights) {
-  return assign_weights(weights);
+    const std::unordered_map<std::string, Tensor>& weights,
+    const WeightQuantMap& quant_info, bool partial) {
+  return assign_weights(weights, quant_info, partial);
+}
+
+void CachedLlamaModel::begin_streamed_load() {
+  std::lock_guard<std::mutex> lock(stream_mutex_);
+  // One latch per layer plus one for the head (final norm + lm_head)
+  layer_ready_.assign(config_.num_layers + 1, false);
+  streaming_.store(true, std::memory_order_release);
+}
+
+void CachedLlamaModel::mark_layer_ready(int layer_idx) {
+  {
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    if (layer_idx >= 0 &&
+        layer_idx < static_cast<int>(layer_ready_.size())) {
+      layer_ready_[layer_idx] = true;
+    }
+  }
+  stream_cv_.notify_all();
+}
+
+void CachedLlamaModel::finish_streamed_load() {
+  // Tying is only decidable once every stage has been assigned; do it
+  // before the head latch opens so no forward reads a zero head
+  tie_lm_head_if_needed();
+
+  {
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    std::fill(layer_ready_.begin(), layer_ready_.end(), true);
+    streaming_.store(false, std::memory_order_release);
+  }
+  stream_cv_.notify_all();
+}
+
+void CachedLlamaModel::wait_for_layer(int layer_idx) const {
+  // Fast path: without a streamed load in flight the latches are free
+  if (!streaming_.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(stream_mutex_);
+  stream_cv_.wait(lock, [&] {
+    if (!streaming_.load(std::memory_order_acquire) || layer_ready_.empty()) {
+      return true;
+    }
+    const size_t idx = std::min<size_t>(static_cast<size_t>(layer_idx),
+                                        layer_ready_.size() - 1);
+    return static_cast<bool>(layer_ready_[idx]);
+  });
 }
 
 bool CachedLlamaModel::load_safetensors(const std::string& path) {
@@ -630,7 +881,8 @@ std::string CachedLlamaModel::map_weight_name(
 }
 
 bool CachedLlamaModel::assign_weights(
-    const std::unordered_map<std::string, Tensor>& weights) {
+    const std::unordered_map<std::string, Tensor>& weights,
+    const WeightQuantMap& quant_info, bool partial) {
   int weights_assigned = 0;
 
   for (const auto& [name, tensor] : weights) {
@@ -640,6 +892,7 @@ bool CachedLlamaModel::assign_weights(
       // Token embeddings
       if (mapped_name == "embed_tokens.weight") {
         embed_tokens_ = tensor;
+        embed_assigned_ = true;
         weights_assigned++;
         continue;
       }
@@ -654,6 +907,7 @@ bool CachedLlamaModel::assign_weights(
       // LM head
       if (mapped_name == "lm_head.weight") {
         lm_head_ = tensor;
+        lm_head_assigned_ = true;
         weights_assigned++;
         continue;
       }
@@ -680,16 +934,20 @@ bool CachedLlamaModel::assign_weights(
         }
         // Attention weights (access via CachedAttention -> Attention)
         else if (layer_suffix == "attention.q_proj.weight") {
-          block.attention().attention().q_proj().weight() = tensor;
+          assign_linear_weight(block.attention().attention().q_proj(), tensor,
+                               name, quant_info, config_.int8_activations);
           weights_assigned++;
         } else if (layer_suffix == "attention.k_proj.weight") {
-          block.attention().attention().k_proj().weight() = tensor;
+          assign_linear_weight(block.attention().attention().k_proj(), tensor,
+                               name, quant_info, config_.int8_activations);
           weights_assigned++;
         } else if (layer_suffix == "attention.v_proj.weight") {
-          block.attention().attention().v_proj().weight() = tensor;
+          assign_linear_weight(block.attention().attention().v_proj(), tensor,
+                               name, quant_info, config_.int8_activations);
           weights_assigned++;
         } else if (layer_suffix == "attention.o_proj.weight") {
-          block.attention().attention().o_proj().weight() = tensor;
+          assign_linear_weight(block.attention().attention().o_proj(), tensor,
+                               name, quant_info, config_.int8_activations);
           weights_assigned++;
         }
         // Post-attention layernorm
@@ -699,13 +957,16 @@ bool CachedLlamaModel::assign_weights(
         }
         // MLP weights
         else if (layer_suffix == "mlp.gate_proj.weight") {
-          block.mlp().gate_proj().weight() = tensor;
+          assign_linear_weight(block.mlp().gate_proj(), tensor, name,
+                               quant_info, config_.int8_activations);
           weights_assigned++;
         } else if (layer_suffix == "mlp.up_proj.weight") {
-          block.mlp().up_proj().weight() = tensor;
+          assign_linear_weight(block.mlp().up_proj(), tensor, name,
+                               quant_info, config_.int8_activations);
           weights_assigned++;
         } else if (layer_suffix == "mlp.down_proj.weight") {
-          block.mlp().down_proj().weight() = tensor;
+          assign_linear_weight(block.mlp().down_proj(), tensor, name,
+                               quant_info, config_.int8_activations);
           weights_assigned++;
         }
 
@@ -725,12 +986,98 @@ bool CachedLlamaModel::assign_weights(
   std::cout << "Successfully assigned " << weights_assigned << " weights"
             << std::endl;
 
-  int expected_weights = 1 + 1 + 1 + config_.num_layers * 10;
-  if (weights_assigned < expected_weights * 0.9) {
-    std::cerr << "Warning: Only assigned " << weights_assigned << " weights, "
-              << "expected ~" << expected_weights << std::endl;
+  // Streamed (partial) loads assign one layer at a time, so the
+  // whole-model count check only applies to full maps - and tying can
+  // only be decided once the whole checkpoint has been seen (streamed
+  // loads resolve it in finish_streamed_load instead)
+  if (!partial) {
+    tie_lm_head_if_needed();
+
+    int expected_weights = 1 + 1 + 1 + config_.num_layers * 10;
+    if (weights_assigned < expected_weights * 0.9) {
+      std::cerr << "Warning: Only assigned " << weights_assigned
+                << " weights, "
+                << "expected ~" << expected_weights << std::endl;
+    }
+  }
+
+  return true;
+}
+
+void CachedLlamaModel::tie_lm_head_if_needed() {
+  if (!embed_assigned_ || lm_head_assigned_) {
+    return;
+  }
+
+  // Checkpoints with tied embeddings omit the output head tensor
+  // (lm_head.weight / GGUF output.weight). Alias the embedding table
+  // rather than keeping a second vocab x hidden buffer: MLX arrays share
+  // storage on assignment, and the output projection already runs
+  // against a transposed view, so the head costs zero extra bytes
+  lm_head_ = embed_tokens_;
+  lm_head_assigned_ = true;
+  std::cout << "[CachedLlamaModel] Tied embeddings detected: LM head shares "
+            << "the embedding table" << std::endl;
+}
+
+namespace {
+
+// The seven adaptable projections of a transformer block, paired with
+// their accessors. Shared by attach and detach so the walk stays in sync
+std::vector<std::pair<const char*, Linear*>> block_projections(
+    CachedTransformerBlock& block) {
+  auto& attn = block.attention().attention();
+  auto& mlp = block.mlp();
+  return {
+      {"q_proj", &attn.q_proj()},       {"k_proj", &attn.k_proj()},
+      {"v_proj", &attn.v_proj()},       {"o_proj", &attn.o_proj()},
+      {"gate_proj", &mlp.gate_proj()},  {"up_proj", &mlp.up_proj()},
+      {"down_proj", &mlp.down_proj()},
+  };
+}
+
+}  // namespace
+
+size_t CachedLlamaModel::attach_adapter(std::shared_ptr<LoRAAdapter> adapter) {
+  if (!adapter) {
+    return 0;
+  }
+
+  size_t bound = 0;
+  for (size_t i = 0; i < cached_blocks_.size(); ++i) {
+    for (const auto& [module, linear] : block_projections(cached_blocks_[i])) {
+      if (const auto* delta = adapter->find(static_cast<int>(i), module)) {
+        linear->attach_lora(adapter, delta);
+        ++bound;
+      }
+    }
+  }
+
+  if (bound > 0) {
+    adapters_.push_back(std::move(adapter));
+  }
+  return bound;
+}
+
+bool CachedLlamaModel::detach_adapter(const std::string& name) {
+  auto it = std::find_if(
+      adapters_.begin(), adapters_.end(),
+      [&name](const std::shared_ptr<LoRAAdapter>& adapter) {
+        return adapter->name() == name;
+      });
+  if (it == adapters_.end()) {
+    return false;
+  }
+
+  const LoRAAdapter* adapter = it->get();
+  for (auto& block : cached_blocks_) {
+    for (const auto& [module, linear] : block_projections(block)) {
+      (void)module;
+      linear->detach_lora(adapter);
+    }
   }
 
+  adapters_.erase(it);
   return true;
 }
 
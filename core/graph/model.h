@@ -5,7 +5,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -72,6 +75,18 @@ struct ModelConfig {
   float norm_eps;         ///< RMSNorm epsilon (default: 1e-6)
   float rope_base;        ///< RoPE base frequency (default: 10000.0)
 
+  /// Dynamic INT8 activation quantization for quantized-weight Linear
+  /// layers (per-row absmax scales feeding the int8 q_gemm variant)
+  bool int8_activations = false;
+
+  /// Number of trailing transformer layers executed on the CPU device
+  /// (0 = all layers on GPU). The final norm and LM head follow the last
+  /// layer's placement. On unified memory no weight copy is involved -
+  /// placement is execution routing via the CPU stream - so a model too
+  /// large for comfortable GPU residency still runs at degraded speed
+  /// instead of not at all. Only honored by CachedLlamaModel
+  int num_cpu_layers = 0;
+
   /**
    * @brief Create default TinyLlama-1.1B config
    */
@@ -88,6 +103,21 @@ struct ModelConfig {
   static ModelConfig from_hf_config(const std::string& path);
 };
 
+/**
+ * @brief Quantization metadata for packed weights in a weight map
+ *
+ * Keyed by the same tensor names as the weight map itself; an entry marks
+ * that tensor as carrying raw GGUF block data (uint8) rather than a dense
+ * matrix, and assign_weights routes it through Linear::set_quantized_weight
+ * so the fused q_gemm kernel consumes the blocks directly.
+ */
+struct WeightQuantInfo {
+  std::string quant_type;  ///< GGUF type name (e.g. "Q4_K")
+  int group_size = 0;      ///< Elements per quant group (0 = format default)
+};
+
+using WeightQuantMap = std::unordered_map<std::string, WeightQuantInfo>;
+
 /**
  * @brief Complete Llama model implementation
  *
@@ -182,8 +212,11 @@ class LlamaModel {
 
   /**
    * @brief Assign loaded weights to model parameters
+   * @param weights Map of tensor names to tensor data
+   * @param quant_info Quantization metadata for packed entries in weights
    */
-  bool assign_weights(const std::unordered_map<std::string, Tensor>& weights);
+  bool assign_weights(const std::unordered_map<std::string, Tensor>& weights,
+                      const WeightQuantMap& quant_info = {});
 
   ModelConfig config_;
 
@@ -208,11 +241,12 @@ class CachedTransformerBlock;
 
 }  // namespace graph
 
-// Forward declaration for Pager
+// Forward declarations for Pager and its decode dispatch plan
 namespace runtime {
 namespace kv {
 class Pager;
-}
+struct BatchDecodePlan;
+}  // namespace kv
 }  // namespace runtime
 
 namespace graph {
@@ -233,6 +267,8 @@ class CachedLlamaModel {
   CachedLlamaModel(const ModelConfig& config,
                    std::shared_ptr<runtime::kv::Pager> pager);
 
+  ~CachedLlamaModel();
+
   /**
    * @brief Forward pass with cached attention
    * @param input_ids Token IDs [batch, seq_len]
@@ -244,6 +280,46 @@ class CachedLlamaModel {
   Tensor forward(const Tensor& input_ids, int seq_id = 0, int start_pos = 0,
                  const Tensor* mask = nullptr);
 
+  /**
+   * @brief Batched decode forward across multiple sequences
+   * @param input_ids Token IDs [batch, 1] (one decode token per sequence)
+   * @param seq_ids Sequence IDs, one per batch row
+   * @param positions Current position per sequence
+   * @return Logits [batch, 1, vocab_size]
+   *
+   * Runs one fused forward for the whole decode batch: embeddings, norms,
+   * MLPs, and projections execute as single batched ops, and the graph is
+   * evaluated once for all sequences instead of once per request.
+   *
+   * Per-step dispatch metadata (packed page table, block gather list)
+   * is recorded once into a BatchDecodePlan and replayed across all
+   * layers - and across steps until a sequence crosses a block
+   * boundary - so steady-state decode only rebinds per-step inputs
+   * instead of re-encoding the table per layer per token.
+   */
+  Tensor forward_decode_batch(const Tensor& input_ids,
+                              const std::vector<int>& seq_ids,
+                              const std::vector<int>& positions);
+
+  /**
+   * @brief Ragged batched prefill over a packed token stream
+   * @param input_ids Token IDs [1, total_tokens]: every sequence's
+   *        prompt concatenated along the token axis, no padding
+   * @param seq_ids Sequence IDs, one per segment
+   * @param cu_seqlens Cumulative segment lengths (seq_ids.size() + 1
+   *        entries, starting at 0 and ending at total_tokens)
+   * @return Logits [1, total_tokens, vocab_size]
+   *
+   * Embeddings, norms, MLPs, projections and the LM head run once over
+   * the packed stream, so mixed-length batches spend FLOPs only on
+   * real tokens — no rectangular padding to the longest prompt.
+   * Attention is computed per segment against each sequence's own page
+   * table, and the whole batch evaluates as one graph.
+   */
+  Tensor forward_prefill_packed(const Tensor& input_ids,
+                                const std::vector<int>& seq_ids,
+                                const std::vector<int>& cu_seqlens);
+
   /**
    * @brief Load weights (delegates to internal LlamaModel)
    */
@@ -253,10 +329,50 @@ class CachedLlamaModel {
   /**
    * @brief Load weights from pre-parsed weight map
    * @param weights Map of tensor names to tensor data
+   * @param quant_info Quantization metadata for packed (GGUF block) entries
+   * @param partial Expected for streamed loads: the map covers only a
+   *        subset of the model (e.g. one layer), so the assigned-count
+   *        check is skipped
    * @return true if successful
    */
   bool load_from_weight_map(
-      const std::unordered_map<std::string, Tensor>& weights);
+      const std::unordered_map<std::string, Tensor>& weights,
+      const WeightQuantMap& quant_info = {}, bool partial = false);
+
+  /**
+   * @brief Arm per-layer latches for a layer-streamed weight load
+   *
+   * After this call every forward pass blocks at layer i until the
+   * loader marks that layer ready, so prefill can start as soon as the
+   * embeddings and layer 0 are assigned while a loader thread races
+   * ahead layer-by-layer.
+   */
+  void begin_streamed_load();
+
+  /**
+   * @brief Mark a layer's weights as assigned (loader thread)
+   *
+   * Marking layer 0 asserts that the token embeddings are assigned too;
+   * the forward pass reads them before entering the block loop.
+   */
+  void mark_layer_ready(int layer_idx);
+
+  /**
+   * @brief Mark the streamed load complete
+   *
+   * Asserts the final norm and lm_head are assigned (tying the head to
+   * the embedding table if the checkpoint omitted it). Releases every
+   * remaining latch and returns forward passes to the zero-overhead
+   * non-streamed path.
+   */
+  void finish_streamed_load();
+
+  /**
+   * @brief Whether a streamed load is still in flight
+   */
+  bool streaming_load_active() const {
+    return streaming_.load(std::memory_order_acquire);
+  }
 
   /**
    * @brief Get model configuration
@@ -289,19 +405,97 @@ class CachedLlamaModel {
    */
   Tensor& lm_head() { return lm_head_; }
 
+  /**
+   * @brief Attach a LoRA adapter across all transformer blocks
+   *
+   * Binds the adapter's low-rank deltas to the matching attention and
+   * MLP projections; projections the adapter does not cover are left
+   * untouched. Pure pointer binding - no weight copies - so several
+   * fine-tuned variants of one base cost only their rank-r factors.
+   * @param adapter Loaded adapter (kept alive by the model while bound)
+   * @return Number of projections bound
+   */
+  size_t attach_adapter(std::shared_ptr<LoRAAdapter> adapter);
+
+  /**
+   * @brief Detach a previously attached adapter by name
+   * @param name Adapter name (LoRAAdapter::name)
+   * @return true if an adapter with that name was attached
+   */
+  bool detach_adapter(const std::string& name);
+
+  /**
+   * @brief Currently attached adapters
+   */
+  const std::vector<std::shared_ptr<LoRAAdapter>>& adapters() const {
+    return adapters_;
+  }
+
  private:
   bool load_safetensors(const std::string& path);
   std::string map_weight_name(const std::string& hf_name) const;
-  bool assign_weights(const std::unordered_map<std::string, Tensor>& weights);
+  bool assign_weights(const std::unordered_map<std::string, Tensor>& weights,
+                      const WeightQuantMap& quant_info = {},
+                      bool partial = false);
+
+  /**
+   * @brief Block until layer_idx is ready (no-op without a streamed load)
+   *
+   * Index num_layers waits for the head (final norm + lm_head).
+   */
+  void wait_for_layer(int layer_idx) const;
+
+  /**
+   * @brief Index of the first CPU-placed layer (== num_layers when the
+   *        whole model runs on GPU)
+   */
+  int first_cpu_layer() const {
+    if (config_.num_cpu_layers <= 0) {
+      return config_.num_layers;
+    }
+    int first = config_.num_layers - config_.num_cpu_layers;
+    return first > 0 ? first : 0;
+  }
 
   ModelConfig config_;
   std::shared_ptr<runtime::kv::Pager> pager_;
 
+  // Streamed-load latches: layer_ready_[i] gates block i, the final slot
+  // gates the head. streaming_ is the fast-path guard so non-streamed
+  // forwards never take the mutex
+  std::atomic<bool> streaming_{false};
+  mutable std::mutex stream_mutex_;
+  mutable std::condition_variable stream_cv_;
+  std::vector<bool> layer_ready_;
+
+  // Recorded decode dispatch plan, shared by every layer and replayed
+  // across steps until the batch's block set changes
+  std::unique_ptr<runtime::kv::BatchDecodePlan> decode_plan_;
+
+  // Tied-embedding detection: set by assign_weights when the respective
+  // tensors arrive. A load that finishes without an lm_head (full maps
+  // at assign time, streamed loads at finish_streamed_load) ties the
+  // head to the embedding table instead - the checkpoint omitting
+  // lm_head.weight / output.weight is the tying signal
+  bool embed_assigned_ = false;
+  bool lm_head_assigned_ = false;
+
+  /**
+   * @brief Alias the LM head to the embedding table if no head arrived
+   *
+   * MLX arrays share storage on assignment and the output projection
+   * multiplies by a transposed view, so tying costs zero bytes.
+   */
+  void tie_lm_head_if_needed();
+
   // Model components
   Tensor embed_tokens_;
   std::vector<CachedTransformerBlock> cached_blocks_;
   RMSNorm norm_;
   Tensor lm_head_;
+
+  // Attached LoRA adapters; each holds the factors its bindings point at
+  std::vector<std::shared_ptr<LoRAAdapter>> adapters_;
 };
 
 }  // namespace graph
@@ -21,7 +21,10 @@ mlx::core::array& Tensor::array() { return array_; }
 
 const mlx::core::array& Tensor::array() const { return array_; }
 
-std::vector<int> Tensor::shape() const { return from_shape(array_.shape()); }
+TensorShape Tensor::shape() const {
+  const auto& s = array_.shape();
+  return TensorShape(s.begin(), s.end());
+}
 
 mlx::core::Dtype Tensor::dtype() const { return array_.dtype(); }
 
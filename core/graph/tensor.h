@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <vector>
@@ -17,6 +20,131 @@
 namespace mlxr {
 namespace graph {
 
+/**
+ * @brief Small-buffer-optimized tensor shape
+ *
+ * Holds up to kInlineDims dimensions inline (covering every shape the
+ * inference graph produces - attention is rank 4) and spills to the
+ * heap only beyond that. Tensor::shape() returns this instead of a
+ * std::vector so the per-step shape queries in the decode path
+ * (vocab_size lookups, reshape bookkeeping) allocate nothing.
+ * Converts implicitly to std::vector<int> for callers that store one.
+ */
+class TensorShape {
+ public:
+  static constexpr size_t kInlineDims = 6;
+
+  TensorShape() noexcept : dims_(inline_dims_) {}
+
+  TensorShape(std::initializer_list<int> dims) : TensorShape() {
+    assign(dims.begin(), dims.end());
+  }
+
+  template <typename It>
+  TensorShape(It first, It last) : TensorShape() {
+    assign(first, last);
+  }
+
+  TensorShape(const TensorShape& other) : TensorShape() {
+    assign(other.begin(), other.end());
+  }
+
+  TensorShape(TensorShape&& other) noexcept : TensorShape() {
+    move_from(other);
+  }
+
+  TensorShape& operator=(const TensorShape& other) {
+    if (this != &other) {
+      assign(other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  TensorShape& operator=(TensorShape&& other) noexcept {
+    if (this != &other) {
+      release();
+      dims_ = inline_dims_;
+      size_ = 0;
+      move_from(other);
+    }
+    return *this;
+  }
+
+  ~TensorShape() { release(); }
+
+  size_t size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+  int operator[](size_t i) const noexcept { return dims_[i]; }
+  int& operator[](size_t i) noexcept { return dims_[i]; }
+  int front() const noexcept { return dims_[0]; }
+  int back() const noexcept { return dims_[size_ - 1]; }
+  const int* data() const noexcept { return dims_; }
+  const int* begin() const noexcept { return dims_; }
+  const int* end() const noexcept { return dims_ + size_; }
+
+  void push_back(int dim) {
+    if (size_ == capacity_) {
+      grow(capacity_ * 2);
+    }
+    dims_[size_++] = dim;
+  }
+
+  bool operator==(const TensorShape& other) const noexcept {
+    return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+  }
+  bool operator!=(const TensorShape& other) const noexcept {
+    return !(*this == other);
+  }
+
+  // Compatibility with callers that keep a std::vector<int> shape
+  operator std::vector<int>() const { return std::vector<int>(begin(), end()); }
+
+ private:
+  template <typename It>
+  void assign(It first, It last) {
+    size_t count = static_cast<size_t>(std::distance(first, last));
+    if (count > capacity_) {
+      grow(count);
+    }
+    std::copy(first, last, dims_);
+    size_ = count;
+  }
+
+  void move_from(TensorShape& other) noexcept {
+    if (other.dims_ == other.inline_dims_) {
+      std::memcpy(inline_dims_, other.inline_dims_,
+                  other.size_ * sizeof(int));
+    } else {
+      // Steal the heap spill
+      dims_ = other.dims_;
+      capacity_ = other.capacity_;
+      other.dims_ = other.inline_dims_;
+      other.capacity_ = kInlineDims;
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+  }
+
+  void grow(size_t new_capacity) {
+    int* heap = new int[new_capacity];
+    std::memcpy(heap, dims_, size_ * sizeof(int));
+    release();
+    dims_ = heap;
+    capacity_ = new_capacity;
+  }
+
+  void release() noexcept {
+    if (dims_ != inline_dims_) {
+      delete[] dims_;
+    }
+  }
+
+  int inline_dims_[kInlineDims];
+  int* dims_;
+  size_t size_ = 0;
+  size_t capacity_ = kInlineDims;
+};
+
 // Helper function to convert std::vector to mlx::core::Shape
 inline mlx::core::Shape to_shape(const std::vector<int>& vec) {
   return mlx::core::Shape(vec.begin(), vec.end());
@@ -53,6 +181,17 @@ class Tensor {
    */
   Tensor(const std::vector<int>& shape, mlx::core::Dtype dtype);
 
+  // Copies share the underlying MLX array handle; moves transfer it
+  // without touching the refcount. Declared noexcept so containers of
+  // tensors (logits batches, KV layer caches) relocate by move
+  Tensor(const Tensor& other) = default;
+  Tensor& operator=(const Tensor& other) = default;
+  Tensor(Tensor&& other) noexcept : array_(std::move(other.array_)) {}
+  Tensor& operator=(Tensor&& other) noexcept {
+    array_ = std::move(other.array_);
+    return *this;
+  }
+
   /**
    * @brief Get the underlying MLX array
    */
@@ -61,8 +200,10 @@ class Tensor {
 
   /**
    * @brief Get tensor shape
+   * Returned by value in SBO storage - no heap allocation for the
+   * rank <= 6 shapes the graph produces
    */
-  std::vector<int> shape() const;
+  TensorShape shape() const;
 
   /**
    * @brief Get tensor dtype
@@ -0,0 +1,67 @@
+// Copyright © 2025 MLXR Development
+// Micro-benchmark pass that picks kernel dispatch variants per GPU
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mlxr {
+namespace kernels {
+
+/**
+ * Representative shapes for one model, taken from registry metadata.
+ * The autotuner benchmarks candidate dispatch variants against these
+ * shapes rather than against a fixed synthetic workload.
+ */
+struct AutotuneShapes {
+  int num_heads = 32;
+  int num_kv_heads = 32;
+  int head_dim = 128;
+  int hidden_size = 4096;
+  int intermediate_size = 11008;
+  int block_size = 32;       ///< KV cache tokens per block
+  int context_tokens = 512;  ///< Decode context length to benchmark against
+};
+
+/** Winning variant for one (kernel, shape) pair */
+struct KernelTuningResult {
+  std::string kernel;     ///< Kernel name (e.g. "attention_decode_fused")
+  std::string shape_key;  ///< Shape key (see kernel_tuning.h helpers)
+  int threadgroup_width;  ///< Winning threads-per-threadgroup
+  double latency_us;      ///< Best measured dispatch latency
+};
+
+/**
+ * The (kernel, shape_key) pairs the autotuner would benchmark for these
+ * shapes. The loader uses this to check the registry for persisted winners
+ * before paying for a fresh benchmark run.
+ */
+std::vector<std::pair<std::string, std::string>> autotune_plan(
+    const AutotuneShapes& shapes);
+
+/**
+ * Micro-benchmark candidate threadgroup widths for the tunable kernels
+ * (attention decode, fused QKV+RoPE prefill, SwiGLU MLP) on the given
+ * shapes and install the winners into the process tuning table.
+ *
+ * Returns the winners so the caller can persist them. Returns empty when
+ * custom kernels are compiled out; kernels that fail to run (e.g. missing
+ * metallib) are skipped rather than failing the model load.
+ */
+std::vector<KernelTuningResult> autotune_kernels(const AutotuneShapes& shapes);
+
+/** Install one tuning (e.g. replayed from the registry) without benchmarking */
+void apply_kernel_tuning(const std::string& kernel,
+                         const std::string& shape_key, int threadgroup_width);
+
+/**
+ * Stable key identifying the GPU for persisted tunings
+ * (e.g. "apple-m4-max"). Tunings recorded on a different GPU must not be
+ * replayed: the best tile configuration differs across generations.
+ */
+std::string gpu_device_key();
+
+}  // namespace kernels
+}  // namespace mlxr
@@ -0,0 +1,257 @@
+// Copyright © 2025 MLXR Development
+// Micro-benchmark pass that picks kernel dispatch variants per GPU
+//
+// The kernel catalog spans head_dim × block_tokens × dtype variants, and
+// the dispatch threadgroup width is a free parameter the shaders read
+// dynamically. Hand-picked defaults (256 everywhere) leave 10-20% on the
+// table because the best width differs between GPU generations. This pass
+// times candidate widths on the model's actual shapes at first load; the
+// loader persists winners to the registry's kernel_tunings table keyed by
+// GPU so subsequent loads replay them instead of re-benchmarking.
+
+#include "autotune.h"
+
+#include "kernel_tuning.h"
+
+#include <chrono>
+#include <iostream>
+
+#ifdef USE_CUSTOM_KERNELS
+#include <mlx/array.h>
+#include <mlx/ops.h>
+#include <mlx/transforms.h>
+
+#include "primitives/attention_decode_primitive.h"
+#include "primitives/qkv_rope_store_primitive.h"
+#include "primitives/swiglu_mlp_primitive.h"
+#endif
+
+#import <Foundation/Foundation.h>
+#import <Metal/Metal.h>
+
+namespace mlxr {
+namespace kernels {
+
+namespace {
+
+// Candidate threads-per-threadgroup. All shaders stride their loops by the
+// dispatched width, so any of these is functionally correct
+const int kCandidateWidths[] = {64, 128, 256, 512};
+
+#ifdef USE_CUSTOM_KERNELS
+
+// Best-of-N wall-clock time for one dispatch, in microseconds.
+// mlx::core::eval blocks until the outputs are computed, so the measured
+// interval covers the full dispatch
+template <typename Fn>
+double time_dispatch_us(Fn&& fn, int warmup = 2, int iterations = 5) {
+  for (int i = 0; i < warmup; i++) {
+    fn();
+  }
+  double best = 0.0;
+  for (int i = 0; i < iterations; i++) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    double us =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count();
+    if (i == 0 || us < best) {
+      best = us;
+    }
+  }
+  return best;
+}
+
+// Benchmark one kernel over the candidate widths. `run` dispatches the
+// kernel once; the tuning table entry is set before each candidate so the
+// primitive picks the width up on dispatch
+template <typename Fn>
+KernelTuningResult tune_kernel(const std::string& kernel,
+                               const std::string& shape_key, Fn&& run) {
+  KernelTuningResult result;
+  result.kernel = kernel;
+  result.shape_key = shape_key;
+  result.threadgroup_width = 0;
+  result.latency_us = 0.0;
+
+  for (int width : kCandidateWidths) {
+    set_tuned_threadgroup_width(kernel, shape_key, width);
+    double us = time_dispatch_us(run);
+    if (result.threadgroup_width == 0 || us < result.latency_us) {
+      result.threadgroup_width = width;
+      result.latency_us = us;
+    }
+  }
+
+  // Leave the winner installed
+  set_tuned_threadgroup_width(kernel, shape_key, result.threadgroup_width);
+  return result;
+}
+
+#endif  // USE_CUSTOM_KERNELS
+
+// The decode primitive dispatches the GQA-specialized kernel for the head
+// ratios it supports and the generic kernel otherwise; tunings must be
+// keyed by the kernel that actually runs for this model's shapes
+std::pair<std::string, std::string> attention_decode_tuning_entry(
+    const AutotuneShapes& shapes) {
+  int gqa_group =
+      attention_decode_gqa_group_size(shapes.num_heads, shapes.num_kv_heads);
+  if (gqa_group > 0) {
+    return {"attention_decode_gqa",
+            attention_decode_gqa_shape_key(gqa_group, shapes.head_dim,
+                                           shapes.block_size)};
+  }
+  return {"attention_decode_fused",
+          attention_decode_shape_key(shapes.head_dim, shapes.block_size)};
+}
+
+}  // anonymous namespace
+
+std::vector<std::pair<std::string, std::string>> autotune_plan(
+    const AutotuneShapes& shapes) {
+  return {
+      attention_decode_tuning_entry(shapes),
+      {"qkv_rope_store",
+       qkv_rope_store_shape_key(shapes.hidden_size, shapes.head_dim)},
+      {"swiglu_mlp_fused",
+       swiglu_shape_key(shapes.hidden_size, shapes.intermediate_size)},
+  };
+}
+
+void apply_kernel_tuning(const std::string& kernel,
+                         const std::string& shape_key, int threadgroup_width) {
+  set_tuned_threadgroup_width(kernel, shape_key, threadgroup_width);
+}
+
+std::string gpu_device_key() {
+  @autoreleasepool {
+    id<MTLDevice> device = MTLCreateSystemDefaultDevice();
+    if (!device) {
+      return "unknown-gpu";
+    }
+    NSString* name = [[[device name] lowercaseString]
+        stringByReplacingOccurrencesOfString:@" " withString:@"-"];
+    std::string key([name UTF8String]);
+    [device release];
+    return key;
+  }
+}
+
+std::vector<KernelTuningResult> autotune_kernels(const AutotuneShapes& shapes) {
+  std::vector<KernelTuningResult> results;
+
+#ifdef USE_CUSTOM_KERNELS
+  using mlx::core::array;
+  namespace mx = mlx::core;
+
+  // Attention decode: one sequence at the benchmark context length
+  try {
+    int max_blocks =
+        (shapes.context_tokens + shapes.block_size - 1) / shapes.block_size;
+    auto q = mx::ones({1, shapes.num_heads, shapes.head_dim}, mx::float16);
+    auto k_cache = mx::zeros(
+        {max_blocks, shapes.block_size, shapes.num_kv_heads, shapes.head_dim},
+        mx::float16);
+    auto v_cache = mx::zeros(
+        {max_blocks, shapes.block_size, shapes.num_kv_heads, shapes.head_dim},
+        mx::float16);
+    std::vector<int> table(max_blocks);
+    for (int i = 0; i < max_blocks; i++) {
+      table[i] = i;
+    }
+    auto page_table = array(table.data(), {1, max_blocks}, mx::int32);
+    std::vector<int> lens = {shapes.context_tokens};
+    auto seq_lengths = array(lens.data(), {1}, mx::int32);
+    mx::eval({q, k_cache, v_cache, page_table, seq_lengths});
+
+    auto decode_entry = attention_decode_tuning_entry(shapes);
+    results.push_back(tune_kernel(
+        decode_entry.first, decode_entry.second, [&]() {
+          auto out = attention_decode_fused(
+              q, k_cache, v_cache, page_table, seq_lengths, shapes.num_heads,
+              shapes.num_kv_heads, shapes.head_dim, shapes.block_size,
+              max_blocks);
+          mx::eval(out);
+        }));
+  } catch (const std::exception& e) {
+    std::cerr << "[Autotune] Skipping attention_decode_fused: " << e.what()
+              << std::endl;
+  }
+
+  // Fused QKV + RoPE + KV store: one block of prefill tokens
+  try {
+    int seq_len = shapes.block_size;
+    auto x = mx::ones({1, seq_len, shapes.hidden_size}, mx::float16);
+    auto wq = mx::ones({shapes.num_heads * shapes.head_dim, shapes.hidden_size},
+                       mx::float16);
+    auto wk = mx::ones(
+        {shapes.num_kv_heads * shapes.head_dim, shapes.hidden_size},
+        mx::float16);
+    auto wv = mx::ones(
+        {shapes.num_kv_heads * shapes.head_dim, shapes.hidden_size},
+        mx::float16);
+    auto rope_cos = mx::ones({seq_len, shapes.head_dim / 2}, mx::float16);
+    auto rope_sin = mx::zeros({seq_len, shapes.head_dim / 2}, mx::float16);
+    auto k_cache = mx::zeros(
+        {1, shapes.block_size, shapes.num_kv_heads, shapes.head_dim},
+        mx::float16);
+    auto v_cache = mx::zeros(
+        {1, shapes.block_size, shapes.num_kv_heads, shapes.head_dim},
+        mx::float16);
+    std::vector<int> table = {0};
+    auto page_table = array(table.data(), {1, 1}, mx::int32);
+    mx::eval({x, wq, wk, wv, rope_cos, rope_sin, k_cache, v_cache, page_table});
+
+    results.push_back(tune_kernel(
+        "qkv_rope_store",
+        qkv_rope_store_shape_key(shapes.hidden_size, shapes.head_dim), [&]() {
+          auto qkv = qkv_rope_store(x, wq, wk, wv, rope_cos, rope_sin, k_cache,
+                                    v_cache, page_table, shapes.num_heads,
+                                    shapes.num_kv_heads, shapes.head_dim,
+                                    shapes.hidden_size, shapes.block_size,
+                                    /*max_blocks_per_seq=*/1);
+          mx::eval(qkv);
+        }));
+  } catch (const std::exception& e) {
+    std::cerr << "[Autotune] Skipping qkv_rope_store: " << e.what()
+              << std::endl;
+  }
+
+  // SwiGLU MLP: a decode-sized batch of rows
+  try {
+    auto x = mx::ones({8, shapes.hidden_size}, mx::float16);
+    auto w_gate = mx::ones({shapes.intermediate_size, shapes.hidden_size},
+                           mx::float16);
+    auto w_up = mx::ones({shapes.intermediate_size, shapes.hidden_size},
+                         mx::float16);
+    auto w_down = mx::ones({shapes.hidden_size, shapes.intermediate_size},
+                           mx::float16);
+    mx::eval({x, w_gate, w_up, w_down});
+
+    results.push_back(tune_kernel(
+        "swiglu_mlp_fused",
+        swiglu_shape_key(shapes.hidden_size, shapes.intermediate_size), [&]() {
+          auto out = swiglu_mlp(x, w_gate, w_up, w_down);
+          mx::eval(out);
+        }));
+  } catch (const std::exception& e) {
+    std::cerr << "[Autotune] Skipping swiglu_mlp_fused: " << e.what()
+              << std::endl;
+  }
+
+  for (const auto& r : results) {
+    std::cout << "[Autotune] " << r.kernel << " " << r.shape_key
+              << ": threadgroup_width=" << r.threadgroup_width << " ("
+              << r.latency_us << " us)" << std::endl;
+  }
+#else
+  (void)shapes;
+#endif  // USE_CUSTOM_KERNELS
+
+  return results;
+}
+
+}  // namespace kernels
+}  // namespace mlxr
@@ -0,0 +1,91 @@
+// Copyright © 2025 MLXR Development
+// NEON attention building blocks (dot, axpy, softmax) with scalar fallback
+
+#include "cpu/neon_kernels.h"
+
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace mlxr {
+namespace kernels {
+namespace cpu {
+
+float dot(const float* a, const float* b, int n) {
+  float sum = 0.0f;
+  int i = 0;
+#if defined(__ARM_NEON)
+  float32x4_t acc = vdupq_n_f32(0.0f);
+  for (; i + 4 <= n; i += 4) {
+    acc = vfmaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+  }
+  sum = vaddvq_f32(acc);
+#endif
+  for (; i < n; i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+void axpy(float alpha, const float* x, float* y, int n) {
+  int i = 0;
+#if defined(__ARM_NEON)
+  const float32x4_t va = vdupq_n_f32(alpha);
+  for (; i + 4 <= n; i += 4) {
+    vst1q_f32(y + i, vfmaq_f32(vld1q_f32(y + i), va, vld1q_f32(x + i)));
+  }
+#endif
+  for (; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+void softmax(float* values, int n) {
+  if (n <= 0) {
+    return;
+  }
+
+  // Pass 1: max (for numerical stability)
+  float max_val = values[0];
+  int i = 0;
+#if defined(__ARM_NEON)
+  if (n >= 4) {
+    float32x4_t vmax = vld1q_f32(values);
+    for (i = 4; i + 4 <= n; i += 4) {
+      vmax = vmaxq_f32(vmax, vld1q_f32(values + i));
+    }
+    max_val = vmaxvq_f32(vmax);
+  }
+#endif
+  for (; i < n; i++) {
+    max_val = values[i] > max_val ? values[i] : max_val;
+  }
+
+  // Pass 2: exponentiate and sum. expf stays scalar — a vectorized exp
+  // approximation isn't worth the accuracy review for a fallback path,
+  // and the score vectors are short (one entry per cached token)
+  float sum = 0.0f;
+  for (int j = 0; j < n; j++) {
+    values[j] = std::exp(values[j] - max_val);
+    sum += values[j];
+  }
+
+  // Pass 3: normalize
+  const float inv_sum = 1.0f / (sum + 1e-8f);
+  i = 0;
+#if defined(__ARM_NEON)
+  const float32x4_t vinv = vdupq_n_f32(inv_sum);
+  for (; i + 4 <= n; i += 4) {
+    vst1q_f32(values + i, vmulq_f32(vld1q_f32(values + i), vinv));
+  }
+#endif
+  for (; i < n; i++) {
+    values[i] *= inv_sum;
+  }
+}
+
+}  // namespace cpu
+}  // namespace kernels
+}  // namespace mlxr
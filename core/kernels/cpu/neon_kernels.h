@@ -0,0 +1,69 @@
+// Copyright © 2025 MLXR Development
+// Vectorized CPU kernels (NEON on Apple Silicon, scalar elsewhere)
+
+#pragma once
+
+#include <cstdint>
+
+namespace mlxr {
+namespace kernels {
+namespace cpu {
+
+/**
+ * Vectorized CPU implementations of the inference hot loops, used by the
+ * primitives' eval_cpu paths so the CPU fallback is a real serving path
+ * instead of scalar reference code.
+ *
+ * On arm64 these compile to NEON intrinsics (4-lane fp32); on other
+ * architectures each function falls back to the equivalent scalar loop,
+ * so the tree stays portable and the dispatch is resolved at compile
+ * time. All functions operate on contiguous row-major fp32 buffers —
+ * the dtype the eval_cpu paths materialize today. fp16 NEON variants
+ * become worthwhile once half-precision arrays flow through eval_cpu
+ * without an fp32 round-trip.
+ *
+ * Callers are responsible for shape/contiguity checks; these functions
+ * do no validation.
+ */
+
+/// True when this build carries NEON code paths (compile-time dispatch)
+bool simd_available();
+
+/**
+ * Fused RMSNorm over `rows` independent rows of width `dim`:
+ *   output = input / sqrt(mean(input^2) + eps) * weight
+ */
+void rmsnorm(const float* input, const float* weight, float* output,
+             int rows, int dim, float eps);
+
+/**
+ * Apply rotary position embedding to one head of width `head_dim`
+ * (adjacent-pair layout: dims 2i/2i+1 rotate together). cos_row/sin_row
+ * point at the position's row of the precomputed tables (head_dim/2
+ * entries each). In-place operation is supported (output == input).
+ */
+void rope_apply_head(const float* input, float* output,
+                     const float* cos_row, const float* sin_row,
+                     int head_dim, float scale);
+
+/// Dot product of two fp32 vectors (Q·K in attention score loops)
+float dot(const float* a, const float* b, int n);
+
+/// y += alpha * x (score-weighted V accumulation in attention)
+void axpy(float alpha, const float* x, float* y, int n);
+
+/**
+ * Numerically stable in-place softmax: subtracts the running max, then
+ * exponentiates and normalizes with fp32 accumulation
+ */
+void softmax(float* values, int n);
+
+/**
+ * SwiGLU activation: out = gate * sigmoid(gate) * up, elementwise over
+ * `n` values. The surrounding projections stay in the caller's GEMM.
+ */
+void swiglu(const float* gate, const float* up, float* out, int n);
+
+}  // namespace cpu
+}  // namespace kernels
+}  // namespace mlxr
@@ -0,0 +1,66 @@
+// Copyright © 2025 MLXR Development
+// NEON RMSNorm kernel with scalar fallback
+
+#include "cpu/neon_kernels.h"
+
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace mlxr {
+namespace kernels {
+namespace cpu {
+
+bool simd_available() {
+#if defined(__ARM_NEON)
+  return true;
+#else
+  return false;
+#endif
+}
+
+void rmsnorm(const float* input, const float* weight, float* output,
+             int rows, int dim, float eps) {
+  for (int row = 0; row < rows; row++) {
+    const float* x = input + static_cast<int64_t>(row) * dim;
+    float* y = output + static_cast<int64_t>(row) * dim;
+
+    // Pass 1: sum of squares with fp32 accumulation
+    float sum_sq = 0.0f;
+    int i = 0;
+#if defined(__ARM_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= dim; i += 4) {
+      float32x4_t v = vld1q_f32(x + i);
+      acc = vfmaq_f32(acc, v, v);
+    }
+    sum_sq = vaddvq_f32(acc);
+#endif
+    for (; i < dim; i++) {
+      sum_sq += x[i] * x[i];
+    }
+
+    const float inv_rms =
+        1.0f / std::sqrt(sum_sq / static_cast<float>(dim) + eps);
+
+    // Pass 2: scale by 1/rms and the learned weight
+    i = 0;
+#if defined(__ARM_NEON)
+    float32x4_t inv = vdupq_n_f32(inv_rms);
+    for (; i + 4 <= dim; i += 4) {
+      float32x4_t v = vld1q_f32(x + i);
+      float32x4_t w = vld1q_f32(weight + i);
+      vst1q_f32(y + i, vmulq_f32(vmulq_f32(v, inv), w));
+    }
+#endif
+    for (; i < dim; i++) {
+      y[i] = x[i] * inv_rms * weight[i];
+    }
+  }
+}
+
+}  // namespace cpu
+}  // namespace kernels
+}  // namespace mlxr
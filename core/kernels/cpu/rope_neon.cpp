@@ -0,0 +1,51 @@
+// Copyright © 2025 MLXR Development
+// NEON rotary position embedding kernel with scalar fallback
+
+#include "cpu/neon_kernels.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace mlxr {
+namespace kernels {
+namespace cpu {
+
+void rope_apply_head(const float* input, float* output,
+                     const float* cos_row, const float* sin_row,
+                     int head_dim, float scale) {
+  const int num_pairs = head_dim / 2;
+  int pair = 0;
+
+#if defined(__ARM_NEON)
+  // vld2q deinterleaves adjacent pairs: val[0] = even dims, val[1] = odd
+  // dims, four pairs per iteration
+  const float32x4_t vscale = vdupq_n_f32(scale);
+  for (; pair + 4 <= num_pairs; pair += 4) {
+    float32x4x2_t xy = vld2q_f32(input + pair * 2);
+    float32x4_t c = vld1q_f32(cos_row + pair);
+    float32x4_t s = vld1q_f32(sin_row + pair);
+
+    float32x4_t y_even = vfmsq_f32(vmulq_f32(xy.val[0], c), xy.val[1], s);
+    float32x4_t y_odd = vfmaq_f32(vmulq_f32(xy.val[1], c), xy.val[0], s);
+
+    float32x4x2_t out;
+    out.val[0] = vmulq_f32(y_even, vscale);
+    out.val[1] = vmulq_f32(y_odd, vscale);
+    vst2q_f32(output + pair * 2, out);
+  }
+#endif
+
+  for (; pair < num_pairs; pair++) {
+    const float x_even = input[pair * 2];
+    const float x_odd = input[pair * 2 + 1];
+    const float c = cos_row[pair];
+    const float s = sin_row[pair];
+    output[pair * 2] = (x_even * c - x_odd * s) * scale;
+    output[pair * 2 + 1] = (x_odd * c + x_even * s) * scale;
+  }
+}
+
+}  // namespace cpu
+}  // namespace kernels
+}  // namespace mlxr
@@ -0,0 +1,59 @@
+// Copyright © 2025 MLXR Development
+// NEON SwiGLU activation kernel with scalar fallback
+
+#include "cpu/neon_kernels.h"
+
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace mlxr {
+namespace kernels {
+namespace cpu {
+
+namespace {
+
+#if defined(__ARM_NEON)
+// Vectorized sigmoid via a degree-matched exp approximation would need
+// its own accuracy review; instead compute 1/(1+exp(-x)) with scalar
+// expf but keep the multiplies vectorized. The expf calls dominate, so
+// precompute sigmoid into a small stack block and fuse the rest.
+constexpr int kBlock = 64;
+#endif
+
+}  // anonymous namespace
+
+void swiglu(const float* gate, const float* up, float* out, int n) {
+#if defined(__ARM_NEON)
+  float sig[kBlock];
+  int base = 0;
+  while (base < n) {
+    const int count = n - base < kBlock ? n - base : kBlock;
+    for (int i = 0; i < count; i++) {
+      sig[i] = 1.0f / (1.0f + std::exp(-gate[base + i]));
+    }
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+      float32x4_t g = vld1q_f32(gate + base + i);
+      float32x4_t s = vld1q_f32(sig + i);
+      float32x4_t u = vld1q_f32(up + base + i);
+      vst1q_f32(out + base + i, vmulq_f32(vmulq_f32(g, s), u));
+    }
+    for (; i < count; i++) {
+      out[base + i] = gate[base + i] * sig[i] * up[base + i];
+    }
+    base += count;
+  }
+#else
+  for (int i = 0; i < n; i++) {
+    const float s = 1.0f / (1.0f + std::exp(-gate[i]));
+    out[i] = gate[i] * s * up[i];
+  }
+#endif
+}
+
+}  // namespace cpu
+}  // namespace kernels
+}  // namespace mlxr
@@ -0,0 +1,75 @@
+// Copyright © 2025 MLXR Development
+// Per-kernel GPU timing aggregator implementation
+
+#include "kernel_profiler.h"
+
+#include <algorithm>
+
+#include <mlx/array.h>
+#include <mlx/transforms.h>
+
+namespace mlxr {
+namespace kernels {
+
+KernelProfiler& KernelProfiler::instance() {
+  static KernelProfiler profiler;
+  return profiler;
+}
+
+void KernelProfiler::record(const std::string& kernel, double ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& entry = stats_[kernel];
+  if (entry.kernel.empty()) {
+    entry.kernel = kernel;
+    entry.min_ms = ms;
+    entry.max_ms = ms;
+  }
+  entry.samples++;
+  entry.total_ms += ms;
+  entry.min_ms = std::min(entry.min_ms, ms);
+  entry.max_ms = std::max(entry.max_ms, ms);
+  entry.last_ms = ms;
+}
+
+std::vector<KernelTimingStats> KernelProfiler::snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<KernelTimingStats> result;
+  result.reserve(stats_.size());
+  for (const auto& [name, entry] : stats_) {
+    result.push_back(entry);
+  }
+  std::sort(result.begin(), result.end(),
+            [](const KernelTimingStats& a, const KernelTimingStats& b) {
+              return a.kernel < b.kernel;
+            });
+  return result;
+}
+
+void KernelProfiler::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.clear();
+}
+
+ScopedKernelTimer::ScopedKernelTimer(const char* kernel)
+    : kernel_(kernel), active_(KernelProfiler::instance().enabled()) {
+  if (active_) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+void ScopedKernelTimer::complete(const mlx::core::array& out) {
+  if (!active_) {
+    return;
+  }
+  // Blocking eval so this dispatch's GPU time is attributed to this
+  // sample rather than to whichever eval happens to flush the graph
+  mlx::core::eval({out});
+  const auto elapsed = std::chrono::steady_clock::now() - start_;
+  const double ms =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() /
+      1e6;
+  KernelProfiler::instance().record(kernel_, ms);
+}
+
+}  // namespace kernels
+}  // namespace mlxr
@@ -0,0 +1,105 @@
+// Copyright © 2025 MLXR Development
+// Opt-in per-kernel GPU timing for the custom Metal kernels
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mlx {
+namespace core {
+class array;
+}  // namespace core
+}  // namespace mlx
+
+namespace mlxr {
+namespace kernels {
+
+/**
+ * Aggregated timing for one kernel since the last reset.
+ */
+struct KernelTimingStats {
+  std::string kernel;
+  int64_t samples = 0;
+  double total_ms = 0.0;
+  double min_ms = 0.0;
+  double max_ms = 0.0;
+  double last_ms = 0.0;
+};
+
+/**
+ * Process-global per-kernel timing aggregator (profiling mode).
+ *
+ * When enabled, each custom-kernel entry point (rmsnorm, attention
+ * decode/prefill, swiglu, q_gemm) evaluates its output synchronously and
+ * records the encode+execute wall time under the kernel's name — the
+ * same timing technique the autotuner uses. Forcing an eval per dispatch
+ * breaks MLX's cross-kernel batching, so this perturbs absolute
+ * throughput and is strictly an opt-in diagnosis tool; the per-kernel
+ * ratios it reports are what locate a regression. Disabled (the
+ * default), the hot path pays a single relaxed atomic load.
+ *
+ * The daemon's metrics endpoint publishes snapshot() so the Metrics UI
+ * can chart per-kernel time. All methods are thread-safe.
+ */
+class KernelProfiler {
+ public:
+  static KernelProfiler& instance();
+
+  KernelProfiler(const KernelProfiler&) = delete;
+  KernelProfiler& operator=(const KernelProfiler&) = delete;
+
+  void set_enabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_release);
+  }
+
+  bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+  /**
+   * Record one timed dispatch for a kernel.
+   * @param kernel Kernel name (e.g. "attention_decode_fused")
+   * @param ms Measured duration in milliseconds
+   */
+  void record(const std::string& kernel, double ms);
+
+  /**
+   * Aggregates for every kernel observed since the last reset.
+   */
+  std::vector<KernelTimingStats> snapshot() const;
+
+  void reset();
+
+ private:
+  KernelProfiler() = default;
+
+  std::atomic<bool> enabled_{false};
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, KernelTimingStats> stats_;
+};
+
+/**
+ * Times one kernel dispatch when profiling is enabled; a no-op
+ * otherwise. Construct before encoding, call complete() with the output
+ * array after eval_gpu — complete() forces evaluation so the GPU time
+ * for this dispatch lands on this sample.
+ */
+class ScopedKernelTimer {
+ public:
+  explicit ScopedKernelTimer(const char* kernel);
+
+  /** Evaluate `out` and record the elapsed time (profiling mode only) */
+  void complete(const mlx::core::array& out);
+
+ private:
+  const char* kernel_;
+  bool active_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace kernels
+}  // namespace mlxr
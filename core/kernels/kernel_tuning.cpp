@@ -0,0 +1,71 @@
+// Copyright © 2025 MLXR Development
+// Process-global tuned dispatch parameters for custom Metal kernels
+
+#include "kernel_tuning.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace mlxr {
+namespace kernels {
+
+namespace {
+
+std::mutex g_tuning_mutex;
+// "<kernel>|<shape_key>" -> threads per threadgroup
+std::unordered_map<std::string, int> g_tuned_widths;
+
+std::string tuning_key(const std::string& kernel,
+                       const std::string& shape_key) {
+  return kernel + "|" + shape_key;
+}
+
+}  // anonymous namespace
+
+void set_tuned_threadgroup_width(const std::string& kernel,
+                                 const std::string& shape_key, int width) {
+  std::lock_guard<std::mutex> lock(g_tuning_mutex);
+  g_tuned_widths[tuning_key(kernel, shape_key)] = width;
+}
+
+int tuned_threadgroup_width(const std::string& kernel,
+                            const std::string& shape_key, int fallback) {
+  std::lock_guard<std::mutex> lock(g_tuning_mutex);
+  auto it = g_tuned_widths.find(tuning_key(kernel, shape_key));
+  return it != g_tuned_widths.end() ? it->second : fallback;
+}
+
+void clear_tuned_threadgroup_widths() {
+  std::lock_guard<std::mutex> lock(g_tuning_mutex);
+  g_tuned_widths.clear();
+}
+
+std::string attention_decode_shape_key(int head_dim, int block_size) {
+  return "d" + std::to_string(head_dim) + "_b" + std::to_string(block_size);
+}
+
+std::string swiglu_shape_key(int hidden_size, int intermediate_size) {
+  return "h" + std::to_string(hidden_size) + "_i" +
+         std::to_string(intermediate_size);
+}
+
+std::string qkv_rope_store_shape_key(int hidden_size, int head_dim) {
+  return "h" + std::to_string(hidden_size) + "_d" + std::to_string(head_dim);
+}
+
+int attention_decode_gqa_group_size(int num_heads, int num_kv_heads) {
+  if (num_kv_heads <= 0 || num_heads % num_kv_heads != 0) {
+    return 0;
+  }
+  int group = num_heads / num_kv_heads;
+  return (group == 1 || group == 4 || group == 8) ? group : 0;
+}
+
+std::string attention_decode_gqa_shape_key(int group_size, int head_dim,
+                                           int block_size) {
+  return "g" + std::to_string(group_size) + "_d" + std::to_string(head_dim) +
+         "_b" + std::to_string(block_size);
+}
+
+}  // namespace kernels
+}  // namespace mlxr
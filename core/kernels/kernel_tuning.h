@@ -0,0 +1,49 @@
+// Copyright © 2025 MLXR Development
+// Process-global tuned dispatch parameters for custom Metal kernels
+
+#pragma once
+
+#include <string>
+
+namespace mlxr {
+namespace kernels {
+
+/**
+ * Tuned threadgroup widths, keyed by (kernel, shape_key).
+ *
+ * The attention and MLP shaders read threads_per_threadgroup dynamically,
+ * so the dispatch width is a free parameter, and the best value differs
+ * between GPU generations (M2 Pro vs M4 Max in our fleet). The autotuner
+ * (autotune.h) installs winners here at model load — either freshly
+ * benchmarked or replayed from the registry's kernel_tunings table — and
+ * the primitives consult this table on every dispatch, falling back to
+ * their built-in defaults when no tuning is present.
+ *
+ * All functions are thread-safe.
+ */
+void set_tuned_threadgroup_width(const std::string& kernel,
+                                 const std::string& shape_key, int width);
+
+int tuned_threadgroup_width(const std::string& kernel,
+                            const std::string& shape_key, int fallback);
+
+void clear_tuned_threadgroup_widths();
+
+// Shape keys shared between the primitives and the autotuner; both sides
+// must build identical keys or tunings silently miss
+std::string attention_decode_shape_key(int head_dim, int block_size);
+std::string swiglu_shape_key(int hidden_size, int intermediate_size);
+std::string qkv_rope_store_shape_key(int hidden_size, int head_dim);
+
+// GQA group size (num_heads / num_kv_heads) when the decode primitive can
+// dispatch the function-constant specialized attention_decode_gqa variant
+// for this head layout, 0 when it must fall back to the generic kernel.
+// Specialized ratios are the ones the fleet ships: 8:1, 4:1, and 1:1.
+// Shared by the primitive and the autotuner so both agree on which kernel
+// a given model actually runs.
+int attention_decode_gqa_group_size(int num_heads, int num_kv_heads);
+std::string attention_decode_gqa_shape_key(int group_size, int head_dim,
+                                           int block_size);
+
+}  // namespace kernels
+}  // namespace mlxr
@@ -13,6 +13,9 @@
  * Features:
  * - Paged KV cache walker for non-contiguous memory
  * - Grouped Query Attention (GQA) support
+ * - GQA-specialized variant (attention_decode_gqa) compiled per head
+ *   ratio and head_dim via function constants; KV tiles are loaded once
+ *   per head group instead of once per query head
  * - Numerically stable softmax with fp32 accumulation
  * - Configurable head dimensions and block sizes
  * - Optional sliding window attention
@@ -290,6 +293,503 @@ kernel void attention_decode_fused(
   }
 }
 
-// Note: Kernel variants for different head dimensions (small_head, large_head)
-// will be added in Phase 2 with optimized implementations.
-// For Phase 1, we use a single general-purpose kernel that works for all head dimensions.
+/**
+ * @brief Attention decode kernel arguments (quantized KV variant)
+ *
+ * Same layout as AttentionDecodeArgs, but the KV cache payload is int8
+ * with per-page, per-layer dequantization scales. Used when the arena
+ * runs with KVQuantMode::INT8 or KVQuantMode::FP8_E4M3 (both store 8-bit
+ * symmetric values host-side).
+ */
+struct AttentionDecodeQ8Args {
+  device const half* q;           // Query: [batch, num_heads, head_dim]
+  device const char* k_cache;     // Quantized K blocks: [num_pages, num_layers, block_size, num_kv_heads, head_dim]
+  device const char* v_cache;     // Quantized V blocks (same layout)
+  device const float* k_scales;   // K dequant scales: [num_pages, num_layers]
+  device const float* v_scales;   // V dequant scales: [num_pages, num_layers]
+  device half* output;            // Output context: [batch, num_heads, head_dim]
+  device const int* page_table;   // Page table: [batch, max_blocks_per_seq]
+  device const int* seq_lengths;  // Sequence lengths: [batch]
+
+  uint batch_size;
+  uint num_heads;
+  uint num_kv_heads;
+  uint head_dim;
+  uint block_size;
+  uint max_blocks_per_seq;
+  uint num_layers;
+  uint layer_idx;
+  float scale;                    // 1/sqrt(head_dim)
+  bool use_sliding_window;
+  uint sliding_window_size;
+};
+
+/**
+ * @brief Fused attention decode kernel over int8-quantized KV cache
+ *
+ * Identical structure to attention_decode_fused (stripe-wise scores,
+ * two-pass softmax with fp32 accumulation), but K/V values are
+ * dequantized in-register: val = float(int8_payload) * per_layer_scale.
+ * Halves KV cache bandwidth and residency versus the fp16 variant.
+ */
+kernel void attention_decode_fused_q8(
+    constant AttentionDecodeQ8Args& args [[buffer(0)]],
+    uint gid [[threadgroup_position_in_grid]],
+    uint lid [[thread_position_in_threadgroup]],
+    uint threadgroup_size [[threads_per_threadgroup]],
+    threadgroup float* shared_scores [[threadgroup(0)]],
+    threadgroup float* shared_reduce [[threadgroup(1)]]) {
+
+  if (gid >= args.batch_size * args.num_heads) {
+    return;
+  }
+
+  const uint batch_idx = gid / args.num_heads;
+  const uint head_idx = gid % args.num_heads;
+  const uint kv_head_idx = head_idx / (args.num_heads / args.num_kv_heads);
+
+  const int seq_len = args.seq_lengths[batch_idx];
+
+  if (seq_len <= 0) {
+    for (uint d = lid; d < args.head_dim; d += threadgroup_size) {
+      args.output[gid * args.head_dim + d] = 0.0h;
+    }
+    return;
+  }
+
+  const uint q_offset = batch_idx * args.num_heads * args.head_dim + head_idx * args.head_dim;
+  device const half* q_ptr = args.q + q_offset;
+
+  // Stride of one block in the quantized cache (block format only)
+  const uint page_stride = args.num_layers * args.block_size * args.num_kv_heads * args.head_dim;
+  const uint layer_offset = args.layer_idx * args.block_size * args.num_kv_heads * args.head_dim;
+
+  // Phase 1: Compute attention scores and find max
+  const uint STRIPE_SIZE = 64;
+  const uint seq_len_u = uint(seq_len);
+  float max_score = -INFINITY;
+
+  for (uint stripe_start = 0; stripe_start < seq_len_u; stripe_start += STRIPE_SIZE) {
+    const uint stripe_end = min(stripe_start + STRIPE_SIZE, seq_len_u);
+    const uint stripe_len = stripe_end - stripe_start;
+
+    for (uint tok = lid; tok < stripe_len; tok += threadgroup_size) {
+      const uint token_pos = stripe_start + tok;
+      const uint block_idx = token_pos / args.block_size;
+      const uint block_offset = token_pos % args.block_size;
+
+      const int page_id = args.page_table[batch_idx * args.max_blocks_per_seq + block_idx];
+
+      if (page_id < 0) {
+        shared_scores[tok] = -INFINITY;
+        continue;
+      }
+
+      const uint k_offset = page_id * page_stride + layer_offset +
+                            block_offset * args.num_kv_heads * args.head_dim +
+                            kv_head_idx * args.head_dim;
+      device const char* k_ptr = args.k_cache + k_offset;
+
+      // Per-page, per-layer dequant scale loaded once per token
+      const float k_scale = args.k_scales[page_id * args.num_layers + args.layer_idx];
+
+      // Compute Q @ K^T with in-register dequantization
+      float score = 0.0f;
+      for (uint d = 0; d < args.head_dim; d++) {
+        float q_val = float(q_ptr[d]);
+        float k_val = float(k_ptr[d]) * k_scale;
+        score += q_val * k_val;
+      }
+
+      score *= args.scale;
+
+      if (args.use_sliding_window) {
+        const uint distance = seq_len - 1 - token_pos;
+        if (distance >= args.sliding_window_size) {
+          score = -INFINITY;
+        }
+      }
+
+      shared_scores[tok] = score;
+      max_score = max(max_score, score);
+    }
+
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    shared_reduce[lid] = max_score;
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    for (uint stride = threadgroup_size / 2; stride > 0; stride >>= 1) {
+      if (lid < stride) {
+        shared_reduce[lid] = max(shared_reduce[lid], shared_reduce[lid + stride]);
+      }
+      threadgroup_barrier(mem_flags::mem_threadgroup);
+    }
+
+    max_score = shared_reduce[0];
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+  }
+
+  // Phase 2: exp(score - max) and sum
+  float sum_exp = 0.0f;
+
+  for (uint stripe_start = 0; stripe_start < seq_len_u; stripe_start += STRIPE_SIZE) {
+    const uint stripe_end = min(stripe_start + STRIPE_SIZE, seq_len_u);
+    const uint stripe_len = stripe_end - stripe_start;
+
+    for (uint tok = lid; tok < stripe_len; tok += threadgroup_size) {
+      float score = shared_scores[tok];
+      float exp_score = exp(score - max_score);
+      shared_scores[tok] = exp_score;
+      sum_exp += exp_score;
+    }
+
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+  }
+
+  shared_reduce[lid] = sum_exp;
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+
+  for (uint stride = threadgroup_size / 2; stride > 0; stride >>= 1) {
+    if (lid < stride) {
+      shared_reduce[lid] += shared_reduce[lid + stride];
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+  }
+
+  sum_exp = shared_reduce[0];
+  const float inv_sum = 1.0f / (sum_exp + 1e-8f);
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+
+  // Phase 3: Normalize scores
+  for (uint stripe_start = 0; stripe_start < seq_len_u; stripe_start += STRIPE_SIZE) {
+    const uint stripe_end = min(stripe_start + STRIPE_SIZE, seq_len_u);
+    const uint stripe_len = stripe_end - stripe_start;
+
+    for (uint tok = lid; tok < stripe_len; tok += threadgroup_size) {
+      shared_scores[tok] *= inv_sum;
+    }
+
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+  }
+
+  // Phase 4: context = softmax(scores) @ V with in-register dequant
+  for (uint d = lid; d < args.head_dim; d += threadgroup_size) {
+    float accum = 0.0f;
+
+    for (uint token_pos = 0; token_pos < seq_len_u; token_pos++) {
+      const uint block_idx = token_pos / args.block_size;
+      const uint block_offset = token_pos % args.block_size;
+
+      const int page_id = args.page_table[batch_idx * args.max_blocks_per_seq + block_idx];
+
+      if (page_id < 0) {
+        continue;
+      }
+
+      const uint v_offset = page_id * page_stride + layer_offset +
+                            block_offset * args.num_kv_heads * args.head_dim +
+                            kv_head_idx * args.head_dim;
+      device const char* v_ptr = args.v_cache + v_offset;
+
+      const float v_scale = args.v_scales[page_id * args.num_layers + args.layer_idx];
+
+      const uint stripe_idx = token_pos % STRIPE_SIZE;
+      const float attn_weight = shared_scores[stripe_idx];
+
+      float v_val = float(v_ptr[d]) * v_scale;
+      accum += attn_weight * v_val;
+    }
+
+    const uint out_offset = gid * args.head_dim + d;
+    args.output[out_offset] = half(accum);
+  }
+}
+
+// ============================================================================
+// GQA-specialized decode variant (function-constant specialization)
+// ============================================================================
+
+/**
+ * Specialization constants for attention_decode_gqa. The host resolves
+ * both at pipeline-compile time (MTLFunctionConstantValues), so the group
+ * mapping and every head_dim loop below are compile-time constants in the
+ * specialized pipeline: the compiler unrolls the per-head loops, keeps the
+ * per-head accumulators in registers, and drops the runtime division that
+ * the generic kernel performs to map query heads onto KV heads.
+ *
+ * GQA_GROUP_SIZE is the query-to-KV head ratio (num_heads / num_kv_heads);
+ * the fleet's models are 8:1, 4:1, or 1:1 (plain MHA). GQA_HEAD_DIM covers
+ * the supported head dimensions (64-256).
+ */
+constant uint GQA_GROUP_SIZE [[function_constant(0)]];
+constant uint GQA_HEAD_DIM [[function_constant(1)]];
+
+// Upper bound for per-thread arrays indexed by group position; the host
+// only specializes ratios up to 8:1 and falls back to the generic kernel
+// beyond that
+constant uint kMaxGqaGroup = 8;
+
+/**
+ * @brief GQA-grouped attention decode kernel (fp16, paged KV cache)
+ *
+ * The generic attention_decode_fused kernel runs one threadgroup per
+ * QUERY head, so a GQA-8 model walks the same K/V pages eight times per
+ * decode step — once for each query head sharing a KV head. This variant
+ * runs one threadgroup per KV-HEAD GROUP: each cached K and V element is
+ * loaded from device memory exactly once per group and dotted against /
+ * accumulated into all GQA_GROUP_SIZE query heads of that group, cutting
+ * KV-cache read traffic by the group ratio on the bandwidth-bound decode
+ * path.
+ *
+ * Softmax is streamed per stripe (running max / running sum with fp32
+ * accumulation, accumulator renormalized when a stripe raises the max,
+ * as in attention_prefill_tiled), so V contributions are folded in while
+ * the stripe's scores are still resident in threadgroup memory and the
+ * kernel is exact for any context length.
+ *
+ * Grid layout:
+ *   - X: batch_size * num_kv_heads (one threadgroup per KV-head group)
+ *   - Y: 1
+ *   - Z: 1
+ *
+ * Threadgroup memory:
+ *   - shared_scores: [GQA_GROUP_SIZE * STRIPE_SIZE] score rows, one per
+ *     query head in the group
+ *   - shared_reduce: [threadgroup_size] reduction scratch
+ *   - shared_q:      [GQA_GROUP_SIZE * GQA_HEAD_DIM] group queries
+ *   - shared_acc:    [GQA_GROUP_SIZE * GQA_HEAD_DIM] unnormalized context
+ */
+kernel void attention_decode_gqa(
+    constant AttentionDecodeArgs& args [[buffer(0)]],
+    uint gid [[threadgroup_position_in_grid]],
+    uint lid [[thread_position_in_threadgroup]],
+    uint threadgroup_size [[threads_per_threadgroup]],
+    threadgroup float* shared_scores [[threadgroup(0)]],
+    threadgroup float* shared_reduce [[threadgroup(1)]],
+    threadgroup half* shared_q [[threadgroup(2)]],
+    threadgroup float* shared_acc [[threadgroup(3)]]) {
+
+  const uint STRIPE_SIZE = 64;
+
+  // Each threadgroup handles one KV head's query group
+  if (gid >= args.batch_size * args.num_kv_heads) {
+    return;
+  }
+
+  const uint batch_idx = gid / args.num_kv_heads;
+  const uint kv_head_idx = gid % args.num_kv_heads;
+
+  // First query head of this group; the group mapping is the inverse of
+  // the generic kernel's head_idx / group division, resolved at compile time
+  const uint first_head = kv_head_idx * GQA_GROUP_SIZE;
+  const uint out_base =
+      (batch_idx * args.num_heads + first_head) * GQA_HEAD_DIM;
+
+  const int seq_len = args.seq_lengths[batch_idx];
+
+  if (seq_len <= 0) {
+    // Empty sequence, write zeros for every head in the group
+    for (uint i = lid; i < GQA_GROUP_SIZE * GQA_HEAD_DIM; i += threadgroup_size) {
+      args.output[out_base + i] = 0.0h;
+    }
+    return;
+  }
+
+  // Stage the group's queries in threadgroup memory and clear the
+  // context accumulator. Q rows for the group are contiguous in
+  // [batch, num_heads, head_dim], so this is one coalesced copy.
+  const uint q_offset =
+      batch_idx * args.num_heads * GQA_HEAD_DIM + first_head * GQA_HEAD_DIM;
+  for (uint i = lid; i < GQA_GROUP_SIZE * GQA_HEAD_DIM; i += threadgroup_size) {
+    shared_q[i] = args.q[q_offset + i];
+    shared_acc[i] = 0.0f;
+  }
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+
+  // Streaming softmax state, identical in every thread after reductions
+  float run_max[kMaxGqaGroup];
+  float run_sum[kMaxGqaGroup];
+  for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+    run_max[g] = -INFINITY;
+    run_sum[g] = 0.0f;
+  }
+
+  const uint seq_len_u = uint(seq_len);
+
+  for (uint stripe_start = 0; stripe_start < seq_len_u; stripe_start += STRIPE_SIZE) {
+    const uint stripe_end = min(stripe_start + STRIPE_SIZE, seq_len_u);
+    const uint stripe_len = stripe_end - stripe_start;
+
+    // Phase 1: scores for this stripe. Each K row is read from device
+    // memory once and dotted against all GQA_GROUP_SIZE queries.
+    float local_max[kMaxGqaGroup];
+    for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+      local_max[g] = -INFINITY;
+    }
+
+    for (uint tok = lid; tok < stripe_len; tok += threadgroup_size) {
+      const uint token_pos = stripe_start + tok;
+      const uint block_idx = token_pos / args.block_size;
+      const uint block_offset = token_pos % args.block_size;
+
+      const int page_id =
+          args.page_table[batch_idx * args.max_blocks_per_seq + block_idx];
+
+      if (page_id < 0) {
+        for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+          shared_scores[g * STRIPE_SIZE + tok] = -INFINITY;
+        }
+        continue;
+      }
+
+      uint k_offset;
+      if (args.use_block_format) {
+        k_offset = page_id * args.num_layers * args.block_size * args.num_kv_heads * GQA_HEAD_DIM +
+                   args.layer_idx * args.block_size * args.num_kv_heads * GQA_HEAD_DIM +
+                   block_offset * args.num_kv_heads * GQA_HEAD_DIM +
+                   kv_head_idx * GQA_HEAD_DIM;
+      } else {
+        k_offset = page_id * args.block_size * args.num_kv_heads * GQA_HEAD_DIM +
+                   block_offset * args.num_kv_heads * GQA_HEAD_DIM +
+                   kv_head_idx * GQA_HEAD_DIM;
+      }
+      device const half* k_ptr = args.k_cache + k_offset;
+
+      float dot[kMaxGqaGroup];
+      for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+        dot[g] = 0.0f;
+      }
+
+      for (uint d = 0; d < GQA_HEAD_DIM; d++) {
+        const float k_val = float(k_ptr[d]);
+        for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+          dot[g] += float(shared_q[g * GQA_HEAD_DIM + d]) * k_val;
+        }
+      }
+
+      // Sliding window masks the whole group identically
+      bool masked = false;
+      if (args.use_sliding_window) {
+        const uint distance = seq_len - 1 - token_pos;
+        masked = distance >= args.sliding_window_size;
+      }
+
+      for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+        const float score = masked ? -INFINITY : dot[g] * args.scale;
+        shared_scores[g * STRIPE_SIZE + tok] = score;
+        local_max[g] = max(local_max[g], score);
+      }
+    }
+
+    // Phase 2: per-head stripe max, then exp(score - new_max) and sum
+    float new_max[kMaxGqaGroup];
+    for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+      shared_reduce[lid] = local_max[g];
+      threadgroup_barrier(mem_flags::mem_threadgroup);
+
+      for (uint stride = threadgroup_size / 2; stride > 0; stride >>= 1) {
+        if (lid < stride) {
+          shared_reduce[lid] = max(shared_reduce[lid], shared_reduce[lid + stride]);
+        }
+        threadgroup_barrier(mem_flags::mem_threadgroup);
+      }
+
+      new_max[g] = max(run_max[g], shared_reduce[0]);
+      threadgroup_barrier(mem_flags::mem_threadgroup);
+    }
+
+    float local_sum[kMaxGqaGroup];
+    for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+      local_sum[g] = 0.0f;
+    }
+
+    for (uint tok = lid; tok < stripe_len; tok += threadgroup_size) {
+      for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+        const float exp_score =
+            exp(shared_scores[g * STRIPE_SIZE + tok] - new_max[g]);
+        shared_scores[g * STRIPE_SIZE + tok] = exp_score;
+        local_sum[g] += exp_score;
+      }
+    }
+
+    float stripe_sum[kMaxGqaGroup];
+    for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+      shared_reduce[lid] = local_sum[g];
+      threadgroup_barrier(mem_flags::mem_threadgroup);
+
+      for (uint stride = threadgroup_size / 2; stride > 0; stride >>= 1) {
+        if (lid < stride) {
+          shared_reduce[lid] += shared_reduce[lid + stride];
+        }
+        threadgroup_barrier(mem_flags::mem_threadgroup);
+      }
+
+      stripe_sum[g] = shared_reduce[0];
+      threadgroup_barrier(mem_flags::mem_threadgroup);
+    }
+
+    // Phase 3: renormalize the running accumulators and fold in this
+    // stripe's V contributions. Each V element is read from device memory
+    // once and accumulated into all heads of the group (corr is 0 on the
+    // first stripe: exp(-inf)).
+    float corr[kMaxGqaGroup];
+    for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+      corr[g] = exp(run_max[g] - new_max[g]);
+    }
+
+    for (uint d = lid; d < GQA_HEAD_DIM; d += threadgroup_size) {
+      float accum[kMaxGqaGroup];
+      for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+        accum[g] = shared_acc[g * GQA_HEAD_DIM + d] * corr[g];
+      }
+
+      for (uint tok = 0; tok < stripe_len; tok++) {
+        const uint token_pos = stripe_start + tok;
+        const uint block_idx = token_pos / args.block_size;
+        const uint block_offset = token_pos % args.block_size;
+
+        const int page_id =
+            args.page_table[batch_idx * args.max_blocks_per_seq + block_idx];
+
+        if (page_id < 0) {
+          continue;
+        }
+
+        uint v_offset;
+        if (args.use_block_format) {
+          v_offset = page_id * args.num_layers * args.block_size * args.num_kv_heads * GQA_HEAD_DIM +
+                     args.layer_idx * args.block_size * args.num_kv_heads * GQA_HEAD_DIM +
+                     block_offset * args.num_kv_heads * GQA_HEAD_DIM +
+                     kv_head_idx * GQA_HEAD_DIM;
+        } else {
+          v_offset = page_id * args.block_size * args.num_kv_heads * GQA_HEAD_DIM +
+                     block_offset * args.num_kv_heads * GQA_HEAD_DIM +
+                     kv_head_idx * GQA_HEAD_DIM;
+        }
+
+        const float v_val = float(args.v_cache[v_offset + d]);
+        for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+          accum[g] += shared_scores[g * STRIPE_SIZE + tok] * v_val;
+        }
+      }
+
+      for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+        shared_acc[g * GQA_HEAD_DIM + d] = accum[g];
+      }
+    }
+
+    for (uint g = 0; g < GQA_GROUP_SIZE; g++) {
+      run_sum[g] = run_sum[g] * corr[g] + stripe_sum[g];
+      run_max[g] = new_max[g];
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+  }
+
+  // Final: normalize and write every head of the group
+  for (uint i = lid; i < GQA_GROUP_SIZE * GQA_HEAD_DIM; i += threadgroup_size) {
+    const uint g = i / GQA_HEAD_DIM;
+    const float inv_sum = 1.0f / (run_sum[g] + 1e-8f);
+    args.output[out_base + i] = half(shared_acc[i] * inv_sum);
+  }
+}
@@ -17,6 +17,8 @@
  * - Causal masking for autoregressive generation
  * - Numerically stable softmax with fp32 accumulation
  * - Grouped Query Attention (GQA) support
+ * - Tiled streaming variant (attention_prefill_tiled) with threadgroup
+ *   memory bounded by the tile size for long-context prefill
  */
 
 #include <metal_stdlib>
@@ -63,6 +65,9 @@ struct AttentionPrefillArgs {
   bool use_block_format;          // NEW: If true, cache is [pages, layers, ...]; if false, [pages, ...]
   float scale;                    // 1/sqrt(head_dim)
   uint position_offset;           // Starting position for RoPE
+  bool inputs_rotated;            // If true, Q/K already have RoPE applied and
+                                  // K/V are already stored in the cache (by the
+                                  // qkv_rope_store front half) - skip both here
 };
 
 /**
@@ -164,7 +169,7 @@ kernel void attention_prefill_fused(
 
   // Apply RoPE to Q (only thread 0 for simplicity in Phase 1)
   // Phase 2 can parallelize this
-  if (lid == 0) {
+  if (lid == 0 && !args.inputs_rotated) {
     apply_rope_threadgroup(shared_q, shared_q, args.rope_cos, args.rope_sin,
                           abs_position, args.head_dim);
   }
@@ -195,11 +200,13 @@ kernel void attention_prefill_fused(
                            kv_head_idx * args.head_dim;
       device const half* k_in = args.k + k_offset;
 
-      // Load K into shared memory and apply RoPE
+      // Load K into shared memory and apply RoPE (skipped when the
+      // front-half kernel already rotated and stored it)
       for (uint d = 0; d < args.head_dim; d++) {
         shared_k[d] = k_in[d];
       }
 
+      if (!args.inputs_rotated) {
       // Apply RoPE to K
       apply_rope_threadgroup(shared_k, shared_k, args.rope_cos, args.rope_sin,
                             args.position_offset + context_token, args.head_dim);
@@ -233,6 +240,7 @@ kernel void attention_prefill_fused(
           k_cache_ptr[d] = shared_k[d];
         }
       }
+      }  // !args.inputs_rotated
 
       // Compute Q @ K^T (dot product)
       float score = 0.0f;
@@ -327,8 +335,9 @@ kernel void attention_prefill_fused(
 
       half v_val = v_in[d];
 
-      // Store V into KV cache (first token only to avoid redundant writes)
-      if (context_token == seq_token_idx) {
+      // Store V into KV cache (first token only to avoid redundant writes;
+      // skipped when the front-half kernel already stored it)
+      if (context_token == seq_token_idx && !args.inputs_rotated) {
         const uint block_idx = context_token / args.block_size;
         const uint block_offset = context_token % args.block_size;
         const int page_id = args.page_table[batch_idx * args.max_blocks_per_seq + block_idx];
@@ -368,3 +377,256 @@ kernel void attention_prefill_fused(
     args.output[out_offset + d] = half(accum);
   }
 }
+
+/**
+ * @brief Tiled streaming attention prefill kernel (FlashAttention-style)
+ *
+ * Memory-bounded variant of attention_prefill_fused for long contexts.
+ * The fused kernel materializes the full score row for a query before
+ * softmax, so its threadgroup score buffer grows with context length -
+ * at 32K context that pressure arrives exactly when the arena also needs
+ * blocks for the KV being written. This variant iterates the context in
+ * fixed-size tiles and carries a running maximum, running sum, and an
+ * unnormalized output accumulator across tiles, renormalizing the
+ * accumulator whenever a tile raises the maximum (online two-pass
+ * softmax with fp32 accumulation). Threadgroup memory is
+ * O(TILE + head_dim) regardless of context length.
+ *
+ * Per tile [t0, t1):
+ *   tile_max  = max over tile scores
+ *   new_max   = max(run_max, tile_max)
+ *   corr      = exp(run_max - new_max)
+ *   acc[d]    = acc[d] * corr + sum_t exp(s_t - new_max) * V[t, d]
+ *   run_sum   = run_sum * corr + sum_t exp(s_t - new_max)
+ *   run_max   = new_max
+ * Final: output[d] = acc[d] / run_sum
+ *
+ * RoPE for K is applied pairwise in registers during the score dot
+ * product (no shared K buffer), and the rotated K is written straight to
+ * the paged cache by the thread that owns the token, so cache storage
+ * behavior matches the fused kernel.
+ *
+ * Grid layout matches attention_prefill_fused: one threadgroup per
+ * (batch, token, head).
+ */
+kernel void attention_prefill_tiled(
+    constant AttentionPrefillArgs& args [[buffer(0)]],
+    uint gid [[threadgroup_position_in_grid]],
+    uint lid [[thread_position_in_threadgroup]],
+    uint threadgroup_size [[threads_per_threadgroup]],
+    threadgroup float* shared_scores [[threadgroup(0)]],   // [TILE_SIZE]
+    threadgroup float* shared_reduce [[threadgroup(1)]],   // [threadgroup_size]
+    threadgroup half* shared_q [[threadgroup(2)]],         // [head_dim]
+    threadgroup float* shared_acc [[threadgroup(3)]]) {    // [head_dim]
+
+  const uint TILE_SIZE = 64;
+
+  // Decode indices (same layout as the fused kernel)
+  const uint total_heads = args.batch_size * args.seq_len * args.num_heads;
+  if (gid >= total_heads) {
+    return;
+  }
+
+  const uint linear_idx = gid;
+  const uint batch_idx = linear_idx / (args.seq_len * args.num_heads);
+  const uint seq_token_idx = (linear_idx / args.num_heads) % args.seq_len;
+  const uint head_idx = linear_idx % args.num_heads;
+  const uint kv_head_idx = head_idx / (args.num_heads / args.num_kv_heads);
+  const uint abs_position = args.position_offset + seq_token_idx;
+
+  // Load Q into shared memory and apply RoPE
+  const uint q_offset = batch_idx * args.seq_len * args.num_heads * args.head_dim +
+                       seq_token_idx * args.num_heads * args.head_dim +
+                       head_idx * args.head_dim;
+  device const half* q_in = args.q + q_offset;
+
+  for (uint d = lid; d < args.head_dim; d += threadgroup_size) {
+    shared_q[d] = q_in[d];
+    shared_acc[d] = 0.0f;
+  }
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+
+  if (lid == 0 && !args.inputs_rotated) {
+    apply_rope_threadgroup(shared_q, shared_q, args.rope_cos, args.rope_sin,
+                          abs_position, args.head_dim);
+  }
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+
+  // Store this token's V into the paged cache once, up front (the fused
+  // kernel does the same write from its context loop)
+  if (!args.inputs_rotated) {
+    const uint cur_block_idx = seq_token_idx / args.block_size;
+    const uint cur_block_offset = seq_token_idx % args.block_size;
+    const int cur_page_id =
+        args.page_table[batch_idx * args.max_blocks_per_seq + cur_block_idx];
+
+    if (cur_page_id >= 0) {
+      uint v_cache_offset;
+      if (args.use_block_format) {
+        v_cache_offset = cur_page_id * args.num_layers * args.block_size * args.num_kv_heads * args.head_dim +
+                         args.layer_idx * args.block_size * args.num_kv_heads * args.head_dim +
+                         cur_block_offset * args.num_kv_heads * args.head_dim +
+                         kv_head_idx * args.head_dim;
+      } else {
+        v_cache_offset = cur_page_id * args.block_size * args.num_kv_heads * args.head_dim +
+                         cur_block_offset * args.num_kv_heads * args.head_dim +
+                         kv_head_idx * args.head_dim;
+      }
+
+      const uint v_offset = batch_idx * args.seq_len * args.num_kv_heads * args.head_dim +
+                           seq_token_idx * args.num_kv_heads * args.head_dim +
+                           kv_head_idx * args.head_dim;
+      for (uint d = lid; d < args.head_dim; d += threadgroup_size) {
+        args.v_cache[v_cache_offset + d] = args.v[v_offset + d];
+      }
+    }
+  }
+
+  // Streaming state, identical in every thread after each reduction
+  const uint num_context_tokens = seq_token_idx + 1;
+  float run_max = -INFINITY;
+  float run_sum = 0.0f;
+
+  for (uint tile_start = 0; tile_start < num_context_tokens; tile_start += TILE_SIZE) {
+    const uint tile_end = min(tile_start + TILE_SIZE, num_context_tokens);
+    const uint tile_len = tile_end - tile_start;
+
+    // Phase 1: scores for this tile (RoPE on K applied pairwise in
+    // registers; rotated K written straight to the paged cache)
+    float local_max = -INFINITY;
+
+    for (uint tok = lid; tok < tile_len; tok += threadgroup_size) {
+      const uint context_token = tile_start + tok;
+
+      const uint k_offset = batch_idx * args.seq_len * args.num_kv_heads * args.head_dim +
+                           context_token * args.num_kv_heads * args.head_dim +
+                           kv_head_idx * args.head_dim;
+      device const half* k_in = args.k + k_offset;
+
+      device half* k_cache_ptr = nullptr;
+      if (!args.inputs_rotated) {
+        const uint block_idx = context_token / args.block_size;
+        const uint block_offset = context_token % args.block_size;
+        const int page_id =
+            args.page_table[batch_idx * args.max_blocks_per_seq + block_idx];
+
+        if (page_id >= 0) {
+          uint k_cache_offset;
+          if (args.use_block_format) {
+            k_cache_offset = page_id * args.num_layers * args.block_size * args.num_kv_heads * args.head_dim +
+                             args.layer_idx * args.block_size * args.num_kv_heads * args.head_dim +
+                             block_offset * args.num_kv_heads * args.head_dim +
+                             kv_head_idx * args.head_dim;
+          } else {
+            k_cache_offset = page_id * args.block_size * args.num_kv_heads * args.head_dim +
+                             block_offset * args.num_kv_heads * args.head_dim +
+                             kv_head_idx * args.head_dim;
+          }
+          k_cache_ptr = args.k_cache + k_cache_offset;
+        }
+      }
+
+      float score = 0.0f;
+      const uint k_position = args.position_offset + context_token;
+
+      for (uint d = 0; d < args.head_dim / 2; d++) {
+        const uint even_idx = d * 2;
+        const uint odd_idx = d * 2 + 1;
+
+        float k_even = float(k_in[even_idx]);
+        float k_odd = float(k_in[odd_idx]);
+
+        if (!args.inputs_rotated) {
+          const uint rope_idx = k_position * (args.head_dim / 2) + d;
+          const float cos_val = float(args.rope_cos[rope_idx]);
+          const float sin_val = float(args.rope_sin[rope_idx]);
+
+          const float rotated_even = k_even * cos_val - k_odd * sin_val;
+          const float rotated_odd = k_odd * cos_val + k_even * sin_val;
+          k_even = rotated_even;
+          k_odd = rotated_odd;
+
+          if (k_cache_ptr) {
+            k_cache_ptr[even_idx] = half(k_even);
+            k_cache_ptr[odd_idx] = half(k_odd);
+          }
+        }
+
+        score += float(shared_q[even_idx]) * k_even +
+                 float(shared_q[odd_idx]) * k_odd;
+      }
+
+      score *= args.scale;
+      shared_scores[tok] = score;
+      local_max = max(local_max, score);
+    }
+
+    // Reduce tile max across threadgroup
+    shared_reduce[lid] = local_max;
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    for (uint stride = threadgroup_size / 2; stride > 0; stride >>= 1) {
+      if (lid < stride) {
+        shared_reduce[lid] = max(shared_reduce[lid], shared_reduce[lid + stride]);
+      }
+      threadgroup_barrier(mem_flags::mem_threadgroup);
+    }
+
+    const float tile_max = shared_reduce[0];
+    const float new_max = max(run_max, tile_max);
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    // Phase 2: exp(score - new_max) and tile sum
+    float local_sum = 0.0f;
+    for (uint tok = lid; tok < tile_len; tok += threadgroup_size) {
+      const float exp_score = exp(shared_scores[tok] - new_max);
+      shared_scores[tok] = exp_score;
+      local_sum += exp_score;
+    }
+
+    shared_reduce[lid] = local_sum;
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    for (uint stride = threadgroup_size / 2; stride > 0; stride >>= 1) {
+      if (lid < stride) {
+        shared_reduce[lid] += shared_reduce[lid + stride];
+      }
+      threadgroup_barrier(mem_flags::mem_threadgroup);
+    }
+
+    const float tile_sum = shared_reduce[0];
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    // Phase 3: renormalize the running accumulator and fold in this
+    // tile's V contributions (corr is 0 on the first tile: exp(-inf))
+    const float corr = exp(run_max - new_max);
+
+    for (uint d = lid; d < args.head_dim; d += threadgroup_size) {
+      float accum = shared_acc[d] * corr;
+
+      for (uint tok = 0; tok < tile_len; tok++) {
+        const uint context_token = tile_start + tok;
+        const uint v_offset = batch_idx * args.seq_len * args.num_kv_heads * args.head_dim +
+                             context_token * args.num_kv_heads * args.head_dim +
+                             kv_head_idx * args.head_dim;
+        accum += shared_scores[tok] * float(args.v[v_offset + d]);
+      }
+
+      shared_acc[d] = accum;
+    }
+
+    run_sum = run_sum * corr + tile_sum;
+    run_max = new_max;
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+  }
+
+  // Final normalization and output write
+  const float inv_sum = 1.0f / (run_sum + 1e-8f);
+  const uint out_offset = batch_idx * args.seq_len * args.num_heads * args.head_dim +
+                         seq_token_idx * args.num_heads * args.head_dim +
+                         head_idx * args.head_dim;
+
+  for (uint d = lid; d < args.head_dim; d += threadgroup_size) {
+    args.output[out_offset + d] = half(shared_acc[d] * inv_sum);
+  }
+}
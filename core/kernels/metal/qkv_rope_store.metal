@@ -0,0 +1,205 @@
+/**
+ * @file qkv_rope_store.metal
+ * @brief Fused QKV projection + RoPE + paged KV block write kernel
+ *
+ * Front half of the FlashAttention-style prefill fusion:
+ * 1. Project input X against the Q/K/V weight matrices (one GEMV per
+ *    token/head row, fp32 accumulation)
+ * 2. Apply RoPE to Q and K rows in threadgroup memory, before the
+ *    unrotated values ever reach device memory
+ * 3. Stream K and V rows directly into the destination paged cache
+ *    blocks via the page table
+ *
+ * Outputs are the rotated Q/K and V tensors for the attention back
+ * half (attention_prefill_fused with inputs_rotated=true), which then
+ * skips its own per-pair RoPE and cache stores. Compared to separate
+ * MLX matmuls this removes three intermediate tensor materializations
+ * per layer and the O(seq_len^2) re-rotation of K inside attention.
+ *
+ * Features:
+ * - fp16 weights/activations with fp32 accumulation
+ * - Grouped Query Attention (num_kv_heads <= num_heads)
+ * - Zero-copy block format [pages, layers, block_size, kv_heads, dim]
+ */
+
+#include <metal_stdlib>
+using namespace metal;
+
+/**
+ * @brief Apply RoPE to one head row held in threadgroup memory
+ *
+ * Same pair rotation as attention_prefill.metal, operating on the
+ * freshly projected row before it is written anywhere.
+ */
+inline void rotate_row(
+    threadgroup float* row,
+    device const half* cos_table,
+    device const half* sin_table,
+    uint token_pos,
+    uint head_dim) {
+
+  for (uint d = 0; d < head_dim / 2; d++) {
+    uint even_idx = d * 2;
+    uint odd_idx = d * 2 + 1;
+
+    uint rope_idx = token_pos * (head_dim / 2) + d;
+    float cos_val = float(cos_table[rope_idx]);
+    float sin_val = float(sin_table[rope_idx]);
+
+    float x_even = row[even_idx];
+    float x_odd = row[odd_idx];
+
+    row[even_idx] = x_even * cos_val - x_odd * sin_val;
+    row[odd_idx] = x_odd * cos_val + x_even * sin_val;
+  }
+}
+
+/**
+ * @brief Fused QKV projection + RoPE + KV block write
+ *
+ * Grid layout:
+ *   - X: batch * seq_len * (num_heads + 2 * num_kv_heads)
+ *     One threadgroup per output head row. Row slots are ordered
+ *     [Q heads][K heads][V heads] per token.
+ *
+ * Threadgroup layout:
+ *   - Threads cooperatively load the token's input row into shared
+ *     memory, then each thread computes a stride of output dims as
+ *     dot products over hidden_size.
+ *
+ * Threadgroup memory:
+ *   - shared_x:   hidden_size halfs (input row, loaded once)
+ *   - shared_row: head_dim floats (projected row, rotated in place)
+ */
+kernel void qkv_rope_store(
+    device const half* x [[buffer(0)]],          // [batch, seq_len, hidden]
+    device const half* wq [[buffer(1)]],         // [num_heads*head_dim, hidden]
+    device const half* wk [[buffer(2)]],         // [num_kv_heads*head_dim, hidden]
+    device const half* wv [[buffer(3)]],         // [num_kv_heads*head_dim, hidden]
+    device const half* rope_cos [[buffer(4)]],   // [max_seq_len, head_dim/2]
+    device const half* rope_sin [[buffer(5)]],   // [max_seq_len, head_dim/2]
+    device half* q_out [[buffer(6)]],            // [batch, seq_len, num_heads, head_dim]
+    device half* k_out [[buffer(7)]],            // [batch, seq_len, num_kv_heads, head_dim]
+    device half* v_out [[buffer(8)]],            // [batch, seq_len, num_kv_heads, head_dim]
+    device half* k_cache [[buffer(9)]],          // block or stacked format
+    device half* v_cache [[buffer(10)]],         // block or stacked format
+    device const int* page_table [[buffer(11)]], // [batch, max_blocks_per_seq]
+    constant uint& batch_size [[buffer(12)]],
+    constant uint& seq_len [[buffer(13)]],
+    constant uint& hidden_size [[buffer(14)]],
+    constant uint& num_heads [[buffer(15)]],
+    constant uint& num_kv_heads [[buffer(16)]],
+    constant uint& head_dim [[buffer(17)]],
+    constant uint& block_size [[buffer(18)]],
+    constant uint& max_blocks_per_seq [[buffer(19)]],
+    constant uint& num_layers [[buffer(20)]],
+    constant uint& layer_idx [[buffer(21)]],
+    constant bool& use_block_format [[buffer(22)]],
+    constant uint& position_offset [[buffer(23)]],
+    uint gid [[threadgroup_position_in_grid]],
+    uint lid [[thread_position_in_threadgroup]],
+    uint threadgroup_size [[threads_per_threadgroup]],
+    threadgroup half* shared_x [[threadgroup(0)]],
+    threadgroup float* shared_row [[threadgroup(1)]]) {
+
+  const uint rows_per_token = num_heads + 2 * num_kv_heads;
+  const uint total_rows = batch_size * seq_len * rows_per_token;
+  if (gid >= total_rows) {
+    return;
+  }
+
+  const uint batch_idx = gid / (seq_len * rows_per_token);
+  const uint token_idx = (gid / rows_per_token) % seq_len;
+  const uint row_slot = gid % rows_per_token;
+
+  // Decode which projection this row belongs to
+  // 0 = Q, 1 = K, 2 = V
+  uint proj;
+  uint head_idx;
+  if (row_slot < num_heads) {
+    proj = 0;
+    head_idx = row_slot;
+  } else if (row_slot < num_heads + num_kv_heads) {
+    proj = 1;
+    head_idx = row_slot - num_heads;
+  } else {
+    proj = 2;
+    head_idx = row_slot - num_heads - num_kv_heads;
+  }
+
+  // Cooperatively load the token's input row once
+  device const half* x_row =
+      x + (batch_idx * seq_len + token_idx) * hidden_size;
+  for (uint i = lid; i < hidden_size; i += threadgroup_size) {
+    shared_x[i] = x_row[i];
+  }
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+
+  // GEMV: each thread computes a stride of the head row. Weight rows
+  // are [out_features, hidden] so row (head_idx*head_dim + d) is the
+  // filter for output dim d.
+  device const half* w = (proj == 0) ? wq : ((proj == 1) ? wk : wv);
+  for (uint d = lid; d < head_dim; d += threadgroup_size) {
+    device const half* w_row = w + (head_idx * head_dim + d) * hidden_size;
+    float accum = 0.0f;
+    for (uint i = 0; i < hidden_size; i++) {
+      accum += float(shared_x[i]) * float(w_row[i]);
+    }
+    shared_row[d] = accum;
+  }
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+
+  // Rotate Q and K in-register before anything is materialized
+  const uint abs_position = position_offset + token_idx;
+  if (proj != 2 && lid == 0) {
+    rotate_row(shared_row, rope_cos, rope_sin, abs_position, head_dim);
+  }
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+
+  // Write the (rotated) row to its output tensor
+  if (proj == 0) {
+    device half* out = q_out +
+        (batch_idx * seq_len + token_idx) * num_heads * head_dim +
+        head_idx * head_dim;
+    for (uint d = lid; d < head_dim; d += threadgroup_size) {
+      out[d] = half(shared_row[d]);
+    }
+    return;
+  }
+
+  device half* out = ((proj == 1) ? k_out : v_out) +
+      (batch_idx * seq_len + token_idx) * num_kv_heads * head_dim +
+      head_idx * head_dim;
+  for (uint d = lid; d < head_dim; d += threadgroup_size) {
+    out[d] = half(shared_row[d]);
+  }
+
+  // Stream K/V directly into the destination cache block
+  const uint cache_token = abs_position;
+  const uint block_idx = cache_token / block_size;
+  const uint block_offset = cache_token % block_size;
+  const int page_id =
+      page_table[batch_idx * max_blocks_per_seq + block_idx];
+  if (page_id < 0) {
+    return;
+  }
+
+  uint cache_offset;
+  if (use_block_format) {
+    // Block format: [num_pages, num_layers, block_size, kv_heads, dim]
+    cache_offset =
+        page_id * num_layers * block_size * num_kv_heads * head_dim +
+        layer_idx * block_size * num_kv_heads * head_dim +
+        block_offset * num_kv_heads * head_dim + head_idx * head_dim;
+  } else {
+    // Stacked format (legacy): [num_pages, block_size, kv_heads, dim]
+    cache_offset = page_id * block_size * num_kv_heads * head_dim +
+                   block_offset * num_kv_heads * head_dim +
+                   head_idx * head_dim;
+  }
+
+  device half* cache = ((proj == 1) ? k_cache : v_cache) + cache_offset;
+  for (uint d = lid; d < head_dim; d += threadgroup_size) {
+    cache[d] = half(shared_row[d]);
+  }
+}
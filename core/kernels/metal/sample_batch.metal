@@ -0,0 +1,376 @@
+/**
+ * @file sample_batch.metal
+ * @brief Fused batched sampling kernel (temperature / top-k / top-p)
+ *
+ * Samples one token per decode-batch row entirely on the GPU, fusing:
+ * 1. Repetition penalty (scatter over the row's context token IDs)
+ * 2. Top-k candidate extraction (iterative argmax with knockout)
+ * 3. Temperature-scaled softmax over the candidate set
+ * 4. Top-p (nucleus) truncation of the candidate distribution
+ * 5. Categorical sampling with a host-provided uniform random draw
+ *
+ * Without this kernel, every decode step copies a full logits row
+ * (vocab_size * 4 bytes, ~128KB for a 32K vocab) back to the host per
+ * sequence and samples on the CPU. The fused kernel returns only one
+ * int32 token ID per row, removing that host-device sync from the
+ * hottest loop in the system.
+ *
+ * Candidate cap: top-k is limited to kMaxCandidates (64). When top-p is
+ * requested without top-k, the nucleus is computed over the top 64
+ * logits; for trained LLMs the nucleus mass is overwhelmingly inside
+ * the top 64, so this truncation matches CPU sampling in practice.
+ * Rows that need exact full-vocab sampling (e.g. min_p) stay on the
+ * CPU path — see Sampler::sample_batch.
+ *
+ * NOTE: The kernel destroys the logits buffer (penalty scatter +
+ * argmax knockout writes -INF into selected slots). Sampling must be
+ * the last consumer of the logits, which it is in the decode loop.
+ */
+
+#include <metal_stdlib>
+using namespace metal;
+
+/// Maximum candidates retained per row (upper bound for top-k).
+constant uint kMaxCandidates = 64;
+
+/**
+ * @brief Per-row sampling parameters
+ *
+ * Must match RowSamplingParams in sample_batch_primitive.h
+ * (16-byte aligned, plain scalar fields only).
+ */
+struct SampleRowParams {
+  float temperature;        // 0 = greedy
+  int top_k;                // 0 = disabled (greedy unless top_p set)
+  float top_p;              // 0 = disabled
+  float repetition_penalty; // 1 = disabled
+  float uniform;            // pre-drawn U(0,1) for this row
+  float pad0;
+  float pad1;
+  float pad2;
+};
+
+/**
+ * @brief Fused batched sampling kernel
+ *
+ * One threadgroup per batch row. Threads cooperatively apply the
+ * repetition penalty, then extract up to kMaxCandidates candidates by
+ * repeated parallel argmax (knocking out each selected logit with
+ * -INF). Thread 0 finishes with softmax + nucleus truncation +
+ * categorical draw over the small candidate set.
+ *
+ * @param logits Logits [batch, vocab_size], modified in place
+ * @param params Per-row sampling parameters [batch]
+ * @param penalty_tokens Flattened unique context token IDs for all rows
+ * @param penalty_offsets Row ranges into penalty_tokens [batch + 1]
+ * @param out_tokens Sampled token ID per row [batch]
+ * @param vocab_size Vocabulary size
+ * @param gid Threadgroup position in grid (batch row)
+ * @param lid Thread position in threadgroup
+ * @param threadgroup_size Threads per threadgroup
+ * @param scratch Threadgroup memory, 2 * threadgroup_size floats:
+ *        [0, tg_size) reduction values, [tg_size, 2*tg_size) indices
+ */
+kernel void sample_batch_fused(
+    device float* logits [[buffer(0)]],
+    device const SampleRowParams* params [[buffer(1)]],
+    device const int* penalty_tokens [[buffer(2)]],
+    device const int* penalty_offsets [[buffer(3)]],
+    device int* out_tokens [[buffer(4)]],
+    constant uint& vocab_size [[buffer(5)]],
+    uint gid [[threadgroup_position_in_grid]],
+    uint lid [[thread_position_in_threadgroup]],
+    uint threadgroup_size [[threads_per_threadgroup]],
+    threadgroup float* scratch [[threadgroup(0)]]) {
+
+  device float* row = logits + gid * vocab_size;
+  const SampleRowParams p = params[gid];
+
+  threadgroup float* tg_val = scratch;
+  threadgroup float* tg_idx = scratch + threadgroup_size;
+
+  // Candidate set (small, thread 0 consumes it after extraction)
+  threadgroup float cand_val[kMaxCandidates];
+  threadgroup uint cand_idx[kMaxCandidates];
+  threadgroup uint num_extracted;
+
+  // Phase 1: repetition penalty, scattered over the row's context IDs.
+  // Token lists are deduplicated on the host so each ID is hit once.
+  if (p.repetition_penalty != 1.0f) {
+    int begin = penalty_offsets[gid];
+    int end = penalty_offsets[gid + 1];
+    for (int t = begin + int(lid); t < end; t += int(threadgroup_size)) {
+      uint idx = uint(penalty_tokens[t]);
+      if (idx < vocab_size) {
+        float v = row[idx];
+        row[idx] = (v > 0.0f) ? v / p.repetition_penalty
+                              : v * p.repetition_penalty;
+      }
+    }
+  }
+  threadgroup_barrier(mem_flags::mem_device);
+
+  // Candidate budget: greedy needs 1; top-k caps at kMaxCandidates;
+  // top-p without top-k uses the full candidate cap.
+  bool greedy = (p.temperature <= 0.0f) || (p.top_k == 0 && p.top_p <= 0.0f);
+  uint budget;
+  if (greedy) {
+    budget = 1;
+  } else if (p.top_k > 0) {
+    budget = min(uint(p.top_k), kMaxCandidates);
+  } else {
+    budget = kMaxCandidates;
+  }
+  budget = min(budget, vocab_size);
+
+  // Phase 2: extract candidates by iterative parallel argmax.
+  // Candidates come out sorted descending by construction.
+  if (lid == 0) {
+    num_extracted = 0;
+  }
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+
+  for (uint c = 0; c < budget; c++) {
+    // Local argmax over this thread's strided slice
+    float best = -INFINITY;
+    uint best_idx = 0;
+    for (uint i = lid; i < vocab_size; i += threadgroup_size) {
+      float v = row[i];
+      if (v > best) {
+        best = v;
+        best_idx = i;
+      }
+    }
+    tg_val[lid] = best;
+    tg_idx[lid] = float(best_idx);
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    // Tree reduction to the global argmax
+    for (uint stride = threadgroup_size / 2; stride > 0; stride >>= 1) {
+      if (lid < stride && tg_val[lid + stride] > tg_val[lid]) {
+        tg_val[lid] = tg_val[lid + stride];
+        tg_idx[lid] = tg_idx[lid + stride];
+      }
+      threadgroup_barrier(mem_flags::mem_threadgroup);
+    }
+
+    if (tg_val[0] == -INFINITY) {
+      break;  // Row exhausted (vocab smaller than budget)
+    }
+
+    if (lid == 0) {
+      cand_val[c] = tg_val[0];
+      cand_idx[c] = uint(tg_idx[0]);
+      num_extracted = c + 1;
+      // Knock out the winner so the next iteration finds the runner-up
+      row[uint(tg_idx[0])] = -INFINITY;
+    }
+    threadgroup_barrier(mem_flags::mem_device);
+  }
+
+  // Phase 3: softmax + nucleus truncation + categorical draw (thread 0)
+  if (lid != 0) {
+    return;
+  }
+
+  uint n = num_extracted;
+  if (n == 0) {
+    out_tokens[gid] = 0;
+    return;
+  }
+
+  if (greedy) {
+    out_tokens[gid] = int(cand_idx[0]);
+    return;
+  }
+
+  // Temperature-scaled softmax, numerically anchored at the max logit
+  float max_val = cand_val[0];
+  float inv_temp = 1.0f / p.temperature;
+  float probs[kMaxCandidates];
+  float sum = 0.0f;
+  for (uint c = 0; c < n; c++) {
+    float e = exp((cand_val[c] - max_val) * inv_temp);
+    probs[c] = e;
+    sum += e;
+  }
+
+  // Nucleus truncation: keep the smallest prefix whose cumulative
+  // probability reaches top_p (candidates are sorted descending)
+  uint keep = n;
+  if (p.top_p > 0.0f && p.top_p < 1.0f) {
+    float cum = 0.0f;
+    for (uint c = 0; c < n; c++) {
+      cum += probs[c] / sum;
+      if (cum >= p.top_p) {
+        keep = c + 1;
+        break;
+      }
+    }
+  }
+
+  // Categorical draw over the kept prefix (implicit renormalization:
+  // scale the uniform by the kept mass instead of dividing each prob)
+  float kept_sum = 0.0f;
+  for (uint c = 0; c < keep; c++) {
+    kept_sum += probs[c];
+  }
+  float r = p.uniform * kept_sum;
+  float acc = 0.0f;
+  uint selected = keep - 1;
+  for (uint c = 0; c < keep; c++) {
+    acc += probs[c];
+    if (r <= acc) {
+      selected = c;
+      break;
+    }
+  }
+  out_tokens[gid] = int(cand_idx[selected]);
+}
+
+/**
+ * @brief FP16 logits variant
+ *
+ * Same algorithm with half-precision logits; penalty scatter, argmax
+ * comparison and softmax all run in fp32 for numerical stability.
+ */
+kernel void sample_batch_fused_fp16(
+    device half* logits [[buffer(0)]],
+    device const SampleRowParams* params [[buffer(1)]],
+    device const int* penalty_tokens [[buffer(2)]],
+    device const int* penalty_offsets [[buffer(3)]],
+    device int* out_tokens [[buffer(4)]],
+    constant uint& vocab_size [[buffer(5)]],
+    uint gid [[threadgroup_position_in_grid]],
+    uint lid [[thread_position_in_threadgroup]],
+    uint threadgroup_size [[threads_per_threadgroup]],
+    threadgroup float* scratch [[threadgroup(0)]]) {
+
+  device half* row = logits + gid * vocab_size;
+  const SampleRowParams p = params[gid];
+
+  threadgroup float* tg_val = scratch;
+  threadgroup float* tg_idx = scratch + threadgroup_size;
+
+  threadgroup float cand_val[kMaxCandidates];
+  threadgroup uint cand_idx[kMaxCandidates];
+  threadgroup uint num_extracted;
+
+  if (p.repetition_penalty != 1.0f) {
+    int begin = penalty_offsets[gid];
+    int end = penalty_offsets[gid + 1];
+    for (int t = begin + int(lid); t < end; t += int(threadgroup_size)) {
+      uint idx = uint(penalty_tokens[t]);
+      if (idx < vocab_size) {
+        float v = float(row[idx]);
+        row[idx] = half((v > 0.0f) ? v / p.repetition_penalty
+                                   : v * p.repetition_penalty);
+      }
+    }
+  }
+  threadgroup_barrier(mem_flags::mem_device);
+
+  bool greedy = (p.temperature <= 0.0f) || (p.top_k == 0 && p.top_p <= 0.0f);
+  uint budget;
+  if (greedy) {
+    budget = 1;
+  } else if (p.top_k > 0) {
+    budget = min(uint(p.top_k), kMaxCandidates);
+  } else {
+    budget = kMaxCandidates;
+  }
+  budget = min(budget, vocab_size);
+
+  if (lid == 0) {
+    num_extracted = 0;
+  }
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+
+  for (uint c = 0; c < budget; c++) {
+    float best = -INFINITY;
+    uint best_idx = 0;
+    for (uint i = lid; i < vocab_size; i += threadgroup_size) {
+      float v = float(row[i]);
+      if (v > best) {
+        best = v;
+        best_idx = i;
+      }
+    }
+    tg_val[lid] = best;
+    tg_idx[lid] = float(best_idx);
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+
+    for (uint stride = threadgroup_size / 2; stride > 0; stride >>= 1) {
+      if (lid < stride && tg_val[lid + stride] > tg_val[lid]) {
+        tg_val[lid] = tg_val[lid + stride];
+        tg_idx[lid] = tg_idx[lid + stride];
+      }
+      threadgroup_barrier(mem_flags::mem_threadgroup);
+    }
+
+    if (tg_val[0] == -INFINITY) {
+      break;
+    }
+
+    if (lid == 0) {
+      cand_val[c] = tg_val[0];
+      cand_idx[c] = uint(tg_idx[0]);
+      num_extracted = c + 1;
+      row[uint(tg_idx[0])] = half(-INFINITY);
+    }
+    threadgroup_barrier(mem_flags::mem_device);
+  }
+
+  if (lid != 0) {
+    return;
+  }
+
+  uint n = num_extracted;
+  if (n == 0) {
+    out_tokens[gid] = 0;
+    return;
+  }
+
+  if (greedy) {
+    out_tokens[gid] = int(cand_idx[0]);
+    return;
+  }
+
+  float max_val = cand_val[0];
+  float inv_temp = 1.0f / p.temperature;
+  float probs[kMaxCandidates];
+  float sum = 0.0f;
+  for (uint c = 0; c < n; c++) {
+    float e = exp((cand_val[c] - max_val) * inv_temp);
+    probs[c] = e;
+    sum += e;
+  }
+
+  uint keep = n;
+  if (p.top_p > 0.0f && p.top_p < 1.0f) {
+    float cum = 0.0f;
+    for (uint c = 0; c < n; c++) {
+      cum += probs[c] / sum;
+      if (cum >= p.top_p) {
+        keep = c + 1;
+        break;
+      }
+    }
+  }
+
+  float kept_sum = 0.0f;
+  for (uint c = 0; c < keep; c++) {
+    kept_sum += probs[c];
+  }
+  float r = p.uniform * kept_sum;
+  float acc = 0.0f;
+  uint selected = keep - 1;
+  for (uint c = 0; c < keep; c++) {
+    acc += probs[c];
+    if (r <= acc) {
+      selected = c;
+      break;
+    }
+  }
+  out_tokens[gid] = int(cand_idx[selected]);
+}
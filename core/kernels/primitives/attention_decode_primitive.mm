@@ -7,6 +7,13 @@
 
 #include "attention_decode_primitive.h"
 
+#include "../kernel_profiler.h"
+#include "../kernel_tuning.h"
+#include "cpu/neon_kernels.h"
+#include "pipeline_archive.h"
+
+#include <algorithm>
+
 #include <mlx/ops.h>
 #include <mlx/allocator.h>
 #include <mlx/backend/metal/device.h>
@@ -191,13 +198,18 @@ void AttentionDecodePrimitive::eval_cpu(
       continue;
     }
 
-    // Process each query head
+    // Process each query head. The dot/softmax/axpy hot loops go through
+    // the vectorized NEON kernels; each cached token's K/V row for one
+    // head is contiguous in the paged block layout, so the per-token
+    // indexing stays scalar while the head_dim work vectorizes.
     for (int h = 0; h < num_heads_; h++) {
       int kv_h = h / (num_heads_ / num_kv_heads_);  // GQA mapping
 
+      const float* q_row = q.data<float>() +
+                           b * num_heads_ * head_dim_ + h * head_dim_;
+
       // Compute attention scores for all past tokens
       std::vector<float> scores(seq_len);
-      float max_score = -std::numeric_limits<float>::infinity();
 
       for (int t = 0; t < seq_len; t++) {
         int block_idx = t / block_size_;
@@ -209,59 +221,38 @@ void AttentionDecodePrimitive::eval_cpu(
           continue;
         }
 
-        // Compute Q @ K^T
-        float score = 0.0f;
-        for (int d = 0; d < head_dim_; d++) {
-          int q_idx = b * num_heads_ * head_dim_ + h * head_dim_ + d;
-          int k_idx = page_id * block_size_ * num_kv_heads_ * head_dim_ +
-                     block_offset * num_kv_heads_ * head_dim_ +
-                     kv_h * head_dim_ + d;
-
-          float q_val = q.data<float>()[q_idx];
-          float k_val = k_cache.data<float>()[k_idx];
-          score += q_val * k_val;
-        }
-
-        score *= scale;
-        scores[t] = score;
-        max_score = std::max(max_score, score);
-      }
-
-      // Softmax: exp and normalize
-      float sum_exp = 0.0f;
-      for (int t = 0; t < seq_len; t++) {
-        scores[t] = std::exp(scores[t] - max_score);
-        sum_exp += scores[t];
-      }
+        const float* k_row =
+            k_cache.data<float>() +
+            page_id * block_size_ * num_kv_heads_ * head_dim_ +
+            block_offset * num_kv_heads_ * head_dim_ + kv_h * head_dim_;
 
-      float inv_sum = 1.0f / (sum_exp + 1e-8f);
-      for (int t = 0; t < seq_len; t++) {
-        scores[t] *= inv_sum;
+        scores[t] = cpu::dot(q_row, k_row, head_dim_) * scale;
       }
 
-      // Compute context = softmax(scores) @ V
-      for (int d = 0; d < head_dim_; d++) {
-        float accum = 0.0f;
-
-        for (int t = 0; t < seq_len; t++) {
-          int block_idx = t / block_size_;
-          int block_offset = t % block_size_;
-          int page_id = page_table.data<int>()[b * max_blocks_per_seq_ + block_idx];
+      // Numerically stable softmax (unmapped pages exp to zero weight)
+      cpu::softmax(scores.data(), seq_len);
 
-          if (page_id < 0) {
-            continue;
-          }
+      // Compute context = softmax(scores) @ V, accumulating one V row
+      // at a time so each pass is a contiguous vectorized axpy
+      float* out_row = output.data<float>() +
+                       b * num_heads_ * head_dim_ + h * head_dim_;
+      std::fill(out_row, out_row + head_dim_, 0.0f);
 
-          int v_idx = page_id * block_size_ * num_kv_heads_ * head_dim_ +
-                     block_offset * num_kv_heads_ * head_dim_ +
-                     kv_h * head_dim_ + d;
+      for (int t = 0; t < seq_len; t++) {
+        int block_idx = t / block_size_;
+        int block_offset = t % block_size_;
+        int page_id = page_table.data<int>()[b * max_blocks_per_seq_ + block_idx];
 
-          float v_val = v_cache.data<float>()[v_idx];
-          accum += scores[t] * v_val;
+        if (page_id < 0) {
+          continue;
         }
 
-        int out_idx = b * num_heads_ * head_dim_ + h * head_dim_ + d;
-        output.data<float>()[out_idx] = accum;
+        const float* v_row =
+            v_cache.data<float>() +
+            page_id * block_size_ * num_kv_heads_ * head_dim_ +
+            block_offset * num_kv_heads_ * head_dim_ + kv_h * head_dim_;
+
+        cpu::axpy(scores[t], v_row, out_row, head_dim_);
       }
     }
   }
@@ -309,12 +300,31 @@ void AttentionDecodePrimitive::eval_gpu(
   // Load our custom Metal library
   auto* mtl_lib = static_cast<MTL::Library*>(load_metal_library());
 
-  // For Phase 1, use single general-purpose kernel
-  // Phase 2 will add optimized variants for different head dimensions
-  std::string kernel_name = "attention_decode_fused";
+  // Kernel selection: for the head ratios the fleet ships (8:1, 4:1 GQA
+  // and 1:1 MHA) dispatch the function-constant specialized group kernel,
+  // which runs one threadgroup per KV-head group and reads each cached
+  // K/V element once per group instead of once per query head. Other
+  // layouts fall back to the generic per-query-head kernel.
+  const int gqa_group =
+      attention_decode_gqa_group_size(num_heads_, num_kv_heads_);
+  const bool use_gqa_variant = gqa_group > 0;
+  std::string kernel_name =
+      use_gqa_variant ? "attention_decode_gqa" : "attention_decode_fused";
+
+  // The group mapping and head_dim are resolved at pipeline-compile time
+  // via function constants; each (group, head_dim) pair is archived as its
+  // own pipeline
+  std::vector<std::pair<int, unsigned int>> specialization;
+  if (use_gqa_variant) {
+    specialization = {{0, static_cast<unsigned int>(gqa_group)},
+                      {1, static_cast<unsigned int>(head_dim_)}};
+  }
 
-  // Get compiled kernel from MLX's device (this caches it)
-  auto* kernel = d.get_kernel(kernel_name, mtl_lib);
+  // Create the pipeline through the binary-archive cache so PSO compilation
+  // is a one-time cost per metallib build, persisted across daemon restarts
+  auto* kernel = static_cast<MTL::ComputePipelineState*>(get_archived_pipeline(
+      d.mtl_device(), mtl_lib, "attention_decode", kernel_name,
+      specialization));
 
   // Get MLX's command encoder and set pipeline
   auto& compute_encoder = d.get_command_encoder(s.index);
@@ -347,29 +357,48 @@ void AttentionDecodePrimitive::eval_gpu(
   compute_encoder.set_bytes(static_cast<uint32_t>(sliding_window_size_), 17);
 
   // Dispatch configuration
-  // Each threadgroup handles one query head
-  size_t num_threadgroups = batch_size * num_heads_;
-  size_t threads_per_group = 256;  // Configurable, but 256 is good default
+  // Generic kernel: one threadgroup per query head. GQA variant: one
+  // threadgroup per KV-head group (it writes all gqa_group heads)
+  size_t num_threadgroups = use_gqa_variant
+                                ? batch_size * num_kv_heads_
+                                : batch_size * num_heads_;
+  // Width is tunable; the autotuner installs per-GPU winners at model load
+  size_t threads_per_group = static_cast<size_t>(tuned_threadgroup_width(
+      kernel_name,
+      use_gqa_variant
+          ? attention_decode_gqa_shape_key(gqa_group, head_dim_, block_size_)
+          : attention_decode_shape_key(head_dim_, block_size_),
+      256));
 
   MTL::Size grid_dims(num_threadgroups, 1, 1);
   MTL::Size group_dims(threads_per_group, 1, 1);
 
-  NSLog(@"[AttentionDecode] Dispatch params: batch=%d, heads=%d, kv_heads=%d, head_dim=%d",
-        batch_size, num_heads_, num_kv_heads_, head_dim_);
+  NSLog(@"[AttentionDecode] Dispatch params: kernel=%s, batch=%d, heads=%d, kv_heads=%d, head_dim=%d",
+        kernel_name.c_str(), batch_size, num_heads_, num_kv_heads_, head_dim_);
   NSLog(@"[AttentionDecode] Grid dims: (%zu, %zu, %zu), Group dims: (%zu, %zu, %zu)",
         grid_dims.width, grid_dims.height, grid_dims.depth,
         group_dims.width, group_dims.height, group_dims.depth);
 
   // Allocate threadgroup memory
-  // shared_scores: STRIPE_SIZE (64) * sizeof(float)
+  // shared_scores: STRIPE_SIZE (64) * sizeof(float), one row per group head
   // shared_reduce: threads_per_group * sizeof(float)
   size_t stripe_size = 64;
-  size_t shared_scores_size = stripe_size * sizeof(float);
+  size_t score_rows = use_gqa_variant ? static_cast<size_t>(gqa_group) : 1;
+  size_t shared_scores_size = score_rows * stripe_size * sizeof(float);
   size_t shared_reduce_size = threads_per_group * sizeof(float);
 
   compute_encoder.set_threadgroup_memory_length(shared_scores_size, 0);
   compute_encoder.set_threadgroup_memory_length(shared_reduce_size, 1);
 
+  if (use_gqa_variant) {
+    // GQA variant stages the group's queries and carries an unnormalized
+    // context accumulator per head across stripes
+    size_t shared_q_size = score_rows * head_dim_ * sizeof(uint16_t);
+    size_t shared_acc_size = score_rows * head_dim_ * sizeof(float);
+    compute_encoder.set_threadgroup_memory_length(shared_q_size, 2);
+    compute_encoder.set_threadgroup_memory_length(shared_acc_size, 3);
+  }
+
   NSLog(@"[AttentionDecode] Threadgroup memory: scores=%zu bytes, reduce=%zu bytes",
         shared_scores_size, shared_reduce_size);
 
@@ -462,6 +491,8 @@ mlx::core::array attention_decode_fused(
     int sliding_window_size,
     mlx::core::StreamOrDevice s) {
 
+  ScopedKernelTimer profile_timer("attention_decode_fused");
+
   // Validate inputs
   if (q.ndim() != 3) {
     throw std::invalid_argument("q must be 3-dimensional [batch, num_heads, head_dim]");
@@ -567,6 +598,8 @@ mlx::core::array attention_decode_fused(
        page_table_contig, seq_lengths_contig}  // inputs (contiguous)
   );
 
+  profile_timer.complete(outputs[0]);
+
   return outputs[0];
 }
 
@@ -62,13 +62,17 @@ class AttentionPrefillPrimitive : public mlx::core::Primitive {
    * @param use_block_format If true, cache is [pages, layers, ...]; if false,
    * [pages, ...]
    * @param position_offset Starting position for RoPE (default 0)
+   * @param inputs_rotated If true, Q/K already have RoPE applied and K/V
+   * are already stored in the cache (by the qkv_rope_store front half);
+   * the kernel skips its own rotation and cache writes
    */
   AttentionPrefillPrimitive(mlx::core::Stream stream, int num_heads,
                             int num_kv_heads, int head_dim, int hidden_size,
                             int block_size, int max_blocks_per_seq,
                             int num_layers = 0, int layer_idx = 0,
                             bool use_block_format = false,
-                            int position_offset = 0);
+                            int position_offset = 0,
+                            bool inputs_rotated = false);
 
   ~AttentionPrefillPrimitive() override;
 
@@ -146,6 +150,7 @@ class AttentionPrefillPrimitive : public mlx::core::Primitive {
   int layer_idx() const { return layer_idx_; }
   bool use_block_format() const { return use_block_format_; }
   int position_offset() const { return position_offset_; }
+  bool inputs_rotated() const { return inputs_rotated_; }
 
  private:
   int num_heads_;
@@ -158,6 +163,7 @@ class AttentionPrefillPrimitive : public mlx::core::Primitive {
   int layer_idx_;
   bool use_block_format_;
   int position_offset_;
+  bool inputs_rotated_;
 
   // Metal library (loaded lazily on first GPU eval)
   void* library_;  // Stores MTL::Library*
@@ -193,6 +199,8 @@ class AttentionPrefillPrimitive : public mlx::core::Primitive {
  * @param layer_idx Current layer index (for block format)
  * @param use_block_format If true, cache has layer dimension
  * @param position_offset Starting position for RoPE
+ * @param inputs_rotated If true, skip RoPE and cache stores (inputs come
+ * from the qkv_rope_store front half)
  * @param s Stream or device for execution
  * @return Context tensor [batch, seq_len, num_heads, head_dim]
  */
@@ -205,7 +213,8 @@ mlx::core::array attention_prefill_fused(
     const mlx::core::array& page_table, int num_heads, int num_kv_heads,
     int head_dim, int hidden_size, int block_size, int max_blocks_per_seq,
     int num_layers = 0, int layer_idx = 0, bool use_block_format = false,
-    int position_offset = 0, mlx::core::StreamOrDevice s = {});
+    int position_offset = 0, bool inputs_rotated = false,
+    mlx::core::StreamOrDevice s = {});
 
 }  // namespace kernels
 }  // namespace mlxr
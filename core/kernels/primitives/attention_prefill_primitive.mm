@@ -7,6 +7,9 @@
 
 #include "attention_prefill_primitive.h"
 
+#include "../kernel_profiler.h"
+#include "pipeline_archive.h"
+
 #include <mlx/ops.h>
 #include <mlx/allocator.h>
 #include <mlx/backend/metal/device.h>
@@ -33,7 +36,8 @@ AttentionPrefillPrimitive::AttentionPrefillPrimitive(
     int num_layers,
     int layer_idx,
     bool use_block_format,
-    int position_offset)
+    int position_offset,
+    bool inputs_rotated)
     : mlx::core::Primitive(stream),
       num_heads_(num_heads),
       num_kv_heads_(num_kv_heads),
@@ -45,6 +49,7 @@ AttentionPrefillPrimitive::AttentionPrefillPrimitive(
       layer_idx_(layer_idx),
       use_block_format_(use_block_format),
       position_offset_(position_offset),
+      inputs_rotated_(inputs_rotated),
       library_(nullptr) {
 }
 
@@ -298,21 +303,31 @@ void AttentionPrefillPrimitive::eval_gpu(
   // Load our custom Metal library
   auto* mtl_lib = static_cast<MTL::Library*>(load_metal_library());
 
-  // For Phase 1, use single general-purpose kernel
-  std::string kernel_name = "attention_prefill_fused";
+  // Prepare kernel arguments
+  int batch_size = q.shape(0);
+  int seq_len = q.shape(1);
+  float scale = 1.0f / std::sqrt(static_cast<float>(head_dim_));
 
-  // Get compiled kernel from MLX's device (this caches it)
-  auto* kernel = d.get_kernel(kernel_name, mtl_lib);
+  // Kernel selection: the fused kernel materializes the full score row
+  // in a fixed 64-slot threadgroup buffer, so it only covers contexts up
+  // to one stripe. Longer prefill chunks use the tiled streaming variant
+  // whose running max/sum renormalization keeps threadgroup memory
+  // O(tile) regardless of context length (32K prefill would otherwise
+  // need the score buffer to scale with the prompt).
+  constexpr int kStripeSize = 64;
+  bool use_tiled = seq_len > kStripeSize;
+  std::string kernel_name =
+      use_tiled ? "attention_prefill_tiled" : "attention_prefill_fused";
+
+  // Create the pipeline through the binary-archive cache so PSO compilation
+  // is a one-time cost per metallib build, persisted across daemon restarts
+  auto* kernel = static_cast<MTL::ComputePipelineState*>(get_archived_pipeline(
+      d.mtl_device(), mtl_lib, "attention_prefill", kernel_name));
 
   // Get MLX's command encoder and set pipeline
   auto& compute_encoder = d.get_command_encoder(s.index);
   compute_encoder.set_compute_pipeline_state(kernel);
 
-  // Prepare kernel arguments
-  int batch_size = q.shape(0);
-  int seq_len = q.shape(1);
-  float scale = 1.0f / std::sqrt(static_cast<float>(head_dim_));
-
   // Bind buffers
   compute_encoder.set_input_array(input, 0);
   compute_encoder.set_output_array(output, 1);
@@ -339,6 +354,7 @@ void AttentionPrefillPrimitive::eval_gpu(
   compute_encoder.set_bytes(use_block_format_, 20);                        // NEW
   compute_encoder.set_bytes(scale, 21);
   compute_encoder.set_bytes(static_cast<uint32_t>(position_offset_), 22);
+  compute_encoder.set_bytes(inputs_rotated_, 23);  // NEW
 
   // Dispatch configuration
   // Each threadgroup handles one query head for one token
@@ -355,23 +371,28 @@ void AttentionPrefillPrimitive::eval_gpu(
         group_dims.width, group_dims.height, group_dims.depth);
 
   // Allocate threadgroup memory
-  // shared_scores: 64 * sizeof(float) for stripe processing
+  // shared_scores: 64 * sizeof(float) for stripe/tile processing
   // shared_reduce: threads_per_group * sizeof(float) for reductions
   // shared_q: head_dim * sizeof(half) for Q storage
-  // shared_k: head_dim * sizeof(half) for K storage
+  // Slot 3 differs by kernel: the fused kernel keeps a K scratch buffer
+  // (head_dim halves) while the tiled kernel keeps the fp32 output
+  // accumulator there (head_dim floats) - K is rotated in registers
   size_t stripe_size = 64;
   size_t shared_scores_size = stripe_size * sizeof(float);
   size_t shared_reduce_size = threads_per_group * sizeof(float);
   size_t shared_q_size = head_dim_ * sizeof(uint16_t);  // half = 16-bit
-  size_t shared_k_size = head_dim_ * sizeof(uint16_t);
+  size_t shared_slot3_size = use_tiled
+      ? head_dim_ * sizeof(float)       // tiled: output accumulator
+      : head_dim_ * sizeof(uint16_t);   // fused: K scratch
 
   compute_encoder.set_threadgroup_memory_length(shared_scores_size, 0);
   compute_encoder.set_threadgroup_memory_length(shared_reduce_size, 1);
   compute_encoder.set_threadgroup_memory_length(shared_q_size, 2);
-  compute_encoder.set_threadgroup_memory_length(shared_k_size, 3);
+  compute_encoder.set_threadgroup_memory_length(shared_slot3_size, 3);
 
-  NSLog(@"[AttentionPrefill] Threadgroup memory: scores=%zu, reduce=%zu, q=%zu, k=%zu bytes",
-        shared_scores_size, shared_reduce_size, shared_q_size, shared_k_size);
+  NSLog(@"[AttentionPrefill] Threadgroup memory (%s): scores=%zu, reduce=%zu, q=%zu, slot3=%zu bytes",
+        kernel_name.c_str(), shared_scores_size, shared_reduce_size,
+        shared_q_size, shared_slot3_size);
 
   compute_encoder.dispatch_threadgroups(grid_dims, group_dims);
 
@@ -395,7 +416,7 @@ AttentionPrefillPrimitive::vmap(
       inputs[8],
       num_heads_, num_kv_heads_, head_dim_, hidden_size_,
       block_size_, max_blocks_per_seq_, num_layers_, layer_idx_,
-      use_block_format_, position_offset_,
+      use_block_format_, position_offset_, inputs_rotated_,
       stream());
 
   return {{out}, {axes[0]}};
@@ -414,7 +435,7 @@ std::vector<mlx::core::array> AttentionPrefillPrimitive::jvp(
       primals[8],
       num_heads_, num_kv_heads_, head_dim_, hidden_size_,
       block_size_, max_blocks_per_seq_, num_layers_, layer_idx_,
-      use_block_format_, position_offset_,
+      use_block_format_, position_offset_, inputs_rotated_,
       stream());
 
   return {out};  // Placeholder
@@ -441,7 +462,8 @@ bool AttentionPrefillPrimitive::is_equivalent(const mlx::core::Primitive& other)
          hidden_size_ == other_attn->hidden_size_ &&
          block_size_ == other_attn->block_size_ &&
          max_blocks_per_seq_ == other_attn->max_blocks_per_seq_ &&
-         position_offset_ == other_attn->position_offset_;
+         position_offset_ == other_attn->position_offset_ &&
+         inputs_rotated_ == other_attn->inputs_rotated_;
 }
 
 // ============================================================================
@@ -468,8 +490,11 @@ mlx::core::array attention_prefill_fused(
     int layer_idx,
     bool use_block_format,
     int position_offset,
+    bool inputs_rotated,
     mlx::core::StreamOrDevice s) {
 
+  ScopedKernelTimer profile_timer("attention_prefill_fused");
+
   // Validate inputs
   if (input.ndim() != 3) {
     throw std::invalid_argument("input must be 3-dimensional [batch, seq_len, hidden_size]");
@@ -614,7 +639,7 @@ mlx::core::array attention_prefill_fused(
   auto primitive = std::make_shared<AttentionPrefillPrimitive>(
       stream, num_heads, num_kv_heads, head_dim, hidden_size,
       block_size, max_blocks_per_seq, num_layers, layer_idx,
-      use_block_format, position_offset);
+      use_block_format, position_offset, inputs_rotated);
 
   // Create output array using MLX's array factory with primitive
   auto outputs = mlx::core::array::make_arrays(
@@ -626,6 +651,8 @@ mlx::core::array attention_prefill_fused(
        k_cache_contig, v_cache_contig, page_table_contig}  // inputs (contiguous)
   );
 
+  profile_timer.complete(outputs[0]);
+
   return outputs[0];
 }
 
@@ -0,0 +1,59 @@
+// Copyright © 2025 MLXR Development
+// Persistent Metal compute pipeline cache backed by MTLBinaryArchive
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mlxr {
+namespace kernels {
+
+/**
+ * Get (or create) a compute pipeline state for `kernel_name` from
+ * `mtl_library`, backed by an on-disk MTLBinaryArchive.
+ *
+ * MLX's Device::get_kernel only caches pipeline states per process, so
+ * every daemon restart re-runs the Metal backend compiler for each kernel
+ * variant before the first request can be served. This cache persists the
+ * compiled pipeline binaries under the MLXR cache directory
+ * (~/Library/Application Support/MLXRunner/cache/metal_archives, or
+ * $MLXR_CACHE_DIR/metal_archives when set), keyed by the metallib content
+ * hash and the GPU family. A restart then loads the pipelines from disk
+ * instead of recompiling; rebuilding a metallib or moving the cache to a
+ * different GPU changes the key and the archive is regenerated. Stale
+ * archives for the same library are pruned automatically.
+ *
+ * A corrupt or mismatched archive never fails the dispatch: creation falls
+ * back to a plain compile and the archive is rewritten.
+ *
+ * @param mtl_device MTL::Device* (cast to void*) from MLX's metal device
+ * @param mtl_library MTL::Library* (cast to void*) holding the kernel
+ * @param library_name Metallib base name (e.g. "rmsnorm"), used to locate
+ *                     the on-disk metallib for hashing and to name the archive
+ * @param kernel_name Compute function name within the library
+ * @return MTL::ComputePipelineState* cast to void*, retained for the
+ *         lifetime of the process. Thread-safe.
+ */
+void* get_archived_pipeline(void* mtl_device, void* mtl_library,
+                            const std::string& library_name,
+                            const std::string& kernel_name);
+
+/**
+ * Function-constant specialized overload. `uint_constants` is a list of
+ * (function_constant index, uint value) pairs resolved when the pipeline
+ * is created, e.g. the GQA group size and head_dim for
+ * attention_decode_gqa. Each distinct constant assignment is cached and
+ * archived as its own pipeline (the archive key appends the values to the
+ * kernel name), so a given specialization compiles once per metallib
+ * build and loads from disk on subsequent daemon starts like any other
+ * kernel.
+ */
+void* get_archived_pipeline(
+    void* mtl_device, void* mtl_library, const std::string& library_name,
+    const std::string& kernel_name,
+    const std::vector<std::pair<int, unsigned int>>& uint_constants);
+
+}  // namespace kernels
+}  // namespace mlxr
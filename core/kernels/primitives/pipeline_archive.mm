@@ -0,0 +1,332 @@
+// Copyright © 2025 MLXR Development
+// MTLBinaryArchive-backed pipeline cache shared by all custom kernel primitives
+//
+// We restart mlxrunnerd on every deploy, and pipeline-state creation for the
+// custom kernels happens lazily on the first dispatch of each primitive. With
+// per-process caching only (MLX's Device::get_kernel), that cold-start window
+// pays seconds of Metal PSO compilation while requests queue. This cache
+// creates the pipeline states itself through an MTLBinaryArchive persisted
+// under the MLXR cache directory so subsequent starts load compiled binaries
+// from disk. Archives are keyed by metallib content hash + GPU family: a
+// rebuilt metallib or a different GPU gets a fresh archive, and stale
+// archives for the same library are pruned.
+
+#include "pipeline_archive.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#import <Foundation/Foundation.h>
+#import <Metal/Metal.h>
+
+namespace mlxr {
+namespace kernels {
+
+namespace {
+
+// FNV-1a over the metallib contents; identifies the exact compiled library
+uint64_t hash_metallib(NSString* path) {
+  NSData* data = [NSData dataWithContentsOfFile:path];
+  if (!data) {
+    return 0;
+  }
+  uint64_t hash = 1469598103934665603ull;
+  const uint8_t* bytes = static_cast<const uint8_t*>([data bytes]);
+  for (NSUInteger i = 0; i < [data length]; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+NSString* archive_directory() {
+  const char* override_dir = getenv("MLXR_CACHE_DIR");
+  NSString* base;
+  if (override_dir != nullptr) {
+    base = @(override_dir);
+  } else {
+    base = [NSHomeDirectory() stringByAppendingPathComponent:
+        @"Library/Application Support/MLXRunner/cache"];
+  }
+  return [base stringByAppendingPathComponent:@"metal_archives"];
+}
+
+// Binary archives are only valid for the GPU they were compiled for, so the
+// device name and highest supported Apple GPU family go into the file name
+NSString* gpu_family_key(id<MTLDevice> device) {
+  int family = 0;
+  for (int f = 9; f >= 1; f--) {
+    if ([device supportsFamily:(MTLGPUFamily)(MTLGPUFamilyApple1 + f - 1)]) {
+      family = f;
+      break;
+    }
+  }
+  NSString* name = [[[device name] lowercaseString]
+      stringByReplacingOccurrencesOfString:@" " withString:@"-"];
+  return [NSString stringWithFormat:@"%@-apple%d", name, family];
+}
+
+// Same search order as the primitives' load_metal_library(); we only need
+// the path to hash the library contents for the archive key
+NSString* find_metallib(NSString* library_name) {
+  NSArray<NSString*>* search_paths = @[
+    [NSString stringWithFormat:@"build/lib/%@.metallib", library_name],
+    [NSString stringWithFormat:@"../../lib/%@.metallib", library_name],
+    [NSString stringWithFormat:@"../lib/%@.metallib", library_name],
+    [NSString stringWithFormat:@"lib/%@.metallib", library_name],
+    [NSString stringWithFormat:@"%s/build/lib/%@.metallib",
+                               getenv("PWD") ?: ".", library_name],
+  ];
+  for (NSString* path in search_paths) {
+    if ([[NSFileManager defaultManager] fileExistsAtPath:path]) {
+      return path;
+    }
+  }
+  return nil;
+}
+
+struct LibraryArchive {
+  void* archive = nullptr;  ///< id<MTLBinaryArchive> (owned, +1 from new*)
+  std::string path;         ///< On-disk .metalar location
+  bool loaded_from_disk = false;
+};
+
+class PipelineArchiveCache {
+ public:
+  static PipelineArchiveCache& instance() {
+    static PipelineArchiveCache cache;
+    return cache;
+  }
+
+  void* get(id<MTLDevice> device, id<MTLLibrary> library,
+            const std::string& library_name, const std::string& kernel_name,
+            const std::vector<std::pair<int, unsigned int>>& uint_constants);
+
+ private:
+  PipelineArchiveCache() = default;
+
+  LibraryArchive& archive_for(id<MTLDevice> device,
+                              const std::string& library_name);
+  void prune_stale(NSString* dir, NSString* library_name,
+                   NSString* current_file);
+
+  std::mutex mutex_;
+  // "<library>/<kernel>" -> MTL::ComputePipelineState* (retained for process)
+  std::unordered_map<std::string, void*> pipelines_;
+  std::unordered_map<std::string, LibraryArchive> archives_;
+};
+
+void PipelineArchiveCache::prune_stale(NSString* dir, NSString* library_name,
+                                       NSString* current_file) {
+  NSFileManager* fm = [NSFileManager defaultManager];
+  NSString* prefix = [library_name stringByAppendingString:@"-"];
+  for (NSString* entry in [fm contentsOfDirectoryAtPath:dir error:nil]) {
+    if ([entry hasPrefix:prefix] && [entry hasSuffix:@".metalar"] &&
+        ![entry isEqualToString:current_file]) {
+      [fm removeItemAtPath:[dir stringByAppendingPathComponent:entry]
+                     error:nil];
+      NSLog(@"[PipelineArchive] Pruned stale archive %@", entry);
+    }
+  }
+}
+
+LibraryArchive& PipelineArchiveCache::archive_for(
+    id<MTLDevice> device, const std::string& library_name) {
+  auto it = archives_.find(library_name);
+  if (it != archives_.end()) {
+    return it->second;
+  }
+
+  LibraryArchive la;
+  NSString* library_name_ns = @(library_name.c_str());
+  NSString* metallib_path = find_metallib(library_name_ns);
+
+  if (metallib_path) {
+    NSString* dir = archive_directory();
+    [[NSFileManager defaultManager] createDirectoryAtPath:dir
+                              withIntermediateDirectories:YES
+                                               attributes:nil
+                                                    error:nil];
+
+    NSString* file =
+        [NSString stringWithFormat:@"%@-%016llx-%@.metalar", library_name_ns,
+                                   hash_metallib(metallib_path),
+                                   gpu_family_key(device)];
+    NSString* path = [dir stringByAppendingPathComponent:file];
+    la.path = std::string([path UTF8String]);
+    prune_stale(dir, library_name_ns, file);
+
+    bool on_disk = [[NSFileManager defaultManager] fileExistsAtPath:path];
+    MTLBinaryArchiveDescriptor* desc =
+        [[MTLBinaryArchiveDescriptor alloc] init];
+    desc.url = on_disk ? [NSURL fileURLWithPath:path] : nil;
+    NSError* error = nil;
+    id<MTLBinaryArchive> archive =
+        [device newBinaryArchiveWithDescriptor:desc error:&error];
+    if (!archive && on_disk) {
+      // Corrupt archive on disk must not take the kernel down: start fresh
+      NSLog(@"[PipelineArchive] Failed to load %@ (%@), rebuilding", file,
+            error ? [error localizedDescription] : @"unknown error");
+      desc.url = nil;
+      error = nil;
+      archive = [device newBinaryArchiveWithDescriptor:desc error:&error];
+      on_disk = false;
+    }
+
+    la.archive = (__bridge void*)archive;
+    la.loaded_from_disk = (archive != nil) && on_disk;
+    if (la.loaded_from_disk) {
+      NSLog(@"[PipelineArchive] Loaded %@", file);
+    }
+  } else {
+    // Can't key the archive without the metallib on disk (library was loaded
+    // from a nonstandard path); fall back to plain pipeline creation
+    NSLog(@"[PipelineArchive] %@.metallib not found in standard paths; "
+          @"pipeline caching disabled for this library", library_name_ns);
+  }
+
+  return archives_.emplace(library_name, la).first->second;
+}
+
+void* PipelineArchiveCache::get(
+    id<MTLDevice> device, id<MTLLibrary> library,
+    const std::string& library_name, const std::string& kernel_name,
+    const std::vector<std::pair<int, unsigned int>>& uint_constants) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Each function-constant assignment is a distinct compiled pipeline, so
+  // the constant values join the cache (and archive) key
+  std::string variant_name = kernel_name;
+  for (const auto& [index, value] : uint_constants) {
+    variant_name += "_c" + std::to_string(index) + "v" + std::to_string(value);
+  }
+
+  std::string key = library_name + "/" + variant_name;
+  auto it = pipelines_.find(key);
+  if (it != pipelines_.end()) {
+    return it->second;
+  }
+
+  @autoreleasepool {
+    LibraryArchive& la = archive_for(device, library_name);
+    id<MTLBinaryArchive> archive = (__bridge id<MTLBinaryArchive>)la.archive;
+
+    id<MTLFunction> function = nil;
+    if (uint_constants.empty()) {
+      function = [library newFunctionWithName:@(kernel_name.c_str())];
+    } else {
+      MTLFunctionConstantValues* values =
+          [[MTLFunctionConstantValues alloc] init];
+      for (const auto& [index, value] : uint_constants) {
+        uint32_t constant = value;
+        [values setConstantValue:&constant
+                            type:MTLDataTypeUInt
+                         atIndex:index];
+      }
+      NSError* fn_error = nil;
+      function = [library newFunctionWithName:@(kernel_name.c_str())
+                               constantValues:values
+                                        error:&fn_error];
+      if (!function && fn_error) {
+        NSLog(@"[PipelineArchive] Specialization of %s failed: %@",
+              kernel_name.c_str(), [fn_error localizedDescription]);
+      }
+    }
+    if (!function) {
+      throw std::runtime_error("Kernel not found in " + library_name +
+                               ".metallib: " + variant_name);
+    }
+
+    MTLComputePipelineDescriptor* desc =
+        [[MTLComputePipelineDescriptor alloc] init];
+    desc.computeFunction = function;
+    desc.label = @(variant_name.c_str());
+
+    // FailOnBinaryArchiveMiss distinguishes a real archive hit from Metal's
+    // silent fallback compile, so we only re-serialize on genuine misses
+    NSError* error = nil;
+    id<MTLComputePipelineState> pipeline = nil;
+    bool from_archive = false;
+    if (la.loaded_from_disk) {
+      desc.binaryArchives = @[ archive ];
+      pipeline = [device
+          newComputePipelineStateWithDescriptor:desc
+                                        options:
+                                            MTLPipelineOptionFailOnBinaryArchiveMiss
+                                     reflection:nil
+                                          error:&error];
+      from_archive = (pipeline != nil);
+    }
+
+    if (!pipeline) {
+      desc.binaryArchives = nil;
+      error = nil;
+      pipeline = [device newComputePipelineStateWithDescriptor:desc
+                                                       options:MTLPipelineOptionNone
+                                                    reflection:nil
+                                                         error:&error];
+    }
+    if (!pipeline) {
+      NSString* err_msg =
+          error ? [error localizedDescription] : @"Unknown error";
+      throw std::runtime_error("Failed to create pipeline state for " +
+                               variant_name + ": " +
+                               std::string([err_msg UTF8String]));
+    }
+
+    // Harvest freshly compiled pipelines into the archive and persist so the
+    // next daemon start loads them from disk
+    if (archive && !from_archive && !la.path.empty()) {
+      NSError* archive_error = nil;
+      if (![archive addComputePipelineFunctionsWithDescriptor:desc
+                                                        error:&archive_error]) {
+        NSLog(@"[PipelineArchive] Failed to harvest %s: %@",
+              variant_name.c_str(),
+              archive_error ? [archive_error localizedDescription]
+                            : @"unknown error");
+      } else if (![archive
+                     serializeToURL:[NSURL fileURLWithPath:
+                                               @(la.path.c_str())]
+                              error:&archive_error]) {
+        NSLog(@"[PipelineArchive] Failed to serialize %s: %@",
+              la.path.c_str(),
+              archive_error ? [archive_error localizedDescription]
+                            : @"unknown error");
+      } else {
+        NSLog(@"[PipelineArchive] Archived %s/%s", library_name.c_str(),
+              variant_name.c_str());
+      }
+    }
+
+    // Pipeline is owned (+1 from new*) and kept for the life of the process,
+    // same as the primitives' cached MTL::Library handles
+    void* result = (__bridge void*)pipeline;
+    pipelines_.emplace(key, result);
+    return result;
+  }
+}
+
+}  // namespace
+
+void* get_archived_pipeline(void* mtl_device, void* mtl_library,
+                            const std::string& library_name,
+                            const std::string& kernel_name) {
+  return get_archived_pipeline(mtl_device, mtl_library, library_name,
+                               kernel_name, {});
+}
+
+void* get_archived_pipeline(
+    void* mtl_device, void* mtl_library, const std::string& library_name,
+    const std::string& kernel_name,
+    const std::vector<std::pair<int, unsigned int>>& uint_constants) {
+  id<MTLDevice> device = (__bridge id<MTLDevice>)mtl_device;
+  id<MTLLibrary> library = (__bridge id<MTLLibrary>)mtl_library;
+  return PipelineArchiveCache::instance().get(device, library, library_name,
+                                              kernel_name, uint_constants);
+}
+
+}  // namespace kernels
+}  // namespace mlxr
@@ -87,10 +87,13 @@ class QGemmDequantPrimitive : public mlx::core::Primitive {
    * @param quant_type Quantization format
    * @param group_size Elements per quantization group
    * @param has_bias Whether bias is present
+   * @param int8_activations Whether activations arrive as dynamically
+   *        quantized INT8 with per-row scales (inputs become
+   *        [input_q, input_scales, weights, bias?])
    */
   QGemmDequantPrimitive(mlx::core::Stream stream, int M, int N, int K,
                         QuantType quant_type, int group_size,
-                        bool has_bias = false);
+                        bool has_bias = false, bool int8_activations = false);
 
   ~QGemmDequantPrimitive() override;
 
@@ -164,6 +167,7 @@ class QGemmDequantPrimitive : public mlx::core::Primitive {
   QuantType quant_type() const { return quant_type_; }
   int group_size() const { return group_size_; }
   bool has_bias() const { return has_bias_; }
+  bool int8_activations() const { return int8_activations_; }
 
  public:
   /**
@@ -183,6 +187,7 @@ class QGemmDequantPrimitive : public mlx::core::Primitive {
   QuantType quant_type_;
   int group_size_;
   bool has_bias_;
+  bool int8_activations_;
 
   // Metal library (loaded lazily on first GPU eval)
   void* library_;  // Stores MTL::Library*
@@ -214,6 +219,35 @@ mlx::core::array q_gemm_dequant(const mlx::core::array& input,
                                 const mlx::core::array* bias = nullptr,
                                 mlx::core::StreamOrDevice s = {});
 
+/**
+ * Quantized GEMM with dynamic INT8 activation quantization
+ *
+ * Quantizes the fp16 activations per row to INT8 on-GPU (absmax scales:
+ * scale[m] = absmax(X[m, :]) / 127) and dispatches the int8 kernel
+ * variant, which streams half the activation bytes of the fp16 path.
+ * On memory-bandwidth-bound decode this is a direct throughput win;
+ * accuracy impact is bounded by the per-row absmax scheme.
+ *
+ * Same signature and semantics as q_gemm_dequant otherwise.
+ *
+ * @param input Input tensor [M, K] (fp16; quantized internally)
+ * @param weights Quantized weight tensor (format-specific size)
+ * @param M Number of input rows
+ * @param N Number of output columns
+ * @param K Number of input columns
+ * @param quant_type Weight quantization format
+ * @param group_size Elements per weight quantization group
+ * @param bias Optional bias tensor [N] (fp16)
+ * @param s Stream or device for execution
+ * @return Output tensor [M, N] (fp16)
+ */
+mlx::core::array q_gemm_dequant_int8(const mlx::core::array& input,
+                                     const mlx::core::array& weights, int M,
+                                     int N, int K, QuantType quant_type,
+                                     int group_size,
+                                     const mlx::core::array* bias = nullptr,
+                                     mlx::core::StreamOrDevice s = {});
+
 /**
  * Helper function to compute quantized weight buffer size
  *
@@ -3,6 +3,9 @@
 
 #include "q_gemm_dequant_primitive.h"
 
+#include "../kernel_profiler.h"
+#include "pipeline_archive.h"
+
 #include <cmath>
 #include <stdexcept>
 #include <sstream>
@@ -235,7 +238,8 @@ QGemmDequantPrimitive::QGemmDequantPrimitive(
     int K,
     QuantType quant_type,
     int group_size,
-    bool has_bias)
+    bool has_bias,
+    bool int8_activations)
     : mlx::core::Primitive(stream),
       M_(M),
       N_(N),
@@ -243,6 +247,7 @@ QGemmDequantPrimitive::QGemmDequantPrimitive(
       quant_type_(quant_type),
       group_size_(group_size),
       has_bias_(has_bias),
+      int8_activations_(int8_activations),
       library_(nullptr) {}
 
 QGemmDequantPrimitive::~QGemmDequantPrimitive() {
@@ -293,13 +298,19 @@ bool QGemmDequantPrimitive::is_equivalent(const mlx::core::Primitive& other) con
          K_ == other_qgemm->K_ &&
          quant_type_ == other_qgemm->quant_type_ &&
          group_size_ == other_qgemm->group_size_ &&
-         has_bias_ == other_qgemm->has_bias_;
+         has_bias_ == other_qgemm->has_bias_ &&
+         int8_activations_ == other_qgemm->int8_activations_;
 }
 
 void QGemmDequantPrimitive::eval_cpu(
     const std::vector<mlx::core::array>& inputs,
     std::vector<mlx::core::array>& outputs) {
 
+  if (int8_activations_) {
+    throw std::runtime_error(
+        "INT8-activation QGemmDequant requires GPU evaluation");
+  }
+
   // Validate inputs
   if (inputs.size() < 2 || (has_bias_ && inputs.size() < 3)) {
     throw std::runtime_error("QGemmDequant requires input, weights, and optional bias");
@@ -368,6 +379,84 @@ void QGemmDequantPrimitive::eval_gpu(
     const std::vector<mlx::core::array>& inputs,
     std::vector<mlx::core::array>& outputs) {
 
+  // INT8-activation variant: inputs are [input_q, input_scales, weights,
+  // bias?] and the kernel reads int8 activations with per-row scales
+  if (int8_activations_) {
+    if (inputs.size() < 3 || (has_bias_ && inputs.size() < 4)) {
+      throw std::runtime_error(
+          "INT8 QGemmDequant requires input, scales, weights, and optional bias");
+    }
+
+    const auto& input_q = inputs[0];       // [M, K] int8
+    const auto& input_scales = inputs[1];  // [M] fp16
+    const auto& weights = inputs[2];
+    const mlx::core::array* bias = has_bias_ ? &inputs[3] : nullptr;
+    auto& output = outputs[0];
+
+    output = mlx::core::array({M_, N_}, mlx::core::float16);
+
+    auto* mtl_lib = static_cast<MTL::Library*>(load_metal_library());
+
+    auto& d = mlx::core::metal::device(mlx::core::Device::gpu);
+    auto kernel_name = "q_gemm_dequant_int8";
+    // Binary-archive cache: persists compiled pipelines across daemon restarts
+    auto* kernel = static_cast<MTL::ComputePipelineState*>(get_archived_pipeline(
+        d.mtl_device(), mtl_lib, "q_gemm_dequant", kernel_name));
+
+    auto& compute_encoder = d.get_command_encoder(stream().index);
+    compute_encoder.set_compute_pipeline_state(kernel);
+
+    // Must match QGemmInt8Args in the shader
+    struct QGemmInt8Args {
+      const void* input;
+      const void* input_scales;
+      void* output;
+      const void* weights;
+      const void* bias;
+      uint32_t M;
+      uint32_t N;
+      uint32_t K;
+      uint32_t quant_type;
+      uint32_t group_size;
+      uint32_t num_groups;
+    };
+
+    QGemmInt8Args args;
+    args.input = input_q.data<void>();
+    args.input_scales = input_scales.data<void>();
+    args.output = output.data<void>();
+    args.weights = weights.data<void>();
+    args.bias = (bias != nullptr) ? bias->data<void>() : nullptr;
+    args.M = M_;
+    args.N = N_;
+    args.K = K_;
+    args.quant_type = static_cast<uint32_t>(quant_type_);
+    args.group_size = group_size_;
+    args.num_groups = (K_ + group_size_ - 1) / group_size_;
+
+    compute_encoder.set_bytes(&args, sizeof(QGemmInt8Args), 0);
+
+    // shared_x holds int8 activations: TILE_M * TILE_K bytes
+    // shared_w holds dequantized weights: TILE_N * TILE_K halves
+    const uint32_t TILE_M = 32;
+    const uint32_t TILE_K = 32;
+    const uint32_t TILE_N = 64;
+
+    compute_encoder.set_threadgroup_memory_length(
+        TILE_M * TILE_K * sizeof(int8_t), 0);
+    compute_encoder.set_threadgroup_memory_length(
+        TILE_N * TILE_K * sizeof(uint16_t), 1);
+
+    const uint32_t grid_x = (N_ + TILE_N - 1) / TILE_N;
+    const uint32_t grid_y = (M_ + TILE_M - 1) / TILE_M;
+
+    MTL::Size grid_size(grid_x, grid_y, 1);
+    MTL::Size threadgroup_size(16, 32, 1);  // 512 threads
+
+    compute_encoder.dispatch_threadgroups(grid_size, threadgroup_size);
+    return;
+  }
+
   // Validate inputs
   if (inputs.size() < 2 || (has_bias_ && inputs.size() < 3)) {
     throw std::runtime_error("QGemmDequant requires input, weights, and optional bias");
@@ -387,7 +476,9 @@ void QGemmDequantPrimitive::eval_gpu(
   // Get device and kernel
   auto& d = mlx::core::metal::device(mlx::core::Device::gpu);
   auto kernel_name = "q_gemm_dequant";
-  auto* kernel = d.get_kernel(kernel_name, mtl_lib);
+  // Binary-archive cache: persists compiled pipelines across daemon restarts
+  auto* kernel = static_cast<MTL::ComputePipelineState*>(get_archived_pipeline(
+      d.mtl_device(), mtl_lib, "q_gemm_dequant", kernel_name));
 
   // Create command buffer and encoder
   auto& compute_encoder = d.get_command_encoder(stream().index);
@@ -486,6 +577,8 @@ mlx::core::array q_gemm_dequant(
     const mlx::core::array* bias,
     mlx::core::StreamOrDevice s) {
 
+  ScopedKernelTimer profile_timer("q_gemm_dequant");
+
   // Validate input shapes
   if (input.shape().size() != 2 || input.shape(0) != M || input.shape(1) != K) {
     throw std::runtime_error("Input shape must be [M, K]");
@@ -518,6 +611,73 @@ mlx::core::array q_gemm_dequant(
     prim->eval_cpu(inputs_vec, outputs);
   }
 
+  profile_timer.complete(outputs[0]);
+
+  return outputs[0];
+}
+
+mlx::core::array q_gemm_dequant_int8(
+    const mlx::core::array& input,
+    const mlx::core::array& weights,
+    int M,
+    int N,
+    int K,
+    QuantType quant_type,
+    int group_size,
+    const mlx::core::array* bias,
+    mlx::core::StreamOrDevice s) {
+
+  ScopedKernelTimer profile_timer("q_gemm_dequant_int8");
+
+  // Validate input shapes
+  if (input.shape().size() != 2 || input.shape(0) != M || input.shape(1) != K) {
+    throw std::runtime_error("Input shape must be [M, K]");
+  }
+
+  if (bias != nullptr && (bias->shape().size() != 1 || bias->shape(0) != N)) {
+    throw std::runtime_error("Bias shape must be [N]");
+  }
+
+  // Dynamic per-row quantization, computed on-GPU with MLX ops:
+  //   scale[m] = absmax(X[m, :]) / 127,  Xq = round(X / scale)
+  // The absmax is clamped away from zero so all-zero rows stay finite
+  auto x32 = mlx::core::astype(input, mlx::core::float32);
+  auto absmax = mlx::core::max(mlx::core::abs(x32), 1, /*keepdims=*/true);
+  auto scales = mlx::core::divide(
+      mlx::core::maximum(absmax, mlx::core::array(1e-8f)),
+      mlx::core::array(127.0f));
+  auto xq = mlx::core::astype(
+      mlx::core::clip(mlx::core::round(mlx::core::divide(x32, scales)),
+                      mlx::core::array(-127.0f), mlx::core::array(127.0f)),
+      mlx::core::int8);
+  auto row_scales =
+      mlx::core::astype(mlx::core::reshape(scales, {M}), mlx::core::float16);
+
+  // The primitive reads raw buffers, so the quantized operands must be
+  // materialized before dispatch
+  mlx::core::eval({xq, row_scales});
+
+  auto stream = mlx::core::to_stream(s);
+  auto prim = std::make_shared<QGemmDequantPrimitive>(
+      stream, M, N, K, quant_type, group_size, bias != nullptr,
+      /*int8_activations=*/true);
+
+  std::vector<mlx::core::array> inputs_vec = {xq, row_scales, weights};
+  if (bias != nullptr) {
+    inputs_vec.push_back(*bias);
+  }
+
+  mlx::core::array output({M, N}, mlx::core::float16);
+  std::vector<mlx::core::array> outputs = {output};
+
+  if (stream.device == mlx::core::Device::gpu) {
+    prim->eval_gpu(inputs_vec, outputs);
+  } else {
+    prim->eval_cpu(inputs_vec, outputs);
+  }
+
+  profile_timer.complete(outputs[0]);
+
   return outputs[0];
 }
 
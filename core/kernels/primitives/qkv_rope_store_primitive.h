@@ -0,0 +1,192 @@
+// Copyright © 2025 MLXR Development
+// MLX Primitive-based fused QKV projection + RoPE + KV block write
+
+#pragma once
+
+#include <mlx/array.h>
+#include <mlx/device.h>
+#include <mlx/primitives.h>
+#include <mlx/stream.h>
+#include <mlx/utils.h>
+
+namespace mlxr {
+namespace kernels {
+
+/**
+ * QkvRopeStore primitive using custom fused Metal kernel
+ *
+ * Front half of the prefill fusion: projects the input against the
+ * Q/K/V weight matrices, applies RoPE to Q and K in threadgroup memory,
+ * and streams K/V directly into the destination paged cache blocks.
+ * The unrotated projections never reach device memory, eliminating
+ * three intermediate tensor materializations per layer.
+ *
+ * Input shapes:
+ *   input:      [batch, seq_len, hidden_size]
+ *   wq:         [num_heads * head_dim, hidden_size]
+ *   wk:         [num_kv_heads * head_dim, hidden_size]
+ *   wv:         [num_kv_heads * head_dim, hidden_size]
+ *   rope_cos:   [max_seq_len, head_dim/2]
+ *   rope_sin:   [max_seq_len, head_dim/2]
+ *   k_cache:    [num_pages, num_layers, block_size, num_kv_heads, head_dim]
+ *               (or [num_pages, block_size, num_kv_heads, head_dim])
+ *   v_cache:    same layout as k_cache
+ *   page_table: [batch, max_blocks_per_seq] (int32)
+ *
+ * Output shapes:
+ *   q_rot:      [batch, seq_len, num_heads, head_dim] (RoPE applied)
+ *   k_rot:      [batch, seq_len, num_kv_heads, head_dim] (RoPE applied)
+ *   v:          [batch, seq_len, num_kv_heads, head_dim]
+ *
+ * The outputs feed attention_prefill_fused with inputs_rotated=true so
+ * the attention back half skips its own RoPE and cache stores.
+ */
+class QkvRopeStorePrimitive : public mlx::core::Primitive {
+ public:
+  /**
+   * Constructor
+   *
+   * @param stream MLX stream for execution
+   * @param num_heads Number of query heads
+   * @param num_kv_heads Number of key/value heads (for GQA)
+   * @param head_dim Dimension per attention head
+   * @param hidden_size Hidden size
+   * @param block_size Number of tokens per KV cache block
+   * @param max_blocks_per_seq Maximum blocks per sequence
+   * @param num_layers Total number of layers in model (for block format)
+   * @param layer_idx Current layer index (for block format indexing)
+   * @param use_block_format If true, cache is [pages, layers, ...]
+   * @param position_offset Starting position for RoPE and cache writes
+   */
+  QkvRopeStorePrimitive(mlx::core::Stream stream, int num_heads,
+                        int num_kv_heads, int head_dim, int hidden_size,
+                        int block_size, int max_blocks_per_seq,
+                        int num_layers = 0, int layer_idx = 0,
+                        bool use_block_format = false,
+                        int position_offset = 0);
+
+  ~QkvRopeStorePrimitive() override;
+
+  /**
+   * Evaluate on CPU (reference implementation)
+   */
+  void eval_cpu(const std::vector<mlx::core::array>& inputs,
+                std::vector<mlx::core::array>& outputs) override;
+
+  /**
+   * Evaluate on GPU using custom Metal kernel
+   * Inputs: [input, wq, wk, wv, rope_cos, rope_sin, k_cache, v_cache,
+   *          page_table]
+   * Outputs: [q_rot, k_rot, v]
+   *
+   * Note: k_cache and v_cache are modified in-place
+   */
+  void eval_gpu(const std::vector<mlx::core::array>& inputs,
+                std::vector<mlx::core::array>& outputs) override;
+
+  /**
+   * Vectorization support (vmap)
+   */
+  std::pair<std::vector<mlx::core::array>, std::vector<int>> vmap(
+      const std::vector<mlx::core::array>& inputs,
+      const std::vector<int>& axes) override;
+
+  /**
+   * Forward-mode autodiff (not needed for inference)
+   */
+  std::vector<mlx::core::array> jvp(
+      const std::vector<mlx::core::array>& primals,
+      const std::vector<mlx::core::array>& tangents,
+      const std::vector<int>& argnums) override;
+
+  /**
+   * Reverse-mode autodiff (not needed for inference)
+   */
+  std::vector<mlx::core::array> vjp(
+      const std::vector<mlx::core::array>& primals,
+      const std::vector<mlx::core::array>& cotangents,
+      const std::vector<int>& argnums,
+      const std::vector<mlx::core::array>& outputs) override;
+
+  /**
+   * Compute output shapes from input shapes
+   */
+  std::vector<mlx::core::Shape> output_shapes(
+      const std::vector<mlx::core::array>& inputs) override {
+    int batch = inputs[0].shape(0);
+    int seq_len = inputs[0].shape(1);
+    return {{batch, seq_len, num_heads_, head_dim_},
+            {batch, seq_len, num_kv_heads_, head_dim_},
+            {batch, seq_len, num_kv_heads_, head_dim_}};
+  }
+
+  /**
+   * Primitive identification
+   */
+  const char* name() const override { return "qkv_rope_store"; }
+
+  /**
+   * Check equivalence with another primitive
+   */
+  bool is_equivalent(const mlx::core::Primitive& other) const override;
+
+ private:
+  int num_heads_;
+  int num_kv_heads_;
+  int head_dim_;
+  int hidden_size_;
+  int block_size_;
+  int max_blocks_per_seq_;
+  int num_layers_;
+  int layer_idx_;
+  bool use_block_format_;
+  int position_offset_;
+
+  // Metal library (loaded lazily on first GPU eval)
+  void* library_;  // Stores MTL::Library*
+
+  /**
+   * Load Metal library containing custom kernels
+   * Returns MTL::Library* (cast from void*)
+   */
+  void* load_metal_library();
+};
+
+/**
+ * Public API function for fused QKV projection + RoPE + KV block write
+ *
+ * @param input Input tokens [batch, seq_len, hidden_size]
+ * @param wq Query projection weight [num_heads * head_dim, hidden_size]
+ * @param wk Key projection weight [num_kv_heads * head_dim, hidden_size]
+ * @param wv Value projection weight [num_kv_heads * head_dim, hidden_size]
+ * @param rope_cos RoPE cosine table [max_seq_len, head_dim/2]
+ * @param rope_sin RoPE sine table [max_seq_len, head_dim/2]
+ * @param k_cache K cache pages (modified in-place)
+ * @param v_cache V cache pages (modified in-place)
+ * @param page_table Page table [batch, max_blocks_per_seq] (int32)
+ * @param num_heads Number of query heads
+ * @param num_kv_heads Number of KV heads (for GQA)
+ * @param head_dim Head dimension
+ * @param hidden_size Hidden size
+ * @param block_size Tokens per block
+ * @param max_blocks_per_seq Max blocks per sequence
+ * @param num_layers Total number of layers (for block format)
+ * @param layer_idx Current layer index (for block format)
+ * @param use_block_format If true, cache has layer dimension
+ * @param position_offset Starting position for RoPE and cache writes
+ * @param s Stream or device for execution
+ * @return {q_rot, k_rot, v} with RoPE already applied to q_rot/k_rot
+ */
+std::vector<mlx::core::array> qkv_rope_store(
+    const mlx::core::array& input, const mlx::core::array& wq,
+    const mlx::core::array& wk, const mlx::core::array& wv,
+    const mlx::core::array& rope_cos, const mlx::core::array& rope_sin,
+    mlx::core::array& k_cache,  // Modified in-place
+    mlx::core::array& v_cache,  // Modified in-place
+    const mlx::core::array& page_table, int num_heads, int num_kv_heads,
+    int head_dim, int hidden_size, int block_size, int max_blocks_per_seq,
+    int num_layers = 0, int layer_idx = 0, bool use_block_format = false,
+    int position_offset = 0, mlx::core::StreamOrDevice s = {});
+
+}  // namespace kernels
+}  // namespace mlxr
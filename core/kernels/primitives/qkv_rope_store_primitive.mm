@@ -0,0 +1,547 @@
+// Copyright © 2025 MLXR Development
+// MLX Primitive-based fused QKV projection + RoPE + KV block write
+//
+// This implementation uses MLX's Primitive API with direct Metal buffer access
+// via MLX's compute encoder. Metal-cpp headers are bundled with MLX and provide
+// the Metal C++ API for custom kernel dispatch.
+
+#include "qkv_rope_store_primitive.h"
+
+#include "../kernel_tuning.h"
+#include "pipeline_archive.h"
+
+#include <mlx/ops.h>
+#include <mlx/allocator.h>
+#include <mlx/backend/metal/device.h>
+#include <mlx/transforms.h>  // For eval
+
+#import <Foundation/Foundation.h>
+#import <Metal/Metal.h>
+
+namespace mlxr {
+namespace kernels {
+
+// ============================================================================
+// Constructor & Destructor
+// ============================================================================
+
+QkvRopeStorePrimitive::QkvRopeStorePrimitive(
+    mlx::core::Stream stream,
+    int num_heads,
+    int num_kv_heads,
+    int head_dim,
+    int hidden_size,
+    int block_size,
+    int max_blocks_per_seq,
+    int num_layers,
+    int layer_idx,
+    bool use_block_format,
+    int position_offset)
+    : mlx::core::Primitive(stream),
+      num_heads_(num_heads),
+      num_kv_heads_(num_kv_heads),
+      head_dim_(head_dim),
+      hidden_size_(hidden_size),
+      block_size_(block_size),
+      max_blocks_per_seq_(max_blocks_per_seq),
+      num_layers_(num_layers),
+      layer_idx_(layer_idx),
+      use_block_format_(use_block_format),
+      position_offset_(position_offset),
+      library_(nullptr) {
+}
+
+QkvRopeStorePrimitive::~QkvRopeStorePrimitive() {
+  // Metal library is managed by MLX's device, no explicit cleanup needed
+}
+
+// ============================================================================
+// Metal Kernel Loading
+// ============================================================================
+
+void* QkvRopeStorePrimitive::load_metal_library() {
+  if (library_) {
+    return library_;
+  }
+
+  @autoreleasepool {
+    // Get Metal device
+    auto& d = mlx::core::metal::device(stream().device);
+
+    // Find metallib file - search multiple paths
+    NSArray<NSString*>* search_paths = @[
+      @"build/lib/qkv_rope_store.metallib",
+      @"../../lib/qkv_rope_store.metallib",
+      @"../lib/qkv_rope_store.metallib",
+      @"lib/qkv_rope_store.metallib",
+      [@(getenv("PWD") ?: ".") stringByAppendingString:@"/build/lib/qkv_rope_store.metallib"]
+    ];
+
+    NSString* metallib_path = nil;
+    for (NSString* path in search_paths) {
+      if ([[NSFileManager defaultManager] fileExistsAtPath:path]) {
+        metallib_path = path;
+        NSLog(@"Found qkv_rope_store.metallib at: %@", path);
+        break;
+      }
+    }
+
+    if (!metallib_path) {
+      NSLog(@"Failed to find qkv_rope_store.metallib in any of these paths:");
+      for (NSString* path in search_paths) {
+        NSLog(@"  - %@", path);
+      }
+      throw std::runtime_error(
+          "Failed to find qkv_rope_store.metallib. Please run 'make metal'");
+    }
+
+    // Load Metal library via MLX's device
+    NSURL* url = [NSURL fileURLWithPath:metallib_path];
+    NSError* error = nil;
+
+    // Get the raw MTL::Device pointer
+    auto mtl_device = d.mtl_device();
+
+    // Load library using Objective-C bridge
+    id<MTLDevice> device_objc = (__bridge id<MTLDevice>)mtl_device;
+    id<MTLLibrary> library_objc = [device_objc newLibraryWithURL:url error:&error];
+
+    if (!library_objc) {
+      NSString* err_msg = error ? [error localizedDescription] : @"Unknown error";
+      throw std::runtime_error(
+          "Failed to load Metal library: " +
+          std::string([err_msg UTF8String]));
+    }
+
+    // Convert to metal-cpp type and store
+    MTL::Library* library_cpp = (__bridge MTL::Library*)library_objc;
+    library_ = static_cast<void*>(library_cpp);
+
+    return library_;
+  }
+}
+
+// ============================================================================
+// CPU Evaluation (Reference)
+// ============================================================================
+
+void QkvRopeStorePrimitive::eval_cpu(
+    const std::vector<mlx::core::array>& inputs,
+    std::vector<mlx::core::array>& outputs) {
+
+  assert(inputs.size() == 9);
+  assert(outputs.size() == 3);
+
+  const auto& input = inputs[0];     // [batch, seq_len, hidden_size]
+  const auto& wq = inputs[1];        // [num_heads*head_dim, hidden_size]
+  const auto& wk = inputs[2];        // [num_kv_heads*head_dim, hidden_size]
+  const auto& wv = inputs[3];        // [num_kv_heads*head_dim, hidden_size]
+  const auto& rope_cos = inputs[4];  // [max_seq_len, head_dim/2]
+  const auto& rope_sin = inputs[5];  // [max_seq_len, head_dim/2]
+  // k_cache and v_cache are modified in-place
+  auto& k_cache = const_cast<mlx::core::array&>(inputs[6]);
+  auto& v_cache = const_cast<mlx::core::array&>(inputs[7]);
+  const auto& page_table = inputs[8];  // [batch, max_blocks_per_seq]
+
+  auto& q_out = outputs[0];  // [batch, seq_len, num_heads, head_dim]
+  auto& k_out = outputs[1];  // [batch, seq_len, num_kv_heads, head_dim]
+  auto& v_out = outputs[2];  // [batch, seq_len, num_kv_heads, head_dim]
+
+  for (auto& out : outputs) {
+    out.set_data(mlx::core::allocator::malloc(out.nbytes()));
+  }
+
+  int batch_size = input.shape(0);
+  int seq_len = input.shape(1);
+  int half_dim = head_dim_ / 2;
+
+  // Rotate one projected head row in place using the precomputed tables
+  auto rotate = [&](std::vector<float>& row, int pos) {
+    for (int d = 0; d < half_dim; d++) {
+      float cos_val = rope_cos.data<float>()[pos * half_dim + d];
+      float sin_val = rope_sin.data<float>()[pos * half_dim + d];
+      float x_even = row[d * 2];
+      float x_odd = row[d * 2 + 1];
+      row[d * 2] = x_even * cos_val - x_odd * sin_val;
+      row[d * 2 + 1] = x_odd * cos_val + x_even * sin_val;
+    }
+  };
+
+  // Write a K or V row into the paged cache via the page table
+  auto store = [&](mlx::core::array& cache, const std::vector<float>& row,
+                   int b, int pos, int kv_h) {
+    int block_idx = pos / block_size_;
+    int block_offset = pos % block_size_;
+    int page_id = page_table.data<int>()[b * max_blocks_per_seq_ + block_idx];
+    if (page_id < 0) {
+      return;
+    }
+    int offset;
+    if (use_block_format_) {
+      offset = page_id * num_layers_ * block_size_ * num_kv_heads_ * head_dim_ +
+               layer_idx_ * block_size_ * num_kv_heads_ * head_dim_ +
+               block_offset * num_kv_heads_ * head_dim_ + kv_h * head_dim_;
+    } else {
+      offset = page_id * block_size_ * num_kv_heads_ * head_dim_ +
+               block_offset * num_kv_heads_ * head_dim_ + kv_h * head_dim_;
+    }
+    for (int d = 0; d < head_dim_; d++) {
+      cache.data<float>()[offset + d] = row[d];
+    }
+  };
+
+  std::vector<float> row(head_dim_);
+
+  for (int b = 0; b < batch_size; b++) {
+    for (int t = 0; t < seq_len; t++) {
+      const float* x_row =
+          input.data<float>() + (b * seq_len + t) * hidden_size_;
+      int pos = position_offset_ + t;
+
+      // Q heads: project and rotate
+      for (int h = 0; h < num_heads_; h++) {
+        for (int d = 0; d < head_dim_; d++) {
+          const float* w_row =
+              wq.data<float>() + (h * head_dim_ + d) * hidden_size_;
+          float accum = 0.0f;
+          for (int i = 0; i < hidden_size_; i++) {
+            accum += x_row[i] * w_row[i];
+          }
+          row[d] = accum;
+        }
+        rotate(row, pos);
+        float* out = q_out.data<float>() +
+                     (b * seq_len + t) * num_heads_ * head_dim_ +
+                     h * head_dim_;
+        std::copy(row.begin(), row.end(), out);
+      }
+
+      // K heads: project, rotate, store
+      for (int h = 0; h < num_kv_heads_; h++) {
+        for (int d = 0; d < head_dim_; d++) {
+          const float* w_row =
+              wk.data<float>() + (h * head_dim_ + d) * hidden_size_;
+          float accum = 0.0f;
+          for (int i = 0; i < hidden_size_; i++) {
+            accum += x_row[i] * w_row[i];
+          }
+          row[d] = accum;
+        }
+        rotate(row, pos);
+        float* out = k_out.data<float>() +
+                     (b * seq_len + t) * num_kv_heads_ * head_dim_ +
+                     h * head_dim_;
+        std::copy(row.begin(), row.end(), out);
+        store(k_cache, row, b, pos, h);
+      }
+
+      // V heads: project and store (no rotation)
+      for (int h = 0; h < num_kv_heads_; h++) {
+        for (int d = 0; d < head_dim_; d++) {
+          const float* w_row =
+              wv.data<float>() + (h * head_dim_ + d) * hidden_size_;
+          float accum = 0.0f;
+          for (int i = 0; i < hidden_size_; i++) {
+            accum += x_row[i] * w_row[i];
+          }
+          row[d] = accum;
+        }
+        float* out = v_out.data<float>() +
+                     (b * seq_len + t) * num_kv_heads_ * head_dim_ +
+                     h * head_dim_;
+        std::copy(row.begin(), row.end(), out);
+        store(v_cache, row, b, pos, h);
+      }
+    }
+  }
+}
+
+// ============================================================================
+// GPU Evaluation (Custom Metal Kernel)
+// ============================================================================
+
+void QkvRopeStorePrimitive::eval_gpu(
+    const std::vector<mlx::core::array>& inputs,
+    std::vector<mlx::core::array>& outputs) {
+
+  NSLog(@"[QkvRopeStore] eval_gpu() called - using Metal kernel");
+
+  assert(inputs.size() == 9);
+  assert(outputs.size() == 3);
+
+  const auto& input = inputs[0];
+  const auto& wq = inputs[1];
+  const auto& wk = inputs[2];
+  const auto& wv = inputs[3];
+  const auto& rope_cos = inputs[4];
+  const auto& rope_sin = inputs[5];
+  // k_cache and v_cache are modified in-place by the Metal kernel
+  auto& k_cache = const_cast<mlx::core::array&>(inputs[6]);
+  auto& v_cache = const_cast<mlx::core::array&>(inputs[7]);
+  const auto& page_table = inputs[8];
+
+  auto& q_out = outputs[0];
+  auto& k_out = outputs[1];
+  auto& v_out = outputs[2];
+
+  // Check contiguity (Phase 1 limitation)
+  for (const auto& in : inputs) {
+    if (!in.flags().row_contiguous) {
+      throw std::runtime_error(
+          "QkvRopeStorePrimitive requires contiguous inputs. "
+          "This is a Phase 1 limitation.");
+    }
+  }
+
+  // Allocate output buffers
+  for (auto& out : outputs) {
+    out.set_data(mlx::core::allocator::malloc(out.nbytes()));
+  }
+
+  // Get stream and device
+  auto& s = stream();
+  auto& d = mlx::core::metal::device(s.device);
+
+  // Load our custom Metal library
+  auto* mtl_lib = static_cast<MTL::Library*>(load_metal_library());
+
+  std::string kernel_name = "qkv_rope_store";
+
+  // Create the pipeline through the binary-archive cache so PSO compilation
+  // is a one-time cost per metallib build, persisted across daemon restarts
+  auto* kernel = static_cast<MTL::ComputePipelineState*>(get_archived_pipeline(
+      d.mtl_device(), mtl_lib, "qkv_rope_store", kernel_name));
+
+  // Get MLX's command encoder and set pipeline
+  auto& compute_encoder = d.get_command_encoder(s.index);
+  compute_encoder.set_compute_pipeline_state(kernel);
+
+  int batch_size = input.shape(0);
+  int seq_len = input.shape(1);
+
+  // Bind buffers (matches qkv_rope_store.metal binding order)
+  compute_encoder.set_input_array(input, 0);
+  compute_encoder.set_input_array(wq, 1);
+  compute_encoder.set_input_array(wk, 2);
+  compute_encoder.set_input_array(wv, 3);
+  compute_encoder.set_input_array(rope_cos, 4);
+  compute_encoder.set_input_array(rope_sin, 5);
+  compute_encoder.set_output_array(q_out, 6);
+  compute_encoder.set_output_array(k_out, 7);
+  compute_encoder.set_output_array(v_out, 8);
+  compute_encoder.set_input_array(k_cache, 9);
+  compute_encoder.set_input_array(v_cache, 10);
+  compute_encoder.set_input_array(page_table, 11);
+
+  // Set scalar parameters
+  compute_encoder.set_bytes(static_cast<uint32_t>(batch_size), 12);
+  compute_encoder.set_bytes(static_cast<uint32_t>(seq_len), 13);
+  compute_encoder.set_bytes(static_cast<uint32_t>(hidden_size_), 14);
+  compute_encoder.set_bytes(static_cast<uint32_t>(num_heads_), 15);
+  compute_encoder.set_bytes(static_cast<uint32_t>(num_kv_heads_), 16);
+  compute_encoder.set_bytes(static_cast<uint32_t>(head_dim_), 17);
+  compute_encoder.set_bytes(static_cast<uint32_t>(block_size_), 18);
+  compute_encoder.set_bytes(static_cast<uint32_t>(max_blocks_per_seq_), 19);
+  compute_encoder.set_bytes(static_cast<uint32_t>(num_layers_), 20);
+  compute_encoder.set_bytes(static_cast<uint32_t>(layer_idx_), 21);
+  compute_encoder.set_bytes(use_block_format_, 22);
+  compute_encoder.set_bytes(static_cast<uint32_t>(position_offset_), 23);
+
+  // Dispatch configuration
+  // One threadgroup per output head row: [Q heads][K heads][V heads]
+  // per token
+  size_t rows_per_token = num_heads_ + 2 * num_kv_heads_;
+  size_t num_threadgroups = batch_size * seq_len * rows_per_token;
+  // Width is tunable; the autotuner installs per-GPU winners at model load
+  size_t threads_per_group = static_cast<size_t>(tuned_threadgroup_width(
+      "qkv_rope_store",
+      qkv_rope_store_shape_key(hidden_size_, head_dim_), 256));
+
+  MTL::Size grid_dims(num_threadgroups, 1, 1);
+  MTL::Size group_dims(threads_per_group, 1, 1);
+
+  NSLog(@"[QkvRopeStore] Dispatch params: batch=%d, seq_len=%d, heads=%d, kv_heads=%d, head_dim=%d, hidden=%d",
+        batch_size, seq_len, num_heads_, num_kv_heads_, head_dim_, hidden_size_);
+  NSLog(@"[QkvRopeStore] Grid dims: (%zu, %zu, %zu), Group dims: (%zu, %zu, %zu)",
+        grid_dims.width, grid_dims.height, grid_dims.depth,
+        group_dims.width, group_dims.height, group_dims.depth);
+
+  // Allocate threadgroup memory
+  // shared_x:   hidden_size halfs (input row, loaded once per group)
+  // shared_row: head_dim floats (projected row, rotated in place)
+  size_t shared_x_size = hidden_size_ * sizeof(uint16_t);  // half = 16-bit
+  size_t shared_row_size = head_dim_ * sizeof(float);
+
+  compute_encoder.set_threadgroup_memory_length(shared_x_size, 0);
+  compute_encoder.set_threadgroup_memory_length(shared_row_size, 1);
+
+  NSLog(@"[QkvRopeStore] Threadgroup memory: x=%zu, row=%zu bytes",
+        shared_x_size, shared_row_size);
+
+  compute_encoder.dispatch_threadgroups(grid_dims, group_dims);
+
+  NSLog(@"[QkvRopeStore] Dispatch complete");
+}
+
+// ============================================================================
+// Function Transformations
+// ============================================================================
+
+std::pair<std::vector<mlx::core::array>, std::vector<int>>
+QkvRopeStorePrimitive::vmap(
+    const std::vector<mlx::core::array>& inputs,
+    const std::vector<int>& axes) {
+
+  auto out = qkv_rope_store(
+      inputs[0], inputs[1], inputs[2], inputs[3], inputs[4], inputs[5],
+      const_cast<mlx::core::array&>(inputs[6]),
+      const_cast<mlx::core::array&>(inputs[7]),
+      inputs[8],
+      num_heads_, num_kv_heads_, head_dim_, hidden_size_,
+      block_size_, max_blocks_per_seq_, num_layers_, layer_idx_,
+      use_block_format_, position_offset_,
+      stream());
+
+  return {out, {axes[0], axes[0], axes[0]}};
+}
+
+std::vector<mlx::core::array> QkvRopeStorePrimitive::jvp(
+    const std::vector<mlx::core::array>& primals,
+    const std::vector<mlx::core::array>& tangents,
+    const std::vector<int>& argnums) {
+
+  // Inference-only primitive
+  throw std::runtime_error("QkvRopeStorePrimitive does not support jvp");
+}
+
+std::vector<mlx::core::array> QkvRopeStorePrimitive::vjp(
+    const std::vector<mlx::core::array>& primals,
+    const std::vector<mlx::core::array>& cotangents,
+    const std::vector<int>& argnums,
+    const std::vector<mlx::core::array>& outputs) {
+
+  // Inference-only primitive
+  throw std::runtime_error("QkvRopeStorePrimitive does not support vjp");
+}
+
+bool QkvRopeStorePrimitive::is_equivalent(const mlx::core::Primitive& other) const {
+  const auto* other_qkv = dynamic_cast<const QkvRopeStorePrimitive*>(&other);
+  if (!other_qkv) {
+    return false;
+  }
+  return num_heads_ == other_qkv->num_heads_ &&
+         num_kv_heads_ == other_qkv->num_kv_heads_ &&
+         head_dim_ == other_qkv->head_dim_ &&
+         hidden_size_ == other_qkv->hidden_size_ &&
+         block_size_ == other_qkv->block_size_ &&
+         max_blocks_per_seq_ == other_qkv->max_blocks_per_seq_ &&
+         num_layers_ == other_qkv->num_layers_ &&
+         layer_idx_ == other_qkv->layer_idx_ &&
+         use_block_format_ == other_qkv->use_block_format_ &&
+         position_offset_ == other_qkv->position_offset_;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+std::vector<mlx::core::array> qkv_rope_store(
+    const mlx::core::array& input,
+    const mlx::core::array& wq,
+    const mlx::core::array& wk,
+    const mlx::core::array& wv,
+    const mlx::core::array& rope_cos,
+    const mlx::core::array& rope_sin,
+    mlx::core::array& k_cache,
+    mlx::core::array& v_cache,
+    const mlx::core::array& page_table,
+    int num_heads,
+    int num_kv_heads,
+    int head_dim,
+    int hidden_size,
+    int block_size,
+    int max_blocks_per_seq,
+    int num_layers,
+    int layer_idx,
+    bool use_block_format,
+    int position_offset,
+    mlx::core::StreamOrDevice s) {
+
+  // Validate inputs
+  if (input.ndim() != 3) {
+    throw std::invalid_argument("input must be 3-dimensional [batch, seq_len, hidden_size]");
+  }
+
+  if (wq.ndim() != 2 || wq.shape(0) != num_heads * head_dim ||
+      wq.shape(1) != hidden_size) {
+    throw std::invalid_argument(
+        "wq must be [num_heads * head_dim, hidden_size]");
+  }
+
+  if (wk.ndim() != 2 || wk.shape(0) != num_kv_heads * head_dim ||
+      wk.shape(1) != hidden_size) {
+    throw std::invalid_argument(
+        "wk must be [num_kv_heads * head_dim, hidden_size]");
+  }
+
+  if (wv.ndim() != 2 || wv.shape(0) != num_kv_heads * head_dim ||
+      wv.shape(1) != hidden_size) {
+    throw std::invalid_argument(
+        "wv must be [num_kv_heads * head_dim, hidden_size]");
+  }
+
+  if (rope_cos.ndim() != 2) {
+    throw std::invalid_argument("rope_cos must be 2-dimensional [max_seq_len, head_dim/2]");
+  }
+
+  if (rope_sin.ndim() != 2) {
+    throw std::invalid_argument("rope_sin must be 2-dimensional [max_seq_len, head_dim/2]");
+  }
+
+  // Validate cache dimensions based on format
+  if (use_block_format) {
+    if (k_cache.ndim() != 5 || v_cache.ndim() != 5) {
+      throw std::invalid_argument(
+          "k_cache/v_cache must be 5-dimensional [num_pages, num_layers, block_size, num_kv_heads, head_dim] when use_block_format=true");
+    }
+  } else {
+    if (k_cache.ndim() != 4 || v_cache.ndim() != 4) {
+      throw std::invalid_argument(
+          "k_cache/v_cache must be 4-dimensional [num_pages, block_size, num_kv_heads, head_dim] when use_block_format=false");
+    }
+  }
+
+  if (page_table.ndim() != 2) {
+    throw std::invalid_argument("page_table must be 2-dimensional [batch, max_blocks_per_seq]");
+  }
+
+  if (page_table.shape(0) != input.shape(0)) {
+    throw std::invalid_argument("page_table batch size mismatch");
+  }
+
+  // Get stream
+  auto stream = mlx::core::to_stream(s);
+
+  int batch_size = input.shape(0);
+  int seq_len = input.shape(1);
+
+  // Create primitive
+  auto primitive = std::make_shared<QkvRopeStorePrimitive>(
+      stream, num_heads, num_kv_heads, head_dim, hidden_size,
+      block_size, max_blocks_per_seq, num_layers, layer_idx,
+      use_block_format, position_offset);
+
+  // Create output arrays using MLX's array factory with primitive
+  auto outputs = mlx::core::array::make_arrays(
+      {{batch_size, seq_len, num_heads, head_dim},
+       {batch_size, seq_len, num_kv_heads, head_dim},
+       {batch_size, seq_len, num_kv_heads, head_dim}},
+      {input.dtype(), input.dtype(), input.dtype()},
+      primitive,
+      {input, wq, wk, wv, rope_cos, rope_sin, k_cache, v_cache, page_table});
+
+  return outputs;
+}
+
+}  // namespace kernels
+}  // namespace mlxr
@@ -7,6 +7,10 @@
 
 #include "rmsnorm_primitive.h"
 
+#include "../kernel_profiler.h"
+#include "cpu/neon_kernels.h"
+#include "pipeline_archive.h"
+
 #include <mlx/ops.h>
 #include <mlx/allocator.h>
 #include <mlx/backend/metal/device.h>
@@ -118,6 +122,17 @@ void RMSNormPrimitive::eval_cpu(
   auto buffer = mlx::core::allocator::malloc(output.nbytes());
   output.set_data(buffer);
 
+  // Fast path: vectorized NEON kernel on contiguous fp32 rows
+  if (input.dtype() == mlx::core::float32 &&
+      weight.dtype() == mlx::core::float32 &&
+      input.flags().row_contiguous && weight.flags().row_contiguous) {
+    const int dim = input.shape(-1);
+    const int rows = static_cast<int>(input.size()) / dim;
+    cpu::rmsnorm(input.data<float>(), weight.data<float>(),
+                 output.data<float>(), rows, dim, eps_);
+    return;
+  }
+
   // Use MLX reference implementation for CPU
   auto x_sq = mlx::core::multiply(input, input);
   std::vector<int> axes = {-1};
@@ -181,8 +196,10 @@ void RMSNormPrimitive::eval_gpu(
                              ? "rmsnorm_fused_fp16"
                              : "rmsnorm_fused";
 
-  // Get compiled kernel from MLX's device (this caches it)
-  auto* kernel = d.get_kernel(kernel_name, mtl_lib);
+  // Create the pipeline through the binary-archive cache so PSO compilation
+  // is a one-time cost per metallib build, persisted across daemon restarts
+  auto* kernel = static_cast<MTL::ComputePipelineState*>(get_archived_pipeline(
+      d.mtl_device(), mtl_lib, "rmsnorm", kernel_name));
 
   // Get MLX's command encoder and set pipeline
   auto& compute_encoder = d.get_command_encoder(s.index);
@@ -305,6 +322,8 @@ mlx::core::array rmsnorm_fused(
     float eps,
     mlx::core::StreamOrDevice s) {
 
+  ScopedKernelTimer profile_timer("rmsnorm_fused");
+
   // Validate inputs
   if (input.ndim() < 1) {
     throw std::invalid_argument("RMSNorm input must have at least 1 dimension");
@@ -355,6 +374,8 @@ mlx::core::array rmsnorm_fused(
       {input_contig, weight_contig}  // inputs (now contiguous)
   );
 
+  profile_timer.complete(outputs[0]);
+
   return outputs[0];
 }
 
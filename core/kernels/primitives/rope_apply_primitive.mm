@@ -3,6 +3,9 @@
 
 #include "rope_apply_primitive.h"
 
+#include "cpu/neon_kernels.h"
+#include "pipeline_archive.h"
+
 #include <cmath>
 #include <stdexcept>
 #include <sstream>
@@ -232,38 +235,22 @@ void RoPEApplyPrimitive::eval_cpu(
       }
       position += position_offset_;
 
+      // Rotate each head against this position's table row with the
+      // vectorized NEON kernel (scalar fallback off arm64)
+      const float* cos_row = cos_data + static_cast<int64_t>(position) * num_pairs;
+      const float* sin_row = sin_data + static_cast<int64_t>(position) * num_pairs;
+      const float scale =
+          scaling_mode_ == RoPEScalingMode::LINEAR ? scale_factor_ : 1.0f;
+
       for (int head = 0; head < num_heads_; head++) {
         // Calculate offset for this head
         int head_offset = batch * seq_len_ * num_heads_ * head_dim_ +
                          seq * num_heads_ * head_dim_ +
                          head * head_dim_;
 
-        // Apply RoPE to each dimension pair
-        for (int pair = 0; pair < num_pairs; pair++) {
-          int even_dim = head_offset + pair * 2;
-          int odd_dim = head_offset + pair * 2 + 1;
-
-          float x_even = input_data[even_dim];
-          float x_odd = input_data[odd_dim];
-
-          // Load cos/sin from tables
-          int table_idx = position * num_pairs + pair;
-          float cos_val = cos_data[table_idx];
-          float sin_val = sin_data[table_idx];
-
-          // Apply rotation
-          float y_even = x_even * cos_val - x_odd * sin_val;
-          float y_odd = x_odd * cos_val + x_even * sin_val;
-
-          // Apply linear scaling if needed
-          if (scaling_mode_ == RoPEScalingMode::LINEAR) {
-            y_even *= scale_factor_;
-            y_odd *= scale_factor_;
-          }
-
-          output_data[even_dim] = y_even;
-          output_data[odd_dim] = y_odd;
-        }
+        cpu::rope_apply_head(input_data + head_offset,
+                             output_data + head_offset,
+                             cos_row, sin_row, head_dim_, scale);
       }
     }
   }
@@ -297,7 +284,9 @@ void RoPEApplyPrimitive::eval_gpu(
   // Get device and kernel
   auto& d = mlx::core::metal::device(mlx::core::Device::gpu);
   std::string kernel_name = inplace_ ? "rope_apply_inplace" : "rope_apply";
-  auto* kernel = d.get_kernel(kernel_name, mtl_lib);
+  // Binary-archive cache: persists compiled pipelines across daemon restarts
+  auto* kernel = static_cast<MTL::ComputePipelineState*>(get_archived_pipeline(
+      d.mtl_device(), mtl_lib, "rope_apply", kernel_name));
 
   // Create command buffer and encoder
   auto& compute_encoder = d.get_command_encoder(stream().index);
@@ -0,0 +1,62 @@
+// Copyright © 2025 MLXR Development
+// Process-wide cache of precomputed RoPE cos/sin tables
+
+#include "rope_tables.h"
+
+#include <mlx/ops.h>
+#include <mlx/transforms.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace mlxr {
+namespace kernels {
+
+namespace {
+
+// Key covers every parameter that changes table contents. Floats are
+// compared bitwise-exact: configs either match or they are genuinely
+// different architectures deserving their own tables.
+using TableKey = std::tuple<int, int, float, int, float, int>;
+
+std::mutex& cache_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// unique_ptr values keep the returned references stable; std::map node
+// stability would suffice, but the indirection makes that explicit
+std::map<TableKey, std::unique_ptr<RoPETables>>& cache() {
+  static std::map<TableKey, std::unique_ptr<RoPETables>> tables;
+  return tables;
+}
+
+}  // namespace
+
+const RoPETables& rope_tables(int head_dim, int max_seq_len, float base,
+                              RoPEScalingMode scaling_mode, float scale_factor,
+                              int orig_context) {
+  TableKey key{head_dim, max_seq_len, base, static_cast<int>(scaling_mode),
+               scale_factor, orig_context};
+
+  std::lock_guard<std::mutex> lock(cache_mutex());
+  auto& tables = cache();
+  auto it = tables.find(key);
+  if (it == tables.end()) {
+    auto [cos_arr, sin_arr] = compute_rope_tables(
+        max_seq_len, head_dim, base, scaling_mode, scale_factor, orig_context);
+    // Materialize now so the one-time build cost is paid here, under
+    // the lock, instead of racing lazily inside the first forward pass
+    mlx::core::eval({cos_arr, sin_arr});
+    it = tables
+             .emplace(key, std::make_unique<RoPETables>(RoPETables{
+                               std::move(cos_arr), std::move(sin_arr)}))
+             .first;
+  }
+  return *it->second;
+}
+
+}  // namespace kernels
+}  // namespace mlxr
@@ -0,0 +1,55 @@
+// Copyright © 2025 MLXR Development
+// Process-wide cache of precomputed RoPE cos/sin tables
+
+#pragma once
+
+#include <mlx/array.h>
+
+#include "rope_apply_primitive.h"
+
+namespace mlxr {
+namespace kernels {
+
+/**
+ * Precomputed RoPE frequency tables shared across the process.
+ *
+ * Every layer of every resident model rotates with the same
+ * [max_seq_len, head_dim/2] cos/sin tables as long as (head_dim, base,
+ * scaling) match, and both the fused prefill kernel (qkv_rope_store)
+ * and the standalone decode kernel (rope_apply) consume the same
+ * layout. Building them per RotaryEmbedding instance therefore
+ * duplicates the table once per layer and, for scaled long-context
+ * configs, redoes the NTK/YaRN frequency math on every model load.
+ *
+ * rope_tables() returns a reference to a lazily built, fully evaluated
+ * table pair keyed by every parameter that changes its contents. The
+ * first request for a given key pays the one-time build (a 32K x 64
+ * fp16 pair is 8 MB and a few ms of trig); every later caller — any
+ * layer, any sequence, prefill or decode — gets the same arrays back.
+ */
+struct RoPETables {
+  mlx::core::array cos;  // [max_seq_len, head_dim/2], float16
+  mlx::core::array sin;  // [max_seq_len, head_dim/2], float16
+};
+
+/**
+ * Fetch (building on first use) the shared tables for a RoPE config.
+ *
+ * Thread-safe; the returned reference stays valid for the process
+ * lifetime. Entries are never evicted — distinct keys correspond to
+ * distinct model architectures, of which a daemon holds a handful.
+ *
+ * @param head_dim Per-head dimension (must be even)
+ * @param max_seq_len Maximum context length covered by the table
+ * @param base RoPE base frequency
+ * @param scaling_mode BASE / NTK / YARN / LINEAR
+ * @param scale_factor Context scaling factor (NTK/LINEAR/YaRN)
+ * @param orig_context Pre-extension context length (NTK/YaRN)
+ */
+const RoPETables& rope_tables(int head_dim, int max_seq_len, float base,
+                              RoPEScalingMode scaling_mode = RoPEScalingMode::BASE,
+                              float scale_factor = 1.0f,
+                              int orig_context = 2048);
+
+}  // namespace kernels
+}  // namespace mlxr
@@ -0,0 +1,172 @@
+// Copyright © 2025 MLXR Development
+// MLX Primitive-based fused batched sampling kernel
+
+#pragma once
+
+#include <mlx/array.h>
+#include <mlx/device.h>
+#include <mlx/primitives.h>
+#include <mlx/stream.h>
+#include <mlx/utils.h>
+
+#include <vector>
+
+namespace mlxr {
+namespace kernels {
+
+/**
+ * Per-row sampling parameters for the fused batched sampler
+ *
+ * Layout must match SampleRowParams in sample_batch.metal
+ * (32 bytes, plain scalar fields, 16-byte aligned for argument
+ * buffer compatibility).
+ */
+struct RowSamplingParams {
+  float temperature = 1.0f;         // 0 = greedy
+  int top_k = 0;                    // 0 = disabled
+  float top_p = 0.0f;               // 0 = disabled
+  float repetition_penalty = 1.0f;  // 1 = disabled
+  float uniform = 0.0f;             // pre-drawn U(0,1) for this row
+  float pad0 = 0.0f;
+  float pad1 = 0.0f;
+  float pad2 = 0.0f;
+};
+
+/**
+ * Batched sampling primitive using a fused Metal kernel
+ *
+ * Samples one token per decode-batch row on the GPU, fusing
+ * repetition penalty, top-k candidate extraction, temperature softmax,
+ * top-p (nucleus) truncation and the categorical draw into a single
+ * dispatch. Only the sampled int32 token IDs cross back to the host,
+ * instead of one full logits row (vocab_size * 4 bytes) per sequence
+ * per decode step.
+ *
+ * Input shapes:
+ *   logits:          [batch, vocab_size] (fp32 or fp16; CONSUMED —
+ *                    the kernel scatters the penalty and knocks out
+ *                    selected logits in place)
+ *   penalty_tokens:  [total_context] int32, flattened unique context
+ *                    token IDs for all rows
+ *   penalty_offsets: [batch + 1] int32, row ranges into penalty_tokens
+ *
+ * Output shape:
+ *   tokens: [batch] int32
+ *
+ * Randomness is supplied by the host: one pre-drawn U(0,1) value per
+ * row inside RowSamplingParams, so seeded configs stay reproducible
+ * and the kernel needs no device-side RNG state.
+ *
+ * Candidate cap: top-k is limited to kMaxCandidates (64); top-p
+ * without top-k computes the nucleus over the top 64 logits. Rows
+ * that need exact full-vocab sampling (e.g. min_p) should use the
+ * CPU Sampler instead — see Sampler::sample_batch.
+ */
+class SampleBatchPrimitive : public mlx::core::Primitive {
+ public:
+  /**
+   * Constructor
+   *
+   * @param stream MLX stream for execution
+   * @param params Per-row sampling parameters (size = batch)
+   */
+  SampleBatchPrimitive(mlx::core::Stream stream,
+                       std::vector<RowSamplingParams> params);
+
+  ~SampleBatchPrimitive() override;
+
+  /**
+   * Evaluate on CPU (fallback)
+   * Mirrors the kernel algorithm in plain C++
+   */
+  void eval_cpu(const std::vector<mlx::core::array>& inputs,
+                std::vector<mlx::core::array>& outputs) override;
+
+  /**
+   * Evaluate on GPU using custom Metal kernel
+   * Inputs: [logits, penalty_tokens, penalty_offsets]
+   * Outputs: [tokens]
+   */
+  void eval_gpu(const std::vector<mlx::core::array>& inputs,
+                std::vector<mlx::core::array>& outputs) override;
+
+  /**
+   * Vectorization support (vmap)
+   * Sampling is not batched beyond its explicit batch dimension
+   */
+  std::pair<std::vector<mlx::core::array>, std::vector<int>> vmap(
+      const std::vector<mlx::core::array>& inputs,
+      const std::vector<int>& axes) override;
+
+  /**
+   * Forward-mode autodiff (sampling is not differentiable)
+   */
+  std::vector<mlx::core::array> jvp(
+      const std::vector<mlx::core::array>& primals,
+      const std::vector<mlx::core::array>& tangents,
+      const std::vector<int>& argnums) override;
+
+  /**
+   * Reverse-mode autodiff (sampling is not differentiable)
+   */
+  std::vector<mlx::core::array> vjp(
+      const std::vector<mlx::core::array>& primals,
+      const std::vector<mlx::core::array>& cotangents,
+      const std::vector<int>& argnums,
+      const std::vector<mlx::core::array>& outputs) override;
+
+  /**
+   * Compute output shapes from input shapes
+   */
+  std::vector<mlx::core::Shape> output_shapes(
+      const std::vector<mlx::core::array>& inputs) override {
+    // One token per batch row
+    return {{inputs[0].shape(0)}};
+  }
+
+  /**
+   * Primitive identification
+   */
+  const char* name() const override { return "sample_batch_fused"; }
+
+  /**
+   * Check equivalence with another primitive
+   */
+  bool is_equivalent(const mlx::core::Primitive& other) const override;
+
+  /// Maximum candidates retained per row (must match sample_batch.metal)
+  static constexpr int kMaxCandidates = 64;
+
+ private:
+  std::vector<RowSamplingParams> params_;
+
+  // Metal library (loaded lazily on first GPU eval)
+  void* library_;  // Stores MTL::Library*
+
+  /**
+   * Load Metal library containing custom kernels
+   * Returns MTL::Library* (cast from void*)
+   */
+  void* load_metal_library();
+};
+
+/**
+ * Public API function for fused batched sampling
+ *
+ * @param logits Logits [batch, vocab_size], fp32 or fp16; consumed by
+ *        the kernel (sampling must be the last reader of this array)
+ * @param params Per-row sampling parameters, one entry per batch row
+ *        with the uniform draw already filled in
+ * @param penalty_tokens Per-row unique context token IDs (deduplicated;
+ *        rows with repetition_penalty == 1 may be empty)
+ * @param s Stream or device for execution
+ * @return Sampled token IDs [batch] int32
+ */
+mlx::core::array sample_batch_fused(
+    const mlx::core::array& logits,
+    const std::vector<RowSamplingParams>& params,
+    const std::vector<std::vector<int>>& penalty_tokens,
+    mlx::core::StreamOrDevice s = {});
+
+}  // namespace kernels
+}  // namespace mlxr
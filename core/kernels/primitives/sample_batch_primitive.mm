@@ -0,0 +1,394 @@
+// Copyright © 2025 MLXR Development
+// MLX Primitive-based fused batched sampling kernel implementation
+//
+// Samples one token per decode-batch row in a single Metal dispatch
+// (repetition penalty + top-k + temperature softmax + top-p + draw),
+// returning only int32 token IDs to the host. Follows the same MLX
+// Primitive / metallib loading pattern as rmsnorm_primitive.mm.
+
+#include "sample_batch_primitive.h"
+
+#include "pipeline_archive.h"
+
+#include <mlx/allocator.h>
+#include <mlx/ops.h>
+#include <mlx/backend/metal/device.h>
+#include <mlx/transforms.h>  // For eval
+
+#import <Foundation/Foundation.h>
+#import <Metal/Metal.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace mlxr {
+namespace kernels {
+
+// ============================================================================
+// Constructor & Destructor
+// ============================================================================
+
+SampleBatchPrimitive::SampleBatchPrimitive(mlx::core::Stream stream,
+                                           std::vector<RowSamplingParams> params)
+    : mlx::core::Primitive(stream),
+      params_(std::move(params)),
+      library_(nullptr) {
+}
+
+SampleBatchPrimitive::~SampleBatchPrimitive() {
+  // Metal library is managed by MLX's device, no explicit cleanup needed
+}
+
+// ============================================================================
+// Metal Kernel Loading
+// ============================================================================
+
+void* SampleBatchPrimitive::load_metal_library() {
+  if (library_) {
+    return library_;
+  }
+
+  @autoreleasepool {
+    // Get Metal device
+    auto& d = mlx::core::metal::device(stream().device);
+
+    // Find metallib file - search multiple paths
+    NSArray<NSString*>* search_paths = @[
+      @"build/lib/sample_batch.metallib",  // From project root
+      @"../../lib/sample_batch.metallib",  // From test executable in build/cmake/bin
+      @"../lib/sample_batch.metallib",     // From build/cmake
+      @"lib/sample_batch.metallib",        // Direct lib/
+      [@(getenv("PWD") ?: ".") stringByAppendingString:@"/build/lib/sample_batch.metallib"]
+    ];
+
+    NSString* metallib_path = nil;
+    for (NSString* path in search_paths) {
+      if ([[NSFileManager defaultManager] fileExistsAtPath:path]) {
+        metallib_path = path;
+        break;
+      }
+    }
+
+    if (!metallib_path) {
+      throw std::runtime_error(
+          "Failed to find sample_batch.metallib. Please run 'make metal'");
+    }
+
+    // Load Metal library via MLX's device
+    NSURL* url = [NSURL fileURLWithPath:metallib_path];
+    NSError* error = nil;
+
+    auto mtl_device = d.mtl_device();
+    id<MTLDevice> device_objc = (__bridge id<MTLDevice>)mtl_device;
+    id<MTLLibrary> library_objc = [device_objc newLibraryWithURL:url error:&error];
+
+    if (!library_objc) {
+      NSString* err_msg = error ? [error localizedDescription] : @"Unknown error";
+      throw std::runtime_error(
+          "Failed to load Metal library: " +
+          std::string([err_msg UTF8String]));
+    }
+
+    MTL::Library* library_cpp = (__bridge MTL::Library*)library_objc;
+    library_ = static_cast<void*>(library_cpp);
+
+    return library_;
+  }
+}
+
+// ============================================================================
+// CPU Evaluation (Fallback)
+// ============================================================================
+
+void SampleBatchPrimitive::eval_cpu(
+    const std::vector<mlx::core::array>& inputs,
+    std::vector<mlx::core::array>& outputs) {
+
+  assert(inputs.size() == 3);
+  assert(outputs.size() == 1);
+
+  auto& logits = inputs[0];
+  auto& penalty_tokens = inputs[1];
+  auto& penalty_offsets = inputs[2];
+  auto& output = outputs[0];
+
+  int batch = logits.shape(0);
+  int vocab_size = logits.shape(1);
+
+  // Allocate output buffer
+  auto buffer = mlx::core::allocator::malloc(output.nbytes());
+  output.set_data(buffer);
+  int* out_tokens = output.data<int>();
+
+  // Work in fp32 regardless of logits dtype
+  auto logits_f32 = mlx::core::astype(logits, mlx::core::float32);
+  mlx::core::eval(logits_f32);
+  const float* logits_data = logits_f32.data<float>();
+  const int* tokens_data = penalty_tokens.data<int>();
+  const int* offsets_data = penalty_offsets.data<int>();
+
+  for (int b = 0; b < batch; b++) {
+    const RowSamplingParams& p = params_[b];
+    std::vector<float> row(logits_data + static_cast<size_t>(b) * vocab_size,
+                           logits_data + static_cast<size_t>(b + 1) * vocab_size);
+
+    // Repetition penalty over the row's (deduplicated) context IDs
+    if (p.repetition_penalty != 1.0f) {
+      for (int t = offsets_data[b]; t < offsets_data[b + 1]; t++) {
+        int idx = tokens_data[t];
+        if (idx >= 0 && idx < vocab_size) {
+          float v = row[idx];
+          row[idx] = (v > 0.0f) ? v / p.repetition_penalty
+                                : v * p.repetition_penalty;
+        }
+      }
+    }
+
+    bool greedy = (p.temperature <= 0.0f) || (p.top_k == 0 && p.top_p <= 0.0f);
+
+    if (greedy) {
+      out_tokens[b] = static_cast<int>(
+          std::max_element(row.begin(), row.end()) - row.begin());
+      continue;
+    }
+
+    // Candidate extraction: partial sort of the top `budget` logits,
+    // mirroring the kernel's iterative-argmax candidate set
+    int budget = (p.top_k > 0) ? std::min(p.top_k, kMaxCandidates)
+                               : kMaxCandidates;
+    budget = std::min(budget, vocab_size);
+
+    std::vector<int> indices(vocab_size);
+    for (int i = 0; i < vocab_size; i++) {
+      indices[i] = i;
+    }
+    std::partial_sort(indices.begin(), indices.begin() + budget, indices.end(),
+                      [&row](int a, int b2) { return row[a] > row[b2]; });
+
+    // Temperature-scaled softmax over the candidate set
+    float max_val = row[indices[0]];
+    float inv_temp = 1.0f / p.temperature;
+    std::vector<float> probs(budget);
+    float sum = 0.0f;
+    for (int c = 0; c < budget; c++) {
+      float e = std::exp((row[indices[c]] - max_val) * inv_temp);
+      probs[c] = e;
+      sum += e;
+    }
+
+    // Nucleus truncation
+    int keep = budget;
+    if (p.top_p > 0.0f && p.top_p < 1.0f) {
+      float cum = 0.0f;
+      for (int c = 0; c < budget; c++) {
+        cum += probs[c] / sum;
+        if (cum >= p.top_p) {
+          keep = c + 1;
+          break;
+        }
+      }
+    }
+
+    // Categorical draw over the kept prefix
+    float kept_sum = 0.0f;
+    for (int c = 0; c < keep; c++) {
+      kept_sum += probs[c];
+    }
+    float r = p.uniform * kept_sum;
+    float acc = 0.0f;
+    int selected = keep - 1;
+    for (int c = 0; c < keep; c++) {
+      acc += probs[c];
+      if (r <= acc) {
+        selected = c;
+        break;
+      }
+    }
+    out_tokens[b] = indices[selected];
+  }
+}
+
+// ============================================================================
+// GPU Evaluation (Custom Metal Kernel)
+// ============================================================================
+
+void SampleBatchPrimitive::eval_gpu(
+    const std::vector<mlx::core::array>& inputs,
+    std::vector<mlx::core::array>& outputs) {
+
+  assert(inputs.size() == 3);
+  assert(outputs.size() == 1);
+
+  auto& logits = inputs[0];
+  auto& penalty_tokens = inputs[1];
+  auto& penalty_offsets = inputs[2];
+  auto& output = outputs[0];
+
+  if (!logits.flags().row_contiguous) {
+    throw std::runtime_error(
+        "SampleBatchPrimitive requires contiguous logits");
+  }
+
+  uint32_t batch = static_cast<uint32_t>(logits.shape(0));
+  uint32_t vocab_size = static_cast<uint32_t>(logits.shape(1));
+
+  if (params_.size() != batch) {
+    throw std::runtime_error(
+        "SampleBatchPrimitive: params size does not match batch dimension");
+  }
+
+  // Allocate output buffer
+  auto buffer = mlx::core::allocator::malloc(output.nbytes());
+  output.set_data(buffer);
+
+  // Get stream and device
+  auto& s = stream();
+  auto& d = mlx::core::metal::device(s.device);
+
+  // Load our custom Metal library
+  auto* mtl_lib = static_cast<MTL::Library*>(load_metal_library());
+
+  // Get kernel name based on dtype
+  std::string kernel_name = (logits.dtype() == mlx::core::float16)
+                             ? "sample_batch_fused_fp16"
+                             : "sample_batch_fused";
+
+  // Create the pipeline through the binary-archive cache so PSO compilation
+  // is a one-time cost per metallib build, persisted across daemon restarts
+  auto* kernel = static_cast<MTL::ComputePipelineState*>(get_archived_pipeline(
+      d.mtl_device(), mtl_lib, "sample_batch", kernel_name));
+
+  // Get MLX's command encoder and set pipeline
+  auto& compute_encoder = d.get_command_encoder(s.index);
+  compute_encoder.set_compute_pipeline_state(kernel);
+
+  // Bind buffers and parameters. The logits array is bound as an input
+  // even though the kernel scatters into it (penalty + argmax knockout);
+  // sampling is the terminal consumer of the logits so the mutation is
+  // never observed by another node.
+  compute_encoder.set_input_array(logits, 0);
+  compute_encoder.set_bytes(params_.data(),
+                            params_.size() * sizeof(RowSamplingParams), 1);
+  compute_encoder.set_input_array(penalty_tokens, 2);
+  compute_encoder.set_input_array(penalty_offsets, 3);
+  compute_encoder.set_output_array(output, 4);
+  compute_encoder.set_bytes(vocab_size, 5);
+
+  // One threadgroup per batch row; threads cooperate on the vocab scan
+  size_t threads_per_group = 256;
+  MTL::Size grid_dims(batch, 1, 1);
+  MTL::Size group_dims(threads_per_group, 1, 1);
+
+  // Threadgroup scratch: reduction values + indices (2 floats/thread)
+  size_t threadgroup_mem_size = 2 * threads_per_group * sizeof(float);
+  compute_encoder.set_threadgroup_memory_length(threadgroup_mem_size, 0);
+
+  compute_encoder.dispatch_threadgroups(grid_dims, group_dims);
+}
+
+// ============================================================================
+// Function Transformations
+// ============================================================================
+
+std::pair<std::vector<mlx::core::array>, std::vector<int>>
+SampleBatchPrimitive::vmap(
+    const std::vector<mlx::core::array>& inputs,
+    const std::vector<int>& axes) {
+  throw std::runtime_error("SampleBatchPrimitive does not support vmap");
+}
+
+std::vector<mlx::core::array> SampleBatchPrimitive::jvp(
+    const std::vector<mlx::core::array>& primals,
+    const std::vector<mlx::core::array>& tangents,
+    const std::vector<int>& argnums) {
+  throw std::runtime_error("Sampling is not differentiable");
+}
+
+std::vector<mlx::core::array> SampleBatchPrimitive::vjp(
+    const std::vector<mlx::core::array>& primals,
+    const std::vector<mlx::core::array>& cotangents,
+    const std::vector<int>& argnums,
+    const std::vector<mlx::core::array>& outputs) {
+  throw std::runtime_error("Sampling is not differentiable");
+}
+
+bool SampleBatchPrimitive::is_equivalent(
+    const mlx::core::Primitive& other) const {
+  // Per-row parameters (including the uniform draws) differ every
+  // step, so fused sampling nodes are never merged
+  return false;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+mlx::core::array sample_batch_fused(
+    const mlx::core::array& logits,
+    const std::vector<RowSamplingParams>& params,
+    const std::vector<std::vector<int>>& penalty_tokens,
+    mlx::core::StreamOrDevice s) {
+
+  // Validate inputs
+  if (logits.ndim() != 2) {
+    throw std::invalid_argument(
+        "sample_batch_fused expects logits of shape [batch, vocab_size]");
+  }
+
+  int batch = logits.shape(0);
+  if (static_cast<int>(params.size()) != batch) {
+    throw std::invalid_argument(
+        "sample_batch_fused: one RowSamplingParams entry required per row");
+  }
+  if (static_cast<int>(penalty_tokens.size()) != batch) {
+    throw std::invalid_argument(
+        "sample_batch_fused: one penalty token list required per row");
+  }
+
+  auto stream = mlx::core::to_stream(s);
+
+  // Ensure logits are contiguous for the Metal kernel
+  auto logits_contig = logits;
+  if (!logits.flags().row_contiguous) {
+    auto logits_flat = mlx::core::reshape(logits, {-1}, stream);
+    mlx::core::eval(logits_flat);
+    logits_contig = mlx::core::reshape(logits_flat, logits.shape(), stream);
+    mlx::core::eval(logits_contig);
+  }
+
+  // Flatten the per-row context token lists into a CSR-style pair of
+  // arrays: values + [batch + 1] row offsets
+  std::vector<int> flat_tokens;
+  std::vector<int> offsets(batch + 1, 0);
+  for (int b = 0; b < batch; b++) {
+    flat_tokens.insert(flat_tokens.end(), penalty_tokens[b].begin(),
+                       penalty_tokens[b].end());
+    offsets[b + 1] = static_cast<int>(flat_tokens.size());
+  }
+  if (flat_tokens.empty()) {
+    flat_tokens.push_back(0);  // Metal buffers cannot be zero-length
+  }
+
+  auto tokens_arr = mlx::core::array(
+      flat_tokens.begin(), {static_cast<int>(flat_tokens.size())},
+      mlx::core::int32);
+  auto offsets_arr = mlx::core::array(
+      offsets.begin(), {batch + 1}, mlx::core::int32);
+
+  auto primitive = std::make_shared<SampleBatchPrimitive>(stream, params);
+
+  auto outputs = mlx::core::array::make_arrays(
+      {{batch}},                                  // output shapes
+      {mlx::core::int32},                         // output dtypes
+      primitive,                                  // the primitive
+      {logits_contig, tokens_arr, offsets_arr}    // inputs
+  );
+
+  return outputs[0];
+}
+
+}  // namespace kernels
+}  // namespace mlxr
@@ -3,6 +3,10 @@
 
 #include "swiglu_mlp_primitive.h"
 
+#include "../kernel_profiler.h"
+#include "../kernel_tuning.h"
+#include "cpu/neon_kernels.h"
+
 #include <cmath>
 #include <stdexcept>
 #include <sstream>
@@ -68,9 +72,22 @@ void SwiGLUMLPPrimitive::eval_cpu(
 
   // Apply SwiGLU: swish(gate) * up
   // swish(x) = x * sigmoid(x) = x / (1 + exp(-x))
-  auto gate_sigmoid = mlx::core::sigmoid(gate);
-  auto gate_swish = mlx::core::multiply(gate, gate_sigmoid);
-  auto activated = mlx::core::multiply(gate_swish, up);
+  // The elementwise activation goes through the vectorized NEON kernel
+  // when the projections land as contiguous fp32; the MLX graph version
+  // stays as the fallback for other dtypes
+  auto activated = mlx::core::zeros_like(gate);
+  mlx::core::eval(gate);
+  mlx::core::eval(up);
+  if (gate.dtype() == mlx::core::float32 && up.dtype() == mlx::core::float32 &&
+      gate.flags().row_contiguous && up.flags().row_contiguous) {
+    mlx::core::eval(activated);
+    cpu::swiglu(gate.data<float>(), up.data<float>(),
+                activated.data<float>(), static_cast<int>(gate.size()));
+  } else {
+    auto gate_sigmoid = mlx::core::sigmoid(gate);
+    auto gate_swish = mlx::core::multiply(gate, gate_sigmoid);
+    activated = mlx::core::multiply(gate_swish, up);
+  }
 
   // Down projection: [M, hidden_size]
   auto output = mlx::core::matmul(activated, mlx::core::transpose(w_down));
@@ -145,7 +162,11 @@ void SwiGLUMLPPrimitive::eval_gpu(
 
   // Calculate threadgroup size and grid size
   // Each threadgroup processes one output row
-  uint32_t threads_per_threadgroup = 256;
+  // Width is tunable; the autotuner installs per-GPU winners at model load
+  uint32_t threads_per_threadgroup = static_cast<uint32_t>(
+      tuned_threadgroup_width(
+          "swiglu_mlp_fused",
+          swiglu_shape_key(hidden_size_, intermediate_size_), 256));
 
   // Shared memory requirements
   size_t shared_input_size = hidden_size_ * sizeof(uint16_t);  // fp16
@@ -242,6 +263,8 @@ mlx::core::array swiglu_mlp(
     const mlx::core::array* bias_down,
     mlx::core::StreamOrDevice s) {
 
+  ScopedKernelTimer profile_timer("swiglu_mlp_fused");
+
   // Validate shapes
   if (input.ndim() != 2) {
     throw std::invalid_argument("Input must be 2D [M, hidden_size]");
@@ -300,6 +323,8 @@ mlx::core::array swiglu_mlp(
     primitive->eval_cpu(inputs, outputs);
   }
 
+  profile_timer.complete(outputs[0]);
+
   return outputs[0];
 }
 
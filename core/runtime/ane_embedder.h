@@ -0,0 +1,153 @@
+// Copyright © 2025 MLXR Development
+// Apple Neural Engine embedding backend (CoreML bridge)
+
+#pragma once
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mlxr {
+namespace runtime {
+
+/**
+ * @brief Configuration for the ANE embedding backend
+ */
+struct AneEmbedderConfig {
+  // Path to a compiled CoreML model bundle (.mlmodelc). The model is
+  // expected to take int32 "input_ids" and "attention_mask" tensors of
+  // shape [1, max_sequence_length] and emit either a pooled embedding
+  // [1, dim] or per-token hidden states [1, seq, dim] (mean-pooled here)
+  std::string compiled_model_path;
+
+  // Inputs are truncated/padded to this length before dispatch
+  int max_sequence_length = 512;
+
+  // Expected output embedding width; creation fails if the compiled
+  // model disagrees, catching path/model mixups at load instead of
+  // serving wrong-width vectors
+  int embedding_dim = 768;
+};
+
+/**
+ * @brief Embedding forward on the Apple Neural Engine via CoreML
+ *
+ * Encoder-style embedding workloads are small, batch-friendly and
+ * latency-tolerant - exactly what the otherwise-idle ANE is good at.
+ * Routing /v1/embeddings through this backend leaves the GPU entirely
+ * to generation traffic, so a RAG indexer hammering the embeddings
+ * endpoint no longer steals decode throughput from chat.
+ *
+ * The bridge loads a compiled CoreML model with compute units pinned to
+ * CPU+ANE (never GPU) and runs coalesced batches through one CoreML
+ * batch prediction. It is deliberately opportunistic: create() returns
+ * nullptr when the hardware, OS or compiled model is not usable, and
+ * the caller falls back to the regular GPU embedding path.
+ *
+ * Thread-safe: CoreML predictions are internally synchronized, and the
+ * embedding batcher serializes batches anyway.
+ */
+class AneEmbedder {
+ public:
+  /**
+   * @brief Whether this machine can dispatch to the Neural Engine
+   *
+   * True on Apple Silicon (every M-series SoC ships an ANE); false on
+   * Intel Macs and non-Apple builds. Cheap - safe to call per request
+   */
+  static bool is_available();
+
+  /**
+   * @brief Load a compiled embedding model pinned to CPU+ANE
+   * @param config Model path and shape expectations
+   * @return Ready backend, or nullptr if the ANE is unavailable or the
+   *         model failed to load/validate (callers fall back to GPU)
+   */
+  static std::unique_ptr<AneEmbedder> create(const AneEmbedderConfig& config);
+
+  ~AneEmbedder();
+
+  // Disable copy and move (owns CoreML state)
+  AneEmbedder(const AneEmbedder&) = delete;
+  AneEmbedder& operator=(const AneEmbedder&) = delete;
+
+  /**
+   * @brief Embed a batch of tokenized inputs on the ANE
+   * @param batch Token IDs per input (truncated to max_sequence_length)
+   * @return One L2-normalized embedding row per input, same order
+   * @throws std::runtime_error if the CoreML prediction fails; callers
+   *         fall back to the GPU path for that batch
+   */
+  std::vector<std::vector<float>> embed_batch(
+      const std::vector<std::vector<int>>& batch);
+
+  const AneEmbedderConfig& config() const { return config_; }
+
+ private:
+  explicit AneEmbedder(const AneEmbedderConfig& config);
+
+  struct Impl;  // Hides CoreML/ObjC types from C++ includers
+  AneEmbedderConfig config_;
+  std::unique_ptr<Impl> impl_;
+};
+
+namespace ane {
+
+/**
+ * @brief Masked mean pooling over per-token hidden states
+ *
+ * Collapses [seq_len, dim] token states into one row by averaging the
+ * positions where mask is non-zero (padding excluded). Header-only so
+ * the pooling math is unit-testable off-device
+ *
+ * @param token_states Row-major [seq_len, dim] hidden states
+ * @param seq_len Number of token positions
+ * @param dim Hidden width
+ * @param mask Per-position validity (>0 = real token); empty = all valid
+ * @return Pooled row of length dim (zeros if the mask is all padding)
+ */
+inline std::vector<float> masked_mean_pool(const float* token_states,
+                                           int seq_len, int dim,
+                                           const std::vector<int>& mask) {
+  std::vector<float> pooled(dim, 0.0f);
+  int valid = 0;
+  for (int t = 0; t < seq_len; t++) {
+    if (!mask.empty() && (t >= static_cast<int>(mask.size()) || mask[t] <= 0)) {
+      continue;
+    }
+    const float* row = token_states + static_cast<size_t>(t) * dim;
+    for (int d = 0; d < dim; d++) {
+      pooled[d] += row[d];
+    }
+    valid++;
+  }
+  if (valid > 0) {
+    float inv = 1.0f / static_cast<float>(valid);
+    for (float& val : pooled) {
+      val *= inv;
+    }
+  }
+  return pooled;
+}
+
+/**
+ * @brief L2-normalize an embedding row in place (no-op on zero vectors)
+ */
+inline void l2_normalize(std::vector<float>& row) {
+  float norm = 0.0f;
+  for (float val : row) {
+    norm += val * val;
+  }
+  norm = std::sqrt(norm);
+  if (norm > 0.0f) {
+    for (float& val : row) {
+      val /= norm;
+    }
+  }
+}
+
+}  // namespace ane
+
+}  // namespace runtime
+}  // namespace mlxr
@@ -0,0 +1,230 @@
+// Copyright © 2025 MLXR Development
+// Apple Neural Engine embedding backend implementation
+//
+// CoreML is the only public route onto the ANE, so the bridge wraps a
+// compiled .mlmodelc with compute units pinned to CPU+ANE - never the
+// GPU, which belongs to generation traffic. Batches arrive already
+// coalesced by the embedding batcher and go through one CoreML batch
+// prediction; CoreML schedules the per-input predictions onto the ANE
+// back to back without round-tripping to the caller.
+
+#include "ane_embedder.h"
+
+#include <iostream>
+#include <stdexcept>
+
+#import <CoreML/CoreML.h>
+#import <Foundation/Foundation.h>
+
+#if defined(__arm64__)
+#define MLXR_ANE_PRESENT 1
+#else
+#define MLXR_ANE_PRESENT 0
+#endif
+
+namespace mlxr {
+namespace runtime {
+
+struct AneEmbedder::Impl {
+  MLModel* model = nil;
+
+  // Input feature names resolved from the model description at load,
+  // so converters that rename inputs still work
+  NSString* input_ids_name = nil;
+  NSString* attention_mask_name = nil;  // nil if the model has no mask input
+  NSString* output_name = nil;
+};
+
+bool AneEmbedder::is_available() {
+#if MLXR_ANE_PRESENT
+  return true;
+#else
+  return false;
+#endif
+}
+
+AneEmbedder::AneEmbedder(const AneEmbedderConfig& config)
+    : config_(config), impl_(std::make_unique<Impl>()) {}
+
+AneEmbedder::~AneEmbedder() = default;
+
+std::unique_ptr<AneEmbedder> AneEmbedder::create(
+    const AneEmbedderConfig& config) {
+  if (!is_available()) {
+    return nullptr;
+  }
+  if (config.compiled_model_path.empty()) {
+    return nullptr;
+  }
+
+  @autoreleasepool {
+    NSURL* url = [NSURL
+        fileURLWithPath:[NSString
+                            stringWithUTF8String:config.compiled_model_path
+                                                     .c_str()]];
+
+    // Pin to CPU+ANE: MLComputeUnitsAll would let CoreML spill onto the
+    // GPU under load, which is exactly the contention this backend exists
+    // to avoid
+    MLModelConfiguration* ml_config = [[MLModelConfiguration alloc] init];
+    ml_config.computeUnits = MLComputeUnitsCPUAndNeuralEngine;
+
+    NSError* error = nil;
+    MLModel* model = [MLModel modelWithContentsOfURL:url
+                                       configuration:ml_config
+                                               error:&error];
+    if (!model) {
+      std::cerr << "AneEmbedder: failed to load "
+                << config.compiled_model_path << ": "
+                << (error ? error.localizedDescription.UTF8String : "unknown")
+                << std::endl;
+      return nullptr;
+    }
+
+    auto embedder = std::unique_ptr<AneEmbedder>(new AneEmbedder(config));
+    embedder->impl_->model = model;
+
+    // Resolve feature names from the model description rather than
+    // hard-coding converter conventions
+    MLModelDescription* desc = model.modelDescription;
+    for (NSString* name in desc.inputDescriptionsByName) {
+      if ([name containsString:@"mask"]) {
+        embedder->impl_->attention_mask_name = name;
+      } else {
+        embedder->impl_->input_ids_name = name;
+      }
+    }
+    embedder->impl_->output_name = desc.outputDescriptionsByName.allKeys
+                                       .firstObject;
+
+    if (!embedder->impl_->input_ids_name || !embedder->impl_->output_name) {
+      std::cerr << "AneEmbedder: model at " << config.compiled_model_path
+                << " has no usable input/output features" << std::endl;
+      return nullptr;
+    }
+
+    std::cout << "AneEmbedder: loaded " << config.compiled_model_path
+              << " (CPU+ANE, seq=" << config.max_sequence_length
+              << ", dim=" << config.embedding_dim << ")" << std::endl;
+    return embedder;
+  }
+}
+
+std::vector<std::vector<float>> AneEmbedder::embed_batch(
+    const std::vector<std::vector<int>>& batch) {
+  std::vector<std::vector<float>> rows;
+  rows.reserve(batch.size());
+  if (batch.empty()) {
+    return rows;
+  }
+
+  @autoreleasepool {
+    const int seq_len = config_.max_sequence_length;
+    NSArray<NSNumber*>* shape = @[ @1, @(seq_len) ];
+
+    // Build one feature provider per input and submit them as a single
+    // CoreML batch prediction
+    NSMutableArray<MLDictionaryFeatureProvider*>* providers =
+        [NSMutableArray arrayWithCapacity:batch.size()];
+    std::vector<std::vector<int>> masks(batch.size());
+
+    for (size_t i = 0; i < batch.size(); i++) {
+      const auto& tokens = batch[i];
+      NSError* error = nil;
+      MLMultiArray* input_ids =
+          [[MLMultiArray alloc] initWithShape:shape
+                                     dataType:MLMultiArrayDataTypeInt32
+                                        error:&error];
+      MLMultiArray* mask = nil;
+      if (impl_->attention_mask_name) {
+        mask = [[MLMultiArray alloc] initWithShape:shape
+                                          dataType:MLMultiArrayDataTypeInt32
+                                             error:&error];
+      }
+      if (!input_ids || (impl_->attention_mask_name && !mask)) {
+        throw std::runtime_error("AneEmbedder: MLMultiArray allocation failed");
+      }
+
+      int32_t* ids_data = static_cast<int32_t*>(input_ids.dataPointer);
+      int32_t* mask_data = mask ? static_cast<int32_t*>(mask.dataPointer)
+                                : nullptr;
+      masks[i].assign(seq_len, 0);
+      for (int t = 0; t < seq_len; t++) {
+        bool valid = t < static_cast<int>(tokens.size());
+        ids_data[t] = valid ? tokens[t] : 0;
+        masks[i][t] = valid ? 1 : 0;
+        if (mask_data) {
+          mask_data[t] = valid ? 1 : 0;
+        }
+      }
+
+      NSMutableDictionary* features = [NSMutableDictionary dictionary];
+      features[impl_->input_ids_name] =
+          [MLFeatureValue featureValueWithMultiArray:input_ids];
+      if (mask) {
+        features[impl_->attention_mask_name] =
+            [MLFeatureValue featureValueWithMultiArray:mask];
+      }
+      MLDictionaryFeatureProvider* provider =
+          [[MLDictionaryFeatureProvider alloc] initWithDictionary:features
+                                                            error:&error];
+      if (!provider) {
+        throw std::runtime_error("AneEmbedder: feature provider failed");
+      }
+      [providers addObject:provider];
+    }
+
+    MLArrayBatchProvider* batch_provider =
+        [[MLArrayBatchProvider alloc] initWithFeatureProviderArray:providers];
+
+    NSError* error = nil;
+    id<MLBatchProvider> results =
+        [impl_->model predictionsFromBatch:batch_provider error:&error];
+    if (!results) {
+      throw std::runtime_error(
+          std::string("AneEmbedder: prediction failed: ") +
+          (error ? error.localizedDescription.UTF8String : "unknown"));
+    }
+
+    const int dim = config_.embedding_dim;
+    for (NSInteger i = 0; i < results.count; i++) {
+      MLFeatureValue* value = [[results featuresAtIndex:i]
+          featureValueForName:impl_->output_name];
+      MLMultiArray* output = value.multiArrayValue;
+      if (!output) {
+        throw std::runtime_error("AneEmbedder: missing output tensor");
+      }
+
+      if (output.dataType != MLMultiArrayDataTypeFloat32) {
+        // Converters emit fp32 outputs by default; anything else means
+        // the model was compiled with unexpected options
+        throw std::runtime_error("AneEmbedder: expected float32 output");
+      }
+      NSInteger count = output.count;
+      const float* data = static_cast<const float*>(output.dataPointer);
+
+      std::vector<float> row;
+      if (count == dim) {
+        // Model emits a pooled embedding directly
+        row.assign(data, data + dim);
+      } else if (count % dim == 0) {
+        // Per-token hidden states: masked mean pool over real positions
+        int seq = static_cast<int>(count / dim);
+        row = ane::masked_mean_pool(data, seq, dim,
+                                    masks[static_cast<size_t>(i)]);
+      } else {
+        throw std::runtime_error(
+            "AneEmbedder: output size " + std::to_string(count) +
+            " is not a multiple of embedding_dim " + std::to_string(dim));
+      }
+
+      ane::l2_normalize(row);
+      rows.push_back(std::move(row));
+    }
+  }
+
+  return rows;
+}
+
+}  // namespace runtime
+}  // namespace mlxr
@@ -5,6 +5,8 @@
 
 #include "engine.h"
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <stdexcept>
 
@@ -94,6 +96,200 @@ void Engine::release_cache_sequence(InferenceCache* cache) {
   cache->seq_id = -1;
 }
 
+void Engine::finish_cache_sequence(InferenceCache* cache,
+                                   const std::vector<int>& all_tokens) {
+  if (!cache) {
+    return;
+  }
+
+  // Index the conversation's KV (prompt + generated) before the blocks
+  // go back to the pager: the prefix cache takes its own references, so
+  // the next turn's prompt - this history plus one new message - is a
+  // prefix match and only the delta tokens need prefilling
+  if (prefix_cache_ && use_cached_ && pager_ && cache->seq_id >= 0 &&
+      !all_tokens.empty()) {
+    prefix_cache_->insert(all_tokens, cache->seq_id);
+  }
+
+  release_cache_sequence(cache);
+}
+
+bool Engine::swap_out_cache_sequence(InferenceCache* cache) {
+  if (!use_cached_ || !pager_ || cache->seq_id < 0) {
+    return false;  // Simple model path has no paged blocks to demote
+  }
+
+  return pager_->swap_out_sequence(cache->seq_id);
+}
+
+bool Engine::swap_in_cache_sequence(InferenceCache* cache) {
+  if (!use_cached_ || !pager_ || cache->seq_id < 0) {
+    return false;
+  }
+
+  return pager_->swap_in_sequence(cache->seq_id);
+}
+
+bool Engine::enable_streaming_kv(InferenceCache* cache, int sink_blocks,
+                                 int window_blocks) {
+  if (!use_cached_ || !pager_ || !cache || cache->seq_id < 0) {
+    return false;
+  }
+
+  return pager_->enable_streaming_window(cache->seq_id, sink_blocks,
+                                         window_blocks);
+}
+
+bool Engine::fork_cache_sequence(InferenceCache* parent,
+                                 InferenceCache* child) {
+  if (!use_cached_ || !pager_ || !parent || !child || !parent->initialized ||
+      parent->seq_id < 0) {
+    return false;
+  }
+
+  int child_seq_id = next_seq_id_++;
+  if (!pager_->fork_sequence(parent->seq_id, child_seq_id)) {
+    return false;
+  }
+
+  // The child decodes from exactly the parent's position: same token
+  // count, same repetition-penalty frequency table
+  child->seq_id = child_seq_id;
+  child->cached_tokens = parent->cached_tokens;
+  child->initialized = true;
+  child->token_counts = parent->token_counts;
+
+  return true;
+}
+
+void Engine::set_draft_model(std::shared_ptr<graph::LlamaModel> draft_model,
+                             const spec::SpeculativeConfig& spec_config) {
+  draft_model_ = draft_model;
+
+  if (!draft_model_) {
+    spec_decoder_.reset();
+    return;
+  }
+
+  spec_decoder_ = std::make_unique<spec::SpeculativeDecoder>(
+      simple_model_, draft_model_, spec_config);
+
+  std::cout << "[Engine] Speculative decoding enabled (draft proposes "
+            << spec_config.num_draft_tokens << " tokens/step)" << std::endl;
+}
+
+int Engine::warmup(const WarmupConfig& config) {
+  int warmed = 0;
+
+  // Pick a real token ID: BOS when the tokenizer defines one
+  int token = config.warmup_token_id;
+  if (token == 0 && tokenizer_ && tokenizer_->bos_token_id() >= 0) {
+    token = tokenizer_->bos_token_id();
+  }
+
+  // Suspend prefix caching so dummy prompts are not indexed for reuse
+  auto saved_prefix_cache = prefix_cache_;
+  prefix_cache_ = nullptr;
+
+  auto warmup_start = std::chrono::steady_clock::now();
+
+  // Prefill shape buckets: one dummy pass per prompt length
+  for (int len : config.prompt_lengths) {
+    if (len <= 0 || len > config_.max_seq_len) {
+      continue;  // Bucket exceeds the engine's sequence budget
+    }
+
+    InferenceCache cache;
+    try {
+      auto t0 = std::chrono::steady_clock::now();
+      std::vector<int> tokens(len, token);
+      forward_prefill(tokens, &cache);
+      warmed++;
+
+      if (config.verbose) {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - t0)
+                      .count();
+        std::cout << "[Engine] Warmup prefill len=" << len << ": " << ms
+                  << "ms" << std::endl;
+      }
+    } catch (const std::exception& e) {
+      std::cerr << "[Engine] Warmup prefill len=" << len
+                << " skipped: " << e.what() << std::endl;
+    }
+    release_cache_sequence(&cache);
+  }
+
+  // Decode shape buckets: one batched decode step per batch size
+  for (int batch : config.batch_sizes) {
+    if (batch <= 0) {
+      continue;
+    }
+
+    std::vector<InferenceCache> caches(batch);
+    try {
+      auto t0 = std::chrono::steady_clock::now();
+
+      std::vector<InferenceCache*> cache_ptrs;
+      cache_ptrs.reserve(batch);
+      for (auto& cache : caches) {
+        forward_prefill({token}, &cache);
+        cache_ptrs.push_back(&cache);
+      }
+
+      std::vector<int> token_ids(batch, token);
+      forward_decode_batch(token_ids, cache_ptrs);
+      warmed++;
+
+      if (config.verbose) {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - t0)
+                      .count();
+        std::cout << "[Engine] Warmup decode batch=" << batch << ": " << ms
+                  << "ms" << std::endl;
+      }
+    } catch (const std::exception& e) {
+      std::cerr << "[Engine] Warmup decode batch=" << batch
+                << " skipped: " << e.what() << std::endl;
+    }
+    for (auto& cache : caches) {
+      release_cache_sequence(&cache);
+    }
+  }
+
+  prefix_cache_ = saved_prefix_cache;
+
+  // Pin the warmed activation buffers in MLX's buffer cache. The passes
+  // above allocated every intermediate each shape bucket needs; raising
+  // the cache limit to that footprint (plus headroom) keeps those
+  // buffers resident, so steady-state forward passes reuse them instead
+  // of allocating fresh Metal buffers every step. Only ever raise the
+  // limit - a caller-configured larger budget stays in effect
+  if (config.retain_activation_cache) {
+    size_t cache_bytes = mlx::core::get_cache_memory();
+    if (cache_bytes > 0) {
+      auto target = static_cast<size_t>(
+          cache_bytes * std::max(1.0f, config.activation_cache_headroom));
+      size_t previous = mlx::core::set_cache_limit(target);
+      if (previous > target) {
+        mlx::core::set_cache_limit(previous);
+      } else {
+        std::cout << "[Engine] Retaining " << (cache_bytes / (1024 * 1024))
+                  << " MB of warmed activation buffers (cache limit "
+                  << (target / (1024 * 1024)) << " MB)" << std::endl;
+      }
+    }
+  }
+
+  auto total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - warmup_start)
+                      .count();
+  std::cout << "[Engine] Warmup complete: " << warmed << " shape buckets in "
+            << total_ms << "ms" << std::endl;
+
+  return warmed;
+}
+
 std::vector<int> Engine::encode(const std::string& text) {
   return tokenizer_->encode(text);
 }
@@ -147,6 +343,12 @@ graph::Tensor Engine::forward_prefill(const std::vector<int>& input_ids,
     throw std::invalid_argument("Cache cannot be null for forward_prefill");
   }
 
+  // Maintain the sequence's token frequency table so repetition penalty
+  // touches only distinct tokens instead of rescanning the history
+  for (int token_id : input_ids) {
+    cache->token_counts[token_id]++;
+  }
+
   // Convert input_ids to tensor [batch=1, seq_len]
   int seq_len = static_cast<int>(input_ids.size());
   auto input_arr =
@@ -158,18 +360,84 @@ graph::Tensor Engine::forward_prefill(const std::vector<int>& input_ids,
   if (use_cached_) {
     // Cached model path: Use paged KV cache with Metal kernels
 
-    // Allocate sequence in pager
-    allocate_cache_sequence(cache, seq_len);
+    if (cache->initialized && cache->seq_id >= 0) {
+      // Chunked prefill continuation: input_ids is the next chunk of a
+      // prompt whose earlier chunks are already in the sequence's cache
+      int start_pos = cache->cached_tokens;
+      int total_tokens = start_pos + seq_len;
+
+      if (!pager_->allocate_blocks_for_sequence(cache->seq_id,
+                                                total_tokens)) {
+        throw std::runtime_error(
+            "Failed to allocate blocks for prefill chunk, sequence " +
+            std::to_string(cache->seq_id));
+      }
+
+      logits = cached_model_->forward(input_tensor, cache->seq_id, start_pos,
+                                      nullptr);
 
-    // Forward pass through cached model
-    // start_pos=0 for prefill (starting from beginning)
-    logits = cached_model_->forward(input_tensor, cache->seq_id, 0, nullptr);
+      auto* seq = pager_->get_sequence(cache->seq_id);
+      if (seq) {
+        seq->set_num_tokens(total_tokens);
+      }
+      cache->cached_tokens = total_tokens;
+
+      // Extract logits for the chunk's last position [vocab_size]
+      auto chunk_logits = logits.array();
+      mlx::core::eval(chunk_logits);
+      auto last = mlx::core::slice(chunk_logits, {0, seq_len - 1, 0},
+                                   {1, seq_len, logits.shape()[2]}, {1, 1, 1});
+      return graph::Tensor(
+          mlx::core::reshape(last, {logits.shape()[2]}));
+    }
+
+    // Create sequence in pager
+    cache->seq_id = next_seq_id_++;
+    if (!pager_->create_sequence(cache->seq_id)) {
+      throw std::runtime_error("Failed to create sequence " +
+                               std::to_string(cache->seq_id));
+    }
+
+    // Try to reuse cached KV blocks for a shared prompt prefix; matched
+    // blocks attach copy-on-write and only the suffix is computed
+    int matched_tokens = 0;
+    if (prefix_cache_) {
+      matched_tokens = prefix_cache_->match_and_attach(input_ids,
+                                                       cache->seq_id);
+    }
+
+    // Allocate blocks for the remainder of the prompt
+    if (!pager_->allocate_blocks_for_sequence(cache->seq_id, seq_len)) {
+      pager_->delete_sequence(cache->seq_id);
+      throw std::runtime_error("Failed to allocate blocks for sequence " +
+                               std::to_string(cache->seq_id));
+    }
+
+    if (matched_tokens > 0) {
+      // Forward only the unmatched suffix, starting past the cached prefix
+      int suffix_len = seq_len - matched_tokens;
+      auto suffix_arr =
+          mlx::core::array(input_ids.begin() + matched_tokens,
+                           {1, suffix_len}, mlx::core::int32);
+      logits = cached_model_->forward(graph::Tensor(suffix_arr),
+                                      cache->seq_id, matched_tokens, nullptr);
+      seq_len = suffix_len;  // Logits cover only the suffix positions
+    } else {
+      // Full prefill from the beginning
+      logits = cached_model_->forward(input_tensor, cache->seq_id, 0, nullptr);
+    }
 
     // Update cache metadata
+    int total_tokens = static_cast<int>(input_ids.size());
     auto* seq = pager_->get_sequence(cache->seq_id);
     if (seq) {
-      seq->set_num_tokens(seq_len);
-      cache->cached_tokens = seq_len;
+      seq->set_num_tokens(total_tokens);
+      cache->cached_tokens = total_tokens;
+    }
+
+    // Index this prompt's blocks for reuse by later requests
+    if (prefix_cache_) {
+      prefix_cache_->insert(input_ids, cache->seq_id);
     }
   } else {
     // Simple model path: Use concatenation-based KV cache
@@ -209,6 +477,10 @@ graph::Tensor Engine::forward_decode(int token_id, InferenceCache* cache) {
         "Cache not initialized - call forward_prefill first");
   }
 
+  // Count the fed-back token so the frequency table always covers
+  // prompt + generated-so-far at sampling time
+  cache->token_counts[token_id]++;
+
   // Create input tensor for single token [batch=1, seq_len=1]
   std::vector<int> token_vec = {token_id};
   auto input_arr =
@@ -266,6 +538,283 @@ graph::Tensor Engine::forward_decode(int token_id, InferenceCache* cache) {
   return graph::Tensor(last_logits_reshaped);
 }
 
+graph::Tensor Engine::decode_step_async(int token_id, InferenceCache* cache) {
+  // Paged-cache counterpart of forward_decode that dispatches without
+  // blocking; only valid on the cached path (the concatenation cache
+  // cannot be rewound on a mispredicted token)
+  cache->token_counts[token_id]++;
+
+  std::vector<int> token_vec = {token_id};
+  auto input_arr =
+      mlx::core::array(token_vec.begin(), {1, 1}, mlx::core::int32);
+  graph::Tensor input_tensor(input_arr);
+
+  int start_pos = cache->cached_tokens;
+  int new_num_tokens = start_pos + 1;
+  if (!pager_->allocate_blocks_for_sequence(cache->seq_id, new_num_tokens)) {
+    throw std::runtime_error("Failed to allocate blocks for decode");
+  }
+
+  graph::Tensor logits =
+      cached_model_->forward(input_tensor, cache->seq_id, start_pos, nullptr);
+
+  auto* seq = pager_->get_sequence(cache->seq_id);
+  if (seq) {
+    seq->set_num_tokens(new_num_tokens);
+    cache->cached_tokens = new_num_tokens;
+  }
+
+  auto last_logits = mlx::core::slice(logits.array(), {0, 0, 0},
+                                      {1, 1, logits.shape()[2]}, {1, 1, 1});
+  auto last_logits_reshaped =
+      mlx::core::reshape(last_logits, {logits.shape()[2]});
+
+  // Kick the GPU and return immediately; the sampler's eventual eval of
+  // this row waits only for in-flight work
+  mlx::core::async_eval({last_logits_reshaped});
+
+  return graph::Tensor(last_logits_reshaped);
+}
+
+std::vector<graph::Tensor> Engine::forward_decode_batch(
+    const std::vector<int>& token_ids,
+    const std::vector<InferenceCache*>& caches) {
+  if (token_ids.size() != caches.size()) {
+    throw std::invalid_argument(
+        "token_ids and caches must have the same size");
+  }
+  if (token_ids.empty()) {
+    return {};
+  }
+
+  int batch = static_cast<int>(token_ids.size());
+
+  for (int b = 0; b < batch; ++b) {
+    if (!caches[b]) {
+      throw std::invalid_argument("Cache cannot be null for decode batch");
+    }
+    if (!caches[b]->initialized) {
+      throw std::runtime_error(
+          "Cache not initialized - call forward_prefill first");
+    }
+  }
+
+  // Simple model path has no per-sequence page tables - fall back to
+  // per-sequence decode (each one evaluates its own graph)
+  if (!use_cached_) {
+    std::vector<graph::Tensor> results;
+    results.reserve(batch);
+    for (int b = 0; b < batch; ++b) {
+      results.push_back(forward_decode(token_ids[b], caches[b]));
+    }
+    return results;
+  }
+
+  // Cached model path: one fused forward for the whole decode batch
+
+  // Gather sequence IDs and positions, grow page tables up front
+  std::vector<int> seq_ids(batch);
+  std::vector<int> positions(batch);
+  for (int b = 0; b < batch; ++b) {
+    seq_ids[b] = caches[b]->seq_id;
+    positions[b] = caches[b]->cached_tokens;
+
+    int new_num_tokens = positions[b] + 1;
+    if (!pager_->allocate_blocks_for_sequence(seq_ids[b], new_num_tokens)) {
+      throw std::runtime_error("Failed to allocate blocks for decode batch");
+    }
+  }
+
+  // Stack all decode tokens into a single [batch, 1] input
+  auto input_arr =
+      mlx::core::array(token_ids.begin(), {batch, 1}, mlx::core::int32);
+  graph::Tensor input_tensor(input_arr);
+
+  // ONE forward pass for all sequences (evaluated once inside the model)
+  auto logits =
+      cached_model_->forward_decode_batch(input_tensor, seq_ids, positions);
+
+  // Update cache metadata for every sequence
+  for (int b = 0; b < batch; ++b) {
+    int new_num_tokens = positions[b] + 1;
+    auto* seq = pager_->get_sequence(seq_ids[b]);
+    if (seq) {
+      seq->set_num_tokens(new_num_tokens);
+    }
+    caches[b]->cached_tokens = new_num_tokens;
+    caches[b]->token_counts[token_ids[b]]++;
+  }
+
+  // Slice per-sequence logits: [batch, 1, vocab_size] -> batch x [vocab_size]
+  auto logits_arr = logits.array();
+  auto vocab_size = logits.shape()[2];
+
+  std::vector<graph::Tensor> results;
+  results.reserve(batch);
+  for (int b = 0; b < batch; ++b) {
+    auto row = mlx::core::slice(logits_arr, {b, 0, 0},
+                                {b + 1, 1, vocab_size}, {1, 1, 1});
+    results.push_back(graph::Tensor(mlx::core::reshape(row, {vocab_size})));
+  }
+
+  return results;
+}
+
+std::vector<graph::Tensor> Engine::forward_prefill_batch(
+    const std::vector<std::vector<int>>& prompts,
+    const std::vector<InferenceCache*>& caches) {
+  if (prompts.size() != caches.size()) {
+    throw std::invalid_argument("prompts and caches must have the same size");
+  }
+  if (prompts.empty()) {
+    return {};
+  }
+
+  int batch = static_cast<int>(prompts.size());
+
+  for (int b = 0; b < batch; ++b) {
+    if (!caches[b]) {
+      throw std::invalid_argument("Cache cannot be null for prefill batch");
+    }
+    if (prompts[b].empty()) {
+      throw std::invalid_argument("Empty prompt in prefill batch");
+    }
+  }
+
+  // Simple model path has no per-sequence page tables, and a single
+  // prompt gains nothing from packing - fall back to forward_prefill
+  if (!use_cached_ || batch == 1) {
+    std::vector<graph::Tensor> results;
+    results.reserve(batch);
+    for (int b = 0; b < batch; ++b) {
+      results.push_back(forward_prefill(prompts[b], caches[b]));
+    }
+    return results;
+  }
+
+  std::vector<graph::Tensor> results(batch);
+
+  // Set up every sequence first; prompts that hit the prefix cache (or
+  // land on an already-initialized cache, i.e. a chunk continuation)
+  // keep the single-sequence path - their start positions differ, so
+  // they cannot share the packed stream's causal spans
+  std::vector<int> packed_rows;
+  packed_rows.reserve(batch);
+  for (int b = 0; b < batch; ++b) {
+    InferenceCache* cache = caches[b];
+
+    if (cache->initialized && cache->seq_id >= 0) {
+      results[b] = forward_prefill(prompts[b], cache);
+      continue;
+    }
+
+    for (int token_id : prompts[b]) {
+      cache->token_counts[token_id]++;
+    }
+
+    cache->seq_id = next_seq_id_++;
+    if (!pager_->create_sequence(cache->seq_id)) {
+      throw std::runtime_error("Failed to create sequence " +
+                               std::to_string(cache->seq_id));
+    }
+
+    int matched_tokens = 0;
+    if (prefix_cache_) {
+      matched_tokens = prefix_cache_->match_and_attach(prompts[b],
+                                                       cache->seq_id);
+    }
+
+    int seq_len = static_cast<int>(prompts[b].size());
+    if (!pager_->allocate_blocks_for_sequence(cache->seq_id, seq_len)) {
+      pager_->delete_sequence(cache->seq_id);
+      throw std::runtime_error("Failed to allocate blocks for sequence " +
+                               std::to_string(cache->seq_id));
+    }
+
+    if (matched_tokens > 0) {
+      // Prefix hit: forward only the suffix on the single-sequence path
+      int suffix_len = seq_len - matched_tokens;
+      auto suffix_arr =
+          mlx::core::array(prompts[b].begin() + matched_tokens,
+                           {1, suffix_len}, mlx::core::int32);
+      auto logits = cached_model_->forward(graph::Tensor(suffix_arr),
+                                           cache->seq_id, matched_tokens,
+                                           nullptr);
+      auto* seq = pager_->get_sequence(cache->seq_id);
+      if (seq) {
+        seq->set_num_tokens(seq_len);
+      }
+      cache->cached_tokens = seq_len;
+      if (prefix_cache_) {
+        prefix_cache_->insert(prompts[b], cache->seq_id);
+      }
+      cache->initialized = true;
+
+      auto logits_arr = logits.array();
+      mlx::core::eval(logits_arr);
+      auto vocab_size = logits.shape()[2];
+      auto last = mlx::core::slice(logits_arr, {0, suffix_len - 1, 0},
+                                   {1, suffix_len, vocab_size}, {1, 1, 1});
+      results[b] = graph::Tensor(mlx::core::reshape(last, {vocab_size}));
+      continue;
+    }
+
+    packed_rows.push_back(b);
+  }
+
+  if (packed_rows.empty()) {
+    return results;
+  }
+
+  // Pack the remaining prompts into one contiguous token stream with a
+  // cumulative-lengths index - no padding to the longest prompt
+  std::vector<int> all_tokens;
+  std::vector<int> seq_ids;
+  std::vector<int> cu_seqlens;
+  seq_ids.reserve(packed_rows.size());
+  cu_seqlens.reserve(packed_rows.size() + 1);
+  cu_seqlens.push_back(0);
+  for (int b : packed_rows) {
+    all_tokens.insert(all_tokens.end(), prompts[b].begin(), prompts[b].end());
+    seq_ids.push_back(caches[b]->seq_id);
+    cu_seqlens.push_back(static_cast<int>(all_tokens.size()));
+  }
+
+  int total_tokens = static_cast<int>(all_tokens.size());
+  auto input_arr = mlx::core::array(all_tokens.begin(), {1, total_tokens},
+                                    mlx::core::int32);
+
+  // ONE forward pass over the packed stream (evaluated inside the model)
+  auto logits = cached_model_->forward_prefill_packed(
+      graph::Tensor(input_arr), seq_ids, cu_seqlens);
+
+  // Update cache metadata and slice each segment's last-position logits
+  auto logits_arr = logits.array();
+  auto vocab_size = logits.shape()[2];
+
+  for (size_t i = 0; i < packed_rows.size(); ++i) {
+    int b = packed_rows[i];
+    int seq_len = static_cast<int>(prompts[b].size());
+
+    auto* seq = pager_->get_sequence(caches[b]->seq_id);
+    if (seq) {
+      seq->set_num_tokens(seq_len);
+    }
+    caches[b]->cached_tokens = seq_len;
+    if (prefix_cache_) {
+      prefix_cache_->insert(prompts[b], caches[b]->seq_id);
+    }
+    caches[b]->initialized = true;
+
+    int last_pos = cu_seqlens[i + 1] - 1;
+    auto last = mlx::core::slice(logits_arr, {0, last_pos, 0},
+                                 {1, last_pos + 1, vocab_size}, {1, 1, 1});
+    results[b] = graph::Tensor(mlx::core::reshape(last, {vocab_size}));
+  }
+
+  return results;
+}
+
 bool Engine::is_stop_token(int token_id, const std::vector<int>& stop_tokens) {
   return std::find(stop_tokens.begin(), stop_tokens.end(), token_id) !=
          stop_tokens.end();
@@ -299,7 +848,31 @@ std::vector<int> Engine::generate_tokens(const std::vector<int>& input_ids,
   InferenceCache cache;
   bool use_cached_path = (cached_model_ != nullptr);
 
+  // Speculative path: draft model or prompt-lookup proposes, target
+  // verifies in one pass
+  if (use_cached_path &&
+      ((spec_decoder_ && draft_model_) || gen_config.enable_prompt_lookup)) {
+    auto generated_spec =
+        generate_tokens_speculative(input_ids, gen_config, stop_tokens);
+    if (gen_config.echo_prompt) {
+      std::vector<int> with_prompt = input_ids;
+      with_prompt.insert(with_prompt.end(), generated_spec.begin(),
+                         generated_spec.end());
+      return with_prompt;
+    }
+    return generated_spec;
+  }
+
+  // Two-stage decode pipeline (paged path only): while the CPU samples
+  // step t's logits, the GPU already runs step t+1's forward on the
+  // GPU-side argmax of those logits. The concatenation cache cannot be
+  // rewound on a mispredict, so the simple path stays serial
+  bool pipeline = use_cached_path && use_cached_ && pager_ &&
+                  gen_config.pipeline_decode;
+
   // Generation loop
+  graph::Tensor logits;
+  bool have_logits = false;  // Next step's logits already in flight
   for (int i = 0; i < gen_config.max_new_tokens; ++i) {
     // Check max sequence length
     if (static_cast<int>(generated.size()) >= gen_config.max_seq_len) {
@@ -310,23 +883,69 @@ std::vector<int> Engine::generate_tokens(const std::vector<int>& input_ids,
     }
 
     // Forward pass - use prefill/decode path if CachedLlamaModel is available
-    graph::Tensor logits;
-    if (use_cached_path) {
-      if (i == 0) {
-        // First iteration: prefill with entire prompt
-        logits = forward_prefill(generated, &cache);
+    if (!have_logits) {
+      if (use_cached_path) {
+        if (i == 0) {
+          // First iteration: prefill with entire prompt
+          logits = forward_prefill(generated, &cache);
+        } else {
+          // Subsequent iterations: decode with single token
+          logits = forward_decode(generated.back(), &cache);
+        }
+      } else {
+        // Fallback to simple forward (reprocesses entire sequence each time)
+        logits = forward(generated);
+      }
+    }
+    have_logits = false;
+
+    int next_token;
+    bool more_steps =
+        i + 1 < gen_config.max_new_tokens &&
+        static_cast<int>(generated.size()) + 1 < gen_config.max_seq_len;
+    if (pipeline && more_steps) {
+      // Guess the next token with a GPU-side argmax (one scalar sync),
+      // then issue the speculative forward BEFORE sampling evaluates
+      // the full distribution on the CPU
+      auto guess_arr = mlx::core::argmax(logits.array(), /*axis=*/-1,
+                                         /*keepdims=*/false);
+      mlx::core::eval(guess_arr);
+      int guess = guess_arr.item<int>();
+
+      int saved_tokens = cache.cached_tokens;
+      graph::Tensor spec_logits = decode_step_async(guess, &cache);
+
+      // Sampling overlaps the in-flight forward
+      next_token = sampler.sample(logits, generated);
+
+      if (next_token == guess) {
+        // Hit (always, for greedy): step t+1's logits are already
+        // computing, no GPU idle gap between steps
+        logits = spec_logits;
+        have_logits = true;
       } else {
-        // Subsequent iterations: decode with single token
-        logits = forward_decode(generated.back(), &cache);
+        // Mispredict: rewind the cache position and overwrite the
+        // speculative KV row with the sampled token's forward. The
+        // re-run targets the same block slot, so nothing leaks
+        auto count_it = cache.token_counts.find(guess);
+        if (count_it != cache.token_counts.end() &&
+            --count_it->second <= 0) {
+          cache.token_counts.erase(count_it);
+        }
+        cache.cached_tokens = saved_tokens;
+        auto* seq = pager_->get_sequence(cache.seq_id);
+        if (seq) {
+          seq->set_num_tokens(saved_tokens);
+        }
+
+        logits = forward_decode(next_token, &cache);
+        have_logits = true;
       }
     } else {
-      // Fallback to simple forward (reprocesses entire sequence each time)
-      logits = forward(generated);
+      // Sample next token
+      next_token = sampler.sample(logits, generated);
     }
 
-    // Sample next token
-    int next_token = sampler.sample(logits, generated);
-
     // Add to generated sequence
     generated.push_back(next_token);
 
@@ -360,6 +979,209 @@ std::vector<int> Engine::generate_tokens(const std::vector<int>& input_ids,
   return generated;
 }
 
+std::vector<int> Engine::generate_tokens_speculative(
+    const std::vector<int>& input_ids, const GenerationConfig& gen_config,
+    const std::vector<int>& stop_tokens) {
+  InferenceCache cache;
+  graph::KVCache draft_kv;
+  Sampler sampler(gen_config.sampler_config);
+
+  // Prompt-lookup mode proposes from the sequence itself, so no draft
+  // model (or draft-side hooks) are needed. The per-request flag wins
+  // over an attached draft model
+  bool lookup_mode = gen_config.enable_prompt_lookup;
+  if (lookup_mode) {
+    spec::SpeculativeConfig lookup_config;
+    lookup_config.proposal_mode = spec::ProposalMode::PROMPT_LOOKUP;
+    // Verify at the request's sampling temperature so accepted tokens
+    // follow the same distribution as regular decode
+    lookup_config.target_temperature = gen_config.sampler_config.temperature;
+    if (!lookup_decoder_) {
+      lookup_decoder_ = std::make_unique<spec::SpeculativeDecoder>(
+          simple_model_, nullptr, lookup_config);
+    } else {
+      lookup_decoder_->update_config(lookup_config);
+    }
+  }
+  spec::SpeculativeDecoder* decoder =
+      lookup_mode ? lookup_decoder_.get() : spec_decoder_.get();
+
+  // Feed tokens through the draft model's own concatenation cache and
+  // return the last position's logits. (The draft's layer/head geometry
+  // differs from the target's, so it cannot share the paged Arena.)
+  auto draft_forward =
+      [this, &draft_kv](const std::vector<int>& tokens) -> std::vector<float> {
+    int n = static_cast<int>(tokens.size());
+    auto input_arr =
+        mlx::core::array(tokens.begin(), {1, n}, mlx::core::int32);
+    graph::Tensor logits =
+        draft_model_->forward(graph::Tensor(input_arr), nullptr, &draft_kv);
+
+    int vocab_size = logits.shape()[2];
+    auto last = mlx::core::slice(logits.array(), {0, n - 1, 0},
+                                 {1, n, vocab_size}, {1, 1, 1});
+    auto last_f32 = mlx::core::astype(mlx::core::reshape(last, {vocab_size}),
+                                      mlx::core::float32);
+    mlx::core::eval(last_f32);
+
+    const float* data = last_f32.data<float>();
+    return std::vector<float>(data, data + vocab_size);
+  };
+
+  // Feed the verification chunk through the target's paged cache as a
+  // continuation, returning one logits row per position
+  auto target_forward = [this, &cache](const std::vector<int>& tokens)
+      -> std::vector<std::vector<float>> {
+    int n = static_cast<int>(tokens.size());
+    int start_pos = cache.cached_tokens;
+
+    if (!pager_->allocate_blocks_for_sequence(cache.seq_id, start_pos + n)) {
+      return {};  // KV pressure; decoder rejects everything
+    }
+
+    auto input_arr =
+        mlx::core::array(tokens.begin(), {1, n}, mlx::core::int32);
+    graph::Tensor logits = cached_model_->forward(graph::Tensor(input_arr),
+                                                  cache.seq_id, start_pos,
+                                                  nullptr);
+
+    auto* seq = pager_->get_sequence(cache.seq_id);
+    if (seq) {
+      seq->set_num_tokens(start_pos + n);
+    }
+    cache.cached_tokens = start_pos + n;
+
+    int vocab_size = logits.shape()[2];
+    auto logits_f32 =
+        mlx::core::astype(logits.array(), mlx::core::float32);
+    mlx::core::eval(logits_f32);
+
+    const float* data = logits_f32.data<float>();
+    std::vector<std::vector<float>> rows(n);
+    for (int i = 0; i < n; i++) {
+      rows[i].assign(data + static_cast<size_t>(i) * vocab_size,
+                     data + static_cast<size_t>(i + 1) * vocab_size);
+    }
+    return rows;
+  };
+
+  // Rewind the draft cache by slicing each layer's K/V tensors; shape
+  // is [batch, num_kv_heads, cached_len, head_dim]
+  auto draft_rollback = [&draft_kv](int num_tokens) {
+    if (draft_kv.cached_length <= num_tokens) {
+      return;
+    }
+    for (auto& layer_cache : draft_kv.layer_caches) {
+      auto k_shape = layer_cache.first.shape();
+      auto v_shape = layer_cache.second.shape();
+      layer_cache.first = graph::Tensor(mlx::core::slice(
+          layer_cache.first.array(), {0, 0, 0, 0},
+          {k_shape[0], k_shape[1], num_tokens, k_shape[3]}, {1, 1, 1, 1}));
+      layer_cache.second = graph::Tensor(mlx::core::slice(
+          layer_cache.second.array(), {0, 0, 0, 0},
+          {v_shape[0], v_shape[1], num_tokens, v_shape[3]}, {1, 1, 1, 1}));
+    }
+    draft_kv.cached_length = num_tokens;
+  };
+
+  // Rewind the paged cache's bookkeeping; KV entries past num_tokens
+  // are overwritten positionally by the next write
+  auto target_rollback = [this, &cache](int num_tokens) {
+    cache.cached_tokens = num_tokens;
+    auto* seq = pager_->get_sequence(cache.seq_id);
+    if (seq) {
+      seq->set_num_tokens(num_tokens);
+    }
+  };
+
+  if (lookup_mode) {
+    decoder->set_forward_hooks(nullptr, target_forward, nullptr,
+                               target_rollback);
+  } else {
+    decoder->set_forward_hooks(draft_forward, target_forward, draft_rollback,
+                               target_rollback);
+  }
+
+  // Prefill the target on the prompt and sample the first token
+  std::vector<int> generated = input_ids;
+  graph::Tensor prefill_logits = forward_prefill(generated, &cache);
+
+  // Prefill the draft model so both caches hold the prompt
+  if (!lookup_mode) {
+    draft_forward(input_ids);
+  }
+
+  int first_token = sampler.sample(prefill_logits, generated);
+  generated.push_back(first_token);
+
+  bool stopped = is_stop_token(first_token, stop_tokens);
+  if (gen_config.verbose && !stopped) {
+    std::cout << tokenizer_->id_to_token(first_token) << std::flush;
+  }
+
+  while (!stopped) {
+    int num_generated = static_cast<int>(generated.size() - input_ids.size());
+    int remaining = gen_config.max_new_tokens - num_generated;
+    if (remaining <= 0 ||
+        static_cast<int>(generated.size()) >= gen_config.max_seq_len) {
+      break;
+    }
+    remaining = std::min(
+        remaining, gen_config.max_seq_len - static_cast<int>(generated.size()));
+
+    std::vector<int> step_tokens;
+
+    if (decoder->should_speculate() && remaining >= 2) {
+      auto result = decoder->speculate(generated, remaining);
+      step_tokens = result.accepted_tokens;
+      if (result.bonus_token.has_value()) {
+        step_tokens.push_back(result.bonus_token.value());
+      }
+    }
+
+    if (step_tokens.empty()) {
+      // Regular decode step (speculation disabled, acceptance rate too
+      // low, or an empty speculation result). Feed the draft model too
+      // so both caches stay in lockstep (lookup mode has no draft)
+      graph::Tensor logits = forward_decode(generated.back(), &cache);
+      if (!lookup_mode) {
+        draft_forward({generated.back()});
+      }
+      step_tokens.push_back(sampler.sample(logits, generated));
+    }
+
+    for (int token : step_tokens) {
+      generated.push_back(token);
+      if (gen_config.verbose) {
+        std::cout << tokenizer_->id_to_token(token) << std::flush;
+      }
+      if (is_stop_token(token, stop_tokens)) {
+        stopped = true;
+        break;
+      }
+      if (static_cast<int>(generated.size() - input_ids.size()) >=
+              gen_config.max_new_tokens ||
+          static_cast<int>(generated.size()) >= gen_config.max_seq_len) {
+        break;
+      }
+    }
+  }
+
+  if (gen_config.verbose) {
+    auto stats = decoder->get_stats();
+    std::cout << std::endl
+              << "Generated " << (generated.size() - input_ids.size())
+              << " tokens (speculative acceptance rate "
+              << stats.overall_acceptance_rate() << ", "
+              << stats.average_speedup() << " tokens/attempt)" << std::endl;
+  }
+
+  release_cache_sequence(&cache);
+
+  return std::vector<int>(generated.begin() + input_ids.size(),
+                          generated.end());
+}
+
 std::string Engine::generate(const std::string& prompt,
                              const GenerationConfig* config) {
   // Encode prompt
@@ -10,11 +10,14 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "../graph/model.h"
 #include "kv/pager.h"
+#include "kv/prefix_cache.h"
 #include "sampler.h"
+#include "spec/speculative_decoder.h"
 #include "tokenizer/tokenizer.h"
 
 namespace mlxr {
@@ -41,14 +44,57 @@ struct InferenceCache {
   // Whether cache has been initialized
   bool initialized = false;
 
+  // Per-sequence token frequency table, maintained incrementally by
+  // forward_prefill/forward_decode. Repetition penalty iterates only
+  // the (typically few hundred) distinct tokens seen instead of
+  // rescanning the full prompt+generated history against the logits
+  // row every step
+  std::unordered_map<int, int> token_counts;
+
   // Clear the cache
   void clear() {
     kv_cache.clear();
     cached_tokens = 0;
     initialized = false;
+    token_counts.clear();
   }
 };
 
+/**
+ * @brief Configuration for graph warmup at model load
+ *
+ * MLX compiles kernels and traces graphs lazily per shape, so the first
+ * request after a model load pays cold-compilation cost (3-5x slower
+ * than steady state). Warmup runs dummy prefill/decode passes over a
+ * set of shape buckets so steady-state traffic never hits a cold shape.
+ */
+struct WarmupConfig {
+  // Decode batch sizes to pre-trace (shape buckets)
+  std::vector<int> batch_sizes = {1, 4, 16, 64};
+
+  // Prompt lengths to pre-trace for prefill (shape buckets)
+  std::vector<int> prompt_lengths = {128, 512, 2048};
+
+  // Dummy token ID used for warmup inputs (BOS if available, else 0)
+  int warmup_token_id = 0;
+
+  // Retain the activation buffers materialized during warmup in MLX's
+  // buffer cache. Every intermediate a forward pass allocates (hidden
+  // states, attention outputs, MLP activations) comes from that cache;
+  // raising its limit to cover the warmed working set means steady-state
+  // decode steps recycle the same fixed buffers per shape bucket instead
+  // of churning through fresh Metal allocations
+  bool retain_activation_cache = true;
+
+  // Headroom multiplier applied to the measured warmup cache footprint
+  // when raising the cache limit, covering shapes that fall between the
+  // warmed buckets
+  float activation_cache_headroom = 1.5f;
+
+  // Print per-bucket timings
+  bool verbose = false;
+};
+
 /**
  * @brief Configuration for generation
  */
@@ -83,6 +129,22 @@ struct GenerationConfig {
   // Number of KV cache blocks (for paged cache, only used if
   // use_cached_attention=true)
   int kv_num_blocks = 256;  // Total capacity: 32 * 256 = 8192 tokens
+
+  // Enable prompt-lookup (n-gram) self-speculation for this request:
+  // continuations are proposed by matching the current suffix against
+  // earlier spans of the same sequence and verified like draft-model
+  // speculation — no draft model or extra memory needed. Effective on
+  // summarization and code-edit outputs that copy prompt spans.
+  // Only used on the cached-attention path
+  bool enable_prompt_lookup = false;
+
+  // Pipeline the decode loop: while the CPU samples step t's logits,
+  // the GPU already runs step t+1's forward on the GPU-side argmax of
+  // those logits. Greedy sampling always agrees with the guess and
+  // low-temperature sampling usually does; on a disagreement the cache
+  // position is rewound and the forward re-runs with the sampled token.
+  // Closes the GPU idle gap between decode steps on the cached path
+  bool pipeline_decode = true;
 };
 
 /**
@@ -134,9 +196,14 @@ class Engine {
 
   /**
    * @brief Prefill phase: Process prompt tokens and populate KV cache
-   * @param input_ids Input token IDs (prompt tokens)
+   * @param input_ids Input token IDs (prompt tokens, or the next chunk
+   *        of a prompt when called on an already-initialized cache)
    * @param cache KV cache to populate (will be initialized if not already)
    * @return Logits for next token [vocab_size]
+   *
+   * Supports chunked prefill: calling again with an initialized cache
+   * appends input_ids after the previously ingested tokens, so long
+   * prompts can be split across scheduler steps.
    */
   graph::Tensor forward_prefill(const std::vector<int>& input_ids,
                                 InferenceCache* cache);
@@ -149,6 +216,129 @@ class Engine {
    */
   graph::Tensor forward_decode(int token_id, InferenceCache* cache);
 
+  /**
+   * @brief Batched decode phase: Generate next token for multiple sequences
+   * @param token_ids Last generated token ID per sequence
+   * @param caches Existing KV caches, one per sequence (same order)
+   * @return Logits per sequence, each [vocab_size]
+   *
+   * With CachedLlamaModel this stacks all decode tokens into a single
+   * [batch, 1] input and runs ONE forward pass against the per-sequence
+   * page tables, eliminating per-request graph dispatch overhead.
+   * With the simple model it falls back to per-sequence forward_decode.
+   */
+  std::vector<graph::Tensor> forward_decode_batch(
+      const std::vector<int>& token_ids,
+      const std::vector<InferenceCache*>& caches);
+
+  /**
+   * @brief Batched prefill: ingest several prompts in one forward pass
+   * @param prompts Prompt token IDs, one vector per request
+   * @param caches KV caches, one per prompt (same order); must be fresh
+   *        (uninitialized) caches
+   * @return Last-position logits per prompt, each [vocab_size]
+   *
+   * With CachedLlamaModel the prompts are packed into one contiguous
+   * [1, total_tokens] stream with a cumulative-lengths index — no
+   * padding to the longest prompt — so embeddings, norms, MLPs and the
+   * LM head run over exactly the tokens submitted while attention is
+   * computed per segment against each sequence's own page table.
+   * Prompts with a prefix-cache hit (and the simple-model path) fall
+   * back to per-request forward_prefill.
+   */
+  std::vector<graph::Tensor> forward_prefill_batch(
+      const std::vector<std::vector<int>>& prompts,
+      const std::vector<InferenceCache*>& caches);
+
+  /**
+   * @brief Warm up MLX graphs and kernels over shape buckets
+   * @param config Warmup shape buckets and options
+   * @return Number of shape buckets successfully warmed
+   *
+   * Runs dummy prefill passes at each configured prompt length and a
+   * dummy batched decode at each configured batch size, so the kernel
+   * compilation and graph tracing cost is paid at load time instead of
+   * on the first request after a model swap. Buckets exceeding
+   * max_seq_len or the KV block budget are skipped; failures in one
+   * bucket do not abort the rest. All warmup sequences are released
+   * before returning.
+   */
+  int warmup(const WarmupConfig& config = WarmupConfig());
+
+  /**
+   * @brief Demote a cache's KV blocks to the CPU tier (preemption swap-out)
+   * @param cache Inference cache holding the sequence to demote
+   * @return True if the sequence was swapped out
+   *
+   * Called when the scheduler preempts a request: the page table is
+   * kept intact while the blocks move off the GPU, so resuming the
+   * request is a block promotion instead of a full re-prefill. No-op
+   * on the simple (non-paged) model path.
+   */
+  bool swap_out_cache_sequence(InferenceCache* cache);
+
+  /**
+   * @brief Promote a swapped-out cache's KV blocks back to GPU
+   * @param cache Inference cache holding the sequence to promote
+   * @return True if every block is GPU-resident again
+   */
+  bool swap_in_cache_sequence(InferenceCache* cache);
+
+  /**
+   * @brief Put a cache's sequence into StreamingLLM sliding-window mode
+   * @param cache Inference cache holding the sequence
+   * @param sink_blocks Leading "attention sink" blocks kept forever
+   * @param window_blocks Trailing blocks kept as the recency window
+   * @return True if the mode was enabled
+   *
+   * For always-on sessions (live transcription, rolling summarization):
+   * KV memory stays constant at sink + window blocks however long
+   * generation runs, with evicted middle positions masked out of
+   * attention by their page-table holes. No-op false on the simple
+   * (non-paged) model path.
+   */
+  bool enable_streaming_kv(InferenceCache* cache, int sink_blocks,
+                           int window_blocks);
+
+  /**
+   * @brief Fork a prefilled cache into a copy-on-write sibling
+   * @param parent Initialized cache whose KV the sibling will share
+   * @param child Fresh cache that receives the forked sequence
+   * @return True if the child now shares the parent's blocks
+   *
+   * Backs OpenAI n / best_of sampling: n completions run ONE prefill,
+   * fork, and diverge only in decode-time blocks. The pager privatizes
+   * a shared final partial block on a sibling's first decode write
+   * (copy-on-write), so siblings never clobber each other's KV. No-op
+   * false on the simple (non-paged) model path.
+   */
+  bool fork_cache_sequence(InferenceCache* parent, InferenceCache* child);
+
+  /**
+   * @brief Release a finished cache's pager sequence
+   * @param cache Inference cache containing sequence ID to release
+   *
+   * Drops the sequence's block references; blocks still pinned by the
+   * prefix cache or forked sequences stay alive through their own
+   * references. No-op if no sequence was allocated.
+   */
+  void release_cache_sequence(InferenceCache* cache);
+
+  /**
+   * @brief Index a finished sequence's KV for reuse, then release it
+   * @param cache Inference cache for the completed request
+   * @param all_tokens Tokens whose K/V the sequence holds (prompt plus
+   *        every generated token that ran a forward pass)
+   *
+   * Inserts the full conversation history into the prefix cache before
+   * the sequence is deleted, so a follow-up chat turn - whose prompt
+   * replays this history plus one new message - attaches the cached
+   * blocks copy-on-write and prefills only the delta tokens. Falls back
+   * to a plain release when prefix caching is disabled.
+   */
+  void finish_cache_sequence(InferenceCache* cache,
+                             const std::vector<int>& all_tokens);
+
   /**
    * @brief Encode text to token IDs
    * @param text Input text
@@ -168,6 +358,57 @@ class Engine {
    */
   bool is_using_cached_attention() const { return use_cached_; }
 
+  /**
+   * @brief Enable shared-prefix prompt caching
+   * @param prefix_cache Prefix cache layered on this engine's pager
+   *
+   * When set, forward_prefill matches prompts against cached prefixes and
+   * only computes the unmatched suffix; completed prefills are indexed
+   * for reuse by later requests. Only effective with CachedLlamaModel.
+   */
+  void set_prefix_cache(std::shared_ptr<kv::PrefixCache> prefix_cache) {
+    prefix_cache_ = prefix_cache;
+  }
+
+  /**
+   * @brief Get prefix cache (nullptr if disabled)
+   */
+  std::shared_ptr<kv::PrefixCache> prefix_cache() { return prefix_cache_; }
+
+  /**
+   * @brief Get the KV cache pager (nullptr for the simple-model engine)
+   *
+   * Exposed so benchmarks and diagnostics can read arena occupancy
+   * without the engine re-exporting every pager statistic.
+   */
+  std::shared_ptr<kv::Pager> pager() { return pager_; }
+
+  /**
+   * @brief Attach a draft model for speculative decoding
+   * @param draft_model Smaller model that proposes tokens; must share
+   *        the target model's tokenizer/vocabulary
+   * @param spec_config Speculation configuration (k, temperatures,
+   *        acceptance thresholds)
+   *
+   * When set, generate_tokens() proposes k tokens per decode step with
+   * the draft model and verifies them with ONE multi-token target
+   * forward pass, committing the accepted prefix plus one bonus (or
+   * corrective) token. The draft model keeps its own concatenation
+   * KVCache — its layer/head geometry differs from the target's, so it
+   * cannot share the paged Arena's fixed block shape. Speculation is
+   * only active on the cached-attention path; pass nullptr to detach.
+   */
+  void set_draft_model(std::shared_ptr<graph::LlamaModel> draft_model,
+                       const spec::SpeculativeConfig& spec_config =
+                           spec::SpeculativeConfig());
+
+  /**
+   * @brief Get speculative decoder (nullptr if no draft model attached)
+   */
+  spec::SpeculativeDecoder* speculative_decoder() {
+    return spec_decoder_.get();
+  }
+
   /**
    * @brief Get tokenizer reference
    */
@@ -207,10 +448,37 @@ class Engine {
   void allocate_cache_sequence(InferenceCache* cache, int num_tokens);
 
   /**
-   * @brief Release sequence from pager
-   * @param cache Inference cache containing sequence ID to release
+   * @brief Generation loop with draft-model speculation
+   * @param input_ids Input token IDs
+   * @param gen_config Effective generation config
+   * @param stop_tokens Stop tokens (including EOS)
+   * @return Generated token IDs (without prompt)
+   *
+   * Binds per-sequence forward/rollback hooks on the speculative
+   * decoder, prefills both models on the prompt, then alternates
+   * speculation steps with regular decode steps whenever the rolling
+   * acceptance rate drops below the configured minimum. Serves both
+   * the draft-model mode and prompt-lookup self-speculation (the
+   * latter skips all draft-model work).
    */
-  void release_cache_sequence(InferenceCache* cache);
+  std::vector<int> generate_tokens_speculative(
+      const std::vector<int>& input_ids, const GenerationConfig& gen_config,
+      const std::vector<int>& stop_tokens);
+
+  /**
+   * @brief Issue one decode step without waiting for its result
+   * @param token_id Token to feed
+   * @param cache Inference cache (paged path only)
+   * @return Un-materialized logits row [vocab_size]
+   *
+   * Mirrors forward_decode's cached path but dispatches with async_eval
+   * instead of a blocking eval, so the caller's CPU work (sampling the
+   * previous step's logits) overlaps the forward pass. The caller is
+   * responsible for rewinding cache metadata if the step turns out to
+   * have used the wrong token (see the pipelined loop in
+   * generate_tokens)
+   */
+  graph::Tensor decode_step_async(int token_id, InferenceCache* cache);
 
   // Simple model (basic concatenation)
   std::shared_ptr<graph::LlamaModel> simple_model_;
@@ -221,6 +489,19 @@ class Engine {
   // Pager for cached model (nullptr if using simple model)
   std::shared_ptr<kv::Pager> pager_;
 
+  // Optional shared-prefix prompt cache (nullptr if disabled)
+  std::shared_ptr<kv::PrefixCache> prefix_cache_;
+
+  // Optional draft model for speculative decoding (nullptr if disabled)
+  std::shared_ptr<graph::LlamaModel> draft_model_;
+
+  // Speculative decoder (created when a draft model is attached)
+  std::unique_ptr<spec::SpeculativeDecoder> spec_decoder_;
+
+  // Prompt-lookup self-speculation decoder, lazily created on the
+  // first request with enable_prompt_lookup (needs no draft model)
+  std::unique_ptr<spec::SpeculativeDecoder> lookup_decoder_;
+
   // Which model is active
   bool use_cached_;
 
@@ -0,0 +1,601 @@
+// Copyright © 2025 MLXR Development
+// Grammar-constrained decoding implementation
+
+#include "grammar.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include "mlx/mlx.h"
+
+#include "tokenizer/tokenizer.h"
+
+namespace mlxr {
+namespace runtime {
+
+namespace {
+
+using State = CompiledGrammar::State;
+using Sym = CompiledGrammar::Sym;
+
+bool is_ws(unsigned char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool is_digit(unsigned char c) { return c >= '0' && c <= '9'; }
+
+bool is_hex(unsigned char c) {
+  return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// Route after a complete value: the enclosing construct decides what
+// comes next. With a partial (top-only) simulation stack, an empty
+// stack means the routing depends on the real stack below the top, so
+// the caller must defer to a runtime check
+bool value_done(State& state, std::vector<Sym>& stack, bool stack_partial,
+                bool* needs_stack) {
+  if (stack.empty()) {
+    if (stack_partial) {
+      *needs_stack = true;
+      return false;
+    }
+    state = State::DONE;
+  } else if (stack.back() == Sym::OBJ) {
+    state = State::OBJ_NEXT;
+  } else {
+    state = State::ARR_NEXT;
+  }
+  return true;
+}
+
+// Dispatch on the first byte of a value
+bool begin_value(State& state, std::vector<Sym>& stack, unsigned char c) {
+  switch (c) {
+    case '{':
+      stack.push_back(Sym::OBJ);
+      state = State::OBJ_FIRST;
+      return true;
+    case '[':
+      stack.push_back(Sym::ARR);
+      state = State::ARR_FIRST;
+      return true;
+    case '"':
+      state = State::STR;
+      return true;
+    case '-':
+      state = State::NUM_SIGN;
+      return true;
+    case '0':
+      state = State::NUM_ZERO;
+      return true;
+    case 't':
+      state = State::LIT_T1;
+      return true;
+    case 'f':
+      state = State::LIT_F1;
+      return true;
+    case 'n':
+      state = State::LIT_N1;
+      return true;
+    default:
+      if (is_digit(c)) {
+        state = State::NUM_INT;
+        return true;
+      }
+      return false;
+  }
+}
+
+bool advance_impl(State& state, std::vector<Sym>& stack, unsigned char c,
+                  bool stack_partial, bool* needs_stack) {
+  // Numbers have no closing delimiter: they end when a structural byte
+  // follows. Complete the value and reprocess the byte in the new state
+  auto end_number = [&]() -> bool {
+    if (is_ws(c) || c == ',' || c == '}' || c == ']') {
+      if (!value_done(state, stack, stack_partial, needs_stack)) {
+        return false;
+      }
+      return advance_impl(state, stack, c, stack_partial, needs_stack);
+    }
+    return false;
+  };
+
+  switch (state) {
+    case State::VALUE:
+      if (is_ws(c)) return true;
+      return begin_value(state, stack, c);
+
+    case State::OBJ_FIRST:
+      if (is_ws(c)) return true;
+      if (c == '"') {
+        state = State::OBJ_KEY;
+        return true;
+      }
+      if (c == '}') {
+        if (stack.empty() || stack.back() != Sym::OBJ) return false;
+        stack.pop_back();
+        return value_done(state, stack, stack_partial, needs_stack);
+      }
+      return false;
+
+    case State::OBJ_KEY:
+      if (c == '"') {
+        state = State::OBJ_COLON;
+        return true;
+      }
+      if (c == '\\') {
+        state = State::OBJ_KEY_ESC;
+        return true;
+      }
+      return c >= 0x20;  // Control characters must be escaped
+
+    case State::OBJ_KEY_ESC:
+      switch (c) {
+        case '"': case '\\': case '/': case 'b':
+        case 'f': case 'n': case 'r': case 't':
+          state = State::OBJ_KEY;
+          return true;
+        case 'u':
+          state = State::OBJ_KEY_U1;
+          return true;
+        default:
+          return false;
+      }
+
+    case State::OBJ_KEY_U1:
+    case State::OBJ_KEY_U2:
+    case State::OBJ_KEY_U3:
+      if (!is_hex(c)) return false;
+      state = static_cast<State>(static_cast<uint8_t>(state) + 1);
+      return true;
+
+    case State::OBJ_KEY_U4:
+      if (!is_hex(c)) return false;
+      state = State::OBJ_KEY;
+      return true;
+
+    case State::OBJ_COLON:
+      if (is_ws(c)) return true;
+      if (c == ':') {
+        state = State::VALUE;
+        return true;
+      }
+      return false;
+
+    case State::OBJ_NEXT:
+      if (is_ws(c)) return true;
+      if (c == ',') {
+        state = State::OBJ_KEY_REQ;
+        return true;
+      }
+      if (c == '}') {
+        if (stack.empty() || stack.back() != Sym::OBJ) return false;
+        stack.pop_back();
+        return value_done(state, stack, stack_partial, needs_stack);
+      }
+      return false;
+
+    case State::OBJ_KEY_REQ:
+      if (is_ws(c)) return true;
+      if (c == '"') {
+        state = State::OBJ_KEY;
+        return true;
+      }
+      return false;
+
+    case State::ARR_FIRST:
+      if (is_ws(c)) return true;
+      if (c == ']') {
+        if (stack.empty() || stack.back() != Sym::ARR) return false;
+        stack.pop_back();
+        return value_done(state, stack, stack_partial, needs_stack);
+      }
+      return begin_value(state, stack, c);
+
+    case State::ARR_NEXT:
+      if (is_ws(c)) return true;
+      if (c == ',') {
+        state = State::VALUE;
+        return true;
+      }
+      if (c == ']') {
+        if (stack.empty() || stack.back() != Sym::ARR) return false;
+        stack.pop_back();
+        return value_done(state, stack, stack_partial, needs_stack);
+      }
+      return false;
+
+    case State::STR:
+      if (c == '"') {
+        return value_done(state, stack, stack_partial, needs_stack);
+      }
+      if (c == '\\') {
+        state = State::STR_ESC;
+        return true;
+      }
+      return c >= 0x20;
+
+    case State::STR_ESC:
+      switch (c) {
+        case '"': case '\\': case '/': case 'b':
+        case 'f': case 'n': case 'r': case 't':
+          state = State::STR;
+          return true;
+        case 'u':
+          state = State::STR_U1;
+          return true;
+        default:
+          return false;
+      }
+
+    case State::STR_U1:
+    case State::STR_U2:
+    case State::STR_U3:
+      if (!is_hex(c)) return false;
+      state = static_cast<State>(static_cast<uint8_t>(state) + 1);
+      return true;
+
+    case State::STR_U4:
+      if (!is_hex(c)) return false;
+      state = State::STR;
+      return true;
+
+    case State::NUM_SIGN:
+      if (c == '0') {
+        state = State::NUM_ZERO;
+        return true;
+      }
+      if (is_digit(c)) {
+        state = State::NUM_INT;
+        return true;
+      }
+      return false;
+
+    case State::NUM_ZERO:
+      // JSON forbids leading zeros, so no further integer digits here
+      if (c == '.') {
+        state = State::NUM_DOT;
+        return true;
+      }
+      if (c == 'e' || c == 'E') {
+        state = State::NUM_E;
+        return true;
+      }
+      return end_number();
+
+    case State::NUM_INT:
+      if (is_digit(c)) return true;
+      if (c == '.') {
+        state = State::NUM_DOT;
+        return true;
+      }
+      if (c == 'e' || c == 'E') {
+        state = State::NUM_E;
+        return true;
+      }
+      return end_number();
+
+    case State::NUM_DOT:
+      if (is_digit(c)) {
+        state = State::NUM_FRAC;
+        return true;
+      }
+      return false;
+
+    case State::NUM_FRAC:
+      if (is_digit(c)) return true;
+      if (c == 'e' || c == 'E') {
+        state = State::NUM_E;
+        return true;
+      }
+      return end_number();
+
+    case State::NUM_E:
+      if (c == '+' || c == '-') {
+        state = State::NUM_E_SIGN;
+        return true;
+      }
+      if (is_digit(c)) {
+        state = State::NUM_EXP;
+        return true;
+      }
+      return false;
+
+    case State::NUM_E_SIGN:
+      if (is_digit(c)) {
+        state = State::NUM_EXP;
+        return true;
+      }
+      return false;
+
+    case State::NUM_EXP:
+      if (is_digit(c)) return true;
+      return end_number();
+
+    case State::LIT_T1:
+      if (c != 'r') return false;
+      state = State::LIT_T2;
+      return true;
+    case State::LIT_T2:
+      if (c != 'u') return false;
+      state = State::LIT_T3;
+      return true;
+    case State::LIT_T3:
+      if (c != 'e') return false;
+      return value_done(state, stack, stack_partial, needs_stack);
+
+    case State::LIT_F1:
+      if (c != 'a') return false;
+      state = State::LIT_F2;
+      return true;
+    case State::LIT_F2:
+      if (c != 'l') return false;
+      state = State::LIT_F3;
+      return true;
+    case State::LIT_F3:
+      if (c != 's') return false;
+      state = State::LIT_F4;
+      return true;
+    case State::LIT_F4:
+      if (c != 'e') return false;
+      return value_done(state, stack, stack_partial, needs_stack);
+
+    case State::LIT_N1:
+      if (c != 'u') return false;
+      state = State::LIT_N2;
+      return true;
+    case State::LIT_N2:
+      if (c != 'l') return false;
+      state = State::LIT_N3;
+      return true;
+    case State::LIT_N3:
+      if (c != 'l') return false;
+      return value_done(state, stack, stack_partial, needs_stack);
+
+    case State::DONE:
+      return is_ws(c);  // Trailing whitespace only
+  }
+  return false;
+}
+
+// Convert a SentencePiece vocabulary piece into the bytes it emits.
+// "▁" marks a word boundary (space); "<0xNN>" pieces are byte
+// fallbacks; other "<...>" pieces are special markers that emit nothing
+std::string piece_to_bytes(const std::string& piece) {
+  if (piece.size() == 6 && piece.compare(0, 3, "<0x") == 0 &&
+      piece[5] == '>' && is_hex(piece[3]) && is_hex(piece[4])) {
+    auto nibble = [](char c) -> int {
+      if (c >= '0' && c <= '9') return c - '0';
+      if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+      return c - 'A' + 10;
+    };
+    return std::string(1, static_cast<char>((nibble(piece[3]) << 4) |
+                                            nibble(piece[4])));
+  }
+  if (piece.size() >= 2 && piece.front() == '<' && piece.back() == '>') {
+    return "";  // Special marker, no emission
+  }
+
+  static const std::string kSpaceMarker = "\xE2\x96\x81";  // "▁"
+  std::string bytes;
+  bytes.reserve(piece.size());
+  size_t i = 0;
+  while (i < piece.size()) {
+    if (piece.compare(i, kSpaceMarker.size(), kSpaceMarker) == 0) {
+      bytes += ' ';
+      i += kSpaceMarker.size();
+    } else {
+      bytes += piece[i];
+      i++;
+    }
+  }
+  return bytes;
+}
+
+}  // namespace
+
+CompiledGrammar::CompiledGrammar(Tokenizer* tokenizer) {
+  size_t vocab = tokenizer->vocab_size();
+  token_bytes_.resize(vocab);
+  eos_token_id_ = tokenizer->eos_token_id();
+
+  int bos = tokenizer->bos_token_id();
+  int pad = tokenizer->pad_token_id();
+  for (size_t id = 0; id < vocab; id++) {
+    int iid = static_cast<int>(id);
+    if (iid == eos_token_id_ || iid == bos || iid == pad) {
+      continue;  // Control tokens never appear in the output text
+    }
+    token_bytes_[id] = piece_to_bytes(tokenizer->id_to_token(iid));
+  }
+}
+
+bool CompiledGrammar::advance(State& state, std::vector<Sym>& stack,
+                              unsigned char byte) {
+  bool unused = false;
+  return advance_impl(state, stack, byte, /*stack_partial=*/false, &unused);
+}
+
+bool CompiledGrammar::advance_all(State& state, std::vector<Sym>& stack,
+                                  const std::string& bytes) {
+  for (char ch : bytes) {
+    if (!advance(state, stack, static_cast<unsigned char>(ch))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+CompiledGrammar::Fit CompiledGrammar::simulate(State state,
+                                               std::vector<Sym> stack,
+                                               bool stack_partial,
+                                               const std::string& bytes) {
+  bool needs_stack = false;
+  for (char ch : bytes) {
+    if (!advance_impl(state, stack, static_cast<unsigned char>(ch),
+                      stack_partial, &needs_stack)) {
+      return needs_stack ? Fit::NEEDS_STACK : Fit::REJECTED;
+    }
+  }
+  return Fit::ACCEPTED;
+}
+
+int CompiledGrammar::mask_key(State state, const std::vector<Sym>& stack) {
+  int top = stack.empty() ? 0 : (stack.back() == Sym::OBJ ? 1 : 2);
+  return static_cast<int>(state) * 3 + top;
+}
+
+const CompiledGrammar::Mask& CompiledGrammar::mask_for(
+    State state, const std::vector<Sym>& stack) const {
+  int key = mask_key(state, stack);
+  std::lock_guard<std::mutex> lock(mask_mutex_);
+  auto it = masks_.find(key);
+  if (it != masks_.end()) {
+    return it->second;
+  }
+
+  // First visit to this configuration: simulate every token from
+  // (state, top-of-stack). Tokens that pop below the seeded top come
+  // out indeterminate and go on the conditional list
+  Mask mask;
+  mask.allowed.assign(token_bytes_.size(), 0);
+  std::vector<Sym> seed;
+  bool partial = !stack.empty();
+  if (partial) {
+    seed.push_back(stack.back());
+  }
+  for (size_t id = 0; id < token_bytes_.size(); id++) {
+    const std::string& bytes = token_bytes_[id];
+    if (bytes.empty()) {
+      continue;  // Specials and zero-emission tokens stay masked
+    }
+    Fit fit = simulate(state, seed, partial, bytes);
+    if (fit == Fit::ACCEPTED) {
+      mask.allowed[id] = 1;
+    } else if (fit == Fit::NEEDS_STACK) {
+      mask.conditional.push_back(static_cast<int>(id));
+    }
+  }
+
+  // Map nodes are stable and entries are never erased, so the
+  // reference stays valid after the lock is released
+  return masks_.emplace(key, std::move(mask)).first->second;
+}
+
+void CompiledGrammar::fill_allowed(State state, const std::vector<Sym>& stack,
+                                   std::vector<uint8_t>* allowed) const {
+  const Mask& mask = mask_for(state, stack);
+  *allowed = mask.allowed;
+
+  // Resolve stack-dependent tokens against the real full stack
+  for (int id : mask.conditional) {
+    if (simulate(state, stack, /*stack_partial=*/false, token_bytes_[id]) ==
+        Fit::ACCEPTED) {
+      (*allowed)[id] = 1;
+    }
+  }
+
+  // EOS becomes legal once the top-level value is complete
+  if (state == State::DONE && eos_token_id_ >= 0 &&
+      eos_token_id_ < static_cast<int>(allowed->size())) {
+    (*allowed)[eos_token_id_] = 1;
+  }
+}
+
+GrammarConstraint::GrammarConstraint(
+    std::shared_ptr<const CompiledGrammar> grammar)
+    : grammar_(std::move(grammar)) {}
+
+std::shared_ptr<GrammarConstraint> GrammarConstraint::create(
+    const std::string& grammar, Tokenizer* tokenizer) {
+  if (grammar != "json" || tokenizer == nullptr) {
+    return nullptr;
+  }
+
+  // Process-wide compile cache keyed by (grammar hash, tokenizer), so
+  // the vocabulary scan runs once per grammar per loaded model
+  static std::mutex cache_mutex;
+  static std::unordered_map<size_t,
+                            std::shared_ptr<const CompiledGrammar>> cache;
+
+  size_t key = std::hash<std::string>{}(grammar) ^
+               (std::hash<const void*>{}(tokenizer) << 1);
+  std::shared_ptr<const CompiledGrammar> compiled;
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+      compiled = it->second;
+    }
+  }
+  if (!compiled) {
+    compiled = std::make_shared<const CompiledGrammar>(tokenizer);
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    cache.emplace(key, compiled);
+  }
+  return std::shared_ptr<GrammarConstraint>(new GrammarConstraint(compiled));
+}
+
+graph::Tensor GrammarConstraint::mask_logits(
+    const graph::Tensor& logits) const {
+  auto logits_arr = logits.array();
+  mlx::core::eval(logits_arr);
+
+  int vocab_size = logits.shape().back();
+  std::vector<uint8_t> allowed;
+  grammar_->fill_allowed(state_, stack_, &allowed);
+
+  std::vector<float> logits_vec(vocab_size);
+  const float* logits_data = logits_arr.data<float>();
+  std::copy(logits_data, logits_data + vocab_size, logits_vec.begin());
+
+  bool any_allowed = false;
+  float neg_inf = -std::numeric_limits<float>::infinity();
+  for (int i = 0; i < vocab_size; i++) {
+    if (i < static_cast<int>(allowed.size()) && allowed[i]) {
+      any_allowed = true;
+    } else {
+      logits_vec[i] = neg_inf;
+    }
+  }
+  if (!any_allowed) {
+    // Vocabulary cannot express any legal continuation (shouldn't
+    // happen with byte-fallback tokenizers); degrade to unconstrained
+    // rather than hand the sampler an all -inf row
+    return logits;
+  }
+
+  auto masked_arr =
+      mlx::core::array(logits_vec.begin(), {vocab_size}, mlx::core::float32);
+  return graph::Tensor(masked_arr);
+}
+
+bool GrammarConstraint::accept_token(int token_id) {
+  if (token_id == grammar_->eos_token_id()) {
+    return is_complete();
+  }
+  if (token_id < 0 ||
+      token_id >= static_cast<int>(grammar_->vocab_size())) {
+    return false;
+  }
+
+  // Advance on copies so a rejected token leaves the constraint
+  // untouched (a multi-byte token can fail partway through)
+  CompiledGrammar::State state = state_;
+  std::vector<CompiledGrammar::Sym> stack = stack_;
+  if (!CompiledGrammar::advance_all(state, stack,
+                                    grammar_->token_bytes(token_id))) {
+    return false;
+  }
+  state_ = state;
+  stack_ = std::move(stack);
+  return true;
+}
+
+bool GrammarConstraint::is_complete() const {
+  return state_ == CompiledGrammar::State::DONE;
+}
+
+}  // namespace runtime
+}  // namespace mlxr
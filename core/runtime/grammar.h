@@ -0,0 +1,215 @@
+// Copyright © 2025 MLXR Development
+// Grammar-constrained decoding (JSON pushdown automaton + token masks)
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../graph/tensor.h"
+
+namespace mlxr {
+namespace runtime {
+
+class Tokenizer;
+
+/**
+ * @brief Grammar compiled against a tokenizer, with cached token masks
+ *
+ * Holds the byte-level pushdown automaton for a grammar plus, per
+ * visited (automaton state, stack top) pair, a precomputed vocabulary
+ * bitmask: which tokens' byte sequences the automaton can accept from
+ * that configuration. Tokens whose acceptance depends on stack depth
+ * below the top (e.g. a "}]}" piece that pops several levels) land in
+ * a short per-mask "conditional" list and are resolved against the
+ * real stack at sampling time.
+ *
+ * Compilation decodes every vocabulary entry once (the expensive part,
+ * hence the grammar-hash cache in GrammarConstraint::create); masks
+ * are filled lazily per configuration and memoized, so steady-state
+ * masking is a table lookup plus a handful of conditional checks.
+ *
+ * Currently supported grammar: "json" - any single well-formed JSON
+ * value (object, array, string, number, true/false/null), as requested
+ * by OpenAI-style response_format {"type": "json_object"}.
+ */
+class CompiledGrammar {
+ public:
+  // Automaton state (byte-level). Values are dense so masks can be
+  // keyed by (state, stack top) in a flat map
+  enum class State : uint8_t {
+    VALUE,        // Expecting the start of a value
+    OBJ_FIRST,    // After '{': first key or '}'
+    OBJ_KEY,      // Inside a key string
+    OBJ_KEY_ESC,  // Escape inside a key string
+    OBJ_KEY_U1, OBJ_KEY_U2, OBJ_KEY_U3, OBJ_KEY_U4,  // \uXXXX in key
+    OBJ_COLON,    // After key: expect ':'
+    OBJ_NEXT,     // After a member value: ',' or '}'
+    OBJ_KEY_REQ,  // After ',': next key required
+    ARR_FIRST,    // After '[': first element or ']'
+    ARR_NEXT,     // After an element: ',' or ']'
+    STR,          // Inside a value string
+    STR_ESC,      // Escape inside a value string
+    STR_U1, STR_U2, STR_U3, STR_U4,  // \uXXXX in value string
+    NUM_SIGN,     // After '-': digit required
+    NUM_ZERO,     // After leading '0': no more integer digits
+    NUM_INT,      // Integer digits
+    NUM_DOT,      // After '.': fraction digit required
+    NUM_FRAC,     // Fraction digits
+    NUM_E,        // After 'e'/'E': sign or digit
+    NUM_E_SIGN,   // After exponent sign: digit required
+    NUM_EXP,      // Exponent digits
+    LIT_T1, LIT_T2, LIT_T3,          // t-rue
+    LIT_F1, LIT_F2, LIT_F3, LIT_F4,  // f-alse
+    LIT_N1, LIT_N2, LIT_N3,          // n-ull
+    DONE          // Top-level value complete (trailing ws only)
+  };
+
+  // Stack symbol: the enclosing construct
+  enum class Sym : uint8_t { OBJ, ARR };
+
+  /**
+   * @brief Compile the grammar against a tokenizer's vocabulary
+   * @param tokenizer Loaded tokenizer (vocabulary is snapshotted; the
+   *        tokenizer is not retained)
+   */
+  explicit CompiledGrammar(Tokenizer* tokenizer);
+
+  /**
+   * @brief Advance the automaton over one byte
+   * @param state In/out automaton state
+   * @param stack In/out construct stack
+   * @param byte Next output byte
+   * @return True if accepted, false if the byte is invalid here
+   */
+  static bool advance(State& state, std::vector<Sym>& stack,
+                      unsigned char byte);
+
+  /**
+   * @brief Advance the automaton over a byte string
+   * @return True if every byte was accepted
+   */
+  static bool advance_all(State& state, std::vector<Sym>& stack,
+                          const std::string& bytes);
+
+  /**
+   * @brief Fill the allowed-token set for a configuration
+   * @param state Current automaton state
+   * @param stack Current construct stack
+   * @param allowed Out: resized to vocab size; allowed[id] nonzero if
+   *        token id may be sampled. EOS is allowed only when the value
+   *        is complete (state DONE with an empty stack)
+   *
+   * Uses the memoized (state, stack top) mask and resolves its
+   * conditional tokens against the provided stack.
+   */
+  void fill_allowed(State state, const std::vector<Sym>& stack,
+                    std::vector<uint8_t>* allowed) const;
+
+  /**
+   * @brief Get the EOS token ID captured at compile time
+   */
+  int eos_token_id() const { return eos_token_id_; }
+
+  /**
+   * @brief Get the vocabulary size captured at compile time
+   */
+  size_t vocab_size() const { return token_bytes_.size(); }
+
+  /**
+   * @brief Get a token's output bytes as seen by the automaton
+   */
+  const std::string& token_bytes(int id) const { return token_bytes_[id]; }
+
+ private:
+  // Lazily computed mask for one (state, stack top) configuration
+  struct Mask {
+    std::vector<uint8_t> allowed;    // Per-token, decided regardless of
+                                     // deeper stack contents
+    std::vector<int> conditional;    // Tokens needing the real stack
+  };
+
+  // Simulation outcome for one token from one configuration
+  enum class Fit { REJECTED, ACCEPTED, NEEDS_STACK };
+
+  static Fit simulate(State state, std::vector<Sym> stack, bool stack_partial,
+                      const std::string& bytes);
+
+  const Mask& mask_for(State state, const std::vector<Sym>& stack) const;
+
+  static int mask_key(State state, const std::vector<Sym>& stack);
+
+  std::vector<std::string> token_bytes_;  // Emission bytes per token ID
+  int eos_token_id_ = -1;
+
+  // Masks memoized per (state, stack top); grown lazily under lock
+  mutable std::mutex mask_mutex_;
+  mutable std::unordered_map<int, Mask> masks_;
+};
+
+/**
+ * @brief Per-request grammar constraint
+ *
+ * Tracks one sequence's automaton state over a shared CompiledGrammar
+ * and masks logits before sampling so the output is valid by
+ * construction - no parse-and-retry loop on structured endpoints.
+ *
+ * Usage (serving layer creates, worker drives):
+ * @code
+ * auto constraint = GrammarConstraint::create("json", tokenizer);
+ * ...
+ * logits = constraint->mask_logits(logits);
+ * int token = sampler.sample(logits, ...);
+ * constraint->accept_token(token);
+ * @endcode
+ */
+class GrammarConstraint {
+ public:
+  /**
+   * @brief Create a constraint for a grammar, compiling if needed
+   * @param grammar Grammar name; currently "json"
+   * @param tokenizer Loaded tokenizer the masks are computed against
+   * @return Constraint, or nullptr for an unknown grammar
+   *
+   * Compiled grammars are cached process-wide by (grammar hash,
+   * tokenizer), so only the first request for a given grammar pays the
+   * vocabulary scan; subsequent requests share the compiled automaton
+   * and its memoized masks.
+   */
+  static std::shared_ptr<GrammarConstraint> create(const std::string& grammar,
+                                                   Tokenizer* tokenizer);
+
+  /**
+   * @brief Mask disallowed tokens to -inf before sampling
+   * @param logits Next-token logits [vocab_size]
+   * @return Masked logits; EOS stays available once the value completes
+   */
+  graph::Tensor mask_logits(const graph::Tensor& logits) const;
+
+  /**
+   * @brief Advance the automaton over a sampled token
+   * @param token_id Token committed to the sequence
+   * @return False if the token is invalid here (should not happen for
+   *         tokens sampled from masked logits)
+   */
+  bool accept_token(int token_id);
+
+  /**
+   * @brief Check whether a complete value has been produced
+   */
+  bool is_complete() const;
+
+ private:
+  explicit GrammarConstraint(std::shared_ptr<const CompiledGrammar> grammar);
+
+  std::shared_ptr<const CompiledGrammar> grammar_;
+  CompiledGrammar::State state_ = CompiledGrammar::State::VALUE;
+  std::vector<CompiledGrammar::Sym> stack_;
+};
+
+}  // namespace runtime
+}  // namespace mlxr
@@ -6,9 +6,14 @@
 #include "arena.h"
 
 #include <algorithm>
+#include <cstring>
 #include <chrono>
+#include <functional>
 #include <iostream>
 #include <stdexcept>
+#include <thread>
+
+#include "compression.h"
 
 namespace mlxr {
 namespace runtime {
@@ -29,20 +34,33 @@ Block::Block(int id, int location, const ArenaConfig& config)
   std::vector<int> shape = {config.num_layers, config.block_size_tokens,
                             config.num_kv_heads, config.head_dim};
 
+  // Quantized modes store 8-bit payloads plus per-layer scales; this
+  // halves KV memory versus FP16 at a given block budget
+  mlx::core::Dtype storage_dtype = config.quant_mode != KVQuantMode::NONE
+                                       ? mlx::core::int8
+                                       : config.dtype;
+
   // Allocate on GPU or CPU based on location
   if (location == 0) {
     // GPU allocation via MLX (default device)
-    k_data = graph::zeros(shape, config.dtype);
-    v_data = graph::zeros(shape, config.dtype);
+    k_data = graph::zeros(shape, storage_dtype);
+    v_data = graph::zeros(shape, storage_dtype);
   } else {
     // CPU allocation
     // MLX arrays can be created and then moved to CPU if needed
-    k_data = graph::zeros(shape, config.dtype);
-    v_data = graph::zeros(shape, config.dtype);
+    k_data = graph::zeros(shape, storage_dtype);
+    v_data = graph::zeros(shape, storage_dtype);
     // Note: In MLX, arrays are lazy - actual allocation happens on first use
     // For CPU, we'd use mlx::core::eval to materialize and then copy to CPU
     // For now, keep on default device and rely on MLX's unified memory
   }
+
+  if (config.quant_mode != KVQuantMode::NONE) {
+    // Per-layer dequant scales, broadcastable against the payload shape
+    std::vector<int> scale_shape = {config.num_layers, 1, 1, 1};
+    k_scale = graph::zeros(scale_shape, mlx::core::float32);
+    v_scale = graph::zeros(scale_shape, mlx::core::float32);
+  }
 }
 
 // ============================================================================
@@ -51,7 +69,9 @@ Block::Block(int id, int location, const ArenaConfig& config)
 
 Arena::Arena(const ArenaConfig& config)
     : config_(config),
-      next_block_id_(0),
+      num_blocks_created_(0),
+      num_gpu_created_(0),
+      num_cpu_created_(0),
       num_gpu_to_cpu_moves_(0),
       num_cpu_to_gpu_moves_(0),
       timestamp_counter_(0) {
@@ -61,7 +81,7 @@ Arena::Arena(const ArenaConfig& config)
 Arena::~Arena() { clear(); }
 
 void Arena::initialize() {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<std::mutex> lock(growth_mutex_);
 
   // Calculate capacity but use LAZY allocation
   // Blocks will be allocated on-demand in allocate_block()
@@ -71,101 +91,126 @@ void Arena::initialize() {
     num_gpu_blocks = std::max(64, config_.num_blocks - config_.max_cpu_blocks);
   }
 
-  // Reserve capacity but don't pre-allocate (lazy allocation)
-  free_gpu_blocks_.reserve(num_gpu_blocks);
-  blocks_.reserve(num_gpu_blocks);
+  // Reserve the FULL capacity (GPU + CPU overflow) up front so blocks_
+  // never reallocates; readers can then index it without the growth lock
+  int total_capacity = num_gpu_blocks;
+  if (config_.allow_cpu_overflow) {
+    total_capacity += config_.max_cpu_blocks;
+  }
+  blocks_.reserve(total_capacity);
+
+  for (auto& shard : shards_) {
+    shard.free_gpu.reserve(num_gpu_blocks / kNumShards + 1);
+  }
 
-  std::cout << "KV Arena initialized (lazy allocation): capacity="
-            << num_gpu_blocks << " GPU blocks, "
+  std::cout << "KV Arena initialized (lazy allocation, " << kNumShards
+            << " shards): capacity=" << num_gpu_blocks << " GPU blocks, "
             << "block_size=" << config_.block_size_tokens << " tokens"
             << std::endl;
 }
 
 int Arena::allocate_physical_block(int location) {
-  // Create new block (no lock needed - called from locked context)
-  int block_id = next_block_id_++;
-  auto block = std::make_unique<Block>(block_id, location, config_);
+  // Caller holds growth_mutex_. Block IDs equal their index in blocks_,
+  // so lookup is a flat vector index - no hash map
+  int block_id = static_cast<int>(blocks_.size());
+  blocks_.push_back(std::make_unique<Block>(block_id, location, config_));
 
-  int block_index = static_cast<int>(blocks_.size());
-  block_id_to_index_[block_id] = block_index;
-  blocks_.push_back(std::move(block));
+  if (location == 0) {
+    num_gpu_created_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    num_cpu_created_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // Publish last: readers gate blocks_ access on this counter
+  num_blocks_created_.fetch_add(1, std::memory_order_release);
 
   return block_id;
 }
 
-int Arena::allocate_block() {
-  std::lock_guard<std::mutex> lock(mutex_);
+int Arena::home_shard() const {
+  // Spread threads across shards so concurrent allocators rarely collide
+  return static_cast<int>(
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) % kNumShards);
+}
 
-  // Try to allocate from GPU free list first
-  if (!free_gpu_blocks_.empty()) {
-    int block_id = free_gpu_blocks_.back();
-    free_gpu_blocks_.pop_back();
+int Arena::pop_free_block(bool want_gpu) {
+  // Start at the calling thread's home shard, steal from siblings if empty
+  int start = home_shard();
+  for (int i = 0; i < kNumShards; ++i) {
+    Shard& shard = shards_[(start + i) % kNumShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto& list = want_gpu ? shard.free_gpu : shard.free_cpu;
+    if (!list.empty()) {
+      int block_id = list.back();
+      list.pop_back();
+      return block_id;
+    }
+  }
+  return -1;
+}
 
-    Block* block = get_block(block_id);
-    if (block) {
-      block->ref_count = 1;
-      block->dirty = false;
-      block->last_access_time = get_timestamp();
+void Arena::mark_allocated(int block_id) {
+  Block* block = get_block(block_id);
+  if (block) {
+    if (block->is_compressed) {
+      // A freed block may still carry its old compressed payload; the
+      // new owner gets live zeroed tensors like a fresh block. No lock
+      // needed: the block came off a free list, nobody else holds it
+      std::vector<int> shape = {config_.num_layers, config_.block_size_tokens,
+                                config_.num_kv_heads, config_.head_dim};
+      mlx::core::Dtype storage_dtype = config_.quant_mode != KVQuantMode::NONE
+                                           ? mlx::core::int8
+                                           : config_.dtype;
+      block->k_data = graph::zeros(shape, storage_dtype);
+      block->v_data = graph::zeros(shape, storage_dtype);
+      block->k_compressed = {};
+      block->v_compressed = {};
+      block->is_compressed = false;
     }
+    block->ref_count.store(1, std::memory_order_relaxed);
+    block->dirty = false;
+    block->last_access_time = get_timestamp();
+  }
+}
 
+int Arena::allocate_block() {
+  // Fast path: pop from the sharded GPU free lists (no global lock)
+  int block_id = pop_free_block(/*want_gpu=*/true);
+  if (block_id >= 0) {
+    mark_allocated(block_id);
     return block_id;
   }
 
-  // LAZY ALLOCATION: If free list is empty but we're below capacity, allocate a
-  // new block
+  // LAZY ALLOCATION: free lists empty but below capacity - create a new
+  // block under the growth lock (rare after warmup)
   int num_gpu_capacity = config_.num_blocks;
   if (config_.allow_cpu_overflow) {
     num_gpu_capacity =
         std::max(64, config_.num_blocks - config_.max_cpu_blocks);
   }
 
-  int num_gpu_blocks = 0;
-  for (const auto& block : blocks_) {
-    if (block->location == 0) {  // GPU
-      num_gpu_blocks++;
-    }
-  }
-
-  if (num_gpu_blocks < num_gpu_capacity) {
-    // Allocate new GPU block lazily
-    int block_id = allocate_physical_block(0);  // GPU
-    Block* block = get_block(block_id);
-    if (block) {
-      block->ref_count = 1;
-      block->dirty = false;
-      block->last_access_time = get_timestamp();
+  {
+    std::lock_guard<std::mutex> lock(growth_mutex_);
+    if (num_gpu_created_.load(std::memory_order_relaxed) < num_gpu_capacity) {
+      block_id = allocate_physical_block(0);  // GPU
+      mark_allocated(block_id);
+      return block_id;
     }
-    return block_id;
   }
 
   // Try CPU overflow if enabled
   if (config_.allow_cpu_overflow) {
-    if (!free_cpu_blocks_.empty()) {
-      int block_id = free_cpu_blocks_.back();
-      free_cpu_blocks_.pop_back();
-
-      Block* block = get_block(block_id);
-      if (block) {
-        block->ref_count = 1;
-        block->dirty = false;
-        block->last_access_time = get_timestamp();
-      }
-
+    block_id = pop_free_block(/*want_gpu=*/false);
+    if (block_id >= 0) {
+      mark_allocated(block_id);
       return block_id;
     }
 
     // Allocate new CPU block if under limit
-    if (static_cast<int>(free_cpu_blocks_.size()) + num_allocated_blocks() <
-        config_.num_blocks + config_.max_cpu_blocks) {
-      int block_id = allocate_physical_block(1);  // CPU
-
-      Block* block = get_block(block_id);
-      if (block) {
-        block->ref_count = 1;
-        block->dirty = false;
-        block->last_access_time = get_timestamp();
-      }
-
+    std::lock_guard<std::mutex> lock(growth_mutex_);
+    if (num_cpu_created_.load(std::memory_order_relaxed) <
+        config_.max_cpu_blocks) {
+      block_id = allocate_physical_block(1);  // CPU
+      mark_allocated(block_id);
       return block_id;
     }
   }
@@ -192,8 +237,6 @@ std::vector<int> Arena::allocate_blocks(int num_blocks) {
 }
 
 void Arena::free_block(int block_id) {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   Block* block = get_block(block_id);
   if (!block) {
     std::cerr << "Warning: Attempting to free invalid block " << block_id
@@ -201,18 +244,20 @@ void Arena::free_block(int block_id) {
     return;
   }
 
-  // Decrement reference count
-  block->ref_count--;
-
-  // Only add to free list if ref count reaches 0
-  if (block->ref_count <= 0) {
-    block->ref_count = 0;
+  // Decrement reference count; only the thread that takes it to zero
+  // pushes the block onto a free list
+  int prev = block->ref_count.fetch_sub(1, std::memory_order_acq_rel);
+  if (prev <= 1) {
+    block->ref_count.store(0, std::memory_order_relaxed);
     block->dirty = false;
 
+    // Return to the block's home shard so IDs stay spread evenly
+    Shard& shard = shards_[block_id % kNumShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
     if (block->location == 0) {
-      free_gpu_blocks_.push_back(block_id);
+      shard.free_gpu.push_back(block_id);
     } else {
-      free_cpu_blocks_.push_back(block_id);
+      shard.free_cpu.push_back(block_id);
     }
   }
 }
@@ -223,41 +268,144 @@ void Arena::free_blocks(const std::vector<int>& block_ids) {
   }
 }
 
-Block* Arena::get_block(int block_id) {
-  // No lock - assumes caller has lock or is read-only
-  auto it = block_id_to_index_.find(block_id);
-  if (it == block_id_to_index_.end()) {
-    return nullptr;
+int Arena::copy_block(int src_block_id) {
+  Block* src = get_block(src_block_id);
+  if (!src) {
+    std::cerr << "Warning: Attempting to copy invalid block " << src_block_id
+              << std::endl;
+    return -1;
   }
 
-  int index = it->second;
-  if (index < 0 || index >= static_cast<int>(blocks_.size())) {
-    return nullptr;
+  // A demoted source may sit compressed; restore its tensors first
+  if (src->is_compressed && !decompress_block(src_block_id)) {
+    return -1;
+  }
+
+  int dst_block_id = allocate_block();
+  if (dst_block_id < 0) {
+    return -1;  // Arena exhausted; caller decides how to degrade
+  }
+
+  Block* dst = get_block(dst_block_id);
+
+  // Materialized deep copies: the source keeps being read through its
+  // other owners' page tables while the new owner writes into the copy
+  dst->k_data = graph::Tensor(mlx::core::copy(src->k_data.array()));
+  dst->v_data = graph::Tensor(mlx::core::copy(src->v_data.array()));
+  if (config_.quant_mode != KVQuantMode::NONE) {
+    dst->k_scale = graph::Tensor(mlx::core::copy(src->k_scale.array()));
+    dst->v_scale = graph::Tensor(mlx::core::copy(src->v_scale.array()));
   }
+  mlx::core::eval(dst->k_data.array());
+  mlx::core::eval(dst->v_data.array());
+
+  dst->dirty = src->dirty;
+  dst->last_access_time = get_timestamp();
 
-  return blocks_[index].get();
+  return dst_block_id;
 }
 
-const Block* Arena::get_block(int block_id) const {
-  auto it = block_id_to_index_.find(block_id);
-  if (it == block_id_to_index_.end()) {
-    return nullptr;
+bool Arena::compress_block_locked(Block* block) {
+  if (!block) {
+    return false;
+  }
+  if (block->is_compressed) {
+    return true;
   }
 
-  int index = it->second;
-  if (index < 0 || index >= static_cast<int>(blocks_.size())) {
+  // Materialize, snapshot the raw bytes, then drop the tensors so the
+  // compressed payload is the only copy left. Per-layer scale tensors in
+  // quantized modes are a few hundred bytes and stay live
+  mlx::core::eval(block->k_data.array());
+  mlx::core::eval(block->v_data.array());
+
+  const auto& k_arr = block->k_data.array();
+  const auto& v_arr = block->v_data.array();
+  block->k_compressed = compress_kv_payload(
+      reinterpret_cast<const uint8_t*>(k_arr.data<char>()), k_arr.nbytes());
+  block->v_compressed = compress_kv_payload(
+      reinterpret_cast<const uint8_t*>(v_arr.data<char>()), v_arr.nbytes());
+
+  block->k_data = graph::Tensor();
+  block->v_data = graph::Tensor();
+  block->is_compressed = true;
+
+  return true;
+}
+
+bool Arena::decompress_block_locked(Block* block) {
+  if (!block) {
+    return false;
+  }
+  if (!block->is_compressed) {
+    return true;
+  }
+
+  // Rebuild storage tensors matching the Block constructor, then fill
+  // them from the compressed payloads
+  std::vector<int> shape = {config_.num_layers, config_.block_size_tokens,
+                            config_.num_kv_heads, config_.head_dim};
+  mlx::core::Dtype storage_dtype = config_.quant_mode != KVQuantMode::NONE
+                                       ? mlx::core::int8
+                                       : config_.dtype;
+
+  graph::Tensor k = graph::zeros(shape, storage_dtype);
+  graph::Tensor v = graph::zeros(shape, storage_dtype);
+  mlx::core::eval(k.array());
+  mlx::core::eval(v.array());
+
+  if (!decompress_kv_payload(block->k_compressed,
+                             reinterpret_cast<uint8_t*>(k.array().data<char>()),
+                             k.array().nbytes()) ||
+      !decompress_kv_payload(block->v_compressed,
+                             reinterpret_cast<uint8_t*>(v.array().data<char>()),
+                             v.array().nbytes())) {
+    std::cerr << "Warning: Corrupt compressed payload for block "
+              << block->block_id << std::endl;
+    return false;
+  }
+
+  block->k_data = k;
+  block->v_data = v;
+  block->k_compressed = {};
+  block->v_compressed = {};
+  block->is_compressed = false;
+
+  return true;
+}
+
+bool Arena::compress_block(int block_id) {
+  std::lock_guard<std::mutex> lock(growth_mutex_);
+  return compress_block_locked(get_block(block_id));
+}
+
+bool Arena::decompress_block(int block_id) {
+  std::lock_guard<std::mutex> lock(growth_mutex_);
+  return decompress_block_locked(get_block(block_id));
+}
+
+Block* Arena::get_block(int block_id) {
+  // O(1) flat index: block_id == index in blocks_. The acquire load pairs
+  // with the release in allocate_physical_block so the Block is visible
+  if (block_id < 0 ||
+      block_id >= num_blocks_created_.load(std::memory_order_acquire)) {
     return nullptr;
   }
+  return blocks_[block_id].get();
+}
 
-  return blocks_[index].get();
+const Block* Arena::get_block(int block_id) const {
+  if (block_id < 0 ||
+      block_id >= num_blocks_created_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return blocks_[block_id].get();
 }
 
 void Arena::ref_block(int block_id) {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   Block* block = get_block(block_id);
   if (block) {
-    block->ref_count++;
+    block->ref_count.fetch_add(1, std::memory_order_relaxed);
     block->last_access_time = get_timestamp();
   }
 }
@@ -268,8 +416,6 @@ void Arena::unref_block(int block_id) {
 }
 
 void Arena::touch_block(int block_id) {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   Block* block = get_block(block_id);
   if (block) {
     block->last_access_time = get_timestamp();
@@ -277,7 +423,8 @@ void Arena::touch_block(int block_id) {
 }
 
 bool Arena::move_to_cpu(int block_id) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  // Migration is rare; serialize location changes with the growth lock
+  std::lock_guard<std::mutex> lock(growth_mutex_);
 
   Block* block = get_block(block_id);
   if (!block || block->location != 0) {
@@ -294,44 +441,69 @@ bool Arena::move_to_cpu(int block_id) {
   // 2. Mark as CPU location
   block->location = 1;
 
-  num_gpu_to_cpu_moves_++;
+  // 3. Optionally compress the payload and release the tensors; nobody
+  // reads a demoted block until promotion restores it
+  if (config_.compress_cpu_blocks) {
+    compress_block_locked(block);
+  }
+
+  {
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    num_gpu_to_cpu_moves_++;
+  }
 
   return true;
 }
 
 bool Arena::move_to_gpu(int block_id) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<std::mutex> lock(growth_mutex_);
 
   Block* block = get_block(block_id);
   if (!block || block->location != 1) {
     return false;  // Not on CPU or invalid
   }
 
+  // Restore compressed payloads before the block becomes readable again
+  if (block->is_compressed && !decompress_block_locked(block)) {
+    return false;
+  }
+
   // In MLX with unified memory, data is already accessible
   // Just mark as GPU location
   block->location = 0;
 
-  num_cpu_to_gpu_moves_++;
+  {
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    num_cpu_to_gpu_moves_++;
+  }
 
   return true;
 }
 
 int Arena::num_free_gpu_blocks() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return static_cast<int>(free_gpu_blocks_.size());
+  int total = 0;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    total += static_cast<int>(shard.free_gpu.size());
+  }
+  return total;
 }
 
 int Arena::num_free_cpu_blocks() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return static_cast<int>(free_cpu_blocks_.size());
+  int total = 0;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    total += static_cast<int>(shard.free_cpu.size());
+  }
+  return total;
 }
 
 int Arena::num_allocated_blocks() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-
+  // Lock-free scan over the created range
+  int created = num_blocks_created_.load(std::memory_order_acquire);
   int allocated = 0;
-  for (const auto& block : blocks_) {
-    if (block->ref_count > 0) {
+  for (int i = 0; i < created; ++i) {
+    if (blocks_[i]->ref_count.load(std::memory_order_relaxed) > 0) {
       allocated++;
     }
   }
@@ -340,8 +512,6 @@ int Arena::num_allocated_blocks() const {
 }
 
 size_t Arena::memory_usage() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   // Size per block: 2 tensors (K, V) * layers * block_size * heads * head_dim *
   // dtype_size
   size_t dtype_size = 2;  // float16
@@ -352,86 +522,243 @@ size_t Arena::memory_usage() const {
   size_t block_size = 2 * config_.num_layers * config_.block_size_tokens *
                       config_.num_kv_heads * config_.head_dim * dtype_size;
 
-  return blocks_.size() * block_size;
+  return static_cast<size_t>(
+             num_blocks_created_.load(std::memory_order_relaxed)) *
+         block_size;
 }
 
 size_t Arena::gpu_memory_usage() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   size_t dtype_size = (config_.dtype == mlx::core::float32) ? 4 : 2;
   size_t block_size = 2 * config_.num_layers * config_.block_size_tokens *
                       config_.num_kv_heads * config_.head_dim * dtype_size;
 
-  size_t gpu_mem = 0;
-  for (const auto& block : blocks_) {
-    if (block->location == 0) {
-      gpu_mem += block_size;
-    }
-  }
-
-  return gpu_mem;
+  return static_cast<size_t>(
+             num_gpu_created_.load(std::memory_order_relaxed)) *
+         block_size;
 }
 
 size_t Arena::cpu_memory_usage() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   size_t dtype_size = (config_.dtype == mlx::core::float32) ? 4 : 2;
   size_t block_size = 2 * config_.num_layers * config_.block_size_tokens *
                       config_.num_kv_heads * config_.head_dim * dtype_size;
 
-  size_t cpu_mem = 0;
-  for (const auto& block : blocks_) {
-    if (block->location == 1) {
-      cpu_mem += block_size;
+  return static_cast<size_t>(
+             num_cpu_created_.load(std::memory_order_relaxed)) *
+         block_size;
+}
+
+void Arena::rebalance_free_lists() {
+  // Drain every shard, then redistribute IDs round-robin so no shard
+  // starves while siblings sit on long free lists
+  std::vector<int> free_gpu;
+  std::vector<int> free_cpu;
+
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    free_gpu.insert(free_gpu.end(), shard.free_gpu.begin(),
+                    shard.free_gpu.end());
+    free_cpu.insert(free_cpu.end(), shard.free_cpu.begin(),
+                    shard.free_cpu.end());
+    shard.free_gpu.clear();
+    shard.free_cpu.clear();
+  }
+
+  for (size_t i = 0; i < free_gpu.size(); ++i) {
+    Shard& shard = shards_[i % kNumShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.free_gpu.push_back(free_gpu[i]);
+  }
+  for (size_t i = 0; i < free_cpu.size(); ++i) {
+    Shard& shard = shards_[i % kNumShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.free_cpu.push_back(free_cpu[i]);
+  }
+}
+
+int Arena::reclaim_free_cpu_blocks(int max_blocks) {
+  int reclaimed = 0;
+
+  for (auto& shard : shards_) {
+    if (reclaimed >= max_blocks) {
+      break;
+    }
+
+    // Pop candidates under the shard lock, then flip them outside it
+    std::vector<int> taken;
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      while (!shard.free_cpu.empty() &&
+             reclaimed + static_cast<int>(taken.size()) < max_blocks) {
+        taken.push_back(shard.free_cpu.back());
+        shard.free_cpu.pop_back();
+      }
+    }
+
+    for (int block_id : taken) {
+      Block* block = get_block(block_id);
+      if (!block) {
+        continue;
+      }
+
+      // Free blocks hold no live data, so the location flag just
+      // decides where the next owner's data will live. Drop any stale
+      // compressed payload now instead of waiting for reallocation
+      if (block->is_compressed) {
+        block->k_compressed = {};
+        block->v_compressed = {};
+      }
+      block->location = 0;
+
+      Shard& home = shards_[block_id % kNumShards];
+      std::lock_guard<std::mutex> lock(home.mutex);
+      home.free_gpu.push_back(block_id);
+      reclaimed++;
     }
   }
 
-  return cpu_mem;
+  return reclaimed;
 }
 
 void Arena::clear() {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<std::mutex> lock(growth_mutex_);
+
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> shard_lock(shard.mutex);
+    shard.free_gpu.clear();
+    shard.free_cpu.clear();
+  }
 
   blocks_.clear();
-  free_gpu_blocks_.clear();
-  free_cpu_blocks_.clear();
-  block_id_to_index_.clear();
-  next_block_id_ = 0;
-  num_gpu_to_cpu_moves_ = 0;
-  num_cpu_to_gpu_moves_ = 0;
-  timestamp_counter_ = 0;
+  num_blocks_created_.store(0, std::memory_order_release);
+  num_gpu_created_.store(0, std::memory_order_relaxed);
+  num_cpu_created_.store(0, std::memory_order_relaxed);
+
+  {
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    num_gpu_to_cpu_moves_ = 0;
+    num_cpu_to_gpu_moves_ = 0;
+  }
+  timestamp_counter_.store(0, std::memory_order_relaxed);
 }
 
 Arena::Stats Arena::get_stats() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   Stats stats;
-  stats.total_blocks = static_cast<int>(blocks_.size());
-  stats.free_gpu_blocks = static_cast<int>(free_gpu_blocks_.size());
-  stats.free_cpu_blocks = static_cast<int>(free_cpu_blocks_.size());
+  stats.total_blocks = num_blocks_created_.load(std::memory_order_relaxed);
+  stats.free_gpu_blocks = num_free_gpu_blocks();
+  stats.free_cpu_blocks = num_free_cpu_blocks();
   stats.allocated_blocks = num_allocated_blocks();
   stats.total_memory_bytes = memory_usage();
   stats.gpu_memory_bytes = gpu_memory_usage();
   stats.cpu_memory_bytes = cpu_memory_usage();
-  stats.num_gpu_to_cpu_moves = num_gpu_to_cpu_moves_;
-  stats.num_cpu_to_gpu_moves = num_cpu_to_gpu_moves_;
+
+  // Lock-free scan in the style of num_allocated_blocks
+  stats.compressed_cpu_blocks = 0;
+  stats.compressed_cpu_bytes = 0;
+  int created = num_blocks_created_.load(std::memory_order_acquire);
+  for (int i = 0; i < created; ++i) {
+    const Block* block = blocks_[i].get();
+    if (block->is_compressed) {
+      stats.compressed_cpu_blocks++;
+      stats.compressed_cpu_bytes +=
+          block->k_compressed.size() + block->v_compressed.size();
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    stats.num_gpu_to_cpu_moves = num_gpu_to_cpu_moves_;
+    stats.num_cpu_to_gpu_moves = num_cpu_to_gpu_moves_;
+  }
 
   return stats;
 }
 
 uint64_t Arena::get_timestamp() const {
   // Simple monotonic counter for LRU
-  return ++timestamp_counter_;
+  return timestamp_counter_.fetch_add(1, std::memory_order_relaxed) + 1;
 }
 
 // ============================================================================
 // Metal Primitive Bridge Methods
 // ============================================================================
 
+bool Arena::store_block_kv(int block_id, const graph::Tensor& k,
+                           const graph::Tensor& v) {
+  Block* block = get_block(block_id);
+  if (!block) {
+    return false;
+  }
+
+  if (!is_quantized()) {
+    // FP16 mode: direct assignment, matching the existing store path
+    block->k_data = k;
+    block->v_data = v;
+    block->dirty = true;
+    return true;
+  }
+
+  // Symmetric per-layer quantization: scale = max|x| / 127 over the
+  // [block_size, num_kv_heads, head_dim] span of each layer
+  auto quantize = [](const mlx::core::array& x, mlx::core::array* out_q,
+                     mlx::core::array* out_scale) {
+    auto x_f32 = mlx::core::astype(x, mlx::core::float32);
+    auto abs_max = mlx::core::max(mlx::core::abs(x_f32), {1, 2, 3},
+                                  /*keepdims=*/true);
+    auto scale = mlx::core::maximum(
+        mlx::core::divide(abs_max, mlx::core::array(127.0f)),
+        mlx::core::array(1e-8f));
+    auto q = mlx::core::astype(
+        mlx::core::round(mlx::core::divide(x_f32, scale)), mlx::core::int8);
+    *out_q = q;
+    *out_scale = scale;
+  };
+
+  mlx::core::array k_q = block->k_data.array();
+  mlx::core::array k_scale = block->k_scale.array();
+  mlx::core::array v_q = block->v_data.array();
+  mlx::core::array v_scale = block->v_scale.array();
+
+  quantize(k.array(), &k_q, &k_scale);
+  quantize(v.array(), &v_q, &v_scale);
+
+  block->k_data = graph::Tensor(k_q);
+  block->k_scale = graph::Tensor(k_scale);
+  block->v_data = graph::Tensor(v_q);
+  block->v_scale = graph::Tensor(v_scale);
+  block->dirty = true;
+
+  return true;
+}
+
+std::pair<graph::Tensor, graph::Tensor> Arena::load_block_kv(int block_id) {
+  Block* block = get_block(block_id);
+  if (!block) {
+    throw std::runtime_error("Invalid block ID in load_block_kv: " +
+                             std::to_string(block_id));
+  }
+
+  if (!is_quantized()) {
+    return {block->k_data, block->v_data};
+  }
+
+  // Dequantize: int8 payload * per-layer scale, back to the arena dtype
+  auto dequantize = [this](const mlx::core::array& q,
+                           const mlx::core::array& scale) {
+    auto x = mlx::core::multiply(mlx::core::astype(q, mlx::core::float32),
+                                 scale);
+    return mlx::core::astype(x, config_.dtype);
+  };
+
+  auto k = dequantize(block->k_data.array(), block->k_scale.array());
+  auto v = dequantize(block->v_data.array(), block->v_scale.array());
+
+  return {graph::Tensor(k), graph::Tensor(v)};
+}
+
 graph::Tensor Arena::build_k_cache_array(int layer_idx,
                                          const std::vector<int>& block_ids) {
-  std::lock_guard<std::mutex> lock(mutex_);
-
+  // No global lock: the caller owns these blocks via its page table, and
+  // blocks_ lookup is safe against growth (see get_block)
   if (block_ids.empty()) {
     // Return empty tensor if no blocks
     return graph::zeros(
@@ -457,6 +784,13 @@ graph::Tensor Arena::build_k_cache_array(int layer_idx,
     // Extract layer slice: k_data[layer_idx, :, :, :]
     // Shape: [block_size, num_kv_heads, head_dim]
     auto k_arr = block->k_data.array();
+    if (is_quantized()) {
+      // Dequantize for consumers that expect the arena dtype
+      k_arr = mlx::core::astype(
+          mlx::core::multiply(mlx::core::astype(k_arr, mlx::core::float32),
+                              block->k_scale.array()),
+          config_.dtype);
+    }
     auto layer_slice =
         mlx::core::slice(k_arr, {layer_idx, 0, 0, 0},
                          {layer_idx + 1, config_.block_size_tokens,
@@ -484,8 +818,8 @@ graph::Tensor Arena::build_k_cache_array(int layer_idx,
 
 graph::Tensor Arena::build_v_cache_array(int layer_idx,
                                          const std::vector<int>& block_ids) {
-  std::lock_guard<std::mutex> lock(mutex_);
-
+  // No global lock: the caller owns these blocks via its page table, and
+  // blocks_ lookup is safe against growth (see get_block)
   if (block_ids.empty()) {
     // Return empty tensor if no blocks
     return graph::zeros(
@@ -506,6 +840,13 @@ graph::Tensor Arena::build_v_cache_array(int layer_idx,
 
     // Extract layer slice: v_data[layer_idx, :, :, :]
     auto v_arr = block->v_data.array();
+    if (is_quantized()) {
+      // Dequantize for consumers that expect the arena dtype
+      v_arr = mlx::core::astype(
+          mlx::core::multiply(mlx::core::astype(v_arr, mlx::core::float32),
+                              block->v_scale.array()),
+          config_.dtype);
+    }
     auto layer_slice =
         mlx::core::slice(v_arr, {layer_idx, 0, 0, 0},
                          {layer_idx + 1, config_.block_size_tokens,
@@ -532,8 +873,7 @@ graph::Tensor Arena::build_v_cache_array(int layer_idx,
 void Arena::write_k_cache_array(int layer_idx,
                                 const std::vector<int>& block_ids,
                                 const graph::Tensor& k_cache) {
-  std::lock_guard<std::mutex> lock(mutex_);
-
+  // No global lock: the caller owns these blocks via its page table
   if (block_ids.empty()) {
     return;
   }
@@ -624,8 +964,7 @@ void Arena::write_k_cache_array(int layer_idx,
 void Arena::write_v_cache_array(int layer_idx,
                                 const std::vector<int>& block_ids,
                                 const graph::Tensor& v_cache) {
-  std::lock_guard<std::mutex> lock(mutex_);
-
+  // No global lock: the caller owns these blocks via its page table
   if (block_ids.empty()) {
     return;
   }
@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -24,6 +26,21 @@ namespace mlxr {
 namespace runtime {
 namespace kv {
 
+/**
+ * @brief KV cache quantization mode
+ *
+ * Quantized modes store block K/V as 8-bit values with per-block,
+ * per-layer scales, halving KV memory versus FP16 and roughly doubling
+ * how many sequences stay resident at a given block budget.
+ */
+enum class KVQuantMode {
+  NONE,      ///< FP16 storage (default)
+  INT8,      ///< Symmetric INT8 with per-block/per-layer scales
+  FP8_E4M3,  ///< 8-bit storage targeting the FP8 shader variant
+             ///< (MLX has no FP8 dtype, so host-side storage uses the
+             ///< same INT8 scheme; the distinction selects the kernel)
+};
+
 /**
  * @brief Configuration for KV cache arena
  */
@@ -40,6 +57,12 @@ struct ArenaConfig {
   // Maximum blocks on CPU before eviction required
   int max_cpu_blocks = 256;
 
+  // Compress demoted blocks' payloads (LZ4 with FP16 byte-plane
+  // splitting) and release their tensors. 1.5-2.5x more suspended
+  // sessions fit in the CPU budget; promotion decompresses. When off,
+  // demotion stays a logical move in unified memory
+  bool compress_cpu_blocks = true;
+
   // Model dimensions
   int num_layers = 32;
   int num_kv_heads = 4;
@@ -47,6 +70,9 @@ struct ArenaConfig {
 
   // Data type for KV cache
   mlx::core::Dtype dtype = mlx::core::float16;
+
+  // Quantization mode for block storage
+  KVQuantMode quant_mode = KVQuantMode::NONE;
 };
 
 /**
@@ -60,7 +86,8 @@ struct Block {
   int block_id;
 
   // Reference count (number of sequences using this block)
-  int ref_count;
+  // Atomic so ref/unref need no global lock on the scheduler hot path
+  std::atomic<int> ref_count;
 
   // Location: 0=GPU, 1=CPU
   int location;
@@ -72,11 +99,25 @@ struct Block {
   uint64_t last_access_time;
 
   // K tensor storage: [num_layers, block_size_tokens, num_kv_heads, head_dim]
+  // int8 when the arena runs in a quantized mode, config dtype otherwise
   graph::Tensor k_data;
 
   // V tensor storage: [num_layers, block_size_tokens, num_kv_heads, head_dim]
+  // int8 when the arena runs in a quantized mode, config dtype otherwise
   graph::Tensor v_data;
 
+  // Per-layer dequantization scales: [num_layers, 1, 1, 1] (fp32)
+  // Only allocated in quantized modes
+  graph::Tensor k_scale;
+  graph::Tensor v_scale;
+
+  // Compressed K/V payloads for CPU-resident blocks (empty while the
+  // tensors are live). Demotion compresses the payload and releases the
+  // tensors; promotion decompresses into fresh ones. See compression.h
+  std::vector<uint8_t> k_compressed;
+  std::vector<uint8_t> v_compressed;
+  bool is_compressed = false;
+
   Block(int id, int location, const ArenaConfig& config);
 };
 
@@ -128,6 +169,17 @@ class Arena {
    */
   void free_blocks(const std::vector<int>& block_ids);
 
+  /**
+   * @brief Deep-copy a block's K/V payload into a freshly allocated block
+   * @param src_block_id Block to duplicate
+   * @return New block ID holding a private copy, or -1 on failure
+   *
+   * Backs the pager's copy-on-write resolution: a forked sequence about
+   * to append into a block it still shares gets its own copy first, so
+   * siblings never see each other's decode-time writes.
+   */
+  int copy_block(int src_block_id);
+
   /**
    * @brief Get reference to a block
    * @param block_id Block ID
@@ -168,6 +220,25 @@ class Arena {
    */
   bool move_to_gpu(int block_id);
 
+  /**
+   * @brief Compress a block's K/V payload and release its tensors
+   * @param block_id Block to compress
+   * @return True if the block is compressed on return
+   *
+   * Intended for CPU-resident blocks nobody reads until promotion.
+   * No-op success on an already compressed block.
+   */
+  bool compress_block(int block_id);
+
+  /**
+   * @brief Restore a compressed block's K/V tensors
+   * @param block_id Block to decompress
+   * @return True if the block holds live tensors on return
+   *
+   * No-op success on a block that was never compressed.
+   */
+  bool decompress_block(int block_id);
+
   /**
    * @brief Get number of free blocks on GPU
    */
@@ -221,6 +292,8 @@ class Arena {
     size_t cpu_memory_bytes;
     int num_gpu_to_cpu_moves;
     int num_cpu_to_gpu_moves;
+    int compressed_cpu_blocks;
+    size_t compressed_cpu_bytes;
   };
 
   Stats get_stats() const;
@@ -269,6 +342,37 @@ class Arena {
   void write_v_cache_array(int layer_idx, const std::vector<int>& block_ids,
                            const graph::Tensor& v_cache);
 
+  /**
+   * @brief Check whether blocks are stored quantized
+   */
+  bool is_quantized() const {
+    return config_.quant_mode != KVQuantMode::NONE;
+  }
+
+  /**
+   * @brief Quantize K/V tensors into a block's 8-bit storage
+   * @param block_id Destination block
+   * @param k K tensor [num_layers, block_size, num_kv_heads, head_dim]
+   * @param v V tensor (same shape)
+   * @return True if successful
+   *
+   * Computes symmetric per-layer scales (max-abs / 127) and stores
+   * rounded int8 values plus the scales in the block. No-op passthrough
+   * assignment when the arena is not quantized.
+   */
+  bool store_block_kv(int block_id, const graph::Tensor& k,
+                      const graph::Tensor& v);
+
+  /**
+   * @brief Load a block's K/V dequantized back to the arena dtype
+   * @param block_id Source block
+   * @return Pair of (K, V) tensors in config dtype
+   *
+   * In quantized modes this multiplies the int8 payload by the stored
+   * per-layer scales; otherwise it returns the block tensors directly.
+   */
+  std::pair<graph::Tensor, graph::Tensor> load_block_kv(int block_id);
+
   /**
    * @brief Get raw MLX arrays for K cache blocks (ZERO-COPY)
    * @param block_ids Block IDs in page table order
@@ -293,7 +397,42 @@ class Arena {
   std::vector<mlx::core::array> get_v_block_arrays(
       const std::vector<int>& block_ids);
 
+  /**
+   * @brief Rebalance free lists across shards
+   *
+   * Evens out free GPU/CPU block counts so allocation rarely needs to
+   * steal from sibling shards. Cheap; safe to call periodically.
+   */
+  void rebalance_free_lists();
+
+  /**
+   * @brief Return free CPU-listed blocks to the GPU tier
+   * @param max_blocks Maximum blocks to reclaim this call
+   * @return Number of blocks reclaimed
+   *
+   * A GPU block demoted by migration and later freed lands on the CPU
+   * free list, so long-running daemons slowly bleed GPU-tier capacity
+   * into the overflow tier and big prefill allocations start failing
+   * well below full utilization. Free blocks carry no payload; flipping
+   * them back costs nothing on unified memory and restores them to the
+   * allocator's GPU fast path.
+   */
+  int reclaim_free_cpu_blocks(int max_blocks);
+
  private:
+  // Number of free-list shards; allocation/free contend only within a
+  // shard instead of on one global lock
+  static constexpr int kNumShards = 8;
+
+  /**
+   * @brief Sharded free lists with their own locks
+   */
+  struct Shard {
+    std::mutex mutex;
+    std::vector<int> free_gpu;
+    std::vector<int> free_cpu;
+  };
+
   /**
    * @brief Initialize arena by pre-allocating blocks
    */
@@ -303,9 +442,43 @@ class Arena {
    * @brief Allocate a new physical block
    * @param location 0=GPU, 1=CPU
    * @return Block ID
+   *
+   * Caller must hold growth_mutex_. Block IDs equal their index in
+   * blocks_, giving O(1) lookup without a hash map.
    */
   int allocate_physical_block(int location);
 
+  /**
+   * @brief Home shard for the calling thread
+   */
+  int home_shard() const;
+
+  /**
+   * @brief Pop a free block from the shards, starting at the home shard
+   * @param want_gpu True for GPU free lists, false for CPU
+   * @return Block ID, or -1 if all shards are empty
+   */
+  int pop_free_block(bool want_gpu);
+
+  /**
+   * @brief Mark a block allocated (ref count, timestamps)
+   */
+  void mark_allocated(int block_id);
+
+  /**
+   * @brief Compress a block's payload in place
+   *
+   * Caller must hold growth_mutex_.
+   */
+  bool compress_block_locked(Block* block);
+
+  /**
+   * @brief Decompress a block's payload in place
+   *
+   * Caller must hold growth_mutex_.
+   */
+  bool decompress_block_locked(Block* block);
+
   /**
    * @brief Get current timestamp for LRU tracking
    */
@@ -314,20 +487,20 @@ class Arena {
   // Configuration
   ArenaConfig config_;
 
-  // All blocks (both free and allocated)
+  // All blocks, indexed by block_id. Pre-reserved to full capacity in
+  // initialize() so concurrent reads never race a reallocation; growth
+  // (push_back) is guarded by growth_mutex_ and published via
+  // num_blocks_created_
   std::vector<std::unique_ptr<Block>> blocks_;
+  std::atomic<int> num_blocks_created_;
+  std::atomic<int> num_gpu_created_;
+  std::atomic<int> num_cpu_created_;
 
-  // Free block IDs on GPU
-  std::vector<int> free_gpu_blocks_;
-
-  // Free block IDs on CPU
-  std::vector<int> free_cpu_blocks_;
+  // Sharded free lists
+  mutable std::array<Shard, kNumShards> shards_;
 
-  // Mapping from block ID to block index
-  std::unordered_map<int, int> block_id_to_index_;
-
-  // Next block ID to assign
-  int next_block_id_;
+  // Guards lazy physical block creation (rare after warmup)
+  mutable std::mutex growth_mutex_;
 
   // Statistics
   mutable std::mutex stats_mutex_;
@@ -335,10 +508,7 @@ class Arena {
   int num_cpu_to_gpu_moves_;
 
   // Timestamp counter
-  mutable uint64_t timestamp_counter_;
-
-  // Thread safety
-  mutable std::mutex mutex_;
+  mutable std::atomic<uint64_t> timestamp_counter_;
 };
 
 }  // namespace kv
@@ -0,0 +1,321 @@
+/**
+ * @file compression.cpp
+ * @brief LZ4 block codec and FP16 byte-plane payload wrapper
+ */
+
+#include "compression.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mlxr {
+namespace runtime {
+namespace kv {
+
+namespace {
+
+// LZ4 block format constants
+constexpr int kHashLog = 12;           // 4096-entry hash table
+constexpr size_t kMinMatch = 4;        // Minimum match length
+constexpr size_t kMFLimit = 12;        // No match may start in the last 12 B
+constexpr size_t kLastLiterals = 5;    // Last 5 bytes are always literals
+constexpr size_t kMaxOffset = 65535;   // 16-bit match offsets
+
+// Payload wrapper modes (first byte of the compressed payload)
+constexpr uint8_t kModeRaw = 0;        // Stored uncompressed
+constexpr uint8_t kModePlanes = 1;     // Byte-plane split + two LZ4 streams
+constexpr uint8_t kModeSingle = 2;     // Single LZ4 stream
+
+inline uint32_t read32(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// Fibonacci hashing of the next 4 bytes
+inline uint32_t hash32(uint32_t v) {
+  return (v * 2654435761u) >> (32 - kHashLog);
+}
+
+// LZ4 length extension: a nibble of 15 is followed by bytes that each
+// add up to 255, terminated by the first byte below 255
+void write_length(std::vector<uint8_t>& out, size_t len) {
+  while (len >= 255) {
+    out.push_back(255);
+    len -= 255;
+  }
+  out.push_back(static_cast<uint8_t>(len));
+}
+
+void write_u32(std::vector<uint8_t>& out, uint32_t v) {
+  out.push_back(static_cast<uint8_t>(v & 0xFF));
+  out.push_back(static_cast<uint8_t>((v >> 8) & 0xFF));
+  out.push_back(static_cast<uint8_t>((v >> 16) & 0xFF));
+  out.push_back(static_cast<uint8_t>((v >> 24) & 0xFF));
+}
+
+uint32_t read_u32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+}  // namespace
+
+std::vector<uint8_t> lz4_compress(const uint8_t* src, size_t src_size) {
+  std::vector<uint8_t> out;
+  if (!src || src_size == 0) {
+    return out;
+  }
+  out.reserve(src_size / 2 + 16);
+
+  // Position+1 per hash bucket; 0 means empty
+  std::vector<uint32_t> table(size_t(1) << kHashLog, 0);
+
+  size_t ip = 0;
+  size_t anchor = 0;
+  const size_t mflimit = src_size > kMFLimit ? src_size - kMFLimit : 0;
+
+  while (ip < mflimit) {
+    uint32_t h = hash32(read32(src + ip));
+    uint32_t stored = table[h];
+    table[h] = static_cast<uint32_t>(ip) + 1;
+
+    if (stored == 0) {
+      ++ip;
+      continue;
+    }
+    size_t ref = stored - 1;
+    if (ip - ref > kMaxOffset || read32(src + ref) != read32(src + ip)) {
+      ++ip;
+      continue;
+    }
+
+    // Extend the match forward, staying clear of the tail literals
+    size_t limit = src_size - kLastLiterals;
+    size_t match_end = ip + kMinMatch;
+    size_t mref = ref + kMinMatch;
+    while (match_end < limit && src[match_end] == src[mref]) {
+      ++match_end;
+      ++mref;
+    }
+    size_t match_len = match_end - ip;
+
+    // Token: high nibble literal length, low nibble match length - 4
+    size_t lit_len = ip - anchor;
+    size_t ml_code = match_len - kMinMatch;
+    uint8_t token =
+        static_cast<uint8_t>((std::min<size_t>(lit_len, 15) << 4) |
+                             std::min<size_t>(ml_code, 15));
+    out.push_back(token);
+    if (lit_len >= 15) {
+      write_length(out, lit_len - 15);
+    }
+    out.insert(out.end(), src + anchor, src + ip);
+
+    uint16_t offset = static_cast<uint16_t>(ip - ref);
+    out.push_back(static_cast<uint8_t>(offset & 0xFF));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+    if (ml_code >= 15) {
+      write_length(out, ml_code - 15);
+    }
+
+    ip = match_end;
+    anchor = ip;
+    if (ip < mflimit && ip >= 2) {
+      // Seed the table with a position inside the match so runs of the
+      // same pattern keep finding nearby references
+      table[hash32(read32(src + ip - 2))] = static_cast<uint32_t>(ip - 2) + 1;
+    }
+  }
+
+  // Final sequence: literals only, no match
+  size_t lit_len = src_size - anchor;
+  uint8_t token = static_cast<uint8_t>(std::min<size_t>(lit_len, 15) << 4);
+  out.push_back(token);
+  if (lit_len >= 15) {
+    write_length(out, lit_len - 15);
+  }
+  out.insert(out.end(), src + anchor, src + src_size);
+
+  return out;
+}
+
+bool lz4_decompress(const uint8_t* src, size_t src_size, uint8_t* dst,
+                    size_t dst_size) {
+  if (!src || !dst) {
+    return false;
+  }
+
+  size_t ip = 0;
+  size_t op = 0;
+
+  while (ip < src_size) {
+    uint8_t token = src[ip++];
+
+    // Literals
+    size_t lit_len = token >> 4;
+    if (lit_len == 15) {
+      uint8_t b;
+      do {
+        if (ip >= src_size) {
+          return false;
+        }
+        b = src[ip++];
+        lit_len += b;
+      } while (b == 255);
+    }
+    if (ip + lit_len > src_size || op + lit_len > dst_size) {
+      return false;
+    }
+    std::memcpy(dst + op, src + ip, lit_len);
+    ip += lit_len;
+    op += lit_len;
+
+    if (ip >= src_size) {
+      break;  // Last sequence carries no match
+    }
+
+    // Match: 16-bit offset back into the output, then length
+    if (ip + 2 > src_size) {
+      return false;
+    }
+    size_t offset = static_cast<size_t>(src[ip]) |
+                    (static_cast<size_t>(src[ip + 1]) << 8);
+    ip += 2;
+    if (offset == 0 || offset > op) {
+      return false;
+    }
+
+    size_t match_len = token & 15;
+    if (match_len == 15) {
+      uint8_t b;
+      do {
+        if (ip >= src_size) {
+          return false;
+        }
+        b = src[ip++];
+        match_len += b;
+      } while (b == 255);
+    }
+    match_len += kMinMatch;
+    if (op + match_len > dst_size) {
+      return false;
+    }
+
+    // Byte-wise copy: overlapping matches (offset < length) replicate
+    // the just-written bytes, which is how LZ4 encodes runs
+    const uint8_t* match = dst + op - offset;
+    for (size_t i = 0; i < match_len; ++i) {
+      dst[op + i] = match[i];
+    }
+    op += match_len;
+  }
+
+  return op == dst_size;
+}
+
+std::vector<uint8_t> compress_kv_payload(const uint8_t* src, size_t src_size) {
+  std::vector<uint8_t> out;
+  if (!src || src_size == 0) {
+    return out;
+  }
+
+  std::vector<uint8_t> payload;
+  uint8_t mode;
+
+  if (src_size % 2 == 0) {
+    // De-interleave into byte planes: for FP16 the high bytes (sign,
+    // exponent, top mantissa bits) are near-constant across a block,
+    // so grouping them gives the matcher much longer runs
+    size_t half = src_size / 2;
+    std::vector<uint8_t> planes(src_size);
+    for (size_t i = 0; i < half; ++i) {
+      planes[i] = src[2 * i];
+      planes[half + i] = src[2 * i + 1];
+    }
+
+    auto low = lz4_compress(planes.data(), half);
+    auto high = lz4_compress(planes.data() + half, half);
+
+    payload.reserve(8 + low.size() + high.size());
+    write_u32(payload, static_cast<uint32_t>(low.size()));
+    write_u32(payload, static_cast<uint32_t>(high.size()));
+    payload.insert(payload.end(), low.begin(), low.end());
+    payload.insert(payload.end(), high.begin(), high.end());
+    mode = kModePlanes;
+  } else {
+    payload = lz4_compress(src, src_size);
+    mode = kModeSingle;
+  }
+
+  if (payload.empty() || payload.size() + 1 >= src_size) {
+    // Incompressible: store raw so the worst case costs one byte
+    out.reserve(src_size + 1);
+    out.push_back(kModeRaw);
+    out.insert(out.end(), src, src + src_size);
+    return out;
+  }
+
+  out.reserve(payload.size() + 1);
+  out.push_back(mode);
+  out.insert(out.end(), payload.begin(), payload.end());
+  return out;
+}
+
+bool decompress_kv_payload(const std::vector<uint8_t>& compressed,
+                           uint8_t* dst, size_t dst_size) {
+  if (compressed.empty() || !dst) {
+    return dst_size == 0 && compressed.empty();
+  }
+
+  uint8_t mode = compressed[0];
+  const uint8_t* body = compressed.data() + 1;
+  size_t body_size = compressed.size() - 1;
+
+  switch (mode) {
+    case kModeRaw: {
+      if (body_size != dst_size) {
+        return false;
+      }
+      std::memcpy(dst, body, dst_size);
+      return true;
+    }
+
+    case kModePlanes: {
+      if (dst_size % 2 != 0 || body_size < 8) {
+        return false;
+      }
+      size_t half = dst_size / 2;
+      size_t low_size = read_u32(body);
+      size_t high_size = read_u32(body + 4);
+      if (8 + low_size + high_size != body_size) {
+        return false;
+      }
+
+      std::vector<uint8_t> planes(dst_size);
+      if (!lz4_decompress(body + 8, low_size, planes.data(), half) ||
+          !lz4_decompress(body + 8 + low_size, high_size,
+                          planes.data() + half, half)) {
+        return false;
+      }
+
+      // Re-interleave the planes
+      for (size_t i = 0; i < half; ++i) {
+        dst[2 * i] = planes[i];
+        dst[2 * i + 1] = planes[half + i];
+      }
+      return true;
+    }
+
+    case kModeSingle:
+      return lz4_decompress(body, body_size, dst, dst_size);
+
+    default:
+      return false;
+  }
+}
+
+}  // namespace kv
+}  // namespace runtime
+}  // namespace mlxr
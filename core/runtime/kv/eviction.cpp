@@ -139,6 +139,38 @@ void WorkingSetEvictionPolicy::set_sequence_priority(int seq_id,
   sequence_priorities_[seq_id] = priority;
 }
 
+void WorkingSetEvictionPolicy::record_access(int seq_id) {
+  std::lock_guard<std::mutex> lock(access_mutex_);
+  AccessStats& stats = access_stats_[seq_id];
+  stats.last_access = ++access_clock_;
+  stats.access_count++;
+}
+
+std::vector<int> WorkingSetEvictionPolicy::predict_hot_sequences(
+    int limit) const {
+  std::lock_guard<std::mutex> lock(access_mutex_);
+
+  // Hottest = most recently accessed; ties broken by access count
+  std::vector<std::pair<int, AccessStats>> entries(access_stats_.begin(),
+                                                   access_stats_.end());
+  std::sort(entries.begin(), entries.end(),
+            [](const auto& a, const auto& b) {
+              if (a.second.last_access != b.second.last_access) {
+                return a.second.last_access > b.second.last_access;
+              }
+              return a.second.access_count > b.second.access_count;
+            });
+
+  std::vector<int> hot;
+  hot.reserve(std::min<size_t>(entries.size(), limit));
+  for (const auto& [seq_id, stats] : entries) {
+    if (static_cast<int>(hot.size()) >= limit) break;
+    hot.push_back(seq_id);
+  }
+
+  return hot;
+}
+
 std::vector<std::pair<int, int>>
 WorkingSetEvictionPolicy::select_blocks_to_evict(const Pager& pager,
                                                  int num_blocks_to_evict) {
@@ -363,6 +395,42 @@ std::string EvictionManager::get_persistence_path(int seq_id,
   return (dir / filename).string();
 }
 
+SpillFile* EvictionManager::get_spill_file() {
+  if (!config_.enable_persistence) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(spill_mutex_);
+  if (spill_file_) {
+    return spill_file_.get();
+  }
+
+  try {
+    const ArenaConfig& arena_config = pager_->arena().config();
+
+    // K + V payload per block
+    size_t elem_bytes = mlx::core::size_of(arena_config.dtype);
+    size_t block_bytes = 2ULL * arena_config.num_layers *
+                         arena_config.block_size_tokens *
+                         arena_config.num_kv_heads * arena_config.head_dim *
+                         elem_bytes;
+
+    SpillFileConfig spill_config;
+    std::filesystem::path dir(config_.persistence_dir);
+    spill_config.path = (dir / config_.spill_file_name).string();
+    spill_config.block_bytes = block_bytes;
+
+    spill_file_ = std::make_unique<SpillFile>(spill_config);
+
+  } catch (const std::exception& e) {
+    std::cerr << "Failed to initialize KV spill file: " << e.what()
+              << std::endl;
+    return nullptr;
+  }
+
+  return spill_file_.get();
+}
+
 bool EvictionManager::persist_block(int seq_id, int block_idx) {
   Sequence* seq = pager_->get_sequence(seq_id);
   if (!seq) {
@@ -379,84 +447,97 @@ bool EvictionManager::persist_block(int seq_id, int block_idx) {
     return false;
   }
 
-  // Get persistence path
-  std::string path = get_persistence_path(seq_id, block_idx);
-
-  try {
-    // Evaluate tensors to materialize data
-    mlx::core::eval(block->k_data.array());
-    mlx::core::eval(block->v_data.array());
-
-    // For now, just create placeholder file
-    // Full implementation would serialize MLX arrays to disk
-    std::ofstream file(path, std::ios::binary);
-    if (!file.is_open()) {
-      return false;
-    }
+  SpillFile* spill = get_spill_file();
+  if (!spill) {
+    return false;
+  }
 
-    // Write metadata
-    file.write(reinterpret_cast<const char*>(&seq_id), sizeof(seq_id));
-    file.write(reinterpret_cast<const char*>(&block_idx), sizeof(block_idx));
-    file.write(reinterpret_cast<const char*>(&block_id), sizeof(block_id));
+  // Spill slots hold raw payloads, so a compressed CPU-tier block must
+  // be restored before its bytes are copied out
+  if (block->is_compressed && !pager_->arena().decompress_block(block_id)) {
+    return false;
+  }
 
-    // TODO: Serialize K and V tensors
-    // For now, just mark as persisted
-    file.close();
+  // Copy the block's K/V bytes and enqueue the slot write; the disk I/O
+  // happens on the spill file's writer thread, so eviction never blocks
+  int slot = spill->spill_block(*block);
+  if (slot < 0) {
+    return false;
+  }
 
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_.blocks_persisted++;
-    stats_.persistence_bytes += std::filesystem::file_size(path);
+  {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    // If the same block was spilled before, drop the stale slot
+    auto key = spill_key(seq_id, block_idx);
+    auto it = spilled_slots_.find(key);
+    if (it != spilled_slots_.end()) {
+      spill_file_->release_slot(it->second);
+    }
+    spilled_slots_[key] = slot;
+  }
 
-    return true;
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  stats_.blocks_persisted++;
+  stats_.persistence_bytes += spill->slot_bytes();
 
-  } catch (const std::exception& e) {
-    std::cerr << "Failed to persist block: " << e.what() << std::endl;
-    return false;
-  }
+  return true;
 }
 
 bool EvictionManager::restore_block(int seq_id, int block_idx) {
-  std::string path = get_persistence_path(seq_id, block_idx);
-
-  if (!std::filesystem::exists(path)) {
+  Sequence* seq = pager_->get_sequence(seq_id);
+  if (!seq) {
     return false;
   }
 
-  try {
-    std::ifstream file(path, std::ios::binary);
-    if (!file.is_open()) {
+  // Look up the spilled slot
+  int slot = -1;
+  {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    auto it = spilled_slots_.find(spill_key(seq_id, block_idx));
+    if (it == spilled_slots_.end()) {
       return false;
     }
+    slot = it->second;
+  }
 
-    // Read metadata
-    int stored_seq_id, stored_block_idx, stored_block_id;
-    file.read(reinterpret_cast<char*>(&stored_seq_id), sizeof(stored_seq_id));
-    file.read(reinterpret_cast<char*>(&stored_block_idx),
-              sizeof(stored_block_idx));
-    file.read(reinterpret_cast<char*>(&stored_block_id),
-              sizeof(stored_block_id));
-
-    // Verify metadata
-    if (stored_seq_id != seq_id || stored_block_idx != block_idx) {
-      return false;
-    }
+  SpillFile* spill = get_spill_file();
+  if (!spill) {
+    return false;
+  }
 
-    // TODO: Deserialize K and V tensors and restore to block
+  // Allocate a fresh block to fault the data into
+  int block_id = pager_->arena().allocate_block();
+  if (block_id < 0) {
+    std::cerr << "Failed to restore block: arena exhausted" << std::endl;
+    return false;
+  }
 
-    file.close();
+  Block* block = pager_->get_block(block_id);
+  if (!block || !spill->fault_block(slot, block)) {
+    pager_->arena().free_block(block_id);
+    return false;
+  }
 
-    // Remove persisted file
-    std::filesystem::remove(path);
+  // Reinstate the block in the sequence's page table
+  auto page_table = seq->page_table();
+  if (block_idx < 0 || block_idx >= static_cast<int>(page_table.size())) {
+    pager_->arena().free_block(block_id);
+    return false;
+  }
+  page_table[block_idx] = block_id;
+  seq->set_page_table(page_table);
 
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_.blocks_restored++;
+  // Slot is no longer needed
+  {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    spilled_slots_.erase(spill_key(seq_id, block_idx));
+  }
+  spill->release_slot(slot);
 
-    return true;
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  stats_.blocks_restored++;
 
-  } catch (const std::exception& e) {
-    std::cerr << "Failed to restore block: " << e.what() << std::endl;
-    return false;
-  }
+  return true;
 }
 
 EvictionManager::Stats EvictionManager::get_stats() const {
@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "pager.h"
+#include "spill_file.h"
 
 namespace mlxr {
 namespace runtime {
@@ -37,6 +38,9 @@ struct EvictionConfig {
   // Persistence directory
   std::string persistence_dir = "~/.mlxr/kv_cache";
 
+  // Spill file name inside the persistence directory (mmap-backed tier)
+  std::string spill_file_name = "kv_spill.bin";
+
   // Minimum blocks to keep per sequence
   int min_blocks_per_sequence = 1;
 };
@@ -106,9 +110,35 @@ class WorkingSetEvictionPolicy : public EvictionPolicy {
    */
   void set_sequence_priority(int seq_id, float priority);
 
+  /**
+   * @brief Record an access to a sequence (decode/prefill step)
+   * @param seq_id Sequence ID
+   *
+   * Feeds the working-set stats used by predict_hot_sequences() and
+   * the background block migrator's prefetch decisions.
+   */
+  void record_access(int seq_id);
+
+  /**
+   * @brief Predict the sequences most likely to be read next
+   * @param limit Maximum sequences to return
+   * @return Sequence IDs ordered hottest first (most recent access,
+   *         ties broken by access count)
+   */
+  std::vector<int> predict_hot_sequences(int limit) const;
+
  private:
   EvictionConfig config_;
   std::unordered_map<int, float> sequence_priorities_;
+
+  // Working-set access stats (guarded: read from the migration thread)
+  struct AccessStats {
+    uint64_t last_access = 0;
+    uint64_t access_count = 0;
+  };
+  mutable std::mutex access_mutex_;
+  std::unordered_map<int, AccessStats> access_stats_;
+  uint64_t access_clock_ = 0;
 };
 
 /**
@@ -192,10 +222,30 @@ class EvictionManager {
    */
   std::string get_persistence_path(int seq_id, int block_idx) const;
 
+  /**
+   * @brief Get (lazily creating) the mmap-backed spill file
+   * @return Spill file, or nullptr if persistence is disabled or
+   *         initialization failed
+   */
+  SpillFile* get_spill_file();
+
+  /**
+   * @brief Key for the spilled-slot map
+   */
+  static uint64_t spill_key(int seq_id, int block_idx) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(seq_id)) << 32) |
+           static_cast<uint32_t>(block_idx);
+  }
+
   std::shared_ptr<Pager> pager_;
   EvictionConfig config_;
   std::unique_ptr<EvictionPolicy> policy_;
 
+  // Disk spill tier: (seq_id, block_idx) -> slot in the spill file
+  std::unique_ptr<SpillFile> spill_file_;
+  std::unordered_map<uint64_t, int> spilled_slots_;
+  std::mutex spill_mutex_;
+
   // Statistics
   mutable std::mutex stats_mutex_;
   Stats stats_;
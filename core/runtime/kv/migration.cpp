@@ -0,0 +1,323 @@
+/**
+ * @file migration.cpp
+ * @brief Implementation of the background KV block migration pipeline
+ */
+
+#include "migration.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace mlxr {
+namespace runtime {
+namespace kv {
+
+BlockMigrator::BlockMigrator(std::shared_ptr<Pager> pager,
+                             const MigrationConfig& config)
+    : pager_(pager), config_(config) {}
+
+BlockMigrator::~BlockMigrator() { stop(); }
+
+void BlockMigrator::start() {
+  if (running_.load()) {
+    return;
+  }
+
+  should_stop_.store(false);
+  running_.store(true);
+  thread_ = std::thread(&BlockMigrator::migration_loop, this);
+
+  std::cout << "[BlockMigrator] Started (poll=" << config_.poll_interval_ms
+            << "ms, demote_batch=" << config_.demote_batch
+            << ", prefetch_batch=" << config_.prefetch_batch << ")"
+            << std::endl;
+}
+
+void BlockMigrator::stop() {
+  if (!running_.load()) {
+    return;
+  }
+
+  should_stop_.store(true);
+  wake_cv_.notify_all();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  running_.store(false);
+  std::cout << "[BlockMigrator] Stopped" << std::endl;
+}
+
+void BlockMigrator::request_prefetch(int seq_id) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    prefetch_queue_.push_back(seq_id);
+  }
+  // Wake the thread so promotion lands before the decode step
+  wake_cv_.notify_one();
+}
+
+void BlockMigrator::set_working_set_policy(WorkingSetEvictionPolicy* policy) {
+  working_set_policy_ = policy;
+}
+
+void BlockMigrator::migration_loop() {
+  while (!should_stop_.load()) {
+    run_once();
+
+    // Sleep until the poll interval elapses or a prefetch request lands
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_cv_.wait_for(lock, std::chrono::milliseconds(config_.poll_interval_ms),
+                      [this] {
+                        if (should_stop_.load()) return true;
+                        std::lock_guard<std::mutex> qlock(queue_mutex_);
+                        return !prefetch_queue_.empty();
+                      });
+  }
+}
+
+int BlockMigrator::run_once() {
+  // Promote first so pending decode reads never wait behind demotion
+  int promoted = prefetch_hot_blocks();
+  int demoted = demote_cold_blocks();
+
+  // Fully idle pass: no pressure and nothing requested - spend the tick
+  // compacting the arena instead
+  int compacted = 0;
+  if (promoted == 0 && demoted == 0) {
+    compacted = compact_arena();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.blocks_demoted += demoted;
+    stats_.blocks_promoted += promoted;
+    stats_.blocks_compacted += compacted;
+    stats_.passes++;
+  }
+
+  return demoted + promoted + compacted;
+}
+
+int BlockMigrator::demote_cold_blocks() {
+  Arena& arena = pager_->arena();
+  const ArenaConfig& arena_config = arena.config();
+
+  // GPU capacity mirrors the arena's lazy-growth budget
+  int gpu_capacity = arena_config.num_blocks;
+  if (arena_config.allow_cpu_overflow) {
+    gpu_capacity = std::max(
+        64, arena_config.num_blocks - arena_config.max_cpu_blocks);
+  }
+
+  // Only demote once lazy growth is exhausted and free blocks run low;
+  // before that, allocation can still mint fresh GPU blocks cheaply
+  Arena::Stats arena_stats = arena.get_stats();
+  if (arena_stats.total_blocks < gpu_capacity) {
+    return 0;
+  }
+  int free_target =
+      static_cast<int>(gpu_capacity * config_.demote_free_threshold);
+  if (arena_stats.free_gpu_blocks >= free_target) {
+    return 0;
+  }
+
+  // Collect cold candidates: GPU-resident, unshared blocks, oldest first
+  struct Candidate {
+    int block_id;
+    uint64_t timestamp;
+  };
+  std::vector<Candidate> candidates;
+
+  for (int seq_id : pager_->get_sequence_ids()) {
+    const Sequence* seq = pager_->get_sequence(seq_id);
+    if (!seq) continue;
+
+    for (int block_id : seq->page_table()) {
+      if (block_id < 0) continue;
+
+      const Block* block = pager_->get_block(block_id);
+      if (!block || block->location != 0 || block->ref_count > 1) {
+        // Skip CPU-resident, shared (COW), or invalid blocks
+        continue;
+      }
+
+      candidates.push_back({block_id, block->last_access_time});
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) {
+              return a.timestamp < b.timestamp;
+            });
+
+  int demoted = 0;
+  for (const Candidate& candidate : candidates) {
+    if (demoted >= config_.demote_batch) break;
+
+    Block* block = pager_->get_block(candidate.block_id);
+    if (!block || block->location != 0) continue;
+
+    // Materialize through the staging buffer off the decode path, then
+    // flip the location flag
+    stage_block(block);
+    if (arena.move_to_cpu(candidate.block_id)) {
+      demoted++;
+    }
+  }
+
+  return demoted;
+}
+
+int BlockMigrator::prefetch_hot_blocks() {
+  int budget = config_.prefetch_batch;
+  int promoted = 0;
+
+  // Explicit requests from the scheduler take precedence
+  while (budget > 0) {
+    int seq_id = -1;
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      if (prefetch_queue_.empty()) break;
+      seq_id = prefetch_queue_.front();
+      prefetch_queue_.pop_front();
+    }
+
+    int moved = promote_sequence(seq_id, budget);
+    promoted += moved;
+    budget -= moved;
+  }
+
+  // Then predicted hot sequences from working-set access stats
+  if (budget > 0 && working_set_policy_) {
+    for (int seq_id :
+         working_set_policy_->predict_hot_sequences(config_.prediction_window)) {
+      if (budget <= 0) break;
+      int moved = promote_sequence(seq_id, budget);
+      promoted += moved;
+      budget -= moved;
+    }
+  }
+
+  return promoted;
+}
+
+int BlockMigrator::promote_sequence(int seq_id, int budget) {
+  const Sequence* seq = pager_->get_sequence(seq_id);
+  if (!seq) {
+    return 0;
+  }
+
+  Arena& arena = pager_->arena();
+  int promoted = 0;
+
+  for (int block_id : seq->page_table()) {
+    if (promoted >= budget) break;
+    if (block_id < 0) continue;
+
+    Block* block = pager_->get_block(block_id);
+    if (!block || block->location != 1) {
+      continue;  // Already on GPU or invalid
+    }
+
+    stage_block(block);
+    if (arena.move_to_gpu(block_id)) {
+      arena.touch_block(block_id);
+      promoted++;
+    }
+  }
+
+  return promoted;
+}
+
+int BlockMigrator::compact_arena() {
+  Arena& arena = pager_->arena();
+
+  // Return free blocks stranded on the CPU lists by demote->free cycles
+  // to the GPU allocator's fast path
+  int moved = arena.reclaim_free_cpu_blocks(config_.compact_batch);
+  int budget = config_.compact_batch - moved;
+
+  // With plenty of free GPU blocks, bring active sequences' demoted
+  // blocks home so their next decode step doesn't fault. Swapped-out
+  // sequences stay on CPU - that demotion was deliberate
+  const ArenaConfig& arena_config = arena.config();
+  int gpu_capacity = arena_config.num_blocks;
+  if (arena_config.allow_cpu_overflow) {
+    gpu_capacity = std::max(
+        64, arena_config.num_blocks - arena_config.max_cpu_blocks);
+  }
+  int free_target =
+      static_cast<int>(gpu_capacity * config_.compact_free_threshold);
+
+  if (budget > 0 && arena.num_free_gpu_blocks() >= free_target) {
+    for (int seq_id : pager_->get_sequence_ids()) {
+      if (budget <= 0) break;
+
+      const Sequence* seq = pager_->get_sequence(seq_id);
+      if (!seq || seq->is_swapped_out()) continue;
+
+      for (int block_id : seq->page_table()) {
+        if (budget <= 0) break;
+        if (block_id < 0) continue;
+
+        Block* block = pager_->get_block(block_id);
+        if (!block || block->location != 1) continue;
+
+        stage_block(block);
+        if (arena.move_to_gpu(block_id)) {
+          moved++;
+          budget--;
+        }
+      }
+    }
+  }
+
+  // Even out the shard free lists while the tick is idle anyway
+  arena.rebalance_free_lists();
+
+  return moved;
+}
+
+void BlockMigrator::stage_block(Block* block) {
+  // Force the block's lazy K/V tensors to materialize into the current
+  // staging buffer. On unified memory the subsequent location change is
+  // a placement-policy update, but materializing here keeps the eval
+  // cost off the decode path. Alternating buffers lets any in-flight
+  // work on the previous buffer overlap this copy.
+  if (block->is_compressed) {
+    // Compressed blocks hold no live tensors; promotion decompresses
+    // inside move_to_gpu, so there is nothing to stage here
+    return;
+  }
+  mlx::core::eval(block->k_data.array());
+  mlx::core::eval(block->v_data.array());
+
+  auto& k_arr = block->k_data.array();
+  auto& v_arr = block->v_data.array();
+  size_t bytes = k_arr.nbytes() + v_arr.nbytes();
+
+  std::vector<char>& staging = staging_[staging_index_];
+  if (staging.size() < bytes) {
+    staging.resize(bytes);
+  }
+
+  std::memcpy(staging.data(), k_arr.data<char>(), k_arr.nbytes());
+  std::memcpy(staging.data() + k_arr.nbytes(), v_arr.data<char>(),
+              v_arr.nbytes());
+
+  // Flip to the other buffer for the next block
+  staging_index_ = 1 - staging_index_;
+}
+
+BlockMigrator::Stats BlockMigrator::get_stats() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return stats_;
+}
+
+}  // namespace kv
+}  // namespace runtime
+}  // namespace mlxr
@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <unordered_map>
 
 namespace mlxr {
 namespace runtime {
@@ -23,6 +24,7 @@ Sequence::Sequence(int seq_id, int block_size_tokens)
       num_tokens_(0),
       last_access_time_(get_current_time()),
       is_active_(true),
+      is_swapped_out_(false),
       parent_id_(-1) {}
 
 int Sequence::num_blocks_required() const {
@@ -44,6 +46,19 @@ int Sequence::get_block_id(int block_idx) const {
   return page_table_[block_idx];
 }
 
+void Sequence::clear_block(int block_idx) {
+  if (block_idx >= 0 && block_idx < static_cast<int>(page_table_.size())) {
+    page_table_[block_idx] = -1;
+  }
+}
+
+void Sequence::set_block_id(int block_idx, int block_id) {
+  if (block_idx >= 0 && block_idx < static_cast<int>(page_table_.size())) {
+    page_table_[block_idx] = block_id;
+    touch();
+  }
+}
+
 int Sequence::get_block_id_for_token(int token_pos) const {
   if (token_pos < 0 || token_pos >= num_tokens_) {
     return -1;
@@ -63,7 +78,8 @@ uint64_t Sequence::get_current_time() {
 // Pager Implementation
 // ============================================================================
 
-Pager::Pager(std::shared_ptr<Arena> arena) : arena_(arena), num_forks_(0) {}
+Pager::Pager(std::shared_ptr<Arena> arena)
+    : arena_(arena), num_forks_(0), block_quota_(0) {}
 
 Pager::~Pager() { clear(); }
 
@@ -160,6 +176,42 @@ const Sequence* Pager::get_sequence(int seq_id) const {
   return it->second.get();
 }
 
+bool Pager::attach_shared_blocks(int seq_id,
+                                 const std::vector<int>& block_ids,
+                                 int num_tokens) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  Sequence* seq = get_sequence(seq_id);
+  if (!seq) {
+    std::cerr << "Sequence " << seq_id << " not found" << std::endl;
+    return false;
+  }
+
+  if (!seq->page_table().empty()) {
+    std::cerr << "Cannot attach shared blocks: sequence " << seq_id
+              << " already has blocks" << std::endl;
+    return false;
+  }
+
+  // Validate all blocks before taking any references
+  for (int block_id : block_ids) {
+    if (!arena_->get_block(block_id)) {
+      std::cerr << "Invalid block " << block_id << " for shared attach"
+                << std::endl;
+      return false;
+    }
+  }
+
+  // Share blocks copy-on-write (same mechanism as fork_sequence)
+  for (int block_id : block_ids) {
+    arena_->ref_block(block_id);
+    seq->append_block(block_id);
+  }
+  seq->set_num_tokens(num_tokens);
+
+  return true;
+}
+
 bool Pager::allocate_blocks_for_sequence(int seq_id, int target_num_tokens) {
   std::lock_guard<std::mutex> lock(mutex_);
 
@@ -176,6 +228,14 @@ bool Pager::allocate_blocks_for_sequence(int seq_id, int target_num_tokens) {
     return true;
   }
 
+  // Copy-on-write resolution: positions [current, target) are about to
+  // be written. A final partial block still shared with a fork sibling
+  // or the prefix cache must be privatized before this sequence writes
+  // into it, or the writes would bleed into the co-owners' caches
+  if (!resolve_cow_range(seq, current_tokens, target_num_tokens)) {
+    return false;
+  }
+
   // Calculate number of new blocks needed
   int current_blocks = seq->page_table().size();
   int target_blocks =
@@ -194,6 +254,15 @@ bool Pager::allocate_blocks_for_sequence(int seq_id, int target_num_tokens) {
 
 bool Pager::allocate_blocks_for_sequence_impl(Sequence* seq,
                                               int num_new_blocks) {
+  // Enforce the per-pager quota before touching the (shared) arena
+  if (block_quota_ > 0 &&
+      total_blocks_locked() + num_new_blocks > block_quota_) {
+    std::cerr << "Block quota exceeded for sequence " << seq->id() << " ("
+              << total_blocks_locked() << " held, " << num_new_blocks
+              << " requested, quota " << block_quota_ << ")" << std::endl;
+    return false;
+  }
+
   // Allocate blocks from arena
   std::vector<int> new_block_ids = arena_->allocate_blocks(num_new_blocks);
 
@@ -208,9 +277,109 @@ bool Pager::allocate_blocks_for_sequence_impl(Sequence* seq,
     seq->append_block(block_id);
   }
 
+  // Streaming sequences shed their middle as the tail grows, so memory
+  // stays constant however long the session runs
+  if (seq->streaming_enabled()) {
+    reclaim_streaming_blocks(seq);
+  }
+
   return true;
 }
 
+bool Pager::resolve_cow_range(Sequence* seq, int first_token,
+                              int target_tokens) {
+  if (target_tokens <= first_token) {
+    return true;  // Nothing will be written
+  }
+
+  int block_size = seq->block_size();
+  int first_idx = first_token / block_size;
+  int last_idx = (target_tokens - 1) / block_size;
+  int mapped_blocks = static_cast<int>(seq->page_table().size());
+
+  for (int idx = first_idx; idx <= last_idx && idx < mapped_blocks; ++idx) {
+    int block_id = seq->get_block_id(idx);
+    if (block_id < 0) {
+      continue;  // Hole (streaming eviction); writes go to new blocks
+    }
+
+    Block* block = arena_->get_block(block_id);
+    if (!block || block->ref_count.load(std::memory_order_acquire) <= 1) {
+      continue;  // Exclusively owned already
+    }
+
+    int copy_id = arena_->copy_block(block_id);
+    if (copy_id < 0) {
+      std::cerr << "Failed to copy shared block " << block_id
+                << " for sequence " << seq->id() << std::endl;
+      return false;
+    }
+
+    seq->set_block_id(idx, copy_id);
+    arena_->unref_block(block_id);
+    num_cow_copies_++;
+  }
+
+  return true;
+}
+
+bool Pager::enable_streaming_window(int seq_id, int sink_blocks,
+                                    int window_blocks) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  Sequence* seq = get_sequence(seq_id);
+  if (!seq) {
+    std::cerr << "Sequence " << seq_id << " not found for streaming mode"
+              << std::endl;
+    return false;
+  }
+  if (sink_blocks < 0 || window_blocks < 1) {
+    std::cerr << "Invalid streaming window shape for sequence " << seq_id
+              << " (sinks " << sink_blocks << ", window " << window_blocks
+              << ")" << std::endl;
+    return false;
+  }
+
+  seq->enable_streaming(sink_blocks, window_blocks);
+  reclaim_streaming_blocks(seq);  // Trim any already-oversized table
+  return true;
+}
+
+void Pager::reclaim_streaming_blocks(Sequence* seq) {
+  const auto& table = seq->page_table();
+  int num_blocks = static_cast<int>(table.size());
+  int window_start = num_blocks - seq->window_blocks();
+
+  for (int idx = seq->sink_blocks(); idx < window_start; ++idx) {
+    int block_id = table[idx];
+    if (block_id < 0) {
+      continue;  // Already a hole
+    }
+    // unref_block respects sharing: a block a fork or the prefix cache
+    // still references survives — only this sequence stops mapping it
+    arena_->unref_block(block_id);
+    seq->clear_block(idx);
+  }
+}
+
+void Pager::set_block_quota(int max_blocks) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  block_quota_ = max_blocks;
+}
+
+int Pager::block_quota() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return block_quota_;
+}
+
+int Pager::total_blocks_locked() const {
+  int total = 0;
+  for (const auto& pair : sequences_) {
+    total += static_cast<int>(pair.second->page_table().size());
+  }
+  return total;
+}
+
 Block* Pager::get_block(int block_id) { return arena_->get_block(block_id); }
 
 const Block* Pager::get_block(int block_id) const {
@@ -233,6 +402,65 @@ void Pager::touch_sequence(int seq_id) {
   }
 }
 
+bool Pager::swap_out_sequence(int seq_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  Sequence* seq = get_sequence(seq_id);
+  if (!seq) {
+    std::cerr << "Sequence " << seq_id << " not found for swap-out"
+              << std::endl;
+    return false;
+  }
+
+  for (int block_id : seq->page_table()) {
+    Block* block = arena_->get_block(block_id);
+    if (!block) {
+      continue;
+    }
+    // Shared blocks (forks, prefix cache hits) stay on GPU: the other
+    // owners are still decoding against them and demotion would stall
+    // their next step on a fault
+    if (block->ref_count.load() > 1) {
+      continue;
+    }
+    if (block->location == 0) {
+      arena_->move_to_cpu(block_id);
+    }
+  }
+
+  seq->set_swapped_out(true);
+  return true;
+}
+
+bool Pager::swap_in_sequence(int seq_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  Sequence* seq = get_sequence(seq_id);
+  if (!seq) {
+    std::cerr << "Sequence " << seq_id << " not found for swap-in"
+              << std::endl;
+    return false;
+  }
+
+  bool all_promoted = true;
+  for (int block_id : seq->page_table()) {
+    Block* block = arena_->get_block(block_id);
+    if (!block || block->location != 1) {
+      continue;
+    }
+    if (!arena_->move_to_gpu(block_id)) {
+      all_promoted = false;
+    }
+  }
+
+  if (all_promoted) {
+    seq->set_swapped_out(false);
+    seq->touch();
+  }
+
+  return all_promoted;
+}
+
 int Pager::num_sequences() const {
   std::lock_guard<std::mutex> lock(mutex_);
   return static_cast<int>(sequences_.size());
@@ -275,12 +503,17 @@ Pager::Stats Pager::get_stats() const {
   stats.total_tokens = 0;
   stats.total_blocks_allocated = 0;
   stats.num_forks = num_forks_;
+  stats.num_cow_copies = num_cow_copies_;
+  stats.num_swapped_sequences = 0;
 
   for (const auto& pair : sequences_) {
     const Sequence* seq = pair.second.get();
     if (seq->is_active()) {
       stats.num_active_sequences++;
     }
+    if (seq->is_swapped_out()) {
+      stats.num_swapped_sequences++;
+    }
     stats.total_tokens += seq->num_tokens();
     stats.total_blocks_allocated += static_cast<int>(seq->page_table().size());
   }
@@ -322,6 +555,96 @@ graph::Tensor Pager::build_page_table_array(int seq_id, int max_blocks) {
   return graph::Tensor(arr);
 }
 
+graph::Tensor Pager::build_batched_page_table_array(
+    const std::vector<int>& seq_ids, int max_blocks,
+    std::vector<int>* block_ids) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  int batch = static_cast<int>(seq_ids.size());
+  std::vector<int> table_data;
+  table_data.reserve(static_cast<size_t>(batch) * max_blocks);
+
+  block_ids->clear();
+
+  // Map global block ID -> index into the stacked cache array. Shared
+  // blocks (fork/prefix reuse) get one slot no matter how many rows
+  // reference them
+  std::unordered_map<int, int> local_index;
+
+  for (int seq_id : seq_ids) {
+    Sequence* seq = get_sequence(seq_id);
+    if (!seq) {
+      throw std::runtime_error(
+          "Sequence not found in build_batched_page_table_array: " +
+          std::to_string(seq_id));
+    }
+
+    const auto& page_table = seq->page_table();
+    for (int i = 0; i < max_blocks; ++i) {
+      if (i < static_cast<int>(page_table.size()) && page_table[i] >= 0) {
+        int global_id = page_table[i];
+        auto it = local_index.find(global_id);
+        if (it == local_index.end()) {
+          it = local_index
+                   .emplace(global_id, static_cast<int>(block_ids->size()))
+                   .first;
+          block_ids->push_back(global_id);
+        }
+        table_data.push_back(it->second);
+      } else {
+        // Pad with -1 for unused slots
+        table_data.push_back(-1);
+      }
+    }
+  }
+
+  auto arr = mlx::core::array(table_data.data(), {batch, max_blocks},
+                              mlx::core::int32);
+
+  return graph::Tensor(arr);
+}
+
+bool Pager::refresh_batch_decode_plan(const std::vector<int>& seq_ids,
+                                      BatchDecodePlan* plan) {
+  // Snapshot the live page tables under the lock. A -1 separator after
+  // each row keeps differently-split batches from comparing equal.
+  int max_blocks = 0;
+  std::vector<int> tables;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int seq_id : seq_ids) {
+      Sequence* seq = get_sequence(seq_id);
+      if (!seq) {
+        throw std::runtime_error(
+            "Sequence not found in refresh_batch_decode_plan: " +
+            std::to_string(seq_id));
+      }
+      const auto& page_table = seq->page_table();
+      max_blocks = std::max(max_blocks, static_cast<int>(page_table.size()));
+      tables.insert(tables.end(), page_table.begin(), page_table.end());
+      tables.push_back(-1);
+    }
+  }
+
+  // Replay: same batch rows over the same blocks means the recorded
+  // packed table and gather list are still exact
+  if (plan->valid && plan->seq_ids == seq_ids &&
+      plan->recorded_tables == tables) {
+    return false;
+  }
+
+  // Re-record (lock released above - build_batched_page_table_array
+  // takes it again)
+  plan->seq_ids = seq_ids;
+  plan->recorded_tables = std::move(tables);
+  plan->max_blocks = max_blocks;
+  plan->block_ids.clear();
+  plan->page_table =
+      build_batched_page_table_array(seq_ids, max_blocks, &plan->block_ids);
+  plan->valid = true;
+  return true;
+}
+
 }  // namespace kv
 }  // namespace runtime
 }  // namespace mlxr
@@ -115,6 +115,17 @@ class Sequence {
    */
   void finish() { is_active_ = false; }
 
+  /**
+   * @brief Whether the sequence's blocks were demoted to the CPU tier
+   * by swap-based preemption (resume requires promotion, not prefill)
+   */
+  bool is_swapped_out() const { return is_swapped_out_; }
+
+  /**
+   * @brief Record swap-out/swap-in state
+   */
+  void set_swapped_out(bool swapped_out) { is_swapped_out_ = swapped_out; }
+
   /**
    * @brief Get parent sequence ID (for forking/beam search)
    */
@@ -125,6 +136,52 @@ class Sequence {
    */
   void set_parent_id(int parent_id) { parent_id_ = parent_id; }
 
+  /**
+   * @brief Whether StreamingLLM-style sliding-window mode is enabled
+   */
+  bool streaming_enabled() const { return streaming_enabled_; }
+
+  /**
+   * @brief Leading "attention sink" blocks kept resident forever
+   */
+  int sink_blocks() const { return sink_blocks_; }
+
+  /**
+   * @brief Trailing window blocks kept resident
+   */
+  int window_blocks() const { return window_blocks_; }
+
+  /**
+   * @brief Enable sliding-window mode (sinks + recent window)
+   * @param sink_blocks Leading blocks pinned for the sequence lifetime
+   * @param window_blocks Trailing blocks kept as the recency window
+   */
+  void enable_streaming(int sink_blocks, int window_blocks) {
+    streaming_enabled_ = true;
+    sink_blocks_ = sink_blocks;
+    window_blocks_ = window_blocks;
+  }
+
+  /**
+   * @brief Clear one page-table entry, leaving a -1 hole
+   * @param block_idx Logical block index
+   *
+   * Holes keep later blocks at their logical positions; the caller owns
+   * releasing the block's arena reference.
+   */
+  void clear_block(int block_idx);
+
+  /**
+   * @brief Remap one page-table entry to a different physical block
+   * @param block_idx Logical block index
+   * @param block_id New block ID for that position
+   *
+   * Used by copy-on-write resolution: the logical position keeps its
+   * contents but now points at this sequence's private copy. The caller
+   * owns the reference accounting for both old and new blocks.
+   */
+  void set_block_id(int block_idx, int block_id);
+
  private:
   static uint64_t get_current_time();
 
@@ -134,7 +191,41 @@ class Sequence {
   std::vector<int> page_table_;  // Maps block_idx -> block_id
   uint64_t last_access_time_;
   bool is_active_;
-  int parent_id_;  // For beam search/forking (-1 if root)
+  bool is_swapped_out_;  // Blocks demoted to CPU by preemption
+  int parent_id_;        // For beam search/forking (-1 if root)
+
+  // StreamingLLM sliding-window state (see Pager::enable_streaming_window)
+  bool streaming_enabled_ = false;
+  int sink_blocks_ = 0;
+  int window_blocks_ = 0;
+};
+
+/**
+ * @brief Recorded dispatch metadata for a batched decode step
+ *
+ * Command encoding is host-side overhead in the most latency-sensitive
+ * loop we have: without a plan every layer repacks the batch's page
+ * tables and re-uploads them each token. The plan records the packed
+ * table and block gather list once per batch composition and replays
+ * them across layers and steps — the recording only goes stale when a
+ * sequence crosses a block boundary (or the batch membership changes),
+ * which Pager::refresh_batch_decode_plan() detects by comparing the
+ * recorded page tables against the live ones.
+ *
+ * seq_lengths is the per-step binding: positions advance every token,
+ * so the caller refreshes it before each replay.
+ */
+struct BatchDecodePlan {
+  // Recorded once per batch composition / block set
+  std::vector<int> seq_ids;          ///< Batch rows the recording covers
+  std::vector<int> recorded_tables;  ///< Page-table snapshot for validation
+  std::vector<int> block_ids;  ///< Deduplicated global IDs backing the stack
+  int max_blocks = 0;          ///< Row stride of the packed table
+  graph::Tensor page_table;    ///< Packed [batch, max_blocks] local indices
+  bool valid = false;          ///< Whether a recording exists
+
+  // Refreshed by the caller every step (positions advance)
+  graph::Tensor seq_lengths;  ///< [batch] int32 context lengths
 };
 
 /**
@@ -192,6 +283,19 @@ class Pager {
   Sequence* get_sequence(int seq_id);
   const Sequence* get_sequence(int seq_id) const;
 
+  /**
+   * @brief Attach shared blocks to the head of an empty sequence
+   * @param seq_id Destination sequence (must exist with an empty page table)
+   * @param block_ids Blocks to share (reference counts are incremented)
+   * @param num_tokens Token count covered by the shared blocks
+   * @return True if successful
+   *
+   * Used by the prefix cache to install cached prompt blocks
+   * copy-on-write, mirroring the sharing done by fork_sequence.
+   */
+  bool attach_shared_blocks(int seq_id, const std::vector<int>& block_ids,
+                            int num_tokens);
+
   /**
    * @brief Allocate blocks for a sequence to reach target token count
    * @param seq_id Sequence ID
@@ -214,6 +318,64 @@ class Pager {
    */
   void touch_sequence(int seq_id);
 
+  /**
+   * @brief Cap the total page-table entries this pager may hold
+   * @param max_blocks Block quota (0 = unlimited)
+   *
+   * Used for multi-model residency: each resident model's pager draws
+   * blocks from the shared arena, and the quota keeps one model from
+   * starving the others under load. Growth past the quota fails the
+   * same way arena exhaustion does.
+   */
+  void set_block_quota(int max_blocks);
+
+  /**
+   * @brief Get the block quota (0 = unlimited)
+   */
+  int block_quota() const;
+
+  /**
+   * @brief Put a sequence into StreamingLLM sliding-window mode
+   * @param seq_id Sequence ID
+   * @param sink_blocks Leading "attention sink" blocks kept forever
+   * @param window_blocks Trailing blocks kept as the recency window
+   * @return True if the sequence exists and the shape is valid
+   *
+   * Generation then holds constant KV memory: whenever the page table
+   * grows past sink_blocks + window_blocks, the blocks in between are
+   * unreferenced and their entries become -1 holes. Later blocks keep
+   * their logical positions, and the decode kernels already score holed
+   * positions as -inf (page_id < 0), so the freed middle masks itself
+   * out of attention — the StreamingLLM sink + sliding-window pattern.
+   * Always-on sessions stop dying on arena exhaustion at the cost of
+   * not attending the evicted middle.
+   */
+  bool enable_streaming_window(int seq_id, int sink_blocks, int window_blocks);
+
+  /**
+   * @brief Demote a sequence's blocks to the CPU tier (swap-based preemption)
+   * @param seq_id Sequence ID
+   * @return True if the sequence was found and marked swapped out
+   *
+   * Moves every exclusively-owned GPU block in the page table to CPU
+   * memory and marks the sequence swapped out. Blocks shared with other
+   * sequences (ref_count > 1) stay resident — the co-owners are still
+   * decoding against them. The page table itself is preserved, so
+   * resuming the victim is a block promotion rather than a re-prefill.
+   */
+  bool swap_out_sequence(int seq_id);
+
+  /**
+   * @brief Promote a swapped-out sequence's blocks back to GPU
+   * @param seq_id Sequence ID
+   * @return True if every CPU-resident block was promoted
+   *
+   * Inverse of swap_out_sequence(). On partial promotion (GPU tier
+   * full) the sequence stays marked swapped out so the caller can
+   * retry once pressure eases.
+   */
+  bool swap_in_sequence(int seq_id);
+
   /**
    * @brief Get number of sequences
    */
@@ -248,6 +410,39 @@ class Pager {
    */
   graph::Tensor build_page_table_array(int seq_id, int max_blocks);
 
+  /**
+   * @brief Build one packed page table for a whole decode batch
+   * @param seq_ids Sequence IDs in batch order
+   * @param max_blocks Blocks per row (rows padded with -1); typically the
+   * widest page table across the batch
+   * @param block_ids Output: deduplicated global block IDs in first-use
+   * order; entry i backs local index i in the returned table
+   * @return Page table array [batch, max_blocks] of stack-local indices
+   *
+   * Entries index into the cache array stacked from block_ids rather than
+   * the global arena, so a single kernel dispatch can cover sequences
+   * whose blocks are scattered anywhere in the pool. Blocks shared
+   * between sequences (forked prefixes) are gathered once.
+   */
+  graph::Tensor build_batched_page_table_array(const std::vector<int>& seq_ids,
+                                               int max_blocks,
+                                               std::vector<int>* block_ids);
+
+  /**
+   * @brief Record or replay the packed page-table plan for a decode batch
+   * @param seq_ids Sequence IDs in batch order
+   * @param plan Plan to validate and (if stale) re-record
+   * @return True if the plan was re-recorded, false if replayed as-is
+   *
+   * Compares the plan's recorded page tables against the live ones and
+   * rebuilds the packed table only on a mismatch, so steady-state decode
+   * steps replay the existing recording instead of repacking per layer.
+   * The caller still refreshes plan->seq_lengths every step. Throws if a
+   * sequence in the batch does not exist.
+   */
+  bool refresh_batch_decode_plan(const std::vector<int>& seq_ids,
+                                 BatchDecodePlan* plan);
+
   /**
    * @brief Get statistics
    */
@@ -257,6 +452,8 @@ class Pager {
     int total_tokens;
     int total_blocks_allocated;
     int num_forks;
+    int num_cow_copies;
+    int num_swapped_sequences;
   };
 
   Stats get_stats() const;
@@ -270,10 +467,41 @@ class Pager {
    */
   bool allocate_blocks_for_sequence_impl(Sequence* seq, int num_new_blocks);
 
+  /**
+   * @brief Privatize shared blocks about to be written (lock held)
+   * @param seq Sequence growing into positions [first_token, target_tokens)
+   * @param first_token First token position to be written
+   * @param target_tokens One past the last position to be written
+   * @return True if every block in the write range is now exclusively owned
+   *
+   * A sequence forked for n>1 sampling (or attached to prefix-cache
+   * blocks) shares its final partial block with its siblings; appending
+   * through the shared mapping would corrupt them. Any block in the
+   * write range with ref_count > 1 is deep-copied via Arena::copy_block
+   * and remapped, so siblings diverge only in the blocks they write.
+   */
+  bool resolve_cow_range(Sequence* seq, int first_token, int target_tokens);
+
+  /**
+   * @brief Free middle blocks of a streaming sequence (lock held)
+   * @param seq Sequence in streaming mode
+   *
+   * Unreferences every allocated block between the sinks and the
+   * trailing window and punches -1 holes in their page-table slots.
+   */
+  void reclaim_streaming_blocks(Sequence* seq);
+
+  /**
+   * @brief Total page-table entries across all sequences (lock held)
+   */
+  int total_blocks_locked() const;
+
   std::shared_ptr<Arena> arena_;
   std::unordered_map<int, std::unique_ptr<Sequence>> sequences_;
   mutable std::mutex mutex_;
   int num_forks_;
+  int num_cow_copies_ = 0;
+  int block_quota_;  // 0 = unlimited
 };
 
 }  // namespace kv
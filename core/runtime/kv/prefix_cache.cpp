@@ -0,0 +1,280 @@
+/**
+ * @file prefix_cache.cpp
+ * @brief Implementation of the shared-prefix KV block cache
+ */
+
+#include "prefix_cache.h"
+
+#include <iostream>
+
+namespace mlxr {
+namespace runtime {
+namespace kv {
+
+PrefixCache::PrefixCache(std::shared_ptr<Pager> pager,
+                         const PrefixCacheConfig& config)
+    : pager_(pager),
+      config_(config),
+      cached_blocks_(0),
+      access_counter_(0),
+      lookups_(0),
+      hits_(0),
+      tokens_reused_(0) {
+  if (!pager_) {
+    throw std::invalid_argument("Pager cannot be null");
+  }
+}
+
+PrefixCache::~PrefixCache() { clear(); }
+
+uint64_t PrefixCache::hash_span(const std::vector<int>& tokens, int start,
+                                int count) {
+  // FNV-1a over the token span
+  uint64_t hash = 14695981039346656037ULL;
+  for (int i = start; i < start + count; ++i) {
+    uint64_t t = static_cast<uint64_t>(static_cast<uint32_t>(tokens[i]));
+    for (int b = 0; b < 4; ++b) {
+      hash ^= (t >> (b * 8)) & 0xFF;
+      hash *= 1099511628211ULL;
+    }
+  }
+  return hash;
+}
+
+bool PrefixCache::span_matches(const Node& node, const std::vector<int>& tokens,
+                               int start, int count) {
+  if (static_cast<int>(node.tokens.size()) != count) {
+    return false;
+  }
+  for (int i = 0; i < count; ++i) {
+    if (node.tokens[i] != tokens[start + i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int PrefixCache::match_and_attach(const std::vector<int>& tokens, int seq_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lookups_++;
+  evict_expired();
+
+  int block_size = pager_->arena().config().block_size_tokens;
+  int num_full_blocks = static_cast<int>(tokens.size()) / block_size;
+
+  if (num_full_blocks == 0) {
+    return 0;
+  }
+
+  // Walk the tree block by block collecting matched block IDs
+  std::vector<int> matched_blocks;
+  Node* node = &root_;
+  for (int i = 0; i < num_full_blocks; ++i) {
+    int start = i * block_size;
+    uint64_t key = hash_span(tokens, start, block_size);
+
+    auto it = node->children.find(key);
+    if (it == node->children.end() ||
+        !span_matches(*it->second, tokens, start, block_size) ||
+        it->second->block_id < 0) {
+      break;
+    }
+
+    node = it->second.get();
+    node->last_access = next_access_time();
+    node->last_touch = std::chrono::steady_clock::now();
+    matched_blocks.push_back(node->block_id);
+  }
+
+  if (matched_blocks.empty()) {
+    return 0;
+  }
+
+  // Never cover the entire prompt: the caller must prefill at least one
+  // token to produce logits, and that token would otherwise write into a
+  // shared block. Dropping the last matched block keeps shared blocks
+  // strictly read-only.
+  int matched_tokens = static_cast<int>(matched_blocks.size()) * block_size;
+  if (matched_tokens >= static_cast<int>(tokens.size())) {
+    matched_blocks.pop_back();
+    matched_tokens -= block_size;
+  }
+
+  if (matched_blocks.empty()) {
+    return 0;
+  }
+
+  // Attach the matched blocks copy-on-write to the new sequence
+  if (!pager_->attach_shared_blocks(seq_id, matched_blocks, matched_tokens)) {
+    return 0;
+  }
+
+  hits_++;
+  tokens_reused_ += matched_tokens;
+
+  return matched_tokens;
+}
+
+void PrefixCache::insert(const std::vector<int>& tokens, int seq_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  evict_expired();
+
+  Sequence* seq = pager_->get_sequence(seq_id);
+  if (!seq) {
+    return;
+  }
+
+  int block_size = pager_->arena().config().block_size_tokens;
+  int num_full_blocks = static_cast<int>(tokens.size()) / block_size;
+
+  if (num_full_blocks < config_.min_prefix_blocks) {
+    return;
+  }
+
+  Node* node = &root_;
+  for (int i = 0; i < num_full_blocks; ++i) {
+    int start = i * block_size;
+    uint64_t key = hash_span(tokens, start, block_size);
+
+    auto it = node->children.find(key);
+    if (it != node->children.end() &&
+        span_matches(*it->second, tokens, start, block_size)) {
+      // Existing entry - just refresh LRU and TTL
+      node = it->second.get();
+      node->last_access = next_access_time();
+      node->last_touch = std::chrono::steady_clock::now();
+      continue;
+    }
+
+    // New entry: take a reference on the sequence's block for this span
+    int block_id = seq->get_block_id(i);
+    if (block_id < 0 || !pager_->get_block(block_id)) {
+      break;  // Sequence doesn't cover this block - stop indexing
+    }
+
+    auto child = std::make_unique<Node>();
+    child->tokens.assign(tokens.begin() + start,
+                         tokens.begin() + start + block_size);
+    child->block_id = block_id;
+    child->last_access = next_access_time();
+    child->last_touch = std::chrono::steady_clock::now();
+    child->parent = node;
+
+    pager_->arena().ref_block(block_id);
+    cached_blocks_++;
+
+    Node* child_ptr = child.get();
+    node->children[key] = std::move(child);
+    node = child_ptr;
+  }
+
+  evict_to_budget();
+}
+
+void PrefixCache::evict_to_budget() {
+  while (cached_blocks_ > config_.max_cached_blocks) {
+    Node* leaf = find_lru_leaf(&root_);
+    if (!leaf || leaf == &root_) {
+      break;
+    }
+    remove_leaf(leaf);
+  }
+}
+
+void PrefixCache::evict_expired() {
+  if (config_.ttl_seconds <= 0) {
+    return;
+  }
+
+  auto deadline = std::chrono::steady_clock::now() -
+                  std::chrono::seconds(config_.ttl_seconds);
+
+  // Nodes are only touched along root-to-leaf walks, so a parent is
+  // never older than its children; removing an expired leaf may expose
+  // an equally expired parent, which the next iteration picks up
+  while (Node* leaf = find_expired_leaf(&root_, deadline)) {
+    remove_leaf(leaf);
+  }
+}
+
+PrefixCache::Node* PrefixCache::find_expired_leaf(
+    Node* node, std::chrono::steady_clock::time_point deadline) {
+  if (node->children.empty()) {
+    if (node == &root_ || node->last_touch >= deadline) {
+      return nullptr;
+    }
+    return node;
+  }
+
+  for (auto& [key, child] : node->children) {
+    Node* leaf = find_expired_leaf(child.get(), deadline);
+    if (leaf) {
+      return leaf;
+    }
+  }
+  return nullptr;
+}
+
+PrefixCache::Node* PrefixCache::find_lru_leaf(Node* node) {
+  if (node->children.empty()) {
+    return node == &root_ ? nullptr : node;
+  }
+
+  Node* best = nullptr;
+  for (auto& [key, child] : node->children) {
+    Node* leaf = find_lru_leaf(child.get());
+    if (leaf && (!best || leaf->last_access < best->last_access)) {
+      best = leaf;
+    }
+  }
+  return best;
+}
+
+void PrefixCache::remove_leaf(Node* leaf) {
+  if (!leaf || !leaf->parent) {
+    return;
+  }
+
+  if (leaf->block_id >= 0) {
+    pager_->arena().unref_block(leaf->block_id);
+    cached_blocks_--;
+  }
+
+  Node* parent = leaf->parent;
+  for (auto it = parent->children.begin(); it != parent->children.end(); ++it) {
+    if (it->second.get() == leaf) {
+      parent->children.erase(it);
+      return;
+    }
+  }
+}
+
+void PrefixCache::release_subtree(Node* node) {
+  for (auto& [key, child] : node->children) {
+    release_subtree(child.get());
+    if (child->block_id >= 0) {
+      pager_->arena().unref_block(child->block_id);
+      cached_blocks_--;
+    }
+  }
+  node->children.clear();
+}
+
+void PrefixCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  release_subtree(&root_);
+}
+
+PrefixCache::Stats PrefixCache::get_stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats;
+  stats.lookups = lookups_;
+  stats.hits = hits_;
+  stats.tokens_reused = tokens_reused_;
+  stats.cached_blocks = cached_blocks_;
+  return stats;
+}
+
+}  // namespace kv
+}  // namespace runtime
+}  // namespace mlxr
@@ -0,0 +1,215 @@
+/**
+ * @file prefix_cache.h
+ * @brief Shared-prefix prompt cache with radix-tree KV block reuse
+ *
+ * Indexes token prefixes at block granularity and maps matched prefixes
+ * to existing KV cache blocks. New sequences attach matched blocks
+ * copy-on-write through the arena's ref_count, turning repeated system
+ * prompts into a handful of new prefill tokens instead of a full
+ * recompute.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "pager.h"
+
+namespace mlxr {
+namespace runtime {
+namespace kv {
+
+/**
+ * @brief Configuration for the prefix cache
+ */
+struct PrefixCacheConfig {
+  // Maximum number of KV blocks the cache may pin (LRU evicted beyond this)
+  int max_cached_blocks = 512;
+
+  // Minimum prefix length in blocks before a prefix is worth caching
+  int min_prefix_blocks = 1;
+
+  // Seconds an untouched entry stays pinned before TTL eviction
+  // reclaims its block (0 = no TTL, budget-driven LRU only). Bounds how
+  // long an idle conversation's KV survives between chat turns
+  int ttl_seconds = 0;
+};
+
+/**
+ * @brief Radix-tree index from token prefixes to KV cache blocks
+ *
+ * Each tree node covers exactly one KV block worth of tokens, so a path
+ * from the root spells out a block-aligned token prefix and carries the
+ * block IDs holding its cached K/V. The cache holds its own reference on
+ * every indexed block (via Arena::ref_block), so blocks stay alive after
+ * the originating sequence is deleted. Attaching a match to a new
+ * sequence adds another reference - the same copy-on-write sharing used
+ * by Pager::fork_sequence.
+ *
+ * Matches are always whole blocks: a sequence that continues past the
+ * matched prefix writes new tokens into freshly allocated blocks, so
+ * shared blocks are never written to.
+ *
+ * Thread-safe.
+ */
+class PrefixCache {
+ public:
+  /**
+   * @brief Construct prefix cache over a pager
+   * @param pager Pager whose arena owns the KV blocks
+   * @param config Cache configuration
+   */
+  PrefixCache(std::shared_ptr<Pager> pager,
+              const PrefixCacheConfig& config = PrefixCacheConfig());
+
+  /**
+   * @brief Destructor - releases all cached block references
+   */
+  ~PrefixCache();
+
+  // Disable copy and move
+  PrefixCache(const PrefixCache&) = delete;
+  PrefixCache& operator=(const PrefixCache&) = delete;
+
+  /**
+   * @brief Match the longest cached prefix and attach it to a sequence
+   * @param tokens Full prompt token IDs
+   * @param seq_id Destination sequence (must exist and be empty)
+   * @return Number of prompt tokens covered by attached blocks
+   *         (always a multiple of block size; 0 on miss)
+   *
+   * On a hit, the matched blocks are ref'd and installed as the head of
+   * the sequence's page table; the caller only needs to prefill the
+   * remaining suffix starting at the returned position.
+   */
+  int match_and_attach(const std::vector<int>& tokens, int seq_id);
+
+  /**
+   * @brief Index a prefilled sequence's blocks under its prompt tokens
+   * @param tokens Prompt token IDs that were prefilled
+   * @param seq_id Sequence whose blocks now hold the prompt's K/V
+   *
+   * Only full blocks are indexed; the trailing partial block (if any) is
+   * skipped since it will be written to as the sequence decodes.
+   */
+  void insert(const std::vector<int>& tokens, int seq_id);
+
+  /**
+   * @brief Release all cached blocks and reset the tree
+   */
+  void clear();
+
+  /**
+   * @brief Get statistics
+   */
+  struct Stats {
+    uint64_t lookups;
+    uint64_t hits;
+    uint64_t tokens_reused;
+    int cached_blocks;
+  };
+
+  Stats get_stats() const;
+
+ private:
+  /**
+   * @brief Radix tree node covering one KV block of tokens
+   */
+  struct Node {
+    // Token span covered by this node (block_size tokens, except root)
+    std::vector<int> tokens;
+
+    // KV block holding this span's K/V (-1 for the root)
+    int block_id = -1;
+
+    // Last access for LRU eviction
+    uint64_t last_access = 0;
+
+    // Wall-clock last touch for TTL eviction
+    std::chrono::steady_clock::time_point last_touch;
+
+    // Children keyed by a hash of their token span
+    std::unordered_map<uint64_t, std::unique_ptr<Node>> children;
+
+    Node* parent = nullptr;
+  };
+
+  /**
+   * @brief Hash a block-sized token span for child lookup
+   */
+  static uint64_t hash_span(const std::vector<int>& tokens, int start,
+                            int count);
+
+  /**
+   * @brief Check that a node's span matches the given tokens
+   */
+  static bool span_matches(const Node& node, const std::vector<int>& tokens,
+                           int start, int count);
+
+  /**
+   * @brief Evict least-recently-used leaves until within block budget
+   * Caller must hold mutex_
+   */
+  void evict_to_budget();
+
+  /**
+   * @brief Evict leaves whose last touch is older than the TTL
+   * Removing a leaf may expose an expired parent, so eviction loops
+   * until no expired leaf remains. No-op when ttl_seconds is 0.
+   * Caller must hold mutex_
+   */
+  void evict_expired();
+
+  /**
+   * @brief Find any leaf last touched before the deadline
+   * Caller must hold mutex_
+   */
+  Node* find_expired_leaf(Node* node,
+                          std::chrono::steady_clock::time_point deadline);
+
+  /**
+   * @brief Find the least-recently-used leaf node
+   * Caller must hold mutex_
+   */
+  Node* find_lru_leaf(Node* node);
+
+  /**
+   * @brief Release a leaf node's block and unlink it from its parent
+   * Caller must hold mutex_
+   */
+  void remove_leaf(Node* leaf);
+
+  /**
+   * @brief Release block references for an entire subtree
+   * Caller must hold mutex_
+   */
+  void release_subtree(Node* node);
+
+  /**
+   * @brief Monotonic access counter for LRU ordering
+   */
+  uint64_t next_access_time() { return ++access_counter_; }
+
+  std::shared_ptr<Pager> pager_;
+  PrefixCacheConfig config_;
+
+  Node root_;
+  int cached_blocks_;
+  uint64_t access_counter_;
+
+  mutable std::mutex mutex_;
+
+  // Statistics
+  uint64_t lookups_;
+  uint64_t hits_;
+  uint64_t tokens_reused_;
+};
+
+}  // namespace kv
+}  // namespace runtime
+}  // namespace mlxr
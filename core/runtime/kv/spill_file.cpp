@@ -0,0 +1,333 @@
+/**
+ * @file spill_file.cpp
+ * @brief Implementation of the memory-mapped KV spill tier
+ */
+
+#include "spill_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+namespace mlxr {
+namespace runtime {
+namespace kv {
+
+namespace {
+
+/**
+ * @brief Round a size up to a multiple of the system page size
+ */
+size_t round_to_page(size_t bytes) {
+  size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return ((bytes + page - 1) / page) * page;
+}
+
+}  // namespace
+
+SpillFile::SpillFile(const SpillFileConfig& config)
+    : config_(config),
+      slot_bytes_(round_to_page(config.block_bytes)),
+      fd_(-1),
+      map_(nullptr),
+      mapped_bytes_(0),
+      num_slots_(0),
+      next_slot_(0),
+      should_stop_(false),
+      stats_{} {
+  if (config_.block_bytes == 0) {
+    throw std::invalid_argument("SpillFile block_bytes must be non-zero");
+  }
+
+  // Create parent directory if needed
+  std::filesystem::path path(config_.path);
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path());
+  }
+
+  // Open (or create) the spill file
+  fd_ = ::open(config_.path.c_str(), O_RDWR | O_CREAT, 0600);
+  if (fd_ < 0) {
+    throw std::runtime_error("Failed to open spill file: " + config_.path);
+  }
+
+  // Reserve initial slots
+  {
+    std::lock_guard<std::mutex> lock(map_mutex_);
+    if (!ensure_capacity(std::max(config_.initial_slots, 1))) {
+      ::close(fd_);
+      fd_ = -1;
+      throw std::runtime_error("Failed to map spill file: " + config_.path);
+    }
+  }
+
+  // Start the write-behind thread
+  writer_thread_ = std::thread(&SpillFile::writer_loop, this);
+
+  std::cout << "[SpillFile] Mapped " << config_.path << " ("
+            << num_slots_ << " slots, " << slot_bytes_ << " bytes/slot)"
+            << std::endl;
+}
+
+SpillFile::~SpillFile() {
+  // Stop the writer thread after draining pending writes
+  flush();
+  should_stop_ = true;
+  queue_cv_.notify_all();
+  if (writer_thread_.joinable()) {
+    writer_thread_.join();
+  }
+
+  std::lock_guard<std::mutex> lock(map_mutex_);
+  if (map_) {
+    ::munmap(map_, mapped_bytes_);
+    map_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+bool SpillFile::ensure_capacity(int num_slots) {
+  if (num_slots <= num_slots_) {
+    return true;
+  }
+
+  // Grow by doubling to amortize remap cost
+  int new_slots = std::max(num_slots_, 1);
+  while (new_slots < num_slots) {
+    new_slots *= 2;
+  }
+
+  size_t new_bytes = static_cast<size_t>(new_slots) * slot_bytes_;
+
+  if (::ftruncate(fd_, static_cast<off_t>(new_bytes)) != 0) {
+    std::cerr << "[SpillFile] ftruncate failed for " << new_bytes << " bytes"
+              << std::endl;
+    return false;
+  }
+
+  // Remap the grown file (mremap is not available on macOS)
+  if (map_) {
+    ::munmap(map_, mapped_bytes_);
+    map_ = nullptr;
+  }
+
+  void* map = ::mmap(nullptr, new_bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fd_, 0);
+  if (map == MAP_FAILED) {
+    std::cerr << "[SpillFile] mmap failed for " << new_bytes << " bytes"
+              << std::endl;
+    return false;
+  }
+
+  map_ = static_cast<char*>(map);
+  mapped_bytes_ = new_bytes;
+  num_slots_ = new_slots;
+
+  return true;
+}
+
+int SpillFile::allocate_slot() {
+  std::lock_guard<std::mutex> slot_lock(slot_mutex_);
+
+  if (!free_slots_.empty()) {
+    int slot = free_slots_.back();
+    free_slots_.pop_back();
+    return slot;
+  }
+
+  int slot = next_slot_++;
+
+  std::lock_guard<std::mutex> map_lock(map_mutex_);
+  if (!ensure_capacity(slot + 1)) {
+    next_slot_--;
+    return -1;
+  }
+
+  return slot;
+}
+
+int SpillFile::spill_block(const Block& block) {
+  int slot = allocate_slot();
+  if (slot < 0) {
+    return -1;
+  }
+
+  PendingWrite write;
+  write.slot = slot;
+
+  try {
+    // Materialize tensors and copy their bytes out so the block can be
+    // freed immediately; the disk write happens on the writer thread
+    auto k_arr = block.k_data.array();
+    auto v_arr = block.v_data.array();
+    mlx::core::eval(k_arr);
+    mlx::core::eval(v_arr);
+
+    size_t k_bytes = k_arr.nbytes();
+    size_t v_bytes = v_arr.nbytes();
+    if (k_bytes + v_bytes > config_.block_bytes) {
+      std::cerr << "[SpillFile] Block payload exceeds slot size" << std::endl;
+      release_slot(slot);
+      return -1;
+    }
+
+    write.k_bytes.resize(k_bytes);
+    write.v_bytes.resize(v_bytes);
+    std::memcpy(write.k_bytes.data(), k_arr.data<char>(), k_bytes);
+    std::memcpy(write.v_bytes.data(), v_arr.data<char>(), v_bytes);
+
+  } catch (const std::exception& e) {
+    std::cerr << "[SpillFile] Failed to copy block for spill: " << e.what()
+              << std::endl;
+    release_slot(slot);
+    return -1;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    write_queue_.push_back(std::move(write));
+  }
+  queue_cv_.notify_one();
+
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.blocks_spilled++;
+  }
+
+  return slot;
+}
+
+bool SpillFile::fault_block(int slot, Block* block) {
+  if (!block || slot < 0) {
+    return false;
+  }
+
+  // Ensure any pending write to this slot has landed in the mapping
+  flush();
+
+  std::lock_guard<std::mutex> lock(map_mutex_);
+  if (slot >= num_slots_ || !map_) {
+    return false;
+  }
+
+  try {
+    auto& k_arr = block->k_data.array();
+    auto& v_arr = block->v_data.array();
+    mlx::core::eval(k_arr);
+    mlx::core::eval(v_arr);
+
+    size_t k_bytes = k_arr.nbytes();
+    size_t v_bytes = v_arr.nbytes();
+    if (k_bytes + v_bytes > config_.block_bytes) {
+      return false;
+    }
+
+    const char* base = map_ + static_cast<size_t>(slot) * slot_bytes_;
+    std::memcpy(k_arr.data<char>(), base, k_bytes);
+    std::memcpy(v_arr.data<char>(), base + k_bytes, v_bytes);
+
+    block->dirty = false;
+
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    stats_.blocks_faulted++;
+    stats_.bytes_read += k_bytes + v_bytes;
+
+    return true;
+
+  } catch (const std::exception& e) {
+    std::cerr << "[SpillFile] Failed to fault block: " << e.what() << std::endl;
+    return false;
+  }
+}
+
+void SpillFile::release_slot(int slot) {
+  if (slot < 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(slot_mutex_);
+  free_slots_.push_back(slot);
+}
+
+void SpillFile::flush() {
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  drained_cv_.wait(lock, [this] { return write_queue_.empty(); });
+}
+
+void SpillFile::writer_loop() {
+  while (true) {
+    PendingWrite write;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cv_.wait(lock,
+                     [this] { return should_stop_ || !write_queue_.empty(); });
+
+      if (write_queue_.empty()) {
+        if (should_stop_) {
+          return;
+        }
+        continue;
+      }
+
+      write = std::move(write_queue_.front());
+      write_queue_.pop_front();
+    }
+
+    write_slot(write);
+
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      if (write_queue_.empty()) {
+        drained_cv_.notify_all();
+      }
+    }
+  }
+}
+
+void SpillFile::write_slot(const PendingWrite& write) {
+  std::lock_guard<std::mutex> lock(map_mutex_);
+  if (write.slot >= num_slots_ || !map_) {
+    return;
+  }
+
+  char* base = map_ + static_cast<size_t>(write.slot) * slot_bytes_;
+  std::memcpy(base, write.k_bytes.data(), write.k_bytes.size());
+  std::memcpy(base + write.k_bytes.size(), write.v_bytes.data(),
+              write.v_bytes.size());
+
+  if (config_.sync_after_write) {
+    ::msync(base, slot_bytes_, MS_ASYNC);
+  }
+
+  std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+  stats_.bytes_written += write.k_bytes.size() + write.v_bytes.size();
+}
+
+SpillFile::Stats SpillFile::get_stats() const {
+  Stats stats;
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats = stats_;
+  }
+  {
+    std::lock_guard<std::mutex> lock(slot_mutex_);
+    stats.slots_in_use = next_slot_ - static_cast<int>(free_slots_.size());
+  }
+  {
+    std::lock_guard<std::mutex> lock(map_mutex_);
+    stats.slots_total = num_slots_;
+  }
+  return stats;
+}
+
+}  // namespace kv
+}  // namespace runtime
+}  // namespace mlxr
@@ -0,0 +1,184 @@
+/**
+ * @file spill_file.h
+ * @brief Memory-mapped disk spill tier for evicted KV cache blocks
+ *
+ * Implements the third KV cache tier below GPU and CPU memory:
+ * - Single page-aligned spill file under the cache directory
+ * - Fixed-size slots (one per block), managed via a free list
+ * - Asynchronous write-behind on a background thread
+ * - Synchronous fault-back into arena blocks on resume
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena.h"
+
+namespace mlxr {
+namespace runtime {
+namespace kv {
+
+/**
+ * @brief Configuration for the KV spill file
+ */
+struct SpillFileConfig {
+  // Path to the spill file (under the cache directory)
+  std::string path = "kv_spill.bin";
+
+  // Raw bytes per block (K + V payload); slots are rounded up to a
+  // multiple of the system page size
+  size_t block_bytes = 0;
+
+  // Initial number of slots to reserve; the file grows by doubling
+  int initial_slots = 64;
+
+  // Whether to issue msync(MS_ASYNC) after each slot write
+  bool sync_after_write = false;
+};
+
+/**
+ * @brief Memory-mapped spill file for evicted KV blocks
+ *
+ * Evicted blocks are copied out of their MLX tensors and enqueued for a
+ * background writer thread, so eviction never blocks on disk I/O. Reads
+ * (faults) are synchronous: the caller needs the data to resume decoding.
+ *
+ * Thread-safe. Slot IDs are stable until released.
+ */
+class SpillFile {
+ public:
+  /**
+   * @brief Construct and map the spill file
+   * @param config Spill file configuration
+   * @throws std::runtime_error if the file cannot be created or mapped
+   */
+  explicit SpillFile(const SpillFileConfig& config);
+
+  /**
+   * @brief Destructor - flushes pending writes and unmaps the file
+   */
+  ~SpillFile();
+
+  // Disable copy and move
+  SpillFile(const SpillFile&) = delete;
+  SpillFile& operator=(const SpillFile&) = delete;
+
+  /**
+   * @brief Spill a block to disk asynchronously
+   * @param block Block whose K/V payload should be written
+   * @return Slot ID for later fault-back, or -1 on failure
+   *
+   * Copies the block's K and V bytes immediately (so the block can be
+   * freed right away) and enqueues the slot write for the background
+   * writer thread.
+   */
+  int spill_block(const Block& block);
+
+  /**
+   * @brief Fault a spilled block back into an arena block
+   * @param slot Slot ID returned by spill_block
+   * @param block Destination block (tensors must match original shape)
+   * @return True if successful
+   *
+   * Synchronous: waits for any pending write to this slot, then copies
+   * the slot's bytes back into the block's K/V tensors.
+   */
+  bool fault_block(int slot, Block* block);
+
+  /**
+   * @brief Release a slot back to the free list
+   * @param slot Slot ID to release
+   */
+  void release_slot(int slot);
+
+  /**
+   * @brief Wait until all pending writes have reached the mapping
+   */
+  void flush();
+
+  /**
+   * @brief Get slot size in bytes (block_bytes rounded to page size)
+   */
+  size_t slot_bytes() const { return slot_bytes_; }
+
+  /**
+   * @brief Get statistics
+   */
+  struct Stats {
+    int slots_in_use;
+    int slots_total;
+    uint64_t blocks_spilled;
+    uint64_t blocks_faulted;
+    uint64_t bytes_written;
+    uint64_t bytes_read;
+  };
+
+  Stats get_stats() const;
+
+ private:
+  struct PendingWrite {
+    int slot;
+    std::vector<char> k_bytes;
+    std::vector<char> v_bytes;
+  };
+
+  /**
+   * @brief Background writer loop - drains the pending write queue
+   */
+  void writer_loop();
+
+  /**
+   * @brief Copy a pending write into its mapped slot
+   */
+  void write_slot(const PendingWrite& write);
+
+  /**
+   * @brief Grow file and mapping to hold at least num_slots slots
+   * Caller must hold map_mutex_
+   */
+  bool ensure_capacity(int num_slots);
+
+  /**
+   * @brief Allocate a slot ID (from free list or by growing)
+   */
+  int allocate_slot();
+
+  SpillFileConfig config_;
+  size_t slot_bytes_;
+
+  // File and mapping (guarded by map_mutex_)
+  int fd_;
+  char* map_;
+  size_t mapped_bytes_;
+  int num_slots_;
+  mutable std::mutex map_mutex_;
+
+  // Slot management (guarded by slot_mutex_)
+  std::vector<int> free_slots_;
+  int next_slot_;
+  mutable std::mutex slot_mutex_;
+
+  // Write-behind queue
+  std::deque<PendingWrite> write_queue_;
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+  std::condition_variable drained_cv_;
+  std::thread writer_thread_;
+  std::atomic<bool> should_stop_;
+
+  // Statistics
+  mutable std::mutex stats_mutex_;
+  Stats stats_;
+};
+
+}  // namespace kv
+}  // namespace runtime
+}  // namespace mlxr
@@ -12,6 +12,10 @@
 
 #include "mlx/mlx.h"
 
+#ifdef USE_CUSTOM_KERNELS
+#include "../kernels/primitives/sample_batch_primitive.h"
+#endif
+
 namespace mlxr {
 namespace runtime {
 
@@ -58,6 +62,222 @@ int Sampler::sample(const graph::Tensor& logits,
   }
 }
 
+int Sampler::sample(const graph::Tensor& logits,
+                    const std::unordered_map<int, int>& token_counts) {
+  // Sparse penalty over distinct tokens only, then dispatch through the
+  // list-based path with an empty context so no second penalty runs
+  graph::Tensor modified_logits = logits;
+  if (config_.repetition_penalty != 1.0f && !token_counts.empty()) {
+    modified_logits = apply_repetition_penalty_sparse(
+        logits, token_counts, config_.repetition_penalty);
+  }
+  return sample(modified_logits, std::vector<int>{});
+}
+
+std::vector<int> Sampler::sample_batch(
+    const std::vector<graph::Tensor>& logits_rows,
+    const std::vector<SamplerConfig>& configs,
+    const std::vector<std::vector<int>>& prev_token_lists) {
+  size_t batch = logits_rows.size();
+  if (configs.size() != batch || prev_token_lists.size() != batch) {
+    throw std::invalid_argument(
+        "sample_batch: logits, configs and token lists must have equal size");
+  }
+  if (batch == 0) {
+    return {};
+  }
+
+#ifdef USE_CUSTOM_KERNELS
+  // The fused kernel handles temperature/top-k/top-p/repetition penalty
+  // but not min_p, and expects 1D rows with a common vocab size
+  bool gpu_eligible = true;
+  int vocab_size = logits_rows[0].shape().back();
+  for (size_t i = 0; i < batch; i++) {
+    if (configs[i].min_p != 0.0f || logits_rows[i].shape().size() != 1 ||
+        logits_rows[i].shape()[0] != vocab_size) {
+      gpu_eligible = false;
+      break;
+    }
+  }
+
+  if (gpu_eligible) {
+    std::vector<kernels::RowSamplingParams> params(batch);
+    std::vector<std::vector<int>> penalty_tokens(batch);
+
+    for (size_t i = 0; i < batch; i++) {
+      const SamplerConfig& cfg = configs[i];
+      kernels::RowSamplingParams& p = params[i];
+      p.temperature = cfg.temperature;
+      // When both top-k and top-p are set, the scalar path applies only
+      // top-p (see sample()); mirror that by disabling top-k so the
+      // kernel uses its full candidate cap for the nucleus
+      p.top_k = (cfg.top_p > 0.0f) ? 0 : cfg.top_k;
+      p.top_p = cfg.top_p;
+      p.repetition_penalty = cfg.repetition_penalty;
+
+      // Pre-draw the row's uniform on the host so seeded configs stay
+      // reproducible and the kernel needs no device-side RNG
+      std::mt19937 rng;
+      if (cfg.seed == 0) {
+        std::random_device rd;
+        rng.seed(rd());
+      } else {
+        rng.seed(cfg.seed);
+      }
+      std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+      p.uniform = dist(rng);
+
+      // Deduplicate context IDs: the kernel scatters the penalty once
+      // per listed token
+      if (cfg.repetition_penalty != 1.0f && !prev_token_lists[i].empty()) {
+        std::vector<int> unique_tokens = prev_token_lists[i];
+        std::sort(unique_tokens.begin(), unique_tokens.end());
+        unique_tokens.erase(
+            std::unique(unique_tokens.begin(), unique_tokens.end()),
+            unique_tokens.end());
+        penalty_tokens[i] = std::move(unique_tokens);
+      }
+    }
+
+    // Stack rows into [batch, vocab] and sample in ONE dispatch
+    std::vector<mlx::core::array> row_arrays;
+    row_arrays.reserve(batch);
+    for (size_t i = 0; i < batch; i++) {
+      row_arrays.push_back(logits_rows[i].array());
+    }
+    auto stacked = mlx::core::stack(row_arrays, /*axis=*/0);
+
+    auto tokens_arr =
+        kernels::sample_batch_fused(stacked, params, penalty_tokens);
+    mlx::core::eval(tokens_arr);
+
+    const int* tokens_data = tokens_arr.data<int>();
+    return std::vector<int>(tokens_data, tokens_data + batch);
+  }
+#endif
+
+  // CPU fallback: per-row sampling with identical semantics to the
+  // scalar path
+  std::vector<int> tokens(batch);
+  for (size_t i = 0; i < batch; i++) {
+    Sampler row_sampler(configs[i]);
+    tokens[i] = row_sampler.sample(logits_rows[i], prev_token_lists[i]);
+  }
+  return tokens;
+}
+
+std::vector<int> Sampler::sample_batch(
+    const std::vector<graph::Tensor>& logits_rows,
+    const std::vector<SamplerConfig>& configs,
+    const std::vector<const std::unordered_map<int, int>*>&
+        token_count_maps) {
+  if (token_count_maps.size() != logits_rows.size()) {
+    throw std::invalid_argument(
+        "sample_batch: logits and token count maps must have equal size");
+  }
+
+  // The tables hold each token once, so the penalty context per row is
+  // just the key set - no copy of the full history and nothing left to
+  // deduplicate
+  std::vector<std::vector<int>> penalty_lists(token_count_maps.size());
+  for (size_t i = 0; i < token_count_maps.size(); i++) {
+    if (token_count_maps[i] && configs[i].repetition_penalty != 1.0f) {
+      penalty_lists[i].reserve(token_count_maps[i]->size());
+      for (const auto& entry : *token_count_maps[i]) {
+        penalty_lists[i].push_back(entry.first);
+      }
+    }
+  }
+  return sample_batch(logits_rows, configs, penalty_lists);
+}
+
+std::vector<TopLogprobs> Sampler::extract_top_logprobs(
+    const std::vector<graph::Tensor>& logits_rows,
+    const std::vector<int>& sampled_tokens, int k) {
+  size_t batch = logits_rows.size();
+  if (sampled_tokens.size() != batch) {
+    throw std::invalid_argument(
+        "extract_top_logprobs: logits and sampled tokens must have equal "
+        "size");
+  }
+  if (batch == 0) {
+    return {};
+  }
+
+  int vocab_size = logits_rows[0].shape().back();
+  k = std::max(0, std::min(k, vocab_size));
+
+  // Stack into [batch, vocab] and compute log-softmax lazily: the full
+  // rows never materialize on the host, only the gathered results do
+  std::vector<mlx::core::array> row_arrays;
+  row_arrays.reserve(batch);
+  for (size_t i = 0; i < batch; i++) {
+    row_arrays.push_back(logits_rows[i].array());
+  }
+  auto stacked = mlx::core::astype(mlx::core::stack(row_arrays, /*axis=*/0),
+                                   mlx::core::float32);
+  auto lse =
+      mlx::core::logsumexp(stacked, std::vector<int>{1}, /*keepdims=*/true);
+  auto logprobs = mlx::core::subtract(stacked, lse);
+
+  // Sampled token's logprob via a [batch, 1] gather
+  auto sampled_ids =
+      mlx::core::array(sampled_tokens.data(),
+                       {static_cast<int>(batch), 1}, mlx::core::int32);
+  auto sampled_lp = mlx::core::take_along_axis(logprobs, sampled_ids,
+                                               /*axis=*/1);
+
+  std::vector<TopLogprobs> results(batch);
+
+  if (k == 0) {
+    mlx::core::eval(sampled_lp);
+    const float* lp_data = sampled_lp.data<float>();
+    for (size_t i = 0; i < batch; i++) {
+      results[i].sampled_logprob = lp_data[i];
+    }
+    return results;
+  }
+
+  // argpartition sorts ascending around position vocab-k, so the top-k
+  // set occupies the last k positions (unordered); gathering their
+  // values gives a compact [batch, k] result to sort on the host
+  auto part = mlx::core::argpartition(logprobs, vocab_size - k, /*axis=*/1);
+  auto topk_idx = mlx::core::astype(
+      mlx::core::slice(part, {0, vocab_size - k},
+                       {static_cast<int>(batch), vocab_size}, {1, 1}),
+      mlx::core::int32);
+  auto topk_vals = mlx::core::take_along_axis(logprobs, topk_idx, /*axis=*/1);
+  mlx::core::eval({sampled_lp, topk_idx, topk_vals});
+
+  const float* lp_data = sampled_lp.data<float>();
+  const int* idx_data = topk_idx.data<int>();
+  const float* val_data = topk_vals.data<float>();
+
+  for (size_t i = 0; i < batch; i++) {
+    TopLogprobs& row = results[i];
+    row.sampled_logprob = lp_data[i];
+
+    // Order the k candidates best-first; k is tiny (OpenAI caps it at
+    // 20), so this is negligible host work
+    std::vector<size_t> order(k);
+    std::iota(order.begin(), order.end(), 0);
+    const float* row_vals = val_data + i * k;
+    const int* row_idx = idx_data + i * k;
+    std::sort(order.begin(), order.end(), [row_vals](size_t a, size_t b) {
+      return row_vals[a] > row_vals[b];
+    });
+
+    row.token_ids.reserve(k);
+    row.logprobs.reserve(k);
+    for (size_t j = 0; j < static_cast<size_t>(k); j++) {
+      row.token_ids.push_back(row_idx[order[j]]);
+      row.logprobs.push_back(row_vals[order[j]]);
+    }
+  }
+
+  return results;
+}
+
 int Sampler::sample_greedy(const graph::Tensor& logits) {
   // Find argmax
   auto logits_arr = logits.array();
@@ -278,5 +498,41 @@ graph::Tensor Sampler::apply_repetition_penalty(
   return graph::Tensor(modified_arr);
 }
 
+graph::Tensor Sampler::apply_repetition_penalty_sparse(
+    const graph::Tensor& logits,
+    const std::unordered_map<int, int>& token_counts, float penalty) {
+  if (penalty == 1.0f || token_counts.empty()) {
+    return logits;
+  }
+
+  auto logits_arr = logits.array();
+  mlx::core::eval(logits_arr);
+
+  auto shape = logits.shape();
+  int vocab_size = shape[0];
+
+  std::vector<float> logits_vec(vocab_size);
+  const float* logits_data = logits_arr.data<float>();
+  std::copy(logits_data, logits_data + vocab_size, logits_vec.begin());
+
+  // Scatter the penalty over the distinct tokens only; each is touched
+  // exactly once no matter how often it occurred
+  for (const auto& entry : token_counts) {
+    int token = entry.first;
+    if (token >= 0 && token < vocab_size) {
+      if (logits_vec[token] > 0.0f) {
+        logits_vec[token] /= penalty;
+      } else {
+        logits_vec[token] *= penalty;
+      }
+    }
+  }
+
+  auto modified_arr =
+      mlx::core::array(logits_vec.begin(), {vocab_size}, mlx::core::float32);
+
+  return graph::Tensor(modified_arr);
+}
+
 }  // namespace runtime
 }  // namespace mlxr
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <random>
+#include <unordered_map>
 #include <vector>
 
 #include "../graph/tensor.h"
@@ -46,6 +47,18 @@ struct SamplerConfig {
   float repetition_penalty = 1.0f;
 };
 
+/**
+ * @brief Per-row result of GPU-side top-k logprob extraction
+ *
+ * Compact record for the OpenAI logprobs field: the sampled token's
+ * log-probability plus the k best alternatives, ordered best-first.
+ */
+struct TopLogprobs {
+  float sampled_logprob = 0.0f;  // log P(sampled token)
+  std::vector<int> token_ids;    // top-k alternative token IDs
+  std::vector<float> logprobs;   // matching log-probabilities
+};
+
 /**
  * @brief Sampler for text generation
  *
@@ -69,6 +82,80 @@ class Sampler {
   int sample(const graph::Tensor& logits,
              const std::vector<int>& prev_tokens = {});
 
+  /**
+   * @brief Sample next token using a token frequency table
+   * @param logits Raw model output logits [vocab_size]
+   * @param token_counts Distinct token -> occurrence count for the
+   *        sequence (InferenceCache::token_counts), maintained
+   *        incrementally by the engine
+   * @return Sampled token ID
+   *
+   * Repetition penalty is scattered over only the distinct tokens in
+   * the table instead of rescanning the full prompt+generated history
+   * per step; at long contexts and large batches that scan is real CPU
+   * time between GPU steps.
+   */
+  int sample(const graph::Tensor& logits,
+             const std::unordered_map<int, int>& token_counts);
+
+  /**
+   * @brief Sample next token for a whole decode batch in one pass
+   * @param logits_rows Logits per sequence, each [vocab_size]
+   * @param configs Sampling configuration per sequence (same order)
+   * @param prev_token_lists Context tokens per sequence for repetition
+   *        penalty (prompt + generated so far)
+   * @return Sampled token ID per sequence
+   *
+   * With USE_CUSTOM_KERNELS the rows are stacked into [batch, vocab]
+   * and sampled by a single fused Metal dispatch (temperature, top-k,
+   * top-p and repetition penalty on-device); only int32 token IDs
+   * cross back to the host instead of one full logits row per
+   * sequence. Rows using min_p, and builds without custom kernels,
+   * fall back to per-row CPU sampling with identical semantics.
+   */
+  static std::vector<int> sample_batch(
+      const std::vector<graph::Tensor>& logits_rows,
+      const std::vector<SamplerConfig>& configs,
+      const std::vector<std::vector<int>>& prev_token_lists);
+
+  /**
+   * @brief Batched sampling using per-sequence token frequency tables
+   * @param logits_rows Logits per sequence, each [vocab_size]
+   * @param configs Sampling configuration per sequence (same order)
+   * @param token_count_maps Frequency table per sequence (entries may
+   *        be nullptr when the row needs no penalty)
+   * @return Sampled token ID per sequence
+   *
+   * The tables already hold distinct tokens, so the penalty context is
+   * a few hundred entries instead of the full prompt+generated history
+   * that the list-based overload copies, sorts and deduplicates per
+   * row per step.
+   */
+  static std::vector<int> sample_batch(
+      const std::vector<graph::Tensor>& logits_rows,
+      const std::vector<SamplerConfig>& configs,
+      const std::vector<const std::unordered_map<int, int>*>&
+          token_count_maps);
+
+  /**
+   * @brief Extract per-token logprobs for a decode batch on the GPU
+   * @param logits_rows Logits per sequence, each [vocab_size]
+   * @param sampled_tokens The token sampled from each row (same order)
+   * @param k Number of top alternatives to return per row (0 = only
+   *        the sampled token's logprob)
+   * @return One TopLogprobs record per row
+   *
+   * Log-softmax and top-k selection stay in the lazy compute graph, so
+   * supporting the OpenAI logprobs field costs one [batch, k] gather
+   * instead of copying each full vocab-sized logits row to the host
+   * (which would roughly halve decode throughput at 32K vocabularies).
+   * Only the compact [k ids, k logprobs] records and the sampled
+   * token's logprob cross back.
+   */
+  static std::vector<TopLogprobs> extract_top_logprobs(
+      const std::vector<graph::Tensor>& logits_rows,
+      const std::vector<int>& sampled_tokens, int k);
+
   /**
    * @brief Greedy sampling (argmax)
    * @param logits Raw model output logits [vocab_size]
@@ -119,6 +206,20 @@ class Sampler {
       const graph::Tensor& logits, const std::vector<int>& prev_tokens,
       float penalty);
 
+  /**
+   * @brief Apply repetition penalty from a token frequency table
+   * @param logits Raw model output logits [vocab_size]
+   * @param token_counts Distinct token -> occurrence count
+   * @param penalty Repetition penalty factor
+   * @return Modified logits with penalty applied
+   *
+   * Sparse scatter: only the table's distinct tokens are touched, each
+   * exactly once regardless of how often it occurred.
+   */
+  static graph::Tensor apply_repetition_penalty_sparse(
+      const graph::Tensor& logits,
+      const std::unordered_map<int, int>& token_counts, float penalty);
+
   /**
    * @brief Convert logits to probabilities using softmax
    * @param logits Raw logits
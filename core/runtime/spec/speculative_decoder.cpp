@@ -14,39 +14,67 @@
 namespace mlxr {
 namespace spec {
 
-SpeculativeDecoder::SpeculativeDecoder(std::shared_ptr<LlamaModel> target_model,
-                                       std::shared_ptr<LlamaModel> draft_model,
-                                       const SpeculativeConfig& config)
+SpeculativeDecoder::SpeculativeDecoder(
+    std::shared_ptr<graph::LlamaModel> target_model,
+    std::shared_ptr<graph::LlamaModel> draft_model,
+    const SpeculativeConfig& config)
     : target_model_(target_model),
       draft_model_(draft_model),
       config_(config),
       history_index_(0),
-      current_draft_length_(config.num_draft_tokens) {
+      current_draft_length_(std::clamp(config.num_draft_tokens, 1,
+                                       std::max(1, config.max_draft_tokens))) {
   // Initialize acceptance history with optimistic values
   acceptance_history_.resize(config.acceptance_window, 1.0f);
 }
 
 SpeculativeDecoder::~SpeculativeDecoder() = default;
 
+void SpeculativeDecoder::set_forward_hooks(DraftForwardFn draft_forward,
+                                           TargetForwardFn target_forward,
+                                           RollbackFn draft_rollback,
+                                           RollbackFn target_rollback) {
+  draft_forward_ = std::move(draft_forward);
+  target_forward_ = std::move(target_forward);
+  draft_rollback_ = std::move(draft_rollback);
+  target_rollback_ = std::move(target_rollback);
+}
+
 SpeculationResult SpeculativeDecoder::speculate(
     const std::vector<int>& context_tokens, int max_new_tokens) {
   SpeculationResult result;
-
-  if (!config_.enabled) {
-    // Speculation disabled, fall back to regular decoding
+  result.num_accepted = 0;
+
+  bool proposer_ready =
+      (config_.proposal_mode == ProposalMode::PROMPT_LOOKUP) ||
+      static_cast<bool>(draft_forward_);
+  if (!config_.enabled || !proposer_ready || !target_forward_ ||
+      context_tokens.empty()) {
+    // Speculation disabled or hooks not bound, fall back to regular
+    // decoding
     return result;
   }
 
-  // Determine how many tokens to propose
-  int num_to_propose = std::min(current_draft_length_, max_new_tokens);
+  // Determine how many tokens to propose. The verification step always
+  // yields one extra token (bonus or corrective), so leave room for it
+  int num_to_propose = std::min(current_draft_length_, max_new_tokens - 1);
   if (num_to_propose <= 0) {
     return result;
   }
 
   auto start_draft = std::chrono::steady_clock::now();
 
-  // Step 1: Draft model proposes tokens
-  result.draft_tokens = propose_tokens(context_tokens, num_to_propose);
+  // Step 1: Draft model proposes tokens; tree mode also records
+  // alternate candidates at uncertain positions
+  bool tree_mode = config_.enable_tree &&
+                   config_.proposal_mode == ProposalMode::DRAFT_MODEL;
+  std::vector<TreeAlternate> alternates;
+  if (tree_mode) {
+    result.draft_tokens =
+        propose_tokens_tree(context_tokens, num_to_propose, &alternates);
+  } else {
+    result.draft_tokens = propose_tokens(context_tokens, num_to_propose);
+  }
 
   auto end_draft = std::chrono::steady_clock::now();
   result.draft_time_ms =
@@ -59,29 +87,57 @@ SpeculationResult SpeculativeDecoder::speculate(
 
   auto start_verify = std::chrono::steady_clock::now();
 
-  // Step 2: Target model verifies draft tokens
-  auto [num_accepted, bonus_token] =
-      verify_tokens(context_tokens, result.draft_tokens);
+  // Step 2: Target model verifies draft tokens; the tree path accepts
+  // the longest valid branch instead of only the primary-chain prefix
+  bool took_alternate = false;
+  if (tree_mode && !alternates.empty()) {
+    auto [path, extra_token] =
+        verify_tokens_tree(context_tokens, result.draft_tokens, alternates);
+    result.num_accepted = static_cast<int>(path.size());
+    result.bonus_token = extra_token;
+    took_alternate =
+        !path.empty() &&
+        path.back() != result.draft_tokens[path.size() - 1];
+    result.accepted_tokens = std::move(path);
+  } else {
+    auto [num_accepted, bonus_token] =
+        verify_tokens(context_tokens, result.draft_tokens);
+    result.num_accepted = num_accepted;
+    result.bonus_token = bonus_token;
+    result.accepted_tokens.assign(result.draft_tokens.begin(),
+                                  result.draft_tokens.begin() + num_accepted);
+  }
 
   auto end_verify = std::chrono::steady_clock::now();
   result.target_time_ms =
       std::chrono::duration<double, std::milli>(end_verify - start_verify)
           .count();
 
-  result.num_accepted = num_accepted;
-  result.bonus_token = bonus_token;
-
-  // Extract accepted tokens
-  result.accepted_tokens.assign(result.draft_tokens.begin(),
-                                result.draft_tokens.begin() + num_accepted);
-
   // Update statistics
   stats_.total_attempts++;
   stats_.total_proposed += result.draft_tokens.size();
-  stats_.total_accepted += num_accepted;
-  if (bonus_token.has_value()) {
+  stats_.total_accepted += result.num_accepted;
+  if (result.bonus_token.has_value() &&
+      result.accepted_tokens == result.draft_tokens) {
+    // Only count true bonus tokens (full primary-chain acceptance);
+    // corrective samples after a mismatch and extra tokens following
+    // an accepted alternate are ordinary target-model tokens
     stats_.total_bonus++;
   }
+  if (tree_mode) {
+    // Alternates are recorded in position order, so distinct positions
+    // are counted at each transition
+    int last_position = -1;
+    for (const auto& alt : alternates) {
+      if (alt.position != last_position) {
+        stats_.total_branch_positions++;
+        last_position = alt.position;
+      }
+    }
+    if (took_alternate) {
+      stats_.total_alternate_accepts++;
+    }
+  }
 
   // Update acceptance tracking
   update_acceptance_tracking(result.acceptance_rate());
@@ -103,7 +159,7 @@ std::vector<int> SpeculativeDecoder::generate(
   while (static_cast<int>(generated_tokens.size()) < max_tokens) {
     int remaining = max_tokens - static_cast<int>(generated_tokens.size());
 
-    if (config_.enabled && !should_disable_speculation()) {
+    if (should_speculate()) {
       // Use speculative decoding
       SpeculationResult result = speculate(context, remaining);
 
@@ -127,14 +183,13 @@ std::vector<int> SpeculativeDecoder::generate(
           }
         }
       } else {
-        // Speculation failed, fall back to regular decoding
-        // This is a placeholder - in real implementation would call target
-        // model
+        // Speculation produced nothing; the regular decode path is
+        // owned by the Engine, so stop here
         break;
       }
     } else {
-      // Regular decoding (no speculation)
-      // Placeholder - would generate one token at a time
+      // Speculation disabled (or acceptance rate dropped below the
+      // minimum); the Engine handles regular decoding
       break;
     }
   }
@@ -147,7 +202,8 @@ void SpeculativeDecoder::reset() {
   acceptance_history_.clear();
   acceptance_history_.resize(config_.acceptance_window, 1.0f);
   history_index_ = 0;
-  current_draft_length_ = config_.num_draft_tokens;
+  current_draft_length_ = std::clamp(config_.num_draft_tokens, 1,
+                                     std::max(1, config_.max_draft_tokens));
 }
 
 SpeculativeStats SpeculativeDecoder::get_stats() const { return stats_; }
@@ -173,7 +229,8 @@ void SpeculativeDecoder::update_config(const SpeculativeConfig& config) {
     history_index_ = 0;
   }
 
-  current_draft_length_ = config.num_draft_tokens;
+  current_draft_length_ = std::clamp(config.num_draft_tokens, 1,
+                                     std::max(1, config.max_draft_tokens));
 }
 
 void SpeculativeDecoder::set_enabled(bool enabled) {
@@ -184,25 +241,28 @@ void SpeculativeDecoder::set_enabled(bool enabled) {
 
 std::vector<int> SpeculativeDecoder::propose_tokens(
     const std::vector<int>& context, int num_tokens) {
+  if (config_.proposal_mode == ProposalMode::PROMPT_LOOKUP) {
+    return propose_from_lookup(context, num_tokens);
+  }
+
   std::vector<int> draft_tokens;
   draft_tokens.reserve(num_tokens);
 
-  std::vector<int> current_context = context;
-
-  // Autoregressively generate draft tokens
+  // Autoregressively generate draft tokens. The first step feeds the
+  // sampled-but-unfed last context token; subsequent steps feed the
+  // previous draft token. The draft cache ends up holding
+  // context.size() - 1 + num_tokens fed tokens (the final draft token
+  // stays unfed, like a normal decode step)
+  int next_input = context.back();
   for (int i = 0; i < num_tokens; i++) {
-    // Forward pass through draft model
-    // Placeholder: In real implementation, would call draft_model_->forward()
-    // For now, just generate dummy tokens
-
-    // Get logits from draft model (placeholder)
-    std::vector<float> logits(32000, 0.0f);
+    std::vector<float> logits = draft_forward_({next_input});
+    if (logits.empty()) {
+      break;
+    }
 
-    // Sample token
     int token = sample_token(logits, config_.draft_temperature);
-
     draft_tokens.push_back(token);
-    current_context.push_back(token);
+    next_input = token;
   }
 
   return draft_tokens;
@@ -214,45 +274,256 @@ std::pair<int, std::optional<int>> SpeculativeDecoder::verify_tokens(
     return {0, std::nullopt};
   }
 
-  // Build verification context: original context + all draft tokens
-  std::vector<int> verify_context = context;
-  verify_context.insert(verify_context.end(), draft_tokens.begin(),
-                        draft_tokens.end());
+  int k = static_cast<int>(draft_tokens.size());
+  int base = static_cast<int>(context.size()) - 1;  // fed tokens before step
+
+  // ONE target forward over [last context token, d1 .. dk]: row i
+  // predicts the token following position base + i, so row 0 is the
+  // target's opinion on d1, row 1 on d2, etc.
+  std::vector<int> verify_input;
+  verify_input.reserve(k + 1);
+  verify_input.push_back(context.back());
+  verify_input.insert(verify_input.end(), draft_tokens.begin(),
+                      draft_tokens.end());
+
+  std::vector<std::vector<float>> rows = target_forward_(verify_input);
+  if (static_cast<int>(rows.size()) < k + 1) {
+    // Verification failed; reject everything and let the caller fall
+    // back to regular decoding
+    if (target_rollback_) {
+      target_rollback_(base);
+    }
+    return {0, std::nullopt};
+  }
 
-  // Forward pass through target model with all draft tokens
-  // Placeholder: In real implementation, would call target_model_->forward()
-  // This would return logits for each position
+  // Accept the longest prefix where the target agrees with the draft
+  int num_accepted = 0;
+  while (num_accepted < k &&
+         sample_token(rows[num_accepted], config_.target_temperature) ==
+             draft_tokens[num_accepted]) {
+    num_accepted++;
+  }
 
-  // For now, simulate verification with random acceptance
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_real_distribution<> dis(0.0, 1.0);
+  // The extra token is free either way: the bonus from the final row
+  // on full acceptance, or the corrective sample at the mismatch
+  std::optional<int> extra_token =
+      sample_token(rows[num_accepted], config_.target_temperature);
+
+  // Restore the decode invariant for the post-step context of
+  // context.size() + num_accepted + 1 tokens (accepted + extra, with
+  // the extra token left unfed): both caches must hold
+  // context.size() + num_accepted fed tokens
+  int target_fed = base + k + 1;  // verify_input was fed above
+  int needed_fed = base + 1 + num_accepted;
+  if (target_rollback_ && target_fed > needed_fed) {
+    target_rollback_(needed_fed);
+  }
 
-  int num_accepted = 0;
-  for (size_t i = 0; i < draft_tokens.size(); i++) {
-    // Get target model's prediction at this position
-    // Placeholder: would compare draft_tokens[i] with target prediction
-
-    // Simulate acceptance with decreasing probability
-    float accept_prob = 0.7f * std::pow(0.9f, static_cast<float>(i));
-    if (dis(gen) < accept_prob) {
-      num_accepted++;
-    } else {
-      // Mismatch found, stop accepting
+  // Prompt-lookup proposals involve no draft cache, so only the
+  // draft-model mode needs to re-sync it
+  if (config_.proposal_mode == ProposalMode::DRAFT_MODEL) {
+    int draft_fed = base + k;  // propose_tokens left the last draft unfed
+    if (draft_fed > needed_fed) {
+      if (draft_rollback_) {
+        draft_rollback_(needed_fed);
+      }
+    } else if (draft_fed < needed_fed) {
+      // Full acceptance: catch the draft cache up by feeding its own
+      // final token (logits discarded)
+      draft_forward_({draft_tokens.back()});
+    }
+  }
+
+  return {num_accepted, extra_token};
+}
+
+std::vector<int> SpeculativeDecoder::propose_tokens_tree(
+    const std::vector<int>& context, int num_tokens,
+    std::vector<TreeAlternate>* alternates) {
+  std::vector<int> draft_tokens;
+  draft_tokens.reserve(num_tokens);
+
+  // Alternate leaves share the verification budget with the primary
+  // chain
+  int budget = std::max(0, config_.tree_max_nodes - num_tokens);
+
+  int next_input = context.back();
+  for (int i = 0; i < num_tokens; i++) {
+    std::vector<float> logits = draft_forward_({next_input});
+    if (logits.empty()) {
       break;
     }
+
+    int token = sample_token(logits, config_.draft_temperature);
+    draft_tokens.push_back(token);
+
+    // Branch where the draft is uncertain: when its top-1 probability
+    // sags below the threshold, the runner-up candidates carry real
+    // mass and are worth a verification slot each
+    if (budget > 0) {
+      float max_logit = *std::max_element(logits.begin(), logits.end());
+      float sum = 0.0f;
+      for (float logit : logits) {
+        sum += std::exp(logit - max_logit);
+      }
+      float top1_prob = 1.0f / sum;  // exp(max - max) / sum
+
+      if (top1_prob < config_.tree_branch_threshold) {
+        // Pick the highest-logit candidates besides the sampled primary
+        std::vector<int> order(logits.size());
+        std::iota(order.begin(), order.end(), 0);
+        int want = std::min(config_.tree_branch_factor,
+                            static_cast<int>(logits.size()));
+        std::partial_sort(order.begin(), order.begin() + want, order.end(),
+                          [&logits](int a, int b) {
+                            return logits[a] > logits[b];
+                          });
+
+        int added = 0;
+        for (int c = 0; c < want && budget > 0 &&
+                        added < config_.tree_branch_factor - 1;
+             c++) {
+          if (order[c] == token) {
+            continue;  // The primary already occupies this position
+          }
+          alternates->push_back({i, order[c]});
+          budget--;
+          added++;
+        }
+      }
+    }
+
+    next_input = token;
+  }
+
+  return draft_tokens;
+}
+
+std::pair<std::vector<int>, std::optional<int>>
+SpeculativeDecoder::verify_tokens_tree(
+    const std::vector<int>& context, const std::vector<int>& draft_tokens,
+    const std::vector<TreeAlternate>& alternates) {
+  std::vector<int> path;
+  if (draft_tokens.empty()) {
+    return {path, std::nullopt};
+  }
+
+  int k = static_cast<int>(draft_tokens.size());
+  int base = static_cast<int>(context.size()) - 1;  // fed tokens before step
+
+  // ONE target forward over [last context token, d1 .. dk]: row m is
+  // the target's prediction for position m + 1 regardless of which
+  // candidate the draft placed there, so the same rows verify the
+  // primary chain and every alternate leaf
+  std::vector<int> verify_input;
+  verify_input.reserve(k + 1);
+  verify_input.push_back(context.back());
+  verify_input.insert(verify_input.end(), draft_tokens.begin(),
+                      draft_tokens.end());
+
+  std::vector<std::vector<float>> rows = target_forward_(verify_input);
+  if (static_cast<int>(rows.size()) < k + 1) {
+    if (target_rollback_) {
+      target_rollback_(base);
+    }
+    return {path, std::nullopt};
+  }
+
+  path.reserve(k);
+  for (int m = 0; m < k; m++) {
+    int target_token = sample_token(rows[m], config_.target_temperature);
+    if (target_token == draft_tokens[m]) {
+      path.push_back(target_token);
+      continue;
+    }
+
+    // The primary chain breaks here; check whether an alternate leaf
+    // at this position carries the target's choice
+    bool alternate_matched = false;
+    for (const auto& alt : alternates) {
+      if (alt.position == m && alt.token == target_token) {
+        alternate_matched = true;
+        break;
+      }
+    }
+
+    if (!alternate_matched) {
+      // Plain mismatch: corrective sample, caches rewind to the
+      // accepted prefix exactly as in linear verification
+      int needed_fed = base + 1 + m;
+      if (target_rollback_) {
+        target_rollback_(needed_fed);
+      }
+      if (draft_rollback_ && base + k > needed_fed) {
+        draft_rollback_(needed_fed);
+      }
+      return {path, target_token};
+    }
+
+    // Alternate accepted: the path leaves the primary chain, so the KV
+    // written for the rejected suffix is rewound and the alternate is
+    // fed to rebuild linear KV. Its returned row supplies the extra
+    // token, so the step still ends with a free corrective/bonus sample
+    path.push_back(target_token);
+
+    int prefix_fed = base + 1 + m;  // root + accepted primaries
+    if (target_rollback_) {
+      target_rollback_(prefix_fed);
+    }
+    std::vector<std::vector<float>> alt_rows = target_forward_({target_token});
+    std::optional<int> extra_token;
+    if (!alt_rows.empty()) {
+      extra_token =
+          sample_token(alt_rows[0], config_.target_temperature);
+    }
+
+    // Re-sync the draft cache onto the accepted branch so the next
+    // step's proposals continue from it
+    if (draft_rollback_ && base + k > prefix_fed) {
+      draft_rollback_(prefix_fed);
+    }
+    if (draft_forward_) {
+      draft_forward_({target_token});
+    }
+
+    return {path, extra_token};
   }
 
-  // If all tokens accepted, try to generate bonus token
-  std::optional<int> bonus_token;
-  if (num_accepted == static_cast<int>(draft_tokens.size())) {
-    // Sample bonus token from target model's logits at the end
-    std::vector<float> logits(32000, 0.0f);
-    int bonus = sample_token(logits, config_.target_temperature);
-    bonus_token = bonus;
+  // Full primary-chain acceptance: bonus from the final row; the
+  // target cache already holds exactly the needed fed tokens and the
+  // draft catches up by feeding its own final token
+  std::optional<int> extra_token =
+      sample_token(rows[k], config_.target_temperature);
+  if (draft_forward_) {
+    draft_forward_({draft_tokens.back()});
   }
 
-  return {num_accepted, bonus_token};
+  return {path, extra_token};
+}
+
+std::vector<int> SpeculativeDecoder::propose_from_lookup(
+    const std::vector<int>& context, int num_tokens) {
+  int context_len = static_cast<int>(context.size());
+  int max_ngram = std::min(config_.lookup_max_ngram, context_len - 1);
+
+  // Back off from the longest suffix n-gram to the shortest, and for
+  // each length prefer the most recent earlier occurrence (locality:
+  // recent spans predict the continuation best)
+  for (int n = max_ngram; n >= config_.lookup_min_ngram; n--) {
+    const int* suffix = context.data() + context_len - n;
+
+    for (int i = context_len - n - 1; i >= 0; i--) {
+      if (std::equal(suffix, suffix + n, context.data() + i)) {
+        // Propose the span that followed this earlier occurrence
+        int copy_begin = i + n;
+        int copy_len = std::min(num_tokens, context_len - copy_begin);
+        return std::vector<int>(context.begin() + copy_begin,
+                                context.begin() + copy_begin + copy_len);
+      }
+    }
+  }
+
+  return {};  // No match; caller falls back to regular decoding
 }
 
 int SpeculativeDecoder::sample_token(const std::vector<float>& logits,
@@ -261,6 +532,13 @@ int SpeculativeDecoder::sample_token(const std::vector<float>& logits,
     return 0;
   }
 
+  // Greedy when temperature is zero (also how verification compares
+  // draft tokens against target predictions deterministically)
+  if (temperature <= 0.0f) {
+    return static_cast<int>(
+        std::max_element(logits.begin(), logits.end()) - logits.begin());
+  }
+
   // Apply temperature
   std::vector<float> scaled_logits = logits;
   if (temperature != 1.0f && temperature > 0.0f) {
@@ -311,12 +589,22 @@ void SpeculativeDecoder::update_acceptance_tracking(float rate) {
 void SpeculativeDecoder::adjust_speculation_length() {
   float current_rate = get_current_acceptance_rate();
 
-  // Increase draft length if acceptance rate is high
-  if (current_rate > 0.8f && current_draft_length_ < config_.num_draft_tokens) {
+  // Diverging draft: collapse to a single proposal so each step wastes
+  // at most one verification position while the window recovers
+  if (current_rate < config_.length_collapse_threshold) {
+    current_draft_length_ = 1;
+    return;
+  }
+
+  // High acceptance: proposals are nearly free throughput, grow k one
+  // step at a time up to the configured ceiling
+  if (current_rate > config_.length_raise_threshold &&
+      current_draft_length_ < config_.max_draft_tokens) {
     current_draft_length_++;
   }
-  // Decrease draft length if acceptance rate is low
-  else if (current_rate < 0.5f && current_draft_length_ > 1) {
+  // Mediocre acceptance: back off gradually
+  else if (current_rate < config_.length_lower_threshold &&
+           current_draft_length_ > 1) {
     current_draft_length_--;
   }
 }
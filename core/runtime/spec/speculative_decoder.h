@@ -11,16 +11,34 @@
 namespace mlxr {
 
 // Forward declarations
+namespace graph {
 class LlamaModel;
-class Tokenizer;
+}
 
 namespace spec {
 
+// How speculation proposals are produced
+enum class ProposalMode {
+  DRAFT_MODEL,    ///< Smaller draft model proposes tokens (needs hooks)
+  PROMPT_LOOKUP,  ///< N-gram matching against earlier context; zero-cost
+                  ///< self-speculation, no draft model required
+};
+
 // Configuration for speculative decoding
 struct SpeculativeConfig {
   // Number of tokens to propose per step
   int num_draft_tokens = 4;
 
+  // Proposal source (draft model or prompt-lookup)
+  ProposalMode proposal_mode = ProposalMode::DRAFT_MODEL;
+
+  // Prompt-lookup: longest suffix n-gram matched against earlier
+  // context (tried first, backing off to shorter n-grams)
+  int lookup_max_ngram = 3;
+
+  // Prompt-lookup: shortest suffix n-gram before giving up on a step
+  int lookup_min_ngram = 1;
+
   // Minimum acceptance rate before disabling speculation
   float min_acceptance_rate = 0.5f;
 
@@ -30,12 +48,44 @@ struct SpeculativeConfig {
   // Enable adaptive speculation length
   bool adaptive_length = true;
 
+  // Ceiling for the adaptive controller; k starts at num_draft_tokens
+  // and may grow up to this when acceptance stays high
+  int max_draft_tokens = 8;
+
+  // Adaptive-length thresholds against the rolling acceptance rate:
+  // above raise → grow k by one, below lower → shrink k by one, below
+  // collapse → drop k straight to 1 (a diverging draft then wastes at
+  // most one verification position per step)
+  float length_raise_threshold = 0.8f;
+  float length_lower_threshold = 0.6f;
+  float length_collapse_threshold = 0.3f;
+
   // Temperature for draft model sampling
   float draft_temperature = 1.0f;
 
   // Temperature for target model verification
   float target_temperature = 1.0f;
 
+  // Tree speculation: at positions where the draft distribution is
+  // uncertain, propose the runner-up candidates as alternate branches
+  // and verify every branch in the same step, accepting the longest
+  // valid path. Linear speculation's expected gain collapses exactly
+  // where the draft is unsure; branching there keeps acceptance high.
+  // Draft-model mode only (prompt-lookup has no distribution to branch
+  // on)
+  bool enable_tree = false;
+
+  // Candidates per branch position: the primary token plus up to
+  // tree_branch_factor - 1 alternates
+  int tree_branch_factor = 2;
+
+  // Draft top-1 probability below which a position branches
+  float tree_branch_threshold = 0.5f;
+
+  // Verification budget: total tree nodes per step (primary chain plus
+  // alternate leaves)
+  int tree_max_nodes = 12;
+
   // Enable/disable speculation
   bool enabled = true;
 };
@@ -51,7 +101,10 @@ struct SpeculationResult {
   // Number of tokens accepted
   int num_accepted;
 
-  // Final token chosen (bonus token from verification)
+  // Extra token from verification: the bonus token when all drafts
+  // were accepted, or the corrective sample from the target's logits
+  // at the first mismatch. Either way it is a committed token, so
+  // every successful speculation step yields at least one token
   std::optional<int> bonus_token;
 
   // Time spent in draft model (ms)
@@ -89,6 +142,14 @@ struct SpeculativeStats {
   // Total bonus tokens
   uint64_t total_bonus = 0;
 
+  // Tree speculation: positions that branched (alternate leaves added)
+  uint64_t total_branch_positions = 0;
+
+  // Tree speculation: steps where the accepted path left the primary
+  // chain through an alternate (tokens linear verification would have
+  // rejected)
+  uint64_t total_alternate_accepts = 0;
+
   // Overall acceptance rate
   float overall_acceptance_rate() const {
     if (total_proposed == 0) return 0.0f;
@@ -125,21 +186,65 @@ struct SpeculativeStats {
  */
 class SpeculativeDecoder {
  public:
+  /**
+   * Forward hook: feed tokens as a continuation of the model's cache
+   * and return the last position's logits [vocab_size]
+   *
+   * The owner (Engine) binds these to a specific sequence's caches;
+   * the decoder only sees token IDs and logits, so it works with both
+   * the simple KVCache and the paged cache.
+   */
+  using DraftForwardFn =
+      std::function<std::vector<float>(const std::vector<int>& tokens)>;
+
+  /**
+   * Verify hook: feed tokens as a continuation of the target model's
+   * cache and return one logits row per input position
+   */
+  using TargetForwardFn = std::function<std::vector<std::vector<float>>(
+      const std::vector<int>& tokens)>;
+
+  /**
+   * Rollback hook: rewind a model's cache to `num_tokens` fed tokens
+   * (discarding KV entries written for rejected draft positions)
+   */
+  using RollbackFn = std::function<void(int num_tokens)>;
+
   /**
    * Create speculative decoder
    * @param target_model Main model for generation
    * @param draft_model Smaller/faster draft model
    * @param config Speculation configuration
    */
-  SpeculativeDecoder(std::shared_ptr<LlamaModel> target_model,
-                     std::shared_ptr<LlamaModel> draft_model,
+  SpeculativeDecoder(std::shared_ptr<graph::LlamaModel> target_model,
+                     std::shared_ptr<graph::LlamaModel> draft_model,
                      const SpeculativeConfig& config);
 
   ~SpeculativeDecoder();
 
+  /**
+   * Bind the forward/rollback hooks for one sequence
+   *
+   * Must be called before speculate(). Both caches are expected to
+   * hold exactly context.size() - 1 fed tokens when speculate() runs
+   * (the standard decode invariant: the last context token has been
+   * sampled but not yet fed). speculate() restores that invariant for
+   * the post-step context before returning.
+   *
+   * @param draft_forward Continuation forward through the draft model
+   * @param target_forward Continuation forward through the target model
+   * @param draft_rollback Rewind the draft cache to n fed tokens
+   * @param target_rollback Rewind the target cache to n fed tokens
+   */
+  void set_forward_hooks(DraftForwardFn draft_forward,
+                         TargetForwardFn target_forward,
+                         RollbackFn draft_rollback,
+                         RollbackFn target_rollback);
+
   /**
    * Perform one speculation step
-   * @param context_tokens Current context (prompt + generated tokens)
+   * @param context_tokens Current context (prompt + generated tokens);
+   *        the last entry is the sampled-but-unfed token
    * @param max_new_tokens Maximum tokens to generate
    * @return Speculation result with accepted tokens
    */
@@ -187,10 +292,36 @@ class SpeculativeDecoder {
    */
   bool is_enabled() const { return config_.enabled; }
 
+  /**
+   * Current speculation length k chosen by the adaptive controller
+   * (equals num_draft_tokens when adaptive_length is off)
+   */
+  int current_draft_length() const { return current_draft_length_; }
+
+  /**
+   * Whether the next step should speculate (enabled, proposer ready,
+   * verify hook bound, and rolling acceptance rate above the
+   * configured minimum). Prompt-lookup mode needs no draft hooks
+   */
+  bool should_speculate() const {
+    bool proposer_ready =
+        (config_.proposal_mode == ProposalMode::PROMPT_LOOKUP) ||
+        static_cast<bool>(draft_forward_);
+    return config_.enabled && proposer_ready &&
+           static_cast<bool>(target_forward_) &&
+           !should_disable_speculation();
+  }
+
  private:
   // Models
-  std::shared_ptr<LlamaModel> target_model_;
-  std::shared_ptr<LlamaModel> draft_model_;
+  std::shared_ptr<graph::LlamaModel> target_model_;
+  std::shared_ptr<graph::LlamaModel> draft_model_;
+
+  // Per-sequence forward/rollback hooks (bound by the Engine)
+  DraftForwardFn draft_forward_;
+  TargetForwardFn target_forward_;
+  RollbackFn draft_rollback_;
+  RollbackFn target_rollback_;
 
   // Configuration
   SpeculativeConfig config_;
@@ -214,6 +345,18 @@ class SpeculativeDecoder {
   std::vector<int> propose_tokens(const std::vector<int>& context,
                                   int num_tokens);
 
+  /**
+   * Propose tokens by prompt-lookup: match the context's suffix n-gram
+   * against earlier positions in the same sequence and copy the span
+   * that followed the most recent match. Effective on summarization
+   * and code-edit workloads where the output repeats prompt spans
+   * @param context Current context
+   * @param num_tokens Maximum tokens to propose
+   * @return Proposed continuation (empty if no n-gram match)
+   */
+  std::vector<int> propose_from_lookup(const std::vector<int>& context,
+                                       int num_tokens);
+
   /**
    * Verify draft tokens with target model
    * @param context Current context
@@ -223,6 +366,48 @@ class SpeculativeDecoder {
   std::pair<int, std::optional<int>> verify_tokens(
       const std::vector<int>& context, const std::vector<int>& draft_tokens);
 
+  /**
+   * One alternate candidate in the proposal tree: a leaf that replaces
+   * draft position `position` (0-based index into the primary chain)
+   */
+  struct TreeAlternate {
+    int position;
+    int token;
+  };
+
+  /**
+   * Propose a primary chain plus alternate leaves at uncertain positions
+   * @param context Current context
+   * @param num_tokens Primary chain length
+   * @param alternates Out: alternate candidates recorded where the
+   *        draft's top-1 probability fell below tree_branch_threshold,
+   *        capped by tree_branch_factor and tree_max_nodes
+   * @return Primary chain tokens (same contract as propose_tokens)
+   */
+  std::vector<int> propose_tokens_tree(const std::vector<int>& context,
+                                       int num_tokens,
+                                       std::vector<TreeAlternate>* alternates);
+
+  /**
+   * Verify a proposal tree and accept the longest valid path
+   * @param context Current context
+   * @param draft_tokens Primary chain
+   * @param alternates Alternate leaves keyed by primary position
+   * @return Accepted path tokens (may leave the primary chain through
+   *         an alternate at its final step) and the extra token
+   *
+   * One target forward covers the whole tree: row m predicts position
+   * m + 1 regardless of which candidate the draft placed there, so
+   * tree attention over leaf alternates degenerates to the primary
+   * chain's causal mask and the same rows verify every branch. When
+   * the target's choice matches an alternate instead of the primary,
+   * the rejected suffix KV is rewound and the alternate is fed to
+   * rebuild linear KV (its returned row supplies the extra token)
+   */
+  std::pair<std::vector<int>, std::optional<int>> verify_tokens_tree(
+      const std::vector<int>& context, const std::vector<int>& draft_tokens,
+      const std::vector<TreeAlternate>& alternates);
+
   /**
    * Sample token from logits with temperature
    * @param logits Output logits from model
@@ -237,7 +422,9 @@ class SpeculativeDecoder {
   void update_acceptance_tracking(float rate);
 
   /**
-   * Adjust speculation length based on acceptance rate
+   * Feedback controller for the speculation length: grows k one step
+   * at a time while the rolling acceptance rate is high, backs off
+   * when it sags, and collapses to k=1 when the draft diverges
    */
   void adjust_speculation_length();
 
@@ -0,0 +1,125 @@
+// Copyright © 2025 MLXR Development
+// Incremental Aho-Corasick stop-sequence matching
+
+#include "stop_matcher.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace mlxr {
+namespace runtime {
+
+StopSequenceMatcher::StopSequenceMatcher(
+    const std::vector<std::string>& patterns) {
+  nodes_.emplace_back();  // Root
+
+  // Build the trie
+  for (const auto& pattern : patterns) {
+    if (pattern.empty()) {
+      continue;
+    }
+    int node = 0;
+    for (unsigned char byte : pattern) {
+      auto it = nodes_[node].next.find(byte);
+      if (it == nodes_[node].next.end()) {
+        nodes_.emplace_back();
+        nodes_.back().depth = nodes_[node].depth + 1;
+        int created = static_cast<int>(nodes_.size()) - 1;
+        nodes_[node].next[byte] = created;
+        node = created;
+      } else {
+        node = it->second;
+      }
+    }
+    nodes_[node].match_len =
+        std::max(nodes_[node].match_len, static_cast<int>(pattern.size()));
+  }
+
+  // BFS failure links; match_len propagates through them so a pattern
+  // that is a suffix of another state's text is still detected
+  std::queue<int> frontier;
+  for (const auto& entry : nodes_[0].next) {
+    nodes_[entry.second].fail = 0;
+    frontier.push(entry.second);
+  }
+  while (!frontier.empty()) {
+    int node = frontier.front();
+    frontier.pop();
+    for (const auto& entry : nodes_[node].next) {
+      unsigned char byte = entry.first;
+      int child = entry.second;
+
+      int fallback = nodes_[node].fail;
+      while (fallback != 0 &&
+             nodes_[fallback].next.find(byte) == nodes_[fallback].next.end()) {
+        fallback = nodes_[fallback].fail;
+      }
+      auto it = nodes_[fallback].next.find(byte);
+      nodes_[child].fail =
+          (it != nodes_[fallback].next.end() && it->second != child)
+              ? it->second
+              : 0;
+      nodes_[child].match_len = std::max(
+          nodes_[child].match_len, nodes_[nodes_[child].fail].match_len);
+      frontier.push(child);
+    }
+  }
+}
+
+bool StopSequenceMatcher::feed(const std::string& bytes,
+                               std::string* safe_out) {
+  if (matched_) {
+    return true;
+  }
+  if (empty()) {
+    safe_out->append(bytes);
+    return false;
+  }
+
+  for (unsigned char byte : bytes) {
+    // Advance the automaton, following failure links on mismatch
+    while (state_ != 0 &&
+           nodes_[state_].next.find(byte) == nodes_[state_].next.end()) {
+      state_ = nodes_[state_].fail;
+    }
+    auto it = nodes_[state_].next.find(byte);
+    state_ = it != nodes_[state_].next.end() ? it->second : 0;
+
+    pending_.push_back(static_cast<char>(byte));
+
+    if (nodes_[state_].match_len > 0) {
+      // Matched: release everything before the stop sequence, drop the
+      // sequence itself and anything held after it
+      size_t match_len = static_cast<size_t>(nodes_[state_].match_len);
+      safe_out->append(pending_, 0, pending_.size() - match_len);
+      pending_.clear();
+      matched_ = true;
+      return true;
+    }
+
+    // Only the current partial-match suffix (depth bytes) can still
+    // become a stop sequence; everything before it is safe to release
+    size_t hold = static_cast<size_t>(nodes_[state_].depth);
+    if (pending_.size() > hold) {
+      safe_out->append(pending_, 0, pending_.size() - hold);
+      pending_.erase(0, pending_.size() - hold);
+    }
+  }
+  return false;
+}
+
+std::string StopSequenceMatcher::flush() {
+  std::string remaining;
+  remaining.swap(pending_);
+  state_ = 0;
+  return remaining;
+}
+
+void StopSequenceMatcher::reset() {
+  state_ = 0;
+  pending_.clear();
+  matched_ = false;
+}
+
+}  // namespace runtime
+}  // namespace mlxr
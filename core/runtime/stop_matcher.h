@@ -0,0 +1,105 @@
+// Copyright © 2025 MLXR Development
+// Incremental Aho-Corasick stop-sequence matching
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mlxr {
+namespace runtime {
+
+/**
+ * @brief Incremental multi-pattern stop-sequence matcher
+ *
+ * Compiles a request's stop strings into an Aho-Corasick automaton once
+ * at request setup, then consumes only the NEW bytes from the streaming
+ * detokenizer. Matching is O(new bytes) regardless of how many stop
+ * sequences there are or how long the output grows, replacing the
+ * re-decode-and-rescan approach that cost O(output^2) per stream.
+ *
+ * Bytes that could still be the prefix of a stop sequence are held back
+ * and released once the automaton proves they cannot complete a match,
+ * so a stop string split across token boundaries is caught and the
+ * matched text is never leaked to the client (OpenAI semantics: the
+ * stop sequence itself is excluded from the output).
+ *
+ * Usage:
+ * @code
+ * StopSequenceMatcher matcher(params.stop_sequences);
+ * std::string safe;
+ * if (matcher.feed(stream.push(token_id), &safe)) {
+ *   emit(safe);      // Text up to (excluding) the stop sequence
+ *   finish("stop");
+ * } else {
+ *   emit(safe);      // May be empty while a partial match is pending
+ * }
+ * // At end of generation without a match:
+ * emit(matcher.flush());
+ * @endcode
+ */
+class StopSequenceMatcher {
+ public:
+  /**
+   * @brief Compile patterns into the matching automaton
+   * @param patterns Stop strings (empty strings are ignored)
+   */
+  explicit StopSequenceMatcher(const std::vector<std::string>& patterns);
+
+  /**
+   * @brief Consume new output bytes
+   * @param bytes New UTF-8 bytes from the detokenizer
+   * @param safe_out Releasable text is APPENDED here: bytes that can no
+   *        longer participate in a match, or on a match everything up
+   *        to (excluding) the matched stop sequence
+   * @return True when a stop sequence completed; further feeds are
+   *         no-ops once matched
+   */
+  bool feed(const std::string& bytes, std::string* safe_out);
+
+  /**
+   * @brief Release held-back bytes at end of generation without a match
+   * @return Buffered text that was still a potential match prefix
+   */
+  std::string flush();
+
+  /**
+   * @brief Check whether a stop sequence has been matched
+   */
+  bool matched() const { return matched_; }
+
+  /**
+   * @brief Check whether the matcher has any patterns
+   *
+   * With no patterns every byte is immediately safe; callers can skip
+   * feed() entirely.
+   */
+  bool empty() const { return nodes_.size() <= 1; }
+
+  /**
+   * @brief Reset matcher state for reuse (automaton is kept)
+   */
+  void reset();
+
+ private:
+  // Trie node with failure link. Byte-keyed sparse transitions: stop
+  // sequences are short and few, so a dense 256-way table per node
+  // would waste cache for nothing
+  struct Node {
+    std::unordered_map<unsigned char, int> next;
+    int fail = 0;
+    int depth = 0;
+    // Length of the longest pattern ending at this state (through
+    // failure links), 0 if none
+    int match_len = 0;
+  };
+
+  std::vector<Node> nodes_;
+  int state_ = 0;
+  std::string pending_;  // Held-back bytes forming a potential prefix
+  bool matched_ = false;
+};
+
+}  // namespace runtime
+}  // namespace mlxr
@@ -0,0 +1,395 @@
+/**
+ * @file bpe_tokenizer.cpp
+ * @brief Byte-level BPE tokenizer implementation
+ */
+
+#include "bpe_tokenizer.h"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+
+namespace mlxr {
+namespace runtime {
+
+namespace {
+
+// GPT-2 byte-to-unicode map: printable latin-1 bytes keep their code
+// point, the rest are remapped to 256+n so every token string is valid
+// UTF-8. Code points stay below 324, so the reverse map is a flat array
+std::array<int, 256> byte_to_codepoint() {
+  std::array<int, 256> cps{};
+  int n = 0;
+  for (int b = 0; b < 256; ++b) {
+    bool printable = (b >= 33 && b <= 126) || (b >= 161 && b <= 172) ||
+                     (b >= 174 && b <= 255);
+    cps[b] = printable ? b : 256 + n++;
+  }
+  return cps;
+}
+
+// UTF-8 encode one code point (all mapped code points fit in 2 bytes)
+std::string codepoint_to_utf8(int cp) {
+  std::string out;
+  if (cp < 0x80) {
+    out += static_cast<char>(cp);
+  } else {
+    out += static_cast<char>(0xC0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+  return out;
+}
+
+// Decode the code point starting at i; returns its byte length. Invalid
+// or >2-byte sequences come back as cp=-1 and are passed through raw
+size_t utf8_next(const std::string& s, size_t i, int* cp) {
+  unsigned char b = static_cast<unsigned char>(s[i]);
+  if (b < 0x80) {
+    *cp = b;
+    return 1;
+  }
+  if ((b & 0xE0) == 0xC0 && i + 1 < s.size()) {
+    *cp = ((b & 0x1F) << 6) | (static_cast<unsigned char>(s[i + 1]) & 0x3F);
+    return 2;
+  }
+  *cp = -1;
+  return 1;
+}
+
+uint64_t pair_key(int left, int right) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(left)) << 32) |
+         static_cast<uint32_t>(right);
+}
+
+bool is_ws(unsigned char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' ||
+         c == '\v';
+}
+
+bool is_digit(unsigned char c) { return c >= '0' && c <= '9'; }
+
+// Letter classification for pre-splitting: ASCII alpha plus any
+// non-ASCII byte. The reference pattern uses \p{L}; treating multi-byte
+// UTF-8 as letters matches it for the common scripts without Unicode
+// category tables, and a misclassified symbol only shifts a piece
+// boundary, never corrupts bytes
+bool is_letter(unsigned char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+}
+
+}  // namespace
+
+std::vector<std::string> BPETokenizer::byte_level_alphabet() {
+  auto cps = byte_to_codepoint();
+  std::vector<std::string> alphabet(256);
+  for (int b = 0; b < 256; ++b) {
+    alphabet[b] = codepoint_to_utf8(cps[b]);
+  }
+  return alphabet;
+}
+
+BPETokenizer::BPETokenizer(std::vector<std::string> vocab,
+                           const std::vector<std::string>& merges, int bos_id,
+                           int eos_id, const std::vector<int>& special_ids)
+    : vocab_(std::move(vocab)), bos_id_(bos_id), eos_id_(eos_id) {
+  if (vocab_.empty()) {
+    throw std::runtime_error("BPETokenizer: empty vocabulary");
+  }
+
+  token_ids_.reserve(vocab_.size());
+  for (size_t i = 0; i < vocab_.size(); ++i) {
+    token_ids_.emplace(vocab_[i], static_cast<int>(i));
+  }
+
+  // Byte alphabet lookups and the reverse code point -> byte map
+  auto cps = byte_to_codepoint();
+  unicode_to_byte_.fill(-1);
+  for (int b = 0; b < 256; ++b) {
+    unicode_to_byte_[cps[b]] = b;
+    auto it = token_ids_.find(codepoint_to_utf8(cps[b]));
+    byte_token_ids_[b] = (it != token_ids_.end()) ? it->second : -1;
+  }
+
+  // Compile merges: rank by list position, keyed by the token-ID pair.
+  // Rules whose halves or result are missing from the vocabulary are
+  // dropped (they could never fire)
+  merge_rules_.reserve(merges.size());
+  for (size_t rank = 0; rank < merges.size(); ++rank) {
+    size_t space = merges[rank].find(' ');
+    if (space == std::string::npos) {
+      continue;
+    }
+    std::string left = merges[rank].substr(0, space);
+    std::string right = merges[rank].substr(space + 1);
+    auto left_it = token_ids_.find(left);
+    auto right_it = token_ids_.find(right);
+    auto merged_it = token_ids_.find(left + right);
+    if (left_it == token_ids_.end() || right_it == token_ids_.end() ||
+        merged_it == token_ids_.end()) {
+      continue;
+    }
+    merge_rules_.emplace(pair_key(left_it->second, right_it->second),
+                         MergeRule{static_cast<int>(rank), merged_it->second});
+  }
+
+  // Special tokens are matched over raw input bytes, so map their
+  // strings out of the byte-to-unicode space first. Longest-first order
+  // makes overlapping specials resolve to the longer match
+  for (int id : special_ids) {
+    if (id < 0 || id >= static_cast<int>(vocab_.size())) {
+      continue;
+    }
+    specials_.push_back({decode({id}), id});
+  }
+  std::sort(specials_.begin(), specials_.end(),
+            [](const SpecialToken& a, const SpecialToken& b) {
+              return a.text.size() > b.text.size();
+            });
+}
+
+std::vector<std::string> BPETokenizer::pre_split(const std::string& text) {
+  std::vector<std::string> pieces;
+  const size_t n = text.size();
+  size_t i = 0;
+
+  while (i < n) {
+    // Contractions ('s 't 're 've 'm 'll 'd) split off as their own
+    // piece, matching the reference pattern
+    if (text[i] == '\'' && i + 1 < n) {
+      char c1 = text[i + 1];
+      char c2 = (i + 2 < n) ? text[i + 2] : '\0';
+      size_t len = 0;
+      if ((c1 == 'r' && c2 == 'e') || (c1 == 'v' && c2 == 'e') ||
+          (c1 == 'l' && c2 == 'l')) {
+        len = 3;
+      } else if (c1 == 's' || c1 == 't' || c1 == 'm' || c1 == 'd') {
+        len = 2;
+      }
+      if (len > 0) {
+        pieces.push_back(text.substr(i, len));
+        i += len;
+        continue;
+      }
+    }
+
+    size_t start = i;
+
+    // Whitespace runs: a run followed by a word donates its trailing
+    // plain space to that word (" ?\p{L}+" behavior); anything else
+    // stays one piece
+    if (is_ws(static_cast<unsigned char>(text[i]))) {
+      size_t j = i;
+      while (j < n && is_ws(static_cast<unsigned char>(text[j]))) {
+        ++j;
+      }
+      bool donate = (j < n && text[j - 1] == ' ');
+      size_t run = j - i - (donate ? 1 : 0);
+      if (run > 0) {
+        pieces.push_back(text.substr(i, run));
+      }
+      i = j - (donate ? 1 : 0);
+      if (!donate) {
+        continue;
+      }
+      start = i;  // The kept space prefixes the word below
+    }
+
+    // Optionally space-prefixed run of letters, digits or punctuation
+    size_t k = i;
+    if (text[k] == ' ') {
+      ++k;
+    }
+    if (k >= n) {
+      pieces.push_back(text.substr(start));
+      break;
+    }
+    unsigned char c = static_cast<unsigned char>(text[k]);
+    if (is_letter(c)) {
+      while (k < n && is_letter(static_cast<unsigned char>(text[k]))) {
+        ++k;
+      }
+    } else if (is_digit(c)) {
+      while (k < n && is_digit(static_cast<unsigned char>(text[k]))) {
+        ++k;
+      }
+    } else {
+      while (k < n) {
+        unsigned char p = static_cast<unsigned char>(text[k]);
+        if (is_ws(p) || is_letter(p) || is_digit(p)) {
+          break;
+        }
+        ++k;
+      }
+    }
+    pieces.push_back(text.substr(start, k - start));
+    i = k;
+  }
+
+  return pieces;
+}
+
+void BPETokenizer::encode_piece(const std::string& piece,
+                                std::vector<int>* out) const {
+  // Seed one symbol per byte as a doubly-linked list
+  struct Symbol {
+    int id;
+    int prev;
+    int next;
+  };
+  std::vector<Symbol> syms;
+  syms.reserve(piece.size());
+  for (unsigned char c : piece) {
+    int id = byte_token_ids_[c];
+    if (id < 0) {
+      continue;  // Byte-incomplete vocabulary: drop unrepresentable byte
+    }
+    int pos = static_cast<int>(syms.size());
+    syms.push_back({id, pos - 1, pos + 1});
+  }
+  if (syms.empty()) {
+    return;
+  }
+  syms.back().next = -1;
+
+  // Min-heap of merge candidates with lazy invalidation: stale entries
+  // (either side already merged away) are detected and skipped on pop,
+  // so each applied merge costs O(log n)
+  struct Candidate {
+    int rank;
+    int pos;
+    int left_id;
+    int right_id;
+    bool operator>(const Candidate& other) const {
+      return rank != other.rank ? rank > other.rank : pos > other.pos;
+    }
+  };
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> heap;
+
+  auto push_candidate = [&](int pos) {
+    int next = syms[pos].next;
+    if (next < 0) {
+      return;
+    }
+    auto it = merge_rules_.find(pair_key(syms[pos].id, syms[next].id));
+    if (it != merge_rules_.end()) {
+      heap.push({it->second.rank, pos, syms[pos].id, syms[next].id});
+    }
+  };
+
+  for (int pos = 0; pos + 1 < static_cast<int>(syms.size()); ++pos) {
+    push_candidate(pos);
+  }
+
+  while (!heap.empty()) {
+    Candidate cand = heap.top();
+    heap.pop();
+
+    int next = syms[cand.pos].next;
+    if (next < 0 || syms[cand.pos].id != cand.left_id ||
+        syms[next].id != cand.right_id) {
+      continue;  // Stale candidate
+    }
+
+    auto it = merge_rules_.find(pair_key(cand.left_id, cand.right_id));
+    syms[cand.pos].id = it->second.merged_id;
+    syms[next].id = -1;  // Absorbed
+    syms[cand.pos].next = syms[next].next;
+    if (syms[next].next >= 0) {
+      syms[syms[next].next].prev = cand.pos;
+    }
+
+    push_candidate(cand.pos);
+    if (syms[cand.pos].prev >= 0) {
+      push_candidate(syms[cand.pos].prev);
+    }
+  }
+
+  for (int pos = 0; pos >= 0; pos = syms[pos].next) {
+    out->push_back(syms[pos].id);
+  }
+}
+
+std::vector<int> BPETokenizer::encode(const std::string& text) {
+  std::vector<int> ids;
+
+  auto encode_segment = [&](const std::string& segment) {
+    for (const auto& piece : pre_split(segment)) {
+      encode_piece(piece, &ids);
+    }
+  };
+
+  size_t pos = 0;
+  while (pos < text.size()) {
+    // Earliest special-token occurrence; specials_ is longest-first so
+    // the strict < keeps the longer match on position ties
+    size_t best_at = std::string::npos;
+    const SpecialToken* best = nullptr;
+    for (const auto& sp : specials_) {
+      size_t at = text.find(sp.text, pos);
+      if (at != std::string::npos && at < best_at) {
+        best_at = at;
+        best = &sp;
+      }
+    }
+    if (!best) {
+      break;
+    }
+    if (best_at > pos) {
+      encode_segment(text.substr(pos, best_at - pos));
+    }
+    ids.push_back(best->id);
+    pos = best_at + best->text.size();
+  }
+  if (pos < text.size()) {
+    encode_segment(pos == 0 ? text : text.substr(pos));
+  }
+
+  return ids;
+}
+
+std::string BPETokenizer::decode(const std::vector<int>& ids) {
+  std::string text;
+  for (int id : ids) {
+    if (id < 0 || id >= static_cast<int>(vocab_.size())) {
+      continue;
+    }
+    const std::string& token = vocab_[id];
+    size_t i = 0;
+    while (i < token.size()) {
+      int cp = -1;
+      size_t len = utf8_next(token, i, &cp);
+      if (cp >= 0 && cp < static_cast<int>(unicode_to_byte_.size()) &&
+          unicode_to_byte_[cp] >= 0) {
+        text += static_cast<char>(unicode_to_byte_[cp]);
+      } else {
+        // Outside the byte alphabet (special tokens): pass through raw
+        text.append(token, i, len);
+      }
+      i += len;
+    }
+  }
+  return text;
+}
+
+size_t BPETokenizer::vocab_size() const { return vocab_.size(); }
+
+int BPETokenizer::bos_token_id() const { return bos_id_; }
+
+int BPETokenizer::eos_token_id() const { return eos_id_; }
+
+int BPETokenizer::pad_token_id() const { return -1; }
+
+std::string BPETokenizer::id_to_token(int id) const {
+  if (id < 0 || id >= static_cast<int>(vocab_.size())) {
+    return "";
+  }
+  return vocab_[id];
+}
+
+int BPETokenizer::token_to_id(const std::string& token) const {
+  auto it = token_ids_.find(token);
+  return it != token_ids_.end() ? it->second : -1;
+}
+
+}  // namespace runtime
+}  // namespace mlxr
@@ -7,11 +7,103 @@
 
 #include <sentencepiece_processor.h>
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 
 namespace mlxr {
 namespace runtime {
 
+namespace {
+
+// Shared tokenization pool backing encode_batch() / encode_async().
+// A few workers are plenty (encode is CPU-bound and bursts are shallow)
+// and one process-wide pool avoids per-tokenizer thread churn. The
+// singleton is leaked deliberately so worker wakeups never race static
+// destruction at process exit
+class TokenizePool {
+ public:
+  static TokenizePool& shared() {
+    static TokenizePool* pool = new TokenizePool(4);
+    return *pool;
+  }
+
+  void submit(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+  }
+
+ private:
+  explicit TokenizePool(int num_workers) {
+    for (int i = 0; i < num_workers; ++i) {
+      workers_.emplace_back([this] { run(); });
+    }
+  }
+
+  void run() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !tasks_.empty(); });
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+}  // namespace
+
+std::vector<std::vector<int>> Tokenizer::encode_batch(
+    const std::vector<std::string>& texts) {
+  std::vector<std::vector<int>> results(texts.size());
+  if (texts.empty()) {
+    return results;
+  }
+  if (texts.size() == 1) {
+    results[0] = encode(texts[0]);
+    return results;
+  }
+
+  // Fan out all but the first text; the caller's thread takes a share
+  // so a two-text batch doesn't pay a full pool round trip
+  std::vector<std::future<std::vector<int>>> futures;
+  futures.reserve(texts.size() - 1);
+  for (size_t i = 1; i < texts.size(); ++i) {
+    auto task = std::make_shared<std::packaged_task<std::vector<int>()>>(
+        [this, &texts, i] { return encode(texts[i]); });
+    futures.push_back(task->get_future());
+    TokenizePool::shared().submit([task] { (*task)(); });
+  }
+
+  results[0] = encode(texts[0]);
+  for (size_t i = 1; i < texts.size(); ++i) {
+    results[i] = futures[i - 1].get();
+  }
+  return results;
+}
+
+std::future<std::vector<int>> Tokenizer::encode_async(std::string text) {
+  auto task = std::make_shared<std::packaged_task<std::vector<int>()>>(
+      [this, owned = std::move(text)] { return encode(owned); });
+  auto future = task->get_future();
+  TokenizePool::shared().submit([task] { (*task)(); });
+  return future;
+}
+
 // SentencePiece implementation using PIMPL pattern
 class SentencePieceTokenizer::Impl {
  public:
@@ -96,6 +188,105 @@ int SentencePieceTokenizer::token_to_id(const std::string& token) const {
   return impl_->token_to_id(token);
 }
 
+// ============================================================================
+// DetokenizeStream
+// ============================================================================
+
+DetokenizeStream::DetokenizeStream(Tokenizer* tokenizer)
+    : tokenizer_(tokenizer) {
+  if (!tokenizer_) {
+    throw std::invalid_argument("DetokenizeStream requires a tokenizer");
+  }
+  window_.reserve(2 * kMaxWindowTokens);
+}
+
+std::string DetokenizeStream::push(int token_id) {
+  window_.push_back(token_id);
+
+  // Decode the trailing window; the previous window decode is the diff
+  // base, so per-token cost is bounded by the window size, not the
+  // sequence length
+  std::string text = tokenizer_->decode(window_);
+
+  std::string raw_new;
+  if (text.size() >= window_text_.size() &&
+      text.compare(0, window_text_.size(), window_text_) == 0) {
+    raw_new = text.substr(window_text_.size());
+  }
+  // else: decoding this token changed earlier output (rare SentencePiece
+  // normalization case) - emit nothing this round and resync below
+
+  window_text_ = std::move(text);
+
+  // Re-anchor the window once it grows; the re-decode may drop a leading
+  // space at the new boundary, which is fine since window_text_ is only
+  // used as the subtrahend for future diffs
+  if (window_.size() > 2 * kMaxWindowTokens) {
+    window_.erase(window_.begin(), window_.end() - kMaxWindowTokens);
+    window_text_ = tokenizer_->decode(window_);
+  }
+
+  // Buffer incomplete multi-byte sequences (byte-fallback pieces can
+  // split a UTF-8 code point across tokens)
+  pending_ += raw_new;
+  size_t complete = utf8_complete_prefix(pending_);
+  std::string out = pending_.substr(0, complete);
+  pending_.erase(0, complete);
+
+  return out;
+}
+
+std::string DetokenizeStream::flush() {
+  std::string out = std::move(pending_);
+  pending_.clear();
+  return out;
+}
+
+void DetokenizeStream::reset() {
+  window_.clear();
+  window_text_.clear();
+  pending_.clear();
+}
+
+size_t DetokenizeStream::utf8_complete_prefix(const std::string& bytes) {
+  if (bytes.empty()) {
+    return 0;
+  }
+
+  // Find the last lead byte within the final 4 bytes
+  size_t size = bytes.size();
+  size_t scan_limit = size >= 4 ? size - 4 : 0;
+
+  for (size_t i = size; i > scan_limit; --i) {
+    unsigned char c = static_cast<unsigned char>(bytes[i - 1]);
+
+    if ((c & 0x80) == 0x00) {
+      return size;  // ASCII: everything up to here is complete
+    }
+    if ((c & 0xC0) == 0x80) {
+      continue;  // Continuation byte, keep scanning for the lead
+    }
+
+    // Lead byte: how many bytes does its sequence need?
+    size_t expected = 0;
+    if ((c & 0xE0) == 0xC0) {
+      expected = 2;
+    } else if ((c & 0xF0) == 0xE0) {
+      expected = 3;
+    } else if ((c & 0xF8) == 0xF0) {
+      expected = 4;
+    } else {
+      return size;  // Invalid lead; pass bytes through as-is
+    }
+
+    size_t available = size - (i - 1);
+    return available < expected ? i - 1 : size;
+  }
+
+  // No lead byte found in the tail (orphan continuations): pass through
+  return size;
+}
+
 // C++17 compatible string suffix check
 static bool ends_with(const std::string& str, const std::string& suffix) {
   if (suffix.length() > str.length()) return false;
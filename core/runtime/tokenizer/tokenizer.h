@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -31,6 +32,31 @@ class Tokenizer {
    */
   virtual std::vector<int> encode(const std::string& text) = 0;
 
+  /**
+   * @brief Encode a batch of texts in parallel
+   * @param texts Input texts
+   * @return One token ID vector per input, in the same order
+   *
+   * The default implementation fans the texts out across a small shared
+   * tokenization pool and calls encode() per text, so any backend whose
+   * encode() is thread-safe (SentencePiece is after Load) parallelizes
+   * for free. Batches of one text encode inline without a handoff.
+   */
+  virtual std::vector<std::vector<int>> encode_batch(
+      const std::vector<std::string>& texts);
+
+  /**
+   * @brief Encode one text asynchronously on the tokenization pool
+   * @param text Input text (moved into the task)
+   * @return Future resolving to the token IDs (or the encode exception)
+   *
+   * Lets the serving layer enqueue raw prompt text and move on instead
+   * of tokenizing on the request thread; a multi-KB document no longer
+   * serializes ahead of the requests queued behind it. The tokenizer
+   * must outlive the returned future.
+   */
+  std::future<std::vector<int>> encode_async(std::string text);
+
   /**
    * @brief Decode token IDs to text
    * @param ids Vector of token IDs
@@ -115,6 +141,68 @@ class SentencePieceTokenizer : public Tokenizer {
   std::unique_ptr<Impl> impl_;
 };
 
+/**
+ * @brief Incremental streaming detokenizer
+ *
+ * Converts one token ID at a time into only the NEW UTF-8 bytes it
+ * contributes, instead of re-decoding the accumulated sequence per
+ * emitted token (O(n) per token, O(n^2) per request). Internally keeps
+ * a small trailing token window so SentencePiece boundary handling
+ * ("▁" -> space, byte fallback pieces) stays correct, and buffers
+ * incomplete multi-byte UTF-8 sequences until they complete.
+ *
+ * Usage:
+ * @code
+ * DetokenizeStream stream(tokenizer.get());
+ * for (int token_id : generated) {
+ *   emit(stream.push(token_id));  // only the new bytes
+ * }
+ * emit(stream.flush());  // any buffered trailing bytes
+ * @endcode
+ */
+class DetokenizeStream {
+ public:
+  /**
+   * @brief Construct stream over a tokenizer
+   * @param tokenizer Tokenizer used for decoding (not owned)
+   */
+  explicit DetokenizeStream(Tokenizer* tokenizer);
+
+  /**
+   * @brief Feed one token and get the newly finalized text
+   * @param token_id Generated token ID
+   * @return New complete UTF-8 bytes (may be empty while a multi-byte
+   *         sequence is still being assembled)
+   */
+  std::string push(int token_id);
+
+  /**
+   * @brief Drain any buffered incomplete bytes at end of generation
+   * @return Remaining buffered bytes (possibly invalid UTF-8 tail)
+   */
+  std::string flush();
+
+  /**
+   * @brief Reset stream state for reuse
+   */
+  void reset();
+
+ private:
+  /**
+   * @brief Length of the longest complete-UTF-8 prefix of bytes
+   */
+  static size_t utf8_complete_prefix(const std::string& bytes);
+
+  // Trailing window kept for boundary-correct decoding; the window is
+  // re-anchored once it grows past twice this size
+  static constexpr size_t kMaxWindowTokens = 16;
+
+  Tokenizer* tokenizer_;
+  std::vector<int> window_;  // Trailing token IDs
+  std::string window_text_;  // decode(window_) from the previous push
+  std::string pending_;      // Held-back incomplete UTF-8 bytes
+};
+
 /**
  * @brief Factory function to create tokenizer from path
  * @param model_path Path to tokenizer model file
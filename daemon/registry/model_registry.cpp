@@ -23,6 +23,16 @@ int64_t current_timestamp() {
       .count();
 }
 
+// The /api/tags and /v1/models handlers poll list_models() with default
+// options every few seconds; only that exact query is served from the
+// in-memory snapshot
+bool is_default_query(const QueryOptions& options) {
+  return !options.architecture && !options.format && !options.quant_type &&
+         !options.search_term && options.required_tags.empty() &&
+         options.limit == 100 && options.offset == 0 &&
+         options.order_by == "last_used_timestamp DESC";
+}
+
 // SQL schema for model registry
 const char* SCHEMA_SQL = R"(
 -- Models table
@@ -90,6 +100,57 @@ CREATE TABLE IF NOT EXISTS adapters (
 );
 
 CREATE INDEX IF NOT EXISTS idx_adapters_base_model ON adapters(base_model_id);
+
+-- Tuned kernel dispatch variants, recorded by the autotune pass at first
+-- model load and keyed by GPU (winners differ across generations)
+CREATE TABLE IF NOT EXISTS kernel_tunings (
+  kernel TEXT NOT NULL,
+  shape_key TEXT NOT NULL,
+  device TEXT NOT NULL,
+  threadgroup_width INTEGER NOT NULL,
+  latency_us REAL,
+  created_timestamp INTEGER,
+  PRIMARY KEY (kernel, shape_key, device)
+);
+
+CREATE INDEX IF NOT EXISTS idx_kernel_tunings_device ON kernel_tunings(device);
+
+-- Deterministic-response cache: byte-identical serialized completion
+-- bodies for temperature=0 requests, keyed by (model, request hash)
+-- and evicted least-recently-used by last_access
+CREATE TABLE IF NOT EXISTS cache_entries (
+  model TEXT NOT NULL,
+  prompt_hash TEXT NOT NULL,
+  response TEXT NOT NULL,
+  created_timestamp INTEGER,
+  last_access INTEGER,
+  PRIMARY KEY (model, prompt_hash)
+);
+
+CREATE INDEX IF NOT EXISTS idx_cache_entries_last_access ON cache_entries(last_access);
+
+-- Content-addressed embedding cache: one float32 vector per
+-- (model, text hash), evicted least-recently-used by last_access
+CREATE TABLE IF NOT EXISTS embedding_cache (
+  model TEXT NOT NULL,
+  text_hash TEXT NOT NULL,
+  embedding BLOB NOT NULL,
+  created_timestamp INTEGER,
+  last_access INTEGER,
+  PRIMARY KEY (model, text_hash)
+);
+
+CREATE INDEX IF NOT EXISTS idx_embedding_cache_last_access ON embedding_cache(last_access);
+
+-- Partial pull progress: per-URL chunk bitmaps so an interrupted model
+-- download resumes from the last completed chunk instead of restarting
+CREATE TABLE IF NOT EXISTS pull_state (
+  url TEXT PRIMARY KEY,
+  total_size INTEGER NOT NULL,
+  chunk_size INTEGER NOT NULL,
+  bitmap BLOB NOT NULL,
+  updated_timestamp INTEGER
+);
 )";
 
 }  // anonymous namespace
@@ -98,7 +159,6 @@ ModelRegistry::ModelRegistry(const std::string& db_path, bool create_if_missing)
     : db_(nullptr),
       db_path_(db_path),
       stmt_insert_model_(nullptr),
-      stmt_update_model_(nullptr),
       stmt_get_model_(nullptr),
       stmt_touch_model_(nullptr) {
   (void)create_if_missing;  // Reserved for future use
@@ -122,6 +182,12 @@ bool ModelRegistry::initialize() {
   // Enable foreign keys
   sqlite3_exec(db_, "PRAGMA foreign_keys = ON;", nullptr, nullptr, nullptr);
 
+  // WAL keeps readers from blocking behind a long model import in another
+  // connection; NORMAL synchronous is durable under WAL and avoids an
+  // fsync on every registry write
+  sqlite3_exec(db_, "PRAGMA journal_mode = WAL;", nullptr, nullptr, nullptr);
+  sqlite3_exec(db_, "PRAGMA synchronous = NORMAL;", nullptr, nullptr, nullptr);
+
   // Create schema (idempotent - uses CREATE TABLE IF NOT EXISTS)
   if (!create_schema()) {
     return false;
@@ -186,19 +252,91 @@ bool ModelRegistry::prepare_statements() {
 
 void ModelRegistry::finalize_statements() {
   if (stmt_insert_model_) sqlite3_finalize(stmt_insert_model_);
-  if (stmt_update_model_) sqlite3_finalize(stmt_update_model_);
   if (stmt_get_model_) sqlite3_finalize(stmt_get_model_);
   if (stmt_touch_model_) sqlite3_finalize(stmt_touch_model_);
 
   stmt_insert_model_ = nullptr;
-  stmt_update_model_ = nullptr;
   stmt_get_model_ = nullptr;
   stmt_touch_model_ = nullptr;
+
+  for (auto& [sql, stmt] : stmt_cache_) {
+    sqlite3_finalize(stmt);
+  }
+  stmt_cache_.clear();
+}
+
+sqlite3_stmt* ModelRegistry::get_cached_stmt(const std::string& sql) const {
+  auto it = stmt_cache_.find(sql);
+  if (it != stmt_cache_.end()) {
+    sqlite3_reset(it->second);
+    sqlite3_clear_bindings(it->second);
+    return it->second;
+  }
+
+  sqlite3_stmt* stmt = nullptr;
+  if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    return nullptr;
+  }
+  stmt_cache_.emplace(sql, stmt);
+  return stmt;
+}
+
+void ModelRegistry::invalidate_model_snapshot() {
+  write_generation_++;
+  snapshot_valid_ = false;
 }
 
 int64_t ModelRegistry::register_model(const ModelInfo& info) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t model_id;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    model_id = register_model_locked(info);
+  }
 
+  // Insert tags outside the registry lock (add_tags takes it itself)
+  if (model_id >= 0 && !info.tags.empty()) {
+    std::unordered_map<std::string, std::string> tags;
+    for (size_t i = 0; i < info.tags.size(); i++) {
+      tags["tag_" + std::to_string(i)] = info.tags[i];
+    }
+    add_tags(model_id, tags);
+  }
+
+  return model_id;
+}
+
+std::vector<int64_t> ModelRegistry::register_models(
+    const std::vector<ModelInfo>& infos) {
+  std::vector<int64_t> model_ids;
+  model_ids.reserve(infos.size());
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // One transaction for the whole batch: a single journal commit and
+    // fsync instead of one per model. Individual insert failures (e.g.
+    // a duplicate model_id) record -1 and do not abort the batch
+    sqlite3_exec(db_, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr);
+    for (const auto& info : infos) {
+      model_ids.push_back(register_model_locked(info));
+    }
+    sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr);
+  }
+
+  for (size_t i = 0; i < infos.size(); i++) {
+    if (model_ids[i] >= 0 && !infos[i].tags.empty()) {
+      std::unordered_map<std::string, std::string> tags;
+      for (size_t t = 0; t < infos[i].tags.size(); t++) {
+        tags["tag_" + std::to_string(t)] = infos[i].tags[t];
+      }
+      add_tags(model_ids[i], tags);
+    }
+  }
+
+  return model_ids;
+}
+
+int64_t ModelRegistry::register_model_locked(const ModelInfo& info) {
   sqlite3_reset(stmt_insert_model_);
 
   int idx = 1;
@@ -257,15 +395,7 @@ int64_t ModelRegistry::register_model(const ModelInfo& info) {
   }
 
   int64_t model_id = sqlite3_last_insert_rowid(db_);
-
-  // Insert tags
-  if (!info.tags.empty()) {
-    std::unordered_map<std::string, std::string> tags;
-    for (size_t i = 0; i < info.tags.size(); i++) {
-      tags["tag_" + std::to_string(i)] = info.tags[i];
-    }
-    add_tags(model_id, tags);
-  }
+  invalidate_model_snapshot();
 
   return model_id;
 }
@@ -285,9 +415,8 @@ bool ModelRegistry::update_model(const ModelInfo& info) {
     WHERE id = ?
   )";
 
-  sqlite3_stmt* stmt;
-  int rc = sqlite3_prepare_v2(db_, update_sql, -1, &stmt, nullptr);
-  if (rc != SQLITE_OK) {
+  sqlite3_stmt* stmt = get_cached_stmt(update_sql);
+  if (!stmt) {
     return false;
   }
 
@@ -330,10 +459,14 @@ bool ModelRegistry::update_model(const ModelInfo& info) {
                     SQLITE_TRANSIENT);
   sqlite3_bind_int64(stmt, idx++, info.id);
 
-  rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  int rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
 
-  return rc == SQLITE_DONE;
+  if (rc == SQLITE_DONE) {
+    invalidate_model_snapshot();
+    return true;
+  }
+  return false;
 }
 
 bool ModelRegistry::remove_model(int64_t model_id, bool delete_file) {
@@ -347,17 +480,20 @@ bool ModelRegistry::remove_model(int64_t model_id, bool delete_file) {
   }
 
   const char* delete_sql = "DELETE FROM models WHERE id = ?";
-  sqlite3_stmt* stmt;
-  int rc = sqlite3_prepare_v2(db_, delete_sql, -1, &stmt, nullptr);
-  if (rc != SQLITE_OK) {
+  sqlite3_stmt* stmt = get_cached_stmt(delete_sql);
+  if (!stmt) {
     return false;
   }
 
   sqlite3_bind_int64(stmt, 1, model_id);
-  rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  int rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
 
-  return rc == SQLITE_DONE;
+  if (rc == SQLITE_DONE) {
+    invalidate_model_snapshot();
+    return true;
+  }
+  return false;
 }
 
 std::optional<ModelInfo> ModelRegistry::get_model(int64_t model_id) const {
@@ -379,21 +515,19 @@ std::optional<ModelInfo> ModelRegistry::get_model_by_identifier(
   std::lock_guard<std::mutex> lock(mutex_);
 
   const char* sql = "SELECT * FROM models WHERE model_id = ?";
-  sqlite3_stmt* stmt;
-  int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-  if (rc != SQLITE_OK) {
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
     return std::nullopt;
   }
 
   sqlite3_bind_text(stmt, 1, model_id.c_str(), -1, SQLITE_TRANSIENT);
-  rc = sqlite3_step(stmt);
 
   std::optional<ModelInfo> result;
-  if (rc == SQLITE_ROW) {
+  if (sqlite3_step(stmt) == SQLITE_ROW) {
     result = row_to_model_info(stmt);
   }
 
-  sqlite3_finalize(stmt);
+  sqlite3_reset(stmt);
   return result;
 }
 
@@ -401,6 +535,14 @@ std::vector<ModelInfo> ModelRegistry::list_models(
     const QueryOptions& options) const {
   std::lock_guard<std::mutex> lock(mutex_);
 
+  // Serve the polled default listing from the snapshot when no write has
+  // happened since it was taken
+  const bool cacheable = is_default_query(options);
+  if (cacheable && snapshot_valid_ &&
+      snapshot_generation_ == write_generation_) {
+    return model_list_snapshot_;
+  }
+
   std::stringstream sql;
   sql << "SELECT * FROM models WHERE 1=1";
 
@@ -426,9 +568,15 @@ std::vector<ModelInfo> ModelRegistry::list_models(
   sql << " ORDER BY " << options.order_by;
   sql << " LIMIT " << options.limit << " OFFSET " << options.offset;
 
-  sqlite3_stmt* stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.str().c_str(), -1, &stmt, nullptr);
-  if (rc != SQLITE_OK) {
+  // Filtered queries inline their terms into the SQL text, so only the
+  // fixed default query goes through the statement cache
+  sqlite3_stmt* stmt = nullptr;
+  if (cacheable) {
+    stmt = get_cached_stmt(sql.str());
+  } else {
+    sqlite3_prepare_v2(db_, sql.str().c_str(), -1, &stmt, nullptr);
+  }
+  if (!stmt) {
     return {};
   }
 
@@ -437,7 +585,15 @@ std::vector<ModelInfo> ModelRegistry::list_models(
     results.push_back(row_to_model_info(stmt));
   }
 
-  sqlite3_finalize(stmt);
+  if (cacheable) {
+    sqlite3_reset(stmt);
+    model_list_snapshot_ = results;
+    snapshot_generation_ = write_generation_;
+    snapshot_valid_ = true;
+  } else {
+    sqlite3_finalize(stmt);
+  }
+
   return results;
 }
 
@@ -448,18 +604,25 @@ void ModelRegistry::touch_model(int64_t model_id) {
   sqlite3_bind_int64(stmt_touch_model_, 1, current_timestamp());
   sqlite3_bind_int64(stmt_touch_model_, 2, model_id);
   sqlite3_step(stmt_touch_model_);
+
+  // Touching reorders the default listing (last_used_timestamp DESC)
+  invalidate_model_snapshot();
 }
 
 void ModelRegistry::set_model_loaded(int64_t model_id, bool loaded) {
   std::lock_guard<std::mutex> lock(mutex_);
 
   const char* sql = "UPDATE models SET is_loaded = ? WHERE id = ?";
-  sqlite3_stmt* stmt;
-  sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return;
+  }
   sqlite3_bind_int(stmt, 1, loaded ? 1 : 0);
   sqlite3_bind_int64(stmt, 2, model_id);
   sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  sqlite3_reset(stmt);
+
+  invalidate_model_snapshot();
 }
 
 bool ModelRegistry::add_tags(
@@ -470,9 +633,8 @@ bool ModelRegistry::add_tags(
   const char* sql =
       "INSERT OR REPLACE INTO model_tags (model_id, key, value) VALUES (?, ?, "
       "?)";
-  sqlite3_stmt* stmt;
-  int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-  if (rc != SQLITE_OK) {
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
     return false;
   }
 
@@ -484,7 +646,8 @@ bool ModelRegistry::add_tags(
     sqlite3_step(stmt);
   }
 
-  sqlite3_finalize(stmt);
+  sqlite3_reset(stmt);
+  invalidate_model_snapshot();
   return true;
 }
 
@@ -493,8 +656,10 @@ std::unordered_map<std::string, std::string> ModelRegistry::get_tags(
   std::lock_guard<std::mutex> lock(mutex_);
 
   const char* sql = "SELECT key, value FROM model_tags WHERE model_id = ?";
-  sqlite3_stmt* stmt;
-  sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return {};
+  }
   sqlite3_bind_int64(stmt, 1, model_id);
 
   std::unordered_map<std::string, std::string> tags;
@@ -506,10 +671,336 @@ std::unordered_map<std::string, std::string> ModelRegistry::get_tags(
     tags[key] = value;
   }
 
-  sqlite3_finalize(stmt);
+  sqlite3_reset(stmt);
   return tags;
 }
 
+bool ModelRegistry::set_kernel_tuning(const KernelTuning& tuning) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const char* sql =
+      "INSERT OR REPLACE INTO kernel_tunings "
+      "(kernel, shape_key, device, threadgroup_width, latency_us, "
+      "created_timestamp) VALUES (?, ?, ?, ?, ?, ?)";
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return false;
+  }
+
+  sqlite3_bind_text(stmt, 1, tuning.kernel.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 2, tuning.shape_key.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 3, tuning.device.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int(stmt, 4, tuning.threadgroup_width);
+  sqlite3_bind_double(stmt, 5, tuning.latency_us);
+  sqlite3_bind_int64(stmt, 6, current_timestamp());
+
+  int rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+  return rc == SQLITE_DONE;
+}
+
+std::optional<KernelTuning> ModelRegistry::get_kernel_tuning(
+    const std::string& kernel, const std::string& shape_key,
+    const std::string& device) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const char* sql =
+      "SELECT kernel, shape_key, device, threadgroup_width, latency_us, "
+      "created_timestamp FROM kernel_tunings "
+      "WHERE kernel = ? AND shape_key = ? AND device = ?";
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return std::nullopt;
+  }
+  sqlite3_bind_text(stmt, 1, kernel.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 2, shape_key.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 3, device.c_str(), -1, SQLITE_TRANSIENT);
+
+  std::optional<KernelTuning> result;
+  if (sqlite3_step(stmt) == SQLITE_ROW) {
+    result = row_to_kernel_tuning(stmt);
+  }
+
+  sqlite3_reset(stmt);
+  return result;
+}
+
+std::vector<KernelTuning> ModelRegistry::list_kernel_tunings(
+    const std::string& device) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const char* sql =
+      "SELECT kernel, shape_key, device, threadgroup_width, latency_us, "
+      "created_timestamp FROM kernel_tunings WHERE device = ?";
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return {};
+  }
+  sqlite3_bind_text(stmt, 1, device.c_str(), -1, SQLITE_TRANSIENT);
+
+  std::vector<KernelTuning> tunings;
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    tunings.push_back(row_to_kernel_tuning(stmt));
+  }
+
+  sqlite3_reset(stmt);
+  return tunings;
+}
+
+bool ModelRegistry::put_cache_entry(const std::string& model,
+                                    const std::string& prompt_hash,
+                                    const std::string& response,
+                                    int max_entries) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const char* sql =
+      "INSERT OR REPLACE INTO cache_entries "
+      "(model, prompt_hash, response, created_timestamp, last_access) "
+      "VALUES (?, ?, ?, ?, ?)";
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return false;
+  }
+
+  int64_t now = current_timestamp();
+  sqlite3_bind_text(stmt, 1, model.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 2, prompt_hash.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 3, response.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int64(stmt, 4, now);
+  sqlite3_bind_int64(stmt, 5, now);
+
+  int rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+  if (rc != SQLITE_DONE) {
+    return false;
+  }
+
+  // LRU eviction: drop everything past the max_entries most recently
+  // accessed rows
+  if (max_entries > 0) {
+    const char* evict_sql =
+        "DELETE FROM cache_entries WHERE rowid IN "
+        "(SELECT rowid FROM cache_entries "
+        " ORDER BY last_access DESC LIMIT -1 OFFSET ?)";
+    stmt = get_cached_stmt(evict_sql);
+    if (!stmt) {
+      return false;
+    }
+    sqlite3_bind_int(stmt, 1, max_entries);
+    rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::optional<std::string> ModelRegistry::get_cache_entry(
+    const std::string& model, const std::string& prompt_hash) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const char* sql =
+      "SELECT response FROM cache_entries "
+      "WHERE model = ? AND prompt_hash = ?";
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return std::nullopt;
+  }
+  sqlite3_bind_text(stmt, 1, model.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 2, prompt_hash.c_str(), -1, SQLITE_TRANSIENT);
+
+  std::optional<std::string> result;
+  if (sqlite3_step(stmt) == SQLITE_ROW) {
+    const char* response =
+        reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    if (response) {
+      result = std::string(response);
+    }
+  }
+  sqlite3_reset(stmt);
+
+  if (result) {
+    const char* touch_sql =
+        "UPDATE cache_entries SET last_access = ? "
+        "WHERE model = ? AND prompt_hash = ?";
+    stmt = get_cached_stmt(touch_sql);
+    if (stmt) {
+      sqlite3_bind_int64(stmt, 1, current_timestamp());
+      sqlite3_bind_text(stmt, 2, model.c_str(), -1, SQLITE_TRANSIENT);
+      sqlite3_bind_text(stmt, 3, prompt_hash.c_str(), -1, SQLITE_TRANSIENT);
+      sqlite3_step(stmt);
+      sqlite3_reset(stmt);
+    }
+  }
+
+  return result;
+}
+
+bool ModelRegistry::put_embedding(const std::string& model,
+                                  const std::string& text_hash,
+                                  const std::vector<float>& embedding,
+                                  int max_entries) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const char* sql =
+      "INSERT OR REPLACE INTO embedding_cache "
+      "(model, text_hash, embedding, created_timestamp, last_access) "
+      "VALUES (?, ?, ?, ?, ?)";
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return false;
+  }
+
+  int64_t now = current_timestamp();
+  sqlite3_bind_text(stmt, 1, model.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 2, text_hash.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_blob(stmt, 3, embedding.data(),
+                    static_cast<int>(embedding.size() * sizeof(float)),
+                    SQLITE_TRANSIENT);
+  sqlite3_bind_int64(stmt, 4, now);
+  sqlite3_bind_int64(stmt, 5, now);
+
+  int rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+  if (rc != SQLITE_DONE) {
+    return false;
+  }
+
+  // LRU eviction: drop everything past the max_entries most recently
+  // accessed rows
+  if (max_entries > 0) {
+    const char* evict_sql =
+        "DELETE FROM embedding_cache WHERE rowid IN "
+        "(SELECT rowid FROM embedding_cache "
+        " ORDER BY last_access DESC LIMIT -1 OFFSET ?)";
+    stmt = get_cached_stmt(evict_sql);
+    if (!stmt) {
+      return false;
+    }
+    sqlite3_bind_int(stmt, 1, max_entries);
+    rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::optional<std::vector<float>> ModelRegistry::get_embedding(
+    const std::string& model, const std::string& text_hash) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const char* sql =
+      "SELECT embedding FROM embedding_cache "
+      "WHERE model = ? AND text_hash = ?";
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return std::nullopt;
+  }
+  sqlite3_bind_text(stmt, 1, model.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt, 2, text_hash.c_str(), -1, SQLITE_TRANSIENT);
+
+  std::optional<std::vector<float>> result;
+  if (sqlite3_step(stmt) == SQLITE_ROW) {
+    const void* blob = sqlite3_column_blob(stmt, 0);
+    int bytes = sqlite3_column_bytes(stmt, 0);
+    if (blob && bytes > 0 && bytes % static_cast<int>(sizeof(float)) == 0) {
+      const float* values = static_cast<const float*>(blob);
+      result = std::vector<float>(values, values + bytes / sizeof(float));
+    }
+  }
+  sqlite3_reset(stmt);
+
+  if (result) {
+    const char* touch_sql =
+        "UPDATE embedding_cache SET last_access = ? "
+        "WHERE model = ? AND text_hash = ?";
+    stmt = get_cached_stmt(touch_sql);
+    if (stmt) {
+      sqlite3_bind_int64(stmt, 1, current_timestamp());
+      sqlite3_bind_text(stmt, 2, model.c_str(), -1, SQLITE_TRANSIENT);
+      sqlite3_bind_text(stmt, 3, text_hash.c_str(), -1, SQLITE_TRANSIENT);
+      sqlite3_step(stmt);
+      sqlite3_reset(stmt);
+    }
+  }
+
+  return result;
+}
+
+bool ModelRegistry::save_pull_state(const std::string& url,
+                                    const PullState& state) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const char* sql =
+      "INSERT OR REPLACE INTO pull_state "
+      "(url, total_size, chunk_size, bitmap, updated_timestamp) "
+      "VALUES (?, ?, ?, ?, ?)";
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return false;
+  }
+
+  sqlite3_bind_text(stmt, 1, url.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int64(stmt, 2, state.total_size);
+  sqlite3_bind_int64(stmt, 3, state.chunk_size);
+  sqlite3_bind_blob(stmt, 4, state.bitmap.data(),
+                    static_cast<int>(state.bitmap.size()), SQLITE_TRANSIENT);
+  sqlite3_bind_int64(stmt, 5, current_timestamp());
+
+  int rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+  return rc == SQLITE_DONE;
+}
+
+std::optional<PullState> ModelRegistry::get_pull_state(
+    const std::string& url) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const char* sql =
+      "SELECT total_size, chunk_size, bitmap FROM pull_state WHERE url = ?";
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return std::nullopt;
+  }
+  sqlite3_bind_text(stmt, 1, url.c_str(), -1, SQLITE_TRANSIENT);
+
+  std::optional<PullState> result;
+  if (sqlite3_step(stmt) == SQLITE_ROW) {
+    PullState state;
+    state.total_size = sqlite3_column_int64(stmt, 0);
+    state.chunk_size = sqlite3_column_int64(stmt, 1);
+    const void* blob = sqlite3_column_blob(stmt, 2);
+    int bytes = sqlite3_column_bytes(stmt, 2);
+    if (blob && bytes > 0) {
+      const uint8_t* data = static_cast<const uint8_t*>(blob);
+      state.bitmap.assign(data, data + bytes);
+    }
+    result = state;
+  }
+
+  sqlite3_reset(stmt);
+  return result;
+}
+
+bool ModelRegistry::clear_pull_state(const std::string& url) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const char* sql = "DELETE FROM pull_state WHERE url = ?";
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return false;
+  }
+  sqlite3_bind_text(stmt, 1, url.c_str(), -1, SQLITE_TRANSIENT);
+  int rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+  return rc == SQLITE_DONE;
+}
+
 int64_t ModelRegistry::register_adapter(const AdapterInfo& info) {
   std::lock_guard<std::mutex> lock(mutex_);
 
@@ -518,9 +1009,8 @@ int64_t ModelRegistry::register_adapter(const AdapterInfo& info) {
     VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
   )";
 
-  sqlite3_stmt* stmt;
-  int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-  if (rc != SQLITE_OK) {
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
     return -1;
   }
 
@@ -540,8 +1030,8 @@ int64_t ModelRegistry::register_adapter(const AdapterInfo& info) {
   sqlite3_bind_text(stmt, 8, target_modules_str.c_str(), -1, SQLITE_TRANSIENT);
   sqlite3_bind_int64(stmt, 9, current_timestamp());
 
-  rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  int rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
 
   if (rc != SQLITE_DONE) {
     return -1;
@@ -555,8 +1045,10 @@ std::vector<AdapterInfo> ModelRegistry::get_adapters(
   std::lock_guard<std::mutex> lock(mutex_);
 
   const char* sql = "SELECT * FROM adapters WHERE base_model_id = ?";
-  sqlite3_stmt* stmt;
-  sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return {};
+  }
   sqlite3_bind_int64(stmt, 1, base_model_id);
 
   std::vector<AdapterInfo> adapters;
@@ -564,7 +1056,7 @@ std::vector<AdapterInfo> ModelRegistry::get_adapters(
     adapters.push_back(row_to_adapter_info(stmt));
   }
 
-  sqlite3_finalize(stmt);
+  sqlite3_reset(stmt);
   return adapters;
 }
 
@@ -572,11 +1064,13 @@ bool ModelRegistry::remove_adapter(int64_t adapter_id) {
   std::lock_guard<std::mutex> lock(mutex_);
 
   const char* sql = "DELETE FROM adapters WHERE id = ?";
-  sqlite3_stmt* stmt;
-  sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+  sqlite3_stmt* stmt = get_cached_stmt(sql);
+  if (!stmt) {
+    return false;
+  }
   sqlite3_bind_int64(stmt, 1, adapter_id);
   int rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  sqlite3_reset(stmt);
 
   return rc == SQLITE_DONE;
 }
@@ -587,19 +1081,22 @@ std::unordered_map<std::string, int64_t> ModelRegistry::get_stats() const {
   std::unordered_map<std::string, int64_t> stats;
 
   const char* count_sql = "SELECT COUNT(*) FROM models";
-  sqlite3_stmt* stmt;
-  sqlite3_prepare_v2(db_, count_sql, -1, &stmt, nullptr);
-  if (sqlite3_step(stmt) == SQLITE_ROW) {
-    stats["total_models"] = sqlite3_column_int64(stmt, 0);
+  sqlite3_stmt* stmt = get_cached_stmt(count_sql);
+  if (stmt) {
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+      stats["total_models"] = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_reset(stmt);
   }
-  sqlite3_finalize(stmt);
 
   const char* loaded_sql = "SELECT COUNT(*) FROM models WHERE is_loaded = 1";
-  sqlite3_prepare_v2(db_, loaded_sql, -1, &stmt, nullptr);
-  if (sqlite3_step(stmt) == SQLITE_ROW) {
-    stats["loaded_models"] = sqlite3_column_int64(stmt, 0);
+  stmt = get_cached_stmt(loaded_sql);
+  if (stmt) {
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+      stats["loaded_models"] = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_reset(stmt);
   }
-  sqlite3_finalize(stmt);
 
   return stats;
 }
@@ -719,6 +1216,20 @@ AdapterInfo ModelRegistry::row_to_adapter_info(sqlite3_stmt* stmt) const {
   return info;
 }
 
+KernelTuning ModelRegistry::row_to_kernel_tuning(sqlite3_stmt* stmt) const {
+  KernelTuning tuning;
+
+  tuning.kernel = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+  tuning.shape_key =
+      reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+  tuning.device = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+  tuning.threadgroup_width = sqlite3_column_int(stmt, 3);
+  tuning.latency_us = sqlite3_column_double(stmt, 4);
+  tuning.created_timestamp = sqlite3_column_int64(stmt, 5);
+
+  return tuning;
+}
+
 std::string ModelRegistry::architecture_to_string(
     ModelArchitecture arch) const {
   switch (arch) {
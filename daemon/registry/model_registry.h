@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -129,6 +130,26 @@ struct ModelTag {
   std::string value;
 };
 
+// Tuned kernel dispatch variant for one GPU (see core/kernels/autotune.h).
+// Winners are recorded at first model load and replayed on later loads so
+// the micro-benchmark pass only runs once per (kernel, shape, device)
+struct KernelTuning {
+  std::string kernel;     // Kernel name (e.g. "attention_decode_fused")
+  std::string shape_key;  // Shape key the variant was tuned for
+  std::string device;     // GPU key (e.g. "apple-m4-max")
+  int threadgroup_width;  // Winning threads-per-threadgroup
+  double latency_us;      // Best measured dispatch latency
+  int64_t created_timestamp;
+};
+
+// Persisted progress of a partial model pull: which fixed-size chunks
+// of the transfer have already landed on disk (see server/model_puller.h)
+struct PullState {
+  int64_t total_size;           // Full file size in bytes
+  int64_t chunk_size;           // Chunk size the bitmap is keyed to
+  std::vector<uint8_t> bitmap;  // One bit per chunk, LSB-first
+};
+
 // Registry query options
 struct QueryOptions {
   std::optional<ModelArchitecture> architecture;
@@ -171,6 +192,15 @@ class ModelRegistry {
    */
   int64_t register_model(const ModelInfo& info);
 
+  /**
+   * Register a batch of models in a single transaction. One fsync for
+   * the whole batch instead of one per model, which is what makes bulk
+   * import (directory scans) fast on slow storage
+   * @param infos Model metadata entries
+   * @return One model ID per entry, -1 for entries that failed
+   */
+  std::vector<int64_t> register_models(const std::vector<ModelInfo>& infos);
+
   /**
    * Update existing model metadata
    * @param info Updated model info (must have valid id)
@@ -236,6 +266,98 @@ class ModelRegistry {
    */
   std::unordered_map<std::string, std::string> get_tags(int64_t model_id) const;
 
+  /**
+   * Persist a tuned kernel variant (upserts on kernel/shape_key/device)
+   * @param tuning Tuning record; created_timestamp is set on insert
+   * @return true if successful
+   */
+  bool set_kernel_tuning(const KernelTuning& tuning);
+
+  /**
+   * Look up a persisted kernel tuning
+   * @param kernel Kernel name
+   * @param shape_key Shape key
+   * @param device GPU key
+   * @return Tuning if one was recorded for this kernel/shape/device
+   */
+  std::optional<KernelTuning> get_kernel_tuning(
+      const std::string& kernel, const std::string& shape_key,
+      const std::string& device) const;
+
+  /**
+   * List all tunings recorded for a GPU
+   * @param device GPU key
+   * @return Vector of tunings
+   */
+  std::vector<KernelTuning> list_kernel_tunings(
+      const std::string& device) const;
+
+  /**
+   * Store a deterministic response in the cache (upserts on
+   * model/prompt_hash), then evicts least-recently-used entries past
+   * max_entries
+   * @param model Model routing name the response was generated by
+   * @param prompt_hash Stable hash of (prompt, sampler config)
+   * @param response Serialized response body to replay on hit
+   * @param max_entries Cache size cap (0 = unbounded)
+   * @return true if successful
+   */
+  bool put_cache_entry(const std::string& model, const std::string& prompt_hash,
+                       const std::string& response, int max_entries);
+
+  /**
+   * Look up a cached deterministic response and touch its last_access
+   * @param model Model routing name
+   * @param prompt_hash Stable hash of (prompt, sampler config)
+   * @return Serialized response body if cached
+   */
+  std::optional<std::string> get_cache_entry(const std::string& model,
+                                             const std::string& prompt_hash);
+
+  /**
+   * Store a computed embedding vector, content-addressed by the input
+   * text's hash (upserts on model/text_hash), then evicts
+   * least-recently-used entries past max_entries
+   * @param model Embedding model the vector came from
+   * @param text_hash Stable hash of the normalized input text
+   * @param embedding Embedding vector (stored as a float32 blob)
+   * @param max_entries Cache size cap (0 = unbounded)
+   * @return true if successful
+   */
+  bool put_embedding(const std::string& model, const std::string& text_hash,
+                     const std::vector<float>& embedding, int max_entries);
+
+  /**
+   * Look up a cached embedding and touch its last_access
+   * @param model Embedding model
+   * @param text_hash Stable hash of the normalized input text
+   * @return Embedding vector if cached
+   */
+  std::optional<std::vector<float>> get_embedding(
+      const std::string& model, const std::string& text_hash);
+
+  /**
+   * Persist the chunk bitmap of an in-progress pull (upserts on url)
+   * @param url Source URL being downloaded
+   * @param state Chunk bitmap and transfer geometry
+   * @return true if successful
+   */
+  bool save_pull_state(const std::string& url, const PullState& state);
+
+  /**
+   * Look up the persisted progress of a partial pull
+   * @param url Source URL
+   * @return Pull state if one was recorded for this URL
+   */
+  std::optional<PullState> get_pull_state(const std::string& url) const;
+
+  /**
+   * Drop the recorded pull progress (after completion or invalidation)
+   * @param url Source URL
+   * @return true if successful
+   */
+  bool clear_pull_state(const std::string& url);
+
   /**
    * Register adapter for a model
    * @param info Adapter metadata
@@ -282,16 +404,34 @@ class ModelRegistry {
 
   // Prepared statements for common queries
   sqlite3_stmt* stmt_insert_model_;
-  sqlite3_stmt* stmt_update_model_;
   sqlite3_stmt* stmt_get_model_;
   sqlite3_stmt* stmt_touch_model_;
 
+  // Prepared-statement cache for every other query, keyed by SQL text.
+  // Statements are compiled on first use and reset between calls so
+  // hot paths never re-run the SQLite parser
+  mutable std::unordered_map<std::string, sqlite3_stmt*> stmt_cache_;
+
+  // Generation-stamped snapshot of the default model listing. The UI
+  // polls /api/tags and /v1/models every few seconds with default query
+  // options; those polls are served from this snapshot without touching
+  // SQLite. Any write to the models table bumps write_generation_, which
+  // invalidates the snapshot on the next listing
+  uint64_t write_generation_ = 0;
+  mutable uint64_t snapshot_generation_ = 0;
+  mutable bool snapshot_valid_ = false;
+  mutable std::vector<ModelInfo> model_list_snapshot_;
+
   // Helper methods
   bool create_schema();
   bool prepare_statements();
   void finalize_statements();
+  sqlite3_stmt* get_cached_stmt(const std::string& sql) const;
+  void invalidate_model_snapshot();
+  int64_t register_model_locked(const ModelInfo& info);
   ModelInfo row_to_model_info(sqlite3_stmt* stmt) const;
   AdapterInfo row_to_adapter_info(sqlite3_stmt* stmt) const;
+  KernelTuning row_to_kernel_tuning(sqlite3_stmt* stmt) const;
   std::string architecture_to_string(ModelArchitecture arch) const;
   ModelArchitecture string_to_architecture(const std::string& str) const;
   std::string format_to_string(ModelFormat format) const;
@@ -0,0 +1,414 @@
+// Copyright © 2025 MLXR Development
+// Parallel header-only model directory scanner implementation
+
+#include "model_scanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include <nlohmann/json.hpp>
+
+#include "gguf_parser.h"
+
+namespace fs = std::filesystem;
+
+namespace mlxr {
+namespace registry {
+
+namespace {
+
+// Sanity bound for the safetensors JSON header: a corrupt length prefix
+// must not make the probe allocate gigabytes
+constexpr uint64_t kMaxSafetensorsHeader = 64 * 1024 * 1024;
+
+// Architecture string -> enum, matching the registry's own encoding
+ModelArchitecture architecture_from_string(const std::string& arch) {
+  if (arch == "llama") return ModelArchitecture::LLAMA;
+  if (arch == "mistral") return ModelArchitecture::MISTRAL;
+  if (arch == "mixtral") return ModelArchitecture::MIXTRAL;
+  if (arch == "gemma" || arch == "gemma2") return ModelArchitecture::GEMMA;
+  if (arch == "phi" || arch == "phi2" || arch == "phi3") {
+    return ModelArchitecture::PHI;
+  }
+  if (arch == "qwen" || arch == "qwen2") return ModelArchitecture::QWEN;
+  return ModelArchitecture::UNKNOWN;
+}
+
+// HF config.json "architectures" entry -> enum (e.g. "LlamaForCausalLM")
+ModelArchitecture architecture_from_hf_class(const std::string& cls) {
+  auto contains = [&cls](const char* needle) {
+    return cls.find(needle) != std::string::npos;
+  };
+  if (contains("Llama")) return ModelArchitecture::LLAMA;
+  if (contains("Mixtral")) return ModelArchitecture::MIXTRAL;
+  if (contains("Mistral")) return ModelArchitecture::MISTRAL;
+  if (contains("Gemma")) return ModelArchitecture::GEMMA;
+  if (contains("Phi")) return ModelArchitecture::PHI;
+  if (contains("Qwen")) return ModelArchitecture::QWEN;
+  return ModelArchitecture::UNKNOWN;
+}
+
+// Dominant tensor quantization -> registry quant type. Weight tensors
+// decide; F32 norms/embeddings alongside quantized weights are normal
+QuantizationType quant_from_tensor_type(GGUFTensorType type) {
+  switch (type) {
+    case GGUFTensorType::Q4_0:
+      return QuantizationType::Q4_0;
+    case GGUFTensorType::Q4_1:
+      return QuantizationType::Q4_1;
+    case GGUFTensorType::Q5_0:
+      return QuantizationType::Q5_0;
+    case GGUFTensorType::Q5_1:
+      return QuantizationType::Q5_1;
+    case GGUFTensorType::Q8_0:
+      return QuantizationType::Q8_0;
+    case GGUFTensorType::Q2_K:
+      return QuantizationType::Q2_K;
+    case GGUFTensorType::Q3_K:
+      return QuantizationType::Q3_K;
+    case GGUFTensorType::Q4_K:
+      return QuantizationType::Q4_K;
+    case GGUFTensorType::Q5_K:
+      return QuantizationType::Q5_K;
+    case GGUFTensorType::Q6_K:
+      return QuantizationType::Q6_K;
+    case GGUFTensorType::Q8_K:
+      return QuantizationType::Q8_K;
+    case GGUFTensorType::IQ2_XXS:
+      return QuantizationType::IQ2_XXS;
+    case GGUFTensorType::IQ2_XS:
+      return QuantizationType::IQ2_XS;
+    case GGUFTensorType::IQ3_XXS:
+      return QuantizationType::IQ3_XXS;
+    default:
+      return QuantizationType::NONE;
+  }
+}
+
+// Model identifier from the file: directory name for HF-style folders
+// (the file is usually just "model.safetensors"), file stem for GGUF
+std::string derive_model_id(const fs::path& path) {
+  std::string stem = path.stem().string();
+  if (stem == "model" || stem.rfind("model-", 0) == 0) {
+    return path.parent_path().filename().string();
+  }
+  return stem;
+}
+
+// Locate a tokenizer next to the model file
+void detect_tokenizer(const fs::path& model_path, ModelInfo& info) {
+  fs::path dir = model_path.parent_path();
+  std::error_code ec;
+  if (fs::exists(dir / "tokenizer.model", ec)) {
+    info.tokenizer_type = "sentencepiece";
+    info.tokenizer_path = (dir / "tokenizer.model").string();
+  } else if (fs::exists(dir / "tokenizer.json", ec)) {
+    info.tokenizer_type = "hf";
+    info.tokenizer_path = (dir / "tokenizer.json").string();
+  }
+}
+
+}  // namespace
+
+ModelScanner::ModelScanner(std::shared_ptr<ModelRegistry> registry)
+    : registry_(std::move(registry)) {}
+
+std::optional<ModelInfo> ModelScanner::probe_file(
+    const std::string& file_path) {
+  fs::path path(file_path);
+  std::string ext = path.extension().string();
+  if (ext == ".gguf") {
+    return probe_gguf(file_path);
+  }
+  if (ext == ".safetensors") {
+    return probe_safetensors(file_path);
+  }
+  return std::nullopt;
+}
+
+std::optional<ModelInfo> ModelScanner::probe_gguf(
+    const std::string& file_path) {
+  // GGUFFile::parse reads the header, metadata and tensor-info section
+  // only - everything before data_offset() - so this never touches
+  // tensor data
+  GGUFFile gguf;
+  if (!gguf.parse(file_path)) {
+    return std::nullopt;
+  }
+
+  ModelInfo info{};
+  fs::path path(file_path);
+  info.model_id = derive_model_id(path);
+  info.name = info.model_id;
+  info.file_path = file_path;
+  info.format = ModelFormat::GGUF;
+
+  std::error_code ec;
+  info.file_size = static_cast<uint64_t>(fs::file_size(path, ec));
+
+  info.architecture = architecture_from_string(gguf.get_arch());
+  info.context_length = static_cast<int>(gguf.get_context_length());
+  info.hidden_size = static_cast<int>(gguf.get_embedding_length());
+  info.num_layers = static_cast<int>(gguf.get_block_count());
+  info.num_heads = static_cast<int>(gguf.get_attention_head_count());
+  info.num_kv_heads = static_cast<int>(gguf.get_attention_head_count_kv());
+  info.intermediate_size = static_cast<int>(gguf.get_feed_forward_length());
+  info.rope_freq_base = gguf.get_rope_freq_base();
+  info.rope_scale = 1.0f;
+  info.rope_scaling_type = "none";
+
+  // Parameter count and dominant quantization from the tensor infos
+  // (shapes and dtypes live in the header, not the data section)
+  uint64_t param_count = 0;
+  uint64_t quant_bytes = 0;
+  QuantizationType dominant = QuantizationType::NONE;
+  for (const auto& tensor : gguf.tensors()) {
+    uint64_t elements = 1;
+    for (uint64_t dim : tensor.dimensions) {
+      elements *= dim;
+    }
+    param_count += elements;
+
+    QuantizationType quant = quant_from_tensor_type(tensor.type);
+    if (quant != QuantizationType::NONE && tensor.size > quant_bytes) {
+      quant_bytes = tensor.size;
+      dominant = quant;
+    }
+  }
+  info.param_count = param_count;
+  info.quant_type = dominant;
+
+  // Vocab size from the embedding tensor when present
+  if (const auto* embed = gguf.find_tensor("token_embd.weight")) {
+    if (embed->dimensions.size() == 2) {
+      info.vocab_size = static_cast<int>(embed->dimensions[1]);
+    }
+  }
+
+  detect_tokenizer(path, info);
+  if (info.tokenizer_path.empty() && !gguf.get_tokenizer_model().empty()) {
+    // Tokenizer is embedded in the GGUF itself
+    info.tokenizer_type = gguf.get_tokenizer_model() == "gpt2"
+                              ? "hf"
+                              : "sentencepiece";
+    info.tokenizer_path = file_path;
+  }
+
+  info.description = "Imported by directory scan";
+  info.is_loaded = false;
+  return info;
+}
+
+std::optional<ModelInfo> ModelScanner::probe_safetensors(
+    const std::string& file_path) {
+  // safetensors layout: 8-byte little-endian header length, then a JSON
+  // object mapping tensor names to {dtype, shape, data_offsets}
+  std::ifstream stream(file_path, std::ios::binary);
+  if (!stream) {
+    return std::nullopt;
+  }
+
+  uint64_t header_len = 0;
+  stream.read(reinterpret_cast<char*>(&header_len), sizeof(header_len));
+  if (!stream.good() || header_len == 0 ||
+      header_len > kMaxSafetensorsHeader) {
+    return std::nullopt;
+  }
+
+  std::string header_json(header_len, '\0');
+  stream.read(header_json.data(), static_cast<std::streamsize>(header_len));
+  if (!stream.good()) {
+    return std::nullopt;
+  }
+
+  nlohmann::json header = nlohmann::json::parse(header_json, nullptr, false);
+  if (header.is_discarded() || !header.is_object()) {
+    return std::nullopt;
+  }
+
+  ModelInfo info{};
+  fs::path path(file_path);
+  info.model_id = derive_model_id(path);
+  info.name = info.model_id;
+  info.file_path = file_path;
+  info.format = ModelFormat::SAFETENSORS;
+  info.quant_type = QuantizationType::NONE;
+
+  std::error_code ec;
+  info.file_size = static_cast<uint64_t>(fs::file_size(path, ec));
+
+  uint64_t param_count = 0;
+  for (auto it = header.begin(); it != header.end(); ++it) {
+    if (it.key() == "__metadata__" || !it.value().is_object()) {
+      continue;
+    }
+    const auto& shape = it.value().value("shape", nlohmann::json::array());
+    uint64_t elements = 1;
+    for (const auto& dim : shape) {
+      if (dim.is_number_unsigned()) {
+        elements *= dim.get<uint64_t>();
+      }
+    }
+    param_count += elements;
+  }
+  info.param_count = param_count;
+
+  // Architecture details come from the sibling config.json in HF model
+  // folders; absent config just leaves the fields at their defaults
+  fs::path config_path = path.parent_path() / "config.json";
+  std::ifstream config_stream(config_path);
+  if (config_stream) {
+    nlohmann::json config =
+        nlohmann::json::parse(config_stream, nullptr, false);
+    if (!config.is_discarded() && config.is_object()) {
+      info.hidden_size = config.value("hidden_size", 0);
+      info.num_layers = config.value("num_hidden_layers", 0);
+      info.num_heads = config.value("num_attention_heads", 0);
+      info.num_kv_heads =
+          config.value("num_key_value_heads", info.num_heads);
+      info.intermediate_size = config.value("intermediate_size", 0);
+      info.vocab_size = config.value("vocab_size", 0);
+      info.context_length = config.value("max_position_embeddings", 0);
+      info.rope_freq_base = config.value("rope_theta", 10000.0f);
+      info.rope_scale = 1.0f;
+      info.rope_scaling_type = "none";
+
+      const auto& archs =
+          config.value("architectures", nlohmann::json::array());
+      if (!archs.empty() && archs[0].is_string()) {
+        info.architecture =
+            architecture_from_hf_class(archs[0].get<std::string>());
+      }
+    }
+  }
+
+  detect_tokenizer(path, info);
+  info.description = "Imported by directory scan";
+  info.is_loaded = false;
+  return info;
+}
+
+ScanResult ModelScanner::scan_directory(const std::string& directory,
+                                        const ScanOptions& options) {
+  ScanResult result;
+  auto scan_start = std::chrono::steady_clock::now();
+
+  std::error_code ec;
+  if (!fs::is_directory(directory, ec)) {
+    return result;
+  }
+
+  // Paths already registered: rescans skip them without re-parsing
+  std::unordered_set<std::string> known_paths;
+  if (registry_) {
+    QueryOptions all;
+    all.limit = std::numeric_limits<int>::max();
+    for (const auto& model : registry_->list_models(all)) {
+      known_paths.insert(model.file_path);
+    }
+  }
+
+  // Enumerate candidates serially (directory listings are cheap, even
+  // on network mounts - it is the per-file header reads that stall)
+  std::vector<std::string> candidates;
+  auto consider = [&](const fs::path& path) {
+    std::string ext = path.extension().string();
+    if (ext != ".gguf" && ext != ".safetensors") {
+      return;
+    }
+    result.files_considered++;
+    if (known_paths.count(path.string())) {
+      result.skipped_existing++;
+      return;
+    }
+    candidates.push_back(path.string());
+  };
+
+  if (options.recursive) {
+    for (auto it = fs::recursive_directory_iterator(
+             directory, fs::directory_options::skip_permission_denied, ec);
+         it != fs::recursive_directory_iterator(); it.increment(ec)) {
+      if (ec) {
+        break;
+      }
+      if (it->is_regular_file(ec)) {
+        consider(it->path());
+      }
+    }
+  } else {
+    for (const auto& entry : fs::directory_iterator(
+             directory, fs::directory_options::skip_permission_denied, ec)) {
+      if (entry.is_regular_file(ec)) {
+        consider(entry.path());
+      }
+    }
+  }
+
+  // Probe headers concurrently: each worker pulls the next candidate
+  // off a shared counter, so fast local files never wait behind slow
+  // NAS round trips
+  int num_threads = options.num_threads;
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(
+        std::min<unsigned>(std::thread::hardware_concurrency(), 8));
+    num_threads = std::max(num_threads, 1);
+  }
+  num_threads =
+      std::min(num_threads, static_cast<int>(candidates.size()));
+
+  std::vector<ModelInfo> discovered;
+  std::mutex discovered_mutex;
+  std::atomic<size_t> next_candidate{0};
+  std::atomic<int> failures{0};
+
+  auto worker = [&]() {
+    while (true) {
+      size_t index = next_candidate.fetch_add(1);
+      if (index >= candidates.size()) {
+        break;
+      }
+      auto info = probe_file(candidates[index]);
+      if (info) {
+        std::lock_guard<std::mutex> lock(discovered_mutex);
+        discovered.push_back(std::move(*info));
+      } else {
+        failures.fetch_add(1);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  result.parse_failures = failures.load();
+
+  // Bulk insert in one transaction
+  if (registry_ && !discovered.empty()) {
+    auto ids = registry_->register_models(discovered);
+    for (int64_t id : ids) {
+      if (id >= 0) {
+        result.models_registered++;
+      }
+    }
+  }
+
+  result.elapsed_ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - scan_start)
+                          .count();
+  return result;
+}
+
+}  // namespace registry
+}  // namespace mlxr
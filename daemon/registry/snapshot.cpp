@@ -0,0 +1,324 @@
+// Copyright © 2025 MLXR Development
+// MLXR-native weight snapshot format implementation
+
+#include "snapshot.h"
+
+#include <cstdio>
+#include <filesystem>
+
+namespace mlxr {
+namespace registry {
+
+namespace {
+
+// Sanity bound for length-prefixed strings in the index
+constexpr uint32_t kMaxStringLength = 4096;
+
+constexpr uint64_t align_up(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+template <typename T>
+bool read_pod(std::ifstream& stream, T& out) {
+  stream.read(reinterpret_cast<char*>(&out), sizeof(T));
+  return stream.good();
+}
+
+template <typename T>
+void write_pod(std::ofstream& stream, const T& value) {
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void write_string(std::ofstream& stream, const std::string& value) {
+  const uint32_t length = static_cast<uint32_t>(value.size());
+  write_pod(stream, length);
+  stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+// Serialized byte size of one index entry
+uint64_t entry_index_size(const SnapshotTensorInfo& info) {
+  return sizeof(uint32_t) + info.name.size() +        // name
+         sizeof(uint32_t) + info.dtype.size() +       // dtype
+         sizeof(uint32_t) + info.quant_type.size() +  // quant_type
+         sizeof(uint32_t) +                           // dim count
+         info.shape.size() * sizeof(int64_t) +        // dims
+         sizeof(int32_t) +                            // quant_block_size
+         sizeof(uint64_t) +                           // offset
+         sizeof(uint64_t);                            // size
+}
+
+}  // anonymous namespace
+
+bool SnapshotFile::read_string(std::ifstream& stream, std::string& out) {
+  uint32_t length = 0;
+  if (!read_pod(stream, length)) {
+    error_ = "Failed to read string length";
+    return false;
+  }
+  if (length > kMaxStringLength) {
+    error_ = "Invalid string length: " + std::to_string(length);
+    return false;
+  }
+  out.resize(length);
+  stream.read(out.data(), length);
+  if (!stream.good()) {
+    error_ = "Failed to read string data";
+    return false;
+  }
+  return true;
+}
+
+bool SnapshotFile::parse(const std::string& file_path) {
+  std::ifstream stream(file_path, std::ios::binary);
+  if (!stream.is_open()) {
+    error_ = "Failed to open file: " + file_path;
+    return false;
+  }
+
+  if (!read_pod(stream, header_.magic) || !read_pod(stream, header_.version) ||
+      !read_pod(stream, header_.tensor_count) ||
+      !read_pod(stream, header_.source_size)) {
+    error_ = "Failed to read snapshot header";
+    return false;
+  }
+
+  if (header_.magic != SNAPSHOT_MAGIC) {
+    error_ = "Invalid snapshot magic number";
+    return false;
+  }
+  if (header_.version != SNAPSHOT_VERSION_V1) {
+    error_ = "Unsupported snapshot version: " +
+             std::to_string(header_.version);
+    return false;
+  }
+
+  tensors_.clear();
+  tensors_.reserve(header_.tensor_count);
+
+  for (uint64_t i = 0; i < header_.tensor_count; i++) {
+    SnapshotTensorInfo info;
+    if (!read_string(stream, info.name) || !read_string(stream, info.dtype) ||
+        !read_string(stream, info.quant_type)) {
+      error_ = "Failed to read tensor index entry " + std::to_string(i) +
+               (error_.empty() ? "" : ": " + error_);
+      return false;
+    }
+
+    uint32_t n_dims = 0;
+    if (!read_pod(stream, n_dims) || n_dims > 8) {
+      error_ = "Invalid dimension count for tensor: " + info.name;
+      return false;
+    }
+    info.shape.resize(n_dims);
+    for (uint32_t d = 0; d < n_dims; d++) {
+      if (!read_pod(stream, info.shape[d])) {
+        error_ = "Failed to read dimensions for tensor: " + info.name;
+        return false;
+      }
+    }
+
+    if (!read_pod(stream, info.quant_block_size) ||
+        !read_pod(stream, info.offset) || !read_pod(stream, info.size)) {
+      error_ = "Failed to read layout for tensor: " + info.name;
+      return false;
+    }
+
+    tensors_.push_back(std::move(info));
+  }
+
+  return true;
+}
+
+bool SnapshotFile::write(const std::string& file_path,
+                         const std::vector<SnapshotWriteEntry>& entries,
+                         uint64_t source_size, std::string* error) {
+  std::vector<SnapshotTensorInfo> infos;
+  infos.reserve(entries.size());
+  for (const auto& entry : entries) {
+    infos.push_back(entry.info);
+  }
+
+  SnapshotWriter writer;
+  if (!writer.begin(file_path, infos, source_size)) {
+    if (error != nullptr) {
+      *error = writer.error();
+    }
+    return false;
+  }
+
+  for (const auto& entry : entries) {
+    if (!writer.append(entry.data, entry.info.size)) {
+      if (error != nullptr) {
+        *error = writer.error();
+      }
+      return false;
+    }
+  }
+
+  if (!writer.finish()) {
+    if (error != nullptr) {
+      *error = writer.error();
+    }
+    return false;
+  }
+
+  return true;
+}
+
+SnapshotWriter::~SnapshotWriter() {
+  if (active_) {
+    abort_write();
+  }
+}
+
+void SnapshotWriter::abort_write() {
+  stream_.close();
+  std::remove(tmp_path_.c_str());
+  active_ = false;
+}
+
+bool SnapshotWriter::pad_to(uint64_t target_offset) {
+  const auto pos = static_cast<uint64_t>(stream_.tellp());
+  for (uint64_t p = pos; p < target_offset; p++) {
+    stream_.put('\0');
+  }
+  return stream_.good();
+}
+
+bool SnapshotWriter::begin(const std::string& file_path,
+                           const std::vector<SnapshotTensorInfo>& tensors,
+                           uint64_t source_size) {
+  // Lay out payload offsets: header + index, padded to the alignment,
+  // then each tensor on its own page boundary
+  uint64_t index_size = 0;
+  for (const auto& info : tensors) {
+    index_size += entry_index_size(info);
+  }
+
+  const uint64_t header_size =
+      sizeof(uint32_t) * 2 + sizeof(uint64_t) * 2;  // SnapshotHeader fields
+  uint64_t cursor = align_up(header_size + index_size, SNAPSHOT_ALIGNMENT);
+
+  offsets_.clear();
+  sizes_.clear();
+  offsets_.reserve(tensors.size());
+  sizes_.reserve(tensors.size());
+  for (const auto& info : tensors) {
+    offsets_.push_back(cursor);
+    sizes_.push_back(info.size);
+    cursor = align_up(cursor + info.size, SNAPSHOT_ALIGNMENT);
+  }
+  end_offset_ = cursor;
+  next_tensor_ = 0;
+
+  // Write to a .tmp sibling and rename so a crashed write never leaves a
+  // half-snapshot the next load would trust
+  file_path_ = file_path;
+  tmp_path_ = file_path + ".tmp";
+  stream_.open(tmp_path_, std::ios::binary | std::ios::trunc);
+  if (!stream_.is_open()) {
+    error_ = "Failed to open snapshot for writing: " + tmp_path_;
+    return false;
+  }
+  active_ = true;
+
+  write_pod(stream_, SNAPSHOT_MAGIC);
+  write_pod(stream_, SNAPSHOT_VERSION_V1);
+  write_pod(stream_, static_cast<uint64_t>(tensors.size()));
+  write_pod(stream_, source_size);
+
+  for (size_t i = 0; i < tensors.size(); i++) {
+    const auto& info = tensors[i];
+    write_string(stream_, info.name);
+    write_string(stream_, info.dtype);
+    write_string(stream_, info.quant_type);
+    write_pod(stream_, static_cast<uint32_t>(info.shape.size()));
+    for (int64_t dim : info.shape) {
+      write_pod(stream_, dim);
+    }
+    write_pod(stream_, info.quant_block_size);
+    write_pod(stream_, offsets_[i]);
+    write_pod(stream_, info.size);
+  }
+
+  if (!stream_.good()) {
+    error_ = "Failed to write snapshot index: " + tmp_path_;
+    abort_write();
+    return false;
+  }
+
+  return true;
+}
+
+bool SnapshotWriter::append(const void* data, uint64_t size) {
+  if (!active_) {
+    error_ = "append() without an active write";
+    return false;
+  }
+  if (next_tensor_ >= offsets_.size()) {
+    error_ = "append() past the declared tensor count";
+    abort_write();
+    return false;
+  }
+  if (size != sizes_[next_tensor_]) {
+    error_ = "Payload size mismatch for tensor " +
+             std::to_string(next_tensor_) + ": declared " +
+             std::to_string(sizes_[next_tensor_]) + ", got " +
+             std::to_string(size);
+    abort_write();
+    return false;
+  }
+
+  // Zero-pad up to the page-aligned payload offset
+  if (!pad_to(offsets_[next_tensor_])) {
+    error_ = "Failed to pad snapshot: " + tmp_path_;
+    abort_write();
+    return false;
+  }
+
+  stream_.write(static_cast<const char*>(data),
+                static_cast<std::streamsize>(size));
+  if (!stream_.good()) {
+    error_ = "Failed to write snapshot data: " + tmp_path_;
+    abort_write();
+    return false;
+  }
+
+  next_tensor_++;
+  return true;
+}
+
+bool SnapshotWriter::finish() {
+  if (!active_) {
+    error_ = "finish() without an active write";
+    return false;
+  }
+  if (next_tensor_ != offsets_.size()) {
+    error_ = "finish() with " + std::to_string(offsets_.size() - next_tensor_) +
+             " tensors not appended";
+    abort_write();
+    return false;
+  }
+
+  if (!pad_to(end_offset_)) {
+    error_ = "Failed to pad snapshot: " + tmp_path_;
+    abort_write();
+    return false;
+  }
+
+  stream_.close();
+  active_ = false;
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path_, file_path_, ec);
+  if (ec) {
+    error_ = "Failed to finalize snapshot: " + ec.message();
+    std::remove(tmp_path_.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace registry
+}  // namespace mlxr
@@ -0,0 +1,178 @@
+// Copyright © 2025 MLXR Development
+// MLXR-native weight snapshot format (convert-once, mmap-on-reload)
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace mlxr {
+namespace registry {
+
+// Snapshot format constants
+constexpr uint32_t SNAPSHOT_MAGIC = 0x52584C4D;  // "MLXR" in little-endian
+constexpr uint32_t SNAPSHOT_VERSION_V1 = 1;
+
+// Tensor payloads are aligned to the Apple Silicon page size so each
+// tensor can be mapped and madvise'd independently without sharing
+// pages with its neighbours
+constexpr uint64_t SNAPSHOT_ALIGNMENT = 16384;
+
+// One tensor in the snapshot index. The metadata mirrors WeightTensor:
+// dtype strings are the post-conversion MLX names ("float16", "q4_k",
+// ...) and quantized entries keep their packed GGUF block layout, so
+// loading a snapshot feeds the weight loader exactly the bytes the
+// original load produced — with zero source-format parsing
+struct SnapshotTensorInfo {
+  std::string name;
+  std::vector<int64_t> shape;
+  std::string dtype;
+  std::string quant_type;       // Empty for dense tensors
+  int32_t quant_block_size = 0;
+  uint64_t offset = 0;          // Absolute, page-aligned file offset
+  uint64_t size = 0;            // Payload size in bytes
+};
+
+// Snapshot file header
+struct SnapshotHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t tensor_count;
+  uint64_t source_size;  // Byte size of the source model file at write
+                         // time; a mismatch invalidates the snapshot
+};
+
+// Input to the writer: index metadata plus a pointer to the (already
+// materialized or mmap'd) payload bytes. `offset` is assigned by the
+// writer
+struct SnapshotWriteEntry {
+  SnapshotTensorInfo info;
+  const void* data = nullptr;
+};
+
+/**
+ * Reader/writer for the MLXR-native snapshot format
+ *
+ * Layout:
+ *   SnapshotHeader (fixed fields, little-endian)
+ *   Index: per tensor — length-prefixed name/dtype/quant_type strings,
+ *          dim count + int64 dims, quant_block_size, offset, size
+ *   Padding to SNAPSHOT_ALIGNMENT
+ *   Tensor payloads, each padded to SNAPSHOT_ALIGNMENT
+ *
+ * Unlike GGUF there is no metadata section: model hyper-parameters stay
+ * in the ModelRegistry row, and the snapshot only carries what the
+ * weight loader needs to register and map tensors.
+ */
+class SnapshotFile {
+ public:
+  SnapshotFile() = default;
+
+  /**
+   * Parse the header and tensor index (does not touch payload bytes)
+   * @param file_path Path to .mlxr-snap file
+   * @return true if successful, false otherwise
+   */
+  bool parse(const std::string& file_path);
+
+  /**
+   * Write a snapshot file
+   * @param file_path Destination path (written atomically via a .tmp
+   *        sibling + rename)
+   * @param entries Tensor index metadata plus payload pointers
+   * @param source_size Byte size of the source model file, recorded for
+   *        staleness checks on reload
+   * @param error Receives a description on failure
+   * @return true if successful, false otherwise
+   */
+  static bool write(const std::string& file_path,
+                    const std::vector<SnapshotWriteEntry>& entries,
+                    uint64_t source_size, std::string* error);
+
+  // Accessors
+  const SnapshotHeader& header() const { return header_; }
+  const std::vector<SnapshotTensorInfo>& tensors() const { return tensors_; }
+
+  // Error handling
+  const std::string& error() const { return error_; }
+  bool has_error() const { return !error_.empty(); }
+
+ private:
+  bool read_string(std::ifstream& stream, std::string& out);
+
+  SnapshotHeader header_{};
+  std::vector<SnapshotTensorInfo> tensors_;
+  std::string error_;
+};
+
+/**
+ * Streaming snapshot writer: header and index up front, then payloads
+ * appended one tensor at a time in index order
+ *
+ * SnapshotFile::write needs every payload pointer alive at once, which
+ * forces callers converting from another format to materialize the whole
+ * model. The streaming writer only needs each tensor's bytes while it is
+ * being appended, so a converter can run with O(largest tensor) memory
+ * (see tools/mlxr_convert.cpp). Payload sizes must be known at begin()
+ * time; the writer assigns the page-aligned offsets.
+ *
+ * The file is written to a .tmp sibling and renamed on finish(), so an
+ * interrupted conversion never leaves a half-snapshot behind.
+ */
+class SnapshotWriter {
+ public:
+  SnapshotWriter() = default;
+  ~SnapshotWriter();
+
+  // Non-copyable
+  SnapshotWriter(const SnapshotWriter&) = delete;
+  SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+  /**
+   * Open the .tmp sibling and write the header and tensor index
+   * @param file_path Final destination path
+   * @param tensors Index metadata with payload sizes filled in; offsets
+   *        are assigned by the writer
+   * @param source_size Byte size of the source model file
+   * @return true if successful (error() describes failures)
+   */
+  bool begin(const std::string& file_path,
+             const std::vector<SnapshotTensorInfo>& tensors,
+             uint64_t source_size);
+
+  /**
+   * Append the payload for the next tensor in index order. size must
+   * match the size declared at begin() time
+   * @return true if successful
+   */
+  bool append(const void* data, uint64_t size);
+
+  /**
+   * Pad out the final tensor and atomically rename into place. All
+   * declared tensors must have been appended
+   * @return true if successful
+   */
+  bool finish();
+
+  // Error handling
+  const std::string& error() const { return error_; }
+
+ private:
+  bool pad_to(uint64_t target_offset);
+  void abort_write();
+
+  std::ofstream stream_;
+  std::string file_path_;
+  std::string tmp_path_;
+  std::vector<uint64_t> offsets_;
+  std::vector<uint64_t> sizes_;
+  size_t next_tensor_ = 0;
+  uint64_t end_offset_ = 0;  // Aligned end of the last payload
+  bool active_ = false;
+  std::string error_;
+};
+
+}  // namespace registry
+}  // namespace mlxr
@@ -0,0 +1,77 @@
+// Router main - data-parallel front process for multiple mlxrunnerd
+// backends. Speaks the same OpenAI/Ollama surface and load-balances by
+// least-outstanding-tokens using each backend's scheduler stats.
+//
+// Usage:
+//   mlxr_router --listen-socket PATH [--listen-port PORT]
+//               --backend SOCKET [--backend SOCKET ...]
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "server/router.h"
+
+using namespace mlxr::server;
+
+namespace {
+
+std::atomic<bool> keep_running{true};
+
+void signal_handler(int signal) {
+  std::cout << "\nReceived signal " << signal << ", shutting down..."
+            << std::endl;
+  keep_running = false;
+}
+
+void print_usage(const char* program) {
+  std::cerr << "Usage: " << program
+            << " --listen-socket PATH [--listen-port PORT]"
+            << " --backend SOCKET [--backend SOCKET ...]" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::signal(SIGINT, signal_handler);
+  std::signal(SIGTERM, signal_handler);
+
+  RouterConfig config;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--listen-socket") == 0 && i + 1 < argc) {
+      config.listen_socket = argv[++i];
+    } else if (std::strcmp(argv[i], "--listen-port") == 0 && i + 1 < argc) {
+      config.listen_port = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--backend") == 0 && i + 1 < argc) {
+      config.backend_sockets.push_back(argv[++i]);
+    } else if (std::strcmp(argv[i], "--poll-interval-ms") == 0 &&
+               i + 1 < argc) {
+      config.stats_poll_interval_ms = std::atoi(argv[++i]);
+    } else {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (config.backend_sockets.empty() ||
+      (config.listen_socket.empty() && config.listen_port <= 0)) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  RequestRouter router(config);
+  if (!router.start()) {
+    std::cerr << "Failed to start router" << std::endl;
+    return 1;
+  }
+
+  while (keep_running) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  }
+
+  router.stop();
+  return 0;
+}
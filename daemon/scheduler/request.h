@@ -10,6 +10,11 @@
 #include <vector>
 
 namespace mlxr {
+
+namespace runtime {
+class GrammarConstraint;
+}
+
 namespace scheduler {
 
 // Request state through the system
@@ -41,10 +46,24 @@ struct SamplingParams {
   float repetition_penalty = 1.1f;  // Slight repetition penalty (was 1.0f)
   int max_tokens = 512;
   std::vector<int> stop_token_ids;
+  // String stop sequences (OpenAI "stop"), matched incrementally over
+  // detokenized bytes by the serving layer; a hit sets
+  // Request::stop_sequence_hit so the worker terminates the request
+  std::vector<std::string> stop_sequences;
   bool logprobs = false;
   int top_logprobs = 0;
 };
 
+// Per-token logprob record for the OpenAI logprobs field. Built by the
+// worker from the GPU-side extraction (log-softmax + top-k in the lazy
+// graph), so only these compact records ever cross to the host
+struct TokenLogprob {
+  int token_id = 0;
+  float logprob = 0.0f;           // log P(sampled token)
+  std::vector<int> top_token_ids;  // top-k alternatives, best first
+  std::vector<float> top_logprobs;
+};
+
 // Generation request
 class Request {
  public:
@@ -54,6 +73,23 @@ class Request {
   std::vector<int> prompt_token_ids;
   SamplingParams sampling_params;
 
+  // Routing key for multi-model serving: the "model" field from the
+  // OpenAI/Ollama payload. The worker dispatches to the matching
+  // resident engine; empty (or unknown) falls back to the default
+  std::string model_name;
+
+  // Tenant identity for fair-share scheduling, derived by the serving
+  // layer from the presented API key (a short non-reversible tag, not
+  // the key itself). Empty means the default tenant; all accounting
+  // and per-tenant metrics key off this value
+  std::string tenant_id;
+
+  // Optional grammar constraint (set by the serving layer for
+  // response_format requests). The worker masks logits through it
+  // before sampling and advances it on each committed token, so the
+  // output is valid by construction
+  std::shared_ptr<runtime::GrammarConstraint> grammar;
+
   // State tracking
   RequestState state;
   FinishReason finish_reason;
@@ -65,6 +101,17 @@ class Request {
   int num_generated_tokens;
   int max_tokens;
 
+  // One record per generated token when sampling_params.logprobs is
+  // set; the worker appends each record just before the matching
+  // add_generated_token, so the serving layer can read the back() entry
+  // inside its token callback
+  std::vector<TokenLogprob> generated_logprobs;
+
+  // Chunked prefill progress
+  int num_prefilled_tokens;  // Prompt tokens already ingested into KV cache
+  int prefill_chunk_tokens;  // Token budget for this step's chunk
+                             // (0 = process all remaining prompt tokens)
+
   // KV cache assignment
   std::vector<int> kv_block_ids;  // Physical block IDs assigned to this request
   int kv_num_blocks_needed;
@@ -72,12 +119,57 @@ class Request {
   // Timing
   std::chrono::steady_clock::time_point arrival_time;
   std::chrono::steady_clock::time_point start_time;
+  std::chrono::steady_clock::time_point decode_start_time;
   std::chrono::steady_clock::time_point last_token_time;
   std::chrono::steady_clock::time_point finish_time;
 
+  // Set by the serving layer's token callback (which runs synchronously
+  // on the worker thread) when a string stop sequence completes in the
+  // detokenized output; checked by should_stop() on the next step
+  bool stop_sequence_hit = false;
+
+  // Post-inference costs accumulated by the serving layer
+  // (detokenization and SSE/transport writes), so tail latency can be
+  // attributed between queueing, prefill, decode and output handling
+  double detokenize_ms = 0.0;
+  double stream_write_ms = 0.0;
+
+  // Deferred tokenization: the serving layer may submit a request
+  // before its prompt tokens have been produced (large prompts are
+  // tokenized asynchronously off the request thread). The scheduler
+  // skips not-yet-ready requests at admission instead of head-of-line
+  // blocking the waiting queue behind them
+  std::atomic<bool> tokens_ready{true};
+
+  // Consumer backpressure: cleared by the serving layer when the
+  // client draining this stream has fallen behind (e.g. a slow gRPC
+  // reader whose per-stream token queue hit its high-water mark). The
+  // scheduler keeps the request in the decoding queue but stops
+  // admitting it into batches until the flag is set again, so a slow
+  // consumer parks its own sequence instead of buffering tokens in
+  // daemon memory or stalling the worker on a blocking write
+  std::atomic<bool> consumer_ready{true};
+
+  // n>1 / best_of sampling: ID of the sibling whose prefill this
+  // request forks instead of re-running. The scheduler holds the
+  // request in the waiting queue until the parent finishes prefill;
+  // the worker then clones the parent's KV copy-on-write and samples
+  // its own first token from the parent's prefill logits
+  std::string fork_of_request_id;
+
+  // Number of siblings that will fork from this request's prefill; the
+  // worker retains the prefill logits until all of them have consumed
+  // their copy
+  int pending_forks = 0;
+
   // Priority (higher = more important)
   int priority;
 
+  // Optional per-token latency target in ms (0 = no deadline).
+  // Interactive traffic (e.g. chat at 80ms/token) sets this; batch
+  // traffic leaves it at 0 and is scheduled with leftover budget
+  float target_token_latency_ms = 0.0f;
+
   // Stream callback (called when new token is generated)
   using TokenCallback = std::function<void(int token_id, bool finished)>;
   TokenCallback token_callback;
@@ -94,10 +186,74 @@ class Request {
         num_prompt_tokens(tokens.size()),
         num_generated_tokens(0),
         max_tokens(params.max_tokens),
+        num_prefilled_tokens(0),
+        prefill_chunk_tokens(0),
         kv_num_blocks_needed(0),
         arrival_time(std::chrono::steady_clock::now()),
         priority(0) {}
 
+  // Deferred-tokenization constructor: submit now, install tokens via
+  // set_prompt_tokens() once asynchronous encoding finishes
+  Request(const std::string& id, const std::string& prompt_text,
+          const SamplingParams& params)
+      : Request(id, prompt_text, std::vector<int>{}, params) {
+    tokens_ready.store(false, std::memory_order_release);
+  }
+
+  // Reinitialize a recycled request (see RequestPool). Field-by-field
+  // rather than placement-new so the token vectors keep their grown
+  // capacity: assign()/clear() reuse the existing storage, which is the
+  // point of pooling. Must mirror the constructor exactly - a stale
+  // field here leaks one request's state into another's
+  void reset_for_reuse(const std::string& id, const std::string& prompt_text,
+                       const std::vector<int>& tokens,
+                       const SamplingParams& params) {
+    request_id = id;
+    prompt = prompt_text;
+    prompt_token_ids.assign(tokens.begin(), tokens.end());
+    sampling_params = params;
+    model_name.clear();
+    tenant_id.clear();
+    grammar.reset();
+    state = RequestState::WAITING;
+    finish_reason = FinishReason::NONE;
+    error_message.clear();
+    generated_token_ids.clear();
+    num_prompt_tokens = static_cast<int>(tokens.size());
+    num_generated_tokens = 0;
+    max_tokens = params.max_tokens;
+    generated_logprobs.clear();
+    num_prefilled_tokens = 0;
+    prefill_chunk_tokens = 0;
+    kv_block_ids.clear();
+    kv_num_blocks_needed = 0;
+    arrival_time = std::chrono::steady_clock::now();
+    start_time = {};
+    decode_start_time = {};
+    last_token_time = {};
+    finish_time = {};
+    stop_sequence_hit = false;
+    detokenize_ms = 0.0;
+    stream_write_ms = 0.0;
+    tokens_ready.store(true, std::memory_order_release);
+    consumer_ready.store(true, std::memory_order_release);
+    fork_of_request_id.clear();
+    pending_forks = 0;
+    priority = 0;
+    target_token_latency_ms = 0.0f;
+    token_callback = nullptr;
+  }
+
+  // Install asynchronously produced prompt tokens and mark the request
+  // admissible. Must be called exactly once for deferred requests,
+  // before any scheduling step can have admitted them (the scheduler
+  // only reads prompt_token_ids after observing tokens_ready)
+  void set_prompt_tokens(std::vector<int> tokens) {
+    prompt_token_ids = std::move(tokens);
+    num_prompt_tokens = static_cast<int>(prompt_token_ids.size());
+    tokens_ready.store(true, std::memory_order_release);
+  }
+
   // Getters
   int total_tokens() const { return num_prompt_tokens + num_generated_tokens; }
 
@@ -106,6 +262,10 @@ class Request {
            (state == RequestState::WAITING && num_generated_tokens == 0);
   }
 
+  bool prefill_complete() const {
+    return num_prefilled_tokens >= num_prompt_tokens;
+  }
+
   bool is_decode_phase() const {
     return state == RequestState::DECODING && num_generated_tokens > 0;
   }
@@ -116,6 +276,10 @@ class Request {
   }
 
   bool should_stop() const {
+    if (stop_sequence_hit) {
+      return true;
+    }
+
     if (num_generated_tokens >= max_tokens) {
       return true;
     }
@@ -145,6 +309,9 @@ class Request {
     if (start_time == std::chrono::steady_clock::time_point{}) {
       start_time = std::chrono::steady_clock::now();
     }
+    if (decode_start_time == std::chrono::steady_clock::time_point{}) {
+      decode_start_time = std::chrono::steady_clock::now();
+    }
   }
 
   void mark_completed(FinishReason reason) {
@@ -190,6 +357,69 @@ class Request {
         .count();
   }
 
+  // Time spent in the prefill phase (start of prefill until the first
+  // decode step; until finish/now if decode never began)
+  double prefill_time_ms() const {
+    if (start_time == std::chrono::steady_clock::time_point{}) {
+      return 0.0;
+    }
+    auto end = decode_start_time;
+    if (end == std::chrono::steady_clock::time_point{}) {
+      end = is_finished() ? finish_time : std::chrono::steady_clock::now();
+    }
+    return std::chrono::duration<double, std::milli>(end - start_time).count();
+  }
+
+  // Time spent in the decode phase (0 until the first decode step)
+  double decode_time_ms() const {
+    if (decode_start_time == std::chrono::steady_clock::time_point{}) {
+      return 0.0;
+    }
+    auto end = is_finished() ? finish_time : std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - decode_start_time)
+        .count();
+  }
+
+  // End-to-end time including the queue wait
+  double total_time_ms() const {
+    auto end = is_finished() ? finish_time : std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - arrival_time)
+        .count();
+  }
+
+  // Deadline helpers (SLA-aware scheduling)
+
+  bool is_interactive() const { return target_token_latency_ms > 0.0f; }
+
+  // Anchor for the per-token latency target: the last emitted token,
+  // or the request start (arrival while still queued) before the first
+  std::chrono::steady_clock::time_point latency_anchor() const {
+    if (last_token_time != std::chrono::steady_clock::time_point{}) {
+      return last_token_time;
+    }
+    if (start_time != std::chrono::steady_clock::time_point{}) {
+      return start_time;
+    }
+    return arrival_time;
+  }
+
+  // Absolute deadline for the next token; comparing these orders
+  // requests by urgency without re-reading the clock per comparison
+  std::chrono::steady_clock::time_point next_token_deadline() const {
+    return latency_anchor() +
+           std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+               std::chrono::duration<float, std::milli>(
+                   target_token_latency_ms));
+  }
+
+  // Time remaining before the next token misses its target (negative
+  // when already late; meaningless for batch-class requests)
+  double deadline_slack_ms() const {
+    return std::chrono::duration<double, std::milli>(
+               next_token_deadline() - std::chrono::steady_clock::now())
+        .count();
+  }
+
   double tokens_per_second() const {
     double elapsed = elapsed_ms();
     if (elapsed < 1.0) {
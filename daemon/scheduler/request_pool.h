@@ -0,0 +1,142 @@
+// Copyright © 2025 MLXR Development
+// Recycling pool for scheduler Request objects
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "request.h"
+
+namespace mlxr {
+namespace scheduler {
+
+/**
+ * @brief Free-list pool for Request objects
+ *
+ * Every API call allocates a Request behind a shared_ptr, with prompt
+ * and generated-token vectors that grow and are discarded at
+ * completion. At hundreds of requests per minute with multi-KB prompts
+ * that churn fragments the heap and shows up as allocator time on the
+ * scheduler thread. The pool recycles completed Request objects through
+ * a free list: reset_for_reuse() clears state field by field, so the
+ * token vectors retain their grown capacity across reuse and a recycled
+ * request's prompt tokenization writes into already-warm storage.
+ *
+ * The shared_ptr deleter returns the object to the pool instead of
+ * destroying it. Pool state is held by shared_ptr so in-flight requests
+ * can outlive the pool itself (the last one to complete frees the
+ * state). Oversized token vectors are dropped on recycle rather than
+ * pinned forever, and the free list is bounded.
+ *
+ * Thread-safe; the serving layers acquire from their handler threads
+ * while completions recycle from the worker thread.
+ */
+class RequestPool {
+ public:
+  explicit RequestPool(size_t max_pooled = 256)
+      : state_(std::make_shared<State>()) {
+    state_->max_pooled = max_pooled;
+  }
+
+  /**
+   * @brief Acquire a request with prompt tokens already available
+   * Mirrors the Request(id, prompt, tokens, params) constructor
+   */
+  RequestPtr acquire(const std::string& id, const std::string& prompt_text,
+                     const std::vector<int>& tokens,
+                     const SamplingParams& params) {
+    Request* request = take();
+    if (request) {
+      request->reset_for_reuse(id, prompt_text, tokens, params);
+    } else {
+      request = new Request(id, prompt_text, tokens, params);
+    }
+    return wrap(request);
+  }
+
+  /**
+   * @brief Acquire a request with deferred tokenization
+   * Mirrors the Request(id, prompt, params) constructor: the request is
+   * not admissible until set_prompt_tokens() lands
+   */
+  RequestPtr acquire_deferred(const std::string& id,
+                              const std::string& prompt_text,
+                              const SamplingParams& params) {
+    auto request = acquire(id, prompt_text, {}, params);
+    request->tokens_ready.store(false, std::memory_order_release);
+    return request;
+  }
+
+  /**
+   * @brief Number of recycled requests currently on the free list
+   */
+  size_t pooled_count() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->free_list.size();
+  }
+
+  /**
+   * @brief Process-wide pool shared by the REST and gRPC serving layers
+   */
+  static RequestPool& instance() {
+    static RequestPool pool;
+    return pool;
+  }
+
+ private:
+  // Token vectors above this capacity are freed on recycle instead of
+  // retained: one 128K-token prompt should not pin half a megabyte in
+  // the free list for the lifetime of the daemon
+  static constexpr size_t kMaxRetainedTokenCapacity = 65536;
+
+  struct State {
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Request>> free_list;
+    size_t max_pooled = 256;
+  };
+
+  Request* take() {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->free_list.empty()) {
+      return nullptr;
+    }
+    Request* request = state_->free_list.back().release();
+    state_->free_list.pop_back();
+    return request;
+  }
+
+  RequestPtr wrap(Request* request) {
+    auto state = state_;
+    return RequestPtr(request,
+                      [state](Request* r) { recycle(state, r); });
+  }
+
+  static void recycle(const std::shared_ptr<State>& state, Request* request) {
+    // Drop closures and grammar state eagerly: the callback may own SSE
+    // stream captures that must not live until the next reuse
+    request->token_callback = nullptr;
+    request->grammar.reset();
+
+    if (request->prompt_token_ids.capacity() > kMaxRetainedTokenCapacity) {
+      std::vector<int>().swap(request->prompt_token_ids);
+    }
+    if (request->generated_token_ids.capacity() > kMaxRetainedTokenCapacity) {
+      std::vector<int>().swap(request->generated_token_ids);
+    }
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->free_list.size() >= state->max_pooled) {
+      delete request;
+      return;
+    }
+    state->free_list.emplace_back(request);
+  }
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace scheduler
+}  // namespace mlxr
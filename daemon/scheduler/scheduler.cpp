@@ -6,12 +6,16 @@
 #include <algorithm>
 #include <cmath>
 
+#include "../telemetry/metrics.h"
+#include "../telemetry/trace.h"
+
 namespace mlxr {
 namespace scheduler {
 
 Scheduler::Scheduler(const SchedulerConfig& config)
     : config_(config),
       num_free_kv_blocks_(config.total_kv_blocks),
+      effective_batch_tokens_(config.max_batch_tokens),
       running_(true) {
   // Initialize KV block free list
   kv_block_free_.resize(config_.total_kv_blocks, true);
@@ -64,6 +68,14 @@ bool Scheduler::cancel_request(const std::string& request_id) {
   // Free KV blocks if allocated
   free_kv_blocks(request);
 
+  // Queue the engine-side cache release: it runs at the top of the
+  // next get_next_batch on the worker thread, so a decode step that is
+  // in flight right now can never race the teardown and the pager
+  // blocks are reclaimed before any new admission
+  if (release_cb_) {
+    cancelled_pending_release_.push_back(request_id);
+  }
+
   // Remove from queues
   auto remove_from_queue = [&request](std::vector<RequestPtr>& queue) {
     queue.erase(std::remove_if(queue.begin(), queue.end(),
@@ -92,13 +104,101 @@ bool Scheduler::cancel_request(const std::string& request_id) {
 Batch Scheduler::get_next_batch() {
   std::lock_guard<std::mutex> lock(mutex_);
 
+  // Release engine-side caches of requests cancelled since the last
+  // batch. This runs on the worker thread before the batch forms, so
+  // the teardown can never race an in-flight forward pass
+  if (!cancelled_pending_release_.empty()) {
+    if (release_cb_) {
+      for (const auto& id : cancelled_pending_release_) {
+        release_cb_(id);
+      }
+    }
+    cancelled_pending_release_.clear();
+  }
+
   Batch batch;
 
+  // Managed degradation under system pressure: shrink the step's token
+  // budget so the GPU duty cycle drops before the OS clamps the clock,
+  // pause batch-class admission once heavy pressure has persisted, and
+  // stop all new admission at critical (in-flight decodes keep running
+  // so streams finish instead of stalling mid-sentence)
+  int token_budget = effective_batch_tokens_;
+  bool pause_batch_class = false;
+  bool pause_all_admission = false;
+  if (config_.enable_pressure_throttling && pressure_level_ > 0) {
+    token_budget = std::max(
+        config_.min_batch_tokens,
+        static_cast<int>(token_budget * config_.pressure_budget_scale));
+    if (heavy_pressure_active_) {
+      auto sustained_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::steady_clock::now() -
+                              heavy_pressure_since_)
+                              .count();
+      pause_batch_class = sustained_ms >= config_.pressure_sustain_ms;
+    }
+    pause_all_admission = pressure_level_ >= 3;  // CRITICAL
+  }
+  stats_.pressure_paused_admission = pause_batch_class || pause_all_admission;
+
   // Budget tracking
   int batch_tokens = 0;
   int batch_size = 0;
   int prefill_tokens = 0;
 
+  // Priority 0: Resume preempted requests once blocks are free again.
+  // Their KV blocks were swapped to the CPU tier (not discarded), so
+  // resumption is a block promotion and they rejoin the decode queue
+  // without re-prefilling
+  resume_paused_requests();
+
+  // Weighted fair share: order requests by their tenant's recent
+  // normalized token consumption (lightest user first), so one tenant's
+  // burst queues behind everyone else's traffic instead of monopolizing
+  // decode slots and prefill budget. Runs before the deadline sort,
+  // which is stable, so urgency stays the primary key and fair share
+  // decides order within a class. Usages are snapshotted once so the
+  // comparator is a strict weak ordering despite time-based decay
+  if (config_.enable_fair_share) {
+    std::unordered_map<std::string, double> usage;
+    auto snapshot_usage = [&](const RequestPtr& request) {
+      if (usage.find(request->tenant_id) == usage.end()) {
+        usage[request->tenant_id] = tenant_usage(request->tenant_id);
+      }
+    };
+    for (const auto& request : decoding_queue_) {
+      snapshot_usage(request);
+    }
+    for (const auto& request : waiting_queue_) {
+      snapshot_usage(request);
+    }
+
+    auto by_tenant_usage = [&usage](const RequestPtr& a, const RequestPtr& b) {
+      return usage[a->tenant_id] < usage[b->tenant_id];
+    };
+    std::stable_sort(decoding_queue_.begin(), decoding_queue_.end(),
+                     by_tenant_usage);
+    std::stable_sort(waiting_queue_.begin(), waiting_queue_.end(),
+                     by_tenant_usage);
+  }
+
+  // Deadline-aware ordering: interactive requests with the least slack
+  // go first so they are never the ones dropped when the batch fills
+  // up; batch-class requests keep their relative order
+  if (config_.enable_deadline_scheduling) {
+    std::stable_sort(decoding_queue_.begin(), decoding_queue_.end(),
+                     [](const RequestPtr& a, const RequestPtr& b) {
+                       if (a->is_interactive() != b->is_interactive()) {
+                         return a->is_interactive();
+                       }
+                       if (!a->is_interactive()) {
+                         return false;
+                       }
+                       return a->next_token_deadline() <
+                              b->next_token_deadline();
+                     });
+  }
+
   // Priority 1: Add decoding requests (low latency, predictable compute)
   for (auto it = decoding_queue_.begin();
        it != decoding_queue_.end() && batch_size < config_.max_batch_size;) {
@@ -116,8 +216,17 @@ Batch Scheduler::get_next_batch() {
       continue;
     }
 
+    // Slow-consumer parking: the serving layer clears consumer_ready
+    // when the client draining this stream has fallen behind. Keep the
+    // request (and its KV blocks) but skip it this step — tokens it
+    // cannot drain would only pile up in daemon memory
+    if (!request->consumer_ready.load(std::memory_order_acquire)) {
+      ++it;
+      continue;
+    }
+
     // Check token budget (each decode generates 1 token)
-    if (batch_tokens + 1 <= config_.max_batch_tokens) {
+    if (batch_tokens + 1 <= token_budget) {
       batch.decode_requests.push_back(request);
       batch_tokens += 1;
       batch_size++;
@@ -127,36 +236,149 @@ Batch Scheduler::get_next_batch() {
     }
   }
 
-  // Priority 2: Add prefilling requests (if budget allows)
+  // Deadline-aware backfill budget: bound this step's prefill tokens
+  // by the slack of the tightest interactive decode so chat requests
+  // stay under their per-token target while batch-class prefills soak
+  // up whatever budget remains
+  int allowed_prefill_tokens = config_.max_prefill_tokens;
+  if (config_.enable_deadline_scheduling) {
+    bool have_interactive = false;
+    double min_slack_ms = 0.0;
+    for (const auto& request : batch.decode_requests) {
+      if (!request->is_interactive()) {
+        continue;
+      }
+      double slack = request->deadline_slack_ms();
+      if (!have_interactive || slack < min_slack_ms) {
+        min_slack_ms = slack;
+        have_interactive = true;
+      }
+    }
+    if (have_interactive) {
+      double headroom_ms = min_slack_ms - config_.decode_step_cost_ms;
+      if (headroom_ms <= 0.0) {
+        allowed_prefill_tokens = 0;  // at/over the deadline: decode only
+      } else {
+        allowed_prefill_tokens = std::min(
+            allowed_prefill_tokens,
+            static_cast<int>(headroom_ms / config_.prefill_token_cost_ms));
+      }
+    }
+  }
+
+  // Whether a partially-ingested long prompt was admitted this step.
+  // With chunked prefill, each step mixes at most ONE chunk of a long
+  // prompt with the full decode batch so decode latency stays flat
+  // while a 16K-token prompt is being ingested.
+  bool long_prefill_admitted = false;
+
+  // Priority 2: Continue prefilling requests (if budget allows)
+  // Requests stay in this queue until their whole prompt is ingested
   for (auto it = prefilling_queue_.begin();
        it != prefilling_queue_.end() && batch_size < config_.max_batch_size;) {
     RequestPtr request = *it;
-    int request_tokens = request->num_prompt_tokens;
+    int remaining_tokens =
+        request->num_prompt_tokens - request->num_prefilled_tokens;
+
+    int chunk_tokens = remaining_tokens;
+    if (config_.enable_chunked_prefill) {
+      chunk_tokens = std::min(remaining_tokens, config_.max_prefill_chunk_size);
+      // Shrink the chunk to the remaining deadline budget and to the
+      // adaptive step budget so long prompts keep making progress even
+      // under tight slack or on a throttled machine
+      chunk_tokens =
+          std::min(chunk_tokens, allowed_prefill_tokens - prefill_tokens);
+      chunk_tokens = std::min(chunk_tokens, token_budget - batch_tokens);
+    }
+    if (chunk_tokens <= 0) {
+      break;  // Deadline budget exhausted for this step
+    }
 
-    // Check if we can fit this request
-    if (prefill_tokens + request_tokens <= config_.max_prefill_tokens &&
-        batch_tokens + request_tokens <= config_.max_batch_tokens) {
+    // Check if we can fit this chunk
+    if (prefill_tokens + chunk_tokens <= allowed_prefill_tokens &&
+        batch_tokens + chunk_tokens <= token_budget) {
+      request->prefill_chunk_tokens =
+          config_.enable_chunked_prefill ? chunk_tokens : 0;
       batch.prefill_requests.push_back(request);
-      batch_tokens += request_tokens;
-      prefill_tokens += request_tokens;
+      batch_tokens += chunk_tokens;
+      prefill_tokens += chunk_tokens;
       batch_size++;
 
-      // Move to decoding queue after prefill
-      move_to_decoding(request);
-      it = prefilling_queue_.erase(it);
+      if (chunk_tokens >= remaining_tokens) {
+        // Final chunk: request starts decoding from the next step
+        move_to_decoding(request);
+        decoding_queue_.push_back(request);
+        it = prefilling_queue_.erase(it);
+      } else {
+        // More chunks to come; cap at one long-prompt chunk per step
+        long_prefill_admitted = true;
+        break;
+      }
     } else {
       ++it;
     }
   }
 
-  // Priority 3: Admit new requests from waiting queue
-  while (!waiting_queue_.empty() && batch_size < config_.max_batch_size) {
-    RequestPtr request = waiting_queue_.front();
+  // Interactive arrivals jump ahead of batch-class arrivals so chat
+  // TTFT is not queued behind offline eval prompts (FIFO is preserved
+  // within each class)
+  if (config_.enable_deadline_scheduling) {
+    std::stable_partition(
+        waiting_queue_.begin(), waiting_queue_.end(),
+        [](const RequestPtr& r) { return r->is_interactive(); });
+  }
+
+  // Priority 3: Admit new requests from waiting queue. Iterates instead
+  // of popping the front so a request whose prompt is still being
+  // tokenized asynchronously is skipped for this step rather than
+  // head-of-line blocking every arrival behind it
+  for (auto it = waiting_queue_.begin();
+       it != waiting_queue_.end() && batch_size < config_.max_batch_size &&
+       !long_prefill_admitted && !pause_all_admission;) {
+    RequestPtr request = *it;
+
+    if (!request->tokens_ready.load(std::memory_order_acquire)) {
+      ++it;  // Tokenization still in flight; consider the next arrival
+      continue;
+    }
+
+    // Sustained heavy pressure: batch-class arrivals wait it out while
+    // interactive requests keep their admission path
+    if (pause_batch_class && !request->is_interactive()) {
+      ++it;
+      continue;
+    }
+
+    // Fork siblings (n>1 sampling) wait for their parent's prefill;
+    // admitting earlier would just redo the shared prompt. A parent
+    // that already finished and vanished unblocks the sibling, which
+    // then falls back to a full prefill in the worker
+    if (!request->fork_of_request_id.empty()) {
+      auto parent_it = all_requests_.find(request->fork_of_request_id);
+      if (parent_it != all_requests_.end() &&
+          (parent_it->second->state == RequestState::WAITING ||
+           parent_it->second->state == RequestState::PREFILLING)) {
+        ++it;
+        continue;
+      }
+    }
+
     int request_tokens = request->num_prompt_tokens;
 
-    // Check token budget
-    if (prefill_tokens + request_tokens > config_.max_prefill_tokens ||
-        batch_tokens + request_tokens > config_.max_batch_tokens) {
+    int chunk_tokens = request_tokens;
+    if (config_.enable_chunked_prefill) {
+      chunk_tokens = std::min(request_tokens, config_.max_prefill_chunk_size);
+      chunk_tokens =
+          std::min(chunk_tokens, allowed_prefill_tokens - prefill_tokens);
+      chunk_tokens = std::min(chunk_tokens, token_budget - batch_tokens);
+    }
+    if (chunk_tokens <= 0) {
+      break;  // Deadline budget exhausted for this step
+    }
+
+    // Check token budget against this step's chunk, not the whole prompt
+    if (prefill_tokens + chunk_tokens > allowed_prefill_tokens ||
+        batch_tokens + chunk_tokens > token_budget) {
       break;
     }
 
@@ -180,15 +402,29 @@ Batch Scheduler::get_next_batch() {
     }
 
     // Add to batch
-    waiting_queue_.pop_front();
+    it = waiting_queue_.erase(it);
     request->mark_prefilling();
+    request->prefill_chunk_tokens =
+        config_.enable_chunked_prefill ? chunk_tokens : 0;
     batch.prefill_requests.push_back(request);
-    batch_tokens += request_tokens;
-    prefill_tokens += request_tokens;
+    batch_tokens += chunk_tokens;
+    prefill_tokens += chunk_tokens;
     batch_size++;
 
-    // Move to decoding after this batch
-    decoding_queue_.push_back(request);
+    if (chunk_tokens >= request_tokens) {
+      // Whole prompt fits this step: move to decoding after this batch
+      decoding_queue_.push_back(request);
+    } else {
+      // Long prompt: stays in prefilling until all chunks are ingested
+      prefilling_queue_.push_back(request);
+      long_prefill_admitted = true;
+      break;
+    }
+  }
+
+  if (!batch.empty()) {
+    telemetry::TraceRecorder::instance().record_instant("batch_formed",
+                                                        "tokens", batch_tokens);
   }
 
   update_stats();
@@ -201,6 +437,21 @@ void Scheduler::complete_batch(const Batch& batch) {
   // Update token counts
   stats_.total_tokens_generated += batch.decode_requests.size();
 
+  // Charge each tenant for the tokens its requests consumed this step
+  // (one per decode, the ingested chunk per prefill) and bump the
+  // exported per-tenant throughput counters
+  if (config_.enable_fair_share) {
+    for (const auto& request : batch.decode_requests) {
+      charge_tenant(request->tenant_id, 1);
+    }
+    for (const auto& request : batch.prefill_requests) {
+      int tokens = request->prefill_chunk_tokens > 0
+                       ? request->prefill_chunk_tokens
+                       : request->num_prompt_tokens;
+      charge_tenant(request->tenant_id, tokens);
+    }
+  }
+
   // Prefill requests are already in decoding_queue_, nothing to do
 }
 
@@ -236,17 +487,27 @@ bool Scheduler::allocate_kv_blocks(RequestPtr request) {
   num_free_kv_blocks_ -= blocks_needed;
   request->kv_num_blocks_needed = blocks_needed;
 
+  telemetry::TraceRecorder::instance().record_instant("kv_alloc", "blocks",
+                                                      blocks_needed);
+
   return true;
 }
 
 void Scheduler::free_kv_blocks(RequestPtr request) {
+  int blocks_freed = 0;
   for (int block_id : request->kv_block_ids) {
     if (block_id >= 0 && block_id < static_cast<int>(kv_block_free_.size())) {
       kv_block_free_[block_id] = true;
       num_free_kv_blocks_++;
+      blocks_freed++;
     }
   }
   request->kv_block_ids.clear();
+
+  if (blocks_freed > 0) {
+    telemetry::TraceRecorder::instance().record_instant("kv_free", "blocks",
+                                                        blocks_freed);
+  }
 }
 
 bool Scheduler::try_preempt(int blocks_needed) {
@@ -262,6 +523,15 @@ bool Scheduler::try_preempt(int blocks_needed) {
     free_kv_blocks(candidate);
     blocks_freed += candidate->kv_num_blocks_needed;
 
+    telemetry::TraceRecorder::instance().record_instant(
+        "kv_evict", "blocks", candidate->kv_num_blocks_needed);
+
+    // Demote the victim's engine-side KV blocks to the CPU tier so
+    // resumption is a promotion, not a re-prefill
+    if (config_.preempt_via_swap && swap_out_cb_) {
+      swap_out_cb_(candidate->request_id);
+    }
+
     // Move to paused queue
     candidate->state = RequestState::PAUSED;
     paused_queue_.push_back(candidate);
@@ -330,6 +600,64 @@ std::vector<RequestPtr> Scheduler::select_preemption_candidates(
   return candidates;
 }
 
+void Scheduler::set_swap_callbacks(SwapCallback swap_out,
+                                   SwapCallback swap_in) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  swap_out_cb_ = std::move(swap_out);
+  swap_in_cb_ = std::move(swap_in);
+}
+
+void Scheduler::set_release_callback(SwapCallback release) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  release_cb_ = std::move(release);
+}
+
+void Scheduler::record_system_pressure(telemetry::PressureLevel level) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  int severity = static_cast<int>(level);
+  pressure_level_ = severity;
+
+  // Track how long HEAVY (or worse) pressure has persisted; the pause
+  // in get_next_batch only engages after pressure_sustain_ms so a
+  // transient spike does not stall batch traffic
+  if (severity >= static_cast<int>(telemetry::PressureLevel::HEAVY)) {
+    if (!heavy_pressure_active_) {
+      heavy_pressure_active_ = true;
+      heavy_pressure_since_ = std::chrono::steady_clock::now();
+    }
+  } else {
+    heavy_pressure_active_ = false;
+  }
+}
+
+void Scheduler::record_step_latency(double step_ms) {
+  if (!config_.enable_adaptive_batch_tokens) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (step_ms > config_.target_step_latency_ms) {
+    // Overrun: back off multiplicatively so a thermally-throttled or
+    // smaller machine converges in a few steps
+    effective_batch_tokens_ =
+        std::max(config_.min_batch_tokens,
+                 static_cast<int>(effective_batch_tokens_ *
+                                  config_.batch_tokens_backoff));
+  } else {
+    // On target: probe upward additively toward the configured ceiling
+    effective_batch_tokens_ =
+        std::min(config_.max_batch_tokens,
+                 effective_batch_tokens_ + config_.batch_tokens_increase);
+  }
+}
+
+int Scheduler::effective_batch_tokens() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return effective_batch_tokens_;
+}
+
 SchedulerStats Scheduler::get_stats() const {
   std::lock_guard<std::mutex> lock(mutex_);
   update_stats();
@@ -374,7 +702,7 @@ bool Scheduler::can_add_to_batch(const Batch& batch,
   int request_tokens =
       request->is_prefill_phase() ? request->num_prompt_tokens : 1;
 
-  return current_tokens + request_tokens <= config_.max_batch_tokens &&
+  return current_tokens + request_tokens <= effective_batch_tokens_ &&
          batch.size() < static_cast<size_t>(config_.max_batch_size);
 }
 
@@ -397,12 +725,37 @@ void Scheduler::move_to_waiting(RequestPtr request) {
   waiting_queue_.push_back(request);
 }
 
+void Scheduler::resume_paused_requests() {
+  // FIFO over victims; stop at the first allocation failure so freed
+  // blocks are not snatched by later (smaller) victims while the
+  // oldest one starves
+  for (auto it = paused_queue_.begin(); it != paused_queue_.end();) {
+    RequestPtr request = *it;
+
+    if (!allocate_kv_blocks(request)) {
+      break;
+    }
+
+    // Promote the demoted KV blocks back to GPU before decoding
+    if (config_.preempt_via_swap && swap_in_cb_) {
+      swap_in_cb_(request->request_id);
+    }
+
+    request->mark_decoding();
+    decoding_queue_.push_back(request);
+    it = paused_queue_.erase(it);
+  }
+}
+
 void Scheduler::update_stats() const {
   stats_.waiting_requests = waiting_queue_.size();
   stats_.prefilling_requests = prefilling_queue_.size();
   stats_.decoding_requests = decoding_queue_.size();
   stats_.paused_requests = paused_queue_.size();
 
+  stats_.effective_batch_tokens = effective_batch_tokens_;
+  stats_.pressure_level = pressure_level_;
+
   stats_.used_kv_blocks = config_.total_kv_blocks - num_free_kv_blocks_;
   stats_.available_kv_blocks = num_free_kv_blocks_;
   stats_.kv_utilization =
@@ -435,5 +788,58 @@ void Scheduler::update_stats() const {
   }
 }
 
+// ============================================================================
+// Fair-share accounting
+// ============================================================================
+
+Scheduler::TenantAccount& Scheduler::tenant_account(const std::string& tenant) {
+  auto it = tenant_accounts_.find(tenant);
+  if (it == tenant_accounts_.end()) {
+    TenantAccount account;
+    account.last_decay = std::chrono::steady_clock::now();
+    const std::string label = tenant.empty() ? "default" : tenant;
+    account.tokens_total =
+        telemetry::MetricsRegistry::instance().register_counter(
+            "mlxr_tenant_tokens_total_" + label,
+            "Tokens scheduled for tenant " + label);
+    it = tenant_accounts_.emplace(tenant, account).first;
+  }
+  return it->second;
+}
+
+double Scheduler::tenant_usage(const std::string& tenant) {
+  auto& account = tenant_account(tenant);
+
+  // Exponential decay with the configured half-life, so a tenant that
+  // went quiet regains full share instead of being penalized for old
+  // bursts
+  auto now = std::chrono::steady_clock::now();
+  double dt_ms =
+      std::chrono::duration<double, std::milli>(now - account.last_decay)
+          .count();
+  if (dt_ms > 0.0 && config_.fair_share_halflife_ms > 0.0f) {
+    account.charged_tokens *=
+        std::pow(0.5, dt_ms / config_.fair_share_halflife_ms);
+    account.last_decay = now;
+  }
+
+  float weight = 1.0f;
+  auto w = config_.tenant_weights.find(tenant);
+  if (w != config_.tenant_weights.end() && w->second > 0.0f) {
+    weight = w->second;
+  }
+  return account.charged_tokens / weight;
+}
+
+void Scheduler::charge_tenant(const std::string& tenant, int tokens) {
+  if (tokens <= 0) {
+    return;
+  }
+  tenant_usage(tenant);  // Refresh the decay before adding
+  auto& account = tenant_account(tenant);
+  account.charged_tokens += tokens;
+  account.tokens_total->increment(tokens);
+}
+
 }  // namespace scheduler
 }  // namespace mlxr
@@ -14,6 +14,12 @@
 #include "request.h"
 
 namespace mlxr {
+
+namespace telemetry {
+class Counter;
+enum class PressureLevel : int;
+}
+
 namespace scheduler {
 
 // Batch of requests for execution
@@ -58,6 +64,53 @@ struct SchedulerConfig {
   bool enable_priority_scheduling = true;
   float decode_preference = 2.0f;  // Prefer decode over prefill (lower latency)
 
+  // Deadline-aware batch formation: requests carrying a per-token
+  // latency target are served first, and prefill backfill is bounded
+  // by the tightest interactive deadline in the decode batch
+  bool enable_deadline_scheduling = true;
+  // Estimated marginal step-time cost of one prefill token; converts
+  // the tightest deadline's slack into a prefill token budget
+  float prefill_token_cost_ms = 0.02f;
+  // Estimated cost of the decode pass itself, reserved out of the
+  // tightest deadline before any prefill backfill is admitted
+  float decode_step_cost_ms = 30.0f;
+
+  // Adaptive token budget: a closed-loop AIMD controller driven by the
+  // measured per-step execution time. The effective budget shrinks
+  // multiplicatively when a step overruns target_step_latency_ms and
+  // grows additively while steps come in under it, so one binary serves
+  // both big and small machines without hand-tuning max_batch_tokens
+  bool enable_adaptive_batch_tokens = true;
+  float target_step_latency_ms = 80.0f;  // target_latency_ms in server.yaml
+  int min_batch_tokens = 256;            // floor for the effective budget
+  int batch_tokens_increase = 128;       // additive increase per good step
+  float batch_tokens_backoff = 0.5f;     // multiplicative decrease on overrun
+
+  // Thermal/memory pressure throttling: a feedback loop fed by
+  // SystemMonitor samples. Under MODERATE or worse pressure the
+  // per-step token budget is scaled down so the GPU duty cycle drops
+  // before the OS clamps the clock mid-step; once HEAVY pressure has
+  // persisted for pressure_sustain_ms, new batch-class admissions pause
+  // (interactive requests keep flowing), and CRITICAL pauses all new
+  // admission while in-flight decodes run to completion. Managed
+  // degradation keeps interactive latency predictable on fanless and
+  // laptop deployments instead of 60ms/token spiking to 200ms/token
+  bool enable_pressure_throttling = true;
+  float pressure_budget_scale = 0.5f;  // budget multiplier under pressure
+  int pressure_sustain_ms = 2000;      // HEAVY must persist this long
+
+  // Weighted fair share across tenants (API keys): batch formation
+  // orders same-class requests by their tenant's recent normalized
+  // token consumption, so one tenant's burst queues behind everyone
+  // else's light traffic instead of starving it. Consumption decays
+  // with a half-life so a tenant that went quiet regains full share
+  // quickly instead of being punished for old usage
+  bool enable_fair_share = true;
+  float fair_share_halflife_ms = 2000.0f;
+  // Relative share per tenant_id; unlisted tenants weigh 1.0. A weight
+  // of 2.0 lets that tenant consume twice the tokens before yielding
+  std::unordered_map<std::string, float> tenant_weights;
+
   // Speculative decoding
   bool enable_speculative_decoding = false;
   int speculation_length = 4;
@@ -65,6 +118,11 @@ struct SchedulerConfig {
   // Preemption policy
   bool enable_preemption = true;
   int min_decode_steps_before_preempt = 10;  // Minimum tokens before preemption
+  // Swap-based preemption: demote the victim's KV blocks to the CPU
+  // tier via the swap callbacks instead of discarding them, so resuming
+  // a 4K-context victim is a block promotion (~ms of memcpy) rather
+  // than a full re-prefill (~hundreds of ms)
+  bool preempt_via_swap = true;
 };
 
 // Scheduler statistics
@@ -80,6 +138,15 @@ struct SchedulerStats {
   int available_kv_blocks = 0;
   float kv_utilization = 0.0f;
 
+  // Effective per-step token budget chosen by the AIMD controller
+  int effective_batch_tokens = 0;
+
+  // Last system pressure severity fed to the scheduler (0 = nominal,
+  // 3 = critical) and whether it is currently pausing batch-class
+  // admission
+  int pressure_level = 0;
+  bool pressure_paused_admission = false;
+
   // Throughput
   double tokens_per_second = 0.0;
   double requests_per_second = 0.0;
@@ -97,6 +164,12 @@ struct SchedulerStats {
 // Main scheduler class
 class Scheduler {
  public:
+  // Invoked with the request ID when a request's engine-side KV cache
+  // should be demoted to the CPU tier (preemption) or promoted back
+  // (resumption). Called with the scheduler lock held — callbacks must
+  // not call back into the scheduler.
+  using SwapCallback = std::function<void(const std::string& request_id)>;
+
   explicit Scheduler(const SchedulerConfig& config);
   ~Scheduler();
 
@@ -148,6 +221,55 @@ class Scheduler {
    */
   bool try_preempt(int blocks_needed);
 
+  /**
+   * Register callbacks for swap-based preemption (see preempt_via_swap).
+   * The worker wires these to the engine's cache swap-out/swap-in so
+   * preempted requests resume from their demoted KV blocks instead of
+   * re-prefilling
+   * @param swap_out Called when a victim is preempted
+   * @param swap_in Called when a paused request is resumed
+   */
+  void set_swap_callbacks(SwapCallback swap_out, SwapCallback swap_in);
+
+  /**
+   * Register the callback that releases a cancelled request's
+   * engine-side KV cache. cancel_request() marks the request terminal
+   * immediately but defers the release to the top of the next
+   * get_next_batch() call: that runs on the worker thread before the
+   * batch forms, so the cache is never torn down under an in-flight
+   * forward pass and the blocks are back in the free pool before any
+   * new admission. Same contract as the swap callbacks: invoked with
+   * the scheduler lock held, must not call back into the scheduler
+   * @param release Called with each cancelled request's ID
+   */
+  void set_release_callback(SwapCallback release);
+
+  /**
+   * Feed the latest system pressure sample into the throttling loop
+   * (see enable_pressure_throttling). The worker samples SystemMonitor
+   * once per step and reports the worst of the thermal and memory
+   * signals; the next get_next_batch() applies the resulting budget
+   * scale and admission policy
+   * @param level Current pressure severity
+   */
+  void record_system_pressure(telemetry::PressureLevel level);
+
+  /**
+   * Report the measured execution time of the batch that just ran.
+   * Drives the AIMD token-budget controller: overruns against
+   * target_step_latency_ms halve the effective budget (down to
+   * min_batch_tokens), on-target steps grow it additively back toward
+   * max_batch_tokens
+   * @param step_ms Wall-clock time the worker spent executing the batch
+   */
+  void record_step_latency(double step_ms);
+
+  /**
+   * Current effective per-step token budget (== max_batch_tokens when
+   * the adaptive controller is disabled)
+   */
+  int effective_batch_tokens() const;
+
   /**
    * Get current scheduler statistics
    */
@@ -186,6 +308,34 @@ class Scheduler {
   std::vector<bool> kv_block_free_;  // Free list for KV blocks
   int num_free_kv_blocks_;
 
+  // Effective token budget chosen by the AIMD controller
+  int effective_batch_tokens_;
+
+  // Pressure throttling state: last reported severity and when HEAVY
+  // (or worse) pressure started, for the sustain check
+  int pressure_level_ = 0;
+  std::chrono::steady_clock::time_point heavy_pressure_since_{};
+  bool heavy_pressure_active_ = false;
+
+  // Swap-based preemption hooks (no-ops when unset)
+  SwapCallback swap_out_cb_;
+  SwapCallback swap_in_cb_;
+
+  // Cancelled-request cleanup hook and the IDs awaiting it; drained at
+  // the top of get_next_batch on the worker thread
+  SwapCallback release_cb_;
+  std::vector<std::string> cancelled_pending_release_;
+
+  // Per-tenant fair-share accounting (see enable_fair_share). Charged
+  // tokens decay with fair_share_halflife_ms; the registry-owned
+  // counter exports lifetime per-tenant throughput
+  struct TenantAccount {
+    double charged_tokens = 0.0;  // Decayed recent consumption
+    std::chrono::steady_clock::time_point last_decay{};
+    telemetry::Counter* tokens_total = nullptr;
+  };
+  std::unordered_map<std::string, TenantAccount> tenant_accounts_;
+
   // Statistics (mutable to allow updating in const methods)
   mutable SchedulerStats stats_;
   mutable std::chrono::steady_clock::time_point last_stats_update_;
@@ -199,8 +349,14 @@ class Scheduler {
   void move_to_prefilling(RequestPtr request);
   void move_to_decoding(RequestPtr request);
   void move_to_waiting(RequestPtr request);
+  void resume_paused_requests();
   void update_stats() const;
   std::vector<RequestPtr> select_preemption_candidates(int blocks_needed);
+
+  // Fair-share helpers (called with mutex_ held)
+  TenantAccount& tenant_account(const std::string& tenant);
+  double tenant_usage(const std::string& tenant);
+  void charge_tenant(const std::string& tenant, int tokens);
 };
 
 }  // namespace scheduler
@@ -0,0 +1,125 @@
+// Copyright © 2025 MLXR Development
+// Cross-request embedding microbatching implementation
+
+#include "embedding_batcher.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+namespace mlxr {
+namespace server {
+
+EmbeddingBatcher::EmbeddingBatcher(ComputeFn compute,
+                                   const EmbeddingBatcherConfig& config)
+    : compute_(std::move(compute)),
+      config_(config),
+      shutdown_(false),
+      requests_(0),
+      batches_(0),
+      largest_batch_(0) {
+  if (!compute_) {
+    throw std::invalid_argument("Compute function cannot be null");
+  }
+  if (config_.max_batch_size < 1) {
+    config_.max_batch_size = 1;
+  }
+}
+
+EmbeddingBatcher::~EmbeddingBatcher() {
+  // Cut any waiting leader's window short; its batch still runs, so
+  // in-flight embed() calls complete. The server stops accepting
+  // requests before tearing the batcher down
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+}
+
+std::vector<float> EmbeddingBatcher::embed(std::vector<int> tokens) {
+  std::future<std::vector<float>> future;
+  bool leader = false;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    requests_++;
+
+    // First request into an empty queue leads the next batch
+    leader = pending_.empty();
+
+    Pending pending;
+    pending.tokens = std::move(tokens);
+    future = pending.result.get_future();
+    pending_.push_back(std::move(pending));
+  }
+
+  if (!leader) {
+    // A full queue flushes immediately instead of waiting out the window
+    cv_.notify_all();
+    return future.get();
+  }
+
+  // Leader: hold the batch open for the coalescing window, then drain
+  // and compute. Arrivals during compute start the next batch
+  std::vector<Pending> batch;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (config_.window_ms > 0) {
+      cv_.wait_for(lock, std::chrono::milliseconds(config_.window_ms), [this] {
+        return shutdown_ ||
+               static_cast<int>(pending_.size()) >= config_.max_batch_size;
+      });
+    }
+
+    batch = std::move(pending_);
+    pending_.clear();
+
+    batches_++;
+    if (batch.size() > largest_batch_) {
+      largest_batch_ = batch.size();
+    }
+  }
+
+  run_batch(std::move(batch));
+  return future.get();
+}
+
+void EmbeddingBatcher::run_batch(std::vector<Pending> batch) {
+  std::vector<std::vector<int>> inputs;
+  inputs.reserve(batch.size());
+  for (const auto& pending : batch) {
+    inputs.push_back(pending.tokens);
+  }
+
+  try {
+    auto rows = compute_(inputs);
+    if (rows.size() != batch.size()) {
+      throw std::runtime_error("Embedding batch returned " +
+                               std::to_string(rows.size()) + " rows for " +
+                               std::to_string(batch.size()) + " inputs");
+    }
+
+    // Scatter rows back to the waiting handlers
+    for (size_t i = 0; i < batch.size(); ++i) {
+      batch[i].result.set_value(std::move(rows[i]));
+    }
+  } catch (...) {
+    // Whole batch fails together - every waiter sees the exception
+    for (auto& pending : batch) {
+      pending.result.set_exception(std::current_exception());
+    }
+  }
+}
+
+EmbeddingBatcher::Stats EmbeddingBatcher::get_stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats;
+  stats.requests = requests_;
+  stats.batches = batches_;
+  stats.largest_batch = largest_batch_;
+  return stats;
+}
+
+}  // namespace server
+}  // namespace mlxr
@@ -0,0 +1,124 @@
+// Copyright © 2025 MLXR Development
+// Cross-request embedding microbatching
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
+
+namespace mlxr {
+namespace server {
+
+/**
+ * @brief Configuration for the embedding batcher
+ */
+struct EmbeddingBatcherConfig {
+  // Coalescing window after the first request arrives: later requests
+  // landing within this many milliseconds join the same batch. 0 means
+  // no waiting - each flush takes whatever has already queued
+  int window_ms = 5;
+
+  // Flush as soon as this many requests have queued, without waiting
+  // out the rest of the window
+  int max_batch_size = 32;
+};
+
+/**
+ * @brief Coalesces concurrent embedding requests into batched forwards
+ *
+ * Embedding throughput on Apple Silicon is almost entirely batch-size
+ * bound: one padded forward over 32 texts costs little more than one
+ * text alone. HTTP handlers land on separate threads though, so without
+ * coalescing every request runs its own forward pass.
+ *
+ * The batcher uses leader election instead of a dedicated thread: the
+ * first caller to find the queue empty becomes the batch leader, waits
+ * up to window_ms for followers (or until max_batch_size queue up),
+ * then runs the compute function over the whole batch and scatters the
+ * rows back to the waiting handlers via their futures. While the leader
+ * computes, new arrivals start the next batch, so batches pipeline
+ * under sustained load.
+ *
+ * Thread-safe; embed() blocks the calling handler thread until its
+ * batch has been computed.
+ */
+class EmbeddingBatcher {
+ public:
+  /**
+   * @brief Batch compute function: token sequences in, one embedding
+   *        row per sequence out (same order)
+   */
+  using ComputeFn = std::function<std::vector<std::vector<float>>(
+      const std::vector<std::vector<int>>&)>;
+
+  /**
+   * @brief Construct batcher around a compute function
+   * @param compute Batched embedding forward
+   * @param config Coalescing window and batch cap
+   */
+  explicit EmbeddingBatcher(
+      ComputeFn compute,
+      const EmbeddingBatcherConfig& config = EmbeddingBatcherConfig());
+
+  ~EmbeddingBatcher();
+
+  // Disable copy and move
+  EmbeddingBatcher(const EmbeddingBatcher&) = delete;
+  EmbeddingBatcher& operator=(const EmbeddingBatcher&) = delete;
+
+  /**
+   * @brief Embed one tokenized input, coalescing with concurrent calls
+   * @param tokens Token IDs for the input text
+   * @return Embedding row for this input
+   * @throws Propagates any exception thrown by the compute function
+   *         (every request in the failed batch sees it)
+   */
+  std::vector<float> embed(std::vector<int> tokens);
+
+  /**
+   * @brief Get statistics
+   */
+  struct Stats {
+    uint64_t requests;       // Total embed() calls
+    uint64_t batches;        // Compute invocations
+    uint64_t largest_batch;  // Largest batch flushed so far
+  };
+
+  Stats get_stats() const;
+
+ private:
+  /**
+   * @brief One queued request awaiting its batch
+   */
+  struct Pending {
+    std::vector<int> tokens;
+    std::promise<std::vector<float>> result;
+  };
+
+  /**
+   * @brief Run the compute function over a drained batch and scatter
+   * rows (or the thrown exception) to every waiting request.
+   * Called without mutex_ held
+   */
+  void run_batch(std::vector<Pending> batch);
+
+  ComputeFn compute_;
+  EmbeddingBatcherConfig config_;
+
+  std::vector<Pending> pending_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool shutdown_;
+
+  // Statistics (guarded by mutex_)
+  uint64_t requests_;
+  uint64_t batches_;
+  uint64_t largest_batch_;
+};
+
+}  // namespace server
+}  // namespace mlxr
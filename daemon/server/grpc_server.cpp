@@ -2,17 +2,160 @@
 #include "mlxrunner.grpc.pb.h"
 #include "scheduler/scheduler.h"
 #include "scheduler/request.h"
+#include "scheduler/request_pool.h"
 #include "registry/model_registry.h"
+#include "telemetry/kernel_metrics.h"
 #include "telemetry/metrics.h"
 
 #include <grpcpp/ext/proto_server_reflection_plugin.h>
 #include <grpcpp/health_check_service_interface.h>
+#include <google/protobuf/arena.h>
 #include <sstream>
 #include <uuid/uuid.h>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
 
 namespace mlxr {
 
+namespace {
+
+// Per-stream token conduit between the scheduler worker and the RPC
+// handler thread. The worker-side push() never blocks: it enqueues the
+// token and, once the queue reaches its high-water mark, clears
+// Request::consumer_ready so the scheduler parks the sequence instead
+// of generating tokens the client cannot drain. The handler-side pop()
+// re-arms the sequence at the low-water mark and hands tokens to
+// grpc::ServerWriter::Write(), which itself blocks on gRPC's transport
+// flow-control window — so a slow client backpressures
+// window -> queue -> scheduler without buffering unbounded chunks in
+// daemon memory or stalling the decode worker on a blocking write.
+class TokenFlow {
+public:
+    // High/low water chosen so a briefly slow reader (GC pause, event
+    // loop hiccup) does not bounce the sequence in and out of the
+    // batch, while a persistently slow one parks after well under a
+    // kilobyte of queued state
+    static constexpr size_t kHighWater = 64;
+    static constexpr size_t kLowWater = 16;
+
+    explicit TokenFlow(scheduler::RequestPtr request)
+        : request_(std::move(request)) {}
+
+    // Worker thread side
+    void push(int token_id, bool finished) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tokens_.emplace_back(token_id, finished);
+            if (tokens_.size() >= kHighWater) {
+                request_->consumer_ready.store(false, std::memory_order_release);
+            }
+        }
+        cv_.notify_one();
+    }
+
+    // Handler thread side: waits up to `timeout` for the next token;
+    // false on timeout so the caller can re-check cancellation
+    bool pop(int& token_id, bool& finished, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, timeout, [this] { return !tokens_.empty(); })) {
+            return false;
+        }
+        token_id = tokens_.front().first;
+        finished = tokens_.front().second;
+        tokens_.pop_front();
+        if (tokens_.size() <= kLowWater) {
+            request_->consumer_ready.store(true, std::memory_order_release);
+        }
+        return true;
+    }
+
+private:
+    scheduler::RequestPtr request_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::pair<int, bool>> tokens_;
+};
+
+// Chunks built per arena before Reset(): the arena hands the blocks
+// back to its initial allocation so steady-state chunk construction is
+// pointer bumps, while the interval keeps the arena from growing past
+// a few hundred small messages
+constexpr int kArenaResetInterval = 256;
+
+// Give up on a stream that has produced no token for this long
+// (matches the REST server's SSE completion wait)
+constexpr auto kStreamIdleTimeout = std::chrono::seconds(120);
+
+// Drains a TokenFlow into a gRPC stream on the handler thread. Chunks
+// are arena-allocated and the blocking Write() rides the transport's
+// flow-control window, so the only memory a slow client can pin is the
+// bounded token queue plus one arena block. Returns once the final
+// token is written, the client disconnects, or the stream stalls.
+template <typename ChunkT, typename BuildFn>
+grpc::Status DrainTokenStream(grpc::ServerContext* context,
+                              grpc::ServerWriter<ChunkT>* writer,
+                              scheduler::Scheduler* sched,
+                              const scheduler::RequestPtr& request,
+                              TokenFlow& flow,
+                              BuildFn&& build_chunk) {
+    google::protobuf::Arena arena;
+    int chunks_since_reset = 0;
+    auto last_token_time = std::chrono::steady_clock::now();
+
+    while (true) {
+        int token_id = 0;
+        bool finished = false;
+        if (!flow.pop(token_id, finished, std::chrono::milliseconds(100))) {
+            if (context->IsCancelled()) {
+                sched->cancel_request(request->request_id);
+                return grpc::Status::CANCELLED;
+            }
+            // Terminal state reached without a final callback (failure
+            // or external cancellation); queue is empty so no token is
+            // outstanding
+            if (request->is_finished()) {
+                if (request->state == scheduler::RequestState::FAILED) {
+                    return grpc::Status(grpc::StatusCode::INTERNAL,
+                                        request->error_message);
+                }
+                return grpc::Status::OK;
+            }
+            if (std::chrono::steady_clock::now() - last_token_time >
+                kStreamIdleTimeout) {
+                sched->cancel_request(request->request_id);
+                return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED,
+                                    "Generation stalled");
+            }
+            continue;
+        }
+        last_token_time = std::chrono::steady_clock::now();
+
+        if (chunks_since_reset >= kArenaResetInterval) {
+            arena.Reset();
+            chunks_since_reset = 0;
+        }
+        auto* chunk = google::protobuf::Arena::Create<ChunkT>(&arena);
+        build_chunk(chunk, token_id, finished);
+        chunks_since_reset++;
+
+        // Blocks until the transport window can accept the message;
+        // false means the client went away
+        if (!writer->Write(*chunk)) {
+            sched->cancel_request(request->request_id);
+            return grpc::Status::CANCELLED;
+        }
+
+        if (finished) {
+            return grpc::Status::OK;
+        }
+    }
+}
+
+}  // namespace
+
 // ============================================================================
 // GrpcServer Implementation
 // ============================================================================
@@ -396,35 +539,18 @@ grpc::Status GrpcServiceImpl::CreateChatCompletion(
 
     // Create scheduler request
     std::string request_id = GenerateRequestId();
-    auto sched_req = std::make_shared<Request>(
+    auto sched_req = RequestPool::instance().acquire(
         request_id,
         prompt,
         prompt_tokens,
         sampling_params
     );
 
-    // Token callback for streaming
-    // Note: The callback signature is (int token_id, bool finished)
-    // We need to decode token_id to string, which requires a tokenizer
-    sched_req->token_callback = [writer, request_id, model = request->model()](int token_id, bool finished) {
-        mlxrunner::v1::ChatCompletionChunk chunk;
-        chunk.set_id(request_id);
-        chunk.set_object("chat.completion.chunk");
-        chunk.set_created(std::chrono::system_clock::now().time_since_epoch().count());
-        chunk.set_model(model);
-
-        auto* choice = chunk.add_choices();
-        choice->set_index(0);
-
-        auto* delta = choice->mutable_delta();
-        // TODO: Decode token_id to text using tokenizer
-        delta->set_content(std::to_string(token_id));  // Placeholder
-
-        if (finished) {
-            choice->set_finish_reason("stop");
-        }
-
-        writer->Write(chunk);
+    // The worker-side callback only enqueues; chunk construction and
+    // the flow-controlled write happen on this handler thread
+    auto flow = std::make_shared<TokenFlow>(sched_req);
+    sched_req->token_callback = [flow](int token_id, bool finished) {
+        flow->push(token_id, finished);
     };
 
     // Submit to scheduler
@@ -433,10 +559,26 @@ grpc::Status GrpcServiceImpl::CreateChatCompletion(
                           "Scheduler queue is full");
     }
 
-    // TODO: Wait for completion asynchronously
-    // Current implementation returns immediately
-    // Production version should wait for request to complete or stream tokens
-    return grpc::Status::OK;
+    return DrainTokenStream(
+        context, writer, scheduler_.get(), sched_req, *flow,
+        [&request_id, request](mlxrunner::v1::ChatCompletionChunk* chunk,
+                               int token_id, bool finished) {
+            chunk->set_id(request_id);
+            chunk->set_object("chat.completion.chunk");
+            chunk->set_created(std::chrono::system_clock::now().time_since_epoch().count());
+            chunk->set_model(request->model());
+
+            auto* choice = chunk->add_choices();
+            choice->set_index(0);
+
+            auto* delta = choice->mutable_delta();
+            // TODO: Decode token_id to text using tokenizer
+            delta->set_content(std::to_string(token_id));  // Placeholder
+
+            if (finished) {
+                choice->set_finish_reason("stop");
+            }
+        });
 }
 
 grpc::Status GrpcServiceImpl::CreateCompletion(
@@ -473,31 +615,18 @@ grpc::Status GrpcServiceImpl::CreateCompletion(
 
     // Create scheduler request
     std::string request_id = GenerateRequestId();
-    auto sched_req = std::make_shared<Request>(
+    auto sched_req = RequestPool::instance().acquire(
         request_id,
         request->prompt(),
         prompt_tokens,
         sampling_params
     );
 
-    // Token callback for streaming
-    sched_req->token_callback = [writer, request_id, model = request->model()](int token_id, bool finished) {
-        mlxrunner::v1::CompletionChunk chunk;
-        chunk.set_id(request_id);
-        chunk.set_object("text_completion");
-        chunk.set_created(std::chrono::system_clock::now().time_since_epoch().count());
-        chunk.set_model(model);
-
-        auto* choice = chunk.add_choices();
-        // TODO: Decode token_id to text using tokenizer
-        choice->set_text(std::to_string(token_id));  // Placeholder
-        choice->set_index(0);
-
-        if (finished) {
-            choice->set_finish_reason("stop");
-        }
-
-        writer->Write(chunk);
+    // Worker-side callback only enqueues; the handler thread builds
+    // and writes chunks under gRPC flow control
+    auto flow = std::make_shared<TokenFlow>(sched_req);
+    sched_req->token_callback = [flow](int token_id, bool finished) {
+        flow->push(token_id, finished);
     };
 
     // Submit to scheduler
@@ -506,7 +635,24 @@ grpc::Status GrpcServiceImpl::CreateCompletion(
                           "Scheduler queue is full");
     }
 
-    return grpc::Status::OK;
+    return DrainTokenStream(
+        context, writer, scheduler_.get(), sched_req, *flow,
+        [&request_id, request](mlxrunner::v1::CompletionChunk* chunk,
+                               int token_id, bool finished) {
+            chunk->set_id(request_id);
+            chunk->set_object("text_completion");
+            chunk->set_created(std::chrono::system_clock::now().time_since_epoch().count());
+            chunk->set_model(request->model());
+
+            auto* choice = chunk->add_choices();
+            // TODO: Decode token_id to text using tokenizer
+            choice->set_text(std::to_string(token_id));  // Placeholder
+            choice->set_index(0);
+
+            if (finished) {
+                choice->set_finish_reason("stop");
+            }
+        });
 }
 
 grpc::Status GrpcServiceImpl::CreateEmbedding(
@@ -562,31 +708,18 @@ grpc::Status GrpcServiceImpl::Generate(
 
     // Create scheduler request
     std::string request_id = GenerateRequestId();
-    auto sched_req = std::make_shared<Request>(
+    auto sched_req = RequestPool::instance().acquire(
         request_id,
         request->prompt(),
         prompt_tokens,
         sampling_params
     );
 
-    // Token callback for streaming
-    auto start_time = std::chrono::steady_clock::now();
-    sched_req->token_callback = [this, writer, model = request->model(), start_time](int token_id, bool finished) {
-        mlxrunner::v1::GenerateResponse resp;
-        resp.set_model(model);
-        resp.set_created_at(GetTimestamp());
-        // TODO: Decode token_id to text using tokenizer
-        resp.set_response(std::to_string(token_id));  // Placeholder
-        resp.set_done(finished);
-
-        if (finished) {
-            auto end_time = std::chrono::steady_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
-                end_time - start_time);
-            resp.set_total_duration(duration.count());
-        }
-
-        writer->Write(resp);
+    // Worker-side callback only enqueues; the handler thread builds
+    // and writes responses under gRPC flow control
+    auto flow = std::make_shared<TokenFlow>(sched_req);
+    sched_req->token_callback = [flow](int token_id, bool finished) {
+        flow->push(token_id, finished);
     };
 
     // Submit to scheduler
@@ -595,7 +728,24 @@ grpc::Status GrpcServiceImpl::Generate(
                           "Scheduler queue is full");
     }
 
-    return grpc::Status::OK;
+    auto start_time = std::chrono::steady_clock::now();
+    return DrainTokenStream(
+        context, writer, scheduler_.get(), sched_req, *flow,
+        [this, request, start_time](mlxrunner::v1::GenerateResponse* resp,
+                                    int token_id, bool finished) {
+            resp->set_model(request->model());
+            resp->set_created_at(GetTimestamp());
+            // TODO: Decode token_id to text using tokenizer
+            resp->set_response(std::to_string(token_id));  // Placeholder
+            resp->set_done(finished);
+
+            if (finished) {
+                auto end_time = std::chrono::steady_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    end_time - start_time);
+                resp->set_total_duration(duration.count());
+            }
+        });
 }
 
 grpc::Status GrpcServiceImpl::Chat(
@@ -650,37 +800,18 @@ grpc::Status GrpcServiceImpl::Chat(
 
     // Create scheduler request
     std::string request_id = GenerateRequestId();
-    auto sched_req = std::make_shared<Request>(
+    auto sched_req = RequestPool::instance().acquire(
         request_id,
         prompt,
         prompt_tokens,
         sampling_params
     );
 
-    // Token callback for streaming
-    auto start_time = std::chrono::steady_clock::now();
-    auto accumulated = std::make_shared<std::string>();  // Shared for lambda capture
-    sched_req->token_callback = [this, writer, model = request->model(), start_time, accumulated](int token_id, bool finished) {
-        // TODO: Decode token_id to text using tokenizer
-        *accumulated += std::to_string(token_id);  // Placeholder
-
-        mlxrunner::v1::ChatResponse resp;
-        resp.set_model(model);
-        resp.set_created_at(GetTimestamp());
-        resp.set_done(finished);
-
-        auto* msg = resp.mutable_message();
-        msg->set_role("assistant");
-        msg->set_content(*accumulated);
-
-        if (finished) {
-            auto end_time = std::chrono::steady_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
-                end_time - start_time);
-            resp.set_total_duration(duration.count());
-        }
-
-        writer->Write(resp);
+    // Worker-side callback only enqueues; the handler thread builds
+    // and writes responses under gRPC flow control
+    auto flow = std::make_shared<TokenFlow>(sched_req);
+    sched_req->token_callback = [flow](int token_id, bool finished) {
+        flow->push(token_id, finished);
     };
 
     // Submit to scheduler
@@ -689,7 +820,30 @@ grpc::Status GrpcServiceImpl::Chat(
                           "Scheduler queue is full");
     }
 
-    return grpc::Status::OK;
+    auto start_time = std::chrono::steady_clock::now();
+    std::string accumulated;
+    return DrainTokenStream(
+        context, writer, scheduler_.get(), sched_req, *flow,
+        [this, request, start_time, &accumulated](
+            mlxrunner::v1::ChatResponse* resp, int token_id, bool finished) {
+            // TODO: Decode token_id to text using tokenizer
+            accumulated += std::to_string(token_id);  // Placeholder
+
+            resp->set_model(request->model());
+            resp->set_created_at(GetTimestamp());
+            resp->set_done(finished);
+
+            auto* msg = resp->mutable_message();
+            msg->set_role("assistant");
+            msg->set_content(accumulated);
+
+            if (finished) {
+                auto end_time = std::chrono::steady_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    end_time - start_time);
+                resp->set_total_duration(duration.count());
+            }
+        });
 }
 
 grpc::Status GrpcServiceImpl::Embeddings(
@@ -730,6 +884,10 @@ grpc::Status GrpcServiceImpl::GetMetrics(
     const mlxrunner::v1::MetricsRequest* request,
     mlxrunner::v1::MetricsResponse* response) {
 
+    // Refresh per-kernel timing gauges so the export is current (no-op
+    // unless profiling mode is on)
+    telemetry::publish_kernel_profile(*metrics_);
+
     if (request->format() == mlxrunner::v1::METRICS_FORMAT_PROMETHEUS) {
         response->set_format("prometheus");
         response->set_data(metrics_->export_prometheus());
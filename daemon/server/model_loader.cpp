@@ -3,23 +3,167 @@
 
 #include "model_loader.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <optional>
+#include <thread>
+
+#include <nlohmann/json.hpp>
 
 #include "../../core/graph/attention_cached.h"
+#include "../../core/kernels/autotune.h"
+#include "../../core/graph/lora.h"
 #include "../../core/graph/model.h"
 #include "../../core/runtime/engine.h"
 #include "../../core/runtime/kv/arena.h"
 #include "../../core/runtime/kv/eviction.h"
 #include "../../core/runtime/kv/pager.h"
+#include "../../core/runtime/tokenizer/bpe_tokenizer.h"
 #include "../../core/runtime/tokenizer/tokenizer.h"
 #include "../registry/gguf_parser.h"
 #include "../registry/model_registry.h"
+#include "../registry/snapshot.h"
 
 namespace mlxr {
 namespace server {
 
+namespace {
+
+// Registry tag recording where a model's native snapshot lives
+constexpr const char* kSnapshotPathTag = "snapshot_path";
+
+// Only projection weights can ride the fused q_gemm path; quantized
+// embeddings and lm_head would need an explicit dequantize step
+bool is_quantizable_projection(const std::string& name) {
+  static const char* kPatterns[] = {
+      "attn_q",    "attn_k", "attn_v",  "attn_output", "ffn_gate",
+      "ffn_up",    "ffn_down", "q_proj", "k_proj",      "v_proj",
+      "o_proj",    "gate_proj", "up_proj", "down_proj"};
+  for (const char* pattern : kPatterns) {
+    if (name.find(pattern) != std::string::npos) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// One mapped-but-not-yet-copied tensor from the single-threaded planning
+// pass; materialization (page faults + copy into an MLX array) happens
+// later, on a worker pool or a streaming thread
+struct PendingTensor {
+  std::string name;
+  WeightTensor info;
+  MappedRegion region;
+  bool quantized = false;
+  mlx::core::Dtype dtype = mlx::core::float32;
+};
+
+// Copy a mapped tensor into an MLX array. Only reads the mapped region,
+// so it is safe to call from any thread. Returns false and fills *error
+// on failure
+bool materialize_tensor(const PendingTensor& entry, graph::Tensor* out,
+                        std::string* error) {
+  const auto& tensor_info = entry.info;
+  const auto& region = entry.region;
+
+  try {
+    if (entry.quantized) {
+      std::vector<uint8_t> data_vec(
+          static_cast<const uint8_t*>(region.data),
+          static_cast<const uint8_t*>(region.data) + tensor_info.data_size);
+      auto packed = mlx::core::array(
+          data_vec.data(), {static_cast<int>(tensor_info.data_size)},
+          mlx::core::uint8);
+      *out = graph::Tensor(packed);
+      return true;
+    }
+
+    // Convert shape vector<int64_t> to Shape
+    std::vector<int> shape_vec;
+    shape_vec.reserve(tensor_info.shape.size());
+    for (auto dim : tensor_info.shape) {
+      shape_vec.push_back(static_cast<int>(dim));
+    }
+    auto mlx_shape = graph::to_shape(shape_vec);
+
+    // Calculate total elements
+    size_t total_elements = 1;
+    for (auto dim : shape_vec) {
+      total_elements *= dim;
+    }
+
+    // Create MLX array by COPYING from mmap'd memory; the construction
+    // copy is synchronous, so the array stays valid even if the loader
+    // is destroyed
+    if (entry.dtype == mlx::core::float32) {
+      std::vector<float> data_vec(
+          static_cast<const float*>(region.data),
+          static_cast<const float*>(region.data) + total_elements);
+      *out = graph::Tensor(
+          mlx::core::array(data_vec.data(), mlx_shape, entry.dtype));
+    } else if (entry.dtype == mlx::core::float16) {
+      // MLX expects fp16 data as uint16_t
+      std::vector<uint16_t> data_vec(
+          static_cast<const uint16_t*>(region.data),
+          static_cast<const uint16_t*>(region.data) + total_elements);
+      *out = graph::Tensor(
+          mlx::core::array(data_vec.data(), mlx_shape, entry.dtype));
+    } else if (entry.dtype == mlx::core::int32) {
+      std::vector<int32_t> data_vec(
+          static_cast<const int32_t*>(region.data),
+          static_cast<const int32_t*>(region.data) + total_elements);
+      *out = graph::Tensor(
+          mlx::core::array(data_vec.data(), mlx_shape, entry.dtype));
+    } else {
+      std::vector<int64_t> data_vec(
+          static_cast<const int64_t*>(region.data),
+          static_cast<const int64_t*>(region.data) + total_elements);
+      *out = graph::Tensor(
+          mlx::core::array(data_vec.data(), mlx_shape, entry.dtype));
+    }
+
+    return true;
+  } catch (const std::exception& e) {
+    *error = e.what();
+    return false;
+  }
+}
+
+// Which streamed-load stage a tensor belongs to: stage i covers
+// transformer block i (GGUF "blk.N.*", HF "layers.N.*" / "blocks.N.*"),
+// the embedding table joins stage 0 so the first prefill can start, and
+// stage num_layers (the tail) covers the final norm / lm_head plus
+// anything we cannot attribute to a block
+int stage_of(const std::string& name, int num_layers) {
+  static const char* kBlockPrefixes[] = {"blk.", "blocks.", "layers."};
+  for (const char* prefix : kBlockPrefixes) {
+    auto pos = name.find(prefix);
+    if (pos == std::string::npos) {
+      continue;
+    }
+    size_t digit = pos + std::strlen(prefix);
+    if (digit < name.size() &&
+        std::isdigit(static_cast<unsigned char>(name[digit]))) {
+      int layer = std::atoi(name.c_str() + digit);
+      return std::min(layer, num_layers - 1);
+    }
+  }
+  if (name.find("embd") != std::string::npos ||
+      name.find("embed") != std::string::npos) {
+    return 0;
+  }
+  return num_layers;
+}
+
+}  // anonymous namespace
+
 ModelLoader::ModelLoader(std::shared_ptr<registry::ModelRegistry> registry)
     : registry_(registry) {}
 
@@ -110,8 +254,202 @@ bool ModelLoader::load_gguf_tensors(std::shared_ptr<MMapWeightLoader> loader,
   return true;
 }
 
+std::shared_ptr<MMapWeightLoader> ModelLoader::open_snapshot(
+    const registry::ModelInfo& info, const LoadModelConfig& config) {
+  auto tags = registry_->get_tags(info.id);
+  auto it = tags.find(kSnapshotPathTag);
+  if (it == tags.end()) {
+    return nullptr;
+  }
+  const std::string& snapshot_path = it->second;
+
+  std::error_code ec;
+  if (!std::filesystem::exists(snapshot_path, ec) || ec) {
+    std::cerr << "[ModelLoader] Recorded snapshot missing: " << snapshot_path
+              << std::endl;
+    return nullptr;
+  }
+
+  registry::SnapshotFile snapshot;
+  if (!snapshot.parse(snapshot_path)) {
+    std::cerr << "[ModelLoader] Warning: Failed to parse snapshot "
+              << snapshot_path << ": " << snapshot.error() << std::endl;
+    return nullptr;
+  }
+
+  // Staleness check: the snapshot records the source file's size at
+  // write time, so a re-downloaded or re-quantized model invalidates it
+  const auto source_size = std::filesystem::file_size(info.file_path, ec);
+  if (ec || snapshot.header().source_size != source_size) {
+    std::cerr << "[ModelLoader] Snapshot stale for " << info.name
+              << " (source file changed); falling back to GGUF" << std::endl;
+    return nullptr;
+  }
+
+  auto loader =
+      load_weights(snapshot_path, config.prefetch_weights, config.lock_weights);
+  if (!loader) {
+    return nullptr;  // load_weights logged; caller falls back to source
+  }
+
+  // Register tensors straight from the snapshot index — offsets are
+  // absolute and page-aligned, so this replaces the whole GGUF parse
+  for (const auto& t : snapshot.tensors()) {
+    WeightTensor wt;
+    wt.name = t.name;
+    wt.shape = t.shape;
+    wt.file_offset = t.offset;
+    wt.data_size = t.size;
+    wt.dtype = t.dtype;
+    wt.quant_type = t.quant_type;
+    wt.quant_block_size = t.quant_block_size;
+    loader->register_tensor(wt);
+  }
+
+  std::cerr << "[ModelLoader] Using native snapshot: " << snapshot_path
+            << " (" << snapshot.tensors().size() << " tensors)" << std::endl;
+
+  return loader;
+}
+
+void ModelLoader::write_snapshot(std::shared_ptr<MMapWeightLoader> loader,
+                                 const registry::ModelInfo& info) {
+  // Map every registered tensor and hand the regions to the writer; the
+  // loader keeps the mappings alive for the duration of the write
+  std::vector<registry::SnapshotWriteEntry> entries;
+  auto tensor_names = loader->list_tensors();
+  entries.reserve(tensor_names.size());
+
+  for (const auto& name : tensor_names) {
+    auto tensor_info_opt = loader->get_tensor_info(name);
+    if (!tensor_info_opt.has_value()) {
+      continue;
+    }
+    const auto& tensor_info = tensor_info_opt.value();
+
+    auto region = loader->map_tensor(name, false);
+    if (!region.is_valid) {
+      std::cerr << "[ModelLoader] Warning: Failed to map " << name
+                << " for snapshot; skipping snapshot write" << std::endl;
+      return;
+    }
+    loader->advise(region, MMapWeightLoader::AdvicePattern::SEQUENTIAL);
+
+    registry::SnapshotWriteEntry entry;
+    entry.info.name = tensor_info.name;
+    entry.info.shape = tensor_info.shape;
+    entry.info.dtype = tensor_info.dtype;
+    entry.info.quant_type = tensor_info.quant_type;
+    entry.info.quant_block_size = tensor_info.quant_block_size;
+    entry.info.size = tensor_info.data_size;
+    entry.data = region.data;
+    entries.push_back(std::move(entry));
+  }
+
+  const std::string snapshot_path = info.file_path + ".mlxr-snap";
+  std::error_code ec;
+  const auto source_size = std::filesystem::file_size(info.file_path, ec);
+  if (ec) {
+    std::cerr << "[ModelLoader] Warning: Cannot stat " << info.file_path
+              << "; skipping snapshot write" << std::endl;
+    return;
+  }
+
+  std::cerr << "[ModelLoader] Writing native snapshot: " << snapshot_path
+            << std::endl;
+
+  std::string write_error;
+  if (!registry::SnapshotFile::write(snapshot_path, entries, source_size,
+                                     &write_error)) {
+    std::cerr << "[ModelLoader] Warning: Snapshot write failed: "
+              << write_error << std::endl;
+    return;
+  }
+
+  registry_->add_tags(info.id, {{kSnapshotPathTag, snapshot_path}});
+  std::cerr << "[ModelLoader] Snapshot recorded; next load is mmap-only"
+            << std::endl;
+}
+
+std::shared_ptr<runtime::Tokenizer> ModelLoader::load_bpe_tokenizer_from_gguf(
+    const std::string& file_path) {
+  registry::GGUFFile gguf;
+  if (!gguf.parse(file_path)) {
+    return nullptr;
+  }
+  if (gguf.get_tokenizer_model() != "gpt2") {
+    return nullptr;  // SentencePiece-family: handled by the path factory
+  }
+
+  const auto* tokens_val = gguf.get_metadata("tokenizer.ggml.tokens");
+  if (!tokens_val || !tokens_val->arr) {
+    return nullptr;
+  }
+
+  std::vector<std::string> vocab;
+  vocab.reserve(tokens_val->arr->values.size());
+  for (const auto& value : tokens_val->arr->values) {
+    vocab.push_back(value->as_string());
+  }
+
+  std::vector<std::string> merges;
+  if (const auto* merges_val = gguf.get_metadata("tokenizer.ggml.merges")) {
+    if (merges_val->arr) {
+      merges.reserve(merges_val->arr->values.size());
+      for (const auto& value : merges_val->arr->values) {
+        merges.push_back(value->as_string());
+      }
+    }
+  }
+
+  int bos_id = -1;
+  int eos_id = -1;
+  if (const auto* val = gguf.get_metadata("tokenizer.ggml.bos_token_id")) {
+    bos_id = static_cast<int>(val->as_uint32());
+  }
+  if (const auto* val = gguf.get_metadata("tokenizer.ggml.eos_token_id")) {
+    eos_id = static_cast<int>(val->as_uint32());
+  }
+
+  // Token types mark control (3) and user-defined (4) tokens; both are
+  // matched verbatim by the tokenizer instead of being split by BPE
+  std::vector<int> special_ids;
+  if (const auto* types_val = gguf.get_metadata("tokenizer.ggml.token_type")) {
+    if (types_val->arr) {
+      for (size_t i = 0; i < types_val->arr->values.size(); ++i) {
+        int type = types_val->arr->values[i]->as_int32();
+        if (type == 3 || type == 4) {
+          special_ids.push_back(static_cast<int>(i));
+        }
+      }
+    }
+  }
+
+  try {
+    auto tokenizer = std::make_shared<runtime::BPETokenizer>(
+        std::move(vocab), merges, bos_id, eos_id, special_ids);
+    std::cerr << "[ModelLoader] Built BPE tokenizer from GGUF metadata, "
+              << "vocab_size=" << tokenizer->vocab_size() << ", "
+              << merges.size() << " merges, " << special_ids.size()
+              << " specials" << std::endl;
+    return tokenizer;
+  } catch (const std::exception& e) {
+    std::cerr << "[ModelLoader] BPE tokenizer build failed: " << e.what()
+              << std::endl;
+    return nullptr;
+  }
+}
+
 std::shared_ptr<runtime::Tokenizer> ModelLoader::load_tokenizer(
     const registry::ModelInfo& info) {
+  // GGUF byte-level BPE checkpoints carry the whole tokenizer in their
+  // metadata; assemble it from there before consulting tokenizer_path
+  if (info.format == registry::ModelFormat::GGUF) {
+    if (auto bpe = load_bpe_tokenizer_from_gguf(info.file_path)) {
+      return bpe;
+    }
+  }
+
   if (info.tokenizer_path.empty()) {
     last_error_ = "No tokenizer path in model info";
     std::cerr << "[ModelLoader] " << last_error_ << std::endl;
@@ -147,23 +485,289 @@ std::shared_ptr<runtime::kv::Pager> ModelLoader::create_pager(
   arena_config.block_size_tokens = config.kv_block_size;
   arena_config.num_blocks = config.kv_num_blocks;
 
-  std::cerr << "[ModelLoader] Creating Arena: " << arena_config.num_blocks
-            << " blocks x " << arena_config.block_size_tokens
-            << " tokens/block = "
-            << (arena_config.num_blocks * arena_config.block_size_tokens)
-            << " token capacity" << std::endl;
-
-  // Create arena
-  auto arena = std::make_shared<runtime::kv::Arena>(arena_config);
+  // Co-resident models share one arena when their KV geometry matches
+  // (block tensor shapes are fixed at arena creation); a geometry
+  // mismatch falls back to a private arena for that model
+  std::shared_ptr<runtime::kv::Arena> arena;
+  {
+    std::lock_guard<std::mutex> lock(residency_mutex_);
+    bool geometry_matches =
+        shared_arena_ &&
+        shared_arena_config_.num_layers == arena_config.num_layers &&
+        shared_arena_config_.num_kv_heads == arena_config.num_kv_heads &&
+        shared_arena_config_.head_dim == arena_config.head_dim &&
+        shared_arena_config_.block_size_tokens ==
+            arena_config.block_size_tokens;
+
+    if (geometry_matches) {
+      arena = shared_arena_;
+      std::cerr << "[ModelLoader] Reusing shared Arena ("
+                << shared_arena_config_.num_blocks << " blocks)" << std::endl;
+    } else if (!shared_arena_) {
+      std::cerr << "[ModelLoader] Creating Arena: " << arena_config.num_blocks
+                << " blocks x " << arena_config.block_size_tokens
+                << " tokens/block = "
+                << (arena_config.num_blocks * arena_config.block_size_tokens)
+                << " token capacity" << std::endl;
+      shared_arena_ = std::make_shared<runtime::kv::Arena>(arena_config);
+      shared_arena_config_ = arena_config;
+      arena = shared_arena_;
+    } else {
+      std::cerr << "[ModelLoader] KV geometry differs from shared Arena; "
+                   "creating private Arena for this model"
+                << std::endl;
+      arena = std::make_shared<runtime::kv::Arena>(arena_config);
+    }
+  }
 
   // Create pager
   auto pager = std::make_shared<runtime::kv::Pager>(arena);
 
+  // Per-model quota keeps co-resident models from starving each other
+  if (config.kv_quota_blocks > 0) {
+    pager->set_block_quota(config.kv_quota_blocks);
+    std::cerr << "[ModelLoader] Per-model KV quota: "
+              << config.kv_quota_blocks << " blocks" << std::endl;
+  }
+
   std::cerr << "[ModelLoader] Pager created successfully" << std::endl;
 
   return pager;
 }
 
+std::optional<LoadedModel> ModelLoader::acquire_model(
+    const std::string& model_name, const LoadModelConfig& config) {
+  {
+    std::lock_guard<std::mutex> lock(residency_mutex_);
+    auto it = resident_models_.find(model_name);
+    if (it != resident_models_.end()) {
+      // Warm-pool hit: bump the LRU stamp so frequently switched
+      // models stay resident
+      it->second.last_used = ++use_counter_;
+      return it->second.model;
+    }
+  }
+
+  // Size the incoming model from registry metadata before loading, so
+  // LRU eviction can make room up front instead of overshooting the
+  // budget and relying on the OS to page weights out
+  uint64_t incoming_bytes = 0;
+  if (auto info = registry_->get_model_by_identifier(model_name)) {
+    incoming_bytes = estimate_model_bytes(info.value());
+  }
+
+  std::vector<std::string> evicted;
+  EvictionCallback notify;
+  {
+    std::lock_guard<std::mutex> lock(residency_mutex_);
+    evict_for_budget_locked(incoming_bytes, &evicted);
+    notify = eviction_callback_;
+  }
+  // Notify outside the lock; the callback drops the server's engine
+  // references and must not deadlock against residency_mutex_
+  if (notify) {
+    for (const auto& name : evicted) {
+      notify(name);
+    }
+  }
+
+  // Load outside the lock: loading takes seconds and create_pager
+  // re-acquires residency_mutex_ for the shared arena
+  auto loaded = load_model(model_name, config);
+  if (!loaded.has_value()) {
+    return std::nullopt;
+  }
+
+  std::lock_guard<std::mutex> lock(residency_mutex_);
+  ResidentEntry entry;
+  entry.model = loaded.value();
+  entry.resident_bytes = estimate_model_bytes(loaded->info);
+  entry.last_used = ++use_counter_;
+  resident_models_[model_name] = std::move(entry);
+  return loaded;
+}
+
+bool ModelLoader::release_model(const std::string& model_name) {
+  std::lock_guard<std::mutex> lock(residency_mutex_);
+  return resident_models_.erase(model_name) > 0;
+}
+
+std::optional<LoadedModel> ModelLoader::get_resident_model(
+    const std::string& model_name) const {
+  std::lock_guard<std::mutex> lock(residency_mutex_);
+  auto it = resident_models_.find(model_name);
+  if (it == resident_models_.end()) {
+    return std::nullopt;
+  }
+  return it->second.model;
+}
+
+std::vector<std::string> ModelLoader::resident_model_names() const {
+  std::lock_guard<std::mutex> lock(residency_mutex_);
+  std::vector<std::string> names;
+  names.reserve(resident_models_.size());
+  for (const auto& pair : resident_models_) {
+    names.push_back(pair.first);
+  }
+  return names;
+}
+
+bool ModelLoader::write_warm_manifest(const std::string& path) const {
+  std::vector<std::pair<uint64_t, std::string>> ordered;
+  {
+    std::lock_guard<std::mutex> lock(residency_mutex_);
+    ordered.reserve(resident_models_.size());
+    for (const auto& [name, entry] : resident_models_) {
+      ordered.emplace_back(entry.last_used, name);
+    }
+  }
+  // Least-recently-used first: restoring in this order re-acquires the
+  // most recent model last, rebuilding the same LRU ordering
+  std::sort(ordered.begin(), ordered.end());
+
+  nlohmann::json manifest;
+  manifest["version"] = 1;
+  manifest["written_at"] = static_cast<int64_t>(std::time(nullptr));
+  auto models = nlohmann::json::array();
+  for (const auto& [stamp, name] : ordered) {
+    (void)stamp;
+    models.push_back(name);
+  }
+  manifest["models"] = models;
+
+  // Write-then-rename so a crash mid-write never leaves a truncated
+  // manifest for the next start to trip over
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::trunc);
+    if (!out) {
+      std::cerr << "[ModelLoader] Cannot write warm manifest to " << tmp_path
+                << std::endl;
+      return false;
+    }
+    out << manifest.dump(2) << std::endl;
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    std::cerr << "[ModelLoader] Cannot publish warm manifest: " << ec.message()
+              << std::endl;
+    return false;
+  }
+
+  std::cerr << "[ModelLoader] Wrote warm-restart manifest (" << ordered.size()
+            << " models) to " << path << std::endl;
+  return true;
+}
+
+std::vector<std::string> ModelLoader::read_warm_manifest(
+    const std::string& path, int max_age_seconds) {
+  std::ifstream in(path);
+  if (!in) {
+    return {};
+  }
+
+  try {
+    auto manifest = nlohmann::json::parse(in);
+    if (manifest.value("version", 0) != 1) {
+      std::cerr << "[ModelLoader] Ignoring warm manifest with unknown version"
+                << std::endl;
+      return {};
+    }
+
+    int64_t written_at = manifest.value("written_at", int64_t{0});
+    int64_t age = static_cast<int64_t>(std::time(nullptr)) - written_at;
+    if (age < 0 || age > max_age_seconds) {
+      std::cerr << "[ModelLoader] Ignoring stale warm manifest (age " << age
+                << "s)" << std::endl;
+      return {};
+    }
+
+    std::vector<std::string> names;
+    for (const auto& entry : manifest.value("models", nlohmann::json::array())) {
+      if (entry.is_string()) {
+        names.push_back(entry.get<std::string>());
+      }
+    }
+    return names;
+
+  } catch (const std::exception& e) {
+    std::cerr << "[ModelLoader] Malformed warm manifest: " << e.what()
+              << std::endl;
+    return {};
+  }
+}
+
+void ModelLoader::set_eviction_callback(EvictionCallback callback) {
+  std::lock_guard<std::mutex> lock(residency_mutex_);
+  eviction_callback_ = std::move(callback);
+}
+
+void ModelLoader::set_memory_budget(uint64_t budget_bytes) {
+  std::lock_guard<std::mutex> lock(residency_mutex_);
+  memory_budget_bytes_ = budget_bytes;
+  if (budget_bytes > 0) {
+    std::cerr << "[ModelLoader] Warm-pool memory budget: "
+              << (budget_bytes / 1024 / 1024) << " MB" << std::endl;
+  }
+}
+
+uint64_t ModelLoader::memory_budget() const {
+  std::lock_guard<std::mutex> lock(residency_mutex_);
+  return memory_budget_bytes_;
+}
+
+uint64_t ModelLoader::resident_bytes() const {
+  std::lock_guard<std::mutex> lock(residency_mutex_);
+  uint64_t total = 0;
+  for (const auto& pair : resident_models_) {
+    total += pair.second.resident_bytes;
+  }
+  return total;
+}
+
+uint64_t ModelLoader::estimate_model_bytes(const registry::ModelInfo& info) {
+  if (info.file_size > 0) {
+    return info.file_size;
+  }
+  // No size on record (e.g. manually registered model) - assume fp16
+  return info.param_count * 2;
+}
+
+void ModelLoader::evict_for_budget_locked(uint64_t incoming_bytes,
+                                          std::vector<std::string>* evicted) {
+  if (memory_budget_bytes_ == 0) {
+    return;  // Unlimited
+  }
+
+  uint64_t total = 0;
+  for (const auto& pair : resident_models_) {
+    total += pair.second.resident_bytes;
+  }
+
+  while (!resident_models_.empty() &&
+         total + incoming_bytes > memory_budget_bytes_) {
+    auto lru = resident_models_.begin();
+    for (auto it = resident_models_.begin(); it != resident_models_.end();
+         ++it) {
+      if (it->second.last_used < lru->second.last_used) {
+        lru = it;
+      }
+    }
+
+    std::cerr << "[ModelLoader] Warm pool over budget ("
+              << ((total + incoming_bytes) / 1024 / 1024) << " MB > "
+              << (memory_budget_bytes_ / 1024 / 1024)
+              << " MB), evicting LRU model: " << lru->first << std::endl;
+
+    total -= lru->second.resident_bytes;
+    if (evicted) {
+      evicted->push_back(lru->first);
+    }
+    resident_models_.erase(lru);
+  }
+}
+
 std::shared_ptr<graph::CachedLlamaModel>
 ModelLoader::load_model_from_safetensors(
     std::shared_ptr<graph::CachedLlamaModel> model,
@@ -190,17 +794,27 @@ ModelLoader::load_model_from_safetensors(
 std::shared_ptr<graph::CachedLlamaModel> ModelLoader::load_model_from_gguf_mmap(
     std::shared_ptr<graph::CachedLlamaModel> model,
     std::shared_ptr<MMapWeightLoader> loader,
-    const registry::ModelInfo& info) {
+    const registry::ModelInfo& info,
+    const LoadModelConfig& config,
+    std::shared_ptr<std::thread>* stream_thread) {
   std::cerr << "[ModelLoader] Loading GGUF weights from mmap..." << std::endl;
 
-  // Build weight map: tensor_name → MLX Tensor
+  // Build weight map: tensor_name → MLX Tensor. Quantized projections stay
+  // packed; quant_map flags them so assign_weights routes them through
+  // Linear::set_quantized_weight
   std::unordered_map<std::string, graph::Tensor> weight_map;
+  graph::WeightQuantMap quant_map;
 
   auto tensor_names = loader->list_tensors();
   std::cerr << "[ModelLoader] Processing " << tensor_names.size()
             << " tensors..." << std::endl;
 
-  int loaded = 0;
+  // PHASE 1 (single-threaded): resolve metadata and map every tensor.
+  // map_tensor mutates the loader's mapping table so it stays on this
+  // thread; the expensive part — faulting pages in and copying into MLX
+  // arrays — is deferred to the worker pool (or streaming thread) below
+  std::vector<PendingTensor> pending;
+  pending.reserve(tensor_names.size());
   int skipped = 0;
 
   for (const auto& tensor_name : tensor_names) {
@@ -214,91 +828,274 @@ std::shared_ptr<graph::CachedLlamaModel> ModelLoader::load_model_from_gguf_mmap(
 
     const auto& tensor_info = tensor_info_opt.value();
 
-    // Map the tensor into memory
-    auto region = loader->map_tensor(tensor_name, true);  // with prefetch
-    if (!region.is_valid) {
-      last_error_ = "Failed to map tensor: " + tensor_name;
-      std::cerr << "[ModelLoader] " << last_error_ << std::endl;
-      return nullptr;
-    }
-
-    // Determine MLX dtype and handle quantized types
-    mlx::core::Dtype mlx_dtype = mlx::core::float32;  // Default
+    PendingTensor entry;
+    entry.name = tensor_name;
+    entry.info = tensor_info;
 
     if (tensor_info.dtype == "float16") {
-      mlx_dtype = mlx::core::float16;
+      entry.dtype = mlx::core::float16;
     } else if (tensor_info.dtype == "float32") {
-      mlx_dtype = mlx::core::float32;
+      entry.dtype = mlx::core::float32;
     } else if (tensor_info.dtype == "int32") {
-      mlx_dtype = mlx::core::int32;
+      entry.dtype = mlx::core::int32;
     } else if (tensor_info.dtype == "int64") {
-      mlx_dtype = mlx::core::int64;
+      entry.dtype = mlx::core::int64;
+    } else if (!tensor_info.quant_type.empty() &&
+               is_quantizable_projection(tensor_name)) {
+      // Packed quantized projection: the raw GGUF blocks go to the fused
+      // q_gemm_dequant kernel as uint8 — the fp16 weight matrix is never
+      // materialized
+      entry.quantized = true;
     } else {
-      // Quantized types need dequantization
-      // For MVP: just log warning and skip
+      // Quantized embeddings / lm_head still need an explicit dequantize
+      // step; only projection weights ride the fused q_gemm path
       std::cerr << "[ModelLoader] Warning: Quantized dtype " << tensor_info.dtype
                 << " for " << tensor_name
-                << " - dequantization not yet implemented, skipping"
-                << std::endl;
+                << " - no fused path for this tensor, skipping" << std::endl;
       skipped++;
       continue;
     }
 
-    // Convert shape vector<int64_t> to Shape
-    std::vector<int> shape_vec;
-    shape_vec.reserve(tensor_info.shape.size());
-    for (auto dim : tensor_info.shape) {
-      shape_vec.push_back(static_cast<int>(dim));
+    // Map without prefetch; the workers below issue MADV_WILLNEED ahead
+    // of the read cursor so page faults overlap with array construction
+    entry.region = loader->map_tensor(tensor_name, false);
+    if (!entry.region.is_valid) {
+      last_error_ = "Failed to map tensor: " + tensor_name;
+      std::cerr << "[ModelLoader] " << last_error_ << std::endl;
+      return nullptr;
     }
-    auto mlx_shape = graph::to_shape(shape_vec);
 
-    // Calculate total elements
-    size_t total_elements = 1;
-    for (auto dim : shape_vec) {
-      total_elements *= dim;
+    pending.push_back(std::move(entry));
+  }
+
+  // STREAMED PATH: materialize stage by stage so the first prefill can
+  // start as soon as the embedding table and block 0 are resident. Stage 0
+  // loads in the foreground; a background thread races ahead layer by
+  // layer, releasing the model's per-layer latches as it goes. Streaming
+  // trades the worker pool's parallelism for a much earlier first token
+  if (config.stream_weights && !pending.empty()) {
+    const int num_layers = model->config().num_layers;
+
+    struct StreamState {
+      std::vector<PendingTensor> pending;
+      std::vector<size_t> order;        // indices into pending, stage-major
+      std::vector<size_t> stage_begin;  // stage s spans [begin[s], begin[s+1])
+      int num_layers = 0;
+    };
+    auto state = std::make_shared<StreamState>();
+    state->num_layers = num_layers;
+
+    // Bucket tensors by stage, then flatten in stage order so readahead
+    // advice tracks the actual read cursor
+    std::vector<std::vector<size_t>> buckets(num_layers + 1);
+    for (size_t i = 0; i < pending.size(); i++) {
+      buckets[stage_of(pending[i].name, num_layers)].push_back(i);
+    }
+    state->order.reserve(pending.size());
+    state->stage_begin.reserve(buckets.size() + 1);
+    for (auto& bucket : buckets) {
+      state->stage_begin.push_back(state->order.size());
+      state->order.insert(state->order.end(), bucket.begin(), bucket.end());
     }
+    state->stage_begin.push_back(state->order.size());
+    state->pending = std::move(pending);
+
+    model->begin_streamed_load();
+
+    constexpr size_t kStreamPrefetchAhead = 4;
+
+    // Materialize and assign one stage's tensors; returns false and
+    // fills *error on the first failure. Captures by value so the
+    // background thread outlives this call safely — the loader shared_ptr
+    // keeps the mapped regions alive
+    auto run_stage = [model, loader, state](int stage, std::string* error) {
+      std::unordered_map<std::string, graph::Tensor> stage_weights;
+      graph::WeightQuantMap stage_quants;
+      std::vector<mlx::core::array> stage_eval;
+
+      const size_t begin = state->stage_begin[stage];
+      const size_t end = state->stage_begin[stage + 1];
+      for (size_t pos = begin; pos < end; pos++) {
+        // Keep readahead in front of the read cursor
+        const size_t ahead = pos + kStreamPrefetchAhead;
+        if (ahead < state->order.size()) {
+          loader->advise(state->pending[state->order[ahead]].region,
+                         MMapWeightLoader::AdvicePattern::WILLNEED);
+        }
+
+        const auto& entry = state->pending[state->order[pos]];
+        graph::Tensor tensor;
+        std::string err;
+        if (!materialize_tensor(entry, &tensor, &err)) {
+          *error = "Failed to materialize tensor " + entry.name +
+                   (err.empty() ? "" : ": " + err);
+          return false;
+        }
+
+        stage_eval.push_back(tensor.array());
+        stage_weights[entry.name] = tensor;
+        if (entry.quantized) {
+          stage_quants[entry.name] = {entry.info.quant_type,
+                                      entry.info.quant_block_size};
+        }
+      }
 
-    // Create MLX array by COPYING from mmap'd memory
-    // This is safer and ensures model works even if loader is destroyed
-    std::optional<mlx::core::array> arr_opt;
+      if (!stage_eval.empty()) {
+        mlx::core::eval(stage_eval);
+      }
 
-    if (mlx_dtype == mlx::core::float32) {
-      // Copy float32 data
-      std::vector<float> data_vec(static_cast<const float*>(region.data),
-                                  static_cast<const float*>(region.data) + total_elements);
-      arr_opt = mlx::core::array(data_vec.data(), mlx_shape, mlx_dtype);
-    } else if (mlx_dtype == mlx::core::float16) {
-      // For float16, we need to copy the raw bytes
-      // MLX expects fp16 data as uint16_t
-      std::vector<uint16_t> data_vec(static_cast<const uint16_t*>(region.data),
-                                     static_cast<const uint16_t*>(region.data) + total_elements);
-      arr_opt = mlx::core::array(data_vec.data(), mlx_shape, mlx_dtype);
-    } else if (mlx_dtype == mlx::core::int32) {
-      std::vector<int32_t> data_vec(static_cast<const int32_t*>(region.data),
-                                    static_cast<const int32_t*>(region.data) + total_elements);
-      arr_opt = mlx::core::array(data_vec.data(), mlx_shape, mlx_dtype);
-    } else if (mlx_dtype == mlx::core::int64) {
-      std::vector<int64_t> data_vec(static_cast<const int64_t*>(region.data),
-                                    static_cast<const int64_t*>(region.data) + total_elements);
-      arr_opt = mlx::core::array(data_vec.data(), mlx_shape, mlx_dtype);
-    } else {
-      std::cerr << "[ModelLoader] Warning: Unsupported dtype for " << tensor_name
-                << ", skipping" << std::endl;
-      skipped++;
-      continue;
+      if (!model->load_from_weight_map(stage_weights, stage_quants,
+                                       /*partial=*/true)) {
+        *error = "Failed to assign streamed weights for stage " +
+                 std::to_string(stage);
+        return false;
+      }
+      return true;
+    };
+
+    // Stage 0 (embeddings + block 0) in the foreground so the model can
+    // accept its first prefill the moment load_model() returns
+    std::string stage_error;
+    if (!run_stage(0, &stage_error)) {
+      model->finish_streamed_load();
+      last_error_ = stage_error;
+      std::cerr << "[ModelLoader] " << last_error_ << std::endl;
+      return nullptr;
+    }
+    model->mark_layer_ready(0);
+
+    std::cerr << "[ModelLoader] Stage 0 resident; streaming remaining "
+              << num_layers << " stages in the background ("
+              << skipped << " tensors skipped)" << std::endl;
+
+    // Remaining stages race ahead on a background thread. On failure we
+    // log loudly and still release every latch so in-flight forwards
+    // never hang; last_error_ is only written from the loading thread
+    auto* worker_thread = new std::thread([model, run_stage, state]() {
+      for (int stage = 1; stage <= state->num_layers; stage++) {
+        std::string err;
+        if (!run_stage(stage, &err)) {
+          std::cerr << "[ModelLoader] ERROR: Streamed weight load failed: "
+                    << err << std::endl;
+          break;
+        }
+        if (stage < state->num_layers) {
+          model->mark_layer_ready(stage);
+        }
+      }
+      model->finish_streamed_load();
+      std::cerr << "[ModelLoader] Streamed weight load complete" << std::endl;
+    });
+
+    // The joining deleter makes the last LoadedModel reference wait for
+    // the stream to drain instead of detaching it
+    auto joiner = std::shared_ptr<std::thread>(
+        worker_thread, [](std::thread* t) {
+          if (t->joinable()) {
+            t->join();
+          }
+          delete t;
+        });
+    if (stream_thread != nullptr) {
+      *stream_thread = joiner;
     }
 
-    // Force evaluation to trigger the copy
-    mlx::core::eval(arr_opt.value());
+    return model;
+  }
 
-    // Store in weight map
-    weight_map[tensor_name] = graph::Tensor(arr_opt.value());
-    loaded++;
+  // PHASE 2 (parallel): materialize independent tensors concurrently.
+  // Before copying its own tensor, each worker advises the kernel about
+  // the tensor kPrefetchWindow positions ahead, keeping readahead in
+  // front of the pool's aggregate read cursor
+  constexpr size_t kPrefetchWindow = 4;
+
+  struct MaterializedTensor {
+    graph::Tensor tensor;
+    bool ok = false;
+    std::string error;
+  };
+
+  std::vector<MaterializedTensor> results(pending.size());
+  std::atomic<size_t> next_index{0};
+  std::atomic<int> progress{0};
+
+  const unsigned hw = std::thread::hardware_concurrency();
+  const size_t num_threads = std::max<size_t>(
+      1, std::min<size_t>({hw > 0 ? hw : 4, pending.size(), 8}));
+
+  // Pre-warm the first window so the initial workers don't start cold
+  for (size_t i = 0; i < std::min(kPrefetchWindow, pending.size()); i++) {
+    loader->advise(pending[i].region,
+                   MMapWeightLoader::AdvicePattern::WILLNEED);
+  }
+
+  auto materialize = [&](size_t i) {
+    auto& slot = results[i];
+    slot.ok = materialize_tensor(pending[i], &slot.tensor, &slot.error);
+  };
+
+  auto worker = [&]() {
+    while (true) {
+      const size_t i = next_index.fetch_add(1);
+      if (i >= pending.size()) {
+        break;
+      }
+
+      const size_t ahead = i + kPrefetchWindow;
+      if (ahead < pending.size()) {
+        loader->advise(pending[ahead].region,
+                       MMapWeightLoader::AdvicePattern::WILLNEED);
+      }
+
+      materialize(i);
+
+      const int done = progress.fetch_add(1) + 1;
+      if (done % 50 == 0) {
+        std::cerr << "[ModelLoader] Loaded " << done << "/" << pending.size()
+                  << " tensors..." << std::endl;
+      }
+    }
+  };
+
+  std::cerr << "[ModelLoader] Materializing " << pending.size()
+            << " tensors on " << num_threads << " threads..." << std::endl;
+
+  std::vector<std::thread> pool;
+  pool.reserve(num_threads);
+  for (size_t t = 0; t < num_threads; t++) {
+    pool.emplace_back(worker);
+  }
+  for (auto& t : pool) {
+    t.join();
+  }
+
+  // Merge results and surface the first failure, if any
+  int loaded = 0;
+  std::vector<mlx::core::array> to_eval;
+  to_eval.reserve(pending.size());
+
+  for (size_t i = 0; i < pending.size(); i++) {
+    auto& slot = results[i];
+    if (!slot.ok) {
+      last_error_ = "Failed to materialize tensor " + pending[i].name +
+                    (slot.error.empty() ? "" : ": " + slot.error);
+      std::cerr << "[ModelLoader] " << last_error_ << std::endl;
+      return nullptr;
+    }
 
-    if (loaded % 50 == 0) {
-      std::cerr << "[ModelLoader] Loaded " << loaded << "/"
-                << tensor_names.size() << " tensors..." << std::endl;
+    to_eval.push_back(slot.tensor.array());
+    weight_map[pending[i].name] = slot.tensor;
+    if (pending[i].quantized) {
+      quant_map[pending[i].name] = {pending[i].info.quant_type,
+                                    pending[i].info.quant_block_size};
     }
+    loaded++;
+  }
+
+  // One batched eval replaces the sequential loader's per-tensor evals;
+  // construction already copied the data out of the mapped regions
+  if (!to_eval.empty()) {
+    mlx::core::eval(to_eval);
   }
 
   std::cerr << "[ModelLoader] Finished loading: " << loaded << " loaded, "
@@ -307,7 +1104,7 @@ std::shared_ptr<graph::CachedLlamaModel> ModelLoader::load_model_from_gguf_mmap(
   // Use model's load_from_weight_map() method
   std::cerr << "[ModelLoader] Assigning weights to model layers..." << std::endl;
 
-  if (!model->load_from_weight_map(weight_map)) {
+  if (!model->load_from_weight_map(weight_map, quant_map)) {
     last_error_ = "Failed to assign weights to model layers";
     std::cerr << "[ModelLoader] " << last_error_ << std::endl;
     return nullptr;
@@ -322,7 +1119,9 @@ std::shared_ptr<graph::CachedLlamaModel> ModelLoader::load_model_from_gguf_mmap(
 std::shared_ptr<graph::CachedLlamaModel> ModelLoader::create_cached_model(
     std::shared_ptr<MMapWeightLoader> loader,
     const registry::ModelInfo& info,
-    std::shared_ptr<runtime::kv::Pager> pager) {
+    std::shared_ptr<runtime::kv::Pager> pager,
+    const LoadModelConfig& config,
+    std::shared_ptr<std::thread>* stream_thread) {
   // Build ModelConfig from registry info
   graph::ModelConfig model_config;
   model_config.hidden_size = info.hidden_size;
@@ -334,6 +1133,19 @@ std::shared_ptr<graph::CachedLlamaModel> ModelLoader::create_cached_model(
   model_config.max_seq_len = info.context_length;
   model_config.norm_eps = 1e-6f;  // Default, could be in info
   model_config.rope_base = info.rope_freq_base;
+  model_config.int8_activations = config.int8_activations;
+  model_config.num_cpu_layers =
+      std::min(std::max(config.num_cpu_layers, 0), info.num_layers);
+
+  if (config.int8_activations) {
+    std::cerr << "[ModelLoader] Dynamic INT8 activation quantization enabled "
+              << "for quantized projections" << std::endl;
+  }
+  if (model_config.num_cpu_layers > 0) {
+    std::cerr << "[ModelLoader] CPU placement for the last "
+              << model_config.num_cpu_layers << " of " << info.num_layers
+              << " layers" << std::endl;
+  }
 
   std::cerr << "[ModelLoader] Model config: " << model_config.num_layers
             << " layers, " << model_config.num_heads << " heads, "
@@ -343,11 +1155,13 @@ std::shared_ptr<graph::CachedLlamaModel> ModelLoader::create_cached_model(
   // Create model
   auto model = std::make_shared<graph::CachedLlamaModel>(model_config, pager);
 
-  // Load weights based on format
+  // Load weights based on format. Streaming only applies to the GGUF
+  // mmap path; safetensors goes through MLX's bulk loader
   if (info.format == registry::ModelFormat::SAFETENSORS) {
     return load_model_from_safetensors(model, info);
   } else if (info.format == registry::ModelFormat::GGUF) {
-    return load_model_from_gguf_mmap(model, loader, info);
+    return load_model_from_gguf_mmap(model, loader, info, config,
+                                     stream_thread);
   } else {
     last_error_ = "Unsupported model format";
     std::cerr << "[ModelLoader] " << last_error_ << std::endl;
@@ -381,15 +1195,26 @@ std::optional<LoadedModel> ModelLoader::load_model(
                     : "UNKNOWN")
             << std::endl;
 
-  // STEP 2: Load weights via mmap
-  auto loader =
-      load_weights(info.file_path, config.prefetch_weights, config.lock_weights);
+  // STEP 2: Load weights via mmap. A recorded native snapshot takes
+  // priority: the reload becomes a pure mmap + index registration with
+  // zero GGUF parsing. Any snapshot problem falls back to the source
+  std::shared_ptr<MMapWeightLoader> loader;
+  bool from_snapshot = false;
+  if (info.format == registry::ModelFormat::GGUF && config.snapshot_weights) {
+    loader = open_snapshot(info, config);
+    from_snapshot = (loader != nullptr);
+  }
   if (!loader) {
-    return std::nullopt;  // last_error_ set by load_weights()
+    loader = load_weights(info.file_path, config.prefetch_weights,
+                          config.lock_weights);
+    if (!loader) {
+      return std::nullopt;  // last_error_ set by load_weights()
+    }
   }
 
-  // STEP 3: Register GGUF tensors (if GGUF format)
-  if (info.format == registry::ModelFormat::GGUF) {
+  // STEP 3: Register GGUF tensors (snapshot loads registered them
+  // straight from the snapshot index)
+  if (info.format == registry::ModelFormat::GGUF && !from_snapshot) {
     if (!load_gguf_tensors(loader, info.file_path)) {
       return std::nullopt;  // last_error_ set by load_gguf_tensors()
     }
@@ -414,12 +1239,25 @@ std::optional<LoadedModel> ModelLoader::load_model(
     return std::nullopt;
   }
 
-  // STEP 6: Create CachedLlamaModel and load weights
-  auto model = create_cached_model(loader, info, pager);
+  // STEP 6: Create CachedLlamaModel and load weights. With stream_weights
+  // this returns once the embedding table and block 0 are resident; the
+  // stream thread keeps loading the remaining layers in the background
+  std::shared_ptr<std::thread> stream_thread;
+  auto model =
+      create_cached_model(loader, info, pager, updated_config, &stream_thread);
   if (!model) {
     return std::nullopt;
   }
 
+  // STEP 6.5: Convert-once snapshot. After a successful load from the
+  // source GGUF, serialize the registered tensors page-aligned so the
+  // next load of this model skips parsing entirely. Skipped while
+  // streaming: the stream thread owns the loader's mapping table
+  if (config.snapshot_weights && !from_snapshot && !stream_thread &&
+      info.format == registry::ModelFormat::GGUF) {
+    write_snapshot(loader, info);
+  }
+
   // STEP 7: Create Engine
   runtime::GenerationConfig gen_config;
   gen_config.max_seq_len = info.context_length;
@@ -431,6 +1269,111 @@ std::optional<LoadedModel> ModelLoader::load_model(
   auto engine =
       std::make_shared<runtime::Engine>(model, pager, tokenizer, gen_config);
 
+  // STEP 7.1: Layer a prefix cache over the pager so repeated system
+  // prompts and multi-turn conversations reuse cached KV blocks
+  // copy-on-write instead of re-prefilling the shared history
+  if (config.use_cached_attention && config.prefix_cache_blocks > 0) {
+    runtime::kv::PrefixCacheConfig prefix_config;
+    prefix_config.max_cached_blocks = config.prefix_cache_blocks;
+    prefix_config.ttl_seconds = config.prefix_cache_ttl_seconds;
+    engine->set_prefix_cache(
+        std::make_shared<runtime::kv::PrefixCache>(pager, prefix_config));
+  }
+
+  // STEP 7.5: Attach draft model for speculative decoding if configured.
+  // A failed draft load is non-fatal: the engine simply runs without
+  // speculation
+  if (!config.draft_model_path.empty()) {
+    std::cerr << "[ModelLoader] Loading draft model from "
+              << config.draft_model_path << std::endl;
+    std::shared_ptr<graph::LlamaModel> draft_model =
+        graph::load_llama_model(config.draft_model_path);
+    if (draft_model) {
+      engine->set_draft_model(draft_model, config.speculative);
+    } else {
+      std::cerr << "[ModelLoader] Failed to load draft model; continuing "
+                   "without speculative decoding"
+                << std::endl;
+    }
+  }
+
+  // STEP 7.55: Attach registered LoRA adapters. Deltas bind as low-rank
+  // factors on the affected projections - no merged weight copies - so
+  // several fine-tuned variants of one base stay resident for the cost
+  // of their rank-r factors. A failed adapter load is non-fatal: the
+  // model simply serves without that adapter
+  for (const auto& adapter_info : registry_->get_adapters(info.id)) {
+    if (adapter_info.adapter_type != "lora" &&
+        adapter_info.adapter_type != "qlora") {
+      continue;  // ia3 etc. not supported yet
+    }
+    auto adapter = graph::LoRAAdapter::load(
+        adapter_info.file_path, adapter_info.name, adapter_info.scale,
+        adapter_info.target_modules);
+    if (!adapter) {
+      std::cerr << "[ModelLoader] Failed to load adapter " << adapter_info.name
+                << " from " << adapter_info.file_path
+                << "; continuing without it" << std::endl;
+      continue;
+    }
+    size_t bound = model->attach_adapter(adapter);
+    std::cerr << "[ModelLoader] Attached adapter " << adapter_info.name
+              << " (rank " << adapter->rank() << ", " << bound
+              << " projections)" << std::endl;
+  }
+
+  // STEP 7.6: Warm up MLX graphs over shape buckets so the first
+  // request after this load doesn't pay cold kernel compilation.
+  // Skipped while streaming: warmup forwards would block on the last
+  // layer's latch and erase the time-to-first-token win
+  if (config.warmup_on_load && !stream_thread) {
+    std::cerr << "[ModelLoader] Warming up graphs for " << info.name
+              << std::endl;
+    engine->warmup(config.warmup);
+  }
+
+  // STEP 7.7: Kernel autotune. Replay persisted winners for this GPU when
+  // the registry has them; otherwise micro-benchmark candidate dispatch
+  // variants on this model's shapes and persist the winners. The best
+  // threadgroup width differs between M2 Pro and M4 Max, so tunings are
+  // keyed by device
+  if (config.autotune_kernels && info.num_heads > 0) {
+    kernels::AutotuneShapes shapes;
+    shapes.num_heads = info.num_heads;
+    shapes.num_kv_heads =
+        info.num_kv_heads > 0 ? info.num_kv_heads : info.num_heads;
+    shapes.head_dim = info.hidden_size / info.num_heads;
+    shapes.hidden_size = info.hidden_size;
+    shapes.intermediate_size = info.intermediate_size;
+    shapes.block_size = config.kv_block_size;
+
+    const std::string device = kernels::gpu_device_key();
+    bool all_cached = true;
+    for (const auto& [kernel, shape_key] : kernels::autotune_plan(shapes)) {
+      auto tuning = registry_->get_kernel_tuning(kernel, shape_key, device);
+      if (tuning.has_value()) {
+        kernels::apply_kernel_tuning(kernel, shape_key,
+                                     tuning->threadgroup_width);
+      } else {
+        all_cached = false;
+      }
+    }
+
+    if (!all_cached) {
+      std::cerr << "[ModelLoader] Autotuning kernel variants for " << device
+                << std::endl;
+      for (const auto& winner : kernels::autotune_kernels(shapes)) {
+        registry::KernelTuning tuning;
+        tuning.kernel = winner.kernel;
+        tuning.shape_key = winner.shape_key;
+        tuning.device = device;
+        tuning.threadgroup_width = winner.threadgroup_width;
+        tuning.latency_us = winner.latency_us;
+        registry_->set_kernel_tuning(tuning);
+      }
+    }
+  }
+
   // STEP 8: Package result
   LoadedModel result;
   result.model = model;
@@ -440,6 +1383,7 @@ std::optional<LoadedModel> ModelLoader::load_model(
   result.info = info;
   result.loader = loader;  // Keep alive for mmap
   result.config = gen_config;
+  result.stream_thread = stream_thread;  // Joined when the model unloads
 
   // Update registry
   registry_->touch_model(info.id);
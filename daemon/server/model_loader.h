@@ -3,9 +3,15 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "../../core/graph/model.h"
 #include "../../core/runtime/engine.h"
@@ -33,6 +39,10 @@ struct LoadedModel {
   // Weight loader (keep alive for mmap)
   std::shared_ptr<MMapWeightLoader> loader;
 
+  // Background loader for layer-streamed loads; the deleter joins it,
+  // so the last LoadedModel reference waits for the stream to finish
+  std::shared_ptr<std::thread> stream_thread;
+
   // Generation config used
   runtime::GenerationConfig config;
 };
@@ -51,6 +61,22 @@ struct LoadModelConfig {
   int kv_num_heads = 32;     // number of KV heads
   int kv_head_dim = 128;     // head dimension
 
+  // Per-model cap on KV blocks when co-resident with other models on
+  // the shared arena (0 = unlimited). E.g. give an 8B chat model 7168
+  // of 8192 blocks and a 1B classifier the rest
+  int kv_quota_blocks = 0;
+
+  // Shared-prefix / conversation KV reuse: completed requests index
+  // their KV blocks in the engine's prefix cache, so a follow-up chat
+  // turn (same history plus one new message) attaches the cached blocks
+  // copy-on-write and prefills only the delta tokens. Budget is in KV
+  // blocks pinned by the cache; 0 disables prefix caching
+  int prefix_cache_blocks = 512;
+
+  // Seconds an idle conversation's cached blocks stay pinned before
+  // TTL eviction reclaims them (0 = budget-driven LRU only)
+  int prefix_cache_ttl_seconds = 600;
+
   // Generation defaults
   int max_seq_len = 4096;
   int max_new_tokens = 2048;
@@ -60,6 +86,58 @@ struct LoadModelConfig {
 
   // Whether to lock weights in memory (prevent swapping)
   bool lock_weights = false;
+
+  // Whether to run graph warmup after load (pre-compiles MLX kernels
+  // and traces over shape buckets so the first request after a model
+  // swap is not 3-5x slower than steady state)
+  bool warmup_on_load = true;
+
+  // Shape buckets for warmup (see runtime::WarmupConfig defaults)
+  runtime::WarmupConfig warmup;
+
+  // Whether to autotune kernel dispatch variants after load. Persisted
+  // winners for this GPU are replayed from the registry's kernel_tunings
+  // table; a fresh micro-benchmark only runs when none are recorded
+  bool autotune_kernels = true;
+
+  // Layer-streamed weight loading (GGUF mmap path only): load_model
+  // returns once the embeddings and layer 0 are assigned while a loader
+  // thread races ahead layer-by-layer; the forward pass blocks on a
+  // per-layer latch only if it catches up. Cuts time-to-first-token
+  // after a model swap to roughly one layer's load. Warmup and any
+  // other forward pass synchronize against the latches, so pair this
+  // with warmup_on_load=false to realize the latency win
+  bool stream_weights = false;
+
+  // Native snapshot caching (GGUF path): after the first load the
+  // registered tensors are re-serialized page-aligned into an
+  // .mlxr-snap file recorded in the registry, and later loads mmap the
+  // snapshot with zero GGUF parsing. Stale snapshots (source file size
+  // changed) are ignored and rewritten
+  bool snapshot_weights = true;
+
+  // Dynamic INT8 activation quantization for quantized-weight layers:
+  // activations are quantized per row on-GPU (absmax scales) and fed to
+  // the int8 q_gemm variant, halving activation traffic on
+  // bandwidth-bound decode. Only affects GGUF models whose projections
+  // take the fused quantized path
+  bool int8_activations = false;
+
+  // Heterogeneous placement: run the last N transformer layers (plus the
+  // final norm and LM head) on the CPU device instead of the GPU. Lets a
+  // model larger than comfortable GPU residency serve at degraded speed
+  // on unified memory - no weight copies, just execution routing. Set
+  // per model via the performance.num_cpu_layers key in
+  // configs/models/*.yaml (0 = everything on GPU)
+  int num_cpu_layers = 0;
+
+  // Optional draft model for speculative decoding (empty = disabled).
+  // Path to a smaller model directory loadable by graph::load_llama_model;
+  // must share the target model's tokenizer/vocabulary
+  std::string draft_model_path;
+
+  // Speculation settings applied when a draft model is configured
+  spec::SpeculativeConfig speculative;
 };
 
 /**
@@ -117,6 +195,126 @@ class ModelLoader {
                                                const LoadModelConfig& config =
                                                    LoadModelConfig());
 
+  /**
+   * @brief Get a resident model, loading it if necessary
+   * @param model_name Model name or ID
+   * @param config Loading configuration (used only on first load)
+   * @return Loaded model components, or nullopt on failure
+   *
+   * Multi-model residency: models acquired through this method stay
+   * loaded (engine, weights, pager) until release_model(), so serving
+   * a 1B draft/classifier alongside an 8B chat model does not force
+   * unload/reload cycles. Co-resident models with matching KV geometry
+   * draw blocks from one shared arena (see create_pager); use
+   * kv_quota_blocks to partition it.
+   *
+   * When a memory budget is set (set_memory_budget), residents act as
+   * a warm pool: loading a model that would push the pool past the
+   * budget evicts least-recently-acquired models first. Switching
+   * between the 3-4 models that fit the budget is then a map lookup;
+   * only the model that fell out of the pool pays a reload.
+   */
+  std::optional<LoadedModel> acquire_model(const std::string& model_name,
+                                           const LoadModelConfig& config =
+                                               LoadModelConfig());
+
+  /**
+   * @brief Evict a resident model
+   * @param model_name Model name used at acquire_model() time
+   * @return True if the model was resident
+   *
+   * Drops the loader's reference; the engine and weights are freed
+   * once in-flight requests holding the shared_ptrs finish.
+   */
+  bool release_model(const std::string& model_name);
+
+  /**
+   * @brief Get a resident model without loading
+   * @param model_name Model name used at acquire_model() time
+   * @return Model components, or nullopt if not resident
+   */
+  std::optional<LoadedModel> get_resident_model(
+      const std::string& model_name) const;
+
+  /**
+   * @brief Names of all resident models
+   */
+  std::vector<std::string> resident_model_names() const;
+
+  /**
+   * @brief Write the warm-restart manifest
+   * @param path Manifest file path
+   * @return true on success
+   *
+   * Serializes the resident model set (least-recently-used first, so a
+   * restore replays acquisition order and rebuilds the same LRU
+   * ordering) with a timestamp. Weights are file-backed read-only
+   * mmaps, so their pages survive the process in the unified page
+   * cache; the restarted daemon reattaches by remapping the same files
+   * and pays parse + graph build instead of a cold weight load.
+   */
+  bool write_warm_manifest(const std::string& path) const;
+
+  /**
+   * @brief Read and validate a warm-restart manifest
+   * @param path Manifest file path
+   * @param max_age_seconds Manifests older than this are ignored (the
+   *        page cache has likely moved on; a cold load is honest)
+   * @return Resident model names in re-acquisition order; empty when
+   *         the manifest is missing, stale, or malformed
+   *
+   * The caller removes the file after a restore attempt so a crash
+   * loop cannot replay a manifest forever.
+   */
+  static std::vector<std::string> read_warm_manifest(
+      const std::string& path, int max_age_seconds = 300);
+
+  /**
+   * @brief Callback invoked when the warm pool evicts a model
+   * Runs synchronously inside acquire_model() on the loading thread,
+   * after the loader has dropped its reference. Must not call back
+   * into the loader. Servers use this to drop their own engine
+   * references so the evicted weights actually unmap.
+   */
+  using EvictionCallback = std::function<void(const std::string& model_name)>;
+
+  /**
+   * @brief Register the warm-pool eviction callback
+   */
+  void set_eviction_callback(EvictionCallback callback);
+
+  /**
+   * @brief Set the unified-memory budget for resident models
+   * @param budget_bytes Total weight bytes the warm pool may hold
+   *        (0 = unlimited, the default)
+   *
+   * Sizes are estimated up front from registry metadata (see
+   * estimate_model_bytes), so eviction happens before the new
+   * model's weights are mapped, not after memory pressure hits.
+   */
+  void set_memory_budget(uint64_t budget_bytes);
+
+  /**
+   * @brief Current warm-pool memory budget (0 = unlimited)
+   */
+  uint64_t memory_budget() const;
+
+  /**
+   * @brief Estimated weight bytes held by resident models
+   */
+  uint64_t resident_bytes() const;
+
+  /**
+   * @brief Estimate a model's resident weight footprint
+   * @param info Model metadata from the registry
+   * @return Estimated bytes
+   *
+   * Weights are mmap'd straight from the model file, so file_size is
+   * the footprint; falls back to param_count at fp16 when the registry
+   * has no size recorded.
+   */
+  static uint64_t estimate_model_bytes(const registry::ModelInfo& info);
+
   /**
    * @brief Load tokenizer for a model
    * @param info Model metadata
@@ -154,12 +352,17 @@ class ModelLoader {
    * @param loader Weight loader
    * @param info Model metadata
    * @param pager KV cache pager
+   * @param config Load options (activation quantization, streaming, etc.)
+   * @param stream_thread Receives the background loader thread when
+   *        config.stream_weights kicks in (joined by LoadedModel)
    * @return Model instance, or nullptr on failure
    */
   std::shared_ptr<graph::CachedLlamaModel> create_cached_model(
       std::shared_ptr<MMapWeightLoader> loader,
       const registry::ModelInfo& info,
-      std::shared_ptr<runtime::kv::Pager> pager);
+      std::shared_ptr<runtime::kv::Pager> pager,
+      const LoadModelConfig& config,
+      std::shared_ptr<std::thread>* stream_thread);
 
   /**
    * @brief Create LlamaModel from weights (fallback, no Metal kernels)
@@ -180,6 +383,47 @@ class ModelLoader {
   bool load_gguf_tensors(std::shared_ptr<MMapWeightLoader> loader,
                          const std::string& file_path);
 
+  /**
+   * @brief Build a byte-level BPE tokenizer from GGUF metadata
+   *
+   * GGUF checkpoints whose tokenizer.ggml.model is "gpt2" (Qwen,
+   * GPT-style, Llama-3) embed the vocabulary and merges directly in the
+   * metadata and have no SentencePiece model file to point at. Returns
+   * nullptr for any other tokenizer model so the caller falls back to
+   * the path-based factory.
+   * @param file_path Path to GGUF file
+   * @return BPE tokenizer, or nullptr to fall back
+   */
+  std::shared_ptr<runtime::Tokenizer> load_bpe_tokenizer_from_gguf(
+      const std::string& file_path);
+
+  /**
+   * @brief Open a recorded native snapshot for a model, if one is usable
+   *
+   * Looks up the registry's snapshot_path tag, validates the snapshot
+   * against the current source file size, and returns a weight loader
+   * with every tensor already registered — no GGUF parsing. Any failure
+   * (missing, stale, corrupt) logs and returns nullptr so the caller
+   * falls back to the source file.
+   * @param info Model metadata
+   * @param config Load options (prefetch/lock)
+   * @return Loader over the snapshot file, or nullptr to fall back
+   */
+  std::shared_ptr<MMapWeightLoader> open_snapshot(
+      const registry::ModelInfo& info, const LoadModelConfig& config);
+
+  /**
+   * @brief Serialize the loader's registered tensors into a native
+   *        snapshot and record its path in the registry
+   *
+   * Best-effort: failures log a warning and leave the model serving
+   * from the source file.
+   * @param loader Weight loader over the source file
+   * @param info Model metadata
+   */
+  void write_snapshot(std::shared_ptr<MMapWeightLoader> loader,
+                      const registry::ModelInfo& info);
+
   /**
    * @brief Load model weights from safetensors format
    * @param model Model instance to load weights into
@@ -195,15 +439,55 @@ class ModelLoader {
    * @param model Model instance to load weights into
    * @param loader Weight loader with registered tensors
    * @param info Model metadata
+   * @param config Load options (streaming, etc.)
+   * @param stream_thread Receives the background loader thread when
+   *        config.stream_weights kicks in (joined by LoadedModel)
    * @return Model instance with loaded weights, or nullptr on failure
    */
   std::shared_ptr<graph::CachedLlamaModel> load_model_from_gguf_mmap(
       std::shared_ptr<graph::CachedLlamaModel> model,
       std::shared_ptr<MMapWeightLoader> loader,
-      const registry::ModelInfo& info);
+      const registry::ModelInfo& info,
+      const LoadModelConfig& config,
+      std::shared_ptr<std::thread>* stream_thread);
+
+  /**
+   * @brief Resident model plus warm-pool bookkeeping
+   */
+  struct ResidentEntry {
+    LoadedModel model;
+    uint64_t resident_bytes = 0;  // estimate_model_bytes() at load time
+    uint64_t last_used = 0;       // use_counter_ stamp for LRU ordering
+  };
+
+  /**
+   * @brief Evict LRU residents until incoming_bytes fits the budget
+   * Caller must hold residency_mutex_. Evicted names are appended to
+   * evicted so the callback can run after the lock is released.
+   * @param incoming_bytes Estimated size of the model about to load
+   * @param evicted Output list of evicted model names
+   */
+  void evict_for_budget_locked(uint64_t incoming_bytes,
+                               std::vector<std::string>* evicted);
 
   std::shared_ptr<registry::ModelRegistry> registry_;
   std::string last_error_;
+
+  // Multi-model residency state
+  mutable std::mutex residency_mutex_;
+  std::unordered_map<std::string, ResidentEntry> resident_models_;
+
+  // Warm-pool state (guarded by residency_mutex_)
+  uint64_t memory_budget_bytes_ = 0;  // 0 = unlimited
+  uint64_t use_counter_ = 0;          // monotonic stamp for LRU
+  EvictionCallback eviction_callback_;
+
+  // KV arena shared by co-resident models with matching geometry
+  // (num_layers/num_kv_heads/head_dim/block_size); models whose
+  // geometry differs get a private arena since block tensor shapes
+  // are fixed at arena creation
+  std::shared_ptr<runtime::kv::Arena> shared_arena_;
+  runtime::kv::ArenaConfig shared_arena_config_;
 };
 
 }  // namespace server
@@ -0,0 +1,523 @@
+// Copyright © 2025 MLXR Development
+// Parallel chunked model downloader implementation
+
+// Include cpp-httplib FIRST before any other includes (fixes namespace
+// conflicts)
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include "model_puller.h"
+
+#include <httplib.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "../registry/model_registry.h"
+
+namespace mlxr {
+namespace server {
+
+namespace {
+
+// ==============================================================================
+// Incremental SHA-256 (FIPS 180-4), self-contained so the hasher thread
+// can fold chunks into the digest as they land
+// ==============================================================================
+
+class Sha256 {
+ public:
+  Sha256() { reset(); }
+
+  void reset() {
+    state_[0] = 0x6a09e667;
+    state_[1] = 0xbb67ae85;
+    state_[2] = 0x3c6ef372;
+    state_[3] = 0xa54ff53a;
+    state_[4] = 0x510e527f;
+    state_[5] = 0x9b05688c;
+    state_[6] = 0x1f83d9ab;
+    state_[7] = 0x5be0cd19;
+    bit_count_ = 0;
+    buffer_len_ = 0;
+  }
+
+  void update(const uint8_t* data, size_t len) {
+    bit_count_ += static_cast<uint64_t>(len) * 8;
+
+    while (len > 0) {
+      size_t take = std::min(len, sizeof(buffer_) - buffer_len_);
+      std::memcpy(buffer_ + buffer_len_, data, take);
+      buffer_len_ += take;
+      data += take;
+      len -= take;
+
+      if (buffer_len_ == sizeof(buffer_)) {
+        process_block(buffer_);
+        buffer_len_ = 0;
+      }
+    }
+  }
+
+  // Finalizes and returns the lowercase hex digest
+  std::string hex_digest() {
+    uint64_t bits = bit_count_;
+
+    // Pad: 0x80, zeros, then the 64-bit big-endian length
+    uint8_t pad = 0x80;
+    update(&pad, 1);
+    bit_count_ -= 8;  // Padding does not count toward the message length
+
+    uint8_t zero = 0x00;
+    while (buffer_len_ != 56) {
+      update(&zero, 1);
+      bit_count_ -= 8;
+    }
+
+    uint8_t length_bytes[8];
+    for (int i = 7; i >= 0; i--) {
+      length_bytes[i] = static_cast<uint8_t>(bits & 0xff);
+      bits >>= 8;
+    }
+    update(length_bytes, 8);
+
+    std::ostringstream oss;
+    for (uint32_t word : state_) {
+      oss << std::hex << std::setfill('0') << std::setw(8) << word;
+    }
+    return oss.str();
+  }
+
+ private:
+  static uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+  }
+
+  void process_block(const uint8_t* block) {
+    static const uint32_t K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
+        0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
+        0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
+        0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+        0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
+        0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+        0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+        0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
+        0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
+        0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
+        0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+        0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+      w[i] = (static_cast<uint32_t>(block[i * 4]) << 24) |
+             (static_cast<uint32_t>(block[i * 4 + 1]) << 16) |
+             (static_cast<uint32_t>(block[i * 4 + 2]) << 8) |
+             static_cast<uint32_t>(block[i * 4 + 3]);
+    }
+    for (int i = 16; i < 64; i++) {
+      uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+    uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+
+    for (int i = 0; i < 64; i++) {
+      uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+      uint32_t ch = (e & f) ^ (~e & g);
+      uint32_t temp1 = h + s1 + ch + K[i] + w[i];
+      uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+      uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+      uint32_t temp2 = s0 + maj;
+
+      h = g;
+      g = f;
+      f = e;
+      e = d + temp1;
+      d = c;
+      c = b;
+      b = a;
+      a = temp1 + temp2;
+    }
+
+    state_[0] += a;
+    state_[1] += b;
+    state_[2] += c;
+    state_[3] += d;
+    state_[4] += e;
+    state_[5] += f;
+    state_[6] += g;
+    state_[7] += h;
+  }
+
+  uint32_t state_[8];
+  uint64_t bit_count_;
+  uint8_t buffer_[64];
+  size_t buffer_len_;
+};
+
+// Split "scheme://host[:port]/path" into the httplib client base and the
+// request path
+bool split_url(const std::string& url, std::string& base, std::string& path) {
+  size_t scheme_end = url.find("://");
+  if (scheme_end == std::string::npos) {
+    return false;
+  }
+  size_t path_start = url.find('/', scheme_end + 3);
+  if (path_start == std::string::npos) {
+    base = url;
+    path = "/";
+  } else {
+    base = url.substr(0, path_start);
+    path = url.substr(path_start);
+  }
+  return true;
+}
+
+inline bool bitmap_test(const std::vector<uint8_t>& bitmap, int64_t idx) {
+  return (bitmap[idx / 8] >> (idx % 8)) & 1;
+}
+
+inline void bitmap_set(std::vector<uint8_t>& bitmap, int64_t idx) {
+  bitmap[idx / 8] |= static_cast<uint8_t>(1 << (idx % 8));
+}
+
+// Shared state between range workers and the hasher thread
+struct PullSharedState {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<uint8_t> bitmap;   // Chunks fully written to disk
+  std::vector<bool> claimed;     // Chunks claimed by a worker
+  int64_t downloaded_bytes = 0;  // Bytes on disk (including resumed)
+  bool cancelled = false;
+  std::string error;
+};
+
+}  // anonymous namespace
+
+ModelPuller::ModelPuller(std::shared_ptr<registry::ModelRegistry> registry,
+                         const PullConfig& config)
+    : registry_(std::move(registry)), config_(config) {}
+
+ModelPuller::~ModelPuller() = default;
+
+std::string ModelPuller::compute_sha256_hex(const std::string& data) {
+  Sha256 sha;
+  sha.update(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+  return sha.hex_digest();
+}
+
+PullResult ModelPuller::pull(const std::string& url,
+                             const std::string& dest_path,
+                             const std::string& expected_sha256,
+                             PullProgressCallback progress) {
+  PullResult result;
+
+  std::string base, path;
+  if (!split_url(url, base, path)) {
+    result.error = "Invalid URL: " + url;
+    return result;
+  }
+
+  httplib::Client client(base);
+  client.set_follow_location(true);
+  client.set_connection_timeout(30);
+  client.set_read_timeout(120);
+
+  // Probe size and range support
+  auto head = client.Head(path);
+  if (!head || head->status >= 400) {
+    result.error = "Failed to reach " + url;
+    return result;
+  }
+
+  int64_t total = 0;
+  if (head->has_header("Content-Length")) {
+    total = std::stoll(head->get_value("Content-Length"));
+  }
+  bool ranges_supported = head->has_header("Accept-Ranges") &&
+                          head->get_value("Accept-Ranges") == "bytes";
+
+  if (progress && !progress("pulling manifest", 0, total)) {
+    result.error = "Cancelled";
+    return result;
+  }
+
+  // Without range support (or a known size) fall back to one sequential
+  // connection with inline hashing
+  if (!ranges_supported || total <= 0) {
+    int fd = ::open(dest_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      result.error = "Cannot open " + dest_path;
+      return result;
+    }
+
+    Sha256 sha;
+    int64_t received = 0;
+    bool cancelled = false;
+    auto res = client.Get(path, [&](const char* data, size_t len) {
+      if (::write(fd, data, len) != static_cast<ssize_t>(len)) {
+        return false;
+      }
+      sha.update(reinterpret_cast<const uint8_t*>(data), len);
+      received += static_cast<int64_t>(len);
+      if (progress && !progress("downloading", received, total)) {
+        cancelled = true;
+        return false;
+      }
+      return true;
+    });
+    ::close(fd);
+
+    if (cancelled) {
+      result.error = "Cancelled";
+      return result;
+    }
+    if (!res || res->status >= 400) {
+      result.error = "Download failed for " + url;
+      return result;
+    }
+
+    result.sha256 = sha.hex_digest();
+    if (!expected_sha256.empty() && result.sha256 != expected_sha256) {
+      result.error = "SHA-256 mismatch for " + url;
+      return result;
+    }
+    result.success = true;
+    if (progress) {
+      progress("success", received, total);
+    }
+    return result;
+  }
+
+  // Parallel ranged path
+  const int64_t chunk_bytes = config_.chunk_bytes;
+  const int64_t num_chunks = (total + chunk_bytes - 1) / chunk_bytes;
+
+  PullSharedState shared;
+  shared.bitmap.assign(static_cast<size_t>((num_chunks + 7) / 8), 0);
+  shared.claimed.assign(static_cast<size_t>(num_chunks), false);
+
+  // Resume: adopt the persisted bitmap when the transfer geometry still
+  // matches and the partial file is present
+  if (registry_) {
+    auto saved = registry_->get_pull_state(url);
+    if (saved && saved->total_size == total &&
+        saved->chunk_size == chunk_bytes &&
+        saved->bitmap.size() == shared.bitmap.size() &&
+        ::access(dest_path.c_str(), F_OK) == 0) {
+      shared.bitmap = saved->bitmap;
+      for (int64_t i = 0; i < num_chunks; i++) {
+        if (bitmap_test(shared.bitmap, i)) {
+          shared.claimed[static_cast<size_t>(i)] = true;
+          int64_t offset = i * chunk_bytes;
+          shared.downloaded_bytes += std::min(chunk_bytes, total - offset);
+        }
+      }
+      std::cout << "[ModelPuller] Resuming pull of " << url << " ("
+                << shared.downloaded_bytes << "/" << total << " bytes on disk)"
+                << std::endl;
+    } else if (saved) {
+      registry_->clear_pull_state(url);
+    }
+  }
+
+  int fd = ::open(dest_path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    result.error = "Cannot open " + dest_path;
+    return result;
+  }
+  if (::ftruncate(fd, total) != 0) {
+    ::close(fd);
+    result.error = "Cannot preallocate " + dest_path;
+    return result;
+  }
+
+  auto persist_state = [&]() {
+    if (registry_) {
+      registry::PullState state;
+      state.total_size = total;
+      state.chunk_size = chunk_bytes;
+      state.bitmap = shared.bitmap;
+      registry_->save_pull_state(url, state);
+    }
+  };
+
+  // Range workers: claim the next unfinished chunk, fetch it, write it
+  // at its offset, mark the bitmap and persist it
+  auto worker_fn = [&]() {
+    httplib::Client worker_client(base);
+    worker_client.set_follow_location(true);
+    worker_client.set_connection_timeout(30);
+    worker_client.set_read_timeout(120);
+
+    while (true) {
+      int64_t chunk = -1;
+      {
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        if (shared.cancelled || !shared.error.empty()) {
+          return;
+        }
+        for (int64_t i = 0; i < num_chunks; i++) {
+          if (!shared.claimed[static_cast<size_t>(i)]) {
+            shared.claimed[static_cast<size_t>(i)] = true;
+            chunk = i;
+            break;
+          }
+        }
+      }
+      if (chunk < 0) {
+        return;  // All chunks claimed
+      }
+
+      int64_t begin = chunk * chunk_bytes;
+      int64_t end = std::min(begin + chunk_bytes, total) - 1;
+
+      httplib::Headers headers = {
+          {"Range",
+           "bytes=" + std::to_string(begin) + "-" + std::to_string(end)}};
+      auto res = worker_client.Get(path, headers);
+
+      std::lock_guard<std::mutex> lock(shared.mutex);
+      if (!res || res->status != 206 ||
+          static_cast<int64_t>(res->body.size()) != end - begin + 1) {
+        // Release the claim so a retry (or a later resume) can refetch
+        shared.claimed[static_cast<size_t>(chunk)] = false;
+        if (shared.error.empty()) {
+          shared.error = "Range request failed at offset " +
+                         std::to_string(begin) + " for " + url;
+        }
+        shared.cv.notify_all();
+        return;
+      }
+
+      if (::pwrite(fd, res->body.data(), res->body.size(), begin) !=
+          static_cast<ssize_t>(res->body.size())) {
+        shared.claimed[static_cast<size_t>(chunk)] = false;
+        if (shared.error.empty()) {
+          shared.error = "Short write to " + dest_path;
+        }
+        shared.cv.notify_all();
+        return;
+      }
+
+      bitmap_set(shared.bitmap, chunk);
+      shared.downloaded_bytes += end - begin + 1;
+      persist_state();
+      shared.cv.notify_all();
+    }
+  };
+
+  // Hasher: consume chunks in file order as they complete, folding each
+  // into the running digest (resumed chunks are re-read from disk), and
+  // drive the progress callback
+  std::string digest;
+  auto hasher_fn = [&]() {
+    Sha256 sha;
+    std::vector<uint8_t> buffer(static_cast<size_t>(chunk_bytes));
+
+    for (int64_t i = 0; i < num_chunks; i++) {
+      {
+        std::unique_lock<std::mutex> lock(shared.mutex);
+        shared.cv.wait(lock, [&]() {
+          return bitmap_test(shared.bitmap, i) || shared.cancelled ||
+                 !shared.error.empty();
+        });
+        if (shared.cancelled || !shared.error.empty()) {
+          return;
+        }
+      }
+
+      int64_t begin = i * chunk_bytes;
+      int64_t len = std::min(chunk_bytes, total - begin);
+      if (::pread(fd, buffer.data(), static_cast<size_t>(len), begin) != len) {
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.error = "Short read from " + dest_path;
+        shared.cv.notify_all();
+        return;
+      }
+      sha.update(buffer.data(), static_cast<size_t>(len));
+
+      if (progress) {
+        int64_t completed;
+        {
+          std::lock_guard<std::mutex> lock(shared.mutex);
+          completed = shared.downloaded_bytes;
+        }
+        if (!progress("downloading", completed, total)) {
+          std::lock_guard<std::mutex> lock(shared.mutex);
+          shared.cancelled = true;
+          shared.cv.notify_all();
+          return;
+        }
+      }
+    }
+
+    digest = sha.hex_digest();
+  };
+
+  int num_workers = std::max(1, config_.num_connections);
+  std::vector<std::thread> workers;
+  workers.reserve(static_cast<size_t>(num_workers));
+  for (int i = 0; i < num_workers; i++) {
+    workers.emplace_back(worker_fn);
+  }
+  std::thread hasher(hasher_fn);
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  {
+    // Wake the hasher if the last worker exited on an error
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    shared.cv.notify_all();
+  }
+  hasher.join();
+  ::close(fd);
+
+  if (shared.cancelled) {
+    result.error = "Cancelled";
+    return result;  // Chunk state stays persisted for resume
+  }
+  if (!shared.error.empty()) {
+    result.error = shared.error;
+    return result;
+  }
+
+  result.sha256 = digest;
+  if (progress) {
+    progress("verifying sha256 digest", total, total);
+  }
+  if (!expected_sha256.empty() && digest != expected_sha256) {
+    // Corrupt transfer: discard the chunk map so the next attempt
+    // refetches from scratch
+    if (registry_) {
+      registry_->clear_pull_state(url);
+    }
+    result.error = "SHA-256 mismatch for " + url + " (got " + digest + ")";
+    return result;
+  }
+
+  if (registry_) {
+    registry_->clear_pull_state(url);
+  }
+  result.success = true;
+  if (progress) {
+    progress("success", total, total);
+  }
+  return result;
+}
+
+}  // namespace server
+}  // namespace mlxr
@@ -0,0 +1,98 @@
+// Copyright © 2025 MLXR Development
+// Parallel chunked model downloader with resume support
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mlxr {
+
+namespace registry {
+class ModelRegistry;
+}
+
+namespace server {
+
+/**
+ * @brief Configuration for a model pull
+ */
+struct PullConfig {
+  int num_connections = 4;               // Parallel range-request workers
+  int64_t chunk_bytes = 32 * 1024 * 1024;  // Range size per request (32 MB)
+};
+
+/**
+ * @brief Result of a completed (or failed) pull
+ */
+struct PullResult {
+  bool success = false;
+  std::string error;   // Populated on failure
+  std::string sha256;  // Hex digest of the downloaded file
+};
+
+/**
+ * @brief Progress callback: (status, completed_bytes, total_bytes).
+ * Return false to cancel the pull; partial chunk state is kept in the
+ * registry so a later pull of the same URL resumes where it stopped
+ */
+using PullProgressCallback =
+    std::function<bool(const std::string& status, int64_t completed,
+                       int64_t total)>;
+
+/**
+ * @brief Parallel chunked HTTP downloader for model files.
+ *
+ * The file is split into fixed-size chunks fetched by N concurrent
+ * range-request workers and written in place at their offsets. A chunk
+ * bitmap is persisted through the ModelRegistry after every completed
+ * chunk, so a dropped connection resumes from the last finished chunk
+ * instead of restarting the transfer. SHA-256 verification runs on a
+ * dedicated hasher thread that consumes chunks in file order as they
+ * land (re-reading already-present chunks from disk on resume), so the
+ * digest is ready when the last byte arrives instead of requiring a
+ * full-file pass at the end.
+ *
+ * Falls back to a single sequential connection when the server does not
+ * advertise range support.
+ */
+class ModelPuller {
+ public:
+  explicit ModelPuller(std::shared_ptr<registry::ModelRegistry> registry,
+                       const PullConfig& config = {});
+
+  ~ModelPuller();
+
+  // Non-copyable
+  ModelPuller(const ModelPuller&) = delete;
+  ModelPuller& operator=(const ModelPuller&) = delete;
+
+  /**
+   * @brief Download url to dest_path, resuming a previous partial pull
+   * of the same URL when one is recorded in the registry
+   * @param url Source URL (http or https)
+   * @param dest_path Destination file path
+   * @param expected_sha256 Hex digest to verify against (empty = skip)
+   * @param progress Progress callback, invoked as chunks complete
+   * @return Pull result with the computed digest
+   */
+  PullResult pull(const std::string& url, const std::string& dest_path,
+                  const std::string& expected_sha256,
+                  PullProgressCallback progress = nullptr);
+
+  /**
+   * @brief Compute the SHA-256 hex digest of a buffer (exposed for
+   * tests; the pull path hashes incrementally per chunk)
+   */
+  static std::string compute_sha256_hex(const std::string& data);
+
+ private:
+  std::shared_ptr<registry::ModelRegistry> registry_;
+  PullConfig config_;
+};
+
+}  // namespace server
+}  // namespace mlxr
@@ -12,6 +12,7 @@
 
 #include "../../core/runtime/engine.h"
 #include "../registry/model_registry.h"
+#include "model_puller.h"
 #include "sse_stream.h"
 
 using json = nlohmann::json;
@@ -806,6 +807,31 @@ void OllamaAPIHandler::stream_chat(const OllamaChatRequest& request,
 
 void OllamaAPIHandler::stream_pull(const OllamaPullRequest& request,
                                    StreamCallback callback) {
+  // Real pull when the registry knows where the model lives: parallel
+  // ranged download with per-chunk hashing and resume (see model_puller)
+  if (registry_) {
+    auto model = registry_->get_model_by_identifier(request.name);
+    if (model && !model->source_url.empty() && !model->file_path.empty()) {
+      ModelPuller puller(registry_);
+      auto result = puller.pull(
+          model->source_url, model->file_path, model->sha256,
+          [&](const std::string& status, int64_t completed, int64_t total) {
+            OllamaPullResponse chunk;
+            chunk.status = status;
+            if (status == "downloading") {
+              chunk.total = total;
+              chunk.completed = completed;
+            }
+            return callback(serialize_pull_response(chunk) + "\n");
+          });
+
+      if (!result.success) {
+        callback(create_error_response(result.error) + "\n");
+      }
+      return;
+    }
+  }
+
   // Simulate pull progress
   const std::vector<std::string> statuses = {
       "pulling manifest", "verifying sha256 digest",
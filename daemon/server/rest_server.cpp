@@ -8,8 +8,13 @@
 
 #include <httplib.h>
 
+#include <algorithm>
+#include <cctype>
 #include <chrono>
+#include <condition_variable>
 #include <ctime>
+#include <deque>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <random>
@@ -18,15 +23,30 @@
 
 // Socket headers for advanced configuration
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+
+#include "../registry/model_registry.h"
+#include "../telemetry/kernel_metrics.h"
+#include "embedding_batcher.h"
+#include "../telemetry/metrics.h"
+#include "../telemetry/trace.h"
 #include "graph/model.h"
+#include "kernels/kernel_profiler.h"
 #include "model_loader.h"
 #include "ollama_api.h"
+#include "runtime/ane_embedder.h"
 #include "runtime/engine.h"
+#include "runtime/grammar.h"
+#include "runtime/stop_matcher.h"
 #include "runtime/tokenizer/tokenizer.h"
 #include "scheduler/request.h"
+#include "scheduler/request_pool.h"
 #include "scheduler/scheduler.h"
 #include "scheduler_worker.h"
 #include "sse_stream.h"
@@ -218,38 +238,139 @@ std::optional<bool> extract_json_bool(const std::string& json,
 namespace mlxr {
 namespace server {
 
+// ==============================================================================
+// Bounded Serving Pool
+// ==============================================================================
+
+namespace {
+
+/**
+ * Fixed-size worker pool with a bounded pending queue, replacing
+ * httplib's default ThreadPool. The thread count never grows, so the
+ * serving layer is a fixed CPU footprint (size it to the E-cores) and
+ * the GPU-feeding worker keeps the performance cores. When the pending
+ * queue is full, enqueue() refuses and httplib closes the connection —
+ * shedding at accept instead of queueing into collapse. Request-level
+ * overload gets the friendlier 429 in route_request(); this bound is
+ * the backstop for connection floods that never reach routing.
+ */
+class BoundedTaskQueue : public httplib::TaskQueue {
+ public:
+  BoundedTaskQueue(int num_threads, size_t max_pending)
+      : max_pending_(max_pending) {
+    threads_.reserve(static_cast<size_t>(num_threads));
+    for (int i = 0; i < num_threads; i++) {
+      threads_.emplace_back([this] { worker_loop(); });
+    }
+  }
+
+  ~BoundedTaskQueue() override { shutdown(); }
+
+  bool enqueue(std::function<void()> fn) override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_ || pending_.size() >= max_pending_) {
+        return false;
+      }
+      pending_.push_back(std::move(fn));
+    }
+    cv_.notify_one();
+    return true;
+  }
+
+  void shutdown() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+ private:
+  void worker_loop() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) {
+          return;  // Stopping and drained
+        }
+        task = std::move(pending_.front());
+        pending_.pop_front();
+      }
+      task();
+    }
+  }
+
+  const size_t max_pending_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> pending_;
+  std::vector<std::thread> threads_;
+  bool stopping_ = false;
+};
+
+}  // anonymous namespace
+
 // ==============================================================================
 // Server Implementation Details
 // ==============================================================================
 
 struct RestServer::Impl {
-  std::unique_ptr<httplib::Server> http_server;
+  std::unique_ptr<httplib::Server> http_server;  // TCP listener
+  std::unique_ptr<httplib::Server> uds_server;   // Unix socket listener
   std::thread server_thread;
+  std::thread uds_thread;
+  std::string resolved_uds_path;  // unix_socket_path with "~" expanded
   bool running = false;
 
-  // HTTP server runner thread
-  void run_server(RestServer* server) {
-    std::cout << "Starting REST server on " << server->config_.bind_address
-              << ":" << server->config_.port << std::endl;
-
-    // Create HTTP server instance
-    http_server = std::make_unique<httplib::Server>();
+  // Expand a leading "~" to $HOME (the configured UDS path lives under
+  // ~/Library/Application Support)
+  static std::string expand_user_path(const std::string& path) {
+    if (path.empty() || path[0] != '~') {
+      return path;
+    }
+    const char* home = std::getenv("HOME");
+    if (!home) {
+      return path;
+    }
+    return std::string(home) + path.substr(1);
+  }
 
+  // Apply shared configuration (thread pool, timeouts, handlers,
+  // routes) to a listener instance; both transports serve the same
+  // API surface
+  void configure_listener(RestServer* server, httplib::Server* listener,
+                          bool is_uds) {
     // Configure thread pool for concurrent requests
-    http_server->new_task_queue = [&server] {
-      return new httplib::ThreadPool(server->config_.thread_pool_size);
+    listener->new_task_queue = [server] {
+      return new BoundedTaskQueue(
+          server->config_.thread_pool_size,
+          static_cast<size_t>(server->config_.max_pending_connections));
     };
 
     // Set socket options for better connection handling
-    http_server->set_socket_options([](socket_t sock) {
+    listener->set_socket_options([is_uds](socket_t sock) {
       // Enable SO_REUSEADDR to allow quick restart
       int yes = 1;
       setsockopt(sock, SOL_SOCKET, SO_REUSEADDR,
                  reinterpret_cast<const char*>(&yes), sizeof(yes));
 
       // Set TCP_NODELAY to disable Nagle's algorithm for lower latency
-      setsockopt(sock, IPPROTO_TCP, TCP_NODELAY,
-                 reinterpret_cast<const char*>(&yes), sizeof(yes));
+      // (TCP only - the option does not exist on AF_UNIX sockets)
+      if (!is_uds) {
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY,
+                   reinterpret_cast<const char*>(&yes), sizeof(yes));
+      }
 
       // Set socket send/receive buffer sizes
       int buffer_size = 256 * 1024; // 256KB
@@ -260,19 +381,19 @@ struct RestServer::Impl {
     });
 
     // Set connection timeouts using configurable values
-    http_server->set_read_timeout(server->config_.read_timeout_sec, 0);
-    http_server->set_write_timeout(server->config_.write_timeout_sec, 0);
+    listener->set_read_timeout(server->config_.read_timeout_sec, 0);
+    listener->set_write_timeout(server->config_.write_timeout_sec, 0);
 
     // Set keep-alive settings for connection reuse
-    http_server->set_keep_alive_max_count(server->config_.keep_alive_max_count);
-    http_server->set_keep_alive_timeout(server->config_.keep_alive_timeout_sec);
+    listener->set_keep_alive_max_count(server->config_.keep_alive_max_count);
+    listener->set_keep_alive_timeout(server->config_.keep_alive_timeout_sec);
 
     // Set payload size limits
-    http_server->set_payload_max_length(server->config_.payload_max_length);
+    listener->set_payload_max_length(server->config_.payload_max_length);
 
     // Setup CORS headers if enabled
     if (server->config_.enable_cors) {
-      http_server->set_default_headers({
+      listener->set_default_headers({
           {"Access-Control-Allow-Origin", "*"},
           {"Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS"},
           {"Access-Control-Allow-Headers", "Content-Type, Authorization"},
@@ -280,8 +401,8 @@ struct RestServer::Impl {
     }
 
     // Set up error handler for server errors
-    http_server->set_error_handler([](const httplib::Request& req,
-                                       httplib::Response& res) {
+    listener->set_error_handler([](const httplib::Request& req,
+                                    httplib::Response& res) {
       std::cerr << "[HTTP ERROR] " << res.status << " for " << req.method
                 << " " << req.path << std::endl;
 
@@ -291,9 +412,9 @@ struct RestServer::Impl {
     });
 
     // Set up exception handler to catch unhandled exceptions
-    http_server->set_exception_handler([](const httplib::Request& req,
-                                           httplib::Response& res,
-                                           std::exception_ptr ep) {
+    listener->set_exception_handler([](const httplib::Request& req,
+                                        httplib::Response& res,
+                                        std::exception_ptr ep) {
       std::string error_msg = "Unknown exception";
       try {
         std::rethrow_exception(ep);
@@ -311,14 +432,24 @@ struct RestServer::Impl {
     });
 
     // Set up logger for request/response tracking
-    http_server->set_logger([](const httplib::Request& req,
-                                const httplib::Response& res) {
+    listener->set_logger([](const httplib::Request& req,
+                             const httplib::Response& res) {
       std::cout << "[HTTP] " << req.method << " " << req.path
                 << " - " << res.status << std::endl;
     });
 
     // Register route handlers
-    register_routes(server);
+    register_routes(server, listener);
+  }
+
+  // TCP server runner thread
+  void run_server(RestServer* server) {
+    std::cout << "Starting REST server on " << server->config_.bind_address
+              << ":" << server->config_.port << std::endl;
+
+    // Create HTTP server instance
+    http_server = std::make_unique<httplib::Server>();
+    configure_listener(server, http_server.get(), /*is_uds=*/false);
 
     // Start listening
     bool listen_success = http_server->listen(
@@ -333,6 +464,38 @@ struct RestServer::Impl {
     std::cout << "REST server stopped" << std::endl;
   }
 
+  // UDS server runner thread
+  void run_uds_server(RestServer* server) {
+    std::cout << "Starting REST server on UDS " << resolved_uds_path
+              << std::endl;
+
+    // Make sure the run directory exists and remove any stale socket
+    // left behind by a crash (bind fails if the path exists)
+    std::error_code ec;
+    std::filesystem::path socket_path(resolved_uds_path);
+    std::filesystem::create_directories(socket_path.parent_path(), ec);
+    std::filesystem::remove(socket_path, ec);
+
+    uds_server = std::make_unique<httplib::Server>();
+    configure_listener(server, uds_server.get(), /*is_uds=*/true);
+    uds_server->set_address_family(AF_UNIX);
+
+    // Bind first so the socket file can be locked down to the owning
+    // user before any client can connect (port is ignored for AF_UNIX)
+    if (!uds_server->bind_to_port(resolved_uds_path.c_str(), 80)) {
+      std::cerr << "Failed to bind UDS at " << resolved_uds_path << std::endl;
+      return;
+    }
+    ::chmod(resolved_uds_path.c_str(), S_IRUSR | S_IWUSR);  // 0600
+
+    if (!uds_server->listen_after_bind()) {
+      std::cerr << "Failed to start UDS server at " << resolved_uds_path
+                << std::endl;
+    }
+
+    std::cout << "REST UDS server stopped" << std::endl;
+  }
+
   // Ollama API handlers
   static void handle_ollama_generate(RestServer* server,
                                      const httplib::Request& req,
@@ -549,7 +712,9 @@ struct RestServer::Impl {
   }
 
   // Register all API routes
-  void register_routes(RestServer* server) {
+  // Register all routes on a listener (shadows the http_server member
+  // so the same table serves both the TCP and UDS instances)
+  void register_routes(RestServer* server, httplib::Server* http_server) {
     // OpenAI-compatible endpoints
     http_server->Post(
         "/v1/chat/completions",
@@ -585,6 +750,70 @@ struct RestServer::Impl {
           res.set_content("{\"status\":\"ok\"}", "application/json");
         });
 
+    // Scheduler load snapshot for the data-parallel router: queue
+    // depths and free KV blocks drive its least-outstanding routing
+    http_server->Get(
+        "/internal/scheduler_stats",
+        [server](const httplib::Request&, httplib::Response& res) {
+          if (!server->scheduler_) {
+            res.status = 503;
+            res.set_content("{\"error\":\"scheduler not attached\"}",
+                            "application/json");
+            return;
+          }
+          auto stats = server->scheduler_->get_stats();
+          std::ostringstream oss;
+          oss << "{\"waiting_requests\":" << stats.waiting_requests
+              << ",\"prefilling_requests\":" << stats.prefilling_requests
+              << ",\"decoding_requests\":" << stats.decoding_requests
+              << ",\"paused_requests\":" << stats.paused_requests
+              << ",\"used_kv_blocks\":" << stats.used_kv_blocks
+              << ",\"available_kv_blocks\":" << stats.available_kv_blocks
+              << ",\"kv_utilization\":" << stats.kv_utilization
+              << ",\"effective_batch_tokens\":"
+              << stats.effective_batch_tokens
+              << ",\"tokens_per_second\":" << stats.tokens_per_second << "}";
+          res.set_content(oss.str(), "application/json");
+        });
+
+    // Metrics endpoint (Prometheus text format). Serves the background
+    // renderer's pre-rendered snapshot: the scrape path is one atomic
+    // pointer load plus the buffer write, so fleet-wide scraping never
+    // walks the registry under its lock alongside token serving
+    if (server->config_.enable_metrics) {
+      http_server->Get(
+          "/metrics", [](const httplib::Request&, httplib::Response& res) {
+            auto snapshot =
+                telemetry::MetricsRegistry::instance().prometheus_snapshot();
+            res.set_content(*snapshot, "text/plain; version=0.0.4");
+          });
+    }
+
+    // Debug tracing: start/stop recording, dump chrome://tracing JSON
+    // (load the dump in chrome://tracing or Perfetto to see the
+    // scheduler timeline)
+    http_server->Post(
+        "/debug/trace/start",
+        [](const httplib::Request&, httplib::Response& res) {
+          auto& recorder = telemetry::TraceRecorder::instance();
+          recorder.clear();
+          recorder.set_enabled(true);
+          res.set_content("{\"tracing\":\"started\"}", "application/json");
+        });
+
+    http_server->Post(
+        "/debug/trace/stop",
+        [](const httplib::Request&, httplib::Response& res) {
+          telemetry::TraceRecorder::instance().set_enabled(false);
+          res.set_content("{\"tracing\":\"stopped\"}", "application/json");
+        });
+
+    http_server->Get(
+        "/debug/trace", [](const httplib::Request&, httplib::Response& res) {
+          res.set_content(telemetry::TraceRecorder::instance().dump_json(),
+                          "application/json");
+        });
+
     // Ollama-compatible endpoints
     http_server->Post("/api/generate", [server](const httplib::Request& req,
                                                 httplib::Response& res) {
@@ -720,6 +949,12 @@ struct RestServer::Impl {
     if (http_server) {
       http_server->stop();
     }
+    if (uds_server) {
+      uds_server->stop();
+      // Remove the socket file so the next start binds cleanly
+      std::error_code ec;
+      std::filesystem::remove(resolved_uds_path, ec);
+    }
   }
 };
 
@@ -732,7 +967,18 @@ RestServer::RestServer(const ServerConfig& config)
       running_(false),
       initialized_(false),
       ollama_handler_(std::make_unique<OllamaAPIHandler>()),
-      impl_(std::make_unique<Impl>()) {}
+      impl_(std::make_unique<Impl>()) {
+  // Coalesce concurrent /v1/embeddings requests into batched forwards;
+  // the batcher blocks each handler thread until its batch is computed
+  EmbeddingBatcherConfig batcher_config;
+  batcher_config.window_ms = config_.embedding_batch_window_ms;
+  batcher_config.max_batch_size = config_.embedding_batch_max_size;
+  embedding_batcher_ = std::make_unique<EmbeddingBatcher>(
+      [this](const std::vector<std::vector<int>>& batch) {
+        return compute_embedding_batch(batch);
+      },
+      batcher_config);
+}
 
 RestServer::~RestServer() { stop(); }
 
@@ -745,11 +991,43 @@ bool RestServer::initialize() {
   std::cout << "Initializing REST server..." << std::endl;
 
   // Validate configuration
-  if (config_.port < 1 || config_.port > 65535) {
+  if (config_.enable_tcp && (config_.port < 1 || config_.port > 65535)) {
     std::cerr << "Invalid port: " << config_.port << std::endl;
     return false;
   }
 
+  if (!config_.enable_tcp &&
+      !(config_.enable_unix_socket && !config_.unix_socket_path.empty())) {
+    std::cerr << "No transport enabled (TCP and UDS both disabled)"
+              << std::endl;
+    return false;
+  }
+
+  // Opportunistic ANE offload for embeddings: load the CoreML bridge
+  // when configured. Creation failure is not fatal - embeddings simply
+  // keep running on the GPU path
+  if (config_.enable_ane_embeddings) {
+    if (runtime::AneEmbedder::is_available()) {
+      runtime::AneEmbedderConfig ane_config;
+      ane_config.compiled_model_path = config_.ane_embedding_model_path;
+      ane_embedder_ = runtime::AneEmbedder::create(ane_config);
+      if (!ane_embedder_) {
+        std::cerr << "ANE embedding backend unavailable; embeddings stay "
+                  << "on the GPU path" << std::endl;
+      }
+    } else {
+      std::cerr << "ANE not present on this machine; embeddings stay on "
+                << "the GPU path" << std::endl;
+    }
+  }
+
+  // Opt-in per-kernel timing; /metrics publishes the aggregates
+  kernels::KernelProfiler::instance().set_enabled(config_.profile_kernels);
+  if (config_.profile_kernels) {
+    std::cout << "Kernel profiling mode enabled (perturbs throughput)"
+              << std::endl;
+  }
+
   initialized_ = true;
   return true;
 }
@@ -770,8 +1048,37 @@ bool RestServer::start() {
   running_ = true;
   impl_->running = true;
 
-  // Start server thread
-  impl_->server_thread = std::thread(&Impl::run_server, impl_.get(), this);
+  // Start the metrics snapshot renderer so /metrics scrapes serve a
+  // pre-rendered buffer. The pre-render hook refreshes the per-kernel
+  // timing gauges (no-op unless profiling mode is on)
+  if (config_.enable_metrics) {
+    telemetry::MetricsRegistry::instance().start_snapshot_renderer(
+        config_.metrics_snapshot_interval_ms, [] {
+          telemetry::publish_kernel_profile(
+              telemetry::MetricsRegistry::instance());
+        });
+  }
+
+  // Start TCP listener thread
+  if (config_.enable_tcp) {
+    impl_->server_thread = std::thread(&Impl::run_server, impl_.get(), this);
+  }
+
+  // Start UDS listener thread (primary transport); each listener is
+  // its own httplib::Server since one instance binds one socket
+  if (config_.enable_unix_socket && !config_.unix_socket_path.empty()) {
+    impl_->resolved_uds_path =
+        Impl::expand_user_path(config_.unix_socket_path);
+    impl_->uds_thread = std::thread(&Impl::run_uds_server, impl_.get(), this);
+  }
+
+  // Warm restart: re-acquire the models the previous process had
+  // resident. Runs after the listeners are up so health checks answer
+  // immediately; requests naming a still-restoring model briefly fail
+  // as unknown, same as before any model load
+  if (!config_.warm_restart_manifest_path.empty()) {
+    restore_warm_models();
+  }
 
   return true;
 }
@@ -783,16 +1090,29 @@ void RestServer::stop() {
 
   std::cout << "Stopping REST server..." << std::endl;
 
+  // Write the warm-restart manifest while the resident set is intact;
+  // the relaunched process (launchd KeepAlive) restores it on start
+  if (!config_.warm_restart_manifest_path.empty() && model_loader_) {
+    model_loader_->write_warm_manifest(config_.warm_restart_manifest_path);
+  }
+
   running_ = false;
   impl_->running = false;
 
+  if (config_.enable_metrics) {
+    telemetry::MetricsRegistry::instance().stop_snapshot_renderer();
+  }
+
   // Gracefully shutdown HTTP server
   impl_->shutdown();
 
-  // Wait for server thread to finish
+  // Wait for listener threads to finish
   if (impl_->server_thread.joinable()) {
     impl_->server_thread.join();
   }
+  if (impl_->uds_thread.joinable()) {
+    impl_->uds_thread.join();
+  }
 
   std::cout << "REST server stopped successfully" << std::endl;
 }
@@ -840,6 +1160,22 @@ void RestServer::set_registry(
 // ==============================================================================
 
 HttpResponse RestServer::route_request(const HttpRequest& request) {
+  // Load shedding: past the in-flight ceiling, answer with a crisp 429
+  // and a retry hint rather than queueing into collapse. The counter
+  // covers the whole handler (RAII release), including the long waits
+  // streaming requests park on
+  struct InFlightSlot {
+    std::atomic<int>& counter;
+    ~InFlightSlot() { counter.fetch_sub(1, std::memory_order_relaxed); }
+  } in_flight_slot{active_requests_};
+  int in_flight = active_requests_.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (config_.max_concurrent_requests > 0 &&
+      in_flight > config_.max_concurrent_requests) {
+    auto response = create_error_response(429, "Server overloaded");
+    response.headers["Retry-After"] = "1";
+    return response;
+  }
+
   // Validate API key if configured
   if (!config_.api_key.empty() && !validate_api_key(request)) {
     return create_error_response(401, "Invalid API key");
@@ -869,6 +1205,152 @@ HttpResponse RestServer::route_request(const HttpRequest& request) {
 // Endpoint Handlers
 // ==============================================================================
 
+namespace {
+
+// Render the per-phase latency breakdown of a finished request as the
+// "timings" JSON object (milliseconds, two decimals)
+std::string serialize_request_timings(const scheduler::Request& request) {
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(2);
+  oss << "{";
+  oss << "\"queue_ms\":" << request.queue_time_ms() << ",";
+  oss << "\"prefill_ms\":" << request.prefill_time_ms() << ",";
+  oss << "\"decode_ms\":" << request.decode_time_ms() << ",";
+  oss << "\"detokenize_ms\":" << request.detokenize_ms << ",";
+  oss << "\"stream_write_ms\":" << request.stream_write_ms << ",";
+  oss << "\"total_ms\":" << request.total_time_ms();
+  oss << "}";
+  return oss.str();
+}
+
+// Render one generated token's logprob record as an OpenAI logprobs
+// content entry. Token texts come from decoding the IDs individually;
+// that loses cross-token byte merges, which matches how OpenAI reports
+// per-token text
+std::string serialize_token_logprob_entry(
+    const scheduler::TokenLogprob& record, runtime::Tokenizer* tokenizer) {
+  std::ostringstream oss;
+  oss << "{\"token\":\""
+      << escape_json_string(tokenizer->decode({record.token_id})) << "\",";
+  oss << "\"logprob\":" << record.logprob << ",";
+  oss << "\"top_logprobs\":[";
+  for (size_t i = 0; i < record.top_token_ids.size(); ++i) {
+    if (i > 0) {
+      oss << ",";
+    }
+    oss << "{\"token\":\""
+        << escape_json_string(tokenizer->decode({record.top_token_ids[i]}))
+        << "\",\"logprob\":" << record.top_logprobs[i] << "}";
+  }
+  oss << "]}";
+  return oss.str();
+}
+
+// Render a request's full logprob trail as the choice-level logprobs
+// object: {"content":[entry, ...]}
+std::string serialize_request_logprobs(const scheduler::Request& request,
+                                       runtime::Tokenizer* tokenizer) {
+  std::ostringstream oss;
+  oss << "{\"content\":[";
+  for (size_t i = 0; i < request.generated_logprobs.size(); ++i) {
+    if (i > 0) {
+      oss << ",";
+    }
+    oss << serialize_token_logprob_entry(request.generated_logprobs[i],
+                                         tokenizer);
+  }
+  oss << "]}";
+  return oss.str();
+}
+
+// Feed the breakdown into the phase histograms (no-ops until
+// StandardMetrics::initialize() has run)
+void observe_request_phases(const scheduler::Request& request) {
+  using telemetry::StandardMetrics;
+  if (StandardMetrics::queue_time_ms) {
+    StandardMetrics::queue_time_ms->observe(request.queue_time_ms());
+  }
+  if (StandardMetrics::prefill_time_ms) {
+    StandardMetrics::prefill_time_ms->observe(request.prefill_time_ms());
+  }
+  if (StandardMetrics::decode_time_ms) {
+    StandardMetrics::decode_time_ms->observe(request.decode_time_ms());
+  }
+  if (StandardMetrics::detokenize_time_ms) {
+    StandardMetrics::detokenize_time_ms->observe(request.detokenize_ms);
+  }
+  if (StandardMetrics::stream_write_time_ms) {
+    StandardMetrics::stream_write_time_ms->observe(request.stream_write_ms);
+  }
+}
+
+// Elapsed milliseconds since a steady_clock point
+double ms_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Stable FNV-1a hex digest for the deterministic-response cache key.
+// std::hash is not guaranteed stable across processes, and the cache
+// persists in SQLite across daemon restarts
+std::string fnv1a_hex(const std::string& data) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  std::ostringstream oss;
+  oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return oss.str();
+}
+
+// Canonical key for the deterministic-response cache: everything that
+// influences a temperature=0 completion's bytes. Fields are joined
+// with a separator that cannot appear in JSON string content unescaped
+std::string deterministic_cache_key(const std::string& model,
+                                    const std::string& prompt,
+                                    const scheduler::SamplingParams& params,
+                                    const std::string& response_format) {
+  std::ostringstream oss;
+  oss << model << '\x1f' << prompt << '\x1f' << params.max_tokens << '\x1f'
+      << params.top_k << '\x1f' << params.top_p << '\x1f'
+      << params.repetition_penalty << '\x1f' << response_format;
+  for (const auto& stop : params.stop_sequences) {
+    oss << '\x1f' << stop;
+  }
+  return fnv1a_hex(oss.str());
+}
+
+// Normalize embedding input text before hashing so trivially different
+// copies of the same chunk (trailing newline, doubled spaces from a
+// splitter) address the same cache row
+std::string normalize_embedding_text(const std::string& text) {
+  std::string normalized;
+  normalized.reserve(text.size());
+
+  bool in_whitespace = false;
+  for (unsigned char c : text) {
+    if (std::isspace(c)) {
+      in_whitespace = true;
+      continue;
+    }
+    if (in_whitespace && !normalized.empty()) {
+      normalized.push_back(' ');
+    }
+    in_whitespace = false;
+    normalized.push_back(static_cast<char>(c));
+  }
+
+  return normalized;
+}
+
+// Hot-tier size for the embedding cache; the persistent SQLite tier
+// holds the long tail
+constexpr size_t kEmbeddingHotTierEntries = 1024;
+
+}  // namespace
+
 HttpResponse RestServer::handle_chat_completion(const HttpRequest& request) {
   auto req = parse_chat_completion_request(request.body);
   if (!req.has_value()) {
@@ -891,8 +1373,12 @@ HttpResponse RestServer::handle_chat_completion(const HttpRequest& request) {
     prompt += msg.role + ": " + msg.content + "\n";
   }
 
-  // Tokenize prompt
-  std::vector<int> prompt_tokens = tokenizer_->encode(prompt);
+  // Tokenize asynchronously on the shared pool: the setup below (stop
+  // sequences, cache lookup, grammar compilation) overlaps with the
+  // encode, and the scheduler keeps admitting other requests instead of
+  // queueing behind a multi-KB prompt's tokenization
+  std::future<std::vector<int>> prompt_tokens_future =
+      tokenizer_->encode_async(prompt);
 
   // Create sampling parameters with improved defaults
   scheduler::SamplingParams sampling_params;
@@ -905,42 +1391,153 @@ HttpResponse RestServer::handle_chat_completion(const HttpRequest& request) {
       req->repetition_penalty.value_or(1.1f);  // Reduce repetition
   sampling_params.max_tokens = req->max_tokens.value_or(512);
 
-  // Parse stop sequences from request
+  // OpenAI logprobs: the worker extracts records on the GPU per step;
+  // alternatives are capped at the API maximum of 20
+  sampling_params.logprobs = req->logprobs.value_or(false);
+  if (sampling_params.logprobs) {
+    sampling_params.top_logprobs =
+        std::max(0, std::min(req->top_logprobs.value_or(0), 20));
+  }
+
+  // Parse stop sequences from request. Strings are matched incrementally
+  // over the detokenized output bytes (Aho-Corasick, handles stops that
+  // span token boundaries); single-token encodings also get the cheap
+  // token-ID check in the scheduler
   if (req->stop.has_value()) {
     for (const auto& stop_str : req->stop.value()) {
-      // Encode each stop string to token IDs
+      sampling_params.stop_sequences.push_back(stop_str);
       std::vector<int> stop_tokens = tokenizer_->encode(stop_str);
-      // For simplicity, use the last token as the stop token
-      // (In production, would need more sophisticated stop sequence matching)
-      if (!stop_tokens.empty()) {
-        sampling_params.stop_token_ids.push_back(stop_tokens.back());
+      if (stop_tokens.size() == 1) {
+        sampling_params.stop_token_ids.push_back(stop_tokens.front());
       }
     }
   }
 
+  // Deterministic-response cache: temperature=0, non-streaming requests
+  // are exact replays, so serve the stored byte-identical body on hit
+  // instead of redoing the GPU work. Timed responses are excluded —
+  // replaying stale timings would be misleading
+  bool cacheable = registry_ && config_.response_cache_max_entries > 0 &&
+                   sampling_params.temperature == 0.0f &&
+                   !req->stream.value_or(false) &&
+                   !req->include_timings.value_or(false);
+  std::string cache_key;
+  if (cacheable) {
+    cache_key = deterministic_cache_key(req->model, prompt, sampling_params,
+                                        req->response_format.value_or(""));
+    if (auto cached = registry_->get_cache_entry(req->model, cache_key)) {
+      HttpResponse http_response;
+      http_response.status_code = 200;
+      http_response.headers["Content-Type"] = "application/json";
+      http_response.body = std::move(*cached);
+      return http_response;
+    }
+  }
+
   // Generate unique request ID
   std::string request_id = generate_request_id();
 
-  // Create scheduler request
-  auto sched_request = std::make_shared<scheduler::Request>(
-      request_id, prompt, prompt_tokens, sampling_params);
+  // Create scheduler request with deferred tokens: the scheduler skips
+  // it at admission until set_prompt_tokens() lands. Pooled: completed
+  // requests are recycled with their token capacity intact
+  auto sched_request = scheduler::RequestPool::instance().acquire_deferred(
+      request_id, prompt, sampling_params);
+  sched_request->model_name = req->model;  // Route to the resident engine
+  sched_request->tenant_id = tenant_tag(request);  // Fair-share identity
+
+  // n>1 / best_of sampling: siblings fork this request's prefilled KV
+  // copy-on-write in the worker, so n completions cost ~one prefill
+  // instead of n. Capped so a single API call cannot monopolize the
+  // batch budget
+  int num_choices = std::max(1, std::min(req->n.value_or(1), 8));
+  sched_request->pending_forks = num_choices - 1;
+
+  // Installs the asynchronously encoded prompt tokens, making the
+  // request admissible; called right after submit in both branches
+  auto install_prompt_tokens = [&]() -> bool {
+    try {
+      sched_request->set_prompt_tokens(prompt_tokens_future.get());
+      return true;
+    } catch (const std::exception&) {
+      scheduler_->cancel_request(request_id);
+      return false;
+    }
+  };
+
+  // response_format json_object: constrain decoding to well-formed JSON.
+  // The compiled grammar is cached process-wide, so only the first such
+  // request pays the vocabulary scan
+  if (req->response_format.value_or("text") == "json_object") {
+    sched_request->grammar =
+        runtime::GrammarConstraint::create("json", tokenizer_.get());
+    if (!sched_request->grammar) {
+      return create_error_response(500, "Failed to compile response grammar");
+    }
+  }
 
   // Handle streaming vs non-streaming
   bool stream = req->stream.value_or(false);
 
+  // Multiplexing n streams over one SSE connection is not wired up;
+  // OpenAI clients that want parallel samples use non-streaming n
+  if (stream && num_choices > 1) {
+    return create_error_response(400, "Streaming with n>1 is not supported");
+  }
+
   if (stream) {
+    // Each stream parks this handler thread until generation finishes;
+    // cap them so a burst of streams cannot absorb the whole pool and
+    // starve health polling and short requests
+    if (config_.max_concurrent_streams > 0 &&
+        active_streams_.load(std::memory_order_relaxed) >=
+            config_.max_concurrent_streams) {
+      auto response = create_error_response(429, "Too many active streams");
+      response.headers["Retry-After"] = "1";
+      return response;
+    }
+    active_streams_.fetch_add(1, std::memory_order_relaxed);
+    struct StreamSlot {
+      std::atomic<int>& counter;
+      ~StreamSlot() { counter.fetch_sub(1, std::memory_order_relaxed); }
+    } stream_slot{active_streams_};
+
     // Implement SSE streaming
     std::string sse_content;
     std::mutex stream_mutex;
     bool stream_finished = false;
     std::condition_variable stream_cv;
 
+    // Incremental detokenizer: emits only the new UTF-8 bytes per token
+    // instead of re-decoding, and keeps spaces/multi-byte chars correct
+    runtime::DetokenizeStream detok(tokenizer_.get());
+
+    // Incremental stop-string matcher over the detokenized bytes; holds
+    // back potential stop-sequence prefixes so they are never streamed
+    runtime::StopSequenceMatcher stop_matcher(sampling_params.stop_sequences);
+
     // Set up streaming callback
     sched_request->token_callback = [&](int token_id, bool finished) {
       std::lock_guard<std::mutex> lock(stream_mutex);
 
-      // Decode single token to text
-      std::string token_text = tokenizer_->decode({token_id});
+      // Decode incrementally to text
+      auto detok_start = std::chrono::steady_clock::now();
+      std::string decoded = detok.push(token_id);
+      if (finished) {
+        decoded += detok.flush();
+      }
+
+      std::string token_text;
+      if (stop_matcher.empty()) {
+        token_text = std::move(decoded);
+      } else if (stop_matcher.feed(decoded, &token_text)) {
+        // Stop string completed: finish the stream here and flag the
+        // request so the worker terminates it on this step
+        sched_request->stop_sequence_hit = true;
+        finished = true;
+      } else if (finished) {
+        token_text += stop_matcher.flush();
+      }
+      sched_request->detokenize_ms += ms_since(detok_start);
 
       // Create SSE chunk
       ChatCompletionChunk chunk;
@@ -953,14 +1550,41 @@ HttpResponse RestServer::handle_chat_completion(const HttpRequest& request) {
       choice.delta.content = token_text;
       choice.finish_reason = finished ? "stop" : "";
 
+      // The worker appends the record before invoking this callback,
+      // so the back() entry belongs to this token
+      if (sampling_params.logprobs &&
+          !sched_request->generated_logprobs.empty()) {
+        std::ostringstream lp;
+        lp << "{\"content\":["
+           << serialize_token_logprob_entry(
+                  sched_request->generated_logprobs.back(), tokenizer_.get())
+           << "]}";
+        choice.logprobs_json = lp.str();
+      }
+
       chunk.choices.push_back(choice);
 
       // Serialize and append to SSE content
       std::string chunk_json = serialize_chat_completion_chunk(chunk);
+
+      // Splice the latency breakdown into the final chunk when the
+      // client asked for it
+      if (finished && req->include_timings.value_or(false)) {
+        chunk_json.insert(chunk_json.size() - 1,
+                          ",\"timings\":" +
+                              serialize_request_timings(*sched_request));
+      }
+
+      auto write_start = std::chrono::steady_clock::now();
       sse_content += "data: " + chunk_json + "\n\n";
 
       if (finished) {
         sse_content += "data: [DONE]\n\n";
+      }
+      sched_request->stream_write_ms += ms_since(write_start);
+
+      if (finished) {
+        observe_request_phases(*sched_request);
         stream_finished = true;
         stream_cv.notify_one();
       }
@@ -971,6 +1595,9 @@ HttpResponse RestServer::handle_chat_completion(const HttpRequest& request) {
     if (!submitted) {
       return create_error_response(503, "Request queue full");
     }
+    if (!install_prompt_tokens()) {
+      return create_error_response(500, "Failed to tokenize prompt");
+    }
 
     // Wait for streaming to complete (with timeout)
     {
@@ -1001,8 +1628,30 @@ HttpResponse RestServer::handle_chat_completion(const HttpRequest& request) {
   bool completed = false;
   std::string error_msg;
 
+  // With string stop sequences the output has to be matched as it is
+  // generated (the stop may span token boundaries), so detokenize
+  // incrementally and accumulate the pre-stop text
+  runtime::DetokenizeStream detok(tokenizer_.get());
+  runtime::StopSequenceMatcher stop_matcher(sampling_params.stop_sequences);
+  std::string accumulated_text;
+  bool incremental_decode = !stop_matcher.empty();
+
   // Set up completion callback
   sched_request->token_callback = [&](int token_id, bool finished) {
+    if (incremental_decode) {
+      auto detok_start = std::chrono::steady_clock::now();
+      std::string decoded = detok.push(token_id);
+      if (finished) {
+        decoded += detok.flush();
+      }
+      if (stop_matcher.feed(decoded, &accumulated_text)) {
+        sched_request->stop_sequence_hit = true;
+        finished = true;
+      } else if (finished) {
+        accumulated_text += stop_matcher.flush();
+      }
+      sched_request->detokenize_ms += ms_since(detok_start);
+    }
     if (finished) {
       std::lock_guard<std::mutex> lock(completion_mutex);
       completed = true;
@@ -1015,15 +1664,94 @@ HttpResponse RestServer::handle_chat_completion(const HttpRequest& request) {
   if (!submitted) {
     return create_error_response(503, "Request queue full");
   }
+  if (!install_prompt_tokens()) {
+    return create_error_response(500, "Failed to tokenize prompt");
+  }
+
+  // n>1: submit fork siblings that reuse the parent's prefill. The
+  // parent's tokens are already installed, so siblings submit ready
+  // and the scheduler releases them once the parent's prefill lands.
+  // Each sibling carries its own detokenizer/stop-matcher state
+  std::vector<scheduler::RequestPtr> sibling_requests;
+  std::vector<std::unique_ptr<runtime::DetokenizeStream>> sibling_detoks;
+  std::vector<std::unique_ptr<runtime::StopSequenceMatcher>> sibling_matchers;
+  std::vector<std::string> sibling_texts(num_choices - 1);
+  std::vector<char> sibling_done(num_choices - 1, 0);
+  auto cancel_all = [&]() {
+    scheduler_->cancel_request(request_id);
+    for (const auto& sibling : sibling_requests) {
+      scheduler_->cancel_request(sibling->request_id);
+    }
+  };
+  for (int i = 1; i < num_choices; ++i) {
+    std::string sibling_id = request_id + "-n" + std::to_string(i);
+    auto sibling = scheduler::RequestPool::instance().acquire(
+        sibling_id, sched_request->prompt, sched_request->prompt_token_ids,
+        sampling_params);
+    sibling->model_name = sched_request->model_name;
+    sibling->tenant_id = sched_request->tenant_id;
+    sibling->fork_of_request_id = request_id;
+    // Grammar state is per request: each sibling advances its own
+    if (sched_request->grammar) {
+      sibling->grammar =
+          runtime::GrammarConstraint::create("json", tokenizer_.get());
+    }
+
+    sibling_detoks.push_back(
+        std::make_unique<runtime::DetokenizeStream>(tokenizer_.get()));
+    sibling_matchers.push_back(std::make_unique<runtime::StopSequenceMatcher>(
+        sampling_params.stop_sequences));
+    runtime::DetokenizeStream* sib_detok = sibling_detoks.back().get();
+    runtime::StopSequenceMatcher* sib_matcher = sibling_matchers.back().get();
+    std::string* sib_text = &sibling_texts[i - 1];
+    char* sib_done = &sibling_done[i - 1];
+    scheduler::Request* sibling_raw = sibling.get();
+
+    sibling->token_callback = [&, sib_detok, sib_matcher, sib_text, sib_done,
+                               sibling_raw](int token_id, bool finished) {
+      if (incremental_decode) {
+        std::string decoded = sib_detok->push(token_id);
+        if (finished) {
+          decoded += sib_detok->flush();
+        }
+        if (sib_matcher->feed(decoded, sib_text)) {
+          sibling_raw->stop_sequence_hit = true;
+          finished = true;
+        } else if (finished) {
+          *sib_text += sib_matcher->flush();
+        }
+      }
+      if (finished) {
+        std::lock_guard<std::mutex> lock(completion_mutex);
+        *sib_done = 1;
+        completion_cv.notify_one();
+      }
+    };
+
+    if (!scheduler_->submit_request(sibling)) {
+      cancel_all();
+      return create_error_response(503, "Request queue full");
+    }
+    sibling_requests.push_back(sibling);
+  }
 
-  // Wait for completion (with timeout)
+  // Wait for completion of the parent and every sibling (with timeout)
   {
     std::unique_lock<std::mutex> lock(completion_mutex);
-    bool success = completion_cv.wait_for(lock, std::chrono::seconds(60),
-                                          [&] { return completed; });
+    bool success = completion_cv.wait_for(lock, std::chrono::seconds(60), [&] {
+      if (!completed) {
+        return false;
+      }
+      for (char done : sibling_done) {
+        if (!done) {
+          return false;
+        }
+      }
+      return true;
+    });
 
     if (!success) {
-      scheduler_->cancel_request(request_id);
+      cancel_all();
       return create_error_response(504, "Request timeout");
     }
   }
@@ -1033,9 +1761,18 @@ HttpResponse RestServer::handle_chat_completion(const HttpRequest& request) {
     return create_error_response(500, sched_request->error_message);
   }
 
-  // Decode generated tokens to text
-  std::string generated_text =
-      tokenizer_->decode(sched_request->generated_token_ids);
+  // Decode generated tokens to text (already accumulated, stop sequence
+  // excluded, when incremental matching ran)
+  std::string generated_text;
+  if (incremental_decode) {
+    generated_text = std::move(accumulated_text);
+  } else {
+    auto detok_start = std::chrono::steady_clock::now();
+    generated_text = tokenizer_->decode(sched_request->generated_token_ids);
+    sched_request->detokenize_ms += ms_since(detok_start);
+  }
+
+  observe_request_phases(*sched_request);
 
   // Create response
   ChatCompletionResponse response;
@@ -1061,19 +1798,67 @@ HttpResponse RestServer::handle_chat_completion(const HttpRequest& request) {
       choice.finish_reason = "stop";
   }
 
+  if (sampling_params.logprobs) {
+    choice.logprobs_json =
+        serialize_request_logprobs(*sched_request, tokenizer_.get());
+  }
+
   response.choices.push_back(choice);
 
+  // Sibling choices, in submission order. A failed sibling fails the
+  // whole call, matching how a failed parent is reported
+  for (size_t i = 0; i < sibling_requests.size(); ++i) {
+    const auto& sibling = sibling_requests[i];
+    if (sibling->state == scheduler::RequestState::FAILED) {
+      return create_error_response(500, sibling->error_message);
+    }
+
+    ChatCompletionChoice sibling_choice;
+    sibling_choice.index = static_cast<int>(i) + 1;
+    sibling_choice.message.role = "assistant";
+    if (incremental_decode) {
+      sibling_choice.message.content = std::move(sibling_texts[i]);
+    } else {
+      sibling_choice.message.content =
+          tokenizer_->decode(sibling->generated_token_ids);
+    }
+    sibling_choice.finish_reason =
+        sibling->finish_reason == scheduler::FinishReason::LENGTH ? "length"
+                                                                  : "stop";
+    if (sampling_params.logprobs) {
+      sibling_choice.logprobs_json =
+          serialize_request_logprobs(*sibling, tokenizer_.get());
+    }
+    response.choices.push_back(std::move(sibling_choice));
+  }
+
   response.usage.prompt_tokens = sched_request->num_prompt_tokens;
   response.usage.completion_tokens = sched_request->num_generated_tokens;
+  // Usage counts every sampled completion; the prompt is counted once
+  // (and with forking it really was prefilled once)
+  for (const auto& sibling : sibling_requests) {
+    response.usage.completion_tokens += sibling->num_generated_tokens;
+  }
   response.usage.total_tokens =
       response.usage.prompt_tokens + response.usage.completion_tokens;
 
+  if (req->include_timings.value_or(false)) {
+    response.timings_json = serialize_request_timings(*sched_request);
+  }
+
   // Serialize response
   HttpResponse http_response;
   http_response.status_code = 200;
   http_response.headers["Content-Type"] = "application/json";
   http_response.body = serialize_chat_completion_response(response);
 
+  // Store the deterministic result for replay (LRU-bounded)
+  if (cacheable &&
+      sched_request->state == scheduler::RequestState::COMPLETED) {
+    registry_->put_cache_entry(req->model, cache_key, http_response.body,
+                               config_.response_cache_max_entries);
+  }
+
   return http_response;
 }
 
@@ -1093,8 +1878,10 @@ HttpResponse RestServer::handle_completion(const HttpRequest& request) {
     return create_error_response(503, "Tokenizer not loaded");
   }
 
-  // Tokenize prompt
-  std::vector<int> prompt_tokens = tokenizer_->encode(req->prompt);
+  // Tokenize asynchronously (see handle_chat_completion): setup and
+  // scheduler admission of other requests overlap with the encode
+  std::future<std::vector<int>> prompt_tokens_future =
+      tokenizer_->encode_async(req->prompt);
 
   // Create sampling parameters with improved defaults
   scheduler::SamplingParams sampling_params;
@@ -1107,38 +1894,112 @@ HttpResponse RestServer::handle_completion(const HttpRequest& request) {
       req->repetition_penalty.value_or(1.1f);  // Reduce repetition
   sampling_params.max_tokens = req->max_tokens.value_or(512);
 
-  // Parse stop sequences
+  // Parse stop sequences (see handle_chat_completion for the matching
+  // strategy)
   if (req->stop.has_value()) {
     for (const auto& stop_str : req->stop.value()) {
+      sampling_params.stop_sequences.push_back(stop_str);
       std::vector<int> stop_tokens = tokenizer_->encode(stop_str);
-      if (!stop_tokens.empty()) {
-        sampling_params.stop_token_ids.push_back(stop_tokens.back());
+      if (stop_tokens.size() == 1) {
+        sampling_params.stop_token_ids.push_back(stop_tokens.front());
       }
     }
   }
 
   // Generate unique request ID
+  // Deterministic-response cache (see handle_chat_completion)
+  bool cacheable = registry_ && config_.response_cache_max_entries > 0 &&
+                   sampling_params.temperature == 0.0f &&
+                   !req->stream.value_or(false);
+  std::string cache_key;
+  if (cacheable) {
+    cache_key = deterministic_cache_key(req->model, req->prompt,
+                                        sampling_params, "");
+    if (auto cached = registry_->get_cache_entry(req->model, cache_key)) {
+      HttpResponse http_response;
+      http_response.status_code = 200;
+      http_response.headers["Content-Type"] = "application/json";
+      http_response.body = std::move(*cached);
+      return http_response;
+    }
+  }
+
   std::string request_id = generate_request_id();
 
-  // Create scheduler request
-  auto sched_request = std::make_shared<scheduler::Request>(
-      request_id, req->prompt, prompt_tokens, sampling_params);
+  // Create scheduler request with deferred tokens (see
+  // handle_chat_completion); pooled like every scheduler request
+  auto sched_request = scheduler::RequestPool::instance().acquire_deferred(
+      request_id, req->prompt, sampling_params);
+  sched_request->model_name = req->model;  // Route to the resident engine
+  sched_request->tenant_id = tenant_tag(request);  // Fair-share identity
+
+  // n>1 / best_of sampling (see handle_chat_completion): siblings fork
+  // this request's prefilled KV copy-on-write
+  int num_choices = std::max(1, std::min(req->n.value_or(1), 8));
+  sched_request->pending_forks = num_choices - 1;
+
+  // Installs the asynchronously encoded prompt tokens after submit
+  auto install_prompt_tokens = [&]() -> bool {
+    try {
+      sched_request->set_prompt_tokens(prompt_tokens_future.get());
+      return true;
+    } catch (const std::exception&) {
+      scheduler_->cancel_request(request_id);
+      return false;
+    }
+  };
 
   // Handle streaming
   bool stream = req->stream.value_or(false);
+  if (stream && num_choices > 1) {
+    return create_error_response(400, "Streaming with n>1 is not supported");
+  }
   if (stream) {
+    // Stream cap, same rationale as handle_chat_completion
+    if (config_.max_concurrent_streams > 0 &&
+        active_streams_.load(std::memory_order_relaxed) >=
+            config_.max_concurrent_streams) {
+      auto response = create_error_response(429, "Too many active streams");
+      response.headers["Retry-After"] = "1";
+      return response;
+    }
+    active_streams_.fetch_add(1, std::memory_order_relaxed);
+    struct StreamSlot {
+      std::atomic<int>& counter;
+      ~StreamSlot() { counter.fetch_sub(1, std::memory_order_relaxed); }
+    } stream_slot{active_streams_};
+
     // Implement SSE streaming for completions
     std::string sse_content;
     std::mutex stream_mutex;
     bool stream_finished = false;
     std::condition_variable stream_cv;
 
+    // Incremental detokenizer: emits only the new UTF-8 bytes per token
+    runtime::DetokenizeStream detok(tokenizer_.get());
+
+    // Incremental stop-string matcher (see handle_chat_completion)
+    runtime::StopSequenceMatcher stop_matcher(sampling_params.stop_sequences);
+
     // Set up streaming callback
     sched_request->token_callback = [&](int token_id, bool finished) {
       std::lock_guard<std::mutex> lock(stream_mutex);
 
-      // Decode single token to text
-      std::string token_text = tokenizer_->decode({token_id});
+      // Decode incrementally to text
+      std::string decoded = detok.push(token_id);
+      if (finished) {
+        decoded += detok.flush();
+      }
+
+      std::string token_text;
+      if (stop_matcher.empty()) {
+        token_text = std::move(decoded);
+      } else if (stop_matcher.feed(decoded, &token_text)) {
+        sched_request->stop_sequence_hit = true;
+        finished = true;
+      } else if (finished) {
+        token_text += stop_matcher.flush();
+      }
 
       // Create simple completion chunk (non-chat format)
       std::string chunk_json =
@@ -1162,6 +2023,9 @@ HttpResponse RestServer::handle_completion(const HttpRequest& request) {
     if (!submitted) {
       return create_error_response(503, "Request queue full");
     }
+    if (!install_prompt_tokens()) {
+      return create_error_response(500, "Failed to tokenize prompt");
+    }
 
     // Wait for streaming to complete
     {
@@ -1191,8 +2055,26 @@ HttpResponse RestServer::handle_completion(const HttpRequest& request) {
   std::condition_variable completion_cv;
   bool completed = false;
 
+  // Incremental stop-string matching (see handle_chat_completion)
+  runtime::DetokenizeStream detok(tokenizer_.get());
+  runtime::StopSequenceMatcher stop_matcher(sampling_params.stop_sequences);
+  std::string accumulated_text;
+  bool incremental_decode = !stop_matcher.empty();
+
   // Set up completion callback
   sched_request->token_callback = [&](int token_id, bool finished) {
+    if (incremental_decode) {
+      std::string decoded = detok.push(token_id);
+      if (finished) {
+        decoded += detok.flush();
+      }
+      if (stop_matcher.feed(decoded, &accumulated_text)) {
+        sched_request->stop_sequence_hit = true;
+        finished = true;
+      } else if (finished) {
+        accumulated_text += stop_matcher.flush();
+      }
+    }
     if (finished) {
       std::lock_guard<std::mutex> lock(completion_mutex);
       completed = true;
@@ -1205,15 +2087,94 @@ HttpResponse RestServer::handle_completion(const HttpRequest& request) {
   if (!submitted) {
     return create_error_response(503, "Request queue full");
   }
+  if (!install_prompt_tokens()) {
+    return create_error_response(500, "Failed to tokenize prompt");
+  }
+
+  // n>1: submit fork siblings that reuse the parent's prefill. The
+  // parent's tokens are already installed, so siblings submit ready
+  // and the scheduler releases them once the parent's prefill lands.
+  // Each sibling carries its own detokenizer/stop-matcher state
+  std::vector<scheduler::RequestPtr> sibling_requests;
+  std::vector<std::unique_ptr<runtime::DetokenizeStream>> sibling_detoks;
+  std::vector<std::unique_ptr<runtime::StopSequenceMatcher>> sibling_matchers;
+  std::vector<std::string> sibling_texts(num_choices - 1);
+  std::vector<char> sibling_done(num_choices - 1, 0);
+  auto cancel_all = [&]() {
+    scheduler_->cancel_request(request_id);
+    for (const auto& sibling : sibling_requests) {
+      scheduler_->cancel_request(sibling->request_id);
+    }
+  };
+  for (int i = 1; i < num_choices; ++i) {
+    std::string sibling_id = request_id + "-n" + std::to_string(i);
+    auto sibling = scheduler::RequestPool::instance().acquire(
+        sibling_id, sched_request->prompt, sched_request->prompt_token_ids,
+        sampling_params);
+    sibling->model_name = sched_request->model_name;
+    sibling->tenant_id = sched_request->tenant_id;
+    sibling->fork_of_request_id = request_id;
+    // Grammar state is per request: each sibling advances its own
+    if (sched_request->grammar) {
+      sibling->grammar =
+          runtime::GrammarConstraint::create("json", tokenizer_.get());
+    }
 
-  // Wait for completion (with timeout)
+    sibling_detoks.push_back(
+        std::make_unique<runtime::DetokenizeStream>(tokenizer_.get()));
+    sibling_matchers.push_back(std::make_unique<runtime::StopSequenceMatcher>(
+        sampling_params.stop_sequences));
+    runtime::DetokenizeStream* sib_detok = sibling_detoks.back().get();
+    runtime::StopSequenceMatcher* sib_matcher = sibling_matchers.back().get();
+    std::string* sib_text = &sibling_texts[i - 1];
+    char* sib_done = &sibling_done[i - 1];
+    scheduler::Request* sibling_raw = sibling.get();
+
+    sibling->token_callback = [&, sib_detok, sib_matcher, sib_text, sib_done,
+                               sibling_raw](int token_id, bool finished) {
+      if (incremental_decode) {
+        std::string decoded = sib_detok->push(token_id);
+        if (finished) {
+          decoded += sib_detok->flush();
+        }
+        if (sib_matcher->feed(decoded, sib_text)) {
+          sibling_raw->stop_sequence_hit = true;
+          finished = true;
+        } else if (finished) {
+          *sib_text += sib_matcher->flush();
+        }
+      }
+      if (finished) {
+        std::lock_guard<std::mutex> lock(completion_mutex);
+        *sib_done = 1;
+        completion_cv.notify_one();
+      }
+    };
+
+    if (!scheduler_->submit_request(sibling)) {
+      cancel_all();
+      return create_error_response(503, "Request queue full");
+    }
+    sibling_requests.push_back(sibling);
+  }
+
+  // Wait for completion of the parent and every sibling (with timeout)
   {
     std::unique_lock<std::mutex> lock(completion_mutex);
-    bool success = completion_cv.wait_for(lock, std::chrono::seconds(60),
-                                          [&] { return completed; });
+    bool success = completion_cv.wait_for(lock, std::chrono::seconds(60), [&] {
+      if (!completed) {
+        return false;
+      }
+      for (char done : sibling_done) {
+        if (!done) {
+          return false;
+        }
+      }
+      return true;
+    });
 
     if (!success) {
-      scheduler_->cancel_request(request_id);
+      cancel_all();
       return create_error_response(504, "Request timeout");
     }
   }
@@ -1223,9 +2184,14 @@ HttpResponse RestServer::handle_completion(const HttpRequest& request) {
     return create_error_response(500, sched_request->error_message);
   }
 
-  // Decode generated tokens to text
-  std::string generated_text =
-      tokenizer_->decode(sched_request->generated_token_ids);
+  // Decode generated tokens to text (already accumulated, stop sequence
+  // excluded, when incremental matching ran)
+  std::string generated_text;
+  if (incremental_decode) {
+    generated_text = std::move(accumulated_text);
+  } else {
+    generated_text = tokenizer_->decode(sched_request->generated_token_ids);
+  }
 
   // Create response
   CompletionResponse response;
@@ -1252,8 +2218,31 @@ HttpResponse RestServer::handle_completion(const HttpRequest& request) {
 
   response.choices.push_back(choice);
 
+  // Sibling choices (see handle_chat_completion)
+  for (size_t i = 0; i < sibling_requests.size(); ++i) {
+    const auto& sibling = sibling_requests[i];
+    if (sibling->state == scheduler::RequestState::FAILED) {
+      return create_error_response(500, sibling->error_message);
+    }
+
+    CompletionChoice sibling_choice;
+    sibling_choice.index = static_cast<int>(i) + 1;
+    if (incremental_decode) {
+      sibling_choice.text = std::move(sibling_texts[i]);
+    } else {
+      sibling_choice.text = tokenizer_->decode(sibling->generated_token_ids);
+    }
+    sibling_choice.finish_reason =
+        sibling->finish_reason == scheduler::FinishReason::LENGTH ? "length"
+                                                                  : "stop";
+    response.choices.push_back(std::move(sibling_choice));
+  }
+
   response.usage.prompt_tokens = sched_request->num_prompt_tokens;
   response.usage.completion_tokens = sched_request->num_generated_tokens;
+  for (const auto& sibling : sibling_requests) {
+    response.usage.completion_tokens += sibling->num_generated_tokens;
+  }
   response.usage.total_tokens =
       response.usage.prompt_tokens + response.usage.completion_tokens;
 
@@ -1262,6 +2251,13 @@ HttpResponse RestServer::handle_completion(const HttpRequest& request) {
   http_response.headers["Content-Type"] = "application/json";
   http_response.body = serialize_completion_response(response);
 
+  // Store the deterministic result for replay (LRU-bounded)
+  if (cacheable &&
+      sched_request->state == scheduler::RequestState::COMPLETED) {
+    registry_->put_cache_entry(req->model, cache_key, http_response.body,
+                               config_.response_cache_max_entries);
+  }
+
   return http_response;
 }
 
@@ -1278,30 +2274,36 @@ HttpResponse RestServer::handle_embedding(const HttpRequest& request) {
 
   // Tokenize input
   std::vector<int> tokens = tokenizer_->encode(req->input);
-
-  // Generate embedding (placeholder)
-  // In production, would use model to generate actual embeddings
-  std::vector<float> embedding(768, 0.0f);
-
-  // Mock embedding: just fill with random values
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::normal_distribution<float> dis(0.0f, 1.0f);
-
-  for (float& val : embedding) {
-    val = dis(gen);
+  int num_prompt_tokens = static_cast<int>(tokens.size());
+
+  // Content-addressed cache: re-index runs re-embed the same chunks,
+  // so identical (model, normalized text) pairs are served from the
+  // hot tier or registry without scheduling any forward
+  bool cacheable = config_.embedding_cache_max_entries > 0;
+  std::string text_hash;
+  std::vector<float> embedding;
+  bool cache_hit = false;
+  if (cacheable) {
+    text_hash = fnv1a_hex(normalize_embedding_text(req->input));
+    if (auto cached = lookup_cached_embedding(req->model, text_hash)) {
+      embedding = std::move(*cached);
+      cache_hit = true;
+    }
   }
 
-  // Normalize
-  float norm = 0.0f;
-  for (float val : embedding) {
-    norm += val * val;
-  }
-  norm = std::sqrt(norm);
+  if (!cache_hit) {
+    // Hand off to the batching stage: requests from other handler
+    // threads landing within the coalescing window share ONE batched
+    // forward, and this thread blocks until its row is scattered back
+    try {
+      embedding = embedding_batcher_->embed(std::move(tokens));
+    } catch (const std::exception& e) {
+      return create_error_response(
+          500, std::string("Embedding failed: ") + e.what());
+    }
 
-  if (norm > 0.0f) {
-    for (float& val : embedding) {
-      val /= norm;
+    if (cacheable) {
+      store_cached_embedding(req->model, text_hash, embedding);
     }
   }
 
@@ -1315,7 +2317,7 @@ HttpResponse RestServer::handle_embedding(const HttpRequest& request) {
 
   response.data.push_back(emb_obj);
 
-  response.usage.prompt_tokens = static_cast<int>(tokens.size());
+  response.usage.prompt_tokens = num_prompt_tokens;
   response.usage.total_tokens = response.usage.prompt_tokens;
 
   HttpResponse http_response;
@@ -1326,6 +2328,130 @@ HttpResponse RestServer::handle_embedding(const HttpRequest& request) {
   return http_response;
 }
 
+std::vector<std::vector<float>> RestServer::compute_embedding_batch(
+    const std::vector<std::vector<int>>& batch) {
+  // ANE route first: the Neural Engine is otherwise idle while the GPU
+  // serves generation, so embedding batches dispatched there cost chat
+  // decode nothing. A failed prediction disables the backend and falls
+  // through to the GPU path rather than failing the batch
+  if (ane_embedder_) {
+    try {
+      return ane_embedder_->embed_batch(batch);
+    } catch (const std::exception& e) {
+      std::cerr << "ANE embedding batch failed (" << e.what()
+                << "); reverting to the GPU path" << std::endl;
+      ane_embedder_.reset();
+    }
+  }
+
+  // Placeholder batched embedding: ONE call covers every coalesced
+  // request. In production this becomes a single padded forward through
+  // the model with mean-pooled hidden states; the batching stage and
+  // scatter-back above stay unchanged. Rows are seeded from the token
+  // IDs so identical inputs embed identically across batches
+  std::vector<std::vector<float>> rows;
+  rows.reserve(batch.size());
+
+  for (const auto& tokens : batch) {
+    uint64_t seed = 14695981039346656037ULL;
+    for (int token : tokens) {
+      uint64_t t = static_cast<uint64_t>(static_cast<uint32_t>(token));
+      for (int b = 0; b < 4; ++b) {
+        seed ^= (t >> (b * 8)) & 0xFF;
+        seed *= 1099511628211ULL;
+      }
+    }
+
+    std::mt19937 gen(static_cast<uint32_t>(seed ^ (seed >> 32)));
+    std::normal_distribution<float> dis(0.0f, 1.0f);
+
+    std::vector<float> embedding(768, 0.0f);
+    for (float& val : embedding) {
+      val = dis(gen);
+    }
+
+    // Normalize
+    float norm = 0.0f;
+    for (float val : embedding) {
+      norm += val * val;
+    }
+    norm = std::sqrt(norm);
+    if (norm > 0.0f) {
+      for (float& val : embedding) {
+        val /= norm;
+      }
+    }
+
+    rows.push_back(std::move(embedding));
+  }
+
+  return rows;
+}
+
+std::optional<std::vector<float>> RestServer::lookup_cached_embedding(
+    const std::string& model, const std::string& text_hash) {
+  const std::string key = model + '\x1f' + text_hash;
+
+  // Hot tier: in-memory, no SQLite round trip
+  {
+    std::lock_guard<std::mutex> lock(embedding_cache_mutex_);
+    auto it = embedding_hot_cache_.find(key);
+    if (it != embedding_hot_cache_.end()) {
+      it->second.stamp = ++embedding_cache_stamp_;
+      return it->second.embedding;
+    }
+  }
+
+  // Persistent tier: registry blob, promoted into the hot tier on hit
+  if (registry_) {
+    auto cached = registry_->get_embedding(model, text_hash);
+    if (cached) {
+      std::lock_guard<std::mutex> lock(embedding_cache_mutex_);
+      HotEmbedding hot;
+      hot.embedding = *cached;
+      hot.stamp = ++embedding_cache_stamp_;
+      embedding_hot_cache_[key] = std::move(hot);
+      return cached;
+    }
+  }
+
+  return std::nullopt;
+}
+
+void RestServer::store_cached_embedding(const std::string& model,
+                                        const std::string& text_hash,
+                                        const std::vector<float>& embedding) {
+  const std::string key = model + '\x1f' + text_hash;
+
+  {
+    std::lock_guard<std::mutex> lock(embedding_cache_mutex_);
+
+    // Bound the hot tier: evict the stalest entry once full. Linear
+    // scan, but only on overflow and the tier is small
+    if (embedding_hot_cache_.size() >= kEmbeddingHotTierEntries &&
+        embedding_hot_cache_.find(key) == embedding_hot_cache_.end()) {
+      auto oldest = embedding_hot_cache_.begin();
+      for (auto it = embedding_hot_cache_.begin();
+           it != embedding_hot_cache_.end(); ++it) {
+        if (it->second.stamp < oldest->second.stamp) {
+          oldest = it;
+        }
+      }
+      embedding_hot_cache_.erase(oldest);
+    }
+
+    HotEmbedding hot;
+    hot.embedding = embedding;
+    hot.stamp = ++embedding_cache_stamp_;
+    embedding_hot_cache_[key] = std::move(hot);
+  }
+
+  if (registry_) {
+    registry_->put_embedding(model, text_hash, embedding,
+                             config_.embedding_cache_max_entries);
+  }
+}
+
 HttpResponse RestServer::handle_models(const HttpRequest& request) {
   ModelListResponse response;
 
@@ -1394,6 +2520,21 @@ std::optional<ChatCompletionRequest> RestServer::parse_chat_completion_request(
   req.top_p = extract_json_float(json, "top_p");
   req.max_tokens = extract_json_int(json, "max_tokens");
   req.stream = extract_json_bool(json, "stream");
+  req.n = extract_json_int(json, "n");
+  req.include_timings = extract_json_bool(json, "include_timings");
+  req.flush_window_ms = extract_json_int(json, "flush_window_ms");
+  req.logprobs = extract_json_bool(json, "logprobs");
+  req.top_logprobs = extract_json_int(json, "top_logprobs");
+
+  // response_format is a nested object: {"type": "json_object"}; pull
+  // the type string out of the slice after the key
+  size_t rf_pos = json.find("\"response_format\"");
+  if (rf_pos != std::string::npos) {
+    std::string type = extract_json_string(json.substr(rf_pos), "type");
+    if (!type.empty()) {
+      req.response_format = type;
+    }
+  }
 
   // Parse messages (simplified)
   // In production, would use proper JSON parser
@@ -1430,6 +2571,8 @@ std::optional<CompletionRequest> RestServer::parse_completion_request(
   req.top_p = extract_json_float(json, "top_p");
   req.max_tokens = extract_json_int(json, "max_tokens");
   req.stream = extract_json_bool(json, "stream");
+  req.n = extract_json_int(json, "n");
+  req.flush_window_ms = extract_json_int(json, "flush_window_ms");
 
   return req;
 }
@@ -1476,6 +2619,10 @@ std::string RestServer::serialize_chat_completion_response(
     oss << "\"content\":\"" << escape_json_string(choice.message.content)
         << "\"";
     oss << "},";
+    if (!choice.logprobs_json.empty()) {
+      // Pre-serialized by the handler from the request's records
+      oss << "\"logprobs\":" << choice.logprobs_json << ",";
+    }
     oss << "\"finish_reason\":\"" << escape_json_string(choice.finish_reason)
         << "\"";
     oss << "}";
@@ -1488,6 +2635,10 @@ std::string RestServer::serialize_chat_completion_response(
   oss << "\"total_tokens\":" << response.usage.total_tokens;
   oss << "}";
 
+  if (!response.timings_json.empty()) {
+    oss << ",\"timings\":" << response.timings_json;
+  }
+
   oss << "}";
 
   return oss.str();
@@ -1639,6 +2790,9 @@ std::string RestServer::serialize_chat_completion_chunk(
     }
 
     oss << "},";
+    if (!choice.logprobs_json.empty()) {
+      oss << "\"logprobs\":" << choice.logprobs_json << ",";
+    }
     oss << "\"finish_reason\":";
     if (choice.finish_reason.empty()) {
       oss << "null";
@@ -1660,8 +2814,16 @@ std::string RestServer::serialize_chat_completion_chunk(
 
 void RestServer::stream_chat_completion(const ChatCompletionRequest& request,
                                         StreamCallback callback) {
-  // Create SSE stream
+  // Create SSE stream with adaptive flush coalescing: solo streams
+  // flush every token, crowded servers batch tokens per transport write
   auto sse_stream = std::make_shared<SSEStream>(callback);
+  SSEFlushConfig flush_config;
+  flush_config.max_window_ms = config_.sse_flush_max_window_ms;
+  flush_config.saturation_streams = config_.sse_flush_saturation_streams;
+  if (request.flush_window_ms) {
+    flush_config.override_window_ms = std::max(0, *request.flush_window_ms);
+  }
+  sse_stream->configure_flush(flush_config, &active_streams_);
 
   // Create formatter
   std::string request_id = generate_request_id();
@@ -1695,9 +2857,10 @@ void RestServer::stream_chat_completion(const ChatCompletionRequest& request,
   for (int i = 0; i < std::min(max_tokens, 20); i++) {
     std::string token_text = "token" + std::to_string(i) + " ";
 
-    // Send content delta
-    std::string content_chunk = formatter.format_content(token_text);
-    if (!sse_stream->send_data(content_chunk)) {
+    // Send content delta via the pooled frame path (no per-token
+    // JSON/string allocations); the flush scheduler decides whether
+    // this token goes out now or coalesces with its neighbors
+    if (!sse_stream->submit_frame(formatter.format_content_frame(token_text))) {
       break;  // Client disconnected
     }
 
@@ -1715,8 +2878,16 @@ void RestServer::stream_chat_completion(const ChatCompletionRequest& request,
 
 void RestServer::stream_completion(const CompletionRequest& request,
                                    StreamCallback callback) {
-  // Create SSE stream
+  // Create SSE stream with adaptive flush coalescing (see
+  // stream_chat_completion)
   auto sse_stream = std::make_shared<SSEStream>(callback);
+  SSEFlushConfig flush_config;
+  flush_config.max_window_ms = config_.sse_flush_max_window_ms;
+  flush_config.saturation_streams = config_.sse_flush_saturation_streams;
+  if (request.flush_window_ms) {
+    flush_config.override_window_ms = std::max(0, *request.flush_window_ms);
+  }
+  sse_stream->configure_flush(flush_config, &active_streams_);
 
   // Create formatter
   std::string request_id = generate_request_id();
@@ -1739,9 +2910,9 @@ void RestServer::stream_completion(const CompletionRequest& request,
   for (int i = 0; i < std::min(max_tokens, 20); i++) {
     std::string token_text = "token" + std::to_string(i) + " ";
 
-    // Send text delta
-    std::string text_chunk = formatter.format_text(token_text);
-    if (!sse_stream->send_data(text_chunk)) {
+    // Send text delta via the pooled frame path (no per-token
+    // JSON/string allocations); flushed per the coalescing policy
+    if (!sse_stream->submit_frame(formatter.format_text_frame(token_text))) {
       break;  // Client disconnected
     }
 
@@ -1838,6 +3009,20 @@ bool RestServer::validate_api_key(const HttpRequest& request) {
   return provided_key == config_.api_key;
 }
 
+std::string RestServer::tenant_tag(const HttpRequest& request) {
+  auto it = request.headers.find("Authorization");
+  if (it == request.headers.end() || it->second.find("Bearer ") != 0) {
+    return "default";
+  }
+
+  // Hash the key so per-tenant metrics and logs never carry the secret;
+  // 8 hex chars is plenty to distinguish the handful of keys on one box
+  const size_t digest = std::hash<std::string>{}(it->second.substr(7));
+  char tag[9];
+  std::snprintf(tag, sizeof(tag), "%08zx", digest & 0xffffffffu);
+  return std::string(tag);
+}
+
 // ============================================================================
 // Model Loading Methods
 // ============================================================================
@@ -1852,8 +3037,17 @@ bool RestServer::load_model(const std::string& model_name) {
     return false;
   }
 
-  // Create ModelLoader
-  auto model_loader = std::make_shared<ModelLoader>(registry_);
+  // The loader persists across load_model calls so previously loaded
+  // models stay resident (multi-model serving). With a memory budget
+  // configured the residents form an LRU warm pool; the eviction
+  // callback keeps our engine/tokenizer maps in sync when a model
+  // falls out of it
+  if (!model_loader_) {
+    model_loader_ = std::make_shared<ModelLoader>(registry_);
+    model_loader_->set_memory_budget(config_.model_memory_budget_bytes);
+    model_loader_->set_eviction_callback(
+        [this](const std::string& name) { on_model_evicted(name); });
+  }
 
   // Load the model with default configuration
   LoadModelConfig config;
@@ -1861,17 +3055,19 @@ bool RestServer::load_model(const std::string& model_name) {
   config.prefetch_weights = true;
   config.lock_weights = false;
 
-  auto loaded_model_opt = model_loader->load_model(model_name, config);
+  auto loaded_model_opt = model_loader_->acquire_model(model_name, config);
   if (!loaded_model_opt.has_value()) {
     std::cerr << "[RestServer] Failed to load model: "
-              << model_loader->last_error() << std::endl;
+              << model_loader_->last_error() << std::endl;
     return false;
   }
 
   auto& loaded_model = loaded_model_opt.value();
 
-  // Update server components
+  // Register the resident model and make it the default routing target
   // Note: model is stored in engine, no need to keep separate reference
+  engines_[model_name] = loaded_model.engine;
+  tokenizers_[model_name] = loaded_model.tokenizer;
   tokenizer_ = loaded_model.tokenizer;
   engine_ = loaded_model.engine;
   current_model_name_ = model_name;
@@ -1888,8 +3084,10 @@ bool RestServer::load_model(const std::string& model_name) {
   std::cout << "[RestServer]   Context: " << loaded_model.info.context_length
             << std::endl;
 
-  // If a worker exists, update its engine (thread-safe)
+  // If a worker exists, register the per-model engine for routing and
+  // update the default engine (thread-safe)
   if (worker_) {
+    worker_->set_engine_for_model(model_name, loaded_model.engine);
     worker_->set_engine(engine_);
     std::cout << "[RestServer] Updated worker engine" << std::endl;
   }
@@ -1902,26 +3100,122 @@ bool RestServer::unload_model(const std::string& model_name) {
 
   std::cout << "[RestServer] Unloading model: " << model_name << std::endl;
 
-  if (current_model_name_ != model_name) {
+  if (engines_.find(model_name) == engines_.end() &&
+      current_model_name_ != model_name) {
     std::cerr << "[RestServer] Model not currently loaded: " << model_name
               << std::endl;
     return false;
   }
 
-  // Clear current model (model is stored in engine)
-  engine_.reset();
-  tokenizer_.reset();
-  current_model_name_.clear();
+  // Drop residency (model is stored in engine); in-flight requests
+  // holding the engine shared_ptr finish before it is freed
+  engines_.erase(model_name);
+  tokenizers_.erase(model_name);
+  if (model_loader_) {
+    model_loader_->release_model(model_name);
+  }
+  if (worker_) {
+    worker_->remove_engine_for_model(model_name);
+  }
+
+  // If the default model was unloaded, fall back to another resident
+  // model (most recently loaded order is not tracked; any is fine)
+  if (current_model_name_ == model_name) {
+    if (!engines_.empty()) {
+      current_model_name_ = engines_.begin()->first;
+      engine_ = engines_.begin()->second;
+      tokenizer_ = tokenizers_[current_model_name_];
+      if (worker_) {
+        worker_->set_engine(engine_);
+      }
+      std::cout << "[RestServer] Default model is now: " << current_model_name_
+                << std::endl;
+    } else {
+      engine_.reset();
+      tokenizer_.reset();
+      current_model_name_.clear();
+      if (worker_) {
+        worker_->set_engine(nullptr);
+      }
+    }
+  }
 
   std::cout << "[RestServer] Model unloaded successfully" << std::endl;
   return true;
 }
 
+void RestServer::on_model_evicted(const std::string& model_name) {
+  // Invoked from acquire_model() inside load_model(), so this thread
+  // already holds model_mutex_ - do not re-lock it here
+  std::cout << "[RestServer] Model evicted from warm pool: " << model_name
+            << std::endl;
+
+  engines_.erase(model_name);
+  tokenizers_.erase(model_name);
+  if (worker_) {
+    worker_->remove_engine_for_model(model_name);
+  }
+
+  // If the evicted model was the default it is about to be replaced by
+  // the model being loaded; clear the stale references in the meantime
+  if (current_model_name_ == model_name) {
+    engine_.reset();
+    tokenizer_.reset();
+    current_model_name_.clear();
+  }
+}
+
+void RestServer::restore_warm_models() {
+  auto names = ModelLoader::read_warm_manifest(
+      config_.warm_restart_manifest_path);
+
+  // Consume the manifest before loading anything: a crash during
+  // restore must not replay the same manifest on the next relaunch
+  std::error_code ec;
+  std::filesystem::remove(config_.warm_restart_manifest_path, ec);
+
+  if (names.empty()) {
+    return;
+  }
+
+  std::cout << "[RestServer] Warm restart: restoring " << names.size()
+            << " resident model(s)" << std::endl;
+  auto start = std::chrono::steady_clock::now();
+
+  size_t restored = 0;
+  for (const auto& name : names) {
+    // Weight files are still hot in the unified page cache from the
+    // previous process, so each load is remap + graph build
+    if (load_model(name)) {
+      ++restored;
+    } else {
+      std::cerr << "[RestServer] Warm restart: failed to restore " << name
+                << "; skipping" << std::endl;
+    }
+  }
+
+  auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  std::cout << "[RestServer] Warm restart: " << restored << "/" << names.size()
+            << " model(s) ready in " << elapsed_ms << " ms" << std::endl;
+}
+
 std::string RestServer::current_model() const {
   // Need lock since std::string is not thread-safe (even for reads)
   std::lock_guard<std::mutex> lock(model_mutex_);
   return current_model_name_;
 }
 
+std::vector<std::string> RestServer::loaded_models() const {
+  std::lock_guard<std::mutex> lock(model_mutex_);
+  std::vector<std::string> names;
+  names.reserve(engines_.size());
+  for (const auto& pair : engines_) {
+    names.push_back(pair.first);
+  }
+  return names;
+}
+
 }  // namespace server
 }  // namespace mlxr
@@ -3,11 +3,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace mlxr {
@@ -18,6 +22,7 @@ class LlamaModel;
 namespace runtime {
 class Tokenizer;
 class Engine;
+class AneEmbedder;
 }  // namespace runtime
 
 namespace scheduler {
@@ -36,6 +41,8 @@ namespace server {
 // Forward declarations
 class OllamaAPIHandler;
 class SchedulerWorker;
+class ModelLoader;
+class EmbeddingBatcher;
 
 // ==============================================================================
 // Request/Response Data Structures
@@ -82,6 +89,25 @@ struct ChatCompletionRequest {
   std::optional<std::vector<ToolDefinition>> tools;
   std::optional<std::string> tool_choice;
   std::optional<int> seed;
+
+  // OpenAI response_format "type": "json_object" constrains decoding
+  // to well-formed JSON via a grammar mask; "text" (default) is
+  // unconstrained
+  std::optional<std::string> response_format;
+
+  // OpenAI logprobs: return the log-probability of each generated
+  // token, plus up to top_logprobs alternatives per position (0-20)
+  std::optional<bool> logprobs;
+  std::optional<int> top_logprobs;
+
+  // MLXR extension: include a per-phase latency breakdown ("timings")
+  // in the response / final SSE chunk
+  std::optional<bool> include_timings;
+
+  // MLXR extension: fixed SSE flush window in milliseconds for this
+  // stream (0 = flush every token), overriding the adaptive coalescing
+  // window. For latency-sensitive clients
+  std::optional<int> flush_window_ms;
 };
 
 // Usage statistics
@@ -97,6 +123,10 @@ struct ChatCompletionChoice {
   ChatMessage message;
   std::string
       finish_reason;  // "stop", "length", "function_call", "content_filter"
+
+  // Pre-serialized OpenAI logprobs object for this choice; empty =
+  // field omitted (request did not set logprobs)
+  std::string logprobs_json;
 };
 
 // Chat completion response
@@ -107,6 +137,9 @@ struct ChatCompletionResponse {
   std::string model;
   std::vector<ChatCompletionChoice> choices;
   UsageInfo usage;
+
+  // Pre-serialized per-phase latency breakdown; empty = omitted
+  std::string timings_json;
 };
 
 // Streaming chunk delta
@@ -121,6 +154,9 @@ struct ChatCompletionStreamChoice {
   int index = 0;
   ChatCompletionDelta delta;
   std::string finish_reason;
+
+  // Pre-serialized logprobs object for this delta; empty = omitted
+  std::string logprobs_json;
 };
 
 // Streaming chunk
@@ -150,6 +186,10 @@ struct CompletionRequest {
   std::optional<int> n;
   std::optional<std::string> suffix;
   std::optional<int> seed;
+
+  // MLXR extension: fixed SSE flush window in milliseconds for this
+  // stream (0 = flush every token); see ChatCompletionRequest
+  std::optional<int> flush_window_ms;
 };
 
 // Completion choice
@@ -240,18 +280,107 @@ struct HttpResponse {
 // ==============================================================================
 
 struct ServerConfig {
+  // TCP transport. Optional: on multi-tenant dev boxes run UDS-only
+  // (enable_tcp = false) to avoid port conflicts and per-request
+  // localhost TCP overhead
   std::string bind_address = "127.0.0.1";
   int port = 8080;
+  bool enable_tcp = true;
+
+  // Unix Domain Socket transport (primary). The socket file is created
+  // with 0600 permissions; a leading "~" expands to $HOME
   bool enable_unix_socket = true;
   std::string unix_socket_path =
       "~/Library/Application Support/MLXRunner/run/mlxrunner.sock";
   bool enable_cors = true;
   int max_connections = 100;
+  // Fixed serving pool: the listener runs exactly this many worker
+  // threads (size to the E-core count) instead of httplib's liberal
+  // default, so the GPU-feeding threads keep the performance cores
   int thread_pool_size = 4;
+  // Connections parsed but not yet picked up by a worker; beyond this
+  // the accept path sheds instead of queueing into collapse
+  int max_pending_connections = 64;
+  // In-flight request ceiling across both transports; excess requests
+  // get a crisp 429 + Retry-After (0 disables the ceiling)
+  int max_concurrent_requests = 256;
+  // Long-lived SSE streams park a handler thread for their whole
+  // generation; capped separately so a burst of streams can never
+  // absorb the entire pool (0 disables the cap)
+  int max_concurrent_streams = 64;
+
+  // Adaptive SSE flush coalescing: per-token transport writes are one
+  // syscall (or TLS record) per ~4 bytes of payload, which burns
+  // serving-thread CPU at high fan-out for no visible latency win. A
+  // solo stream still flushes every token; the coalescing window ramps
+  // linearly to this cap as active streams approach the saturation
+  // count. 0 disables coalescing entirely
+  int sse_flush_max_window_ms = 20;
+
+  // Fan-out at which the SSE coalescing window stops growing
+  int sse_flush_saturation_streams = 32;
   std::string api_key;  // Optional API key for authentication
   bool enable_metrics = true;
+
+  // How often the background renderer re-renders the /metrics text
+  // exposition. Scrapes serve the latest pre-rendered snapshot (one
+  // atomic pointer load + buffer write), so any scrape frequency is
+  // fine; this only bounds snapshot staleness
+  int metrics_snapshot_interval_ms = 1000;
+
+  // Profiling mode: time each custom-kernel dispatch synchronously and
+  // surface per-kernel GPU time on the metrics endpoint. Perturbs
+  // throughput — diagnosis only, never on in production
+  bool profile_kernels = false;
+
   std::string log_level = "info";
 
+  // Deterministic-response cache: temperature=0, non-streaming requests
+  // are served byte-identical from the registry's cache_entries table,
+  // so eval replays become an SQLite lookup instead of GPU work.
+  // LRU-evicted past this many entries; 0 disables the cache
+  int response_cache_max_entries = 1024;
+
+  // Cross-request embedding microbatching: /v1/embeddings requests
+  // landing within this window are coalesced into ONE padded forward
+  // pass, since embedding throughput is almost entirely batch-size
+  // bound. 0 disables coalescing (each flush takes only what has
+  // already queued)
+  int embedding_batch_window_ms = 5;
+
+  // Flush an embedding batch early once this many requests have queued
+  int embedding_batch_max_size = 32;
+
+  // Opportunistic ANE offload for /v1/embeddings: run embedding
+  // forwards on the Neural Engine through a CoreML-compiled model
+  // (compute units pinned to CPU+ANE), leaving the GPU entirely to
+  // generation traffic. Falls back to the regular GPU path when the
+  // hardware, model or a prediction is unavailable
+  bool enable_ane_embeddings = false;
+
+  // Compiled CoreML embedding model bundle (.mlmodelc) for the ANE path
+  std::string ane_embedding_model_path;
+
+  // Content-addressed embedding cache: vectors are keyed by
+  // hash(model, normalized text) in the registry's embedding_cache
+  // table with an in-memory hot tier, so re-indexing runs that re-embed
+  // the same chunks skip the forward pass entirely. LRU-evicted past
+  // this many entries; 0 disables the cache
+  int embedding_cache_max_entries = 65536;
+
+  // Warm-pool budget for resident model weights in bytes (0 = unlimited).
+  // Models loaded past the budget evict the least-recently-used resident
+  // model; switching back to an evicted model pays a full reload
+  uint64_t model_memory_budget_bytes = 0;
+
+  // Warm-restart manifest path (empty = disabled). On graceful stop the
+  // resident model set is serialized here; the next start (launchd
+  // KeepAlive relaunches the daemon) re-acquires those models before
+  // serving. Weights are file-backed read-only mmaps, so their pages
+  // survive the process in the unified page cache and the reload is
+  // mostly remap + graph build rather than disk I/O
+  std::string warm_restart_manifest_path;
+
   // Connection timeout settings
   int read_timeout_sec = 30;        // Read timeout in seconds (default: 30s)
   int write_timeout_sec = 30;       // Write timeout in seconds (default: 30s)
@@ -300,24 +429,38 @@ class RestServer {
 
   // Model loading and management
   /**
-   * @brief Load a model by name
+   * @brief Load a model by name and make it resident
    * @param model_name Model name or ID from registry
    * @return true if model loaded successfully
+   *
+   * Multi-model residency: previously loaded models stay resident, so
+   * a 1B draft/classifier can serve alongside an 8B chat model.
+   * Requests route to the engine matching their "model" field; the
+   * most recently loaded model becomes the default for requests naming
+   * an unknown model.
    */
   bool load_model(const std::string& model_name);
 
   /**
-   * @brief Unload a model
+   * @brief Unload a resident model
    * @param model_name Model name to unload
    * @return true if model unloaded successfully
+   *
+   * If the default model is unloaded, another resident model (if any)
+   * becomes the default.
    */
   bool unload_model(const std::string& model_name);
 
   /**
-   * @brief Get currently loaded model name
+   * @brief Get the default model name (most recently loaded)
    */
   std::string current_model() const;
 
+  /**
+   * @brief Names of all resident models
+   */
+  std::vector<std::string> loaded_models() const;
+
   // Endpoint handlers (can be overridden for custom behavior)
   virtual HttpResponse handle_chat_completion(const HttpRequest& request);
   virtual HttpResponse handle_completion(const HttpRequest& request);
@@ -341,13 +484,72 @@ class RestServer {
   std::shared_ptr<registry::ModelRegistry> registry_;
   std::shared_ptr<SchedulerWorker> worker_;
 
-  // Model loading and management
+  // Model loading and management. current_model_name_ is the default
+  // routing target; engines_/tokenizers_ hold every resident model
   std::string current_model_name_;
+  std::shared_ptr<ModelLoader> model_loader_;  // Owns residency state
+  std::unordered_map<std::string, std::shared_ptr<Engine>> engines_;
+  std::unordered_map<std::string, std::shared_ptr<Tokenizer>> tokenizers_;
   mutable std::mutex model_mutex_;  // Protect model loading/unloading (mutable for const methods)
 
+  // Load-shedding counters (see max_concurrent_requests /
+  // max_concurrent_streams); relaxed atomics, never exact under races
+  // but always within one of the truth, which is all shedding needs
+  std::atomic<int> active_requests_{0};
+  std::atomic<int> active_streams_{0};
+
   // API handlers
   std::unique_ptr<OllamaAPIHandler> ollama_handler_;
 
+  // Cross-request embedding batching stage (see embedding_batcher.h)
+  std::unique_ptr<EmbeddingBatcher> embedding_batcher_;
+
+  /**
+   * @brief Batched embedding forward: one call per coalesced batch
+   * Registered as the EmbeddingBatcher compute function; runs on the
+   * batch leader's handler thread
+   * @param batch Tokenized inputs from every request in the batch
+   * @return One normalized embedding row per input, same order
+   */
+  std::vector<std::vector<float>> compute_embedding_batch(
+      const std::vector<std::vector<int>>& batch);
+
+  // ANE embedding backend: created at initialize() when configured and
+  // available; compute_embedding_batch routes through it first and
+  // falls back to the GPU path (disabling the backend) on failure
+  std::unique_ptr<runtime::AneEmbedder> ane_embedder_;
+
+  /**
+   * @brief Look up a cached embedding vector by content hash
+   * Checks the in-memory hot tier first, then the registry's
+   * embedding_cache table (promoting registry hits into the hot tier)
+   * @param model Embedding model routing name
+   * @param text_hash Hash of the normalized input text
+   * @return Cached vector, or nullopt on miss
+   */
+  std::optional<std::vector<float>> lookup_cached_embedding(
+      const std::string& model, const std::string& text_hash);
+
+  /**
+   * @brief Store a computed embedding in both cache tiers
+   * @param model Embedding model routing name
+   * @param text_hash Hash of the normalized input text
+   * @param embedding Vector to cache
+   */
+  void store_cached_embedding(const std::string& model,
+                              const std::string& text_hash,
+                              const std::vector<float>& embedding);
+
+  // In-memory hot tier for the content-addressed embedding cache,
+  // keyed by model + text hash and stamped for LRU eviction
+  struct HotEmbedding {
+    std::vector<float> embedding;
+    uint64_t stamp = 0;
+  };
+  std::unordered_map<std::string, HotEmbedding> embedding_hot_cache_;
+  uint64_t embedding_cache_stamp_ = 0;
+  std::mutex embedding_cache_mutex_;
+
   // Request routing
   HttpResponse route_request(const HttpRequest& request);
 
@@ -375,12 +577,32 @@ class RestServer {
   void stream_completion(const CompletionRequest& request,
                          StreamCallback callback);
 
+  /**
+   * @brief Drop references to a model evicted from the loader warm pool
+   * Registered as the ModelLoader eviction callback. Runs on the
+   * thread inside load_model(), which already holds model_mutex_, so
+   * it must not re-lock it.
+   */
+  void on_model_evicted(const std::string& model_name);
+
+  /**
+   * @brief Re-acquire the models listed in the warm-restart manifest
+   * Called by start() when warm_restart_manifest_path is set. Consumes
+   * the manifest (removed before loading so a crash loop cannot replay
+   * it) and loads each model through the normal load_model path; a
+   * model that fails to load is skipped, not fatal.
+   */
+  void restore_warm_models();
+
   // Utility methods
   std::string generate_request_id();
   int64_t current_timestamp();
   HttpResponse create_error_response(int status_code,
                                      const std::string& message);
   bool validate_api_key(const HttpRequest& request);
+  // Short non-reversible tag for the presented API key, used as the
+  // scheduler's fair-share tenant identity ("default" when no key)
+  static std::string tenant_tag(const HttpRequest& request);
 
   // Server implementation details (platform-specific)
   struct Impl;
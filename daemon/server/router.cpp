@@ -0,0 +1,417 @@
+// Copyright © 2025 MLXR Development
+// Data-parallel request router implementation
+
+#include "router.h"
+
+#include <httplib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+namespace mlxr {
+namespace server {
+
+namespace {
+
+// Whether the request body asks for a streamed response. A full JSON
+// parse is wasted work on the proxy hot path; scanning for the stream
+// flag matches what the payload can legally contain
+bool wants_streaming(const std::string& body) {
+  size_t pos = body.find("\"stream\"");
+  if (pos == std::string::npos) {
+    return false;
+  }
+  pos = body.find_first_not_of(" \t\r\n", pos + 8);
+  if (pos == std::string::npos || body[pos] != ':') {
+    return false;
+  }
+  pos = body.find_first_not_of(" \t\r\n", pos + 1);
+  return pos != std::string::npos && body[pos] == 't';
+}
+
+std::string backend_error_body(const std::string& message) {
+  nlohmann::json error = {
+      {"error",
+       {{"message", message}, {"type", "router_error"}, {"code", 502}}}};
+  return error.dump();
+}
+
+}  // namespace
+
+struct RequestRouter::Impl {
+  // Per-backend routing state. Held by shared_ptr so a detached stream
+  // worker outlives router shutdown safely
+  struct BackendState {
+    std::string socket_path;
+    std::atomic<int> outstanding{0};
+    std::atomic<int> queue_depth{0};
+    std::atomic<int> available_kv_blocks{0};
+    std::atomic<bool> healthy{false};
+  };
+
+  std::vector<std::shared_ptr<BackendState>> backends;
+
+  std::unique_ptr<httplib::Server> tcp_server;
+  std::unique_ptr<httplib::Server> uds_server;
+  std::thread tcp_thread;
+  std::thread uds_thread;
+
+  std::mutex poll_mutex;
+  std::condition_variable poll_cv;
+
+  const RouterConfig* config = nullptr;
+
+  std::unique_ptr<httplib::Client> make_client(
+      const std::string& socket_path) const {
+    auto client = std::make_unique<httplib::Client>(socket_path, 80);
+    client->set_address_family(AF_UNIX);
+    client->set_connection_timeout(
+        0, config->connect_timeout_ms * 1000);  // sec, usec
+    client->set_read_timeout(config->read_timeout_sec, 0);
+    return client;
+  }
+
+  httplib::Headers forward_headers(const httplib::Request& req) const {
+    httplib::Headers headers;
+    auto auth = req.get_header_value("Authorization");
+    if (!auth.empty()) {
+      headers.emplace("Authorization", auth);
+    }
+    return headers;
+  }
+
+  std::shared_ptr<BackendState> pick() const {
+    int index = pick_least_loaded(loads_source());
+    return index >= 0 ? backends[static_cast<size_t>(index)] : nullptr;
+  }
+
+  std::vector<BackendLoad> loads_source() const {
+    std::vector<BackendLoad> loads;
+    loads.reserve(backends.size());
+    for (const auto& backend : backends) {
+      BackendLoad load;
+      load.queue_depth = backend->queue_depth.load(std::memory_order_relaxed);
+      load.available_kv_blocks =
+          backend->available_kv_blocks.load(std::memory_order_relaxed);
+      load.outstanding = backend->outstanding.load(std::memory_order_relaxed);
+      load.healthy = backend->healthy.load(std::memory_order_relaxed);
+      loads.push_back(load);
+    }
+    return loads;
+  }
+
+  // Buffered proxy for non-streaming requests and GETs: status, content
+  // type and body pass through unchanged
+  void proxy_buffered(const std::shared_ptr<BackendState>& backend,
+                      const httplib::Request& req, httplib::Response& res,
+                      bool is_post) {
+    auto client = make_client(backend->socket_path);
+    auto headers = forward_headers(req);
+    auto content_type = req.get_header_value("Content-Type");
+    if (content_type.empty()) {
+      content_type = "application/json";
+    }
+
+    auto result = is_post ? client->Post(req.path.c_str(), headers, req.body,
+                                        content_type.c_str())
+                          : client->Get(req.path.c_str(), headers);
+    if (!result) {
+      backend->healthy.store(false, std::memory_order_relaxed);
+      res.status = 502;
+      res.set_content(backend_error_body("backend unavailable: " +
+                                         backend->socket_path),
+                      "application/json");
+      return;
+    }
+
+    res.status = result->status;
+    auto response_type = result->get_header_value("Content-Type");
+    res.set_content(result->body, response_type.empty() ? "application/json"
+                                                        : response_type);
+  }
+
+  // Streaming proxy: a worker thread runs the backend request and feeds
+  // chunks through a pipe the front's chunked provider drains, so SSE
+  // tokens reach the client as the backend emits them
+  void proxy_streaming(const std::shared_ptr<BackendState>& backend,
+                       const httplib::Request& req, httplib::Response& res) {
+    struct StreamPipe {
+      std::mutex mutex;
+      std::condition_variable cv;
+      std::string buffer;
+      bool done = false;
+    };
+    auto pipe = std::make_shared<StreamPipe>();
+
+    auto headers = forward_headers(req);
+    auto content_type = req.get_header_value("Content-Type");
+    if (content_type.empty()) {
+      content_type = "application/json";
+    }
+
+    std::thread([this, backend, pipe, path = req.path, body = req.body,
+                 headers, content_type] {
+      auto client = make_client(backend->socket_path);
+      auto result = client->Post(
+          path.c_str(), headers, body, content_type.c_str(),
+          [pipe](const char* data, size_t len) {
+            {
+              std::lock_guard<std::mutex> lock(pipe->mutex);
+              pipe->buffer.append(data, len);
+            }
+            pipe->cv.notify_one();
+            return true;
+          });
+      if (!result) {
+        backend->healthy.store(false, std::memory_order_relaxed);
+      }
+      backend->outstanding.fetch_sub(1, std::memory_order_relaxed);
+      {
+        std::lock_guard<std::mutex> lock(pipe->mutex);
+        pipe->done = true;
+      }
+      pipe->cv.notify_one();
+    }).detach();
+
+    res.set_chunked_content_provider(
+        "text/event-stream",
+        [pipe](size_t /*offset*/, httplib::DataSink& sink) {
+          std::unique_lock<std::mutex> lock(pipe->mutex);
+          pipe->cv.wait(lock,
+                        [&pipe] { return pipe->done || !pipe->buffer.empty(); });
+          if (!pipe->buffer.empty()) {
+            std::string chunk;
+            chunk.swap(pipe->buffer);
+            lock.unlock();
+            return sink.write(chunk.data(), chunk.size());
+          }
+          sink.done();
+          return false;
+        });
+  }
+
+  void handle_proxy_post(RequestRouter* router, const httplib::Request& req,
+                         httplib::Response& res) {
+    (void)router;
+    auto backend = pick();
+    if (!backend) {
+      res.status = 503;
+      res.set_content(backend_error_body("no backends configured"),
+                      "application/json");
+      return;
+    }
+
+    backend->outstanding.fetch_add(1, std::memory_order_relaxed);
+    if (wants_streaming(req.body)) {
+      // The stream worker owns the decrement (it knows when the
+      // generation actually finished)
+      proxy_streaming(backend, req, res);
+    } else {
+      proxy_buffered(backend, req, res, /*is_post=*/true);
+      backend->outstanding.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+  void handle_proxy_get(const httplib::Request& req, httplib::Response& res) {
+    auto backend = pick();
+    if (!backend) {
+      res.status = 503;
+      res.set_content(backend_error_body("no backends configured"),
+                      "application/json");
+      return;
+    }
+    proxy_buffered(backend, req, res, /*is_post=*/false);
+  }
+
+  void configure_routes(RequestRouter* router, httplib::Server* server) {
+    // Generation and embedding endpoints: routed per request by load
+    for (const char* path :
+         {"/v1/chat/completions", "/v1/completions", "/v1/embeddings",
+          "/api/generate", "/api/chat", "/api/embeddings"}) {
+      server->Post(path, [this, router](const httplib::Request& req,
+                                        httplib::Response& res) {
+        handle_proxy_post(router, req, res);
+      });
+    }
+
+    // Catalog endpoints: replicas serve the same box, any healthy
+    // backend's answer is authoritative
+    for (const char* path : {"/v1/models", "/api/tags", "/api/ps"}) {
+      server->Get(path, [this](const httplib::Request& req,
+                               httplib::Response& res) {
+        handle_proxy_get(req, res);
+      });
+    }
+
+    // Router health: own status plus the per-backend load picture
+    server->Get("/health", [this](const httplib::Request&,
+                                  httplib::Response& res) {
+      nlohmann::json health;
+      health["status"] = "ok";
+      health["role"] = "router";
+      auto backends_json = nlohmann::json::array();
+      for (const auto& backend : backends) {
+        backends_json.push_back(
+            {{"socket", backend->socket_path},
+             {"healthy", backend->healthy.load(std::memory_order_relaxed)},
+             {"queue_depth",
+              backend->queue_depth.load(std::memory_order_relaxed)},
+             {"outstanding",
+              backend->outstanding.load(std::memory_order_relaxed)},
+             {"available_kv_blocks",
+              backend->available_kv_blocks.load(std::memory_order_relaxed)}});
+      }
+      health["backends"] = backends_json;
+      res.set_content(health.dump(), "application/json");
+    });
+  }
+
+  void run_uds(RequestRouter* router, const std::string& path) {
+    std::error_code ec;
+    std::filesystem::path socket_path(path);
+    std::filesystem::create_directories(socket_path.parent_path(), ec);
+    std::filesystem::remove(socket_path, ec);
+
+    uds_server = std::make_unique<httplib::Server>();
+    configure_routes(router, uds_server.get());
+    uds_server->set_address_family(AF_UNIX);
+    if (!uds_server->bind_to_port(path.c_str(), 80)) {
+      std::cerr << "[Router] Failed to bind UDS at " << path << std::endl;
+      return;
+    }
+    ::chmod(path.c_str(), S_IRUSR | S_IWUSR);  // 0600
+    uds_server->listen_after_bind();
+  }
+
+  void run_tcp(RequestRouter* router, const std::string& host, int port) {
+    tcp_server = std::make_unique<httplib::Server>();
+    configure_routes(router, tcp_server.get());
+    if (!tcp_server->listen(host.c_str(), port)) {
+      std::cerr << "[Router] Failed to listen on " << host << ":" << port
+                << std::endl;
+    }
+  }
+
+  void shutdown() {
+    if (tcp_server) {
+      tcp_server->stop();
+    }
+    if (uds_server) {
+      uds_server->stop();
+    }
+  }
+};
+
+RequestRouter::RequestRouter(const RouterConfig& config)
+    : config_(config), impl_(std::make_unique<Impl>()) {
+  impl_->config = &config_;
+  for (const auto& socket_path : config_.backend_sockets) {
+    auto backend = std::make_shared<Impl::BackendState>();
+    backend->socket_path = socket_path;
+    impl_->backends.push_back(std::move(backend));
+  }
+}
+
+RequestRouter::~RequestRouter() { stop(); }
+
+bool RequestRouter::start() {
+  if (running_) {
+    return false;
+  }
+  if (impl_->backends.empty()) {
+    std::cerr << "[Router] No backend sockets configured" << std::endl;
+    return false;
+  }
+
+  running_ = true;
+
+  // Prime the load picture so the first requests route on real signal
+  poll_backends();
+  poll_thread_ = std::thread(&RequestRouter::poll_loop, this);
+
+  if (!config_.listen_socket.empty()) {
+    impl_->uds_thread = std::thread(&Impl::run_uds, impl_.get(), this,
+                                    config_.listen_socket);
+  }
+  if (config_.listen_port > 0) {
+    impl_->tcp_thread = std::thread(&Impl::run_tcp, impl_.get(), this,
+                                    config_.listen_host, config_.listen_port);
+  }
+
+  std::cout << "[Router] Routing across " << impl_->backends.size()
+            << " backend(s)" << std::endl;
+  return true;
+}
+
+void RequestRouter::stop() {
+  if (!running_) {
+    return;
+  }
+  running_ = false;
+  impl_->poll_cv.notify_all();
+  if (poll_thread_.joinable()) {
+    poll_thread_.join();
+  }
+
+  impl_->shutdown();
+  if (impl_->tcp_thread.joinable()) {
+    impl_->tcp_thread.join();
+  }
+  if (impl_->uds_thread.joinable()) {
+    impl_->uds_thread.join();
+  }
+}
+
+std::vector<BackendLoad> RequestRouter::backend_loads() const {
+  return impl_->loads_source();
+}
+
+void RequestRouter::poll_backends() {
+  for (const auto& backend : impl_->backends) {
+    auto client = impl_->make_client(backend->socket_path);
+    auto result = client->Get("/internal/scheduler_stats");
+    if (!result || result->status != 200) {
+      backend->healthy.store(false, std::memory_order_relaxed);
+      continue;
+    }
+
+    try {
+      auto stats = nlohmann::json::parse(result->body);
+      int depth = stats.value("waiting_requests", 0) +
+                  stats.value("prefilling_requests", 0) +
+                  stats.value("decoding_requests", 0);
+      backend->queue_depth.store(depth, std::memory_order_relaxed);
+      backend->available_kv_blocks.store(
+          stats.value("available_kv_blocks", 0), std::memory_order_relaxed);
+      backend->healthy.store(true, std::memory_order_relaxed);
+    } catch (const std::exception&) {
+      backend->healthy.store(false, std::memory_order_relaxed);
+    }
+  }
+}
+
+void RequestRouter::poll_loop() {
+  while (running_) {
+    {
+      std::unique_lock<std::mutex> lock(impl_->poll_mutex);
+      impl_->poll_cv.wait_for(
+          lock, std::chrono::milliseconds(config_.stats_poll_interval_ms),
+          [this] { return !running_.load(); });
+    }
+    if (!running_) {
+      break;
+    }
+    poll_backends();
+  }
+}
+
+}  // namespace server
+}  // namespace mlxr
@@ -0,0 +1,153 @@
+// Copyright © 2025 MLXR Development
+// Data-parallel request router - load-balances across mlxrunnerd backends
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mlxr {
+namespace server {
+
+/**
+ * @brief Router configuration
+ */
+struct RouterConfig {
+  // Backend daemon UDS socket paths, one per mlxrunnerd replica
+  std::vector<std::string> backend_sockets;
+
+  // Front listener: UDS path (primary transport, same convention as the
+  // daemons behind it) and optional localhost TCP port (0 = disabled)
+  std::string listen_socket;
+  std::string listen_host = "127.0.0.1";
+  int listen_port = 0;
+
+  // How often each backend's /internal/scheduler_stats is polled. The
+  // per-request outstanding counters keep routing accurate between
+  // polls, so this only bounds staleness of the queue-depth signal
+  int stats_poll_interval_ms = 500;
+
+  // Per-backend HTTP timeouts. Reads are long: an SSE stream stays open
+  // for the whole generation
+  int connect_timeout_ms = 500;
+  int read_timeout_sec = 600;
+};
+
+/**
+ * @brief Load signal for one backend, as seen by the routing policy
+ *
+ * queue_depth and available_kv_blocks come from the backend's polled
+ * SchedulerStats; outstanding counts requests this router has in flight
+ * to the backend (its own queue signal lags by up to one poll interval)
+ */
+struct BackendLoad {
+  int queue_depth = 0;          // waiting + prefilling + decoding
+  int available_kv_blocks = 0;  // Free KV blocks
+  int outstanding = 0;          // Router-side in-flight requests
+  bool healthy = true;          // Last stats poll succeeded
+};
+
+/**
+ * @brief Pick the least-loaded backend
+ * @param backends Load snapshot per backend
+ * @return Chosen index, or -1 when backends is empty
+ *
+ * Least-outstanding first: the backend with the smallest
+ * queue_depth + outstanding wins; ties break toward more free KV blocks
+ * (the emptier cache absorbs a long prompt without preemption).
+ * Unhealthy backends are skipped unless every backend is unhealthy, in
+ * which case the first is returned so the request fails with the
+ * backend's own error rather than a router-fabricated one.
+ */
+inline int pick_least_loaded(const std::vector<BackendLoad>& backends) {
+  int best = -1;
+  for (size_t i = 0; i < backends.size(); ++i) {
+    if (!backends[i].healthy) {
+      continue;
+    }
+    if (best < 0) {
+      best = static_cast<int>(i);
+      continue;
+    }
+    const auto& candidate = backends[i];
+    const auto& incumbent = backends[best];
+    int candidate_load = candidate.queue_depth + candidate.outstanding;
+    int incumbent_load = incumbent.queue_depth + incumbent.outstanding;
+    if (candidate_load < incumbent_load ||
+        (candidate_load == incumbent_load &&
+         candidate.available_kv_blocks > incumbent.available_kv_blocks)) {
+      best = static_cast<int>(i);
+    }
+  }
+  if (best < 0 && !backends.empty()) {
+    best = 0;  // All unhealthy: let the backend's own error surface
+  }
+  return best;
+}
+
+/**
+ * @brief Lightweight front process for data-parallel serving
+ *
+ * Speaks the same OpenAI/Ollama surface as mlxrunnerd and proxies every
+ * request to one of several backend daemons over their UDS sockets,
+ * chosen by least-outstanding-tokens routing informed by each backend's
+ * SchedulerStats (polled from /internal/scheduler_stats). Streaming
+ * responses are piped through chunk by chunk, so SSE token latency is
+ * one extra local hop. 2-3 independent replicas on an Ultra-class box
+ * scale throughput linearly since they share nothing but the machine.
+ */
+class RequestRouter {
+ public:
+  explicit RequestRouter(const RouterConfig& config);
+  ~RequestRouter();
+
+  // Delete copy operations
+  RequestRouter(const RequestRouter&) = delete;
+  RequestRouter& operator=(const RequestRouter&) = delete;
+
+  /**
+   * @brief Start the stats poller and front listeners
+   * @return false when no backends are configured or a listener fails
+   */
+  bool start();
+
+  /**
+   * @brief Stop listeners and the poller; drains by construction since
+   * in-flight proxied requests hold their handler threads until done
+   */
+  void stop();
+
+  bool is_running() const { return running_; }
+
+  /**
+   * @brief Current load snapshot per backend (poll order)
+   * Exposed for the router's own /health output and for tests
+   */
+  std::vector<BackendLoad> backend_loads() const;
+
+ private:
+  struct Impl;
+
+  /**
+   * @brief Poll every backend's scheduler stats once
+   */
+  void poll_backends();
+
+  /**
+   * @brief Stats poll loop (background thread)
+   */
+  void poll_loop();
+
+  RouterConfig config_;
+  std::unique_ptr<Impl> impl_;
+
+  std::thread poll_thread_;
+  std::atomic<bool> running_{false};
+};
+
+}  // namespace server
+}  // namespace mlxr
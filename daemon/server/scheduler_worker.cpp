@@ -3,11 +3,15 @@
 
 #include "scheduler_worker.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <thread>
 
+#include "../../core/runtime/grammar.h"
 #include "../scheduler/request.h"
+#include "../telemetry/metrics.h"
+#include "../telemetry/trace.h"
 
 namespace mlxr {
 namespace server {
@@ -18,7 +22,29 @@ SchedulerWorker::SchedulerWorker(
     : scheduler_(scheduler),
       engine_(engine),
       running_(false),
-      should_stop_(false) {}
+      should_stop_(false),
+      prefill_stream_(mlx::core::new_stream(mlx::core::default_device())) {
+  // Wire swap-based preemption: on preempt/resume, the scheduler asks
+  // us to demote/promote the request's engine-side KV cache so paused
+  // requests keep their context instead of re-prefilling
+  if (scheduler_) {
+    scheduler_->set_swap_callbacks(
+        [this](const std::string& request_id) {
+          swap_request_cache(request_id, /*swap_in=*/false);
+        },
+        [this](const std::string& request_id) {
+          swap_request_cache(request_id, /*swap_in=*/true);
+        });
+
+    // Cancellation fast path: when a request is cancelled (client
+    // disconnect, explicit DELETE), the scheduler frees its blocks and
+    // asks us — at the top of the next batch, on this thread — to tear
+    // down the engine-side cache so the pager sequence is reclaimed too
+    scheduler_->set_release_callback([this](const std::string& request_id) {
+      drop_request_cache(request_id);
+    });
+  }
+}
 
 SchedulerWorker::~SchedulerWorker() { stop(); }
 
@@ -30,6 +56,10 @@ void SchedulerWorker::start() {
   should_stop_ = false;
   running_ = true;
 
+  // The pressure feedback loop needs live samples (see run_loop);
+  // start() is idempotent if the daemon already started the monitor
+  telemetry::SystemMonitor::instance().start();
+
   worker_thread_ = std::thread(&SchedulerWorker::run_loop, this);
 }
 
@@ -48,15 +78,165 @@ void SchedulerWorker::stop() {
 }
 
 void SchedulerWorker::set_engine(std::shared_ptr<runtime::Engine> engine) {
-  std::lock_guard<std::mutex> lock(engine_mutex_);
-  engine_ = engine;
-  std::cout << "[SchedulerWorker] Engine updated" << std::endl;
+  enqueue_engine_command(
+      {EngineCommand::Op::SET_DEFAULT, std::string(), std::move(engine)});
+}
+
+void SchedulerWorker::set_engine_for_model(
+    const std::string& model_name, std::shared_ptr<runtime::Engine> engine) {
+  enqueue_engine_command(
+      {EngineCommand::Op::REGISTER, model_name, std::move(engine)});
+}
+
+void SchedulerWorker::remove_engine_for_model(const std::string& model_name) {
+  enqueue_engine_command({EngineCommand::Op::REMOVE, model_name, nullptr});
+}
+
+void SchedulerWorker::enqueue_engine_command(EngineCommand command) {
+  // Setup phase: no worker thread yet, so the caller owns the routing
+  // state and the change applies immediately
+  if (!running_) {
+    apply_engine_command(command);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    engine_commands_.push_back(std::move(command));
+  }
+  has_engine_commands_.store(true, std::memory_order_release);
+}
+
+void SchedulerWorker::apply_engine_command(EngineCommand& command) {
+  switch (command.op) {
+    case EngineCommand::Op::SET_DEFAULT:
+      engine_ = std::move(command.engine);
+      std::cout << "[SchedulerWorker] Engine updated" << std::endl;
+      break;
+    case EngineCommand::Op::REGISTER:
+      engine_map_[command.model_name] = std::move(command.engine);
+      std::cout << "[SchedulerWorker] Engine registered for model: "
+                << command.model_name << std::endl;
+      break;
+    case EngineCommand::Op::REMOVE:
+      engine_map_.erase(command.model_name);
+      std::cout << "[SchedulerWorker] Engine removed for model: "
+                << command.model_name << std::endl;
+      break;
+  }
+}
+
+void SchedulerWorker::drain_engine_commands() {
+  if (!has_engine_commands_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::vector<EngineCommand> commands;
+  {
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    commands.swap(engine_commands_);
+    has_engine_commands_.store(false, std::memory_order_relaxed);
+  }
+  for (auto& command : commands) {
+    apply_engine_command(command);
+  }
+}
+
+std::shared_ptr<runtime::Engine> SchedulerWorker::engine_for_model(
+    const std::string& model_name) {
+  // Worker-thread only (run_loop and the scheduler callbacks it
+  // invokes). The returned copy keeps the engine alive through the
+  // caller's step even if a REMOVE command lands before it finishes
+  if (!model_name.empty()) {
+    auto it = engine_map_.find(model_name);
+    if (it != engine_map_.end()) {
+      return it->second;
+    }
+  }
+  return engine_;
+}
+
+void SchedulerWorker::swap_request_cache(const std::string& request_id,
+                                         bool swap_in) {
+  // Resolve the engine owning this request's cache from the model
+  // recorded at cache creation; never call back into the scheduler
+  // from here (it invokes us with its lock held, on this thread)
+  std::string model_name;
+  auto model_it = cache_models_.find(request_id);
+  if (model_it != cache_models_.end()) {
+    model_name = model_it->second;
+  }
+
+  auto engine = engine_for_model(model_name);
+  if (!engine) {
+    return;
+  }
+
+  auto it = cache_map_.find(request_id);
+  if (it == cache_map_.end()) {
+    return;  // No engine-side cache yet (preempted before prefill ran)
+  }
+
+  if (swap_in) {
+    engine->swap_in_cache_sequence(&it->second);
+  } else {
+    engine->swap_out_cache_sequence(&it->second);
+  }
+}
+
+void SchedulerWorker::finish_request_cache(scheduler::RequestPtr request) {
+  auto engine = engine_for_model(request->model_name);
+
+  auto it = cache_map_.find(request->request_id);
+  if (it != cache_map_.end() && engine) {
+    // The sequence's KV covers the prompt plus every generated token
+    // that was fed back through decode; the final sampled token never
+    // ran a forward pass, so it is excluded from the indexed history
+    std::vector<int> history = request->prompt_token_ids;
+    if (!request->generated_token_ids.empty()) {
+      history.insert(history.end(), request->generated_token_ids.begin(),
+                     request->generated_token_ids.end() - 1);
+    }
+    engine->finish_cache_sequence(&it->second, history);
+  }
+  cache_map_.erase(request->request_id);
+  cache_models_.erase(request->request_id);
+  // Fork siblings that have not consumed the retained prefill logits
+  // yet fall back to a full prefill once the parent cache is gone
+  fork_prefill_logits_.erase(request->request_id);
+}
+
+void SchedulerWorker::drop_request_cache(const std::string& request_id) {
+  std::string model_name;
+  auto model_it = cache_models_.find(request_id);
+  if (model_it != cache_models_.end()) {
+    model_name = model_it->second;
+  }
+
+  auto engine = engine_for_model(model_name);
+
+  auto it = cache_map_.find(request_id);
+  if (it != cache_map_.end() && engine) {
+    engine->release_cache_sequence(&it->second);
+  }
+  cache_map_.erase(request_id);
+  cache_models_.erase(request_id);
+  fork_prefill_logits_.erase(request_id);
 }
 
 void SchedulerWorker::run_loop() {
   std::cout << "[SchedulerWorker] Worker thread started" << std::endl;
 
   while (!should_stop_) {
+    // Apply engine-routing changes queued by other threads; in steady
+    // state this is one relaxed atomic load, so the step loop itself
+    // runs lock-free
+    drain_engine_commands();
+
+    // Feed the latest thermal/memory pressure sample into the
+    // scheduler's throttling loop before it forms the batch, so
+    // managed degradation kicks in ahead of an OS clock clamp
+    scheduler_->record_system_pressure(
+        telemetry::SystemMonitor::instance().pressure_level());
+
     // Get next batch from scheduler
     scheduler::Batch batch = scheduler_->get_next_batch();
 
@@ -66,8 +246,14 @@ void SchedulerWorker::run_loop() {
       continue;
     }
 
-    // Execute the batch
+    // Execute the batch, timing the step to drive the scheduler's
+    // adaptive token-budget controller
+    auto step_start = std::chrono::steady_clock::now();
     execute_batch(batch);
+    double step_ms = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - step_start)
+                         .count();
+    scheduler_->record_step_latency(step_ms);
 
     // Notify scheduler that batch is complete
     scheduler_->complete_batch(batch);
@@ -77,31 +263,109 @@ void SchedulerWorker::run_loop() {
 }
 
 void SchedulerWorker::execute_batch(const scheduler::Batch& batch) {
-  // Execute prefill requests first (process entire prompt)
+  telemetry::ScopedTraceSpan batch_span(
+      "execute_batch", "requests",
+      static_cast<int64_t>(batch.prefill_requests.size() +
+                           batch.decode_requests.size()));
+
+  // Decode first: these tokens are already owed to streaming clients,
+  // so they must never queue behind a throughput-bound prefill chunk
+  // that was admitted in the same batch
+  if (!batch.decode_requests.empty()) {
+    telemetry::ScopedTraceSpan decode_span(
+        "decode_step", "requests",
+        static_cast<int64_t>(batch.decode_requests.size()));
+
+    if (batch.decode_requests.size() > 1) {
+      // Fused path: one batched forward for all decode requests
+      execute_decode_batch(batch.decode_requests);
+    } else {
+      for (const auto& request : batch.decode_requests) {
+        if (should_stop_) {
+          break;
+        }
+
+        try {
+          execute_decode(request);
+        } catch (const std::exception& e) {
+          std::cerr << "[SchedulerWorker] Decode failed for request "
+                    << request->request_id << ": " << e.what() << std::endl;
+          request->mark_failed(e.what());
+        }
+      }
+    }
+  }
+
+  if (should_stop_) {
+    return;
+  }
+
+  // Group fresh full-prompt requests by model: those pack into one
+  // padding-free forward pass (ragged batching). Chunked long prompts,
+  // chunk continuations, and fork siblings keep the single-request path
+  std::vector<std::string> group_models;
+  std::vector<std::vector<scheduler::RequestPtr>> prefill_groups;
+  std::vector<scheduler::RequestPtr> single_prefills;
+
   for (const auto& request : batch.prefill_requests) {
+    bool fresh_full_prompt =
+        request->fork_of_request_id.empty() &&
+        request->num_prefilled_tokens == 0 &&
+        (request->prefill_chunk_tokens == 0 ||
+         request->prefill_chunk_tokens >= request->num_prompt_tokens);
+    if (!fresh_full_prompt) {
+      single_prefills.push_back(request);
+      continue;
+    }
+
+    size_t group = 0;
+    while (group < group_models.size() &&
+           group_models[group] != request->model_name) {
+      group++;
+    }
+    if (group == group_models.size()) {
+      group_models.push_back(request->model_name);
+      prefill_groups.emplace_back();
+    }
+    prefill_groups[group].push_back(request);
+  }
+
+  // Prefill work goes to the dedicated prefill stream (a second Metal
+  // command queue), so its GPU work runs beside the next step's decode
+  // submission instead of serializing ahead of it
+  for (const auto& group : prefill_groups) {
     if (should_stop_) {
       break;
     }
 
-    try {
-      execute_prefill(request);
-    } catch (const std::exception& e) {
-      std::cerr << "[SchedulerWorker] Prefill failed for request "
-                << request->request_id << ": " << e.what() << std::endl;
-      request->mark_failed(e.what());
+    // A group of one gains nothing from packing
+    if (group.size() == 1) {
+      single_prefills.push_back(group.front());
+      continue;
+    }
+
+    int64_t group_tokens = 0;
+    for (const auto& request : group) {
+      group_tokens += request->num_prompt_tokens;
     }
+    telemetry::ScopedTraceSpan prefill_span("prefill_packed", "prompt_tokens",
+                                            group_tokens);
+    mlx::core::StreamContext stream_context(prefill_stream_);
+    execute_prefill_batch(group);
   }
 
-  // Execute decode requests (generate one token each)
-  for (const auto& request : batch.decode_requests) {
+  for (const auto& request : single_prefills) {
     if (should_stop_) {
       break;
     }
 
     try {
-      execute_decode(request);
+      telemetry::ScopedTraceSpan prefill_span(
+          "prefill_chunk", "prompt_tokens", request->num_prompt_tokens);
+      mlx::core::StreamContext stream_context(prefill_stream_);
+      execute_prefill(request);
     } catch (const std::exception& e) {
-      std::cerr << "[SchedulerWorker] Decode failed for request "
+      std::cerr << "[SchedulerWorker] Prefill failed for request "
                 << request->request_id << ": " << e.what() << std::endl;
       request->mark_failed(e.what());
     }
@@ -112,14 +376,9 @@ void SchedulerWorker::execute_prefill(scheduler::RequestPtr request) {
   request->mark_prefilling();
 
   try {
-    // Get engine (thread-safe)
-    // Note: We copy the shared_ptr under lock to ensure the engine stays alive
-    // for the duration of this operation, even if another thread calls set_engine()
-    std::shared_ptr<runtime::Engine> engine;
-    {
-      std::lock_guard<std::mutex> lock(engine_mutex_);
-      engine = engine_;
-    }
+    // Route to the engine serving this request's model (default engine
+    // when the model field is empty or unknown)
+    auto engine = engine_for_model(request->model_name);
 
     // If no engine is available, skip inference (for testing)
     if (!engine) {
@@ -128,67 +387,133 @@ void SchedulerWorker::execute_prefill(scheduler::RequestPtr request) {
     }
 
     // Get or create cache for this request
-    runtime::InferenceCache* cache = nullptr;
-    {
-      std::lock_guard<std::mutex> lock(cache_mutex_);
-      cache = &cache_map_[request->request_id];
+    runtime::InferenceCache* cache = &cache_map_[request->request_id];
+    cache_models_[request->request_id] = request->model_name;
+
+    // n>1 sibling: clone the parent's prefilled KV copy-on-write and
+    // reuse its retained prefill logits instead of re-running the
+    // shared prompt. Falls back to a normal prefill when the parent's
+    // cache is already gone (e.g. it finished at max_tokens=1)
+    graph::Tensor logits;
+    bool forked = false;
+    if (!request->fork_of_request_id.empty() &&
+        request->num_prefilled_tokens == 0) {
+      auto parent_it = cache_map_.find(request->fork_of_request_id);
+      auto logits_it = fork_prefill_logits_.find(request->fork_of_request_id);
+      if (parent_it != cache_map_.end() &&
+          logits_it != fork_prefill_logits_.end() &&
+          parent_it->second.cached_tokens >= request->num_prompt_tokens &&
+          engine->fork_cache_sequence(&parent_it->second, cache)) {
+        logits = logits_it->second.logits;
+        if (--logits_it->second.remaining <= 0) {
+          fork_prefill_logits_.erase(logits_it);
+        }
+        request->num_prefilled_tokens = request->num_prompt_tokens;
+        forked = true;
+      }
     }
 
-    // Single forward pass for prefill - processes all prompt tokens
-    auto logits = engine->forward_prefill(request->prompt_token_ids, cache);
-
-    // Configure sampler with request parameters
-    runtime::SamplerConfig sampler_config;
-    sampler_config.temperature = request->sampling_params.temperature;
-    sampler_config.top_p = request->sampling_params.top_p;
-    sampler_config.top_k = request->sampling_params.top_k;
-    sampler_config.repetition_penalty =
-        request->sampling_params.repetition_penalty;
+    if (!forked) {
+      // Run this step's prefill chunk. prefill_chunk_tokens == 0 means
+      // the scheduler admitted the whole remaining prompt at once
+      int start = request->num_prefilled_tokens;
+      int remaining = request->num_prompt_tokens - start;
+      int chunk = remaining;
+      if (request->prefill_chunk_tokens > 0) {
+        chunk = std::min(request->prefill_chunk_tokens, remaining);
+      }
 
-    runtime::Sampler sampler(sampler_config);
+      std::vector<int> chunk_tokens(
+          request->prompt_token_ids.begin() + start,
+          request->prompt_token_ids.begin() + start + chunk);
 
-    // Sample ONE token from logits
-    int next_token = sampler.sample(logits, request->prompt_token_ids);
+      logits = engine->forward_prefill(chunk_tokens, cache);
+      request->num_prefilled_tokens += chunk;
 
-    // Add to request (this calls the token_callback)
-    request->add_generated_token(next_token);
+      // Partial chunk: prompt not fully ingested yet, so no token to
+      // sample. The request stays PREFILLING and the scheduler will
+      // admit the next chunk alongside the decode batch
+      if (!request->prefill_complete()) {
+        return;
+      }
+    }
 
-    // Transition to decoding phase
-    request->mark_decoding();
+    // Sample and commit the first token (handles fork-logits retention,
+    // the decode transition, stop checking, and cleanup)
+    commit_prefill_token(request, logits, cache);
 
-    // Check if finished after first token
-    if (request->should_stop()) {
-      scheduler::FinishReason reason = scheduler::FinishReason::STOP;
+  } catch (const std::exception& e) {
+    // Clean up cache on error
+    drop_request_cache(request->request_id);
+    throw;  // Re-throw for caller to handle
+  }
+}
 
-      if (request->num_generated_tokens >= request->max_tokens) {
-        reason = scheduler::FinishReason::LENGTH;
-      }
+void SchedulerWorker::execute_prefill_batch(
+    const std::vector<scheduler::RequestPtr>& requests) {
+  for (const auto& request : requests) {
+    request->mark_prefilling();
+  }
 
-      request->mark_completed(reason);
+  // All requests in the group share a model (grouped by execute_batch)
+  auto engine = engine_for_model(requests.front()->model_name);
 
-      // Clean up cache
-      std::lock_guard<std::mutex> lock(cache_mutex_);
-      cache_map_.erase(request->request_id);
+  // If no engine is available, skip inference (for testing)
+  if (!engine) {
+    for (const auto& request : requests) {
+      request->mark_completed(scheduler::FinishReason::STOP);
     }
+    return;
+  }
 
+  // Create caches for every request up front; unordered_map references
+  // stay valid across later insertions, so the pointers survive the
+  // whole pass
+  std::vector<std::vector<int>> prompts;
+  std::vector<runtime::InferenceCache*> caches;
+  prompts.reserve(requests.size());
+  caches.reserve(requests.size());
+  for (const auto& request : requests) {
+    caches.push_back(&cache_map_[request->request_id]);
+    cache_models_[request->request_id] = request->model_name;
+  }
+  for (const auto& request : requests) {
+    prompts.push_back(request->prompt_token_ids);
+  }
+
+  // ONE packed forward pass for every prompt in the group
+  std::vector<graph::Tensor> logits_batch;
+  try {
+    logits_batch = engine->forward_prefill_batch(prompts, caches);
   } catch (const std::exception& e) {
-    // Clean up cache on error
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    cache_map_.erase(request->request_id);
-    throw;  // Re-throw for caller to handle
+    std::cerr << "[SchedulerWorker] Batched prefill failed: " << e.what()
+              << std::endl;
+    for (const auto& request : requests) {
+      request->mark_failed(e.what());
+      drop_request_cache(request->request_id);
+    }
+    return;
+  }
+
+  // Commit a first token per request
+  for (size_t i = 0; i < requests.size(); ++i) {
+    const auto& request = requests[i];
+    try {
+      request->num_prefilled_tokens = request->num_prompt_tokens;
+      commit_prefill_token(request, logits_batch[i], caches[i]);
+    } catch (const std::exception& e) {
+      std::cerr << "[SchedulerWorker] Prefill failed for request "
+                << request->request_id << ": " << e.what() << std::endl;
+      request->mark_failed(e.what());
+      drop_request_cache(request->request_id);
+    }
   }
 }
 
 void SchedulerWorker::execute_decode(scheduler::RequestPtr request) {
   try {
-    // Get engine (thread-safe)
-    // Note: We copy the shared_ptr under lock to ensure the engine stays alive
-    // for the duration of this operation, even if another thread calls set_engine()
-    std::shared_ptr<runtime::Engine> engine;
-    {
-      std::lock_guard<std::mutex> lock(engine_mutex_);
-      engine = engine_;
-    }
+    // Route to the engine serving this request's model
+    auto engine = engine_for_model(request->model_name);
 
     // If no engine is available, skip inference (for testing)
     if (!engine) {
@@ -197,16 +522,12 @@ void SchedulerWorker::execute_decode(scheduler::RequestPtr request) {
     }
 
     // Get existing cache for this request
-    runtime::InferenceCache* cache = nullptr;
-    {
-      std::lock_guard<std::mutex> lock(cache_mutex_);
-      auto it = cache_map_.find(request->request_id);
-      if (it == cache_map_.end()) {
-        throw std::runtime_error("No cache found for request " +
-                                 request->request_id);
-      }
-      cache = &it->second;
+    auto it = cache_map_.find(request->request_id);
+    if (it == cache_map_.end()) {
+      throw std::runtime_error("No cache found for request " +
+                               request->request_id);
     }
+    runtime::InferenceCache* cache = &it->second;
 
     // Get the last generated token
     if (request->generated_token_ids.empty()) {
@@ -217,48 +538,367 @@ void SchedulerWorker::execute_decode(scheduler::RequestPtr request) {
     // Single forward pass for decode - processes ONE token with existing cache
     auto logits = engine->forward_decode(last_token, cache);
 
-    // Configure sampler
-    runtime::SamplerConfig sampler_config;
-    sampler_config.temperature = request->sampling_params.temperature;
-    sampler_config.top_p = request->sampling_params.top_p;
-    sampler_config.top_k = request->sampling_params.top_k;
-    sampler_config.repetition_penalty =
-        request->sampling_params.repetition_penalty;
+    // Sample and commit the token (handles stop checking and cleanup)
+    commit_decode_token(request, logits, cache);
 
-    runtime::Sampler sampler(sampler_config);
+  } catch (const std::exception& e) {
+    // Clean up cache on error
+    drop_request_cache(request->request_id);
+    throw;  // Re-throw for caller to handle
+  }
+}
 
-    // Build context for repetition penalty (prompt + generated so far)
-    std::vector<int> context = request->prompt_token_ids;
-    context.insert(context.end(), request->generated_token_ids.begin(),
-                   request->generated_token_ids.end());
+void SchedulerWorker::execute_decode_batch(
+    const std::vector<scheduler::RequestPtr>& requests) {
+  // Multi-model batches: group requests by the engine serving their
+  // model so each resident model still gets ONE fused forward pass per
+  // step. With a single resident model this is one group, same as before
+  std::vector<std::shared_ptr<runtime::Engine>> group_engines;
+  std::vector<std::vector<scheduler::RequestPtr>> groups;
 
-    // Sample ONE token from logits
-    int next_token = sampler.sample(logits, context);
+  for (const auto& request : requests) {
+    auto engine = engine_for_model(request->model_name);
 
-    // Add to request (this calls the token_callback)
-    request->add_generated_token(next_token);
+    // If no engine is available, skip inference (for testing)
+    if (!engine) {
+      request->mark_completed(scheduler::FinishReason::STOP);
+      continue;
+    }
 
-    // Check if finished
-    if (request->should_stop()) {
-      scheduler::FinishReason reason = scheduler::FinishReason::STOP;
+    size_t group = 0;
+    while (group < group_engines.size() && group_engines[group] != engine) {
+      group++;
+    }
+    if (group == group_engines.size()) {
+      group_engines.push_back(engine);
+      groups.emplace_back();
+    }
+    groups[group].push_back(request);
+  }
 
-      if (request->num_generated_tokens >= request->max_tokens) {
-        reason = scheduler::FinishReason::LENGTH;
+  for (size_t group = 0; group < groups.size(); ++group) {
+    execute_decode_group(group_engines[group], groups[group]);
+  }
+}
+
+void SchedulerWorker::execute_decode_group(
+    std::shared_ptr<runtime::Engine> engine,
+    const std::vector<scheduler::RequestPtr>& requests) {
+  // Gather last tokens and caches for every decodable request; requests
+  // with missing caches or no generated tokens fail individually without
+  // poisoning the batch
+  std::vector<scheduler::RequestPtr> batch_requests;
+  std::vector<int> last_tokens;
+  std::vector<runtime::InferenceCache*> caches;
+  batch_requests.reserve(requests.size());
+  last_tokens.reserve(requests.size());
+  caches.reserve(requests.size());
+
+  for (const auto& request : requests) {
+    try {
+      auto it = cache_map_.find(request->request_id);
+      if (it == cache_map_.end()) {
+        throw std::runtime_error("No cache found for request " +
+                                 request->request_id);
       }
+      runtime::InferenceCache* cache = &it->second;
 
-      request->mark_completed(reason);
+      if (request->generated_token_ids.empty()) {
+        throw std::runtime_error("No tokens generated yet for decode phase");
+      }
 
-      // Clean up cache
-      std::lock_guard<std::mutex> lock(cache_mutex_);
-      cache_map_.erase(request->request_id);
+      batch_requests.push_back(request);
+      last_tokens.push_back(request->generated_token_ids.back());
+      caches.push_back(cache);
+    } catch (const std::exception& e) {
+      std::cerr << "[SchedulerWorker] Decode failed for request "
+                << request->request_id << ": " << e.what() << std::endl;
+      request->mark_failed(e.what());
+      drop_request_cache(request->request_id);
     }
+  }
 
+  if (batch_requests.empty()) {
+    return;
+  }
+
+  // ONE fused forward pass for the whole decode batch
+  std::vector<graph::Tensor> logits_batch;
+  try {
+    logits_batch = engine->forward_decode_batch(last_tokens, caches);
   } catch (const std::exception& e) {
-    // Clean up cache on error
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    cache_map_.erase(request->request_id);
-    throw;  // Re-throw for caller to handle
+    std::cerr << "[SchedulerWorker] Batched decode failed: " << e.what()
+              << std::endl;
+    for (const auto& request : batch_requests) {
+      request->mark_failed(e.what());
+      drop_request_cache(request->request_id);
+    }
+    return;
+  }
+
+  // ONE fused sampling pass for the whole decode batch: per-row
+  // temperature/top-k/top-p/repetition penalty run on the GPU and only
+  // the sampled token IDs come back to the host (instead of pulling a
+  // full vocab-sized logits row per sequence)
+  std::vector<int> next_tokens;
+  try {
+    std::vector<runtime::SamplerConfig> sampler_configs;
+    std::vector<const std::unordered_map<int, int>*> token_count_maps;
+    sampler_configs.reserve(batch_requests.size());
+    token_count_maps.reserve(batch_requests.size());
+
+    for (size_t i = 0; i < batch_requests.size(); ++i) {
+      const auto& request = batch_requests[i];
+      runtime::SamplerConfig sampler_config;
+      sampler_config.temperature = request->sampling_params.temperature;
+      sampler_config.top_p = request->sampling_params.top_p;
+      sampler_config.top_k = request->sampling_params.top_k;
+      sampler_config.repetition_penalty =
+          request->sampling_params.repetition_penalty;
+      sampler_configs.push_back(sampler_config);
+
+      // Repetition penalty context: the cache's incrementally maintained
+      // frequency table (prompt + generated so far, distinct tokens),
+      // instead of copying and deduplicating the full history per step
+      token_count_maps.push_back(&caches[i]->token_counts);
+
+      // Grammar-constrained rows: mask illegal continuations before the
+      // fused sampling pass
+      if (request->grammar) {
+        logits_batch[i] = request->grammar->mask_logits(logits_batch[i]);
+      }
+    }
+
+    next_tokens = runtime::Sampler::sample_batch(logits_batch, sampler_configs,
+                                                 token_count_maps);
+  } catch (const std::exception& e) {
+    std::cerr << "[SchedulerWorker] Batched sampling failed: " << e.what()
+              << std::endl;
+    for (const auto& request : batch_requests) {
+      request->mark_failed(e.what());
+      drop_request_cache(request->request_id);
+    }
+    return;
   }
+
+  // Logprob extraction for the rows that asked for it, batched into one
+  // GPU log-softmax + gather; only the compact records cross to host.
+  // Extraction runs with the largest requested k and trims per request
+  std::unordered_map<size_t, scheduler::TokenLogprob> logprob_records;
+  try {
+    std::vector<size_t> logprob_rows;
+    std::vector<graph::Tensor> logprob_logits;
+    std::vector<int> logprob_tokens;
+    int max_k = 0;
+    for (size_t i = 0; i < batch_requests.size(); ++i) {
+      if (batch_requests[i]->sampling_params.logprobs) {
+        logprob_rows.push_back(i);
+        logprob_logits.push_back(logits_batch[i]);
+        logprob_tokens.push_back(next_tokens[i]);
+        max_k =
+            std::max(max_k, batch_requests[i]->sampling_params.top_logprobs);
+      }
+    }
+    if (!logprob_rows.empty()) {
+      auto rows = runtime::Sampler::extract_top_logprobs(
+          logprob_logits, logprob_tokens, max_k);
+      for (size_t j = 0; j < logprob_rows.size(); ++j) {
+        size_t i = logprob_rows[j];
+        int k = std::max(0, batch_requests[i]->sampling_params.top_logprobs);
+        scheduler::TokenLogprob record;
+        record.token_id = next_tokens[i];
+        record.logprob = rows[j].sampled_logprob;
+        if (k < static_cast<int>(rows[j].token_ids.size())) {
+          rows[j].token_ids.resize(k);
+          rows[j].logprobs.resize(k);
+        }
+        record.top_token_ids = std::move(rows[j].token_ids);
+        record.top_logprobs = std::move(rows[j].logprobs);
+        logprob_records.emplace(i, std::move(record));
+      }
+    }
+  } catch (const std::exception& e) {
+    // Logprobs are auxiliary: a failed extraction degrades the response
+    // rather than failing the whole decode step
+    std::cerr << "[SchedulerWorker] Logprob extraction failed: " << e.what()
+              << std::endl;
+    logprob_records.clear();
+  }
+
+  // Commit a token per sequence
+  for (size_t i = 0; i < batch_requests.size(); ++i) {
+    auto& request = batch_requests[i];
+    try {
+      auto lp_it = logprob_records.find(i);
+      commit_token(request, next_tokens[i],
+                   lp_it != logprob_records.end() ? &lp_it->second : nullptr);
+    } catch (const std::exception& e) {
+      std::cerr << "[SchedulerWorker] Decode failed for request "
+                << request->request_id << ": " << e.what() << std::endl;
+      request->mark_failed(e.what());
+      drop_request_cache(request->request_id);
+    }
+  }
+}
+
+void SchedulerWorker::commit_decode_token(scheduler::RequestPtr request,
+                                          const graph::Tensor& logits,
+                                          runtime::InferenceCache* cache) {
+  // Configure sampler
+  runtime::SamplerConfig sampler_config;
+  sampler_config.temperature = request->sampling_params.temperature;
+  sampler_config.top_p = request->sampling_params.top_p;
+  sampler_config.top_k = request->sampling_params.top_k;
+  sampler_config.repetition_penalty =
+      request->sampling_params.repetition_penalty;
+
+  runtime::Sampler sampler(sampler_config);
+
+  // Grammar-constrained requests: mask illegal continuations before
+  // sampling
+  graph::Tensor sample_logits = logits;
+  if (request->grammar) {
+    sample_logits = request->grammar->mask_logits(logits);
+  }
+
+  // Sample ONE token from logits; the cache's frequency table covers
+  // prompt + generated-so-far without copying the history each step
+  int next_token = sampler.sample(sample_logits, cache->token_counts);
+
+  scheduler::TokenLogprob logprob;
+  const scheduler::TokenLogprob* logprob_ptr =
+      extract_logprob_record(request, sample_logits, next_token, logprob)
+          ? &logprob
+          : nullptr;
+
+  commit_token(request, next_token, logprob_ptr);
+}
+
+void SchedulerWorker::commit_prefill_token(scheduler::RequestPtr request,
+                                           const graph::Tensor& logits,
+                                           runtime::InferenceCache* cache) {
+  // Cancelled while this step was in flight: discard the result without
+  // invoking the token callback (the handler's captures may already be
+  // gone); the release callback reclaims the cache before the next batch
+  if (request->is_finished()) {
+    return;
+  }
+
+  // Parent of pending fork siblings: retain these logits so each
+  // sibling samples its own first token from the same distribution
+  if (request->pending_forks > 0) {
+    fork_prefill_logits_[request->request_id] = {logits,
+                                                 request->pending_forks};
+  }
+
+  // Configure sampler with request parameters
+  runtime::SamplerConfig sampler_config;
+  sampler_config.temperature = request->sampling_params.temperature;
+  sampler_config.top_p = request->sampling_params.top_p;
+  sampler_config.top_k = request->sampling_params.top_k;
+  sampler_config.repetition_penalty =
+      request->sampling_params.repetition_penalty;
+
+  runtime::Sampler sampler(sampler_config);
+
+  // Grammar-constrained requests: mask illegal continuations to -inf
+  // before sampling the first token
+  graph::Tensor sample_logits = logits;
+  if (request->grammar) {
+    sample_logits = request->grammar->mask_logits(logits);
+  }
+
+  // Sample ONE token from logits; the cache's frequency table already
+  // covers the ingested prompt
+  int next_token = sampler.sample(sample_logits, cache->token_counts);
+
+  if (request->grammar) {
+    request->grammar->accept_token(next_token);
+  }
+
+  // Logprob record lands before the token so the serving layer's
+  // callback sees it alongside the delta
+  scheduler::TokenLogprob logprob;
+  if (extract_logprob_record(request, sample_logits, next_token, logprob)) {
+    request->generated_logprobs.push_back(std::move(logprob));
+  }
+
+  // Add to request (this calls the token_callback)
+  request->add_generated_token(next_token);
+
+  // Transition to decoding phase
+  request->mark_decoding();
+
+  // Check if finished after first token
+  if (request->should_stop()) {
+    scheduler::FinishReason reason = scheduler::FinishReason::STOP;
+
+    if (request->num_generated_tokens >= request->max_tokens) {
+      reason = scheduler::FinishReason::LENGTH;
+    }
+
+    request->mark_completed(reason);
+
+    // Index the conversation for reuse and free the pager sequence
+    finish_request_cache(request);
+  }
+}
+
+void SchedulerWorker::commit_token(scheduler::RequestPtr request,
+                                   int next_token,
+                                   const scheduler::TokenLogprob* logprob) {
+  // Cancelled while this step was in flight: drop the sampled token
+  // rather than firing the token callback on a terminal request
+  if (request->is_finished()) {
+    return;
+  }
+
+  // Advance the grammar over the committed token so the next step's
+  // mask reflects it
+  if (request->grammar) {
+    request->grammar->accept_token(next_token);
+  }
+
+  // Logprob record lands before the token so the serving layer's
+  // callback sees it alongside the delta
+  if (logprob) {
+    request->generated_logprobs.push_back(*logprob);
+  }
+
+  // Add to request (this calls the token_callback)
+  request->add_generated_token(next_token);
+
+  // Check if finished
+  if (request->should_stop()) {
+    scheduler::FinishReason reason = scheduler::FinishReason::STOP;
+
+    if (request->num_generated_tokens >= request->max_tokens) {
+      reason = scheduler::FinishReason::LENGTH;
+    }
+
+    request->mark_completed(reason);
+
+    // Index the conversation for reuse and free the pager sequence
+    finish_request_cache(request);
+  }
+}
+
+bool SchedulerWorker::extract_logprob_record(
+    const scheduler::RequestPtr& request, const graph::Tensor& logits,
+    int sampled_token, scheduler::TokenLogprob& record) {
+  if (!request->sampling_params.logprobs) {
+    return false;
+  }
+
+  int k = std::max(0, request->sampling_params.top_logprobs);
+  auto rows =
+      runtime::Sampler::extract_top_logprobs({logits}, {sampled_token}, k);
+
+  record.token_id = sampled_token;
+  record.logprob = rows[0].sampled_logprob;
+  record.top_token_ids = std::move(rows[0].token_ids);
+  record.top_logprobs = std::move(rows[0].logprobs);
+  return true;
 }
 
 }  // namespace server
@@ -12,6 +12,7 @@
 #include "../../core/runtime/engine.h"
 #include "../../core/runtime/sampler.h"
 #include "../scheduler/scheduler.h"
+#include "mlx/mlx.h"
 
 namespace mlxr {
 namespace server {
@@ -56,12 +57,33 @@ class SchedulerWorker {
   bool is_running() const { return running_; }
 
   /**
-   * @brief Update the inference engine
-   * Thread-safe method to replace the engine
+   * @brief Update the default inference engine
+   * Applied directly before start(); once the worker thread runs, the
+   * change is delivered through the command queue and takes effect at
+   * the top of its next loop iteration
    * @param engine New engine to use
    */
   void set_engine(std::shared_ptr<runtime::Engine> engine);
 
+  /**
+   * @brief Register an engine for a resident model
+   * Requests whose model field matches are routed to this engine;
+   * requests naming no (or an unknown) model use the default engine.
+   * Delivered like set_engine (see above)
+   * @param model_name Model routing key (the API payload's "model")
+   * @param engine Engine serving that model
+   */
+  void set_engine_for_model(const std::string& model_name,
+                            std::shared_ptr<runtime::Engine> engine);
+
+  /**
+   * @brief Remove a resident model's engine
+   * Delivered like set_engine; a batch already in flight keeps its own
+   * shared_ptr, so the engine stays alive until that step finishes
+   * @param model_name Model routing key
+   */
+  void remove_engine_for_model(const std::string& model_name);
+
  private:
   /**
    * @brief Main worker loop
@@ -83,6 +105,16 @@ class SchedulerWorker {
    */
   void execute_prefill(scheduler::RequestPtr request);
 
+  /**
+   * @brief Execute prefill for several requests in one packed forward pass
+   * Helper for execute_batch: fresh full-prompt requests sharing a model
+   * are packed into one contiguous token stream (no padding to the
+   * longest prompt) and ingested in a single engine call
+   * @param requests Fresh requests routed to the same model
+   */
+  void execute_prefill_batch(
+      const std::vector<scheduler::RequestPtr>& requests);
+
   /**
    * @brief Execute decode phase for a request
    * Generate one token for the request
@@ -90,19 +122,198 @@ class SchedulerWorker {
    */
   void execute_decode(scheduler::RequestPtr request);
 
+  /**
+   * @brief Execute decode phase for multiple requests in one forward pass
+   * Stacks all decode tokens into a single batched engine call so the
+   * whole batch is one graph evaluation instead of one per request
+   * @param requests Requests in decode phase
+   */
+  void execute_decode_batch(const std::vector<scheduler::RequestPtr>& requests);
+
+  /**
+   * @brief Execute one fused decode pass for requests sharing an engine
+   * Helper for execute_decode_batch: a multi-model batch is split into
+   * per-engine groups and each group decodes in a single forward pass
+   * @param engine Engine serving the group's model
+   * @param requests Requests routed to that engine
+   */
+  void execute_decode_group(std::shared_ptr<runtime::Engine> engine,
+                            const std::vector<scheduler::RequestPtr>& requests);
+
+  /**
+   * @brief Sample next token from logits and commit it to the request
+   * Handles sampler setup, token callback, stop checking, and cache
+   * cleanup on completion
+   * @param request Request being decoded
+   * @param logits Next-token logits [vocab_size]
+   * @param cache Inference cache holding the sequence's token frequency
+   *        table for repetition penalty
+   */
+  void commit_decode_token(scheduler::RequestPtr request,
+                           const graph::Tensor& logits,
+                           runtime::InferenceCache* cache);
+
+  /**
+   * @brief Sample the first token from prefill logits and commit it
+   * Handles fork-logits retention, sampler setup, grammar masking, the
+   * token callback, the decode transition, and completion cleanup.
+   * Shared by the single-request and packed prefill paths
+   * @param request Request whose prompt is fully ingested
+   * @param logits Last-position logits [vocab_size]
+   * @param cache Inference cache holding the sequence's token frequency
+   *        table for repetition penalty
+   */
+  void commit_prefill_token(scheduler::RequestPtr request,
+                            const graph::Tensor& logits,
+                            runtime::InferenceCache* cache);
+
+  /**
+   * @brief Commit an already-sampled token to the request
+   * Handles token callback, stop checking, and cache cleanup on
+   * completion. Used by the batched decode path where sampling for
+   * all sequences happens in one fused GPU dispatch
+   * @param request Request being decoded
+   * @param next_token Sampled token ID
+   * @param logprob Optional logprob record for this token; appended to
+   *        the request before the token callback fires so the serving
+   *        layer can serialize it with the delta
+   */
+  void commit_token(scheduler::RequestPtr request, int next_token,
+                    const scheduler::TokenLogprob* logprob = nullptr);
+
+  /**
+   * @brief Extract the logprob record for a just-sampled token
+   * Runs the GPU-side log-softmax + top-k extraction for a single row
+   * when the request asked for logprobs. Returns false (and leaves
+   * record untouched) when the request did not
+   * @param request Request being decoded
+   * @param logits The row the token was sampled from
+   * @param sampled_token The committed token
+   * @param record Output record
+   */
+  bool extract_logprob_record(const scheduler::RequestPtr& request,
+                              const graph::Tensor& logits, int sampled_token,
+                              scheduler::TokenLogprob& record);
+
+  /**
+   * @brief Index a completed request's KV for reuse and free its cache
+   * Inserts the conversation history (prompt + generated) into the
+   * engine's prefix cache, releases the pager sequence, and drops the
+   * worker's cache entry. The indexed blocks stay alive under the
+   * prefix cache's TTL/budget, so the next chat turn extending this
+   * conversation prefills only its delta tokens
+   * @param request Request that finished successfully
+   */
+  void finish_request_cache(scheduler::RequestPtr request);
+
+  /**
+   * @brief Release a failed or abandoned request's cache
+   * Releases the pager sequence (nothing is indexed for reuse) and
+   * drops the worker's cache entry
+   * @param request_id Request whose cache to discard
+   */
+  void drop_request_cache(const std::string& request_id);
+
+  /**
+   * @brief Demote or promote a request's KV cache for swap-based preemption
+   * Registered with the scheduler as its swap callbacks; looks up the
+   * request's engine-side cache and moves its blocks between the GPU
+   * and CPU tiers. Must not call back into the scheduler (invoked with
+   * the scheduler lock held)
+   * @param request_id Request whose cache to move
+   * @param swap_in True to promote back to GPU, false to demote to CPU
+   */
+  void swap_request_cache(const std::string& request_id, bool swap_in);
+
+  /**
+   * @brief Resolve the engine serving a model
+   * @param model_name Model routing key (empty = default engine)
+   * @return Matching resident engine, or the default engine
+   */
+  std::shared_ptr<runtime::Engine> engine_for_model(
+      const std::string& model_name);
+
+  // Control-plane message for engine routing changes (see the command
+  // queue members below)
+  struct EngineCommand {
+    enum class Op { SET_DEFAULT, REGISTER, REMOVE };
+    Op op;
+    std::string model_name;
+    std::shared_ptr<runtime::Engine> engine;
+  };
+
+  /**
+   * @brief Queue an engine-routing change from any thread
+   * Applied directly when the worker is not running (setup phase,
+   * single-threaded by contract)
+   * @param command Command to deliver
+   */
+  void enqueue_engine_command(EngineCommand command);
+
+  /**
+   * @brief Apply a queued engine-routing change (worker thread only)
+   * @param command Command to apply
+   */
+  void apply_engine_command(EngineCommand& command);
+
+  /**
+   * @brief Drain and apply queued engine commands (worker thread only)
+   * Called at the top of each loop iteration; the steady-state check is
+   * a single relaxed atomic load, so an empty queue costs no lock in
+   * the step loop
+   */
+  void drain_engine_commands();
+
   // Dependencies
   std::shared_ptr<scheduler::Scheduler> scheduler_;
-  std::shared_ptr<runtime::Engine> engine_;
-  std::mutex engine_mutex_;  // Protect engine access
+
+  // Engine routing state, owned by the worker thread once start() has
+  // run (and by the configuring thread before that). Other threads
+  // never touch these directly; they enqueue EngineCommands instead
+  std::shared_ptr<runtime::Engine> engine_;  // Default/fallback engine
+  std::unordered_map<std::string, std::shared_ptr<runtime::Engine>>
+      engine_map_;  // Resident engines keyed by model name
+
+  // Control-plane handoff for engine changes from other threads. The
+  // queue mutex is taken by producers and, only when the flag says the
+  // queue is non-empty, by the worker - never during batch execution
+  std::vector<EngineCommand> engine_commands_;  // Guarded by command_mutex_
+  std::mutex command_mutex_;
+  std::atomic<bool> has_engine_commands_{false};
 
   // Worker thread
   std::thread worker_thread_;
   std::atomic<bool> running_;
   std::atomic<bool> should_stop_;
 
-  // KV cache management - one cache per active request
+  // Dedicated stream for prefill chunks. MLX backs each stream with its
+  // own Metal command queue, so throughput-bound prefill work is
+  // submitted beside - not ahead of - the latency-bound decode steps on
+  // the default stream. MLX's graph inserts events for the KV-write ->
+  // decode-read dependency when a sequence crosses streams, so a
+  // request transitioning from prefill to decode still sees its own
+  // writes
+  mlx::core::Stream prefill_stream_;
+
+  // KV cache management - one cache per active request. Owned by the
+  // worker thread: every accessor (batch execution, the scheduler's
+  // swap/release callbacks, error cleanup) runs inside run_loop, so no
+  // lock guards these maps
   std::unordered_map<std::string, runtime::InferenceCache> cache_map_;
-  std::mutex cache_mutex_;  // Protect cache map access
+  // Prefill logits retained for n>1 sampling: each fork sibling samples
+  // its own first token from the parent's final prefill distribution
+  // instead of re-running the prompt. The count tracks how many
+  // siblings still need the entry; it is dropped when the last one
+  // consumes it or the parent's cache is torn down
+  struct ForkPrefillLogits {
+    graph::Tensor logits;
+    int remaining = 0;
+  };
+  std::unordered_map<std::string, ForkPrefillLogits> fork_prefill_logits_;
+  // Model routing key per active request, recorded when the cache is
+  // created so swap callbacks can find the owning engine (same
+  // worker-thread ownership and lifecycle as cache_map_ entries)
+  std::unordered_map<std::string, std::string> cache_models_;
 };
 
 }  // namespace server
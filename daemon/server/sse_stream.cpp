@@ -9,6 +9,8 @@
 #include <sstream>
 #include <thread>
 
+#include "../telemetry/trace.h"
+
 namespace mlxr {
 namespace server {
 
@@ -52,7 +54,10 @@ std::string SSEEvent::format() const {
 // ==============================================================================
 
 SSEStream::SSEStream(SSECallback callback)
-    : callback_(callback), closed_(false), event_count_(0) {}
+    : callback_(callback),
+      closed_(false),
+      event_count_(0),
+      disconnect_signalled_(false) {}
 
 SSEStream::~SSEStream() { close(); }
 
@@ -61,19 +66,32 @@ bool SSEStream::send(const SSEEvent& event) {
     return false;
   }
 
-  std::lock_guard<std::mutex> lock(mutex_);
+  bool success;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
 
-  if (closed_) {
-    return false;
-  }
+    if (closed_) {
+      return false;
+    }
 
-  std::string formatted = event.format();
-  bool success = callback_(formatted);
+    std::string formatted = event.format();
+
+    // Any coalesced frames still pending go out ahead of this event in
+    // the same write, so finish chunks and [DONE] never overtake tokens
+    if (!pending_frames_.empty()) {
+      pending_frames_.append(formatted);
+      pending_count_++;
+      success = flush_frames_locked();
+    } else {
+      success = callback_(formatted);
+      if (success) {
+        event_count_++;
+      }
+    }
+  }
 
-  if (success) {
-    event_count_++;
-  } else {
-    closed_ = true;
+  if (!success) {
+    on_write_failure();
   }
 
   return success;
@@ -98,17 +116,163 @@ bool SSEStream::send_comment(const std::string& comment) {
     return false;
   }
 
+  bool success;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (closed_) {
+      return false;
+    }
+
+    std::string formatted = ": " + comment + "\n\n";
+    if (!pending_frames_.empty()) {
+      pending_frames_.append(formatted);
+      pending_count_++;
+      success = flush_frames_locked();
+    } else {
+      success = callback_(formatted);
+    }
+  }
+
+  if (!success) {
+    on_write_failure();
+  }
+
+  return success;
+}
+
+bool SSEStream::send_frame(const std::string& frame) {
+  if (closed_) {
+    return false;
+  }
+
+  bool success;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (closed_) {
+      return false;
+    }
+
+    // Flush coalesced frames ahead of this one in the same write
+    if (!pending_frames_.empty()) {
+      pending_frames_.append(frame);
+      pending_count_++;
+      success = flush_frames_locked();
+    } else {
+      success = callback_(frame);
+      if (success) {
+        event_count_++;
+      }
+    }
+  }
+
+  if (!success) {
+    on_write_failure();
+  }
+
+  return success;
+}
+
+void SSEStream::queue_frame(const std::string& frame) {
   std::lock_guard<std::mutex> lock(mutex_);
+  pending_frames_.append(frame);
+  pending_count_++;
+}
 
+bool SSEStream::flush_frames() {
   if (closed_) {
     return false;
   }
 
-  std::string formatted = ": " + comment + "\n\n";
-  bool success = callback_(formatted);
+  bool success;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (closed_) {
+      return false;
+    }
+    success = flush_frames_locked();
+  }
 
   if (!success) {
-    closed_ = true;
+    on_write_failure();
+  }
+
+  return success;
+}
+
+bool SSEStream::flush_frames_locked() {
+  if (pending_frames_.empty()) {
+    return true;
+  }
+
+  // One transport write for however many frames accumulated; clear()
+  // keeps the buffer's capacity for the next batch
+  telemetry::TraceRecorder::instance().record_instant(
+      "sse_flush", "frames", static_cast<int64_t>(pending_count_));
+  bool success = callback_(pending_frames_);
+
+  if (success) {
+    event_count_ += pending_count_;
+  }
+
+  pending_frames_.clear();
+  pending_count_ = 0;
+  return success;
+}
+
+void SSEStream::configure_flush(const SSEFlushConfig& config,
+                                const std::atomic<int>* active_streams) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  flush_config_ = config;
+  active_streams_ = active_streams;
+}
+
+bool SSEStream::submit_frame(const std::string& frame) {
+  if (closed_) {
+    return false;
+  }
+
+  bool success = true;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (closed_) {
+      return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (pending_frames_.empty()) {
+      first_pending_time_ = now;
+    }
+    pending_frames_.append(frame);
+    pending_count_++;
+
+    // The window adapts to fan-out: a solo stream flushes every token,
+    // a crowded server coalesces up to max_window_ms per stream
+    int fanout = active_streams_
+                     ? active_streams_->load(std::memory_order_relaxed)
+                     : 1;
+    int window = coalesce_window_ms(fanout, flush_config_);
+
+    bool window_elapsed =
+        window == 0 ||
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - first_pending_time_)
+                .count() >= window;
+    bool buffer_full =
+        flush_config_.max_pending_frames > 0 &&
+        pending_count_ >=
+            static_cast<size_t>(flush_config_.max_pending_frames);
+
+    if (window_elapsed || buffer_full) {
+      success = flush_frames_locked();
+    }
+  }
+
+  if (!success) {
+    on_write_failure();
   }
 
   return success;
@@ -116,8 +280,32 @@ bool SSEStream::send_comment(const std::string& comment) {
 
 void SSEStream::send_done() { send_data("[DONE]"); }
 
+void SSEStream::set_disconnect_handler(std::function<void()> handler) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  disconnect_handler_ = std::move(handler);
+}
+
 void SSEStream::close() { closed_ = true; }
 
+void SSEStream::on_write_failure() {
+  closed_ = true;
+
+  // First failure wins; later ones (including from other threads racing
+  // past the closed_ fast path) are no-ops
+  if (disconnect_signalled_.exchange(true)) {
+    return;
+  }
+
+  std::function<void()> handler;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    handler = disconnect_handler_;
+  }
+  if (handler) {
+    handler();
+  }
+}
+
 // ==============================================================================
 // SSEResponseBuilder Implementation
 // ==============================================================================
@@ -223,7 +411,26 @@ ChatCompletionStreamFormatter::ChatCompletionStreamFormatter(
     const std::string& request_id, const std::string& model)
     : request_id_(request_id),
       model_(model),
-      created_(get_current_timestamp()) {}
+      created_(get_current_timestamp()) {
+  // Prebuild the content-chunk template: every chunk of a stream is
+  // identical except for the token text, so the per-token work reduces
+  // to splicing the escaped token between these two halves. The JSON
+  // is escaped, hence newline-free, so one "data:" line is a complete
+  // SSE event
+  std::ostringstream prefix;
+  prefix << "data: {";
+  prefix << "\"id\":\"" << escape_json(request_id_) << "\",";
+  prefix << "\"object\":\"chat.completion.chunk\",";
+  prefix << "\"created\":" << created_ << ",";
+  prefix << "\"model\":\"" << escape_json(model_) << "\",";
+  prefix << "\"choices\":[{";
+  prefix << "\"index\":0,";
+  prefix << "\"delta\":{\"content\":\"";
+  content_frame_prefix_ = prefix.str();
+  content_frame_suffix_ = "\"},\"finish_reason\":null}]}\n\n";
+  frame_buffer_.reserve(content_frame_prefix_.size() +
+                        content_frame_suffix_.size() + 64);
+}
 
 std::string ChatCompletionStreamFormatter::format_role(
     const std::string& role) {
@@ -259,8 +466,39 @@ std::string ChatCompletionStreamFormatter::format_content(
   return oss.str();
 }
 
+std::string ChatCompletionStreamFormatter::format_content_with_logprobs(
+    const std::string& content, float logprob,
+    const std::vector<std::pair<std::string, float>>& top_alternatives) {
+  std::ostringstream oss;
+  oss << "{";
+  oss << "\"id\":\"" << escape_json(request_id_) << "\",";
+  oss << "\"object\":\"chat.completion.chunk\",";
+  oss << "\"created\":" << created_ << ",";
+  oss << "\"model\":\"" << escape_json(model_) << "\",";
+  oss << "\"choices\":[{";
+  oss << "\"index\":0,";
+  oss << "\"delta\":{\"content\":\"" << escape_json(content) << "\"},";
+  oss << "\"logprobs\":{\"content\":[{";
+  oss << "\"token\":\"" << escape_json(content) << "\",";
+  oss << "\"logprob\":" << logprob << ",";
+  oss << "\"top_logprobs\":[";
+  for (size_t i = 0; i < top_alternatives.size(); ++i) {
+    if (i > 0) {
+      oss << ",";
+    }
+    oss << "{\"token\":\"" << escape_json(top_alternatives[i].first)
+        << "\",\"logprob\":" << top_alternatives[i].second << "}";
+  }
+  oss << "]";
+  oss << "}]},";
+  oss << "\"finish_reason\":null";
+  oss << "}]";
+  oss << "}";
+  return oss.str();
+}
+
 std::string ChatCompletionStreamFormatter::format_finish(
-    const std::string& finish_reason) {
+    const std::string& finish_reason, const std::string& timings_json) {
   std::ostringstream oss;
   oss << "{";
   oss << "\"id\":\"" << escape_json(request_id_) << "\",";
@@ -272,10 +510,23 @@ std::string ChatCompletionStreamFormatter::format_finish(
   oss << "\"delta\":{},";
   oss << "\"finish_reason\":\"" << escape_json(finish_reason) << "\"";
   oss << "}]";
+  if (!timings_json.empty()) {
+    // Pre-serialized by the server from the request's phase timestamps
+    oss << ",\"timings\":" << timings_json;
+  }
   oss << "}";
   return oss.str();
 }
 
+const std::string& ChatCompletionStreamFormatter::format_content_frame(
+    const std::string& content) {
+  frame_buffer_.clear();  // capacity is retained
+  frame_buffer_.append(content_frame_prefix_);
+  escape_json_into(content, frame_buffer_);
+  frame_buffer_.append(content_frame_suffix_);
+  return frame_buffer_;
+}
+
 std::string ChatCompletionStreamFormatter::format_function_call(
     const std::string& function_name, const std::string& arguments) {
   std::ostringstream oss;
@@ -306,7 +557,31 @@ CompletionStreamFormatter::CompletionStreamFormatter(
     const std::string& request_id, const std::string& model)
     : request_id_(request_id),
       model_(model),
-      created_(get_current_timestamp()) {}
+      created_(get_current_timestamp()) {
+  // Prebuilt text-chunk template (see ChatCompletionStreamFormatter)
+  std::ostringstream prefix;
+  prefix << "data: {";
+  prefix << "\"id\":\"" << escape_json(request_id_) << "\",";
+  prefix << "\"object\":\"text_completion\",";
+  prefix << "\"created\":" << created_ << ",";
+  prefix << "\"model\":\"" << escape_json(model_) << "\",";
+  prefix << "\"choices\":[{";
+  prefix << "\"index\":0,";
+  prefix << "\"text\":\"";
+  text_frame_prefix_ = prefix.str();
+  text_frame_suffix_ = "\",\"finish_reason\":null}]}\n\n";
+  frame_buffer_.reserve(text_frame_prefix_.size() +
+                        text_frame_suffix_.size() + 64);
+}
+
+const std::string& CompletionStreamFormatter::format_text_frame(
+    const std::string& text) {
+  frame_buffer_.clear();  // capacity is retained
+  frame_buffer_.append(text_frame_prefix_);
+  escape_json_into(text, frame_buffer_);
+  frame_buffer_.append(text_frame_suffix_);
+  return frame_buffer_;
+}
 
 std::string CompletionStreamFormatter::format_text(const std::string& text) {
   std::ostringstream oss;
@@ -354,43 +629,47 @@ int64_t get_current_timestamp() {
 std::string escape_json(const std::string& str) {
   std::string result;
   result.reserve(str.size());
+  escape_json_into(str, result);
+  return result;
+}
 
+void escape_json_into(const std::string& str, std::string& out) {
   for (char c : str) {
     switch (c) {
       case '"':
-        result += "\\\"";
+        out += "\\\"";
         break;
       case '\\':
-        result += "\\\\";
+        out += "\\\\";
         break;
       case '\b':
-        result += "\\b";
+        out += "\\b";
         break;
       case '\f':
-        result += "\\f";
+        out += "\\f";
         break;
       case '\n':
-        result += "\\n";
+        out += "\\n";
         break;
       case '\r':
-        result += "\\r";
+        out += "\\r";
         break;
       case '\t':
-        result += "\\t";
+        out += "\\t";
         break;
       default:
         if (c < 0x20) {
-          std::ostringstream oss;
-          oss << "\\u" << std::hex << std::setfill('0') << std::setw(4)
-              << static_cast<int>(static_cast<unsigned char>(c));
-          result += oss.str();
+          // Rare control character: format \uXXXX without a stream
+          static const char hex[] = "0123456789abcdef";
+          unsigned char uc = static_cast<unsigned char>(c);
+          out += "\\u00";
+          out += hex[(uc >> 4) & 0xF];
+          out += hex[uc & 0xF];
         } else {
-          result += c;
+          out += c;
         }
     }
   }
-
-  return result;
 }
 
 }  // namespace server
@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <map>
@@ -11,6 +13,7 @@
 #include <mutex>
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace mlxr {
@@ -47,6 +50,61 @@ struct SSEEvent {
  */
 using SSECallback = std::function<bool(const std::string& event)>;
 
+// ==============================================================================
+// Adaptive Flush Scheduling
+// ==============================================================================
+
+/**
+ * @brief Configuration for adaptive SSE flush coalescing
+ *
+ * Per-token flushes cost one transport write (syscall, or a whole TLS
+ * record) per ~4 bytes of payload. With one active stream that is the
+ * right trade - the reader sees every token immediately. Across 100
+ * streams the write storm measurably burns serving-thread CPU while the
+ * extra latency of a short coalescing window is invisible next to
+ * decode time. The window therefore scales with fan-out: zero when a
+ * stream is alone, ramping linearly to max_window_ms as the number of
+ * active streams approaches saturation_streams.
+ */
+struct SSEFlushConfig {
+  // Largest coalescing window, reached at saturation_streams fan-out
+  int max_window_ms = 20;
+
+  // Fan-out at which the window stops growing
+  int saturation_streams = 32;
+
+  // Flush regardless of the window once this many frames are pending,
+  // bounding buffered bytes for chatty streams
+  int max_pending_frames = 32;
+
+  // Per-request override: >= 0 fixes the window (0 = flush every
+  // token, for latency-sensitive clients); -1 uses the adaptive window
+  int override_window_ms = -1;
+};
+
+/**
+ * @brief Coalescing window for the current fan-out
+ * @param active_streams Number of SSE streams currently live
+ * @param config Flush configuration
+ * @return Window in milliseconds; 0 means flush immediately
+ */
+inline int coalesce_window_ms(int active_streams,
+                              const SSEFlushConfig& config) {
+  if (config.override_window_ms >= 0) {
+    return config.override_window_ms;
+  }
+  if (active_streams <= 1 || config.max_window_ms <= 0) {
+    return 0;
+  }
+  if (config.saturation_streams <= 1) {
+    return config.max_window_ms;
+  }
+  long scaled = static_cast<long>(config.max_window_ms) *
+                (active_streams - 1) / (config.saturation_streams - 1);
+  return static_cast<int>(
+      std::min(scaled, static_cast<long>(config.max_window_ms)));
+}
+
 /**
  * @brief Manages Server-Sent Events streaming
  *
@@ -99,11 +157,78 @@ class SSEStream {
    */
   bool send_comment(const std::string& comment);
 
+  /**
+   * @brief Send an already-framed SSE event (fast path)
+   * @param frame Complete wire bytes including "data: " prefix and
+   *        trailing blank line, e.g. from format_content_frame()
+   * @return True if sent successfully
+   *
+   * Skips SSEEvent::format(): no line splitting, no intermediate
+   * strings. This is the per-token emission path.
+   */
+  bool send_frame(const std::string& frame);
+
+  /**
+   * @brief Buffer a framed event for a coalesced flush
+   * @param frame Complete wire bytes (see send_frame)
+   *
+   * Appends into a per-stream buffer whose capacity is reused across
+   * flushes. Use with flush_frames() to hand the transport one write
+   * per batch instead of one per token.
+   */
+  void queue_frame(const std::string& frame);
+
+  /**
+   * @brief Flush all queued frames in a single transport write
+   * @return True if sent successfully (or nothing was queued)
+   */
+  bool flush_frames();
+
+  /**
+   * @brief Enable adaptive flush scheduling for submit_frame()
+   * @param config Window ramp and per-request override
+   * @param active_streams Live-stream counter the window adapts to
+   *        (the server's active_streams_ gauge); nullptr treats the
+   *        stream as alone, i.e. every submit flushes
+   */
+  void configure_flush(const SSEFlushConfig& config,
+                       const std::atomic<int>* active_streams);
+
+  /**
+   * @brief Queue a framed event and flush per the adaptive policy
+   * @param frame Complete wire bytes (see send_frame)
+   * @return True if the stream is still open (a deferred frame reports
+   *         true; the failure surfaces on the flush that writes it)
+   *
+   * Flushes immediately when the coalescing window for the current
+   * fan-out is zero (solo stream or per-request override), when the
+   * oldest pending frame has waited out the window, or when
+   * max_pending_frames have accumulated. Frames still pending when a
+   * direct send (finish chunk, [DONE]) arrives are flushed ahead of it
+   * in the same write, so ordering always holds.
+   */
+  bool submit_frame(const std::string& frame);
+
   /**
    * @brief Send the [DONE] marker to indicate stream completion
    */
   void send_done();
 
+  /**
+   * @brief Register a handler fired when a transport write fails
+   * @param handler Invoked exactly once, on the first send/flush whose
+   *        callback returns false (client disconnected)
+   *
+   * This is the cancellation fast path: the server wires it to
+   * Scheduler::cancel_request so a mid-stream disconnect stops decoding
+   * and frees the request's KV blocks instead of generating to
+   * max_tokens for a reader that is gone. The handler runs on the
+   * thread that attempted the write, outside the stream's lock, so it
+   * may safely call into the scheduler. Not fired by close() or the
+   * destructor — only by an actual failed write.
+   */
+  void set_disconnect_handler(std::function<void()> handler);
+
   /**
    * @brief Close the stream
    */
@@ -126,6 +251,31 @@ class SSEStream {
   std::atomic<bool> closed_;
   std::atomic<size_t> event_count_;
   mutable std::mutex mutex_;
+
+  // Fired once on the first failed transport write (see
+  // set_disconnect_handler); invoked outside mutex_
+  std::function<void()> disconnect_handler_;
+  std::atomic<bool> disconnect_signalled_;
+
+  // Marks the stream closed and fires the disconnect handler exactly
+  // once. Must be called without mutex_ held
+  void on_write_failure();
+
+  // Coalescing buffer for queue_frame()/flush_frames(); cleared but
+  // never shrunk, so steady-state flushes allocate nothing
+  std::string pending_frames_;
+  size_t pending_count_ = 0;
+
+  // Adaptive flush scheduling state (see configure_flush). The stamp
+  // marks when the oldest pending frame was queued
+  SSEFlushConfig flush_config_;
+  const std::atomic<int>* active_streams_ = nullptr;
+  std::chrono::steady_clock::time_point first_pending_time_;
+
+  // Flush the pending buffer with mutex_ already held; returns the
+  // transport result. Callers invoke on_write_failure() after
+  // releasing the lock
+  bool flush_frames_locked();
 };
 
 // ==============================================================================
@@ -280,12 +430,32 @@ class ChatCompletionStreamFormatter {
    */
   std::string format_content(const std::string& content);
 
+  /**
+   * @brief Format content delta chunk carrying a logprobs block
+   * @param content Content delta
+   * @param logprob Log-probability of the emitted token
+   * @param top_alternatives Top-k alternative tokens with their
+   *        log-probabilities, best first (may be empty)
+   * @return Formatted JSON chunk
+   *
+   * Emits the OpenAI chat-chunk logprobs shape: the choice carries a
+   * "logprobs" object with a one-entry "content" array for this delta.
+   * Used instead of the prebuilt fast-path frame when the request asked
+   * for logprobs, since the block varies per token.
+   */
+  std::string format_content_with_logprobs(
+      const std::string& content, float logprob,
+      const std::vector<std::pair<std::string, float>>& top_alternatives);
+
   /**
    * @brief Format final chunk with finish reason
    * @param finish_reason Finish reason (e.g., "stop", "length")
+   * @param timings_json Optional pre-serialized per-phase latency
+   *        breakdown embedded as a top-level "timings" object
    * @return Formatted JSON chunk
    */
-  std::string format_finish(const std::string& finish_reason);
+  std::string format_finish(const std::string& finish_reason,
+                            const std::string& timings_json = "");
 
   /**
    * @brief Format function call chunk
@@ -296,10 +466,29 @@ class ChatCompletionStreamFormatter {
   std::string format_function_call(const std::string& function_name,
                                    const std::string& arguments);
 
+  /**
+   * @brief Format a content delta as complete SSE wire bytes (fast path)
+   * @param content Content delta
+   * @return Reference to an internal reusable buffer, valid until the
+   *         next format_content_frame() call
+   *
+   * Everything except the token text is identical between chunks of a
+   * stream, so the surrounding JSON and SSE framing are prebuilt once
+   * in the constructor and the escaped token is spliced between them.
+   * Pass the result to SSEStream::send_frame or queue_frame.
+   */
+  const std::string& format_content_frame(const std::string& content);
+
  private:
   std::string request_id_;
   std::string model_;
   int64_t created_;
+
+  // Prebuilt frame template around the content splice point, and the
+  // reusable emission buffer (capacity retained across tokens)
+  std::string content_frame_prefix_;
+  std::string content_frame_suffix_;
+  std::string frame_buffer_;
 };
 
 /**
@@ -331,10 +520,25 @@ class CompletionStreamFormatter {
    */
   std::string format_finish(const std::string& finish_reason);
 
+  /**
+   * @brief Format a text delta as complete SSE wire bytes (fast path)
+   * @param text Text delta
+   * @return Reference to an internal reusable buffer, valid until the
+   *         next format_text_frame() call
+   *
+   * See ChatCompletionStreamFormatter::format_content_frame.
+   */
+  const std::string& format_text_frame(const std::string& text);
+
  private:
   std::string request_id_;
   std::string model_;
   int64_t created_;
+
+  // Prebuilt frame template and reusable emission buffer
+  std::string text_frame_prefix_;
+  std::string text_frame_suffix_;
+  std::string frame_buffer_;
 };
 
 // ==============================================================================
@@ -354,5 +558,15 @@ int64_t get_current_timestamp();
  */
 std::string escape_json(const std::string& str);
 
+/**
+ * @brief Escape JSON string, appending into an existing buffer
+ * @param str String to escape
+ * @param out Buffer to append to (not cleared)
+ *
+ * Allocation-free when out has spare capacity; used by the pooled
+ * emission path where the buffer lives for the whole stream.
+ */
+void escape_json_into(const std::string& str, std::string& out);
+
 }  // namespace server
 }  // namespace mlxr
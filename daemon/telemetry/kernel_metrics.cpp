@@ -0,0 +1,46 @@
+// Copyright © 2025 MLXR Development
+// Bridge from the core kernel profiler into the metrics registry
+
+#include "kernel_metrics.h"
+
+#include <cmath>
+
+#include "kernels/kernel_profiler.h"
+
+namespace mlxr {
+namespace telemetry {
+
+namespace {
+
+int64_t to_us(double ms) {
+  return static_cast<int64_t>(std::llround(ms * 1000.0));
+}
+
+}  // namespace
+
+void publish_kernel_profile(MetricsRegistry& registry) {
+  const auto stats = kernels::KernelProfiler::instance().snapshot();
+
+  for (const auto& entry : stats) {
+    const std::string prefix = "mlxr_kernel_" + entry.kernel;
+
+    registry
+        .register_gauge(prefix + "_dispatches",
+                        "Timed dispatches of " + entry.kernel +
+                            " (profiling mode)")
+        ->set(entry.samples);
+    registry
+        .register_gauge(prefix + "_gpu_time_us_total",
+                        "Cumulative GPU time of " + entry.kernel +
+                            " in microseconds (profiling mode)")
+        ->set(to_us(entry.total_ms));
+    registry
+        .register_gauge(prefix + "_gpu_time_us_last",
+                        "Last observed GPU time of " + entry.kernel +
+                            " in microseconds (profiling mode)")
+        ->set(to_us(entry.last_ms));
+  }
+}
+
+}  // namespace telemetry
+}  // namespace mlxr
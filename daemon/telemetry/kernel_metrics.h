@@ -0,0 +1,31 @@
+// Copyright © 2025 MLXR Development
+// Bridge from the core kernel profiler into the metrics registry
+
+#pragma once
+
+#include "metrics.h"
+
+namespace mlxr {
+namespace telemetry {
+
+/**
+ * Publish the kernel profiler's per-kernel timing aggregates as gauges
+ * in the given registry.
+ *
+ * For each custom kernel observed since the last profiler reset this
+ * registers/updates three gauges (microsecond resolution, since Gauge is
+ * integral):
+ *   - mlxr_kernel_<name>_dispatches
+ *   - mlxr_kernel_<name>_gpu_time_us_total
+ *   - mlxr_kernel_<name>_gpu_time_us_last
+ *
+ * Intended to be called from the metrics endpoints just before export so
+ * the published values are current. A no-op when profiling mode is off
+ * (the profiler has no samples to publish).
+ *
+ * @param registry Registry to publish into (usually MetricsRegistry::instance())
+ */
+void publish_kernel_profile(MetricsRegistry& registry);
+
+}  // namespace telemetry
+}  // namespace mlxr
@@ -6,10 +6,16 @@
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
+#include <limits>
 #include <nlohmann/json.hpp>
 #include <numeric>
 #include <sstream>
 
+#ifdef __APPLE__
+#include <notify.h>
+#include <sys/sysctl.h>
+#endif
+
 using json = nlohmann::json;
 
 namespace mlxr {
@@ -19,42 +25,124 @@ namespace telemetry {
 // Histogram Implementation
 // ==============================================================================
 
+namespace {
+
+// C++17 lacks fetch_add on atomic<double>; CAS loops keep the hot path
+// lock-free regardless
+void atomic_add(std::atomic<double>& target, double delta) {
+  double current = target.load(std::memory_order_relaxed);
+  while (!target.compare_exchange_weak(current, current + delta,
+                                       std::memory_order_relaxed)) {
+  }
+}
+
+void atomic_min(std::atomic<double>& target, double value) {
+  double current = target.load(std::memory_order_relaxed);
+  while (value < current && !target.compare_exchange_weak(
+                                current, value, std::memory_order_relaxed)) {
+  }
+}
+
+void atomic_max(std::atomic<double>& target, double value) {
+  double current = target.load(std::memory_order_relaxed);
+  while (value > current && !target.compare_exchange_weak(
+                                current, value, std::memory_order_relaxed)) {
+  }
+}
+
+}  // anonymous namespace
+
 Histogram::Histogram()
-    : count_(0),
+    : buckets_(kNumBuckets),
+      count_(0),
       sum_(0.0),
       min_(std::numeric_limits<double>::max()),
-      max_(std::numeric_limits<double>::min()) {
-  values_.reserve(10000);  // Pre-allocate
+      max_(std::numeric_limits<double>::lowest()) {}
+
+int Histogram::bucket_index(double value) {
+  const double scaled = value / kMinTrackable;
+  if (!(scaled >= 1.0)) {
+    return 0;  // Underflow bucket (also catches 0, negatives, NaN)
+  }
+
+  int octave = static_cast<int>(std::log2(scaled));
+  if (octave >= kOctaves) {
+    return kNumBuckets - 1;
+  }
+
+  // Position within the octave, split into kSubBuckets linear slices
+  const double octave_base = std::ldexp(1.0, octave);
+  int sub = static_cast<int>((scaled / octave_base - 1.0) * kSubBuckets);
+  sub = std::min(std::max(sub, 0), kSubBuckets - 1);
+
+  return 1 + octave * kSubBuckets + sub;
+}
+
+double Histogram::bucket_lower(int index) {
+  if (index <= 0) {
+    return 0.0;
+  }
+  const int octave = (index - 1) / kSubBuckets;
+  const int sub = (index - 1) % kSubBuckets;
+  return kMinTrackable * std::ldexp(1.0, octave) *
+         (1.0 + static_cast<double>(sub) / kSubBuckets);
+}
+
+double Histogram::bucket_width(int index) {
+  if (index <= 0) {
+    return kMinTrackable;
+  }
+  const int octave = (index - 1) / kSubBuckets;
+  return kMinTrackable * std::ldexp(1.0, octave) / kSubBuckets;
 }
 
 void Histogram::observe(double value) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  values_.push_back(value);
-  count_++;
-  sum_ += value;
-  min_ = std::min(min_, value);
-  max_ = std::max(max_, value);
+  buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  atomic_add(sum_, value);
+  atomic_min(min_, value);
+  atomic_max(max_, value);
 }
 
 Histogram::Stats Histogram::get_stats() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   Stats stats;
-  stats.count = count_;
-  stats.sum = sum_;
-  stats.min = (count_ > 0) ? min_ : 0.0;
-  stats.max = (count_ > 0) ? max_ : 0.0;
-  stats.mean = (count_ > 0) ? sum_ / count_ : 0.0;
 
-  if (count_ > 0 && !values_.empty()) {
-    // Calculate percentiles
-    std::vector<double> sorted = values_;
-    std::sort(sorted.begin(), sorted.end());
+  // Snapshot the buckets once; concurrent observes may land in either
+  // side of the snapshot, which is fine for monitoring data
+  std::vector<int64_t> counts(kNumBuckets);
+  int64_t total = 0;
+  for (int i = 0; i < kNumBuckets; i++) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+
+  stats.count = total;
+  stats.sum = sum_.load(std::memory_order_relaxed);
+  stats.min = (total > 0) ? min_.load(std::memory_order_relaxed) : 0.0;
+  stats.max = (total > 0) ? max_.load(std::memory_order_relaxed) : 0.0;
+  stats.mean = (total > 0) ? stats.sum / static_cast<double>(total) : 0.0;
 
+  if (total > 0) {
+    // Walk the cumulative counts and interpolate linearly inside the
+    // bucket that crosses the target rank
     auto percentile = [&](double p) -> double {
-      size_t idx = static_cast<size_t>(std::ceil(p * sorted.size())) - 1;
-      idx = std::min(idx, sorted.size() - 1);
-      return sorted[idx];
+      const double target = p * static_cast<double>(total);
+      int64_t cumulative = 0;
+      for (int i = 0; i < kNumBuckets; i++) {
+        if (counts[i] == 0) {
+          continue;
+        }
+        if (cumulative + counts[i] >= target) {
+          const double into_bucket =
+              (target - static_cast<double>(cumulative) - 0.5) /
+              static_cast<double>(counts[i]);
+          const double frac = std::min(std::max(into_bucket, 0.0), 1.0);
+          double value = bucket_lower(i) + frac * bucket_width(i);
+          return std::min(std::max(value, stats.min), stats.max);
+        }
+        cumulative += counts[i];
+      }
+      return stats.max;
     };
 
     stats.p50 = percentile(0.50);
@@ -70,12 +158,13 @@ Histogram::Stats Histogram::get_stats() const {
 }
 
 void Histogram::reset() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  values_.clear();
-  count_ = 0;
-  sum_ = 0.0;
-  min_ = std::numeric_limits<double>::max();
-  max_ = std::numeric_limits<double>::min();
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0.0, std::memory_order_relaxed);
+  min_.store(std::numeric_limits<double>::max(), std::memory_order_relaxed);
+  max_.store(std::numeric_limits<double>::lowest(), std::memory_order_relaxed);
 }
 
 // ==============================================================================
@@ -233,6 +322,71 @@ std::string MetricsRegistry::export_json() const {
   return j.dump(2);
 }
 
+void MetricsRegistry::start_snapshot_renderer(
+    int interval_ms, std::function<void()> pre_render) {
+  if (snapshot_running_.exchange(true)) {
+    return;  // Already running
+  }
+
+  // Publish an initial snapshot so the very first scrape is already a
+  // buffer read
+  if (pre_render) {
+    pre_render();
+  }
+  std::atomic_store_explicit(
+      &snapshot_, std::make_shared<const std::string>(export_prometheus()),
+      std::memory_order_release);
+
+  snapshot_thread_ = std::thread(&MetricsRegistry::snapshot_loop, this,
+                                 interval_ms, std::move(pre_render));
+}
+
+void MetricsRegistry::stop_snapshot_renderer() {
+  if (!snapshot_running_.exchange(false)) {
+    return;
+  }
+  snapshot_cv_.notify_all();
+  if (snapshot_thread_.joinable()) {
+    snapshot_thread_.join();
+  }
+}
+
+std::shared_ptr<const std::string> MetricsRegistry::prometheus_snapshot()
+    const {
+  auto snapshot =
+      std::atomic_load_explicit(&snapshot_, std::memory_order_acquire);
+  if (snapshot) {
+    return snapshot;
+  }
+  // No renderer has published yet: render on demand rather than serve
+  // nothing
+  return std::make_shared<const std::string>(export_prometheus());
+}
+
+void MetricsRegistry::snapshot_loop(int interval_ms,
+                                    std::function<void()> pre_render) {
+  while (snapshot_running_.load(std::memory_order_relaxed)) {
+    {
+      std::unique_lock<std::mutex> lock(snapshot_mutex_);
+      snapshot_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms),
+                            [this] {
+                              return !snapshot_running_.load(
+                                  std::memory_order_relaxed);
+                            });
+    }
+    if (!snapshot_running_.load(std::memory_order_relaxed)) {
+      break;
+    }
+
+    if (pre_render) {
+      pre_render();
+    }
+    std::atomic_store_explicit(
+        &snapshot_, std::make_shared<const std::string>(export_prometheus()),
+        std::memory_order_release);
+  }
+}
+
 void MetricsRegistry::reset_all() {
   std::lock_guard<std::mutex> lock(mutex_);
 
@@ -256,6 +410,12 @@ Counter* StandardMetrics::requests_success = nullptr;
 Counter* StandardMetrics::requests_error = nullptr;
 Histogram* StandardMetrics::request_duration_ms = nullptr;
 
+Histogram* StandardMetrics::queue_time_ms = nullptr;
+Histogram* StandardMetrics::prefill_time_ms = nullptr;
+Histogram* StandardMetrics::decode_time_ms = nullptr;
+Histogram* StandardMetrics::detokenize_time_ms = nullptr;
+Histogram* StandardMetrics::stream_write_time_ms = nullptr;
+
 Counter* StandardMetrics::tokens_generated = nullptr;
 Histogram* StandardMetrics::tokens_per_second = nullptr;
 Histogram* StandardMetrics::time_to_first_token_ms = nullptr;
@@ -296,6 +456,18 @@ void StandardMetrics::initialize() {
   request_duration_ms = registry.register_histogram(
       "mlxr_request_duration_ms", "Request duration in milliseconds");
 
+  // Per-phase latency breakdown
+  queue_time_ms = registry.register_histogram(
+      "mlxr_queue_time_ms", "Time from arrival to first prefill step in ms");
+  prefill_time_ms = registry.register_histogram(
+      "mlxr_prefill_time_ms", "Time in the prefill phase in ms");
+  decode_time_ms = registry.register_histogram(
+      "mlxr_decode_time_ms", "Time in the decode phase in ms");
+  detokenize_time_ms = registry.register_histogram(
+      "mlxr_detokenize_time_ms", "Per-request detokenization time in ms");
+  stream_write_time_ms = registry.register_histogram(
+      "mlxr_stream_write_time_ms", "Per-request SSE/transport write time in ms");
+
   // Token metrics
   tokens_generated = registry.register_counter(
       "mlxr_tokens_generated_total", "Total number of tokens generated");
@@ -464,15 +636,20 @@ void SystemMonitor::start() {
     return;  // Already running
   }
 
-  // TODO: Start monitoring thread
-  // For now, just initialize to zero
-  std::lock_guard<std::mutex> lock(mutex_);
-  current_stats_ = {};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_stats_ = {};
+  }
+
+  monitor_thread_ = std::thread(&SystemMonitor::monitor_loop, this);
 }
 
 void SystemMonitor::stop() {
   running_.store(false);
-  // TODO: Stop monitoring thread
+  cv_.notify_all();
+  if (monitor_thread_.joinable()) {
+    monitor_thread_.join();
+  }
 }
 
 SystemMonitor::SystemStats SystemMonitor::get_stats() const {
@@ -490,10 +667,66 @@ SystemMonitor::SystemStats SystemMonitor::get_stats() const {
   return stats;
 }
 
+PressureLevel SystemMonitor::pressure_level() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return current_stats_.thermal_pressure > current_stats_.memory_pressure
+             ? current_stats_.thermal_pressure
+             : current_stats_.memory_pressure;
+}
+
 void SystemMonitor::monitor_loop() {
-  // TODO: Implement system monitoring
-  // This would periodically sample CPU/GPU usage and memory
-  // For now, placeholder implementation
+  while (running_) {
+    PressureLevel thermal = PressureLevel::NOMINAL;
+    PressureLevel memory = PressureLevel::NOMINAL;
+
+#ifdef __APPLE__
+    // Thermal pressure: the kernel publishes its level through the
+    // notify subsystem, so polling the registered state gives us the
+    // same signal as NSProcessInfo.thermalState without an ObjC
+    // dependency in this translation unit.
+    // Levels follow kOSThermalPressureLevel: 0 nominal, 10 moderate,
+    // 20 heavy, 30+ trapping/sleeping
+    static int thermal_token = -1;
+    if (thermal_token < 0) {
+      if (notify_register_check("com.apple.system.thermalpressurelevel",
+                                &thermal_token) != NOTIFY_STATUS_OK) {
+        thermal_token = -1;
+      }
+    }
+    if (thermal_token >= 0) {
+      uint64_t state = 0;
+      if (notify_get_state(thermal_token, &state) == NOTIFY_STATUS_OK) {
+        if (state >= 30) {
+          thermal = PressureLevel::CRITICAL;
+        } else if (state >= 20) {
+          thermal = PressureLevel::HEAVY;
+        } else if (state >= 10) {
+          thermal = PressureLevel::MODERATE;
+        }
+      }
+    }
+
+    // Memory pressure: memorystatus reports 1 normal, 2 warn, 4 critical
+    int vm_level = 0;
+    size_t len = sizeof(vm_level);
+    if (sysctlbyname("kern.memorystatus_vm_pressure_level", &vm_level, &len,
+                     nullptr, 0) == 0) {
+      if (vm_level >= 4) {
+        memory = PressureLevel::CRITICAL;
+      } else if (vm_level >= 2) {
+        memory = PressureLevel::MODERATE;
+      }
+    }
+#endif
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    current_stats_.thermal_pressure = thermal;
+    current_stats_.memory_pressure = memory;
+
+    // Interruptible sleep so stop() does not block for a full interval
+    cv_.wait_for(lock, std::chrono::seconds(1),
+                 [this]() { return !running_.load(); });
+  }
 }
 
 }  // namespace telemetry
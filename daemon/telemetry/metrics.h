@@ -5,10 +5,13 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace mlxr {
@@ -19,20 +22,50 @@ namespace telemetry {
 // ==============================================================================
 
 // Counter: monotonically increasing value
+//
+// Sharded across cache lines: each thread increments its own shard with
+// a relaxed atomic add, so per-token instrumentation from the worker,
+// scheduler and SSE threads never bounces a shared line. value() sums
+// the shards lazily at scrape time
 class Counter {
  public:
-  Counter() : value_(0) {}
+  Counter() = default;
 
   void increment(int64_t delta = 1) {
-    value_.fetch_add(delta, std::memory_order_relaxed);
+    shards_[shard_index()].value.fetch_add(delta, std::memory_order_relaxed);
   }
 
-  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+  int64_t value() const {
+    int64_t total = 0;
+    for (const auto& shard : shards_) {
+      total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
 
-  void reset() { value_.store(0, std::memory_order_relaxed); }
+  void reset() {
+    for (auto& shard : shards_) {
+      shard.value.store(0, std::memory_order_relaxed);
+    }
+  }
 
  private:
-  std::atomic<int64_t> value_;
+  static constexpr size_t kNumShards = 16;
+
+  struct alignas(64) Shard {
+    std::atomic<int64_t> value{0};
+  };
+
+  // Threads are assigned shards round-robin on first use; collisions
+  // just mean two threads share an atomic, never incorrect counts
+  static size_t shard_index() {
+    static std::atomic<size_t> next_shard{0};
+    thread_local size_t index =
+        next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+    return index;
+  }
+
+  Shard shards_[kNumShards];
 };
 
 // Gauge: value that can go up or down
@@ -57,6 +90,13 @@ class Gauge {
 };
 
 // Histogram: tracks distribution of values
+//
+// Lock-free fixed buckets: values land in log-linear buckets (64 linear
+// sub-buckets per power-of-two octave, HdrHistogram-style) so observe()
+// is a handful of relaxed atomic ops and never allocates or takes a
+// lock. Percentiles are reconstructed at scrape time by walking the
+// cumulative bucket counts with linear interpolation inside the bucket,
+// accurate to well under one sub-bucket width (~1.6% relative error)
 class Histogram {
  public:
   Histogram();
@@ -78,12 +118,24 @@ class Histogram {
   void reset();
 
  private:
-  mutable std::mutex mutex_;
-  std::vector<double> values_;
-  int64_t count_;
-  double sum_;
-  double min_;
-  double max_;
+  // 48 octaves of 64 sub-buckets starting at 1e-6 covers ~1e-6..2.8e8,
+  // enough for ratios (0-1), tokens/sec and millisecond latencies alike.
+  // Slot 0 catches underflow (values below the first bound, incl. 0)
+  static constexpr int kSubBucketBits = 6;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kOctaves = 48;
+  static constexpr int kNumBuckets = kOctaves * kSubBuckets + 1;
+  static constexpr double kMinTrackable = 1e-6;
+
+  static int bucket_index(double value);
+  static double bucket_lower(int index);
+  static double bucket_width(int index);
+
+  std::vector<std::atomic<int64_t>> buckets_;
+  std::atomic<int64_t> count_;
+  std::atomic<double> sum_;
+  std::atomic<double> min_;
+  std::atomic<double> max_;
 };
 
 // Timer: measures duration of operations
@@ -135,17 +187,46 @@ class MetricsRegistry {
   std::string export_prometheus() const;
   std::string export_json() const;
 
+  // Start the background exposition renderer: every interval_ms it runs
+  // the optional pre_render hook (e.g. refreshing kernel-profile
+  // gauges), renders the Prometheus text exposition once, and publishes
+  // it with an atomic buffer swap. Scrapes then return the pre-rendered
+  // snapshot instead of walking every metric under the registry lock,
+  // so scrape frequency never contends with token serving. Idempotent
+  void start_snapshot_renderer(int interval_ms = 1000,
+                               std::function<void()> pre_render = nullptr);
+
+  // Stop the renderer (joins the thread; the last published snapshot
+  // stays readable)
+  void stop_snapshot_renderer();
+
+  // Current pre-rendered Prometheus snapshot. A lock-free pointer load
+  // on the scrape path; falls back to rendering on demand only when the
+  // renderer has never published (renderer disabled, unit tests)
+  std::shared_ptr<const std::string> prometheus_snapshot() const;
+
   // Reset all metrics
   void reset_all();
 
  private:
   MetricsRegistry() = default;
+  ~MetricsRegistry() { stop_snapshot_renderer(); }
+
+  void snapshot_loop(int interval_ms, std::function<void()> pre_render);
 
   mutable std::mutex mutex_;
   std::map<std::string, std::unique_ptr<Counter>> counters_;
   std::map<std::string, std::unique_ptr<Gauge>> gauges_;
   std::map<std::string, std::unique_ptr<Histogram>> histograms_;
   std::map<std::string, std::string> descriptions_;
+
+  // Published exposition buffer, swapped whole via std::atomic_load /
+  // atomic_store so readers never see a partial render
+  std::shared_ptr<const std::string> snapshot_;
+  std::thread snapshot_thread_;
+  std::atomic<bool> snapshot_running_{false};
+  mutable std::mutex snapshot_mutex_;  // Pairs with snapshot_cv_ only
+  std::condition_variable snapshot_cv_;
 };
 
 // ==============================================================================
@@ -162,6 +243,14 @@ class StandardMetrics {
   static Counter* requests_error;
   static Histogram* request_duration_ms;
 
+  // Per-phase latency breakdown (queue wait, prefill, decode, then the
+  // serving-side detokenize and SSE-write costs)
+  static Histogram* queue_time_ms;
+  static Histogram* prefill_time_ms;
+  static Histogram* decode_time_ms;
+  static Histogram* detokenize_time_ms;
+  static Histogram* stream_write_time_ms;
+
   // Token metrics
   static Counter* tokens_generated;
   static Histogram* tokens_per_second;
@@ -230,6 +319,17 @@ class RequestTracker {
 // System Monitor
 // ==============================================================================
 
+// Severity of an OS resource-pressure signal (thermal state or memory
+// pressure). Ordered so consumers can compare levels directly; maps the
+// kernel's thermal pressure levels and memorystatus pressure onto one
+// scale the scheduler can act on
+enum class PressureLevel : int {
+  NOMINAL = 0,   // Unconstrained
+  MODERATE = 1,  // OS beginning to throttle; reduce duty cycle
+  HEAVY = 2,     // Sustained throttling; shed batch-class load
+  CRITICAL = 3,  // Imminent clamp; stop admitting new work
+};
+
 class SystemMonitor {
  public:
   static SystemMonitor& instance();
@@ -249,10 +349,18 @@ class SystemMonitor {
     int64_t memory_used_bytes;
     int64_t gpu_memory_used_bytes;
     int64_t uptime_seconds;
+    // Sampled from the kernel's thermal notify state and the
+    // memorystatus VM pressure level (NOMINAL on non-macOS builds)
+    PressureLevel thermal_pressure;
+    PressureLevel memory_pressure;
   };
 
   SystemStats get_stats() const;
 
+  // Worst of the thermal and memory pressure signals; this is what the
+  // scheduler's throttling feedback loop consumes
+  PressureLevel pressure_level() const;
+
  private:
   SystemMonitor();
   ~SystemMonitor();
@@ -261,6 +369,8 @@ class SystemMonitor {
 
   std::atomic<bool> running_;
   mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread monitor_thread_;
   SystemStats current_stats_;
   std::chrono::steady_clock::time_point start_time_;
 };
@@ -0,0 +1,145 @@
+// Copyright © 2025 MLXR Development
+// Scheduler event tracing implementation
+
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace mlxr {
+namespace telemetry {
+
+TraceRecorder& TraceRecorder::instance() {
+  static TraceRecorder recorder;
+  return recorder;
+}
+
+uint64_t TraceRecorder::now_ns() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::local_buffer() {
+  // The recorder owns the buffer; this thread just caches a pointer.
+  // Buffers outlive their threads so a dump after thread exit still
+  // shows that thread's tail of events
+  thread_local ThreadBuffer* buffer = nullptr;
+  if (!buffer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto owned = std::make_unique<ThreadBuffer>();
+    owned->tid = buffers_.size() + 1;
+    buffer = owned.get();
+    buffers_.push_back(std::move(owned));
+  }
+  return buffer;
+}
+
+void TraceRecorder::record(const TraceEvent& event) {
+  ThreadBuffer* buffer = local_buffer();
+  uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  buffer->events[head % kRingCapacity] = event;
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void TraceRecorder::record_instant(const char* name, const char* arg_name,
+                                   int64_t arg_value) {
+  if (!enabled()) {
+    return;
+  }
+  TraceEvent event;
+  event.name = name;
+  event.phase = 'i';
+  event.ts_ns = now_ns();
+  event.arg_name = arg_name;
+  event.arg_value = arg_value;
+  record(event);
+}
+
+void TraceRecorder::record_span(const char* name, uint64_t start_ns,
+                                const char* arg_name, int64_t arg_value) {
+  if (!enabled()) {
+    return;
+  }
+  TraceEvent event;
+  event.name = name;
+  event.phase = 'X';
+  event.ts_ns = start_ns;
+  event.dur_ns = now_ns() - start_ns;
+  event.arg_name = arg_name;
+  event.arg_value = arg_value;
+  record(event);
+}
+
+void TraceRecorder::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& buffer : buffers_) {
+    buffer->head.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::string TraceRecorder::dump_json() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::ostringstream json;
+  json << "{\"traceEvents\":[";
+
+  bool first = true;
+  for (const auto& buffer : buffers_) {
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    uint64_t count = std::min<uint64_t>(head, kRingCapacity);
+    uint64_t begin = head - count;  // oldest surviving event
+
+    for (uint64_t i = begin; i < head; i++) {
+      const TraceEvent& event = buffer->events[i % kRingCapacity];
+      if (!event.name) {
+        continue;  // torn write from a concurrent recorder
+      }
+      if (!first) {
+        json << ",";
+      }
+      first = false;
+
+      // chrome://tracing expects microseconds
+      json << "{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase
+           << "\",\"ts\":" << (event.ts_ns / 1000) << ",\"pid\":1,\"tid\":"
+           << buffer->tid;
+      if (event.phase == 'X') {
+        json << ",\"dur\":" << (event.dur_ns / 1000);
+      } else {
+        json << ",\"s\":\"t\"";  // instant scoped to its thread
+      }
+      if (event.arg_name) {
+        json << ",\"args\":{\"" << event.arg_name
+             << "\":" << event.arg_value << "}";
+      }
+      json << "}";
+    }
+  }
+
+  json << "]}";
+  return json.str();
+}
+
+ScopedTraceSpan::ScopedTraceSpan(const char* name, const char* arg_name,
+                                 int64_t arg_value)
+    : name_(name),
+      arg_name_(arg_name),
+      arg_value_(arg_value),
+      active_(TraceRecorder::instance().enabled()) {
+  if (active_) {
+    start_ns_ = TraceRecorder::now_ns();
+  }
+}
+
+ScopedTraceSpan::~ScopedTraceSpan() {
+  if (active_) {
+    TraceRecorder::instance().record_span(name_, start_ns_, arg_name_,
+                                          arg_value_);
+  }
+}
+
+}  // namespace telemetry
+}  // namespace mlxr
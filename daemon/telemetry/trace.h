@@ -0,0 +1,126 @@
+// Copyright © 2025 MLXR Development
+// Scheduler event tracing with per-thread ring buffers
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mlxr {
+namespace telemetry {
+
+/**
+ * One trace event. Names and argument keys must be string literals (the
+ * recorder stores the pointers, not copies) so recording never allocates.
+ */
+struct TraceEvent {
+  const char* name = nullptr;
+  char phase = 'i';        // 'X' = complete (span), 'i' = instant
+  uint64_t ts_ns = 0;      // steady_clock timestamp
+  uint64_t dur_ns = 0;     // span duration ('X' only)
+  const char* arg_name = nullptr;  // optional integer argument
+  int64_t arg_value = 0;
+};
+
+/**
+ * Process-global event recorder for the scheduler timeline.
+ *
+ * Each recording thread gets its own fixed-size ring buffer, so the hot
+ * path is one relaxed atomic load (enabled check), a timestamp, and a
+ * store into thread-local memory — no locks, no allocation, and the ring
+ * overwrites the oldest events instead of growing. Disabled (the
+ * default), recording is just the atomic load.
+ *
+ * dump_json() renders everything currently buffered as chrome://tracing
+ * "traceEvents" JSON. The dump takes the registry lock but readers never
+ * block writers; an event being written concurrently may be torn, which
+ * is acceptable for a debug timeline. The REST server exposes this via
+ * GET /debug/trace (with /debug/trace/start and /debug/trace/stop to
+ * toggle recording).
+ */
+class TraceRecorder {
+ public:
+  static TraceRecorder& instance();
+
+  TraceRecorder(const TraceRecorder&) = delete;
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  void set_enabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_release);
+  }
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /** Current steady-clock time in nanoseconds */
+  static uint64_t now_ns();
+
+  /**
+   * Record a point-in-time event.
+   * @param name Event name (string literal)
+   * @param arg_name Optional argument key (string literal, may be null)
+   * @param arg_value Argument value (ignored when arg_name is null)
+   */
+  void record_instant(const char* name, const char* arg_name = nullptr,
+                      int64_t arg_value = 0);
+
+  /**
+   * Record a completed span.
+   * @param name Span name (string literal)
+   * @param start_ns Span start from now_ns()
+   * @param arg_name Optional argument key (string literal, may be null)
+   * @param arg_value Argument value (ignored when arg_name is null)
+   */
+  void record_span(const char* name, uint64_t start_ns,
+                   const char* arg_name = nullptr, int64_t arg_value = 0);
+
+  /** Drop all buffered events (buffers themselves are kept) */
+  void clear();
+
+  /** Render buffered events as chrome://tracing JSON */
+  std::string dump_json() const;
+
+ private:
+  TraceRecorder() = default;
+
+  // Ring capacity per thread; at ~50 events per scheduler step this
+  // holds several seconds of timeline, which is what a p95 spike needs
+  static constexpr size_t kRingCapacity = 8192;
+
+  struct ThreadBuffer {
+    std::vector<TraceEvent> events{kRingCapacity};
+    std::atomic<uint64_t> head{0};  // total events written (monotonic)
+    uint64_t tid = 0;
+  };
+
+  ThreadBuffer* local_buffer();
+  void record(const TraceEvent& event);
+
+  std::atomic<bool> enabled_{false};
+  mutable std::mutex mutex_;  // guards buffers_ registration and dump
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+/**
+ * Records a span covering the enclosing scope when tracing is enabled;
+ * a no-op otherwise.
+ */
+class ScopedTraceSpan {
+ public:
+  explicit ScopedTraceSpan(const char* name, const char* arg_name = nullptr,
+                           int64_t arg_value = 0);
+  ~ScopedTraceSpan();
+
+ private:
+  const char* name_;
+  const char* arg_name_;
+  int64_t arg_value_;
+  bool active_;
+  uint64_t start_ns_ = 0;
+};
+
+}  // namespace telemetry
+}  // namespace mlxr
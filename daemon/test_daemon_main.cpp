@@ -1,7 +1,6 @@
 // Test daemon main - HTTP server with scheduler integration
 // This is a test file to verify the full inference pipeline
 
-#include <dirent.h>
 #include <sys/stat.h>
 
 #include <atomic>
@@ -17,6 +16,7 @@
 #include "../core/runtime/engine.h"
 #include "../core/runtime/tokenizer/tokenizer.h"
 #include "registry/model_registry.h"
+#include "registry/model_scanner.h"
 #include "scheduler/scheduler.h"
 #include "server/rest_server.h"
 #include "server/scheduler_worker.h"
@@ -38,24 +38,12 @@ bool is_directory(const std::string& path) {
   return (stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode));
 }
 
-// Helper function to check if a file exists
-bool file_exists(const std::string& path) {
-  struct stat st;
-  return (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode));
-}
-
-// Helper function to get file size
-uint64_t get_file_size(const std::string& path) {
-  struct stat st;
-  if (stat(path.c_str(), &st) == 0) {
-    return st.st_size;
-  }
-  return 0;
-}
-
-// Scan models directory and register discovered models
-void scan_and_register_models(registry::ModelRegistry& registry,
-                              const std::string& models_dir) {
+// Scan models directory and register discovered models. Header-only
+// parallel scan: candidate files are probed concurrently and new models
+// are bulk-inserted in one transaction (see registry/model_scanner.h)
+void scan_and_register_models(
+    std::shared_ptr<registry::ModelRegistry> registry,
+    const std::string& models_dir) {
   std::cout << "Scanning models directory: " << models_dir << std::endl;
 
   if (!is_directory(models_dir)) {
@@ -63,100 +51,14 @@ void scan_and_register_models(registry::ModelRegistry& registry,
     return;
   }
 
-  DIR* dir = opendir(models_dir.c_str());
-  if (!dir) {
-    std::cerr << "Failed to open models directory" << std::endl;
-    return;
-  }
+  registry::ModelScanner scanner(registry);
+  auto result = scanner.scan_directory(models_dir);
 
-  int models_found = 0;
-  struct dirent* entry;
-
-  while ((entry = readdir(dir)) != nullptr) {
-    std::string model_name = entry->d_name;
-
-    // Skip . and ..
-    if (model_name == "." || model_name == "..") {
-      continue;
-    }
-
-    std::string model_path = models_dir + "/" + model_name;
-
-    // Check if it's a directory
-    if (!is_directory(model_path)) {
-      continue;
-    }
-
-    // Look for model files (safetensors or GGUF)
-    std::string safetensors_path = model_path + "/model.safetensors";
-    std::string gguf_path = model_path + "/ggml-model-f16.gguf";
-
-    registry::ModelInfo info;
-    info.name = model_name;
-    info.model_id = model_name;
-    info.architecture = registry::ModelArchitecture::LLAMA;  // Default to Llama
-
-    // Check for safetensors format
-    if (file_exists(safetensors_path)) {
-      info.file_path = safetensors_path;
-      info.format = registry::ModelFormat::SAFETENSORS;
-      info.file_size = get_file_size(safetensors_path);
-      info.quant_type =
-          registry::QuantizationType::NONE;  // Safetensors usually FP16
-    }
-    // Check for GGUF format
-    else if (file_exists(gguf_path)) {
-      info.file_path = gguf_path;
-      info.format = registry::ModelFormat::GGUF;
-      info.file_size = get_file_size(gguf_path);
-      info.quant_type = registry::QuantizationType::Q4_K;  // Default assumption
-    } else {
-      // No recognized model file found
-      continue;
-    }
-
-    // Look for tokenizer
-    std::string tokenizer_path = model_path + "/tokenizer.model";
-    if (file_exists(tokenizer_path)) {
-      info.tokenizer_type = "sentencepiece";
-      info.tokenizer_path = tokenizer_path;
-    }
-
-    // Set some defaults
-    info.param_count =
-        1100000000;  // ~1.1B, will be updated when model is loaded
-    info.context_length = 2048;
-    info.hidden_size = 2048;
-    info.num_layers = 22;
-    info.num_heads = 32;
-    info.num_kv_heads = 4;
-    info.intermediate_size = 5632;
-    info.vocab_size = 32000;
-    info.rope_freq_base = 10000.0f;
-    info.rope_scale = 1.0f;
-    info.rope_scaling_type = "none";
-    info.description = "Discovered model: " + model_name;
-    info.is_loaded = false;
-
-    // Register the model
-    int64_t model_id = registry.register_model(info);
-    if (model_id >= 0) {
-      std::cout << "  ✓ Registered model: " << model_name << " (id=" << model_id
-                << ", format="
-                << (info.format == registry::ModelFormat::SAFETENSORS
-                        ? "safetensors"
-                        : "gguf")
-                << ")" << std::endl;
-      models_found++;
-    } else {
-      std::cerr << "  ✗ Failed to register model: " << model_name << std::endl;
-    }
-  }
-
-  closedir(dir);
-
-  std::cout << "Model scan complete. Found " << models_found << " model(s)"
-            << std::endl;
+  std::cout << "Model scan complete in " << static_cast<int>(result.elapsed_ms)
+            << " ms: " << result.models_registered << " registered, "
+            << result.skipped_existing << " already known, "
+            << result.parse_failures << " unreadable (of "
+            << result.files_considered << " candidate file(s))" << std::endl;
 }
 
 int main() {
@@ -200,7 +102,7 @@ int main() {
 
   // Scan and register models from disk
   std::filesystem::path models_dir = std::filesystem::path(home) / "models" / "llm";
-  scan_and_register_models(*registry, models_dir.string());
+  scan_and_register_models(registry, models_dir.string());
 
   // Display registered models
   auto registered_models = registry->list_models();
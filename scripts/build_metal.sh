@@ -116,7 +116,41 @@ compile_all() {
     fi
 }
 
+# Emit the GQA decode variant matrix.
+# attention_decode_gqa is specialized per (group ratio, head_dim) through
+# Metal function constants, so the metallib carries a single entry point
+# and each variant is compiled at pipeline-creation time on first use.
+# The manifest records the matrix the runtime may request; the daemon's
+# pipeline archive pre-warms from it when compile_all_variants is enabled.
+GQA_GROUP_SIZES="1 4 8"
+HEAD_DIMS="64 80 96 112 128 160 192 256"
+
+emit_variant_matrix() {
+    local manifest="$OUTPUT_DIR/attention_decode_variants.txt"
+    local count=0
+
+    : > "$manifest"
+    for group in $GQA_GROUP_SIZES; do
+        for head_dim in $HEAD_DIMS; do
+            echo "attention_decode_gqa g=$group d=$head_dim" >> "$manifest"
+            count=$((count + 1))
+        done
+    done
+
+    echo ""
+    echo -e "${GREEN}=== GQA Decode Variant Matrix ===${NC}"
+    echo "Group ratios: $GQA_GROUP_SIZES"
+    echo "Head dims:    $HEAD_DIMS"
+    echo "Variants:     $count (function-constant specialized at pipeline creation)"
+    echo "Manifest:     $manifest"
+}
+
 # Main execution
 compile_all
+build_status=$?
+
+if [ $build_status -eq 0 ]; then
+    emit_variant_matrix
+fi
 
-exit $?
+exit $build_status
@@ -0,0 +1,66 @@
+// Copyright © 2025 MLXR Development
+// Unit tests for the ANE embedding backend's pooling helpers
+//
+// The CoreML bridge itself only runs on Apple Silicon; the pooling and
+// normalization math it applies to model outputs is header-only and
+// tested here off-device
+
+#include "runtime/ane_embedder.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace mlxr::runtime::ane;
+
+namespace {
+
+TEST(AneMaskedMeanPoolTest, AveragesValidPositionsOnly) {
+  // Two real tokens and one padding position
+  const std::vector<float> states = {
+      1.0f, 2.0f,   // token 0
+      3.0f, 4.0f,   // token 1
+      9.0f, 9.0f,   // padding - must not contribute
+  };
+  const std::vector<int> mask = {1, 1, 0};
+
+  auto pooled = masked_mean_pool(states.data(), 3, 2, mask);
+  ASSERT_EQ(pooled.size(), 2u);
+  EXPECT_FLOAT_EQ(pooled[0], 2.0f);
+  EXPECT_FLOAT_EQ(pooled[1], 3.0f);
+}
+
+TEST(AneMaskedMeanPoolTest, EmptyMaskMeansAllValid) {
+  const std::vector<float> states = {2.0f, 4.0f};
+  auto pooled = masked_mean_pool(states.data(), 2, 1, {});
+  ASSERT_EQ(pooled.size(), 1u);
+  EXPECT_FLOAT_EQ(pooled[0], 3.0f);
+}
+
+TEST(AneMaskedMeanPoolTest, AllPaddingYieldsZeros) {
+  const std::vector<float> states = {5.0f, 5.0f};
+  const std::vector<int> mask = {0, 0};
+  auto pooled = masked_mean_pool(states.data(), 2, 1, mask);
+  ASSERT_EQ(pooled.size(), 1u);
+  EXPECT_FLOAT_EQ(pooled[0], 0.0f);
+}
+
+TEST(AneL2NormalizeTest, ProducesUnitVector) {
+  std::vector<float> row = {3.0f, 4.0f};
+  l2_normalize(row);
+  EXPECT_FLOAT_EQ(row[0], 0.6f);
+  EXPECT_FLOAT_EQ(row[1], 0.8f);
+
+  float norm = std::sqrt(row[0] * row[0] + row[1] * row[1]);
+  EXPECT_NEAR(norm, 1.0f, 1e-6f);
+}
+
+TEST(AneL2NormalizeTest, ZeroVectorIsLeftAlone) {
+  std::vector<float> row = {0.0f, 0.0f};
+  l2_normalize(row);
+  EXPECT_FLOAT_EQ(row[0], 0.0f);
+  EXPECT_FLOAT_EQ(row[1], 0.0f);
+}
+
+}  // namespace
@@ -0,0 +1,233 @@
+// Copyright © 2025 MLXR Development
+// Background KV block migration unit tests
+
+#include "runtime/kv/migration.h"
+
+#include <gtest/gtest.h>
+
+using namespace mlxr;
+using namespace mlxr::runtime::kv;
+
+namespace {
+
+class BlockMigratorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ArenaConfig arena_config;
+    arena_config.num_layers = 2;
+    arena_config.block_size_tokens = 4;
+    arena_config.num_blocks = 16;
+    arena_config.max_cpu_blocks = 8;
+    arena_config.num_kv_heads = 2;
+    arena_config.head_dim = 8;
+    arena_config.allow_cpu_overflow = true;
+
+    arena_ = std::make_shared<Arena>(arena_config);
+    pager_ = std::make_shared<Pager>(arena_);
+
+    MigrationConfig config;
+    config.poll_interval_ms = 5;
+    config.demote_batch = 4;
+    config.prefetch_batch = 4;
+    migrator_ = std::make_unique<BlockMigrator>(pager_, config);
+  }
+
+  // Create a sequence with blocks covering num_tokens tokens
+  void make_sequence(int seq_id, int num_tokens) {
+    ASSERT_TRUE(pager_->create_sequence(seq_id));
+    ASSERT_TRUE(pager_->allocate_blocks_for_sequence(seq_id, num_tokens));
+    pager_->get_sequence(seq_id)->set_num_tokens(num_tokens);
+  }
+
+  std::shared_ptr<Arena> arena_;
+  std::shared_ptr<Pager> pager_;
+  std::unique_ptr<BlockMigrator> migrator_;
+};
+
+// Test thread start/stop lifecycle
+TEST_F(BlockMigratorTest, StartStop) {
+  EXPECT_FALSE(migrator_->is_running());
+
+  migrator_->start();
+  EXPECT_TRUE(migrator_->is_running());
+
+  migrator_->stop();
+  EXPECT_FALSE(migrator_->is_running());
+}
+
+// Test that an idle pass with no pressure moves nothing
+TEST_F(BlockMigratorTest, NoMigrationWithoutPressure) {
+  make_sequence(1, 8);
+
+  EXPECT_EQ(migrator_->run_once(), 0);
+
+  auto stats = migrator_->get_stats();
+  EXPECT_EQ(stats.blocks_demoted, 0);
+  EXPECT_EQ(stats.blocks_promoted, 0);
+  EXPECT_EQ(stats.passes, 1);
+}
+
+// Test explicit prefetch promotes a sequence's CPU-resident blocks
+TEST_F(BlockMigratorTest, PrefetchPromotesCpuBlocks) {
+  make_sequence(1, 8);  // 2 blocks
+
+  // Push the sequence's blocks to CPU manually
+  const auto& page_table = pager_->get_sequence(1)->page_table();
+  for (int block_id : page_table) {
+    ASSERT_TRUE(arena_->move_to_cpu(block_id));
+  }
+
+  migrator_->request_prefetch(1);
+  int moved = migrator_->run_once();
+  EXPECT_EQ(moved, 2);
+
+  for (int block_id : page_table) {
+    const Block* block = pager_->get_block(block_id);
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(block->location, 0);  // Back on GPU
+  }
+}
+
+// Test prediction path: working-set stats drive promotion without an
+// explicit prefetch request
+TEST_F(BlockMigratorTest, PredictedPrefetchUsesWorkingSetStats) {
+  make_sequence(1, 4);
+  make_sequence(2, 4);
+
+  // Both sequences' blocks on CPU; only seq 2 is recorded as hot
+  for (int seq_id : {1, 2}) {
+    for (int block_id : pager_->get_sequence(seq_id)->page_table()) {
+      ASSERT_TRUE(arena_->move_to_cpu(block_id));
+    }
+  }
+
+  EvictionConfig eviction_config;
+  WorkingSetEvictionPolicy policy(eviction_config);
+  policy.record_access(2);
+  migrator_->set_working_set_policy(&policy);
+
+  migrator_->run_once();
+
+  EXPECT_EQ(pager_->get_block(pager_->get_sequence(2)->page_table()[0])
+                ->location,
+            0);
+  EXPECT_EQ(pager_->get_block(pager_->get_sequence(1)->page_table()[0])
+                ->location,
+            1);
+}
+
+// Test prefetch budget caps promotions per pass
+TEST_F(BlockMigratorTest, PrefetchRespectsBatchBudget) {
+  make_sequence(1, 24);  // 6 blocks, budget is 4
+
+  const auto& page_table = pager_->get_sequence(1)->page_table();
+  for (int block_id : page_table) {
+    ASSERT_TRUE(arena_->move_to_cpu(block_id));
+  }
+
+  migrator_->request_prefetch(1);
+  EXPECT_EQ(migrator_->run_once(), 4);
+
+  int on_gpu = 0;
+  for (int block_id : page_table) {
+    if (pager_->get_block(block_id)->location == 0) on_gpu++;
+  }
+  EXPECT_EQ(on_gpu, 4);
+}
+
+// Test an idle pass returns freed CPU-listed blocks to the GPU tier
+TEST_F(BlockMigratorTest, CompactionReclaimsFreedCpuBlocks) {
+  make_sequence(1, 8);  // 2 blocks
+
+  // Demote, then free: the blocks land on the CPU free list and would
+  // otherwise be lost to the GPU allocator's fast path for good
+  for (int block_id : pager_->get_sequence(1)->page_table()) {
+    ASSERT_TRUE(arena_->move_to_cpu(block_id));
+  }
+  pager_->delete_sequence(1);
+  ASSERT_EQ(arena_->num_free_cpu_blocks(), 2);
+
+  EXPECT_EQ(migrator_->run_once(), 2);
+
+  EXPECT_EQ(arena_->num_free_cpu_blocks(), 0);
+  EXPECT_EQ(arena_->num_free_gpu_blocks(), 2);
+  EXPECT_EQ(migrator_->get_stats().blocks_compacted, 2);
+}
+
+// Test an idle pass brings an active sequence's stranded CPU blocks
+// back to the GPU once free space is plentiful
+TEST_F(BlockMigratorTest, CompactionPromotesActiveStrandedBlocks) {
+  make_sequence(1, 8);  // 2 blocks
+
+  for (int block_id : pager_->get_sequence(1)->page_table()) {
+    ASSERT_TRUE(arena_->move_to_cpu(block_id));
+  }
+
+  MigrationConfig config;
+  config.compact_free_threshold = 0.0f;  // Always consider space plentiful
+  BlockMigrator migrator(pager_, config);
+
+  EXPECT_EQ(migrator.run_once(), 2);
+  for (int block_id : pager_->get_sequence(1)->page_table()) {
+    EXPECT_EQ(pager_->get_block(block_id)->location, 0);
+  }
+}
+
+// Test compaction leaves swapped-out sequences on the CPU; their
+// demotion was deliberate
+TEST_F(BlockMigratorTest, CompactionSkipsSwappedOutSequences) {
+  make_sequence(1, 8);
+  ASSERT_TRUE(pager_->swap_out_sequence(1));
+
+  MigrationConfig config;
+  config.compact_free_threshold = 0.0f;
+  BlockMigrator migrator(pager_, config);
+
+  EXPECT_EQ(migrator.run_once(), 0);
+  for (int block_id : pager_->get_sequence(1)->page_table()) {
+    EXPECT_EQ(pager_->get_block(block_id)->location, 1);
+  }
+}
+
+// Test sequence-level swap-out demotes exclusively-owned blocks
+TEST_F(BlockMigratorTest, SwapOutSequenceDemotesExclusiveBlocks) {
+  make_sequence(1, 8);  // 2 blocks
+
+  ASSERT_TRUE(pager_->swap_out_sequence(1));
+
+  for (int block_id : pager_->get_sequence(1)->page_table()) {
+    EXPECT_EQ(pager_->get_block(block_id)->location, 1);
+  }
+  EXPECT_TRUE(pager_->get_sequence(1)->is_swapped_out());
+  EXPECT_EQ(pager_->get_stats().num_swapped_sequences, 1);
+}
+
+// Test swap-out leaves blocks shared with a fork on the GPU
+TEST_F(BlockMigratorTest, SwapOutKeepsSharedBlocksResident) {
+  make_sequence(1, 8);
+  ASSERT_TRUE(pager_->fork_sequence(1, 2));
+
+  ASSERT_TRUE(pager_->swap_out_sequence(1));
+
+  // The fork still decodes against these blocks, so they stay on GPU
+  for (int block_id : pager_->get_sequence(1)->page_table()) {
+    EXPECT_EQ(pager_->get_block(block_id)->location, 0);
+  }
+  EXPECT_TRUE(pager_->get_sequence(1)->is_swapped_out());
+}
+
+// Test swap-in promotes blocks back and clears the swapped flag
+TEST_F(BlockMigratorTest, SwapInSequencePromotesBlocks) {
+  make_sequence(1, 8);
+  ASSERT_TRUE(pager_->swap_out_sequence(1));
+
+  ASSERT_TRUE(pager_->swap_in_sequence(1));
+
+  for (int block_id : pager_->get_sequence(1)->page_table()) {
+    EXPECT_EQ(pager_->get_block(block_id)->location, 0);
+  }
+  EXPECT_FALSE(pager_->get_sequence(1)->is_swapped_out());
+  EXPECT_EQ(pager_->get_stats().num_swapped_sequences, 0);
+}
+
+}  // namespace
@@ -0,0 +1,112 @@
+/**
+ * @file bpe_tokenizer_test.cpp
+ * @brief Unit tests for the byte-level BPE tokenizer
+ */
+
+#include "runtime/tokenizer/bpe_tokenizer.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+using namespace mlxr::runtime;
+
+class BPETokenizerTest : public ::testing::Test {
+ protected:
+  // Byte-complete vocabulary plus the merge products used by the tests.
+  // Token strings are in the byte-to-unicode space (space = "Ġ")
+  std::vector<std::string> build_vocab(
+      const std::vector<std::string>& extras = {}) {
+    auto vocab = BPETokenizer::byte_level_alphabet();
+    vocab.insert(vocab.end(), extras.begin(), extras.end());
+    return vocab;
+  }
+};
+
+TEST_F(BPETokenizerTest, ByteLevelAlphabetCoversAllBytes) {
+  auto alphabet = BPETokenizer::byte_level_alphabet();
+  ASSERT_EQ(alphabet.size(), 256u);
+
+  // Every entry is distinct valid UTF-8 (1 or 2 bytes)
+  for (const auto& token : alphabet) {
+    EXPECT_GE(token.size(), 1u);
+    EXPECT_LE(token.size(), 2u);
+  }
+  EXPECT_EQ(alphabet[' '], "\xC4\xA0");  // 'Ġ'
+}
+
+TEST_F(BPETokenizerTest, RejectsEmptyVocabulary) {
+  EXPECT_THROW(BPETokenizer({}, {}, -1, -1), std::runtime_error);
+}
+
+TEST_F(BPETokenizerTest, EncodeAppliesMergesInRankOrder) {
+  auto vocab = build_vocab({"he", "ll", "hell", "hello"});
+  BPETokenizer tok(vocab, {"h e", "l l", "he ll", "hell o"}, -1, -1);
+
+  auto ids = tok.encode("hello");
+  ASSERT_EQ(ids.size(), 1u);
+  EXPECT_EQ(ids[0], tok.token_to_id("hello"));
+  EXPECT_EQ(tok.decode(ids), "hello");
+}
+
+TEST_F(BPETokenizerTest, UnmergedTextFallsBackToByteTokens) {
+  BPETokenizer tok(build_vocab(), {}, -1, -1);
+
+  auto ids = tok.encode("ab");
+  ASSERT_EQ(ids.size(), 2u);
+  EXPECT_EQ(ids[0], tok.token_to_id("a"));
+  EXPECT_EQ(ids[1], tok.token_to_id("b"));
+}
+
+TEST_F(BPETokenizerTest, RoundTripPreservesBytes) {
+  BPETokenizer tok(build_vocab(), {}, -1, -1);
+
+  // Spaces, punctuation, digits, newlines and multi-byte UTF-8 must all
+  // survive the byte-to-unicode round trip exactly
+  std::string text = "We said: \"caf\xC3\xA9 costs 12.50!\"\n\tdon't panic";
+  EXPECT_EQ(tok.decode(tok.encode(text)), text);
+}
+
+TEST_F(BPETokenizerTest, MergesDoNotCrossPreSplitBoundaries) {
+  // "o" + "Ġ" would merge across the word/space boundary if the
+  // pre-splitter failed to separate the pieces first
+  auto vocab = build_vocab({"o\xC4\xA0"});
+  BPETokenizer tok(vocab, {"o \xC4\xA0"}, -1, -1);
+
+  auto ids = tok.encode("go west");
+  int forbidden = tok.token_to_id("o\xC4\xA0");
+  for (int id : ids) {
+    EXPECT_NE(id, forbidden);
+  }
+  EXPECT_EQ(tok.decode(ids), "go west");
+}
+
+TEST_F(BPETokenizerTest, SpecialTokensMatchVerbatim) {
+  auto vocab = build_vocab({"<|endoftext|>"});
+  int special_id = 256;
+  BPETokenizer tok(vocab, {}, -1, special_id, {special_id});
+
+  auto ids = tok.encode("hi<|endoftext|>yo");
+  int hits = 0;
+  for (int id : ids) {
+    if (id == special_id) {
+      ++hits;
+    }
+  }
+  EXPECT_EQ(hits, 1);
+  EXPECT_EQ(tok.decode(ids), "hi<|endoftext|>yo");
+  EXPECT_EQ(tok.eos_token_id(), special_id);
+}
+
+TEST_F(BPETokenizerTest, TokenIdLookupsAreConsistent) {
+  auto vocab = build_vocab({"he"});
+  BPETokenizer tok(vocab, {"h e"}, 1, 2);
+
+  EXPECT_EQ(tok.vocab_size(), vocab.size());
+  EXPECT_EQ(tok.bos_token_id(), 1);
+  EXPECT_EQ(tok.eos_token_id(), 2);
+  EXPECT_EQ(tok.pad_token_id(), -1);
+  EXPECT_EQ(tok.id_to_token(tok.token_to_id("he")), "he");
+  EXPECT_EQ(tok.token_to_id("definitely_not_a_token"), -1);
+  EXPECT_EQ(tok.id_to_token(-1), "");
+}
@@ -0,0 +1,144 @@
+// Copyright © 2025 MLXR Development
+// Embedding microbatching unit tests
+
+#include "server/embedding_batcher.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace mlxr::server;
+
+namespace {
+
+// Compute function echoing each input's tokens as floats, so tests can
+// verify every request got its own row back
+std::vector<std::vector<float>> echo_compute(
+    const std::vector<std::vector<int>>& batch) {
+  std::vector<std::vector<float>> rows;
+  rows.reserve(batch.size());
+  for (const auto& tokens : batch) {
+    std::vector<float> row;
+    row.reserve(tokens.size());
+    for (int t : tokens) {
+      row.push_back(static_cast<float>(t));
+    }
+    rows.push_back(std::move(row));
+  }
+  return rows;
+}
+
+// Test a lone request completes and runs exactly one batch
+TEST(EmbeddingBatcherTest, SingleRequestCompletes) {
+  EmbeddingBatcherConfig config;
+  config.window_ms = 1;
+  EmbeddingBatcher batcher(echo_compute, config);
+
+  auto row = batcher.embed({1, 2, 3});
+  ASSERT_EQ(row.size(), 3u);
+  EXPECT_FLOAT_EQ(row[0], 1.0f);
+  EXPECT_FLOAT_EQ(row[2], 3.0f);
+
+  auto stats = batcher.get_stats();
+  EXPECT_EQ(stats.requests, 1u);
+  EXPECT_EQ(stats.batches, 1u);
+}
+
+// Test concurrent requests coalesce into fewer forwards than requests
+// and every thread gets the row for ITS input
+TEST(EmbeddingBatcherTest, CoalescesConcurrentRequests) {
+  EmbeddingBatcherConfig config;
+  config.window_ms = 200;  // Generous window so all threads join one batch
+  EmbeddingBatcher batcher(echo_compute, config);
+
+  constexpr int kThreads = 8;
+  std::vector<std::thread> threads;
+  std::vector<std::vector<float>> results(kThreads);
+
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i] { results[i] = batcher.embed({i, i + 100}); });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (int i = 0; i < kThreads; ++i) {
+    ASSERT_EQ(results[i].size(), 2u);
+    EXPECT_FLOAT_EQ(results[i][0], static_cast<float>(i));
+    EXPECT_FLOAT_EQ(results[i][1], static_cast<float>(i + 100));
+  }
+
+  auto stats = batcher.get_stats();
+  EXPECT_EQ(stats.requests, static_cast<uint64_t>(kThreads));
+  EXPECT_LT(stats.batches, static_cast<uint64_t>(kThreads));
+  EXPECT_GT(stats.largest_batch, 1u);
+}
+
+// Test a full batch flushes without waiting out the window
+TEST(EmbeddingBatcherTest, FullBatchFlushesEarly) {
+  EmbeddingBatcherConfig config;
+  config.window_ms = 10000;  // Would stall the test if the cap didn't flush
+  config.max_batch_size = 2;
+  EmbeddingBatcher batcher(echo_compute, config);
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::thread other([&] { batcher.embed({7}); });
+  auto row = batcher.embed({9});
+  other.join();
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  ASSERT_EQ(row.size(), 1u);
+  EXPECT_LT(elapsed, 5000);
+}
+
+// Test a compute failure propagates to every request in the batch
+TEST(EmbeddingBatcherTest, ComputeErrorPropagatesToAllWaiters) {
+  EmbeddingBatcherConfig config;
+  config.window_ms = 100;
+  EmbeddingBatcher batcher(
+      [](const std::vector<std::vector<int>>&)
+          -> std::vector<std::vector<float>> {
+        throw std::runtime_error("forward failed");
+      },
+      config);
+
+  std::atomic<int> failures{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&, i] {
+      try {
+        batcher.embed({i});
+      } catch (const std::runtime_error&) {
+        failures++;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(failures.load(), 4);
+}
+
+// Test a row-count mismatch from the compute function fails the batch
+TEST(EmbeddingBatcherTest, RowCountMismatchFailsBatch) {
+  EmbeddingBatcherConfig config;
+  config.window_ms = 0;
+  EmbeddingBatcher batcher(
+      [](const std::vector<std::vector<int>>&) {
+        return std::vector<std::vector<float>>();  // Wrong row count
+      },
+      config);
+
+  EXPECT_THROW(batcher.embed({1}), std::runtime_error);
+}
+
+}  // namespace
@@ -0,0 +1,259 @@
+/**
+ * @file grammar_test.cpp
+ * @brief Unit tests for grammar-constrained decoding
+ *
+ * Exercises the JSON automaton and token-mask machinery against a tiny
+ * mock tokenizer, so the tests need no SentencePiece model on disk.
+ * Covers acceptance of well-formed JSON, the allowed-token mask at
+ * representative states, EOS gating on completion, multi-pop tokens
+ * resolved against the real stack, and number termination rules.
+ */
+
+#include "runtime/grammar.h"
+
+#include <gtest/gtest.h>
+#include <mlx/mlx.h>
+
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "runtime/tokenizer/tokenizer.h"
+
+using namespace mlxr;
+using namespace mlxr::runtime;
+
+namespace {
+
+/**
+ * @brief Minimal in-memory tokenizer with a hand-picked vocabulary
+ *
+ * Pieces use SentencePiece conventions ("▁" word marker, "<0xXX>"
+ * byte fallback) so the grammar's piece decoding is exercised too.
+ */
+class MockTokenizer : public Tokenizer {
+ public:
+  MockTokenizer() {
+    pieces_ = {
+        "<unk>",   // 0
+        "<s>",     // 1 (BOS)
+        "</s>",    // 2 (EOS)
+        "{",       // 3
+        "}",       // 4
+        "[",       // 5
+        "]",       // 6
+        ":",       // 7
+        ",",       // 8
+        "\"",      // 9
+        "\xE2\x96\x81",  // 10: "▁" -> single space
+        "0",       // 11
+        "1",       // 12
+        "a",       // 13
+        "b",       // 14
+        "-",       // 15
+        "true",    // 16
+        "false",   // 17
+        "null",    // 18
+        "}}",      // 19: pops two levels
+        "\":",     // 20: closes a key and adds the colon
+        "<0x0A>",  // 21: newline via byte fallback
+    };
+  }
+
+  std::vector<int> encode(const std::string&) override { return {}; }
+
+  std::string decode(const std::vector<int>& ids) override {
+    std::string out;
+    for (int id : ids) {
+      out += pieces_[id];
+    }
+    return out;
+  }
+
+  size_t vocab_size() const override { return pieces_.size(); }
+  int bos_token_id() const override { return 1; }
+  int eos_token_id() const override { return 2; }
+  int pad_token_id() const override { return -1; }
+
+  std::string id_to_token(int id) const override { return pieces_[id]; }
+
+  int token_to_id(const std::string& token) const override {
+    for (size_t i = 0; i < pieces_.size(); i++) {
+      if (pieces_[i] == token) return static_cast<int>(i);
+    }
+    return -1;
+  }
+
+ private:
+  std::vector<std::string> pieces_;
+};
+
+}  // namespace
+
+class GrammarTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    constraint_ = GrammarConstraint::create("json", &tokenizer_);
+    ASSERT_NE(constraint_, nullptr);
+  }
+
+  // Feed a sequence of tokens (by piece text) and require acceptance
+  void accept_all(const std::vector<std::string>& pieces) {
+    for (const auto& piece : pieces) {
+      int id = tokenizer_.token_to_id(piece);
+      ASSERT_GE(id, 0) << "unknown piece: " << piece;
+      ASSERT_TRUE(constraint_->accept_token(id)) << "rejected: " << piece;
+    }
+  }
+
+  // Mask a zero logits row and report which pieces survive
+  std::vector<uint8_t> current_mask() {
+    int vocab = static_cast<int>(tokenizer_.vocab_size());
+    std::vector<float> zeros(vocab, 0.0f);
+    auto arr = mlx::core::array(zeros.begin(), {vocab}, mlx::core::float32);
+    auto masked = constraint_->mask_logits(graph::Tensor(arr));
+
+    auto masked_arr = masked.array();
+    mlx::core::eval(masked_arr);
+    const float* data = masked_arr.data<float>();
+    std::vector<uint8_t> allowed(vocab);
+    for (int i = 0; i < vocab; i++) {
+      allowed[i] = std::isinf(data[i]) ? 0 : 1;
+    }
+    return allowed;
+  }
+
+  bool piece_allowed(const std::vector<uint8_t>& mask,
+                     const std::string& piece) {
+    return mask[tokenizer_.token_to_id(piece)] != 0;
+  }
+
+  MockTokenizer tokenizer_;
+  std::shared_ptr<GrammarConstraint> constraint_;
+};
+
+TEST_F(GrammarTest, UnknownGrammarReturnsNull) {
+  EXPECT_EQ(GrammarConstraint::create("gbnf", &tokenizer_), nullptr);
+  EXPECT_EQ(GrammarConstraint::create("json", nullptr), nullptr);
+}
+
+TEST_F(GrammarTest, AcceptsWellFormedObject) {
+  // {"a": 1}
+  accept_all({"{", "\"", "a", "\":", "\xE2\x96\x81", "1", "}"});
+  EXPECT_TRUE(constraint_->is_complete());
+}
+
+TEST_F(GrammarTest, AcceptsNestedStructures) {
+  // {"a": [1, true], "b": null}
+  accept_all({"{", "\"", "a", "\":", "[", "1", ",", "\xE2\x96\x81", "true",
+              "]", ",", "\"", "b", "\":", "null", "}"});
+  EXPECT_TRUE(constraint_->is_complete());
+}
+
+TEST_F(GrammarTest, StartMaskAllowsValueStartsOnly) {
+  auto mask = current_mask();
+
+  EXPECT_TRUE(piece_allowed(mask, "{"));
+  EXPECT_TRUE(piece_allowed(mask, "["));
+  EXPECT_TRUE(piece_allowed(mask, "\""));
+  EXPECT_TRUE(piece_allowed(mask, "1"));
+  EXPECT_TRUE(piece_allowed(mask, "-"));
+  EXPECT_TRUE(piece_allowed(mask, "true"));
+  EXPECT_TRUE(piece_allowed(mask, "null"));
+  EXPECT_TRUE(piece_allowed(mask, "\xE2\x96\x81"));  // Leading ws
+  EXPECT_TRUE(piece_allowed(mask, "<0x0A>"));        // Newline is ws too
+
+  EXPECT_FALSE(piece_allowed(mask, "}"));
+  EXPECT_FALSE(piece_allowed(mask, "]"));
+  EXPECT_FALSE(piece_allowed(mask, ":"));
+  EXPECT_FALSE(piece_allowed(mask, ","));
+  EXPECT_FALSE(piece_allowed(mask, "a"));  // Bare letter is no value start
+  EXPECT_FALSE(mask[tokenizer_.eos_token_id()]);
+  EXPECT_FALSE(mask[tokenizer_.bos_token_id()]);  // Specials stay masked
+}
+
+TEST_F(GrammarTest, EosAllowedOnlyWhenComplete) {
+  accept_all({"{"});
+  auto mask = current_mask();
+  EXPECT_FALSE(mask[tokenizer_.eos_token_id()]);
+
+  accept_all({"}"});
+  EXPECT_TRUE(constraint_->is_complete());
+  mask = current_mask();
+  EXPECT_TRUE(mask[tokenizer_.eos_token_id()]);
+  EXPECT_TRUE(piece_allowed(mask, "\xE2\x96\x81"));  // Trailing ws
+  EXPECT_FALSE(piece_allowed(mask, "{"));            // Second value
+  EXPECT_FALSE(piece_allowed(mask, ","));
+
+  EXPECT_TRUE(constraint_->accept_token(tokenizer_.eos_token_id()));
+}
+
+TEST_F(GrammarTest, MultiPopTokenResolvedAgainstRealStack) {
+  // {"a": {"b": 1  -> "}}" closes both objects; "}" alone also legal
+  accept_all({"{", "\"", "a", "\":", "{", "\"", "b", "\":", "1"});
+
+  auto mask = current_mask();
+  EXPECT_TRUE(piece_allowed(mask, "}"));
+  EXPECT_TRUE(piece_allowed(mask, "}}"));
+
+  accept_all({"}}"});
+  EXPECT_TRUE(constraint_->is_complete());
+}
+
+TEST_F(GrammarTest, MultiPopTokenMaskedAtSingleDepth) {
+  // {"a": 1 -> one enclosing object, so "}}" would pop past the root
+  accept_all({"{", "\"", "a", "\":", "1"});
+
+  auto mask = current_mask();
+  EXPECT_TRUE(piece_allowed(mask, "}"));
+  EXPECT_FALSE(piece_allowed(mask, "}}"));
+}
+
+TEST_F(GrammarTest, NumberTerminationRules) {
+  // A number ends implicitly at a structural byte: "1," inside an array
+  accept_all({"[", "1", ",", "\xE2\x96\x81", "1", "]"});
+  EXPECT_TRUE(constraint_->is_complete());
+}
+
+TEST_F(GrammarTest, LeadingZeroRejected) {
+  accept_all({"0"});
+  // "01" is not a valid JSON number
+  EXPECT_FALSE(constraint_->accept_token(tokenizer_.token_to_id("1")));
+}
+
+TEST_F(GrammarTest, InvalidTokensRejected) {
+  EXPECT_FALSE(constraint_->accept_token(tokenizer_.token_to_id("}")));
+  EXPECT_FALSE(constraint_->accept_token(tokenizer_.token_to_id(",")));
+  // EOS before any value is rejected
+  EXPECT_FALSE(constraint_->accept_token(tokenizer_.eos_token_id()));
+}
+
+TEST_F(GrammarTest, MaskPreservesAllowedLogitValues) {
+  int vocab = static_cast<int>(tokenizer_.vocab_size());
+  std::vector<float> values(vocab);
+  for (int i = 0; i < vocab; i++) {
+    values[i] = static_cast<float>(i) * 0.5f;
+  }
+  auto arr = mlx::core::array(values.begin(), {vocab}, mlx::core::float32);
+  auto masked = constraint_->mask_logits(graph::Tensor(arr));
+
+  auto masked_arr = masked.array();
+  mlx::core::eval(masked_arr);
+  const float* data = masked_arr.data<float>();
+
+  int open_brace = tokenizer_.token_to_id("{");
+  EXPECT_FLOAT_EQ(data[open_brace], open_brace * 0.5f);
+  EXPECT_TRUE(std::isinf(data[tokenizer_.token_to_id(",")]));
+}
+
+TEST_F(GrammarTest, ConstraintsAreIndependentButShareCompilation) {
+  auto other = GrammarConstraint::create("json", &tokenizer_);
+  ASSERT_NE(other, nullptr);
+
+  // Advance one constraint; the other must still be at the start state
+  accept_all({"{", "}"});
+  EXPECT_TRUE(constraint_->is_complete());
+  EXPECT_FALSE(other->is_complete());
+  EXPECT_TRUE(other->accept_token(tokenizer_.token_to_id("[")));
+}
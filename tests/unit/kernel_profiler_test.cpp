@@ -0,0 +1,99 @@
+// Copyright © 2025 MLXR Development
+// Unit tests for the per-kernel timing aggregator (profiling mode)
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "kernels/kernel_profiler.h"
+
+using namespace mlxr::kernels;
+
+class KernelProfilerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    KernelProfiler::instance().reset();
+    KernelProfiler::instance().set_enabled(false);
+  }
+
+  void TearDown() override {
+    KernelProfiler::instance().reset();
+    KernelProfiler::instance().set_enabled(false);
+  }
+};
+
+TEST_F(KernelProfilerTest, DisabledByDefault) {
+  EXPECT_FALSE(KernelProfiler::instance().enabled());
+  EXPECT_TRUE(KernelProfiler::instance().snapshot().empty());
+}
+
+TEST_F(KernelProfilerTest, EnableDisableToggle) {
+  KernelProfiler::instance().set_enabled(true);
+  EXPECT_TRUE(KernelProfiler::instance().enabled());
+
+  KernelProfiler::instance().set_enabled(false);
+  EXPECT_FALSE(KernelProfiler::instance().enabled());
+}
+
+TEST_F(KernelProfilerTest, RecordAggregatesPerKernel) {
+  auto& profiler = KernelProfiler::instance();
+  profiler.record("rmsnorm_fused", 0.5);
+  profiler.record("rmsnorm_fused", 1.5);
+  profiler.record("rmsnorm_fused", 1.0);
+
+  auto stats = profiler.snapshot();
+  ASSERT_EQ(stats.size(), 1u);
+  EXPECT_EQ(stats[0].kernel, "rmsnorm_fused");
+  EXPECT_EQ(stats[0].samples, 3);
+  EXPECT_DOUBLE_EQ(stats[0].total_ms, 3.0);
+  EXPECT_DOUBLE_EQ(stats[0].min_ms, 0.5);
+  EXPECT_DOUBLE_EQ(stats[0].max_ms, 1.5);
+  EXPECT_DOUBLE_EQ(stats[0].last_ms, 1.0);
+}
+
+TEST_F(KernelProfilerTest, SnapshotSortedByKernelName) {
+  auto& profiler = KernelProfiler::instance();
+  profiler.record("swiglu_mlp_fused", 1.0);
+  profiler.record("attention_decode_fused", 2.0);
+  profiler.record("q_gemm_dequant", 3.0);
+
+  auto stats = profiler.snapshot();
+  ASSERT_EQ(stats.size(), 3u);
+  EXPECT_EQ(stats[0].kernel, "attention_decode_fused");
+  EXPECT_EQ(stats[1].kernel, "q_gemm_dequant");
+  EXPECT_EQ(stats[2].kernel, "swiglu_mlp_fused");
+}
+
+TEST_F(KernelProfilerTest, ResetClearsStats) {
+  auto& profiler = KernelProfiler::instance();
+  profiler.record("attention_decode_fused", 1.0);
+  ASSERT_EQ(profiler.snapshot().size(), 1u);
+
+  profiler.reset();
+  EXPECT_TRUE(profiler.snapshot().empty());
+}
+
+TEST_F(KernelProfilerTest, ConcurrentRecording) {
+  auto& profiler = KernelProfiler::instance();
+
+  const int num_threads = 8;
+  const int records_per_thread = 1000;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&profiler]() {
+      for (int j = 0; j < records_per_thread; ++j) {
+        profiler.record("attention_decode_fused", 1.0);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  auto stats = profiler.snapshot();
+  ASSERT_EQ(stats.size(), 1u);
+  EXPECT_EQ(stats[0].samples, num_threads * records_per_thread);
+  EXPECT_DOUBLE_EQ(stats[0].total_ms, num_threads * records_per_thread * 1.0);
+}
@@ -0,0 +1,155 @@
+// Copyright © 2025 MLXR Development
+// KV block compression unit tests
+
+#include "runtime/kv/compression.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "runtime/kv/arena.h"
+
+using namespace mlxr;
+using namespace mlxr::runtime::kv;
+
+namespace {
+
+std::vector<uint8_t> round_trip(const std::vector<uint8_t>& src) {
+  auto compressed = compress_kv_payload(src.data(), src.size());
+  std::vector<uint8_t> out(src.size());
+  EXPECT_TRUE(decompress_kv_payload(compressed, out.data(), out.size()));
+  return out;
+}
+
+// Zero-filled payloads (fresh blocks) should compress dramatically
+TEST(KVCompressionTest, ZerosCompressAndRoundTrip) {
+  std::vector<uint8_t> src(4096, 0);
+  auto compressed = compress_kv_payload(src.data(), src.size());
+
+  EXPECT_LT(compressed.size(), src.size() / 10);
+  EXPECT_EQ(round_trip(src), src);
+}
+
+// FP16-like data: high bytes near-constant, low bytes noisy. Byte-plane
+// splitting should still find compressible structure
+TEST(KVCompressionTest, Fp16LikeDataRoundTrips) {
+  std::mt19937 rng(42);
+  std::vector<uint8_t> src(8192);
+  for (size_t i = 0; i < src.size(); i += 2) {
+    src[i] = static_cast<uint8_t>(rng() & 0xFF);  // mantissa byte
+    src[i + 1] = 0x3C + static_cast<uint8_t>(rng() % 4);  // exp/sign byte
+  }
+
+  auto compressed = compress_kv_payload(src.data(), src.size());
+  EXPECT_LT(compressed.size(), src.size());
+  EXPECT_EQ(round_trip(src), src);
+}
+
+// Pure random input is incompressible; the raw fallback caps the
+// overhead at one byte
+TEST(KVCompressionTest, IncompressibleInputStoredRaw) {
+  std::mt19937 rng(7);
+  std::vector<uint8_t> src(4096);
+  for (auto& b : src) {
+    b = static_cast<uint8_t>(rng() & 0xFF);
+  }
+
+  auto compressed = compress_kv_payload(src.data(), src.size());
+  EXPECT_LE(compressed.size(), src.size() + 1);
+  EXPECT_EQ(round_trip(src), src);
+}
+
+// Small and odd-sized payloads exercise the single-stream path and the
+// encoder's tail-literal handling
+TEST(KVCompressionTest, TinyAndOddSizesRoundTrip) {
+  for (size_t size = 1; size <= 20; ++size) {
+    std::vector<uint8_t> src(size);
+    for (size_t i = 0; i < size; ++i) {
+      src[i] = static_cast<uint8_t>(i * 37);
+    }
+    EXPECT_EQ(round_trip(src), src) << "size=" << size;
+  }
+}
+
+// Long repeated runs trigger >255 match-length extensions and
+// overlapping match copies in the decoder
+TEST(KVCompressionTest, LongRunsRoundTrip) {
+  std::vector<uint8_t> src(10000);
+  for (size_t i = 0; i < src.size(); ++i) {
+    src[i] = static_cast<uint8_t>((i / 2000) * 0x11);
+  }
+  EXPECT_EQ(round_trip(src), src);
+}
+
+// Corrupt payloads must be rejected, never decoded into the buffer
+TEST(KVCompressionTest, CorruptPayloadRejected) {
+  std::vector<uint8_t> src(1024, 0);
+  auto compressed = compress_kv_payload(src.data(), src.size());
+  std::vector<uint8_t> out(src.size());
+
+  // Wrong destination size
+  EXPECT_FALSE(decompress_kv_payload(compressed, out.data(), src.size() - 1));
+
+  // Unknown mode byte
+  auto bad_mode = compressed;
+  bad_mode[0] = 0xFF;
+  EXPECT_FALSE(decompress_kv_payload(bad_mode, out.data(), out.size()));
+
+  // Truncated body
+  auto truncated = compressed;
+  truncated.resize(truncated.size() / 2);
+  EXPECT_FALSE(decompress_kv_payload(truncated, out.data(), out.size()));
+}
+
+// Arena-level round trip: demotion compresses and releases tensors,
+// promotion restores the exact payload
+TEST(KVCompressionTest, ArenaDemotePromoteRoundTrip) {
+  ArenaConfig config;
+  config.block_size_tokens = 4;
+  config.num_blocks = 4;
+  config.num_layers = 2;
+  config.num_kv_heads = 2;
+  config.head_dim = 8;
+  config.compress_cpu_blocks = true;
+
+  Arena arena(config);
+  int block_id = arena.allocate_block();
+  ASSERT_GE(block_id, 0);
+
+  // Store a recognizable payload
+  std::vector<int> shape = {config.num_layers, config.block_size_tokens,
+                            config.num_kv_heads, config.head_dim};
+  auto k = graph::Tensor(mlx::core::full(shape, 1.5f, config.dtype));
+  auto v = graph::Tensor(mlx::core::full(shape, -2.0f, config.dtype));
+  ASSERT_TRUE(arena.store_block_kv(block_id, k, v));
+
+  ASSERT_TRUE(arena.move_to_cpu(block_id));
+  Block* block = arena.get_block(block_id);
+  ASSERT_NE(block, nullptr);
+  EXPECT_TRUE(block->is_compressed);
+  EXPECT_FALSE(block->k_compressed.empty());
+
+  auto stats = arena.get_stats();
+  EXPECT_EQ(stats.compressed_cpu_blocks, 1);
+  EXPECT_GT(stats.compressed_cpu_bytes, 0u);
+
+  ASSERT_TRUE(arena.move_to_gpu(block_id));
+  EXPECT_FALSE(block->is_compressed);
+  EXPECT_TRUE(block->k_compressed.empty());
+
+  auto [k_out, v_out] = arena.load_block_kv(block_id);
+  mlx::core::eval(k_out.array());
+  mlx::core::eval(v_out.array());
+  auto k_max = mlx::core::max(mlx::core::abs(mlx::core::subtract(
+      mlx::core::astype(k_out.array(), mlx::core::float32),
+      mlx::core::astype(k.array(), mlx::core::float32))));
+  auto v_max = mlx::core::max(mlx::core::abs(mlx::core::subtract(
+      mlx::core::astype(v_out.array(), mlx::core::float32),
+      mlx::core::astype(v.array(), mlx::core::float32))));
+  EXPECT_FLOAT_EQ(k_max.item<float>(), 0.0f);
+  EXPECT_FLOAT_EQ(v_max.item<float>(), 0.0f);
+}
+
+}  // namespace
@@ -223,6 +223,26 @@ TEST_F(LayersTest, LinearBatchedInput) {
   EXPECT_TRUE(shapes_equal(output.shape(), {32, 16}));
 }
 
+TEST_F(LayersTest, LinearQuantizedState) {
+  Linear layer(128, 256, false);
+
+  // Fresh layers are dense
+  EXPECT_FALSE(layer.is_quantized());
+
+  // An unknown quantization type must be rejected rather than silently
+  // producing garbage output (invalid_argument with custom kernels,
+  // runtime_error when they are compiled out)
+  Tensor packed = mlxr::graph::zeros({1024}, mlx::core::uint8);
+  EXPECT_THROW(layer.set_quantized_weight(packed, "Q99_X"), std::exception);
+  EXPECT_FALSE(layer.is_quantized());
+
+  // Dynamic INT8 activation quantization is a separate toggle, off by
+  // default and inert without a quantized weight installed
+  EXPECT_FALSE(layer.activation_quantization());
+  layer.set_activation_quantization(true);
+  EXPECT_TRUE(layer.activation_quantization());
+}
+
 // ============================================================================
 // RotaryEmbedding Tests
 // ============================================================================
@@ -0,0 +1,140 @@
+/**
+ * @file lora_test.cpp
+ * @brief Unit tests for runtime LoRA adapter support
+ */
+
+#include "graph/lora.h"
+
+#include <gtest/gtest.h>
+
+#include "graph/layers.h"
+#include "graph/tensor.h"
+
+using namespace mlxr::graph;
+
+// ============================================================================
+// Checkpoint tensor name parsing
+// ============================================================================
+
+TEST(LoRANameParsing, PeftStyleName) {
+  int layer = -1;
+  std::string module;
+  bool is_b = true;
+  ASSERT_TRUE(LoRAAdapter::parse_tensor_name(
+      "base_model.model.model.layers.12.self_attn.q_proj.lora_A.weight",
+      layer, module, is_b));
+  EXPECT_EQ(layer, 12);
+  EXPECT_EQ(module, "q_proj");
+  EXPECT_FALSE(is_b);
+}
+
+TEST(LoRANameParsing, LoraBAndMlpModule) {
+  int layer = -1;
+  std::string module;
+  bool is_b = false;
+  ASSERT_TRUE(LoRAAdapter::parse_tensor_name(
+      "model.layers.3.mlp.gate_proj.lora_B.weight", layer, module, is_b));
+  EXPECT_EQ(layer, 3);
+  EXPECT_EQ(module, "gate_proj");
+  EXPECT_TRUE(is_b);
+}
+
+TEST(LoRANameParsing, InternalBlocksNaming) {
+  int layer = -1;
+  std::string module;
+  bool is_b = true;
+  ASSERT_TRUE(LoRAAdapter::parse_tensor_name(
+      "blocks.0.attention.v_proj.lora_A.weight", layer, module, is_b));
+  EXPECT_EQ(layer, 0);
+  EXPECT_EQ(module, "v_proj");
+  EXPECT_FALSE(is_b);
+}
+
+TEST(LoRANameParsing, RejectsNonLoraTensors) {
+  int layer = -1;
+  std::string module;
+  bool is_b = false;
+  EXPECT_FALSE(LoRAAdapter::parse_tensor_name(
+      "model.layers.0.self_attn.q_proj.weight", layer, module, is_b));
+  EXPECT_FALSE(LoRAAdapter::parse_tensor_name("model.embed_tokens.weight",
+                                              layer, module, is_b));
+}
+
+TEST(LoRANameParsing, RejectsLoraTensorsOutsideBlocks) {
+  // A classifier head adapted by PEFT has lora factors but no layer index
+  int layer = -1;
+  std::string module;
+  bool is_b = false;
+  EXPECT_FALSE(LoRAAdapter::parse_tensor_name(
+      "base_model.model.score.lora_A.weight", layer, module, is_b));
+}
+
+// ============================================================================
+// Linear binding lifecycle
+// ============================================================================
+
+TEST(LoRALinearBinding, AttachAppliesDeltaInForward) {
+  // Base weight zero, so the output is exactly scale * B(Ax)
+  Linear linear(4, 4);
+  linear.weight() = zeros({4, 4});
+
+  LoRALayerWeights delta;
+  delta.a = ones({2, 4});  // rank 2
+  delta.b = ones({4, 2});
+  delta.scale = 0.5f;
+
+  linear.attach_lora(nullptr, &delta);
+  EXPECT_EQ(linear.num_lora(), 1u);
+
+  auto out = linear.forward(ones({1, 4}));
+  out.eval();
+  // Ax = [4, 4], B(Ax) = [8, 8, 8, 8], scaled by 0.5 -> 4
+  auto expected = ones({1, 4}) * 4.0f;
+  auto diff = out - expected;
+  diff.eval();
+  EXPECT_FLOAT_EQ(mlx::core::max(mlx::core::abs(diff.array())).item<float>(),
+                  0.0f);
+}
+
+TEST(LoRALinearBinding, DetachRestoresBaseOutput) {
+  Linear linear(4, 4);
+  linear.weight() = zeros({4, 4});
+
+  LoRALayerWeights delta;
+  delta.a = ones({2, 4});
+  delta.b = ones({4, 2});
+  delta.scale = 1.0f;
+
+  linear.attach_lora(nullptr, &delta);
+  EXPECT_EQ(linear.detach_lora(nullptr), 1u);
+  EXPECT_EQ(linear.num_lora(), 0u);
+
+  auto out = linear.forward(ones({1, 4}));
+  out.eval();
+  EXPECT_FLOAT_EQ(mlx::core::max(mlx::core::abs(out.array())).item<float>(),
+                  0.0f);
+}
+
+TEST(LoRALinearBinding, AdaptersStackAdditively) {
+  Linear linear(4, 4);
+  linear.weight() = zeros({4, 4});
+
+  LoRALayerWeights first;
+  first.a = ones({1, 4});
+  first.b = ones({4, 1});
+  first.scale = 1.0f;
+
+  LoRALayerWeights second = first;
+  second.scale = 2.0f;
+
+  linear.attach_lora(nullptr, &first);
+  linear.attach_lora(nullptr, &second);
+
+  auto out = linear.forward(ones({1, 4}));
+  out.eval();
+  // Each delta contributes scale * 4; stacked: 4 + 8 = 12
+  auto diff = out - ones({1, 4}) * 12.0f;
+  diff.eval();
+  EXPECT_FLOAT_EQ(mlx::core::max(mlx::core::abs(diff.array())).item<float>(),
+                  0.0f);
+}
@@ -184,6 +184,44 @@ TEST(HistogramTest, Reset) {
   EXPECT_EQ(stats.sum, 0.0);
 }
 
+TEST(HistogramTest, UnderflowValues) {
+  Histogram histogram;
+  // Zero and negative samples land in the underflow bucket instead of
+  // being dropped
+  histogram.observe(0.0);
+  histogram.observe(-5.0);
+  histogram.observe(0.5);
+
+  auto stats = histogram.get_stats();
+  EXPECT_EQ(stats.count, 3);
+  EXPECT_DOUBLE_EQ(stats.min, -5.0);
+  EXPECT_DOUBLE_EQ(stats.max, 0.5);
+}
+
+TEST(HistogramTest, ThreadSafety) {
+  Histogram histogram;
+  const int num_threads = 8;
+  const int observes_per_thread = 1000;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&histogram, observes_per_thread]() {
+      for (int j = 0; j < observes_per_thread; j++) {
+        histogram.observe(static_cast<double>(j % 100) + 1.0);
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto stats = histogram.get_stats();
+  EXPECT_EQ(stats.count, num_threads * observes_per_thread);
+  EXPECT_DOUBLE_EQ(stats.min, 1.0);
+  EXPECT_DOUBLE_EQ(stats.max, 100.0);
+}
+
 // ==============================================================================
 // Timer Tests
 // ==============================================================================
@@ -268,6 +306,78 @@ TEST(MetricsRegistryTest, ExportPrometheus) {
   EXPECT_TRUE(prom.find("42") != std::string::npos);
 }
 
+TEST(MetricsRegistryTest, SnapshotFallsBackWithoutRenderer) {
+  auto& registry = MetricsRegistry::instance();
+
+  auto* counter = registry.register_counter("snap_fallback_counter");
+  counter->increment(7);
+
+  // No renderer started: the snapshot renders on demand
+  auto snapshot = registry.prometheus_snapshot();
+  ASSERT_NE(snapshot, nullptr);
+  EXPECT_TRUE(snapshot->find("snap_fallback_counter") != std::string::npos);
+}
+
+TEST(MetricsRegistryTest, SnapshotRendererPublishesAndRefreshes) {
+  auto& registry = MetricsRegistry::instance();
+
+  auto* counter = registry.register_counter("snap_refresh_counter");
+  counter->increment(1);
+
+  registry.start_snapshot_renderer(20);
+
+  // The initial snapshot is published synchronously by start
+  auto first = registry.prometheus_snapshot();
+  ASSERT_NE(first, nullptr);
+  EXPECT_TRUE(first->find("snap_refresh_counter") != std::string::npos);
+
+  // A later render must pick up new increments
+  counter->increment(99);
+  std::string needle = "snap_refresh_counter 100";
+  bool refreshed = false;
+  for (int i = 0; i < 100 && !refreshed; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    refreshed =
+        registry.prometheus_snapshot()->find(needle) != std::string::npos;
+  }
+  registry.stop_snapshot_renderer();
+  EXPECT_TRUE(refreshed);
+}
+
+TEST(MetricsRegistryTest, SnapshotRendererPreRenderHook) {
+  auto& registry = MetricsRegistry::instance();
+
+  auto* gauge = registry.register_gauge("snap_hook_gauge");
+  std::atomic<int> hook_runs{0};
+
+  registry.start_snapshot_renderer(10, [&] {
+    gauge->set(++hook_runs);
+  });
+
+  // The hook runs before every render, starting with the initial one
+  bool hooked = false;
+  for (int i = 0; i < 100 && !hooked; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    hooked = hook_runs.load() >= 2;
+  }
+  registry.stop_snapshot_renderer();
+  EXPECT_TRUE(hooked);
+  EXPECT_GE(hook_runs.load(), 1);
+}
+
+TEST(MetricsRegistryTest, SnapshotRendererStartStopIdempotent) {
+  auto& registry = MetricsRegistry::instance();
+
+  registry.start_snapshot_renderer(50);
+  registry.start_snapshot_renderer(50);  // No-op while running
+  registry.stop_snapshot_renderer();
+  registry.stop_snapshot_renderer();  // No-op when stopped
+
+  // Snapshot from the stopped renderer stays readable
+  auto snapshot = registry.prometheus_snapshot();
+  ASSERT_NE(snapshot, nullptr);
+}
+
 TEST(MetricsRegistryTest, ExportJSON) {
   auto& registry = MetricsRegistry::instance();
 
@@ -0,0 +1,39 @@
+// Copyright © 2025 MLXR Development
+// Model puller unit tests
+
+#include "server/model_puller.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace mlxr::server;
+
+namespace {
+
+// The hasher thread folds chunks into an incremental SHA-256; verify the
+// implementation against the FIPS 180-4 test vectors
+TEST(ModelPullerTest, Sha256KnownVectors) {
+  EXPECT_EQ(
+      ModelPuller::compute_sha256_hex(""),
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+
+  EXPECT_EQ(
+      ModelPuller::compute_sha256_hex("abc"),
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+  EXPECT_EQ(
+      ModelPuller::compute_sha256_hex(
+          "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+}
+
+// Multi-block input (crosses the 64-byte block boundary several times)
+TEST(ModelPullerTest, Sha256LongInput) {
+  std::string input(1000000, 'a');
+  EXPECT_EQ(
+      ModelPuller::compute_sha256_hex(input),
+      "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+}  // namespace
@@ -320,4 +320,207 @@ TEST_F(ModelRegistryTest, TouchModel) {
   EXPECT_GT(touched->last_used_timestamp, initial_timestamp);
 }
 
+// The default listing is served from an in-memory snapshot between
+// writes; every write must invalidate it so polls never see stale data
+TEST_F(ModelRegistryTest, ListModelsSnapshotInvalidation) {
+  ModelInfo info;
+  info.name = "Snapshot Model A";
+  info.model_id = "snapshot-a";
+  info.architecture = ModelArchitecture::LLAMA;
+  info.file_path = "/tmp/snapshot_a.gguf";
+  info.format = ModelFormat::GGUF;
+  info.file_size = 1000000;
+
+  int64_t id_a = registry_->register_model(info);
+  ASSERT_GT(id_a, 0);
+
+  // First listing populates the snapshot; the second is served from it
+  EXPECT_EQ(registry_->list_models().size(), 1);
+  EXPECT_EQ(registry_->list_models().size(), 1);
+
+  // A new registration must show up on the next poll
+  info.name = "Snapshot Model B";
+  info.model_id = "snapshot-b";
+  info.file_path = "/tmp/snapshot_b.gguf";
+  int64_t id_b = registry_->register_model(info);
+  ASSERT_GT(id_b, 0);
+  EXPECT_EQ(registry_->list_models().size(), 2);
+
+  // Field updates are reflected, not just row counts
+  registry_->set_model_loaded(id_a, true);
+  auto models = registry_->list_models();
+  ASSERT_EQ(models.size(), 2);
+  int loaded = 0;
+  for (const auto& m : models) {
+    if (m.is_loaded) loaded++;
+  }
+  EXPECT_EQ(loaded, 1);
+
+  // Removal is reflected too
+  EXPECT_TRUE(registry_->remove_model(id_b, false));
+  EXPECT_EQ(registry_->list_models().size(), 1);
+}
+
+// Test kernel tuning persistence (autotune winners keyed by GPU)
+TEST_F(ModelRegistryTest, KernelTunings) {
+  KernelTuning tuning;
+  tuning.kernel = "attention_decode_fused";
+  tuning.shape_key = "d128_b32";
+  tuning.device = "apple-m4-max";
+  tuning.threadgroup_width = 512;
+  tuning.latency_us = 42.5;
+  EXPECT_TRUE(registry_->set_kernel_tuning(tuning));
+
+  // Retrieve and verify
+  auto retrieved = registry_->get_kernel_tuning("attention_decode_fused",
+                                                "d128_b32", "apple-m4-max");
+  ASSERT_TRUE(retrieved.has_value());
+  EXPECT_EQ(retrieved->threadgroup_width, 512);
+  EXPECT_DOUBLE_EQ(retrieved->latency_us, 42.5);
+  EXPECT_GT(retrieved->created_timestamp, 0);
+
+  // A different GPU must not see this tuning
+  auto other_gpu = registry_->get_kernel_tuning("attention_decode_fused",
+                                                "d128_b32", "apple-m2-pro");
+  EXPECT_FALSE(other_gpu.has_value());
+
+  // Upsert replaces the recorded winner
+  tuning.threadgroup_width = 256;
+  tuning.latency_us = 38.0;
+  EXPECT_TRUE(registry_->set_kernel_tuning(tuning));
+  retrieved = registry_->get_kernel_tuning("attention_decode_fused",
+                                           "d128_b32", "apple-m4-max");
+  ASSERT_TRUE(retrieved.has_value());
+  EXPECT_EQ(retrieved->threadgroup_width, 256);
+
+  // List returns all tunings for the device
+  KernelTuning swiglu;
+  swiglu.kernel = "swiglu_mlp_fused";
+  swiglu.shape_key = "h4096_i11008";
+  swiglu.device = "apple-m4-max";
+  swiglu.threadgroup_width = 128;
+  swiglu.latency_us = 15.0;
+  EXPECT_TRUE(registry_->set_kernel_tuning(swiglu));
+
+  auto tunings = registry_->list_kernel_tunings("apple-m4-max");
+  EXPECT_EQ(tunings.size(), 2);
+}
+
+// Test deterministic-response cache (byte-identical replay + LRU)
+TEST_F(ModelRegistryTest, CacheEntries) {
+  const std::string body = "{\"id\":\"chatcmpl-1\",\"choices\":[]}";
+
+  // Miss before insert
+  EXPECT_FALSE(registry_->get_cache_entry("llama-7b", "abc123").has_value());
+
+  EXPECT_TRUE(registry_->put_cache_entry("llama-7b", "abc123", body, 0));
+
+  // Hit returns the stored bytes exactly
+  auto cached = registry_->get_cache_entry("llama-7b", "abc123");
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(*cached, body);
+
+  // Keyed by model too: same hash under another model misses
+  EXPECT_FALSE(registry_->get_cache_entry("mistral-7b", "abc123").has_value());
+
+  // Upsert replaces the stored body
+  EXPECT_TRUE(registry_->put_cache_entry("llama-7b", "abc123", "{}", 0));
+  cached = registry_->get_cache_entry("llama-7b", "abc123");
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(*cached, "{}");
+}
+
+TEST_F(ModelRegistryTest, EmbeddingCache) {
+  const std::vector<float> vec = {0.5f, -0.25f, 0.125f, 1.0f};
+
+  // Miss before insert
+  EXPECT_FALSE(registry_->get_embedding("embed-model", "hash1").has_value());
+
+  EXPECT_TRUE(registry_->put_embedding("embed-model", "hash1", vec, 0));
+
+  // Hit returns the exact stored floats
+  auto cached = registry_->get_embedding("embed-model", "hash1");
+  ASSERT_TRUE(cached.has_value());
+  ASSERT_EQ(cached->size(), vec.size());
+  for (size_t i = 0; i < vec.size(); ++i) {
+    EXPECT_FLOAT_EQ((*cached)[i], vec[i]);
+  }
+
+  // Keyed by model too: same hash under another model misses
+  EXPECT_FALSE(registry_->get_embedding("other-model", "hash1").has_value());
+
+  // Upsert replaces the stored vector
+  const std::vector<float> vec2 = {9.0f};
+  EXPECT_TRUE(registry_->put_embedding("embed-model", "hash1", vec2, 0));
+  cached = registry_->get_embedding("embed-model", "hash1");
+  ASSERT_TRUE(cached.has_value());
+  ASSERT_EQ(cached->size(), 1u);
+  EXPECT_FLOAT_EQ((*cached)[0], 9.0f);
+}
+
+TEST_F(ModelRegistryTest, EmbeddingCacheLruEviction) {
+  const std::vector<float> vec = {1.0f, 2.0f};
+
+  EXPECT_TRUE(registry_->put_embedding("embed-model", "old", vec, 2));
+
+  // Wait so the next entries get a later last_access (second precision)
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+
+  EXPECT_TRUE(registry_->put_embedding("embed-model", "new1", vec, 2));
+  EXPECT_TRUE(registry_->put_embedding("embed-model", "new2", vec, 2));
+
+  // The least recently accessed entry is gone; the newer two survive
+  EXPECT_FALSE(registry_->get_embedding("embed-model", "old").has_value());
+  EXPECT_TRUE(registry_->get_embedding("embed-model", "new1").has_value());
+  EXPECT_TRUE(registry_->get_embedding("embed-model", "new2").has_value());
+}
+
+TEST_F(ModelRegistryTest, CacheEntriesLruEviction) {
+  EXPECT_TRUE(registry_->put_cache_entry("llama-7b", "old", "{\"a\":1}", 2));
+
+  // Wait so the next entries get a later last_access (second precision)
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+
+  EXPECT_TRUE(registry_->put_cache_entry("llama-7b", "new1", "{\"b\":2}", 2));
+  EXPECT_TRUE(registry_->put_cache_entry("llama-7b", "new2", "{\"c\":3}", 2));
+
+  // The least recently accessed entry is gone; the newer two survive
+  EXPECT_FALSE(registry_->get_cache_entry("llama-7b", "old").has_value());
+  EXPECT_TRUE(registry_->get_cache_entry("llama-7b", "new1").has_value());
+  EXPECT_TRUE(registry_->get_cache_entry("llama-7b", "new2").has_value());
+}
+
+// Partial pull progress round-trips through the registry so interrupted
+// model downloads can resume from their chunk bitmap
+TEST_F(ModelRegistryTest, PullStateRoundTrip) {
+  const std::string url = "https://example.com/models/test.gguf";
+
+  // No state recorded yet
+  EXPECT_FALSE(registry_->get_pull_state(url).has_value());
+
+  PullState state;
+  state.total_size = 100 * 1024 * 1024;
+  state.chunk_size = 32 * 1024 * 1024;
+  state.bitmap = {0x05, 0x00};  // Chunks 0 and 2 complete
+
+  EXPECT_TRUE(registry_->save_pull_state(url, state));
+
+  auto loaded = registry_->get_pull_state(url);
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(loaded->total_size, state.total_size);
+  EXPECT_EQ(loaded->chunk_size, state.chunk_size);
+  EXPECT_EQ(loaded->bitmap, state.bitmap);
+
+  // Upsert replaces the bitmap as more chunks land
+  state.bitmap = {0x07, 0x00};
+  EXPECT_TRUE(registry_->save_pull_state(url, state));
+  loaded = registry_->get_pull_state(url);
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(loaded->bitmap[0], 0x07);
+
+  // Cleared after the pull completes
+  EXPECT_TRUE(registry_->clear_pull_state(url));
+  EXPECT_FALSE(registry_->get_pull_state(url).has_value());
+}
+
 }  // namespace
@@ -0,0 +1,236 @@
+// Copyright © 2025 MLXR Development
+// Unit tests for the parallel model directory scanner
+
+#include "model_scanner.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "gguf_parser.h"
+#include "model_registry.h"
+
+namespace fs = std::filesystem;
+
+using namespace mlxr::registry;
+
+namespace {
+
+// Build a minimal GGUF header with llama metadata and one F16 (or
+// quantized) embedding tensor; no tensor data is written, which is the
+// point - the scanner must never need it
+std::vector<uint8_t> build_gguf(GGUFTensorType embed_type,
+                                uint64_t hidden = 64, uint64_t vocab = 1000) {
+  std::vector<uint8_t> data;
+
+  auto append = [&data](const void* ptr, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(ptr);
+    data.insert(data.end(), bytes, bytes + size);
+  };
+  auto append_string = [&append](const std::string& str) {
+    uint64_t len = str.size();
+    append(&len, sizeof(len));
+    append(str.data(), str.size());
+  };
+  auto append_u32 = [&](const std::string& key, uint32_t value) {
+    append_string(key);
+    uint32_t type = static_cast<uint32_t>(GGUFMetadataType::UINT32);
+    append(&type, sizeof(type));
+    append(&value, sizeof(value));
+  };
+
+  uint32_t magic = GGUF_MAGIC;
+  uint32_t version = GGUF_VERSION_V3;
+  uint64_t tensor_count = 1;
+  uint64_t metadata_kv_count = 6;
+  append(&magic, sizeof(magic));
+  append(&version, sizeof(version));
+  append(&tensor_count, sizeof(tensor_count));
+  append(&metadata_kv_count, sizeof(metadata_kv_count));
+
+  append_string("general.architecture");
+  uint32_t type = static_cast<uint32_t>(GGUFMetadataType::STRING);
+  append(&type, sizeof(type));
+  append_string("llama");
+
+  append_u32("llama.context_length", 2048);
+  append_u32("llama.embedding_length", static_cast<uint32_t>(hidden));
+  append_u32("llama.block_count", 4);
+  append_u32("llama.attention.head_count", 8);
+  append_u32("llama.attention.head_count_kv", 2);
+
+  // Tensor info: token_embd.weight [hidden, vocab]
+  append_string("token_embd.weight");
+  uint32_t n_dims = 2;
+  append(&n_dims, sizeof(n_dims));
+  append(&hidden, sizeof(hidden));
+  append(&vocab, sizeof(vocab));
+  uint32_t tensor_type = static_cast<uint32_t>(embed_type);
+  append(&tensor_type, sizeof(tensor_type));
+  uint64_t offset = 0;
+  append(&offset, sizeof(offset));
+
+  return data;
+}
+
+void write_file(const fs::path& path, const std::vector<uint8_t>& data) {
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+void write_text(const fs::path& path, const std::string& text) {
+  std::ofstream out(path);
+  out << text;
+}
+
+// Minimal safetensors file: length-prefixed JSON header, no tensor data
+void write_safetensors(const fs::path& path, const std::string& header_json) {
+  std::ofstream out(path, std::ios::binary);
+  uint64_t len = header_json.size();
+  out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+  out.write(header_json.data(), header_json.size());
+}
+
+class ModelScannerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    test_dir_ = fs::temp_directory_path() / "mlxr_test_scanner";
+    fs::remove_all(test_dir_);
+    fs::create_directories(test_dir_);
+
+    registry_ = std::make_shared<ModelRegistry>(":memory:");
+    ASSERT_TRUE(registry_->initialize());
+  }
+
+  void TearDown() override { fs::remove_all(test_dir_); }
+
+  fs::path test_dir_;
+  std::shared_ptr<ModelRegistry> registry_;
+};
+
+TEST_F(ModelScannerTest, ProbeGgufReadsHeaderOnly) {
+  auto path = test_dir_ / "tiny-llama.gguf";
+  write_file(path, build_gguf(GGUFTensorType::F16));
+
+  auto info = ModelScanner::probe_file(path.string());
+  ASSERT_TRUE(info.has_value());
+
+  EXPECT_EQ(info->model_id, "tiny-llama");
+  EXPECT_EQ(info->format, ModelFormat::GGUF);
+  EXPECT_EQ(info->architecture, ModelArchitecture::LLAMA);
+  EXPECT_EQ(info->context_length, 2048);
+  EXPECT_EQ(info->hidden_size, 64);
+  EXPECT_EQ(info->num_layers, 4);
+  EXPECT_EQ(info->num_heads, 8);
+  EXPECT_EQ(info->num_kv_heads, 2);
+  EXPECT_EQ(info->vocab_size, 1000);
+  EXPECT_EQ(info->param_count, 64u * 1000u);
+  EXPECT_EQ(info->quant_type, QuantizationType::NONE);
+}
+
+TEST_F(ModelScannerTest, ProbeGgufDetectsQuantization) {
+  auto path = test_dir_ / "quant.gguf";
+  write_file(path, build_gguf(GGUFTensorType::Q4_K));
+
+  auto info = ModelScanner::probe_file(path.string());
+  ASSERT_TRUE(info.has_value());
+  EXPECT_EQ(info->quant_type, QuantizationType::Q4_K);
+}
+
+TEST_F(ModelScannerTest, ProbeSafetensorsWithConfig) {
+  auto model_dir = test_dir_ / "my-hf-model";
+  fs::create_directories(model_dir);
+
+  write_safetensors(
+      model_dir / "model.safetensors",
+      R"({"model.embed_tokens.weight":{"dtype":"F16","shape":[1000,64],)"
+      R"("data_offsets":[0,128000]},"__metadata__":{"format":"pt"}})");
+  write_text(model_dir / "config.json",
+             R"({"architectures":["LlamaForCausalLM"],"hidden_size":64,)"
+             R"("num_hidden_layers":4,"num_attention_heads":8,)"
+             R"("num_key_value_heads":2,"intermediate_size":256,)"
+             R"("vocab_size":1000,"max_position_embeddings":4096,)"
+             R"("rope_theta":10000.0})");
+
+  auto info =
+      ModelScanner::probe_file((model_dir / "model.safetensors").string());
+  ASSERT_TRUE(info.has_value());
+
+  // Identifier comes from the folder, not the generic file name
+  EXPECT_EQ(info->model_id, "my-hf-model");
+  EXPECT_EQ(info->format, ModelFormat::SAFETENSORS);
+  EXPECT_EQ(info->architecture, ModelArchitecture::LLAMA);
+  EXPECT_EQ(info->hidden_size, 64);
+  EXPECT_EQ(info->num_layers, 4);
+  EXPECT_EQ(info->num_kv_heads, 2);
+  EXPECT_EQ(info->vocab_size, 1000);
+  EXPECT_EQ(info->context_length, 4096);
+  EXPECT_EQ(info->param_count, 1000u * 64u);
+}
+
+TEST_F(ModelScannerTest, ProbeRejectsUnrecognizedFiles) {
+  auto path = test_dir_ / "notes.txt";
+  write_text(path, "not a model");
+  EXPECT_FALSE(ModelScanner::probe_file(path.string()).has_value());
+}
+
+TEST_F(ModelScannerTest, ScanRegistersNewModelsInOneBatch) {
+  write_file(test_dir_ / "a.gguf", build_gguf(GGUFTensorType::F16));
+  write_file(test_dir_ / "b.gguf", build_gguf(GGUFTensorType::Q4_K));
+  write_text(test_dir_ / "readme.md", "ignored");
+
+  ModelScanner scanner(registry_);
+  auto result = scanner.scan_directory(test_dir_.string());
+
+  EXPECT_EQ(result.files_considered, 2);
+  EXPECT_EQ(result.models_registered, 2);
+  EXPECT_EQ(result.skipped_existing, 0);
+  EXPECT_EQ(result.parse_failures, 0);
+
+  EXPECT_TRUE(registry_->get_model_by_identifier("a").has_value());
+  EXPECT_TRUE(registry_->get_model_by_identifier("b").has_value());
+}
+
+TEST_F(ModelScannerTest, RescanSkipsAlreadyRegisteredPaths) {
+  write_file(test_dir_ / "a.gguf", build_gguf(GGUFTensorType::F16));
+
+  ModelScanner scanner(registry_);
+  auto first = scanner.scan_directory(test_dir_.string());
+  EXPECT_EQ(first.models_registered, 1);
+
+  auto second = scanner.scan_directory(test_dir_.string());
+  EXPECT_EQ(second.models_registered, 0);
+  EXPECT_EQ(second.skipped_existing, 1);
+}
+
+TEST_F(ModelScannerTest, MalformedFilesCountAsParseFailures) {
+  write_text(test_dir_ / "broken.gguf", "garbage");
+
+  ModelScanner scanner(registry_);
+  auto result = scanner.scan_directory(test_dir_.string());
+
+  EXPECT_EQ(result.files_considered, 1);
+  EXPECT_EQ(result.models_registered, 0);
+  EXPECT_EQ(result.parse_failures, 1);
+}
+
+TEST_F(ModelScannerTest, RecursiveScanFindsNestedModels) {
+  auto nested = test_dir_ / "library" / "chat";
+  fs::create_directories(nested);
+  write_file(nested / "nested.gguf", build_gguf(GGUFTensorType::F16));
+
+  ModelScanner scanner(registry_);
+  auto result = scanner.scan_directory(test_dir_.string());
+  EXPECT_EQ(result.models_registered, 1);
+
+  ScanOptions flat;
+  flat.recursive = false;
+  auto flat_result =
+      scanner.scan_directory(test_dir_.string(), flat);
+  EXPECT_EQ(flat_result.files_considered, 0);
+}
+
+}  // namespace
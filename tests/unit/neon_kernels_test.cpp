@@ -0,0 +1,149 @@
+// Copyright © 2025 MLXR Development
+// Vectorized CPU kernel unit tests (NEON path on arm64, scalar elsewhere)
+
+#include "kernels/cpu/neon_kernels.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace mlxr::kernels;
+
+namespace {
+
+// Deterministic pseudo-random fill, no <random> churn between runs
+void fill_values(std::vector<float>& values, uint32_t seed) {
+  uint32_t state = seed;
+  for (auto& v : values) {
+    state = state * 1664525u + 1013904223u;
+    v = static_cast<float>(static_cast<int32_t>(state >> 8) % 2000 - 1000) /
+        250.0f;
+  }
+}
+
+TEST(NeonKernelsTest, RMSNormMatchesReference) {
+  const int rows = 3;
+  const int dim = 67;  // Not a multiple of the vector width
+  const float eps = 1e-5f;
+
+  std::vector<float> input(rows * dim);
+  std::vector<float> weight(dim);
+  fill_values(input, 1);
+  fill_values(weight, 2);
+
+  std::vector<float> output(rows * dim);
+  cpu::rmsnorm(input.data(), weight.data(), output.data(), rows, dim, eps);
+
+  for (int r = 0; r < rows; r++) {
+    double sum_sq = 0.0;
+    for (int i = 0; i < dim; i++) {
+      sum_sq += input[r * dim + i] * input[r * dim + i];
+    }
+    const float inv_rms = 1.0f / std::sqrt(static_cast<float>(sum_sq / dim) + eps);
+    for (int i = 0; i < dim; i++) {
+      EXPECT_NEAR(output[r * dim + i],
+                  input[r * dim + i] * inv_rms * weight[i], 1e-3f);
+    }
+  }
+}
+
+TEST(NeonKernelsTest, RopeRotatesPairsInPlace) {
+  const int head_dim = 10;
+  std::vector<float> head(head_dim);
+  std::vector<float> cos_row(head_dim / 2);
+  std::vector<float> sin_row(head_dim / 2);
+  fill_values(head, 3);
+  for (int p = 0; p < head_dim / 2; p++) {
+    const float theta = 0.1f * static_cast<float>(p + 1);
+    cos_row[p] = std::cos(theta);
+    sin_row[p] = std::sin(theta);
+  }
+
+  std::vector<float> expected(head_dim);
+  for (int p = 0; p < head_dim / 2; p++) {
+    expected[p * 2] = head[p * 2] * cos_row[p] - head[p * 2 + 1] * sin_row[p];
+    expected[p * 2 + 1] =
+        head[p * 2 + 1] * cos_row[p] + head[p * 2] * sin_row[p];
+  }
+
+  cpu::rope_apply_head(head.data(), head.data(), cos_row.data(),
+                       sin_row.data(), head_dim, 1.0f);
+  for (int i = 0; i < head_dim; i++) {
+    EXPECT_NEAR(head[i], expected[i], 1e-5f);
+  }
+
+  // Rotation preserves pair magnitudes; scale=2 doubles them
+  std::vector<float> scaled(head_dim);
+  cpu::rope_apply_head(expected.data(), scaled.data(), cos_row.data(),
+                       sin_row.data(), head_dim, 2.0f);
+  for (int p = 0; p < head_dim / 2; p++) {
+    const float before = std::hypot(expected[p * 2], expected[p * 2 + 1]);
+    const float after = std::hypot(scaled[p * 2], scaled[p * 2 + 1]);
+    EXPECT_NEAR(after, 2.0f * before, 1e-4f);
+  }
+}
+
+TEST(NeonKernelsTest, DotAndAxpy) {
+  const int n = 37;
+  std::vector<float> a(n);
+  std::vector<float> b(n);
+  fill_values(a, 4);
+  fill_values(b, 5);
+
+  double expected = 0.0;
+  for (int i = 0; i < n; i++) {
+    expected += static_cast<double>(a[i]) * b[i];
+  }
+  EXPECT_NEAR(cpu::dot(a.data(), b.data(), n),
+              static_cast<float>(expected), 1e-2f);
+
+  std::vector<float> y(n, 1.0f);
+  cpu::axpy(0.5f, a.data(), y.data(), n);
+  for (int i = 0; i < n; i++) {
+    EXPECT_NEAR(y[i], 1.0f + 0.5f * a[i], 1e-5f);
+  }
+}
+
+TEST(NeonKernelsTest, SoftmaxIsStableAndNormalized) {
+  // Large magnitudes would overflow a naive exp
+  std::vector<float> scores = {1000.0f, 1001.0f, 999.0f, 1000.5f,
+                               998.0f,  1000.2f, 997.5f};
+  cpu::softmax(scores.data(), static_cast<int>(scores.size()));
+
+  float sum = 0.0f;
+  for (float s : scores) {
+    EXPECT_TRUE(std::isfinite(s));
+    EXPECT_GE(s, 0.0f);
+    sum += s;
+  }
+  EXPECT_NEAR(sum, 1.0f, 1e-4f);
+  // Largest logit keeps the largest weight
+  EXPECT_GT(scores[1], scores[0]);
+
+  // -inf entries (unmapped KV pages) get exactly zero weight
+  std::vector<float> masked = {0.0f, -std::numeric_limits<float>::infinity(),
+                               0.0f};
+  cpu::softmax(masked.data(), static_cast<int>(masked.size()));
+  EXPECT_FLOAT_EQ(masked[1], 0.0f);
+  EXPECT_NEAR(masked[0], 0.5f, 1e-4f);
+}
+
+TEST(NeonKernelsTest, SwiGLUMatchesReference) {
+  const int n = 129;  // Crosses the internal block boundary
+  std::vector<float> gate(n);
+  std::vector<float> up(n);
+  fill_values(gate, 6);
+  fill_values(up, 7);
+
+  std::vector<float> out(n);
+  cpu::swiglu(gate.data(), up.data(), out.data(), n);
+
+  for (int i = 0; i < n; i++) {
+    const float sig = 1.0f / (1.0f + std::exp(-gate[i]));
+    EXPECT_NEAR(out[i], gate[i] * sig * up[i], 1e-4f);
+  }
+}
+
+}  // namespace
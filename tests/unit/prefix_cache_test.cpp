@@ -0,0 +1,210 @@
+// Copyright © 2025 MLXR Development
+// Shared-prefix KV cache unit tests
+
+#include "runtime/kv/prefix_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <numeric>
+#include <thread>
+
+using namespace mlxr;
+using namespace mlxr::runtime::kv;
+
+namespace {
+
+class PrefixCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ArenaConfig arena_config;
+    arena_config.num_layers = 2;
+    arena_config.block_size_tokens = 4;
+    arena_config.num_blocks = 32;
+    arena_config.num_kv_heads = 2;
+    arena_config.head_dim = 8;
+
+    arena_ = std::make_shared<Arena>(arena_config);
+    pager_ = std::make_shared<Pager>(arena_);
+    cache_ = std::make_unique<PrefixCache>(pager_);
+  }
+
+  // Create a sequence with blocks covering the given tokens
+  int make_prefilled_sequence(int seq_id, const std::vector<int>& tokens) {
+    EXPECT_TRUE(pager_->create_sequence(seq_id));
+    EXPECT_TRUE(pager_->allocate_blocks_for_sequence(
+        seq_id, static_cast<int>(tokens.size())));
+    pager_->get_sequence(seq_id)->set_num_tokens(
+        static_cast<int>(tokens.size()));
+    return seq_id;
+  }
+
+  std::shared_ptr<Arena> arena_;
+  std::shared_ptr<Pager> pager_;
+  std::unique_ptr<PrefixCache> cache_;
+};
+
+// Test miss on empty cache
+TEST_F(PrefixCacheTest, MissOnEmptyCache) {
+  std::vector<int> tokens(12);
+  std::iota(tokens.begin(), tokens.end(), 100);
+
+  pager_->create_sequence(1);
+  EXPECT_EQ(cache_->match_and_attach(tokens, 1), 0);
+
+  auto stats = cache_->get_stats();
+  EXPECT_EQ(stats.lookups, 1u);
+  EXPECT_EQ(stats.hits, 0u);
+}
+
+// Test insert then match attaches shared blocks to a new sequence
+TEST_F(PrefixCacheTest, InsertAndMatch) {
+  // Prompt covering 3 full blocks (12 tokens, block_size=4)
+  std::vector<int> prompt(12);
+  std::iota(prompt.begin(), prompt.end(), 0);
+
+  make_prefilled_sequence(1, prompt);
+  cache_->insert(prompt, 1);
+
+  auto stats = cache_->get_stats();
+  EXPECT_EQ(stats.cached_blocks, 3);
+
+  // Same prompt plus a suffix: all 3 prefix blocks should match
+  std::vector<int> prompt2 = prompt;
+  prompt2.push_back(99);
+  prompt2.push_back(98);
+
+  pager_->create_sequence(2);
+  EXPECT_EQ(cache_->match_and_attach(prompt2, 2), 12);
+
+  // Child sequence shares the parent's physical blocks
+  auto* seq1 = pager_->get_sequence(1);
+  auto* seq2 = pager_->get_sequence(2);
+  ASSERT_NE(seq1, nullptr);
+  ASSERT_NE(seq2, nullptr);
+  EXPECT_EQ(seq2->num_tokens(), 12);
+  ASSERT_EQ(seq2->page_table().size(), 3u);
+  EXPECT_EQ(seq2->page_table()[0], seq1->page_table()[0]);
+}
+
+// Test exact-length prompt never fully matches (last block is dropped)
+TEST_F(PrefixCacheTest, ExactMatchLeavesSuffixToCompute) {
+  std::vector<int> prompt(8);
+  std::iota(prompt.begin(), prompt.end(), 0);
+
+  make_prefilled_sequence(1, prompt);
+  cache_->insert(prompt, 1);
+
+  pager_->create_sequence(2);
+  // 2 blocks cached, but full coverage is capped to 1 block (4 tokens)
+  EXPECT_EQ(cache_->match_and_attach(prompt, 2), 4);
+}
+
+// Test cached blocks survive deletion of the originating sequence
+TEST_F(PrefixCacheTest, BlocksSurviveSourceSequenceDeletion) {
+  std::vector<int> prompt(12);
+  std::iota(prompt.begin(), prompt.end(), 0);
+
+  make_prefilled_sequence(1, prompt);
+  cache_->insert(prompt, 1);
+  pager_->delete_sequence(1);
+
+  std::vector<int> prompt2 = prompt;
+  prompt2.push_back(7);
+
+  pager_->create_sequence(2);
+  EXPECT_EQ(cache_->match_and_attach(prompt2, 2), 12);
+}
+
+// Test divergent prompts only match the common prefix
+TEST_F(PrefixCacheTest, DivergentPromptMatchesCommonPrefixOnly) {
+  std::vector<int> prompt(12);
+  std::iota(prompt.begin(), prompt.end(), 0);
+
+  make_prefilled_sequence(1, prompt);
+  cache_->insert(prompt, 1);
+
+  // Same first block, different second block
+  std::vector<int> other = prompt;
+  other[5] = 777;
+  other.push_back(1);
+
+  pager_->create_sequence(2);
+  EXPECT_EQ(cache_->match_and_attach(other, 2), 4);
+}
+
+// Test LRU eviction keeps the cache within its block budget
+TEST_F(PrefixCacheTest, EvictsToBudget) {
+  PrefixCacheConfig config;
+  config.max_cached_blocks = 2;
+  auto small_cache = std::make_unique<PrefixCache>(pager_, config);
+
+  std::vector<int> prompt(12);
+  std::iota(prompt.begin(), prompt.end(), 0);
+
+  make_prefilled_sequence(1, prompt);
+  small_cache->insert(prompt, 1);
+
+  auto stats = small_cache->get_stats();
+  EXPECT_LE(stats.cached_blocks, 2);
+}
+
+// Test TTL eviction reclaims blocks from idle conversations
+TEST_F(PrefixCacheTest, TtlEvictsIdleEntries) {
+  PrefixCacheConfig config;
+  config.ttl_seconds = 1;
+  auto ttl_cache = std::make_unique<PrefixCache>(pager_, config);
+
+  std::vector<int> prompt(12);
+  std::iota(prompt.begin(), prompt.end(), 0);
+
+  make_prefilled_sequence(1, prompt);
+  ttl_cache->insert(prompt, 1);
+  EXPECT_EQ(ttl_cache->get_stats().cached_blocks, 3);
+
+  // Let the entries expire, then trigger eviction via a lookup for an
+  // unrelated prompt
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+
+  std::vector<int> other(12, 500);
+  pager_->create_sequence(2);
+  EXPECT_EQ(ttl_cache->match_and_attach(other, 2), 0);
+  EXPECT_EQ(ttl_cache->get_stats().cached_blocks, 0);
+}
+
+// Test a touch within the TTL keeps a conversation's blocks alive
+TEST_F(PrefixCacheTest, TtlRefreshedByMatch) {
+  PrefixCacheConfig config;
+  config.ttl_seconds = 3;
+  auto ttl_cache = std::make_unique<PrefixCache>(pager_, config);
+
+  std::vector<int> prompt(12);
+  std::iota(prompt.begin(), prompt.end(), 0);
+
+  make_prefilled_sequence(1, prompt);
+  ttl_cache->insert(prompt, 1);
+
+  // A follow-up turn inside the TTL refreshes every matched node
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+
+  std::vector<int> prompt2 = prompt;
+  prompt2.push_back(99);
+  pager_->create_sequence(2);
+  EXPECT_EQ(ttl_cache->match_and_attach(prompt2, 2), 12);
+  EXPECT_EQ(ttl_cache->get_stats().cached_blocks, 3);
+}
+
+// Test clear releases all cached blocks
+TEST_F(PrefixCacheTest, ClearReleasesBlocks) {
+  std::vector<int> prompt(8);
+  std::iota(prompt.begin(), prompt.end(), 0);
+
+  make_prefilled_sequence(1, prompt);
+  cache_->insert(prompt, 1);
+  cache_->clear();
+
+  auto stats = cache_->get_stats();
+  EXPECT_EQ(stats.cached_blocks, 0);
+}
+
+}  // namespace
@@ -0,0 +1,145 @@
+// Copyright © 2025 MLXR Development
+// Unit tests for the scheduler's Request recycling pool
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "scheduler/request.h"
+#include "scheduler/request_pool.h"
+
+namespace mlxr {
+namespace scheduler {
+namespace test {
+
+TEST(RequestPoolTest, RecyclesCompletedRequests) {
+  RequestPool pool;
+
+  Request* first_raw = nullptr;
+  {
+    auto request = pool.acquire("req-1", "hello", {1, 2, 3}, SamplingParams{});
+    first_raw = request.get();
+    request->mark_completed(FinishReason::STOP);
+  }
+  EXPECT_EQ(pool.pooled_count(), 1u);
+
+  // The next acquire reuses the recycled object
+  auto reused = pool.acquire("req-2", "world", {4, 5}, SamplingParams{});
+  EXPECT_EQ(reused.get(), first_raw);
+  EXPECT_EQ(pool.pooled_count(), 0u);
+}
+
+TEST(RequestPoolTest, ReusedRequestHasFreshState) {
+  RequestPool pool;
+
+  {
+    auto request = pool.acquire("req-1", "first", {1, 2, 3}, SamplingParams{});
+    request->mark_prefilling();
+    request->mark_decoding();
+    request->add_generated_token(42);
+    request->kv_block_ids = {7, 8, 9};
+    request->pending_forks = 3;
+    request->stop_sequence_hit = true;
+    request->priority = 5;
+    request->mark_completed(FinishReason::LENGTH);
+  }
+
+  SamplingParams params;
+  params.max_tokens = 64;
+  auto reused = pool.acquire("req-2", "second", {9}, params);
+
+  EXPECT_EQ(reused->request_id, "req-2");
+  EXPECT_EQ(reused->prompt, "second");
+  ASSERT_EQ(reused->prompt_token_ids.size(), 1u);
+  EXPECT_EQ(reused->prompt_token_ids[0], 9);
+  EXPECT_EQ(reused->state, RequestState::WAITING);
+  EXPECT_EQ(reused->finish_reason, FinishReason::NONE);
+  EXPECT_TRUE(reused->generated_token_ids.empty());
+  EXPECT_EQ(reused->num_generated_tokens, 0);
+  EXPECT_EQ(reused->num_prompt_tokens, 1);
+  EXPECT_EQ(reused->max_tokens, 64);
+  EXPECT_EQ(reused->num_prefilled_tokens, 0);
+  EXPECT_TRUE(reused->kv_block_ids.empty());
+  EXPECT_EQ(reused->pending_forks, 0);
+  EXPECT_FALSE(reused->stop_sequence_hit);
+  EXPECT_EQ(reused->priority, 0);
+  EXPECT_TRUE(reused->tokens_ready.load());
+  EXPECT_TRUE(reused->consumer_ready.load());
+  EXPECT_FALSE(reused->token_callback);
+}
+
+TEST(RequestPoolTest, TokenVectorsRetainCapacityAcrossReuse) {
+  RequestPool pool;
+
+  std::vector<int> large_prompt(4096, 1);
+  size_t retained_capacity = 0;
+  Request* raw = nullptr;
+  {
+    auto request =
+        pool.acquire("req-1", "large", large_prompt, SamplingParams{});
+    retained_capacity = request->prompt_token_ids.capacity();
+    raw = request.get();
+  }
+
+  // Reuse with a small prompt: the grown storage is still there, so the
+  // assign() writes into warm memory instead of reallocating
+  auto reused = pool.acquire("req-2", "small", {1, 2}, SamplingParams{});
+  ASSERT_EQ(reused.get(), raw);
+  EXPECT_GE(reused->prompt_token_ids.capacity(), retained_capacity);
+}
+
+TEST(RequestPoolTest, OversizedVectorsAreDroppedOnRecycle) {
+  RequestPool pool;
+
+  std::vector<int> huge_prompt(100000, 1);  // Above the retention cap
+  Request* raw = nullptr;
+  {
+    auto request = pool.acquire("req-1", "huge", huge_prompt, SamplingParams{});
+    raw = request.get();
+  }
+
+  auto reused = pool.acquire("req-2", "tiny", {1}, SamplingParams{});
+  ASSERT_EQ(reused.get(), raw);
+  EXPECT_LT(reused->prompt_token_ids.capacity(), 100000u);
+}
+
+TEST(RequestPoolTest, FreeListIsBounded) {
+  RequestPool pool(/*max_pooled=*/2);
+
+  std::vector<RequestPtr> requests;
+  for (int i = 0; i < 5; i++) {
+    requests.push_back(pool.acquire("req-" + std::to_string(i), "p", {1},
+                                    SamplingParams{}));
+  }
+  requests.clear();
+
+  EXPECT_EQ(pool.pooled_count(), 2u);
+}
+
+TEST(RequestPoolTest, DeferredAcquireIsNotAdmissible) {
+  RequestPool pool;
+
+  auto request = pool.acquire_deferred("req-1", "prompt", SamplingParams{});
+  EXPECT_FALSE(request->tokens_ready.load());
+  EXPECT_TRUE(request->prompt_token_ids.empty());
+
+  request->set_prompt_tokens({1, 2, 3});
+  EXPECT_TRUE(request->tokens_ready.load());
+  EXPECT_EQ(request->num_prompt_tokens, 3);
+}
+
+TEST(RequestPoolTest, RequestsMayOutlivePool) {
+  RequestPtr survivor;
+  {
+    RequestPool pool;
+    survivor = pool.acquire("req-1", "p", {1}, SamplingParams{});
+  }
+  // Pool destroyed while the request is in flight; releasing the
+  // request must not crash (state is kept alive by the deleter)
+  EXPECT_EQ(survivor->request_id, "req-1");
+  survivor.reset();
+}
+
+}  // namespace test
+}  // namespace scheduler
+}  // namespace mlxr
@@ -5,7 +5,12 @@
 
 #include <gtest/gtest.h>
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <chrono>
+#include <cstdio>
+#include <filesystem>
 #include <thread>
 
 #include "runtime/tokenizer/tokenizer.h"
@@ -50,6 +55,11 @@ TEST_F(RestServerTest, ConfigDefaults) {
   EXPECT_EQ(default_config.max_connections, 100);
   EXPECT_EQ(default_config.thread_pool_size, 4);
   EXPECT_TRUE(default_config.enable_metrics);
+
+  // Bounded serving footprint (load shedding instead of thread growth)
+  EXPECT_EQ(default_config.max_pending_connections, 64);
+  EXPECT_EQ(default_config.max_concurrent_requests, 256);
+  EXPECT_EQ(default_config.max_concurrent_streams, 64);
 }
 
 TEST_F(RestServerTest, ServerConstruction) {
@@ -98,6 +108,65 @@ TEST_F(RestServerTest, ServerDoubleStart) {
   server.stop();
 }
 
+// ==============================================================================
+// Unix Domain Socket Transport Tests
+// ==============================================================================
+
+TEST_F(RestServerTest, ConfigTransportDefaults) {
+  ServerConfig default_config;
+
+  // UDS is the primary transport; TCP stays on by default for
+  // backward compatibility
+  EXPECT_TRUE(default_config.enable_tcp);
+  EXPECT_TRUE(default_config.enable_unix_socket);
+  EXPECT_FALSE(default_config.unix_socket_path.empty());
+}
+
+TEST_F(RestServerTest, InitializeFailsWithNoTransport) {
+  config_.enable_tcp = false;
+  config_.enable_unix_socket = false;
+
+  RestServer server(config_);
+  EXPECT_FALSE(server.initialize());
+}
+
+TEST_F(RestServerTest, InvalidPortIgnoredWhenTcpDisabled) {
+  config_.enable_tcp = false;
+  config_.enable_unix_socket = true;
+  config_.port = -1;
+
+  RestServer server(config_);
+  EXPECT_TRUE(server.initialize());
+}
+
+TEST_F(RestServerTest, UdsOnlyStartCreatesSocketWithOwnerPermissions) {
+  std::string socket_path =
+      (std::filesystem::temp_directory_path() /
+       ("mlxr_uds_test_" + std::to_string(::getpid()) + ".sock"))
+          .string();
+
+  config_.enable_tcp = false;
+  config_.enable_unix_socket = true;
+  config_.unix_socket_path = socket_path;
+
+  RestServer server(config_);
+  ASSERT_TRUE(server.initialize());
+  ASSERT_TRUE(server.start());
+
+  // Give the listener time to bind
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  struct stat st;
+  ASSERT_EQ(::stat(socket_path.c_str(), &st), 0);
+  EXPECT_TRUE(S_ISSOCK(st.st_mode));
+  EXPECT_EQ(st.st_mode & 0777, 0600u);  // owner-only
+
+  server.stop();
+
+  // Socket file is cleaned up on shutdown
+  EXPECT_FALSE(std::filesystem::exists(socket_path));
+}
+
 // ==============================================================================
 // Request/Response Data Structure Tests
 // ==============================================================================
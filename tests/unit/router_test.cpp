@@ -0,0 +1,93 @@
+// Copyright © 2025 MLXR Development
+// Unit tests for the request router's backend selection policy
+
+#include <gtest/gtest.h>
+
+#include "server/router.h"
+
+namespace mlxr {
+namespace server {
+namespace test {
+
+namespace {
+
+BackendLoad make_load(int queue_depth, int available_kv_blocks,
+                      int outstanding, bool healthy = true) {
+  BackendLoad load;
+  load.queue_depth = queue_depth;
+  load.available_kv_blocks = available_kv_blocks;
+  load.outstanding = outstanding;
+  load.healthy = healthy;
+  return load;
+}
+
+}  // namespace
+
+TEST(RouterPolicy, EmptyBackendListReturnsMinusOne) {
+  EXPECT_EQ(pick_least_loaded({}), -1);
+}
+
+TEST(RouterPolicy, SingleBackendAlwaysWins) {
+  std::vector<BackendLoad> backends = {make_load(100, 0, 50)};
+  EXPECT_EQ(pick_least_loaded(backends), 0);
+}
+
+TEST(RouterPolicy, LeastLoadedBackendWins) {
+  std::vector<BackendLoad> backends = {
+      make_load(4, 1024, 2),  // Load 6
+      make_load(1, 1024, 1),  // Load 2 - winner
+      make_load(3, 1024, 3),  // Load 6
+  };
+  EXPECT_EQ(pick_least_loaded(backends), 1);
+}
+
+TEST(RouterPolicy, OutstandingCountsTowardLoad) {
+  // Backend 0 reports an empty queue but the router has 5 requests in
+  // flight to it between stats polls; backend 1 is the better choice
+  std::vector<BackendLoad> backends = {
+      make_load(0, 1024, 5),
+      make_load(2, 1024, 0),
+  };
+  EXPECT_EQ(pick_least_loaded(backends), 1);
+}
+
+TEST(RouterPolicy, TieBreaksTowardMoreFreeKvBlocks) {
+  std::vector<BackendLoad> backends = {
+      make_load(2, 128, 0),
+      make_load(2, 4096, 0),  // Same load, emptier cache - winner
+      make_load(2, 512, 0),
+  };
+  EXPECT_EQ(pick_least_loaded(backends), 1);
+}
+
+TEST(RouterPolicy, UnhealthyBackendsAreSkipped) {
+  std::vector<BackendLoad> backends = {
+      make_load(0, 4096, 0, /*healthy=*/false),
+      make_load(9, 16, 3),
+  };
+  EXPECT_EQ(pick_least_loaded(backends), 1);
+}
+
+TEST(RouterPolicy, AllUnhealthyFallsBackToFirst) {
+  // When every backend is down we still route so the caller sees the
+  // backend's own connection error rather than a fabricated one
+  std::vector<BackendLoad> backends = {
+      make_load(0, 0, 0, /*healthy=*/false),
+      make_load(0, 0, 0, /*healthy=*/false),
+  };
+  EXPECT_EQ(pick_least_loaded(backends), 0);
+}
+
+TEST(RouterPolicy, StableChoiceUnderEqualLoad) {
+  // Fully symmetric backends: first healthy index wins deterministically
+  std::vector<BackendLoad> backends = {
+      make_load(1, 256, 1),
+      make_load(1, 256, 1),
+      make_load(1, 256, 1),
+  };
+  EXPECT_EQ(pick_least_loaded(backends), 0);
+}
+
+}  // namespace test
+}  // namespace server
+}  // namespace mlxr
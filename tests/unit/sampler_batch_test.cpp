@@ -0,0 +1,194 @@
+/**
+ * @file sampler_batch_test.cpp
+ * @brief Unit tests for batched sampling (Sampler::sample_batch)
+ *
+ * Covers the deterministic contracts of the batched path: greedy rows,
+ * top-k=1 truncation, repetition penalty, per-row config independence,
+ * and argument validation. These hold for both the fused GPU kernel
+ * and the CPU fallback, so the tests pass with or without
+ * USE_CUSTOM_KERNELS and a compiled metallib.
+ */
+
+#include "runtime/sampler.h"
+
+#include <gtest/gtest.h>
+#include <mlx/mlx.h>
+
+#include <unordered_map>
+#include <vector>
+
+using namespace mlxr;
+using namespace mlxr::runtime;
+
+class SamplerBatchTest : public ::testing::Test {
+ protected:
+  // Build a 1D logits row from explicit values
+  graph::Tensor make_row(const std::vector<float>& values) {
+    auto arr = mlx::core::array(values.begin(),
+                                {static_cast<int>(values.size())},
+                                mlx::core::float32);
+    return graph::Tensor(arr);
+  }
+};
+
+TEST_F(SamplerBatchTest, EmptyBatchReturnsEmpty) {
+  auto tokens = Sampler::sample_batch({}, {}, {});
+  EXPECT_TRUE(tokens.empty());
+}
+
+TEST_F(SamplerBatchTest, GreedyRowsPickArgmax) {
+  std::vector<graph::Tensor> rows = {
+      make_row({0.1f, 5.0f, 0.2f, 0.3f}),
+      make_row({2.0f, 0.1f, 0.1f, 0.1f}),
+      make_row({0.0f, 0.0f, 0.0f, 9.0f}),
+  };
+
+  SamplerConfig greedy;
+  greedy.temperature = 0.0f;
+  std::vector<SamplerConfig> configs(rows.size(), greedy);
+  std::vector<std::vector<int>> contexts(rows.size());
+
+  auto tokens = Sampler::sample_batch(rows, configs, contexts);
+  ASSERT_EQ(tokens.size(), 3u);
+  EXPECT_EQ(tokens[0], 1);
+  EXPECT_EQ(tokens[1], 0);
+  EXPECT_EQ(tokens[2], 3);
+}
+
+TEST_F(SamplerBatchTest, TopKOneIsDeterministic) {
+  std::vector<graph::Tensor> rows = {
+      make_row({0.1f, 0.2f, 7.0f, 0.3f}),
+  };
+
+  SamplerConfig config;
+  config.temperature = 0.8f;
+  config.top_k = 1;
+  config.seed = 42;
+
+  auto tokens = Sampler::sample_batch(rows, {config}, {{}});
+  ASSERT_EQ(tokens.size(), 1u);
+  EXPECT_EQ(tokens[0], 2);
+}
+
+TEST_F(SamplerBatchTest, RepetitionPenaltyDemotesContextTokens) {
+  // Token 1 leads by a small margin; penalizing it flips the argmax
+  // to token 2
+  std::vector<graph::Tensor> rows = {
+      make_row({0.1f, 2.0f, 1.9f, 0.1f}),
+  };
+
+  SamplerConfig config;
+  config.temperature = 0.0f;
+  config.repetition_penalty = 1.5f;
+
+  auto tokens = Sampler::sample_batch(rows, {config}, {{1, 1, 1}});
+  ASSERT_EQ(tokens.size(), 1u);
+  EXPECT_EQ(tokens[0], 2);
+}
+
+TEST_F(SamplerBatchTest, RowsUseTheirOwnConfigs) {
+  // Same logits, but row 0 penalizes token 0 while row 1 does not
+  std::vector<graph::Tensor> rows = {
+      make_row({3.0f, 2.9f, 0.1f}),
+      make_row({3.0f, 2.9f, 0.1f}),
+  };
+
+  SamplerConfig penalized;
+  penalized.temperature = 0.0f;
+  penalized.repetition_penalty = 2.0f;
+
+  SamplerConfig plain;
+  plain.temperature = 0.0f;
+
+  auto tokens = Sampler::sample_batch(rows, {penalized, plain}, {{0}, {}});
+  ASSERT_EQ(tokens.size(), 2u);
+  EXPECT_EQ(tokens[0], 1);
+  EXPECT_EQ(tokens[1], 0);
+}
+
+TEST_F(SamplerBatchTest, SampledTokensAreAlwaysInVocab) {
+  // Stochastic configs: verify range invariants over several draws
+  std::vector<graph::Tensor> rows = {
+      make_row({0.5f, 1.5f, 2.5f, 0.1f, 1.0f}),
+      make_row({2.0f, 0.1f, 0.2f, 3.0f, 0.3f}),
+  };
+
+  SamplerConfig config;
+  config.temperature = 1.0f;
+  config.top_k = 3;
+  config.top_p = 0.9f;
+
+  std::vector<SamplerConfig> configs(rows.size(), config);
+  std::vector<std::vector<int>> contexts(rows.size());
+
+  for (int i = 0; i < 10; i++) {
+    auto tokens = Sampler::sample_batch(rows, configs, contexts);
+    ASSERT_EQ(tokens.size(), 2u);
+    for (int token : tokens) {
+      EXPECT_GE(token, 0);
+      EXPECT_LT(token, 5);
+    }
+  }
+}
+
+TEST_F(SamplerBatchTest, FrequencyTableOverloadMatchesListOverload) {
+  // Same logits and penalty, context given once as a raw history list
+  // and once as the frequency table the engine maintains
+  std::vector<graph::Tensor> rows = {
+      make_row({0.1f, 2.0f, 1.9f, 0.1f}),
+  };
+
+  SamplerConfig config;
+  config.temperature = 0.0f;
+  config.repetition_penalty = 1.5f;
+
+  auto from_list = Sampler::sample_batch(rows, {config}, {{1, 1, 1}});
+
+  std::unordered_map<int, int> counts = {{1, 3}};
+  std::vector<const std::unordered_map<int, int>*> maps = {&counts};
+  auto from_table = Sampler::sample_batch(rows, {config}, maps);
+
+  ASSERT_EQ(from_table.size(), 1u);
+  EXPECT_EQ(from_table[0], from_list[0]);
+  EXPECT_EQ(from_table[0], 2);
+}
+
+TEST_F(SamplerBatchTest, NullFrequencyTableMeansNoPenalty) {
+  std::vector<graph::Tensor> rows = {make_row({0.1f, 2.0f, 1.9f, 0.1f})};
+
+  SamplerConfig config;
+  config.temperature = 0.0f;
+  config.repetition_penalty = 1.5f;
+
+  std::vector<const std::unordered_map<int, int>*> maps = {nullptr};
+  auto tokens = Sampler::sample_batch(rows, {config}, maps);
+  ASSERT_EQ(tokens.size(), 1u);
+  EXPECT_EQ(tokens[0], 1);
+}
+
+TEST_F(SamplerBatchTest, SparsePenaltyScattersDistinctTokensOnce) {
+  // Penalty semantics are presence-based: a token seen 100 times is
+  // penalized exactly once, same as the history-list implementation
+  auto logits = make_row({1.0f, 2.0f, -1.0f, 0.5f});
+
+  std::unordered_map<int, int> counts = {{1, 100}, {2, 1}};
+  auto penalized =
+      Sampler::apply_repetition_penalty_sparse(logits, counts, 2.0f);
+
+  auto arr = penalized.array();
+  mlx::core::eval(arr);
+  const float* data = arr.data<float>();
+  EXPECT_FLOAT_EQ(data[0], 1.0f);   // Untouched
+  EXPECT_FLOAT_EQ(data[1], 1.0f);   // Positive: divided once
+  EXPECT_FLOAT_EQ(data[2], -2.0f);  // Negative: multiplied once
+  EXPECT_FLOAT_EQ(data[3], 0.5f);   // Untouched
+}
+
+TEST_F(SamplerBatchTest, MismatchedSizesThrow) {
+  std::vector<graph::Tensor> rows = {make_row({1.0f, 2.0f})};
+  std::vector<SamplerConfig> configs(2);
+  std::vector<std::vector<int>> contexts(1);
+
+  EXPECT_THROW(Sampler::sample_batch(rows, configs, contexts),
+               std::invalid_argument);
+}
@@ -11,6 +11,7 @@
 #include <thread>
 
 #include "scheduler/request.h"
+#include "telemetry/metrics.h"
 
 using namespace mlxr::scheduler;
 
@@ -242,3 +243,676 @@ TEST_F(SchedulerTest, ConcurrentSubmitRequests) {
   // All requests should be accepted
   EXPECT_EQ(total_accepted, num_threads * requests_per_thread);
 }
+
+// ============================================================================
+// Chunked Prefill Tests
+// ============================================================================
+
+TEST_F(SchedulerTest, ChunkedPrefillSplitsLongPrompt) {
+  config.enable_chunked_prefill = true;
+  config.max_prefill_chunk_size = 64;
+  config.max_prefill_tokens = 4096;
+  config.max_batch_tokens = 8192;
+  Scheduler scheduler(config);
+
+  // 200-token prompt -> 64 + 64 + 64 + 8 token chunks
+  auto request = create_request("long_prompt", 200);
+  ASSERT_TRUE(scheduler.submit_request(request));
+
+  // First step admits only one chunk of the long prompt
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->prefill_chunk_tokens, 64);
+  EXPECT_EQ(batch.prefill_requests[0]->state, RequestState::PREFILLING);
+
+  // Simulate the worker ingesting the chunk
+  request->num_prefilled_tokens += 64;
+  scheduler.complete_batch(batch);
+
+  // Subsequent steps keep serving the remaining chunks
+  batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->prefill_chunk_tokens, 64);
+}
+
+TEST_F(SchedulerTest, ChunkedPrefillMixesWithDecodeBatch) {
+  config.enable_chunked_prefill = true;
+  config.max_prefill_chunk_size = 32;
+  Scheduler scheduler(config);
+
+  // Short request first: prefills whole prompt in one step and moves to
+  // decode
+  auto short_req = create_request("short", 8);
+  ASSERT_TRUE(scheduler.submit_request(short_req));
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  short_req->num_prefilled_tokens = 8;
+  short_req->mark_decoding();
+  short_req->add_generated_token(42);
+  scheduler.complete_batch(batch);
+
+  // Long request arrives; each following step should carry the decode
+  // request AND one chunk of the long prompt
+  auto long_req = create_request("long", 100);
+  ASSERT_TRUE(scheduler.submit_request(long_req));
+
+  batch = scheduler.get_next_batch();
+  EXPECT_EQ(batch.decode_requests.size(), 1u);
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->request_id, "long");
+  EXPECT_EQ(batch.prefill_requests[0]->prefill_chunk_tokens, 32);
+}
+
+// ============================================================================
+// Adaptive Token Budget Tests
+// ============================================================================
+
+TEST_F(SchedulerTest, BudgetBacksOffOnOverrunAndRecovers) {
+  config.enable_adaptive_batch_tokens = true;
+  config.target_step_latency_ms = 80.0f;
+  config.min_batch_tokens = 256;
+  config.batch_tokens_increase = 128;
+  config.batch_tokens_backoff = 0.5f;
+  Scheduler scheduler(config);  // max_batch_tokens = 2048
+
+  EXPECT_EQ(scheduler.effective_batch_tokens(), 2048);
+
+  // Overruns halve the budget, clamped at the floor
+  scheduler.record_step_latency(200.0);
+  EXPECT_EQ(scheduler.effective_batch_tokens(), 1024);
+  scheduler.record_step_latency(200.0);
+  EXPECT_EQ(scheduler.effective_batch_tokens(), 512);
+  for (int i = 0; i < 10; ++i) {
+    scheduler.record_step_latency(200.0);
+  }
+  EXPECT_EQ(scheduler.effective_batch_tokens(), 256);
+
+  // On-target steps grow the budget additively back to the ceiling
+  scheduler.record_step_latency(40.0);
+  EXPECT_EQ(scheduler.effective_batch_tokens(), 384);
+  for (int i = 0; i < 100; ++i) {
+    scheduler.record_step_latency(40.0);
+  }
+  EXPECT_EQ(scheduler.effective_batch_tokens(), 2048);
+}
+
+TEST_F(SchedulerTest, DisabledControllerKeepsStaticBudget) {
+  config.enable_adaptive_batch_tokens = false;
+  Scheduler scheduler(config);
+
+  scheduler.record_step_latency(500.0);
+  EXPECT_EQ(scheduler.effective_batch_tokens(), 2048);
+}
+
+TEST_F(SchedulerTest, ReducedBudgetShrinksPrefillChunks) {
+  config.enable_adaptive_batch_tokens = true;
+  config.min_batch_tokens = 16;
+  config.batch_tokens_backoff = 0.01f;  // collapse quickly for the test
+  Scheduler scheduler(config);
+
+  scheduler.record_step_latency(1000.0);  // 2048 * 0.01 = 20 tokens
+  ASSERT_EQ(scheduler.effective_batch_tokens(), 20);
+
+  // A 100-token prompt still makes progress, in budget-sized chunks
+  auto request = create_request("throttled", 100);
+  ASSERT_TRUE(scheduler.submit_request(request));
+
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->prefill_chunk_tokens, 20);
+}
+
+// ============================================================================
+// Deadline-Aware Scheduling Tests
+// ============================================================================
+
+TEST_F(SchedulerTest, LateInteractiveDecodeBlocksPrefillBackfill) {
+  config.enable_chunked_prefill = true;
+  config.max_prefill_chunk_size = 32;
+  Scheduler scheduler(config);
+
+  // Interactive chat request reaches the decode phase
+  auto chat = create_request("chat", 8);
+  chat->target_token_latency_ms = 80.0f;
+  ASSERT_TRUE(scheduler.submit_request(chat));
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  chat->num_prefilled_tokens = 8;
+  chat->mark_decoding();
+  chat->add_generated_token(42);
+  scheduler.complete_batch(batch);
+
+  // Push the chat request past its deadline, then submit a batch-class
+  // eval prompt
+  chat->last_token_time =
+      std::chrono::steady_clock::now() - std::chrono::milliseconds(200);
+  auto eval = create_request("eval", 100);  // no latency target
+  ASSERT_TRUE(scheduler.submit_request(eval));
+
+  // No slack left: the step is decode-only, eval prefill waits
+  batch = scheduler.get_next_batch();
+  EXPECT_EQ(batch.decode_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests.size(), 0u);
+}
+
+TEST_F(SchedulerTest, AmpleSlackBackfillsBatchPrefill) {
+  config.enable_chunked_prefill = true;
+  config.max_prefill_chunk_size = 32;
+  Scheduler scheduler(config);
+
+  auto chat = create_request("chat", 8);
+  chat->target_token_latency_ms = 80.0f;
+  ASSERT_TRUE(scheduler.submit_request(chat));
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  chat->num_prefilled_tokens = 8;
+  chat->mark_decoding();
+  chat->add_generated_token(42);  // fresh token: full 80ms of slack
+  scheduler.complete_batch(batch);
+
+  auto eval = create_request("eval", 100);
+  ASSERT_TRUE(scheduler.submit_request(eval));
+
+  // Slack covers the decode step plus a prefill chunk: backfill happens
+  batch = scheduler.get_next_batch();
+  EXPECT_EQ(batch.decode_requests.size(), 1u);
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->request_id, "eval");
+}
+
+TEST_F(SchedulerTest, InteractiveArrivalsJumpBatchArrivals) {
+  config.max_prefill_tokens = 64;
+  Scheduler scheduler(config);
+
+  // Batch-class eval prompt arrives first, interactive chat second;
+  // the budget only fits one of them this step
+  auto eval = create_request("eval", 64);
+  auto chat = create_request("chat", 40);
+  chat->target_token_latency_ms = 80.0f;
+  ASSERT_TRUE(scheduler.submit_request(eval));
+  ASSERT_TRUE(scheduler.submit_request(chat));
+
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_FALSE(batch.prefill_requests.empty());
+  EXPECT_EQ(batch.prefill_requests[0]->request_id, "chat");
+}
+
+TEST_F(SchedulerTest, DeferredTokensSkipAdmissionUntilReady) {
+  Scheduler scheduler(config);
+
+  // "big_doc" arrives first but its prompt is still being tokenized
+  // asynchronously; "chat" behind it must not be head-of-line blocked
+  SamplingParams params;
+  auto big_doc = std::make_shared<Request>("big_doc", "large document", params);
+  auto chat = create_request("chat", 8);
+  ASSERT_TRUE(scheduler.submit_request(big_doc));
+  ASSERT_TRUE(scheduler.submit_request(chat));
+
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->request_id, "chat");
+  EXPECT_EQ(big_doc->state, RequestState::WAITING);
+  scheduler.complete_batch(batch);
+
+  // Tokens land: the request is admissible on the next step
+  big_doc->set_prompt_tokens(std::vector<int>(16, 1));
+  batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->request_id, "big_doc");
+  EXPECT_EQ(big_doc->num_prompt_tokens, 16);
+}
+
+TEST_F(SchedulerTest, ForkSiblingsWaitForParentPrefill) {
+  Scheduler scheduler(config);
+
+  // n>1 sampling: the sibling forks the parent's prefilled KV, so
+  // admitting it before the parent's prefill lands would just redo
+  // the shared prompt
+  auto parent = create_request("parent", 16);
+  auto sibling = create_request("parent-n1", 16);
+  sibling->fork_of_request_id = "parent";
+  ASSERT_TRUE(scheduler.submit_request(parent));
+  ASSERT_TRUE(scheduler.submit_request(sibling));
+
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->request_id, "parent");
+  EXPECT_EQ(sibling->state, RequestState::WAITING);
+
+  // Parent's prefill completes; the sibling is admissible next step
+  parent->num_prefilled_tokens = parent->num_prompt_tokens;
+  parent->mark_decoding();
+  scheduler.complete_batch(batch);
+
+  batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->request_id, "parent-n1");
+}
+
+TEST_F(SchedulerTest, FinalChunkMovesRequestToDecoding) {
+  config.enable_chunked_prefill = true;
+  config.max_prefill_chunk_size = 32;
+  Scheduler scheduler(config);
+
+  auto request = create_request("two_chunks", 50);
+  ASSERT_TRUE(scheduler.submit_request(request));
+
+  // Chunk 1: 32 tokens
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  request->num_prefilled_tokens += 32;
+  scheduler.complete_batch(batch);
+
+  // Chunk 2: remaining 18 tokens - request should be scheduled for
+  // decode on the step after
+  batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->prefill_chunk_tokens, 18);
+  request->num_prefilled_tokens += 18;
+  request->mark_decoding();
+  request->add_generated_token(7);
+  scheduler.complete_batch(batch);
+
+  batch = scheduler.get_next_batch();
+  EXPECT_EQ(batch.prefill_requests.size(), 0u);
+  EXPECT_EQ(batch.decode_requests.size(), 1u);
+}
+
+// ============================================================================
+// Swap-Based Preemption Tests
+// ============================================================================
+
+TEST_F(SchedulerTest, PreemptionSwapsVictimOutAndResumesIt) {
+  config.total_kv_blocks = 3;  // victim holds 2, newcomer needs 2
+  config.min_decode_steps_before_preempt = 10;
+  Scheduler scheduler(config);
+
+  std::vector<std::string> swapped_out;
+  std::vector<std::string> swapped_in;
+  scheduler.set_swap_callbacks(
+      [&](const std::string& id) { swapped_out.push_back(id); },
+      [&](const std::string& id) { swapped_in.push_back(id); });
+
+  // Victim reaches the decode phase with enough progress to be eligible
+  auto victim = create_request("victim", 16, 16);
+  ASSERT_TRUE(scheduler.submit_request(victim));
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  victim->num_prefilled_tokens = 16;
+  victim->mark_decoding();
+  for (int i = 0; i < 10; ++i) {
+    victim->add_generated_token(i);
+  }
+  scheduler.complete_batch(batch);
+
+  // Newcomer can't fit without preempting the victim
+  auto newcomer = create_request("newcomer", 16, 16);
+  ASSERT_TRUE(scheduler.submit_request(newcomer));
+  batch = scheduler.get_next_batch();
+
+  ASSERT_EQ(swapped_out.size(), 1u);
+  EXPECT_EQ(swapped_out[0], "victim");
+  EXPECT_EQ(victim->state, RequestState::PAUSED);
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->request_id, "newcomer");
+  scheduler.complete_batch(batch);
+
+  // Once the newcomer's blocks are freed, the victim is swapped back
+  // in and resumes decoding - no re-prefill
+  ASSERT_TRUE(scheduler.cancel_request("newcomer"));
+  batch = scheduler.get_next_batch();
+
+  ASSERT_EQ(swapped_in.size(), 1u);
+  EXPECT_EQ(swapped_in[0], "victim");
+  EXPECT_EQ(victim->state, RequestState::DECODING);
+  EXPECT_EQ(batch.prefill_requests.size(), 0u);
+  ASSERT_EQ(batch.decode_requests.size(), 1u);
+  EXPECT_EQ(batch.decode_requests[0]->request_id, "victim");
+}
+
+TEST_F(SchedulerTest, SwapDisabledStillPausesWithoutCallbacks) {
+  config.total_kv_blocks = 3;
+  config.min_decode_steps_before_preempt = 10;
+  config.preempt_via_swap = false;
+  Scheduler scheduler(config);
+
+  std::vector<std::string> swapped_out;
+  scheduler.set_swap_callbacks(
+      [&](const std::string& id) { swapped_out.push_back(id); },
+      [](const std::string&) {});
+
+  auto victim = create_request("victim", 16, 16);
+  ASSERT_TRUE(scheduler.submit_request(victim));
+  Batch batch = scheduler.get_next_batch();
+  victim->num_prefilled_tokens = 16;
+  victim->mark_decoding();
+  for (int i = 0; i < 10; ++i) {
+    victim->add_generated_token(i);
+  }
+  scheduler.complete_batch(batch);
+
+  auto newcomer = create_request("newcomer", 16, 16);
+  ASSERT_TRUE(scheduler.submit_request(newcomer));
+  scheduler.get_next_batch();
+
+  // Victim is preempted the old way: paused, but no swap requested
+  EXPECT_EQ(victim->state, RequestState::PAUSED);
+  EXPECT_TRUE(swapped_out.empty());
+}
+
+TEST_F(SchedulerTest, PhaseTimingBreakdown) {
+  auto request = create_request("timed", 16, 16);
+
+  // Queue → prefill → decode → complete, with a measurable pause in
+  // each phase
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  request->mark_prefilling();
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  request->mark_decoding();
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  request->mark_completed(FinishReason::STOP);
+
+  EXPECT_GE(request->queue_time_ms(), 4.0);
+  EXPECT_GE(request->prefill_time_ms(), 4.0);
+  EXPECT_GE(request->decode_time_ms(), 4.0);
+
+  // Phases partition the end-to-end time
+  double phase_sum = request->queue_time_ms() + request->prefill_time_ms() +
+                     request->decode_time_ms();
+  EXPECT_NEAR(phase_sum, request->total_time_ms(), 1.0);
+
+  // Prefill ends where decode starts, not at completion
+  EXPECT_LT(request->prefill_time_ms(), request->total_time_ms());
+}
+
+TEST_F(SchedulerTest, PhaseTimingWithoutDecode) {
+  auto request = create_request("prefill_only", 16, 16);
+
+  request->mark_prefilling();
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  request->mark_failed("engine error");
+
+  // Prefill spans until failure; decode never started
+  EXPECT_GE(request->prefill_time_ms(), 4.0);
+  EXPECT_DOUBLE_EQ(request->decode_time_ms(), 0.0);
+}
+
+// ============================================================================
+// Fair-Share Scheduling Tests
+// ============================================================================
+
+TEST_F(SchedulerTest, FairShareLetsLightTenantJumpHeavyBacklog) {
+  config.enable_fair_share = true;
+  config.fair_share_halflife_ms = 1e9f;  // Effectively no decay in-test
+  config.max_batch_size = 1;             // One admission per step
+  Scheduler scheduler(config);
+
+  // Tenant "a" consumes a prefill's worth of tokens
+  auto heavy = create_request("a1", 64, 0);
+  heavy->tenant_id = "a";
+  ASSERT_TRUE(scheduler.submit_request(heavy));
+  auto batch1 = scheduler.get_next_batch();
+  ASSERT_EQ(batch1.prefill_requests.size(), 1u);
+  scheduler.complete_batch(batch1);
+
+  // "a" queues more work, then tenant "b" arrives behind it
+  auto heavy2 = create_request("a2", 8, 0);
+  heavy2->tenant_id = "a";
+  auto light = create_request("b1", 8, 0);
+  light->tenant_id = "b";
+  ASSERT_TRUE(scheduler.submit_request(heavy2));
+  ASSERT_TRUE(scheduler.submit_request(light));
+
+  // "b" has zero recent consumption, so it is admitted first even
+  // though "a2" arrived earlier
+  auto batch2 = scheduler.get_next_batch();
+  ASSERT_EQ(batch2.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch2.prefill_requests[0]->request_id, "b1");
+}
+
+TEST_F(SchedulerTest, FairShareDisabledPreservesArrivalOrder) {
+  config.enable_fair_share = false;
+  config.max_batch_size = 1;
+  Scheduler scheduler(config);
+
+  auto heavy = create_request("a1", 64, 0);
+  heavy->tenant_id = "a";
+  ASSERT_TRUE(scheduler.submit_request(heavy));
+  auto batch1 = scheduler.get_next_batch();
+  scheduler.complete_batch(batch1);
+
+  auto heavy2 = create_request("a2", 8, 0);
+  heavy2->tenant_id = "a";
+  auto light = create_request("b1", 8, 0);
+  light->tenant_id = "b";
+  ASSERT_TRUE(scheduler.submit_request(heavy2));
+  ASSERT_TRUE(scheduler.submit_request(light));
+
+  auto batch2 = scheduler.get_next_batch();
+  ASSERT_EQ(batch2.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch2.prefill_requests[0]->request_id, "a2");
+}
+
+TEST_F(SchedulerTest, TenantWeightScalesShare) {
+  config.enable_fair_share = true;
+  config.fair_share_halflife_ms = 1e9f;
+  config.max_batch_size = 1;
+  config.tenant_weights["a"] = 100.0f;  // "a" is entitled to 100x share
+  Scheduler scheduler(config);
+
+  // Both tenants consume the same raw tokens
+  for (const auto& [id, tenant] : {std::pair<std::string, std::string>{
+                                       "a1", "a"},
+                                   {"b1", "b"}}) {
+    auto request = create_request(id, 64, 0);
+    request->tenant_id = tenant;
+    ASSERT_TRUE(scheduler.submit_request(request));
+    auto batch = scheduler.get_next_batch();
+    ASSERT_EQ(batch.prefill_requests.size(), 1u);
+    scheduler.complete_batch(batch);
+  }
+
+  // Normalized by weight, "a" has consumed far less of its entitlement
+  auto a2 = create_request("b2", 8, 0);
+  a2->tenant_id = "b";
+  auto b2 = create_request("a2", 8, 0);
+  b2->tenant_id = "a";
+  ASSERT_TRUE(scheduler.submit_request(a2));
+  ASSERT_TRUE(scheduler.submit_request(b2));
+
+  auto batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->request_id, "a2");
+}
+
+// ============================================================================
+// Consumer Backpressure Tests
+// ============================================================================
+
+TEST_F(SchedulerTest, ParkedConsumerSkipsDecodeAdmission) {
+  Scheduler scheduler(config);
+
+  // Drive a request into the decode phase
+  auto request = create_request("slow_client", 8);
+  ASSERT_TRUE(scheduler.submit_request(request));
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  request->num_prefilled_tokens = 8;
+  request->mark_decoding();
+  request->add_generated_token(42);
+  scheduler.complete_batch(batch);
+
+  // Serving layer parks the sequence (stream queue hit high water):
+  // the request stays resident but is not admitted into the batch
+  request->consumer_ready.store(false);
+  batch = scheduler.get_next_batch();
+  EXPECT_TRUE(batch.decode_requests.empty());
+  EXPECT_EQ(scheduler.get_request("slow_client"), request);
+
+  // Client catches up: the sequence resumes decoding from where it was
+  request->consumer_ready.store(true);
+  batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.decode_requests.size(), 1u);
+  EXPECT_EQ(batch.decode_requests[0]->request_id, "slow_client");
+}
+
+// ============================================================================
+// Cancellation Release Tests
+// ============================================================================
+
+TEST_F(SchedulerTest, CancelReleasesCacheBeforeNextBatch) {
+  Scheduler scheduler(config);
+
+  std::vector<std::string> released;
+  scheduler.set_release_callback(
+      [&](const std::string& request_id) { released.push_back(request_id); });
+
+  // Drive a request into the decode phase so it holds KV blocks
+  auto request = create_request("gone_client", 8);
+  ASSERT_TRUE(scheduler.submit_request(request));
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  request->num_prefilled_tokens = 8;
+  request->mark_decoding();
+  request->add_generated_token(42);
+  scheduler.complete_batch(batch);
+
+  int free_before = scheduler.get_stats().available_kv_blocks;
+
+  // Client disconnects mid-stream: the request goes terminal and its
+  // scheduler-side blocks come back immediately, but the engine-side
+  // release is deferred to the worker thread
+  ASSERT_TRUE(scheduler.cancel_request("gone_client"));
+  EXPECT_TRUE(request->is_finished());
+  EXPECT_EQ(request->finish_reason, FinishReason::CANCELLED);
+  EXPECT_GT(scheduler.get_stats().available_kv_blocks, free_before);
+  EXPECT_TRUE(released.empty());
+
+  // The next batch formation fires the release before admitting work,
+  // and the cancelled request is not in the batch
+  batch = scheduler.get_next_batch();
+  ASSERT_EQ(released.size(), 1u);
+  EXPECT_EQ(released[0], "gone_client");
+  EXPECT_TRUE(batch.decode_requests.empty());
+
+  // One-shot: subsequent batches do not re-fire
+  scheduler.get_next_batch();
+  EXPECT_EQ(released.size(), 1u);
+}
+
+TEST_F(SchedulerTest, CancelWaitingRequestAlsoQueuesRelease) {
+  Scheduler scheduler(config);
+
+  std::vector<std::string> released;
+  scheduler.set_release_callback(
+      [&](const std::string& request_id) { released.push_back(request_id); });
+
+  auto request = create_request("never_started", 16);
+  ASSERT_TRUE(scheduler.submit_request(request));
+  ASSERT_TRUE(scheduler.cancel_request("never_started"));
+
+  // Waiting requests hold no engine-side cache, but the worker's
+  // release hook tolerates unknown IDs, so the scheduler does not have
+  // to know which phase the request reached
+  scheduler.get_next_batch();
+  ASSERT_EQ(released.size(), 1u);
+  EXPECT_EQ(released[0], "never_started");
+}
+
+TEST_F(SchedulerTest, CancelWithoutReleaseCallbackIsSafe) {
+  Scheduler scheduler(config);
+
+  auto request = create_request("no_hook", 8);
+  ASSERT_TRUE(scheduler.submit_request(request));
+  ASSERT_TRUE(scheduler.cancel_request("no_hook"));
+
+  // No callback registered: nothing queued, batch formation unaffected
+  EXPECT_NO_THROW(scheduler.get_next_batch());
+}
+
+// ============================================================================
+// Pressure Throttling Tests
+// ============================================================================
+
+TEST_F(SchedulerTest, ModeratePressureShrinksTokenBudget) {
+  Scheduler scheduler(config);
+
+  // Prompt larger than the throttled budget but within the nominal one
+  auto request = create_request("warm_machine", 1500);
+  ASSERT_TRUE(scheduler.submit_request(request));
+
+  scheduler.record_system_pressure(mlxr::telemetry::PressureLevel::MODERATE);
+
+  // Budget drops to max_batch_tokens * pressure_budget_scale (1024), so
+  // only the first chunk of the prompt is admitted this step
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->prefill_chunk_tokens, 1024);
+  EXPECT_EQ(scheduler.get_stats().pressure_level, 1);
+}
+
+TEST_F(SchedulerTest, SustainedHeavyPressurePausesBatchClass) {
+  config.pressure_sustain_ms = 0;  // engage the pause immediately
+  Scheduler scheduler(config);
+
+  auto batch_job = create_request("offline_eval", 16);
+  auto chat = create_request("chat", 16);
+  chat->target_token_latency_ms = 50.0f;
+  ASSERT_TRUE(scheduler.submit_request(batch_job));
+  ASSERT_TRUE(scheduler.submit_request(chat));
+
+  scheduler.record_system_pressure(mlxr::telemetry::PressureLevel::HEAVY);
+
+  // Batch-class work waits out the throttling; interactive keeps flowing
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->request_id, "chat");
+  EXPECT_TRUE(scheduler.get_stats().pressure_paused_admission);
+}
+
+TEST_F(SchedulerTest, TransientHeavyPressureDoesNotPause) {
+  Scheduler scheduler(config);  // default 2s sustain window
+
+  auto batch_job = create_request("offline_eval", 16);
+  ASSERT_TRUE(scheduler.submit_request(batch_job));
+
+  // A single heavy sample is a spike, not sustained throttling
+  scheduler.record_system_pressure(mlxr::telemetry::PressureLevel::HEAVY);
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_FALSE(scheduler.get_stats().pressure_paused_admission);
+}
+
+TEST_F(SchedulerTest, CriticalPressureStopsAdmissionButDecodesContinue) {
+  config.pressure_sustain_ms = 0;
+  Scheduler scheduler(config);
+
+  // Drive one request into decode before the pressure hits
+  auto resident = create_request("resident", 8);
+  ASSERT_TRUE(scheduler.submit_request(resident));
+  Batch batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  resident->num_prefilled_tokens = 8;
+  resident->mark_decoding();
+  resident->add_generated_token(42);
+  scheduler.complete_batch(batch);
+
+  auto late_chat = create_request("late_chat", 8);
+  late_chat->target_token_latency_ms = 50.0f;
+  ASSERT_TRUE(scheduler.submit_request(late_chat));
+
+  scheduler.record_system_pressure(mlxr::telemetry::PressureLevel::CRITICAL);
+
+  // Even interactive arrivals wait, but the in-flight stream decodes on
+  batch = scheduler.get_next_batch();
+  EXPECT_TRUE(batch.prefill_requests.empty());
+  ASSERT_EQ(batch.decode_requests.size(), 1u);
+  EXPECT_EQ(batch.decode_requests[0]->request_id, "resident");
+  scheduler.complete_batch(batch);
+
+  // Pressure clears: the queued arrival is admitted on the next step
+  scheduler.record_system_pressure(mlxr::telemetry::PressureLevel::NOMINAL);
+  batch = scheduler.get_next_batch();
+  ASSERT_EQ(batch.prefill_requests.size(), 1u);
+  EXPECT_EQ(batch.prefill_requests[0]->request_id, "late_chat");
+}
@@ -0,0 +1,211 @@
+// Copyright © 2025 MLXR Development
+// Native weight snapshot format unit tests
+
+#include "registry/snapshot.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace mlxr;
+using namespace mlxr::registry;
+
+namespace {
+
+class SnapshotTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    snapshot_path_ = "/tmp/mlxr_snapshot_test.mlxr-snap";
+    std::filesystem::remove(snapshot_path_);
+  }
+
+  void TearDown() override { std::filesystem::remove(snapshot_path_); }
+
+  std::string snapshot_path_;
+};
+
+// Round-trip: write two tensors, parse them back, verify metadata and
+// page-aligned payload offsets
+TEST_F(SnapshotTest, WriteAndParseRoundTrip) {
+  std::vector<uint8_t> dense(256, 0xAB);
+  std::vector<uint8_t> packed(144, 0xCD);
+
+  std::vector<SnapshotWriteEntry> entries(2);
+  entries[0].info.name = "token_embd.weight";
+  entries[0].info.shape = {16, 8};
+  entries[0].info.dtype = "float16";
+  entries[0].info.size = dense.size();
+  entries[0].data = dense.data();
+
+  entries[1].info.name = "blk.0.attn_q.weight";
+  entries[1].info.shape = {8, 8};
+  entries[1].info.dtype = "q4_k";
+  entries[1].info.quant_type = "q4_k";
+  entries[1].info.quant_block_size = 256;
+  entries[1].info.size = packed.size();
+  entries[1].data = packed.data();
+
+  std::string error;
+  ASSERT_TRUE(SnapshotFile::write(snapshot_path_, entries, 12345, &error))
+      << error;
+
+  SnapshotFile snapshot;
+  ASSERT_TRUE(snapshot.parse(snapshot_path_)) << snapshot.error();
+
+  EXPECT_EQ(snapshot.header().magic, SNAPSHOT_MAGIC);
+  EXPECT_EQ(snapshot.header().version, SNAPSHOT_VERSION_V1);
+  EXPECT_EQ(snapshot.header().tensor_count, 2u);
+  EXPECT_EQ(snapshot.header().source_size, 12345u);
+
+  ASSERT_EQ(snapshot.tensors().size(), 2u);
+
+  const auto& t0 = snapshot.tensors()[0];
+  EXPECT_EQ(t0.name, "token_embd.weight");
+  EXPECT_EQ(t0.dtype, "float16");
+  EXPECT_TRUE(t0.quant_type.empty());
+  EXPECT_EQ(t0.shape, (std::vector<int64_t>{16, 8}));
+  EXPECT_EQ(t0.size, dense.size());
+  EXPECT_EQ(t0.offset % SNAPSHOT_ALIGNMENT, 0u);
+
+  const auto& t1 = snapshot.tensors()[1];
+  EXPECT_EQ(t1.name, "blk.0.attn_q.weight");
+  EXPECT_EQ(t1.quant_type, "q4_k");
+  EXPECT_EQ(t1.quant_block_size, 256);
+  EXPECT_EQ(t1.offset % SNAPSHOT_ALIGNMENT, 0u);
+  EXPECT_GE(t1.offset, t0.offset + t0.size);
+}
+
+// Payload bytes land at the recorded offsets
+TEST_F(SnapshotTest, PayloadBytesAtRecordedOffsets) {
+  std::vector<uint8_t> data(64);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<uint8_t>(i);
+  }
+
+  std::vector<SnapshotWriteEntry> entries(1);
+  entries[0].info.name = "output_norm.weight";
+  entries[0].info.shape = {64};
+  entries[0].info.dtype = "float32";
+  entries[0].info.size = data.size();
+  entries[0].data = data.data();
+
+  std::string error;
+  ASSERT_TRUE(SnapshotFile::write(snapshot_path_, entries, 1, &error))
+      << error;
+
+  SnapshotFile snapshot;
+  ASSERT_TRUE(snapshot.parse(snapshot_path_));
+  const auto& t = snapshot.tensors()[0];
+
+  std::ifstream stream(snapshot_path_, std::ios::binary);
+  stream.seekg(static_cast<std::streamoff>(t.offset));
+  std::vector<uint8_t> read_back(t.size);
+  stream.read(reinterpret_cast<char*>(read_back.data()),
+              static_cast<std::streamsize>(t.size));
+  ASSERT_TRUE(stream.good());
+  EXPECT_EQ(read_back, data);
+}
+
+// Missing files and junk content are rejected with an error message
+TEST_F(SnapshotTest, RejectsMissingAndCorruptFiles) {
+  SnapshotFile missing;
+  EXPECT_FALSE(missing.parse("/nonexistent/file.mlxr-snap"));
+  EXPECT_FALSE(missing.error().empty());
+
+  {
+    std::ofstream stream(snapshot_path_, std::ios::binary);
+    const uint32_t junk = 0xDEADBEEF;
+    stream.write(reinterpret_cast<const char*>(&junk), sizeof(junk));
+  }
+  SnapshotFile corrupt;
+  EXPECT_FALSE(corrupt.parse(snapshot_path_));
+  EXPECT_FALSE(corrupt.error().empty());
+}
+
+// A crashed write must not leave a parseable file behind: the writer
+// goes through a .tmp sibling and renames on success
+TEST_F(SnapshotTest, WriteIsAtomic) {
+  std::vector<uint8_t> data(32, 0x11);
+  std::vector<SnapshotWriteEntry> entries(1);
+  entries[0].info.name = "w";
+  entries[0].info.shape = {32};
+  entries[0].info.dtype = "float16";
+  entries[0].info.size = data.size();
+  entries[0].data = data.data();
+
+  std::string error;
+  ASSERT_TRUE(SnapshotFile::write(snapshot_path_, entries, 7, &error));
+  EXPECT_FALSE(std::filesystem::exists(snapshot_path_ + ".tmp"));
+}
+
+// Streaming writer produces the same layout as the one-shot path:
+// tensors appended one at a time parse back identically
+TEST_F(SnapshotTest, StreamingWriterRoundTrip) {
+  std::vector<uint8_t> first(100, 0x42);
+  std::vector<uint8_t> second(200, 0x77);
+
+  std::vector<SnapshotTensorInfo> infos(2);
+  infos[0].name = "a";
+  infos[0].shape = {50};
+  infos[0].dtype = "float16";
+  infos[0].size = first.size();
+  infos[1].name = "b";
+  infos[1].shape = {100};
+  infos[1].dtype = "float16";
+  infos[1].size = second.size();
+
+  SnapshotWriter writer;
+  ASSERT_TRUE(writer.begin(snapshot_path_, infos, 999)) << writer.error();
+  ASSERT_TRUE(writer.append(first.data(), first.size())) << writer.error();
+  ASSERT_TRUE(writer.append(second.data(), second.size())) << writer.error();
+  ASSERT_TRUE(writer.finish()) << writer.error();
+
+  SnapshotFile snapshot;
+  ASSERT_TRUE(snapshot.parse(snapshot_path_)) << snapshot.error();
+  ASSERT_EQ(snapshot.tensors().size(), 2u);
+  EXPECT_EQ(snapshot.header().source_size, 999u);
+  EXPECT_EQ(snapshot.tensors()[0].offset % SNAPSHOT_ALIGNMENT, 0u);
+  EXPECT_EQ(snapshot.tensors()[1].offset % SNAPSHOT_ALIGNMENT, 0u);
+
+  std::ifstream stream(snapshot_path_, std::ios::binary);
+  stream.seekg(static_cast<std::streamoff>(snapshot.tensors()[1].offset));
+  std::vector<uint8_t> read_back(second.size());
+  stream.read(reinterpret_cast<char*>(read_back.data()),
+              static_cast<std::streamsize>(read_back.size()));
+  ASSERT_TRUE(stream.good());
+  EXPECT_EQ(read_back, second);
+}
+
+// The writer enforces the declared sizes and tensor count
+TEST_F(SnapshotTest, StreamingWriterRejectsMismatches) {
+  std::vector<uint8_t> data(16, 0x01);
+
+  std::vector<SnapshotTensorInfo> infos(1);
+  infos[0].name = "w";
+  infos[0].shape = {16};
+  infos[0].dtype = "float16";
+  infos[0].size = data.size();
+
+  // Wrong payload size
+  {
+    SnapshotWriter writer;
+    ASSERT_TRUE(writer.begin(snapshot_path_, infos, 1));
+    EXPECT_FALSE(writer.append(data.data(), data.size() - 1));
+    EXPECT_FALSE(writer.error().empty());
+  }
+  EXPECT_FALSE(std::filesystem::exists(snapshot_path_));
+
+  // Finishing before all tensors are appended
+  {
+    SnapshotWriter writer;
+    ASSERT_TRUE(writer.begin(snapshot_path_, infos, 1));
+    EXPECT_FALSE(writer.finish());
+  }
+  EXPECT_FALSE(std::filesystem::exists(snapshot_path_));
+  EXPECT_FALSE(std::filesystem::exists(snapshot_path_ + ".tmp"));
+}
+
+}  // namespace
@@ -35,8 +35,8 @@ class SpeculativeDecoderTest : public ::testing::Test {
     // Nothing to clean up
   }
 
-  std::shared_ptr<mlxr::LlamaModel> target_model_;
-  std::shared_ptr<mlxr::LlamaModel> draft_model_;
+  std::shared_ptr<mlxr::graph::LlamaModel> target_model_;
+  std::shared_ptr<mlxr::graph::LlamaModel> draft_model_;
   SpeculativeConfig config_;
 };
 
@@ -101,4 +101,575 @@ TEST_F(SpeculativeDecoderTest, StatsMethods) {
   EXPECT_FLOAT_EQ(stats.tokens_per_attempt(), 3.5f);
 }
 
+// ============================================================================
+// Hook-driven speculation tests (scripted draft/target, no real models)
+// ============================================================================
+
+class SpeculativeHooksTest : public ::testing::Test {
+ protected:
+  static constexpr int kVocab = 16;
+
+  void SetUp() override {
+    config_.num_draft_tokens = 4;
+    config_.acceptance_window = 4;
+    config_.adaptive_length = false;
+    config_.draft_temperature = 0.0f;   // deterministic (greedy)
+    config_.target_temperature = 0.0f;  // deterministic (greedy)
+    config_.enabled = true;
+
+    decoder_ = std::make_unique<SpeculativeDecoder>(nullptr, nullptr, config_);
+  }
+
+  // Logits with a single dominant token
+  std::vector<float> one_hot(int token) {
+    std::vector<float> logits(kVocab, 0.0f);
+    logits[token] = 10.0f;
+    return logits;
+  }
+
+  /**
+   * Bind scripted hooks:
+   * - The draft proposes 1, 2, 3, ... (one per forward call)
+   * - The target's verification rows are taken from `target_predictions`
+   * Call counts and rollback arguments are recorded for assertions.
+   */
+  void bind_hooks(const std::vector<int>& target_predictions) {
+    decoder_->set_forward_hooks(
+        [this](const std::vector<int>& tokens) {
+          draft_calls_++;
+          draft_fed_ += static_cast<int>(tokens.size());
+          // Proposes 1, 2, 3, ... (wrapping keeps indices in-vocab for
+          // tests that speculate repeatedly)
+          return one_hot(draft_calls_ % kVocab);
+        },
+        [this, target_predictions](const std::vector<int>& tokens) {
+          target_fed_ += static_cast<int>(tokens.size());
+          std::vector<std::vector<float>> rows;
+          for (size_t i = 0; i < tokens.size(); i++) {
+            rows.push_back(one_hot(target_predictions[i]));
+          }
+          return rows;
+        },
+        [this](int num_tokens) { draft_rollbacks_.push_back(num_tokens); },
+        [this](int num_tokens) { target_rollbacks_.push_back(num_tokens); });
+  }
+
+  SpeculativeConfig config_;
+  std::unique_ptr<SpeculativeDecoder> decoder_;
+
+  int draft_calls_ = 0;
+  int draft_fed_ = 0;
+  int target_fed_ = 0;
+  std::vector<int> draft_rollbacks_;
+  std::vector<int> target_rollbacks_;
+};
+
+TEST_F(SpeculativeHooksTest, NoHooksReturnsEmptyResult) {
+  auto result = decoder_->speculate({10, 11}, 8);
+  EXPECT_TRUE(result.draft_tokens.empty());
+  EXPECT_EQ(result.num_accepted, 0);
+  EXPECT_FALSE(decoder_->should_speculate());
+}
+
+TEST_F(SpeculativeHooksTest, FullAcceptanceYieldsBonusToken) {
+  // Target agrees with all four drafts and predicts 5 after them
+  bind_hooks({1, 2, 3, 4, 5});
+
+  auto result = decoder_->speculate({10, 11}, 8);
+
+  EXPECT_EQ(result.draft_tokens, (std::vector<int>{1, 2, 3, 4}));
+  EXPECT_EQ(result.num_accepted, 4);
+  ASSERT_TRUE(result.bonus_token.has_value());
+  EXPECT_EQ(result.bonus_token.value(), 5);
+  EXPECT_EQ(result.total_tokens(), 5);
+
+  // No rollback on full acceptance; the draft catches up by feeding
+  // its own final token (4 propose calls + 1 catch-up)
+  EXPECT_TRUE(target_rollbacks_.empty());
+  EXPECT_TRUE(draft_rollbacks_.empty());
+  EXPECT_EQ(draft_calls_, 5);
+
+  auto stats = decoder_->get_stats();
+  EXPECT_EQ(stats.total_accepted, 4u);
+  EXPECT_EQ(stats.total_bonus, 1u);
+}
+
+TEST_F(SpeculativeHooksTest, MismatchYieldsCorrectiveToken) {
+  // Target agrees with drafts 1 and 2, then predicts 9 instead of 3
+  bind_hooks({1, 2, 9, 0, 0});
+
+  auto result = decoder_->speculate({10, 11}, 8);
+
+  EXPECT_EQ(result.num_accepted, 2);
+  EXPECT_EQ(result.accepted_tokens, (std::vector<int>{1, 2}));
+  ASSERT_TRUE(result.bonus_token.has_value());
+  EXPECT_EQ(result.bonus_token.value(), 9);  // corrective sample
+  EXPECT_EQ(result.total_tokens(), 3);
+
+  // Both caches rewind to context.size() + num_accepted fed tokens
+  // (context 2 + 2 accepted = 4), discarding the rejected positions
+  ASSERT_EQ(target_rollbacks_.size(), 1u);
+  EXPECT_EQ(target_rollbacks_[0], 4);
+  ASSERT_EQ(draft_rollbacks_.size(), 1u);
+  EXPECT_EQ(draft_rollbacks_[0], 4);
+
+  // Corrective samples are not counted as bonus tokens
+  auto stats = decoder_->get_stats();
+  EXPECT_EQ(stats.total_accepted, 2u);
+  EXPECT_EQ(stats.total_bonus, 0u);
+}
+
+TEST_F(SpeculativeHooksTest, ReservesRoomForExtraToken) {
+  bind_hooks({1, 2, 3, 4, 5});
+
+  // max_new_tokens == 1 leaves no room for a draft + extra token
+  auto result = decoder_->speculate({10, 11}, 1);
+  EXPECT_TRUE(result.draft_tokens.empty());
+  EXPECT_EQ(draft_calls_, 0);
+
+  // max_new_tokens == 3 caps proposals at 2 despite num_draft_tokens=4
+  auto result2 = decoder_->speculate({10, 11}, 3);
+  EXPECT_EQ(result2.draft_tokens.size(), 2u);
+}
+
+TEST_F(SpeculativeHooksTest, LowAcceptanceDisablesSpeculation) {
+  // Target always disagrees immediately
+  bind_hooks({9, 0, 0, 0, 0});
+
+  EXPECT_TRUE(decoder_->should_speculate());
+  for (int i = 0; i < config_.acceptance_window; i++) {
+    decoder_->speculate({10, 11}, 8);
+  }
+
+  // Rolling acceptance rate is now 0, below min_acceptance_rate
+  EXPECT_FALSE(decoder_->should_speculate());
+
+  // reset() restores the optimistic history
+  decoder_->reset();
+  EXPECT_TRUE(decoder_->should_speculate());
+}
+
+// ============================================================================
+// Prompt-lookup self-speculation tests (no draft model or draft hooks)
+// ============================================================================
+
+class PromptLookupTest : public ::testing::Test {
+ protected:
+  static constexpr int kVocab = 16;
+
+  void SetUp() override {
+    config_.proposal_mode = ProposalMode::PROMPT_LOOKUP;
+    config_.num_draft_tokens = 4;
+    config_.acceptance_window = 4;
+    config_.adaptive_length = false;
+    config_.target_temperature = 0.0f;  // deterministic (greedy)
+    config_.enabled = true;
+
+    decoder_ = std::make_unique<SpeculativeDecoder>(nullptr, nullptr, config_);
+  }
+
+  // Logits with a single dominant token
+  std::vector<float> one_hot(int token) {
+    std::vector<float> logits(kVocab, 0.0f);
+    logits[token] = 10.0f;
+    return logits;
+  }
+
+  /**
+   * Bind only the target-side hooks; lookup mode proposes from the
+   * sequence itself, so the draft hooks stay null.
+   */
+  void bind_target(const std::vector<int>& target_predictions) {
+    decoder_->set_forward_hooks(
+        nullptr,
+        [this, target_predictions](const std::vector<int>& tokens) {
+          target_calls_++;
+          std::vector<std::vector<float>> rows;
+          for (size_t i = 0; i < tokens.size(); i++) {
+            rows.push_back(one_hot(target_predictions[i]));
+          }
+          return rows;
+        },
+        nullptr,
+        [this](int num_tokens) { target_rollbacks_.push_back(num_tokens); });
+  }
+
+  SpeculativeConfig config_;
+  std::unique_ptr<SpeculativeDecoder> decoder_;
+
+  int target_calls_ = 0;
+  std::vector<int> target_rollbacks_;
+};
+
+TEST_F(PromptLookupTest, SpeculatesWithoutDraftHooks) {
+  bind_target({0, 0, 0, 0, 0});
+  EXPECT_TRUE(decoder_->should_speculate());
+}
+
+TEST_F(PromptLookupTest, ProposesContinuationOfRepeatedNgram) {
+  // Suffix {1, 2, 3} occurred at the start of the context; the span
+  // that followed it is {4, 5, 1, 2}. Target agrees with all four and
+  // predicts 6 after them
+  bind_target({4, 5, 1, 2, 6});
+
+  auto result = decoder_->speculate({1, 2, 3, 4, 5, 1, 2, 3}, 16);
+
+  EXPECT_EQ(result.draft_tokens, (std::vector<int>{4, 5, 1, 2}));
+  EXPECT_EQ(result.num_accepted, 4);
+  ASSERT_TRUE(result.bonus_token.has_value());
+  EXPECT_EQ(result.bonus_token.value(), 6);
+  EXPECT_TRUE(target_rollbacks_.empty());
+}
+
+TEST_F(PromptLookupTest, MostRecentMatchWins) {
+  // Suffix {1, 2} occurs at positions 0 and 3; the more recent match
+  // (followed by {6, 1, 2}) is preferred over the older one (followed
+  // by 5). Only three tokens remain after the match, clipping the
+  // proposal below num_draft_tokens
+  bind_target({6, 1, 2, 9});
+
+  auto result = decoder_->speculate({1, 2, 5, 1, 2, 6, 1, 2}, 16);
+
+  EXPECT_EQ(result.draft_tokens, (std::vector<int>{6, 1, 2}));
+  EXPECT_EQ(result.num_accepted, 3);
+}
+
+TEST_F(PromptLookupTest, NoMatchReturnsEmptyResult) {
+  bind_target({0, 0, 0, 0, 0});
+
+  // No token repeats, so even the 1-gram backoff finds nothing
+  auto result = decoder_->speculate({1, 2, 3, 4, 5}, 16);
+
+  EXPECT_TRUE(result.draft_tokens.empty());
+  EXPECT_EQ(result.total_tokens(), 0);
+  EXPECT_EQ(target_calls_, 0);  // nothing was verified
+}
+
+TEST_F(PromptLookupTest, MismatchRollsBackTargetOnly) {
+  // Target agrees with the first proposal, then predicts 9
+  bind_target({4, 9, 0, 0, 0});
+
+  auto result = decoder_->speculate({1, 2, 3, 4, 5, 1, 2, 3}, 16);
+
+  EXPECT_EQ(result.num_accepted, 1);
+  ASSERT_TRUE(result.bonus_token.has_value());
+  EXPECT_EQ(result.bonus_token.value(), 9);
+
+  // Target rewinds to context 8 - 1 + 1 fed + 1 accepted = 9 tokens;
+  // there is no draft cache to roll back in lookup mode
+  ASSERT_EQ(target_rollbacks_.size(), 1u);
+  EXPECT_EQ(target_rollbacks_[0], 9);
+}
+
+// ============================================================================
+// Tree speculation tests (alternate branches at uncertain positions)
+// ============================================================================
+
+class TreeSpeculationTest : public ::testing::Test {
+ protected:
+  static constexpr int kVocab = 16;
+
+  void SetUp() override {
+    config_.num_draft_tokens = 4;
+    config_.acceptance_window = 4;
+    config_.adaptive_length = false;
+    config_.draft_temperature = 0.0f;   // deterministic (greedy)
+    config_.target_temperature = 0.0f;  // deterministic (greedy)
+    config_.enable_tree = true;
+    config_.tree_branch_factor = 2;
+    config_.tree_branch_threshold = 0.5f;
+    config_.tree_max_nodes = 12;
+    config_.enabled = true;
+
+    decoder_ = std::make_unique<SpeculativeDecoder>(nullptr, nullptr, config_);
+  }
+
+  // Logits with a single dominant token (top-1 prob ~1, never branches)
+  std::vector<float> one_hot(int token) {
+    std::vector<float> logits(kVocab, 0.0f);
+    logits[token] = 10.0f;
+    return logits;
+  }
+
+  // Logits splitting the mass between two tokens (top-1 prob ~0.48,
+  // below the branch threshold). Greedy sampling breaks the tie toward
+  // the lower index, so pass primary < alternate
+  std::vector<float> two_way(int primary, int alternate) {
+    std::vector<float> logits(kVocab, 0.0f);
+    logits[primary] = 5.0f;
+    logits[alternate] = 5.0f;
+    return logits;
+  }
+
+  /**
+   * Bind scripted hooks:
+   * - The draft returns one scripted logits row per forward call (the
+   *   catch-up/re-sync feeds past the script get one_hot(0))
+   * - The target consumes `target_predictions` across calls, one entry
+   *   per fed token, so the verification rows and any follow-up
+   *   alternate feed draw from the same sequence
+   */
+  void bind_hooks(std::vector<std::vector<float>> draft_script,
+                  std::vector<int> target_predictions) {
+    draft_script_ = std::move(draft_script);
+    target_predictions_ = std::move(target_predictions);
+    decoder_->set_forward_hooks(
+        [this](const std::vector<int>& tokens) {
+          draft_fed_ += static_cast<int>(tokens.size());
+          if (draft_cursor_ >= draft_script_.size()) {
+            return one_hot(0);
+          }
+          return draft_script_[draft_cursor_++];
+        },
+        [this](const std::vector<int>& tokens) {
+          target_calls_++;
+          std::vector<std::vector<float>> rows;
+          for (size_t i = 0; i < tokens.size(); i++) {
+            int prediction = 0;
+            if (target_cursor_ < target_predictions_.size()) {
+              prediction = target_predictions_[target_cursor_++];
+            }
+            rows.push_back(one_hot(prediction));
+          }
+          return rows;
+        },
+        [this](int num_tokens) { draft_rollbacks_.push_back(num_tokens); },
+        [this](int num_tokens) { target_rollbacks_.push_back(num_tokens); });
+  }
+
+  SpeculativeConfig config_;
+  std::unique_ptr<SpeculativeDecoder> decoder_;
+
+  std::vector<std::vector<float>> draft_script_;
+  std::vector<int> target_predictions_;
+  size_t draft_cursor_ = 0;
+  size_t target_cursor_ = 0;
+  int draft_fed_ = 0;
+  int target_calls_ = 0;
+  std::vector<int> draft_rollbacks_;
+  std::vector<int> target_rollbacks_;
+};
+
+TEST_F(TreeSpeculationTest, AlternateAcceptedAtUncertainPosition) {
+  // Position 1 is uncertain: the draft splits between 2 (primary) and 7
+  // (alternate). The target rejects 2 but picks exactly 7, then
+  // predicts 9 after it - linear verification would have stopped with
+  // a corrective token at position 1
+  bind_hooks({one_hot(1), two_way(2, 7), one_hot(3), one_hot(4)},
+             {1, 7, 8, 8, 8, /* after the alternate: */ 9});
+
+  auto result = decoder_->speculate({10, 11}, 16);
+
+  EXPECT_EQ(result.draft_tokens, (std::vector<int>{1, 2, 3, 4}));
+  EXPECT_EQ(result.accepted_tokens, (std::vector<int>{1, 7}));
+  EXPECT_EQ(result.num_accepted, 2);
+  ASSERT_TRUE(result.bonus_token.has_value());
+  EXPECT_EQ(result.bonus_token.value(), 9);
+  EXPECT_EQ(result.total_tokens(), 3);
+
+  // Both caches rewind past the rejected suffix to context + 1 accepted
+  // primary (3 fed tokens), then the alternate is fed to rebuild linear
+  // KV - its row supplied the extra token above
+  ASSERT_EQ(target_rollbacks_.size(), 1u);
+  EXPECT_EQ(target_rollbacks_[0], 3);
+  ASSERT_EQ(draft_rollbacks_.size(), 1u);
+  EXPECT_EQ(draft_rollbacks_[0], 3);
+  EXPECT_EQ(target_calls_, 2);
+
+  auto stats = decoder_->get_stats();
+  EXPECT_EQ(stats.total_branch_positions, 1u);
+  EXPECT_EQ(stats.total_alternate_accepts, 1u);
+  EXPECT_EQ(stats.total_bonus, 0u);  // the extra token is not a bonus
+}
+
+TEST_F(TreeSpeculationTest, ConfidentDraftNeverBranches) {
+  // All positions are one-hot certain: no alternates are proposed and
+  // a mismatch behaves exactly like linear verification
+  bind_hooks({one_hot(1), one_hot(2), one_hot(3), one_hot(4)},
+             {1, 9, 0, 0, 0});
+
+  auto result = decoder_->speculate({10, 11}, 16);
+
+  EXPECT_EQ(result.accepted_tokens, (std::vector<int>{1}));
+  ASSERT_TRUE(result.bonus_token.has_value());
+  EXPECT_EQ(result.bonus_token.value(), 9);  // corrective sample
+  EXPECT_EQ(target_calls_, 1);
+
+  auto stats = decoder_->get_stats();
+  EXPECT_EQ(stats.total_branch_positions, 0u);
+  EXPECT_EQ(stats.total_alternate_accepts, 0u);
+}
+
+TEST_F(TreeSpeculationTest, MismatchOutsideTreeYieldsCorrectiveToken) {
+  // Position 1 branches to alternate 7, but the target picks 9 -
+  // neither the primary nor any alternate - so the step falls back to
+  // the standard corrective sample
+  bind_hooks({one_hot(1), two_way(2, 7), one_hot(3), one_hot(4)},
+             {1, 9, 0, 0, 0});
+
+  auto result = decoder_->speculate({10, 11}, 16);
+
+  EXPECT_EQ(result.accepted_tokens, (std::vector<int>{1}));
+  ASSERT_TRUE(result.bonus_token.has_value());
+  EXPECT_EQ(result.bonus_token.value(), 9);
+  ASSERT_EQ(target_rollbacks_.size(), 1u);
+  EXPECT_EQ(target_rollbacks_[0], 3);
+
+  auto stats = decoder_->get_stats();
+  EXPECT_EQ(stats.total_branch_positions, 1u);
+  EXPECT_EQ(stats.total_alternate_accepts, 0u);
+}
+
+TEST_F(TreeSpeculationTest, NodeBudgetCapsAlternates) {
+  // tree_max_nodes == num_draft_tokens leaves no budget for alternate
+  // leaves, so even uncertain positions stay linear and the alternate
+  // token the target picks gets rejected
+  config_.tree_max_nodes = 4;
+  decoder_->update_config(config_);
+
+  bind_hooks({one_hot(1), two_way(2, 7), one_hot(3), one_hot(4)},
+             {1, 7, 0, 0, 0});
+
+  auto result = decoder_->speculate({10, 11}, 16);
+
+  EXPECT_EQ(result.accepted_tokens, (std::vector<int>{1}));
+  ASSERT_TRUE(result.bonus_token.has_value());
+  EXPECT_EQ(result.bonus_token.value(), 7);  // corrective, not accepted path
+
+  auto stats = decoder_->get_stats();
+  EXPECT_EQ(stats.total_branch_positions, 0u);
+}
+
+TEST_F(TreeSpeculationTest, FullPrimaryAcceptanceStillYieldsBonus) {
+  // Alternates exist but the target agrees with the whole primary
+  // chain: behavior matches linear full acceptance, bonus included
+  bind_hooks({one_hot(1), two_way(2, 7), one_hot(3), one_hot(4)},
+             {1, 2, 3, 4, 5});
+
+  auto result = decoder_->speculate({10, 11}, 16);
+
+  EXPECT_EQ(result.accepted_tokens, (std::vector<int>{1, 2, 3, 4}));
+  ASSERT_TRUE(result.bonus_token.has_value());
+  EXPECT_EQ(result.bonus_token.value(), 5);
+  EXPECT_TRUE(target_rollbacks_.empty());
+  EXPECT_TRUE(draft_rollbacks_.empty());
+
+  auto stats = decoder_->get_stats();
+  EXPECT_EQ(stats.total_bonus, 1u);
+  EXPECT_EQ(stats.total_branch_positions, 1u);
+  EXPECT_EQ(stats.total_alternate_accepts, 0u);
+}
+
+// ============================================================================
+// Adaptive speculation-length controller tests
+// ============================================================================
+
+class AdaptiveLengthTest : public ::testing::Test {
+ protected:
+  static constexpr int kVocab = 16;
+
+  void SetUp() override {
+    config_.num_draft_tokens = 2;
+    config_.max_draft_tokens = 4;
+    config_.acceptance_window = 2;
+    config_.adaptive_length = true;
+    config_.min_acceptance_rate = 0.0f;  // never disable; test lengths only
+    config_.draft_temperature = 0.0f;
+    config_.target_temperature = 0.0f;
+    config_.enabled = true;
+
+    decoder_ = std::make_unique<SpeculativeDecoder>(nullptr, nullptr, config_);
+  }
+
+  // Logits with a single dominant token
+  std::vector<float> one_hot(int token) {
+    std::vector<float> logits(kVocab, 0.0f);
+    logits[token] = 10.0f;
+    return logits;
+  }
+
+  /**
+   * Bind hooks where the target either echoes agreement with every
+   * draft token (agree=true, full acceptance every attempt) or rejects
+   * the first one (agree=false, zero acceptance every attempt).
+   */
+  void bind_hooks(bool agree) {
+    decoder_->set_forward_hooks(
+        [this](const std::vector<int>& tokens) {
+          (void)tokens;
+          draft_calls_++;
+          return one_hot(draft_calls_ % kVocab);
+        },
+        [this, agree](const std::vector<int>& tokens) {
+          std::vector<std::vector<float>> rows;
+          for (size_t i = 0; i < tokens.size(); i++) {
+            // Row i is the prediction after feeding tokens[i]; agreeing
+            // means predicting the next verify-chunk entry
+            int next = (i + 1 < tokens.size()) ? tokens[i + 1] : 0;
+            rows.push_back(one_hot(agree ? next : (next + 1) % kVocab));
+          }
+          return rows;
+        },
+        [](int) {}, [](int) {});
+  }
+
+  SpeculativeConfig config_;
+  std::unique_ptr<SpeculativeDecoder> decoder_;
+  int draft_calls_ = 0;
+};
+
+TEST_F(AdaptiveLengthTest, GrowsTowardCeilingOnHighAcceptance) {
+  bind_hooks(true);
+  EXPECT_EQ(decoder_->current_draft_length(), 2);
+
+  decoder_->speculate({10, 11}, 32);
+  EXPECT_EQ(decoder_->current_draft_length(), 3);
+  decoder_->speculate({10, 11}, 32);
+  EXPECT_EQ(decoder_->current_draft_length(), 4);
+
+  // Capped at max_draft_tokens, not num_draft_tokens
+  decoder_->speculate({10, 11}, 32);
+  EXPECT_EQ(decoder_->current_draft_length(), 4);
+}
+
+TEST_F(AdaptiveLengthTest, CollapsesToOneWhenDraftDiverges) {
+  config_.num_draft_tokens = 4;
+  decoder_->update_config(config_);
+  bind_hooks(false);
+
+  // First failure only drags the rolling rate to 0.5: gradual back-off
+  decoder_->speculate({10, 11}, 32);
+  EXPECT_EQ(decoder_->current_draft_length(), 3);
+
+  // Window saturates at 0: collapse straight to k=1, skipping 2
+  decoder_->speculate({10, 11}, 32);
+  EXPECT_EQ(decoder_->current_draft_length(), 1);
+}
+
+TEST_F(AdaptiveLengthTest, RecoversAfterWindowHeals) {
+  config_.num_draft_tokens = 4;
+  decoder_->update_config(config_);
+  bind_hooks(false);
+  decoder_->speculate({10, 11}, 32);
+  decoder_->speculate({10, 11}, 32);
+  ASSERT_EQ(decoder_->current_draft_length(), 1);
+
+  // Acceptance returns; k climbs back once the rolling window clears
+  bind_hooks(true);
+  decoder_->speculate({10, 11}, 32);
+  EXPECT_EQ(decoder_->current_draft_length(), 1);  // window still half bad
+  decoder_->speculate({10, 11}, 32);
+  EXPECT_EQ(decoder_->current_draft_length(), 2);
+}
+
+TEST_F(AdaptiveLengthTest, DisabledControllerKeepsConfiguredLength) {
+  config_.adaptive_length = false;
+  decoder_->update_config(config_);
+  bind_hooks(false);
+
+  decoder_->speculate({10, 11}, 32);
+  decoder_->speculate({10, 11}, 32);
+  EXPECT_EQ(decoder_->current_draft_length(), 2);
+}
+
 }  // namespace
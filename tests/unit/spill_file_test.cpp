@@ -0,0 +1,139 @@
+// Copyright © 2025 MLXR Development
+// KV spill file unit tests
+
+#include "runtime/kv/spill_file.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+using namespace mlxr;
+using namespace mlxr::runtime::kv;
+
+namespace {
+
+class SpillFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    spill_path_ = "/tmp/mlxr_spill_test.bin";
+    std::filesystem::remove(spill_path_);
+
+    // Small arena config so test blocks stay cheap
+    arena_config_.num_layers = 2;
+    arena_config_.block_size_tokens = 4;
+    arena_config_.num_kv_heads = 2;
+    arena_config_.head_dim = 8;
+    arena_config_.dtype = mlx::core::float16;
+  }
+
+  void TearDown() override { std::filesystem::remove(spill_path_); }
+
+  size_t block_bytes() const {
+    return 2ULL * arena_config_.num_layers * arena_config_.block_size_tokens *
+           arena_config_.num_kv_heads * arena_config_.head_dim *
+           mlx::core::size_of(arena_config_.dtype);
+  }
+
+  SpillFileConfig make_config() const {
+    SpillFileConfig config;
+    config.path = spill_path_;
+    config.block_bytes = block_bytes();
+    config.initial_slots = 2;
+    return config;
+  }
+
+  std::string spill_path_;
+  ArenaConfig arena_config_;
+};
+
+// Test construction creates and maps the file
+TEST_F(SpillFileTest, Initialization) {
+  SpillFile spill(make_config());
+  EXPECT_TRUE(std::filesystem::exists(spill_path_));
+  EXPECT_GE(spill.slot_bytes(), block_bytes());
+
+  auto stats = spill.get_stats();
+  EXPECT_EQ(stats.slots_in_use, 0);
+  EXPECT_GE(stats.slots_total, 2);
+}
+
+// Test zero block_bytes is rejected
+TEST_F(SpillFileTest, RejectsZeroBlockBytes) {
+  SpillFileConfig config = make_config();
+  config.block_bytes = 0;
+  EXPECT_THROW(SpillFile spill(config), std::invalid_argument);
+}
+
+// Test spill and fault round-trips block data
+TEST_F(SpillFileTest, SpillAndFaultRoundTrip) {
+  SpillFile spill(make_config());
+
+  Block source(0, /*location=*/1, arena_config_);
+  source.k_data = graph::Tensor(mlx::core::full(
+      {arena_config_.num_layers, arena_config_.block_size_tokens,
+       arena_config_.num_kv_heads, arena_config_.head_dim},
+      1.5f, arena_config_.dtype));
+  source.v_data = graph::Tensor(mlx::core::full(
+      {arena_config_.num_layers, arena_config_.block_size_tokens,
+       arena_config_.num_kv_heads, arena_config_.head_dim},
+      -2.0f, arena_config_.dtype));
+
+  int slot = spill.spill_block(source);
+  ASSERT_GE(slot, 0);
+
+  // Fault into a freshly zeroed block
+  Block dest(1, /*location=*/1, arena_config_);
+  ASSERT_TRUE(spill.fault_block(slot, &dest));
+
+  auto k = mlx::core::astype(dest.k_data.array(), mlx::core::float32);
+  auto v = mlx::core::astype(dest.v_data.array(), mlx::core::float32);
+  mlx::core::eval(k);
+  mlx::core::eval(v);
+
+  EXPECT_FLOAT_EQ(k.data<float>()[0], 1.5f);
+  EXPECT_FLOAT_EQ(v.data<float>()[0], -2.0f);
+
+  auto stats = spill.get_stats();
+  EXPECT_EQ(stats.blocks_spilled, 1u);
+  EXPECT_EQ(stats.blocks_faulted, 1u);
+}
+
+// Test released slots are reused
+TEST_F(SpillFileTest, SlotReuse) {
+  SpillFile spill(make_config());
+
+  Block block(0, /*location=*/1, arena_config_);
+
+  int first = spill.spill_block(block);
+  ASSERT_GE(first, 0);
+  spill.release_slot(first);
+
+  int second = spill.spill_block(block);
+  EXPECT_EQ(second, first);
+}
+
+// Test fault on invalid slot fails
+TEST_F(SpillFileTest, FaultInvalidSlot) {
+  SpillFile spill(make_config());
+
+  Block block(0, /*location=*/1, arena_config_);
+  EXPECT_FALSE(spill.fault_block(-1, &block));
+  EXPECT_FALSE(spill.fault_block(9999, &block));
+  EXPECT_FALSE(spill.fault_block(0, nullptr));
+}
+
+// Test file grows beyond initial slot count
+TEST_F(SpillFileTest, GrowsBeyondInitialSlots) {
+  SpillFile spill(make_config());
+
+  Block block(0, /*location=*/1, arena_config_);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_GE(spill.spill_block(block), 0);
+  }
+
+  auto stats = spill.get_stats();
+  EXPECT_EQ(stats.slots_in_use, 8);
+  EXPECT_GE(stats.slots_total, 8);
+}
+
+}  // namespace
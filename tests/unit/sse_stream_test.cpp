@@ -322,6 +322,61 @@ TEST_F(SSEStreamTest, ChatFormatterFinish) {
   EXPECT_TRUE(chunk.find("\"delta\":{}") != std::string::npos);
 }
 
+TEST_F(SSEStreamTest, ChatFormatterFinishWithTimings) {
+  ChatCompletionStreamFormatter formatter("req-123", "llama-7b");
+
+  std::string chunk = formatter.format_finish(
+      "stop", "{\"queue_ms\":1.25,\"decode_ms\":80.00}");
+
+  EXPECT_TRUE(chunk.find("\"finish_reason\":\"stop\"") != std::string::npos);
+  EXPECT_TRUE(
+      chunk.find("\"timings\":{\"queue_ms\":1.25,\"decode_ms\":80.00}") !=
+      std::string::npos);
+
+  // Without timings the chunk stays unchanged
+  EXPECT_TRUE(formatter.format_finish("stop").find("timings") ==
+              std::string::npos);
+}
+
+TEST_F(SSEStreamTest, ChatFormatterContentWithLogprobs) {
+  ChatCompletionStreamFormatter formatter("req-123", "llama-7b");
+
+  std::string chunk = formatter.format_content_with_logprobs(
+      "Hello", -0.25f, {{"Hello", -0.25f}, {"Hi", -1.5f}});
+
+  EXPECT_TRUE(chunk.find("\"content\":\"Hello\"") != std::string::npos);
+  EXPECT_TRUE(chunk.find("\"logprobs\":{\"content\":[{") != std::string::npos);
+  EXPECT_TRUE(chunk.find("\"token\":\"Hello\",\"logprob\":-0.25") !=
+              std::string::npos);
+  // Alternatives emitted in the given (best-first) order
+  size_t first = chunk.find("\"token\":\"Hello\",\"logprob\":-0.25",
+                            chunk.find("top_logprobs"));
+  size_t second = chunk.find("\"token\":\"Hi\",\"logprob\":-1.5");
+  EXPECT_TRUE(first != std::string::npos);
+  EXPECT_TRUE(second != std::string::npos);
+  EXPECT_LT(first, second);
+  EXPECT_TRUE(chunk.find("\"finish_reason\":null") != std::string::npos);
+}
+
+TEST_F(SSEStreamTest, ChatFormatterLogprobsEmptyAlternatives) {
+  ChatCompletionStreamFormatter formatter("req-123", "llama-7b");
+
+  std::string chunk = formatter.format_content_with_logprobs("x", -2.0f, {});
+
+  EXPECT_TRUE(chunk.find("\"top_logprobs\":[]") != std::string::npos);
+  EXPECT_TRUE(chunk.find("\"logprob\":-2") != std::string::npos);
+}
+
+TEST_F(SSEStreamTest, ChatFormatterLogprobsEscapesTokenText) {
+  ChatCompletionStreamFormatter formatter("req-123", "llama-7b");
+
+  std::string chunk = formatter.format_content_with_logprobs(
+      "\"quote\"", -0.5f, {{"\n", -3.0f}});
+
+  EXPECT_TRUE(chunk.find("\"token\":\"\\\"quote\\\"\"") != std::string::npos);
+  EXPECT_TRUE(chunk.find("\"token\":\"\\n\"") != std::string::npos);
+}
+
 TEST_F(SSEStreamTest, ChatFormatterFunctionCall) {
   ChatCompletionStreamFormatter formatter("req-123", "llama-7b");
 
@@ -391,4 +446,314 @@ TEST_F(SSEStreamTest, EscapeJsonTab) {
   EXPECT_EQ(result, "Column1\\tColumn2");
 }
 
+TEST_F(SSEStreamTest, EscapeJsonIntoAppends) {
+  std::string buffer = "prefix:";
+  escape_json_into("a\"b", buffer);
+  EXPECT_EQ(buffer, "prefix:a\\\"b");
+}
+
+TEST_F(SSEStreamTest, EscapeJsonControlCharacter) {
+  std::string result = escape_json(std::string("a\x01z", 3));
+  EXPECT_EQ(result, "a\\u0001z");
+}
+
+// ==============================================================================
+// Pooled Frame Emission Tests
+// ==============================================================================
+
+TEST_F(SSEStreamTest, ChatFormatterContentFrameMatchesSlowPath) {
+  ChatCompletionStreamFormatter formatter("req-123", "test-model");
+
+  // The fast path must put the same bytes on the wire as
+  // send_data(format_content(...)) did
+  std::string expected =
+      "data: " + formatter.format_content("Hello \"world\"") + "\n\n";
+  const std::string& frame = formatter.format_content_frame("Hello \"world\"");
+  EXPECT_EQ(frame, expected);
+}
+
+TEST_F(SSEStreamTest, ChatFormatterContentFrameReusesBuffer) {
+  ChatCompletionStreamFormatter formatter("req-123", "test-model");
+
+  const std::string& first = formatter.format_content_frame("one");
+  const char* data_ptr = first.data();
+  size_t capacity = first.capacity();
+
+  // A second token of similar size must not reallocate the buffer
+  const std::string& second = formatter.format_content_frame("two");
+  EXPECT_EQ(second.data(), data_ptr);
+  EXPECT_EQ(second.capacity(), capacity);
+  EXPECT_TRUE(second.find("\"content\":\"two\"") != std::string::npos);
+}
+
+TEST_F(SSEStreamTest, CompletionFormatterTextFrameMatchesSlowPath) {
+  CompletionStreamFormatter formatter("req-456", "test-model");
+
+  std::string expected = "data: " + formatter.format_text("chunk\n") + "\n\n";
+  const std::string& frame = formatter.format_text_frame("chunk\n");
+  EXPECT_EQ(frame, expected);
+}
+
+TEST_F(SSEStreamTest, SendFramePassesBytesThrough) {
+  auto stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  EXPECT_TRUE(stream->send_frame("data: {\"x\":1}\n\n"));
+  EXPECT_EQ(callback_called, 1);
+  EXPECT_EQ(received_events[0], "data: {\"x\":1}\n\n");
+  EXPECT_EQ(stream->event_count(), 1u);
+}
+
+TEST_F(SSEStreamTest, FlushFramesCoalescesIntoOneWrite) {
+  auto stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  stream->queue_frame("data: one\n\n");
+  stream->queue_frame("data: two\n\n");
+  stream->queue_frame("data: three\n\n");
+
+  EXPECT_TRUE(stream->flush_frames());
+  EXPECT_EQ(callback_called, 1);  // single transport write
+  EXPECT_EQ(received_events[0], "data: one\n\ndata: two\n\ndata: three\n\n");
+  EXPECT_EQ(stream->event_count(), 3u);
+
+  // Empty flush is a no-op
+  EXPECT_TRUE(stream->flush_frames());
+  EXPECT_EQ(callback_called, 1);
+}
+
+TEST_F(SSEStreamTest, FlushFramesFailureClosesStream) {
+  auto stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  stream->queue_frame("data: one\n\n");
+  callback_should_fail = true;
+
+  EXPECT_FALSE(stream->flush_frames());
+  EXPECT_FALSE(stream->is_open());
+}
+
+// ==============================================================================
+// Disconnect Handler Tests
+// ==============================================================================
+
+TEST_F(SSEStreamTest, DisconnectHandlerFiresOnFirstFailedWrite) {
+  auto stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  int disconnects = 0;
+  stream->set_disconnect_handler([&]() { disconnects++; });
+
+  EXPECT_TRUE(stream->send_data("alive"));
+  EXPECT_EQ(disconnects, 0);
+
+  callback_should_fail = true;
+  EXPECT_FALSE(stream->send_data("client gone"));
+  EXPECT_EQ(disconnects, 1);
+  EXPECT_FALSE(stream->is_open());
+}
+
+TEST_F(SSEStreamTest, DisconnectHandlerFiresAtMostOnce) {
+  auto stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  int disconnects = 0;
+  stream->set_disconnect_handler([&]() { disconnects++; });
+
+  callback_should_fail = true;
+  EXPECT_FALSE(stream->send_data("first failure"));
+
+  // Later sends short-circuit on closed_ and must not re-fire
+  EXPECT_FALSE(stream->send_data("after close"));
+  EXPECT_FALSE(stream->send_comment("ping"));
+  EXPECT_FALSE(stream->flush_frames());
+  EXPECT_EQ(disconnects, 1);
+}
+
+TEST_F(SSEStreamTest, DisconnectHandlerFiresFromFlushFailure) {
+  auto stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  int disconnects = 0;
+  stream->set_disconnect_handler([&]() { disconnects++; });
+
+  stream->queue_frame("data: one\n\n");
+  callback_should_fail = true;
+  EXPECT_FALSE(stream->flush_frames());
+  EXPECT_EQ(disconnects, 1);
+}
+
+TEST_F(SSEStreamTest, CloseDoesNotFireDisconnectHandler) {
+  int disconnects = 0;
+  {
+    SSEStream stream(
+        [this](const std::string& event) { return test_callback(event); });
+    stream.set_disconnect_handler([&]() { disconnects++; });
+    stream.send_data("ok");
+    stream.close();
+  }  // destructor also calls close()
+
+  EXPECT_EQ(disconnects, 0);
+}
+
+TEST_F(SSEStreamTest, DisconnectHandlerMayReenterStream) {
+  // The handler runs outside the stream's lock, so wiring it to code
+  // that touches the stream again (or the scheduler) must not deadlock
+  std::shared_ptr<SSEStream> stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  bool reentered = false;
+  stream->set_disconnect_handler([&]() {
+    EXPECT_FALSE(stream->send_data("from handler"));
+    reentered = true;
+  });
+
+  callback_should_fail = true;
+  EXPECT_FALSE(stream->send_data("trigger"));
+  EXPECT_TRUE(reentered);
+}
+
+// ==============================================================================
+// Adaptive Flush Scheduling Tests
+// ==============================================================================
+
+TEST_F(SSEStreamTest, CoalesceWindowZeroForSoloStream) {
+  SSEFlushConfig config;
+  EXPECT_EQ(coalesce_window_ms(1, config), 0);
+  EXPECT_EQ(coalesce_window_ms(0, config), 0);
+}
+
+TEST_F(SSEStreamTest, CoalesceWindowRampsWithFanout) {
+  SSEFlushConfig config;
+  config.max_window_ms = 20;
+  config.saturation_streams = 32;
+
+  int mid = coalesce_window_ms(16, config);
+  EXPECT_GT(mid, 0);
+  EXPECT_LT(mid, 20);
+
+  // Caps at the max from saturation onward
+  EXPECT_EQ(coalesce_window_ms(32, config), 20);
+  EXPECT_EQ(coalesce_window_ms(100, config), 20);
+}
+
+TEST_F(SSEStreamTest, CoalesceWindowHonorsOverride) {
+  SSEFlushConfig config;
+  config.max_window_ms = 20;
+  config.override_window_ms = 0;
+  EXPECT_EQ(coalesce_window_ms(100, config), 0);
+
+  config.override_window_ms = 5;
+  EXPECT_EQ(coalesce_window_ms(100, config), 5);
+  EXPECT_EQ(coalesce_window_ms(1, config), 5);
+}
+
+TEST_F(SSEStreamTest, CoalesceWindowDisabledWhenMaxIsZero) {
+  SSEFlushConfig config;
+  config.max_window_ms = 0;
+  EXPECT_EQ(coalesce_window_ms(100, config), 0);
+}
+
+TEST_F(SSEStreamTest, SubmitFrameFlushesImmediatelyWhenAlone) {
+  auto stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  std::atomic<int> active{1};
+  stream->configure_flush(SSEFlushConfig{}, &active);
+
+  EXPECT_TRUE(stream->submit_frame("data: one\n\n"));
+  EXPECT_EQ(callback_called, 1);
+  EXPECT_TRUE(stream->submit_frame("data: two\n\n"));
+  EXPECT_EQ(callback_called, 2);
+}
+
+TEST_F(SSEStreamTest, SubmitFrameCoalescesUnderFanout) {
+  auto stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  // High fan-out and a generous window: tokens defer until the window
+  // elapses
+  std::atomic<int> active{100};
+  SSEFlushConfig config;
+  config.max_window_ms = 1000;
+  stream->configure_flush(config, &active);
+
+  EXPECT_TRUE(stream->submit_frame("data: one\n\n"));
+  EXPECT_TRUE(stream->submit_frame("data: two\n\n"));
+  EXPECT_EQ(callback_called, 0);  // both still pending
+
+  EXPECT_TRUE(stream->flush_frames());
+  EXPECT_EQ(callback_called, 1);  // one coalesced write
+  EXPECT_EQ(received_events[0], "data: one\n\ndata: two\n\n");
+  EXPECT_EQ(stream->event_count(), 2u);
+}
+
+TEST_F(SSEStreamTest, SubmitFrameFlushesWhenWindowElapses) {
+  auto stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  std::atomic<int> active{100};
+  SSEFlushConfig config;
+  config.max_window_ms = 5;
+  config.saturation_streams = 2;  // already saturated: full 5ms window
+  stream->configure_flush(config, &active);
+
+  EXPECT_TRUE(stream->submit_frame("data: one\n\n"));
+  EXPECT_EQ(callback_called, 0);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  // Next token finds the window elapsed and carries the batch out
+  EXPECT_TRUE(stream->submit_frame("data: two\n\n"));
+  EXPECT_EQ(callback_called, 1);
+  EXPECT_EQ(received_events[0], "data: one\n\ndata: two\n\n");
+}
+
+TEST_F(SSEStreamTest, SubmitFrameFlushesWhenBufferFull) {
+  auto stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  std::atomic<int> active{100};
+  SSEFlushConfig config;
+  config.max_window_ms = 1000;
+  config.max_pending_frames = 3;
+  stream->configure_flush(config, &active);
+
+  EXPECT_TRUE(stream->submit_frame("data: 1\n\n"));
+  EXPECT_TRUE(stream->submit_frame("data: 2\n\n"));
+  EXPECT_EQ(callback_called, 0);
+  EXPECT_TRUE(stream->submit_frame("data: 3\n\n"));
+  EXPECT_EQ(callback_called, 1);  // hit max_pending_frames
+  EXPECT_EQ(received_events[0], "data: 1\n\ndata: 2\n\ndata: 3\n\n");
+}
+
+TEST_F(SSEStreamTest, PendingFramesFlushAheadOfDirectSends) {
+  auto stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  std::atomic<int> active{100};
+  SSEFlushConfig config;
+  config.max_window_ms = 1000;
+  stream->configure_flush(config, &active);
+
+  EXPECT_TRUE(stream->submit_frame("data: token\n\n"));
+  EXPECT_EQ(callback_called, 0);
+
+  // The [DONE] marker must not overtake the buffered token: both go
+  // out in one ordered write
+  stream->send_done();
+  EXPECT_EQ(callback_called, 1);
+  EXPECT_EQ(received_events[0], "data: token\n\ndata: [DONE]\n\n");
+}
+
+TEST_F(SSEStreamTest, SubmitFrameFailureClosesStream) {
+  auto stream = std::make_shared<SSEStream>(
+      [this](const std::string& event) { return test_callback(event); });
+
+  // No configure_flush: treated as solo, flushes (and fails) at once
+  callback_should_fail = true;
+  EXPECT_FALSE(stream->submit_frame("data: one\n\n"));
+  EXPECT_FALSE(stream->is_open());
+}
+
 }  // namespace
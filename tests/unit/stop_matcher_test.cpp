@@ -0,0 +1,154 @@
+// Copyright © 2025 MLXR Development
+// Unit tests for incremental Aho-Corasick stop-sequence matching
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "runtime/stop_matcher.h"
+
+namespace mlxr {
+namespace runtime {
+namespace test {
+
+class StopMatcherTest : public ::testing::Test {
+ protected:
+  // Feed text in chunks and return (matched, released-text)
+  static std::pair<bool, std::string> feed_all(
+      StopSequenceMatcher& matcher, const std::vector<std::string>& chunks) {
+    std::string released;
+    for (const auto& chunk : chunks) {
+      if (matcher.feed(chunk, &released)) {
+        return {true, released};
+      }
+    }
+    released += matcher.flush();
+    return {false, released};
+  }
+};
+
+TEST_F(StopMatcherTest, NoPatternsPassesEverythingThrough) {
+  StopSequenceMatcher matcher({});
+  EXPECT_TRUE(matcher.empty());
+
+  std::string released;
+  EXPECT_FALSE(matcher.feed("hello world", &released));
+  EXPECT_EQ(released, "hello world");
+}
+
+TEST_F(StopMatcherTest, SimpleMatchExcludesStopSequence) {
+  StopSequenceMatcher matcher({"STOP"});
+
+  auto [matched, text] = feed_all(matcher, {"before STOP after"});
+  EXPECT_TRUE(matched);
+  EXPECT_EQ(text, "before ");
+}
+
+TEST_F(StopMatcherTest, MatchSpanningChunkBoundaries) {
+  StopSequenceMatcher matcher({"\n\nHuman:"});
+
+  // The stop sequence arrives split across token-sized chunks, as the
+  // incremental detokenizer produces it
+  auto [matched, text] =
+      feed_all(matcher, {"answer", "\n", "\nHu", "man:", " next"});
+  EXPECT_TRUE(matched);
+  EXPECT_EQ(text, "answer");
+}
+
+TEST_F(StopMatcherTest, PartialPrefixHeldBackThenReleased) {
+  StopSequenceMatcher matcher({"###"});
+
+  std::string released;
+  EXPECT_FALSE(matcher.feed("value: #", &released));
+  // The trailing '#' could still start the stop sequence
+  EXPECT_EQ(released, "value: ");
+
+  EXPECT_FALSE(matcher.feed("1", &released));
+  // '#1' proves the '#' was not a stop prefix
+  EXPECT_EQ(released, "value: #1");
+
+  EXPECT_EQ(matcher.flush(), "");
+}
+
+TEST_F(StopMatcherTest, FlushReleasesPendingPrefixAtEnd) {
+  StopSequenceMatcher matcher({"END"});
+
+  std::string released;
+  EXPECT_FALSE(matcher.feed("text EN", &released));
+  EXPECT_EQ(released, "text ");
+  EXPECT_EQ(matcher.flush(), "EN");
+}
+
+TEST_F(StopMatcherTest, MultiplePatternsFirstMatchWins) {
+  StopSequenceMatcher matcher({"</s>", "\n\n", "Observation:"});
+
+  auto [matched, text] = feed_all(matcher, {"thought\n", "\nmore"});
+  EXPECT_TRUE(matched);
+  EXPECT_EQ(text, "thought");
+}
+
+TEST_F(StopMatcherTest, SuffixPatternFoundViaFailureLinks) {
+  // "ab" never matches, but its suffix "b" is itself a pattern; the
+  // failure-link propagation must catch it mid-walk
+  StopSequenceMatcher matcher({"abc", "b"});
+
+  auto [matched, text] = feed_all(matcher, {"xaby"});
+  EXPECT_TRUE(matched);
+  EXPECT_EQ(text, "xa");
+}
+
+TEST_F(StopMatcherTest, OverlappingOccurrencesMatchEarliest) {
+  StopSequenceMatcher matcher({"aa"});
+
+  std::string released;
+  EXPECT_TRUE(matcher.feed("xaaa", &released));
+  EXPECT_EQ(released, "x");
+}
+
+TEST_F(StopMatcherTest, FeedAfterMatchIsNoOp) {
+  StopSequenceMatcher matcher({"X"});
+
+  std::string released;
+  EXPECT_TRUE(matcher.feed("aXb", &released));
+  EXPECT_EQ(released, "a");
+  EXPECT_TRUE(matcher.matched());
+
+  EXPECT_TRUE(matcher.feed("more", &released));
+  EXPECT_EQ(released, "a");  // Nothing appended
+}
+
+TEST_F(StopMatcherTest, ResetAllowsReuse) {
+  StopSequenceMatcher matcher({"STOP"});
+
+  std::string released;
+  EXPECT_TRUE(matcher.feed("a STOP", &released));
+
+  matcher.reset();
+  EXPECT_FALSE(matcher.matched());
+
+  released.clear();
+  EXPECT_FALSE(matcher.feed("clean run", &released));
+  released += matcher.flush();
+  EXPECT_EQ(released, "clean run");
+}
+
+TEST_F(StopMatcherTest, EmptyPatternStringsIgnored) {
+  StopSequenceMatcher matcher({"", "", ""});
+  EXPECT_TRUE(matcher.empty());
+}
+
+TEST_F(StopMatcherTest, MultiBytePatternMatchedBytewise) {
+  // UTF-8 pattern fed one byte at a time
+  StopSequenceMatcher matcher({"\xE2\x80\x94"});  // em dash
+
+  std::string released;
+  EXPECT_FALSE(matcher.feed("a\xE2", &released));
+  EXPECT_FALSE(matcher.feed("\x80", &released));
+  EXPECT_TRUE(matcher.feed("\x94", &released));
+  EXPECT_EQ(released, "a");
+}
+
+}  // namespace test
+}  // namespace runtime
+}  // namespace mlxr
@@ -97,6 +97,60 @@ TEST_F(TensorTest, ShapeProperty) {
   EXPECT_EQ(shape[2], 4);
 }
 
+// ============================================================================
+// TensorShape (SBO) Tests
+// ============================================================================
+
+TEST_F(TensorTest, TensorShapeInlineStorage) {
+  TensorShape shape{2, 3, 4};
+
+  EXPECT_EQ(shape.size(), 3);
+  EXPECT_EQ(shape.front(), 2);
+  EXPECT_EQ(shape.back(), 4);
+  EXPECT_FALSE(shape.empty());
+}
+
+TEST_F(TensorTest, TensorShapeHeapSpill) {
+  // Beyond kInlineDims the shape spills to the heap transparently
+  TensorShape shape{1, 2, 3, 4, 5, 6, 7, 8};
+
+  EXPECT_EQ(shape.size(), 8);
+  EXPECT_EQ(shape.back(), 8);
+}
+
+TEST_F(TensorTest, TensorShapeMoveTransfersSpill) {
+  TensorShape big{1, 2, 3, 4, 5, 6, 7, 8};
+  TensorShape expected = big;
+
+  TensorShape moved = std::move(big);
+  EXPECT_EQ(moved, expected);
+  EXPECT_EQ(big.size(), 0);
+
+  TensorShape reassigned;
+  reassigned = std::move(moved);
+  EXPECT_EQ(reassigned, expected);
+}
+
+TEST_F(TensorTest, TensorShapeConvertsToVector) {
+  Tensor t({2, 3}, mlx::core::float32);
+  std::vector<int> vec = t.shape();
+
+  EXPECT_EQ(vec, (std::vector<int>{2, 3}));
+}
+
+TEST_F(TensorTest, TensorMoveIsNoexcept) {
+  // Containers of tensors (logits batches, KV caches) relocate by move
+  // only when the move constructor is noexcept
+  static_assert(std::is_nothrow_move_constructible<Tensor>::value,
+                "Tensor move must be noexcept");
+  static_assert(std::is_nothrow_move_constructible<TensorShape>::value,
+                "TensorShape move must be noexcept");
+
+  Tensor src({2, 3}, mlx::core::float32);
+  Tensor dst(std::move(src));
+  EXPECT_TRUE(shapes_equal(dst.shape(), {2, 3}));
+}
+
 TEST_F(TensorTest, DtypeProperty) {
   Tensor t({2, 3}, mlx::core::float32);
   EXPECT_EQ(t.dtype(), mlx::core::float32);
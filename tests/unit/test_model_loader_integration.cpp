@@ -3,7 +3,9 @@
 
 #include <gtest/gtest.h>
 
+#include <ctime>
 #include <filesystem>
+#include <fstream>
 #include <memory>
 
 #include "registry/model_registry.h"
@@ -264,6 +266,55 @@ TEST_F(ModelLoaderIntegrationTest, GQAVsMHA) {
   EXPECT_EQ(mha->num_kv_heads, 32);  // MHA
 }
 
+TEST_F(ModelLoaderIntegrationTest, WarmManifestRoundTrip) {
+  auto manifest_path = (test_dir_ / "warm_manifest.json").string();
+
+  // Loader with no residents writes an empty (but valid) manifest
+  ASSERT_TRUE(loader_->write_warm_manifest(manifest_path));
+  ASSERT_TRUE(fs::exists(manifest_path));
+
+  auto names = ModelLoader::read_warm_manifest(manifest_path);
+  EXPECT_TRUE(names.empty());
+}
+
+TEST_F(ModelLoaderIntegrationTest, WarmManifestMissingFile) {
+  auto names = ModelLoader::read_warm_manifest(
+      (test_dir_ / "does_not_exist.json").string());
+  EXPECT_TRUE(names.empty());
+}
+
+TEST_F(ModelLoaderIntegrationTest, WarmManifestRejectsStaleAndMalformed) {
+  auto stale_path = (test_dir_ / "stale_manifest.json").string();
+  {
+    std::ofstream out(stale_path);
+    // written_at far in the past: the page cache has moved on
+    out << "{\"version\":1,\"written_at\":1000,\"models\":[\"m\"]}";
+  }
+  EXPECT_TRUE(ModelLoader::read_warm_manifest(stale_path).empty());
+
+  auto malformed_path = (test_dir_ / "malformed_manifest.json").string();
+  {
+    std::ofstream out(malformed_path);
+    out << "{not json";
+  }
+  EXPECT_TRUE(ModelLoader::read_warm_manifest(malformed_path).empty());
+}
+
+TEST_F(ModelLoaderIntegrationTest, WarmManifestReadsFreshModelList) {
+  auto manifest_path = (test_dir_ / "fresh_manifest.json").string();
+  {
+    std::ofstream out(manifest_path);
+    out << "{\"version\":1,\"written_at\":"
+        << static_cast<int64_t>(std::time(nullptr))
+        << ",\"models\":[\"draft-1b\",\"chat-8b\"]}";
+  }
+
+  auto names = ModelLoader::read_warm_manifest(manifest_path);
+  ASSERT_EQ(names.size(), 2u);
+  EXPECT_EQ(names[0], "draft-1b");
+  EXPECT_EQ(names[1], "chat-8b");
+}
+
 }  // namespace test
 }  // namespace server
 }  // namespace mlxr
@@ -231,6 +231,388 @@ TEST_F(ModelLoaderPagerTest, CapacityLimits) {
   EXPECT_TRUE(pager->allocate_blocks_for_sequence(0, 96));  // 96 tokens = 3 blocks
 }
 
+// Test per-pager block quota (multi-model residency)
+TEST_F(ModelLoaderPagerTest, BlockQuotaLimitsAllocation) {
+  runtime::kv::ArenaConfig arena_config;
+  arena_config.num_layers = 22;
+  arena_config.num_kv_heads = 4;
+  arena_config.head_dim = 64;
+  arena_config.block_size_tokens = 32;
+  arena_config.num_blocks = 100;
+
+  auto arena = std::make_shared<runtime::kv::Arena>(arena_config);
+  auto pager = std::make_shared<runtime::kv::Pager>(arena);
+  pager->set_block_quota(2);
+
+  pager->create_sequence(0);
+
+  // 2 blocks fit the quota even though the arena has 100
+  EXPECT_TRUE(pager->allocate_blocks_for_sequence(0, 64));
+
+  // A 3rd block exceeds the quota
+  EXPECT_FALSE(pager->allocate_blocks_for_sequence(0, 96));
+
+  // Raising the quota lets growth continue
+  pager->set_block_quota(3);
+  EXPECT_TRUE(pager->allocate_blocks_for_sequence(0, 96));
+}
+
+// Test that the quota is per-pager, not per-arena
+TEST_F(ModelLoaderPagerTest, QuotaIsPerPager) {
+  runtime::kv::ArenaConfig arena_config;
+  arena_config.num_layers = 22;
+  arena_config.num_kv_heads = 4;
+  arena_config.head_dim = 64;
+  arena_config.block_size_tokens = 32;
+  arena_config.num_blocks = 100;
+
+  auto arena = std::make_shared<runtime::kv::Arena>(arena_config);
+  auto chat_pager = std::make_shared<runtime::kv::Pager>(arena);
+  auto draft_pager = std::make_shared<runtime::kv::Pager>(arena);
+  chat_pager->set_block_quota(2);
+
+  // Chat model exhausts its quota on the shared arena
+  chat_pager->create_sequence(0);
+  ASSERT_TRUE(chat_pager->allocate_blocks_for_sequence(0, 64));
+  EXPECT_FALSE(chat_pager->allocate_blocks_for_sequence(0, 96));
+
+  // The co-resident draft model is unaffected
+  draft_pager->create_sequence(0);
+  EXPECT_TRUE(draft_pager->allocate_blocks_for_sequence(0, 128));
+}
+
+// Test co-resident models with matching KV geometry share one arena
+TEST_F(ModelLoaderPagerTest, MatchingGeometryReusesSharedArena) {
+  LoadModelConfig config;
+  config.kv_num_layers = 22;
+  config.kv_num_heads = 4;
+  config.kv_head_dim = 64;
+  config.kv_block_size = 32;
+  config.kv_num_blocks = 64;
+
+  auto chat_pager = loader_->create_pager(config);
+  ASSERT_NE(chat_pager, nullptr);
+
+  auto draft_pager = loader_->create_pager(config);
+  ASSERT_NE(draft_pager, nullptr);
+
+  // Same arena: a block allocated through one pager reduces what the
+  // other can allocate
+  EXPECT_EQ(&chat_pager->arena(), &draft_pager->arena());
+}
+
+// Test that mismatched KV geometry falls back to a private arena
+TEST_F(ModelLoaderPagerTest, MismatchedGeometryGetsPrivateArena) {
+  LoadModelConfig chat_config;
+  chat_config.kv_num_layers = 32;
+  chat_config.kv_num_heads = 8;
+  chat_config.kv_head_dim = 128;
+  chat_config.kv_block_size = 32;
+  chat_config.kv_num_blocks = 64;
+
+  LoadModelConfig draft_config = chat_config;
+  draft_config.kv_num_layers = 22;  // different depth
+  draft_config.kv_head_dim = 64;
+
+  auto chat_pager = loader_->create_pager(chat_config);
+  auto draft_pager = loader_->create_pager(draft_config);
+  ASSERT_NE(chat_pager, nullptr);
+  ASSERT_NE(draft_pager, nullptr);
+
+  // Block tensor shapes differ, so the arenas must too
+  EXPECT_NE(&chat_pager->arena(), &draft_pager->arena());
+}
+
+// Test quota applied through the loader config
+TEST_F(ModelLoaderPagerTest, LoaderAppliesConfiguredQuota) {
+  LoadModelConfig config;
+  config.kv_num_layers = 22;
+  config.kv_num_heads = 4;
+  config.kv_head_dim = 64;
+  config.kv_block_size = 32;
+  config.kv_num_blocks = 64;
+  config.kv_quota_blocks = 48;
+
+  auto pager = loader_->create_pager(config);
+  ASSERT_NE(pager, nullptr);
+  EXPECT_EQ(pager->block_quota(), 48);
+}
+
+// Test batched page table packing for single-dispatch decode
+TEST_F(ModelLoaderPagerTest, BatchedPageTableRemapsToLocalIndices) {
+  runtime::kv::ArenaConfig arena_config;
+  arena_config.num_layers = 2;
+  arena_config.num_kv_heads = 4;
+  arena_config.head_dim = 64;
+  arena_config.block_size_tokens = 32;
+  arena_config.num_blocks = 16;
+
+  auto arena = std::make_shared<runtime::kv::Arena>(arena_config);
+  auto pager = std::make_shared<runtime::kv::Pager>(arena);
+
+  // Two sequences: 2 blocks and 1 block respectively
+  pager->create_sequence(0);
+  ASSERT_TRUE(pager->allocate_blocks_for_sequence(0, 64));
+  pager->create_sequence(1);
+  ASSERT_TRUE(pager->allocate_blocks_for_sequence(1, 32));
+
+  std::vector<int> block_ids;
+  auto table = pager->build_batched_page_table_array({0, 1}, 2, &block_ids);
+
+  // One slot per referenced block, no duplicates
+  EXPECT_EQ(block_ids.size(), 3u);
+
+  auto arr = table.array();
+  arr.eval();
+  EXPECT_EQ(arr.shape(0), 2);
+  EXPECT_EQ(arr.shape(1), 2);
+
+  // Entries index the gathered stack (0..2); row 1 is padded with -1
+  const int* data = arr.data<int>();
+  EXPECT_EQ(data[0], 0);
+  EXPECT_EQ(data[1], 1);
+  EXPECT_EQ(data[2], 2);
+  EXPECT_EQ(data[3], -1);
+}
+
+TEST_F(ModelLoaderPagerTest, BatchedPageTableDedupsSharedBlocks) {
+  runtime::kv::ArenaConfig arena_config;
+  arena_config.num_layers = 2;
+  arena_config.num_kv_heads = 4;
+  arena_config.head_dim = 64;
+  arena_config.block_size_tokens = 32;
+  arena_config.num_blocks = 16;
+
+  auto arena = std::make_shared<runtime::kv::Arena>(arena_config);
+  auto pager = std::make_shared<runtime::kv::Pager>(arena);
+
+  // Fork shares the parent's blocks copy-on-write
+  pager->create_sequence(0);
+  ASSERT_TRUE(pager->allocate_blocks_for_sequence(0, 64));
+  ASSERT_TRUE(pager->fork_sequence(0, 1));
+
+  std::vector<int> block_ids;
+  auto table = pager->build_batched_page_table_array({0, 1}, 2, &block_ids);
+
+  // Shared blocks are gathered once, and both rows point at the same
+  // local slots
+  EXPECT_EQ(block_ids.size(), 2u);
+
+  auto arr = table.array();
+  arr.eval();
+  const int* data = arr.data<int>();
+  EXPECT_EQ(data[0], data[2]);
+  EXPECT_EQ(data[1], data[3]);
+}
+
+// Test that a recorded decode plan replays until the block set changes
+TEST_F(ModelLoaderPagerTest, BatchDecodePlanReplaysUntilBlockSetChanges) {
+  runtime::kv::ArenaConfig arena_config;
+  arena_config.num_layers = 2;
+  arena_config.num_kv_heads = 4;
+  arena_config.head_dim = 64;
+  arena_config.block_size_tokens = 32;
+  arena_config.num_blocks = 16;
+
+  auto arena = std::make_shared<runtime::kv::Arena>(arena_config);
+  auto pager = std::make_shared<runtime::kv::Pager>(arena);
+
+  pager->create_sequence(0);
+  pager->create_sequence(1);
+  ASSERT_TRUE(pager->allocate_blocks_for_sequence(0, 32));  // 1 block
+  ASSERT_TRUE(pager->allocate_blocks_for_sequence(1, 32));  // 1 block
+
+  runtime::kv::BatchDecodePlan plan;
+  std::vector<int> seq_ids = {0, 1};
+
+  // First call records
+  EXPECT_TRUE(pager->refresh_batch_decode_plan(seq_ids, &plan));
+  EXPECT_TRUE(plan.valid);
+  EXPECT_EQ(plan.max_blocks, 1);
+  EXPECT_EQ(plan.block_ids.size(), 2u);
+
+  // Same block set: subsequent steps replay the recording
+  EXPECT_FALSE(pager->refresh_batch_decode_plan(seq_ids, &plan));
+
+  // Crossing a block boundary invalidates and re-records
+  ASSERT_TRUE(pager->allocate_blocks_for_sequence(0, 64));  // 2nd block
+  EXPECT_TRUE(pager->refresh_batch_decode_plan(seq_ids, &plan));
+  EXPECT_EQ(plan.max_blocks, 2);
+  EXPECT_EQ(plan.block_ids.size(), 3u);
+
+  // Different batch membership is a different recording
+  std::vector<int> reversed = {1, 0};
+  EXPECT_TRUE(pager->refresh_batch_decode_plan(reversed, &plan));
+}
+
+// Test model size estimation for the warm-pool budget
+TEST_F(ModelLoaderPagerTest, EstimateModelBytesUsesFileSize) {
+  registry::ModelInfo info;
+  info.file_size = 4ULL * 1024 * 1024 * 1024;  // 4 GB GGUF
+  info.param_count = 8'000'000'000ULL;
+
+  // Weights are mmap'd from the file, so file size is the footprint
+  EXPECT_EQ(ModelLoader::estimate_model_bytes(info),
+            4ULL * 1024 * 1024 * 1024);
+}
+
+// Test size fallback when the registry has no file size recorded
+TEST_F(ModelLoaderPagerTest, EstimateModelBytesFallsBackToParams) {
+  registry::ModelInfo info;
+  info.file_size = 0;
+  info.param_count = 1'100'000'000ULL;  // 1.1B
+
+  // Assumes fp16 (2 bytes/param)
+  EXPECT_EQ(ModelLoader::estimate_model_bytes(info), 2'200'000'000ULL);
+}
+
+// Test warm-pool budget bookkeeping on an empty pool
+TEST_F(ModelLoaderPagerTest, MemoryBudgetDefaultsToUnlimited) {
+  EXPECT_EQ(loader_->memory_budget(), 0u);
+  EXPECT_EQ(loader_->resident_bytes(), 0u);
+
+  loader_->set_memory_budget(16ULL * 1024 * 1024 * 1024);
+  EXPECT_EQ(loader_->memory_budget(), 16ULL * 1024 * 1024 * 1024);
+}
+
+// Streaming (StreamingLLM) mode: middle blocks are freed, sinks and the
+// recent window survive, and later blocks keep their logical positions
+TEST_F(ModelLoaderPagerTest, StreamingWindowFreesMiddleBlocks) {
+  runtime::kv::ArenaConfig arena_config;
+  arena_config.num_layers = 2;
+  arena_config.num_kv_heads = 2;
+  arena_config.head_dim = 8;
+  arena_config.block_size_tokens = 32;
+  arena_config.num_blocks = 64;
+
+  auto arena = std::make_shared<runtime::kv::Arena>(arena_config);
+  auto pager = std::make_shared<runtime::kv::Pager>(arena);
+
+  pager->create_sequence(0);
+  ASSERT_TRUE(pager->allocate_blocks_for_sequence(0, 8 * 32));  // 8 blocks
+  EXPECT_EQ(arena->get_stats().allocated_blocks, 8);
+
+  ASSERT_TRUE(pager->enable_streaming_window(0, /*sink_blocks=*/1,
+                                             /*window_blocks=*/2));
+
+  auto* seq = pager->get_sequence(0);
+  ASSERT_NE(seq, nullptr);
+  const auto& table = seq->page_table();
+  ASSERT_EQ(table.size(), 8u);  // Logical positions preserved
+  EXPECT_GE(table[0], 0);       // Sink block survives
+  for (int idx = 1; idx < 6; ++idx) {
+    EXPECT_EQ(table[idx], -1) << "middle block " << idx << " not freed";
+  }
+  EXPECT_GE(table[6], 0);  // Window survives
+  EXPECT_GE(table[7], 0);
+  EXPECT_EQ(arena->get_stats().allocated_blocks, 3);
+}
+
+// Memory stays constant however far the sequence grows
+TEST_F(ModelLoaderPagerTest, StreamingSessionHoldsConstantMemory) {
+  runtime::kv::ArenaConfig arena_config;
+  arena_config.num_layers = 2;
+  arena_config.num_kv_heads = 2;
+  arena_config.head_dim = 8;
+  arena_config.block_size_tokens = 16;
+  arena_config.num_blocks = 8;  // Far fewer blocks than the session needs
+
+  auto arena = std::make_shared<runtime::kv::Arena>(arena_config);
+  auto pager = std::make_shared<runtime::kv::Pager>(arena);
+
+  pager->create_sequence(0);
+  ASSERT_TRUE(pager->allocate_blocks_for_sequence(0, 16));
+  ASSERT_TRUE(pager->enable_streaming_window(0, 1, 2));
+
+  // 50 block-growths on an 8-block arena: linear growth would exhaust
+  // it; streaming reclamation must keep it at sinks + window
+  for (int step = 2; step <= 50; ++step) {
+    ASSERT_TRUE(pager->allocate_blocks_for_sequence(0, step * 16))
+        << "allocation failed at step " << step;
+    EXPECT_LE(arena->get_stats().allocated_blocks, 3);
+  }
+
+  // The holes never disturb later blocks' logical positions
+  auto* seq = pager->get_sequence(0);
+  ASSERT_NE(seq, nullptr);
+  EXPECT_EQ(seq->page_table().size(), 50u);
+  EXPECT_GE(seq->get_block_id(0), 0);
+  EXPECT_GE(seq->get_block_id(49), 0);
+  EXPECT_EQ(seq->get_block_id(25), -1);
+}
+
+// Fork siblings (n>1 sampling) share prefill blocks copy-on-write:
+// the first write into the shared partial tail privatizes it
+TEST_F(ModelLoaderPagerTest, ForkedSequencesCopySharedTailOnWrite) {
+  runtime::kv::ArenaConfig arena_config;
+  arena_config.num_layers = 2;
+  arena_config.num_kv_heads = 2;
+  arena_config.head_dim = 8;
+  arena_config.block_size_tokens = 32;
+  arena_config.num_blocks = 64;
+
+  auto arena = std::make_shared<runtime::kv::Arena>(arena_config);
+  auto pager = std::make_shared<runtime::kv::Pager>(arena);
+
+  // 80-token prefill: two full blocks plus a partial tail
+  pager->create_sequence(0);
+  ASSERT_TRUE(pager->allocate_blocks_for_sequence(0, 80));
+  pager->get_sequence(0)->set_num_tokens(80);
+  ASSERT_TRUE(pager->fork_sequence(0, 1));
+  EXPECT_EQ(arena->get_stats().allocated_blocks, 3);
+
+  int shared_tail = pager->get_sequence(0)->get_block_id(2);
+  ASSERT_GE(shared_tail, 0);
+
+  // Parent decodes into the shared partial block -> gets a private copy
+  ASSERT_TRUE(pager->allocate_blocks_for_sequence(0, 81));
+  int parent_tail = pager->get_sequence(0)->get_block_id(2);
+  EXPECT_NE(parent_tail, shared_tail);
+  EXPECT_EQ(pager->get_sequence(1)->get_block_id(2), shared_tail);
+  EXPECT_EQ(arena->get_stats().allocated_blocks, 4);
+
+  // The child now owns the original tail exclusively -> no second copy
+  ASSERT_TRUE(pager->allocate_blocks_for_sequence(1, 81));
+  EXPECT_EQ(pager->get_sequence(1)->get_block_id(2), shared_tail);
+  EXPECT_EQ(arena->get_stats().allocated_blocks, 4);
+  EXPECT_EQ(pager->get_stats().num_cow_copies, 1);
+
+  // Full prefix blocks stay shared for both siblings throughout
+  EXPECT_EQ(pager->get_sequence(0)->get_block_id(0),
+            pager->get_sequence(1)->get_block_id(0));
+  EXPECT_EQ(pager->get_sequence(0)->get_block_id(1),
+            pager->get_sequence(1)->get_block_id(1));
+}
+
+// Blocks shared with a fork survive streaming eviction (refcounted)
+TEST_F(ModelLoaderPagerTest, StreamingKeepsSharedBlocksAlive) {
+  runtime::kv::ArenaConfig arena_config;
+  arena_config.num_layers = 2;
+  arena_config.num_kv_heads = 2;
+  arena_config.head_dim = 8;
+  arena_config.block_size_tokens = 32;
+  arena_config.num_blocks = 64;
+
+  auto arena = std::make_shared<runtime::kv::Arena>(arena_config);
+  auto pager = std::make_shared<runtime::kv::Pager>(arena);
+
+  pager->create_sequence(0);
+  ASSERT_TRUE(pager->allocate_blocks_for_sequence(0, 6 * 32));
+  ASSERT_TRUE(pager->fork_sequence(0, 1));
+
+  int shared_middle = pager->get_sequence(0)->get_block_id(2);
+  ASSERT_GE(shared_middle, 0);
+
+  ASSERT_TRUE(pager->enable_streaming_window(0, 1, 2));
+
+  // The streaming sequence dropped its mapping, but the fork still
+  // references the block, so it stays allocated
+  EXPECT_EQ(pager->get_sequence(0)->get_block_id(2), -1);
+  EXPECT_EQ(pager->get_sequence(1)->get_block_id(2), shared_middle);
+  ASSERT_NE(pager->get_block(shared_middle), nullptr);
+  EXPECT_EQ(pager->get_block(shared_middle)->ref_count.load(), 1);
+}
+
 }  // namespace test
 }  // namespace server
 }  // namespace mlxr
@@ -7,8 +7,11 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <stdexcept>
+#include <thread>
 
 using namespace mlxr::runtime;
 
@@ -397,3 +400,237 @@ TEST_F(TokenizerTest, READMEInstructions) {
  *       "./test_models/tokenizer.model"
  *   );
  */
+
+// ============================================================================
+// DetokenizeStream Tests
+// ============================================================================
+
+namespace {
+
+// Stub tokenizer emulating SentencePiece decode semantics: pieces join
+// with "▁" -> space, and a leading space at the start of the output is
+// stripped. Byte pieces carry raw bytes (for multi-byte UTF-8 tests).
+class StubSentencePieceTokenizer : public Tokenizer {
+ public:
+  explicit StubSentencePieceTokenizer(std::vector<std::string> pieces)
+      : pieces_(std::move(pieces)) {}
+
+  std::vector<int> encode(const std::string&) override { return {}; }
+
+  std::string decode(const std::vector<int>& ids) override {
+    std::string text;
+    for (int id : ids) {
+      std::string piece = pieces_.at(static_cast<size_t>(id));
+      size_t pos = 0;
+      while ((pos = piece.find("\xe2\x96\x81")) != std::string::npos) {
+        piece.replace(pos, 3, " ");
+      }
+      text += piece;
+    }
+    if (!text.empty() && text[0] == ' ') {
+      text.erase(0, 1);
+    }
+    return text;
+  }
+
+  size_t vocab_size() const override { return pieces_.size(); }
+  int bos_token_id() const override { return -1; }
+  int eos_token_id() const override { return -1; }
+  int pad_token_id() const override { return -1; }
+  std::string id_to_token(int id) const override {
+    return pieces_.at(static_cast<size_t>(id));
+  }
+  int token_to_id(const std::string&) const override { return -1; }
+
+ private:
+  std::vector<std::string> pieces_;
+};
+
+}  // namespace
+
+TEST_F(TokenizerTest, DetokenizeStreamEmitsIncrementalText) {
+  // "▁Hello" "▁world" "!" -> "Hello world!"
+  StubSentencePieceTokenizer tok(
+      {"\xe2\x96\x81Hello", "\xe2\x96\x81world", "!"});
+  DetokenizeStream stream(&tok);
+
+  EXPECT_EQ(stream.push(0), "Hello");
+  EXPECT_EQ(stream.push(1), " world");
+  EXPECT_EQ(stream.push(2), "!");
+  EXPECT_EQ(stream.flush(), "");
+}
+
+TEST_F(TokenizerTest, DetokenizeStreamBuffersIncompleteUtf8) {
+  // U+00E9 (é) = 0xC3 0xA9 split across two byte-fallback pieces
+  StubSentencePieceTokenizer tok({"caf", "\xC3", "\xA9", "!"});
+  DetokenizeStream stream(&tok);
+
+  EXPECT_EQ(stream.push(0), "caf");
+  EXPECT_EQ(stream.push(1), "");  // Incomplete lead byte held back
+  EXPECT_EQ(stream.push(2), "\xC3\xA9");
+  EXPECT_EQ(stream.push(3), "!");
+}
+
+TEST_F(TokenizerTest, DetokenizeStreamFlushDrainsPendingBytes) {
+  // Generation ends mid code point: flush returns the buffered tail
+  StubSentencePieceTokenizer tok({"ok", "\xE2\x82"});
+  DetokenizeStream stream(&tok);
+
+  EXPECT_EQ(stream.push(0), "ok");
+  EXPECT_EQ(stream.push(1), "");  // 3-byte sequence missing final byte
+  EXPECT_EQ(stream.flush(), "\xE2\x82");
+  EXPECT_EQ(stream.flush(), "");
+}
+
+TEST_F(TokenizerTest, DetokenizeStreamSurvivesWindowReanchor) {
+  // More tokens than 2x the internal window: output must stay correct
+  // across the re-anchor
+  std::vector<std::string> pieces;
+  for (int i = 0; i < 64; ++i) {
+    pieces.push_back("\xe2\x96\x81tok" + std::to_string(i));
+  }
+  StubSentencePieceTokenizer tok(pieces);
+  DetokenizeStream stream(&tok);
+
+  std::string out;
+  for (int i = 0; i < 64; ++i) {
+    out += stream.push(i);
+  }
+  out += stream.flush();
+
+  std::string expected;
+  for (int i = 0; i < 64; ++i) {
+    expected += (i == 0 ? "tok" : " tok") + std::to_string(i);
+  }
+  EXPECT_EQ(out, expected);
+}
+
+TEST_F(TokenizerTest, DetokenizeStreamResetClearsState) {
+  StubSentencePieceTokenizer tok({"\xe2\x96\x81Hi", "\xC3"});
+  DetokenizeStream stream(&tok);
+
+  stream.push(0);
+  stream.push(1);  // Leaves a pending byte
+  stream.reset();
+
+  // After reset the stream behaves like a fresh one
+  EXPECT_EQ(stream.push(0), "Hi");
+  EXPECT_EQ(stream.flush(), "");
+}
+
+TEST_F(TokenizerTest, DetokenizeStreamRequiresTokenizer) {
+  EXPECT_THROW({ DetokenizeStream stream(nullptr); }, std::invalid_argument);
+}
+
+// ============================================================================
+// Batch / Async Encoding Tests
+// ============================================================================
+
+namespace {
+
+// Stub whose encode maps each byte to its char code (deterministic and
+// thread-safe), so pool-dispatched results can be checked exactly. An
+// optional per-call delay simulates a large document
+class ByteCodeTokenizer : public Tokenizer {
+ public:
+  explicit ByteCodeTokenizer(int encode_delay_ms = 0)
+      : encode_delay_ms_(encode_delay_ms) {}
+
+  std::vector<int> encode(const std::string& text) override {
+    if (encode_delay_ms_ > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(encode_delay_ms_));
+    }
+    if (text == "!!throw!!") {
+      throw std::runtime_error("encode failed");
+    }
+    std::vector<int> ids;
+    ids.reserve(text.size());
+    for (unsigned char c : text) {
+      ids.push_back(static_cast<int>(c));
+    }
+    return ids;
+  }
+
+  std::string decode(const std::vector<int>& ids) override {
+    std::string text;
+    for (int id : ids) {
+      text += static_cast<char>(id);
+    }
+    return text;
+  }
+
+  size_t vocab_size() const override { return 256; }
+  int bos_token_id() const override { return -1; }
+  int eos_token_id() const override { return -1; }
+  int pad_token_id() const override { return -1; }
+  std::string id_to_token(int id) const override {
+    return std::string(1, static_cast<char>(id));
+  }
+  int token_to_id(const std::string&) const override { return -1; }
+
+ private:
+  int encode_delay_ms_;
+};
+
+}  // namespace
+
+TEST_F(TokenizerTest, EncodeBatchPreservesInputOrder) {
+  ByteCodeTokenizer tok;
+
+  std::vector<std::string> texts;
+  for (int i = 0; i < 16; ++i) {
+    texts.push_back("text" + std::to_string(i));
+  }
+
+  auto results = tok.encode_batch(texts);
+
+  ASSERT_EQ(results.size(), texts.size());
+  for (size_t i = 0; i < texts.size(); ++i) {
+    EXPECT_EQ(tok.decode(results[i]), texts[i]) << "row " << i;
+  }
+}
+
+TEST_F(TokenizerTest, EncodeBatchHandlesEmptyAndSingle) {
+  ByteCodeTokenizer tok;
+
+  EXPECT_TRUE(tok.encode_batch({}).empty());
+
+  auto single = tok.encode_batch({"hi"});
+  ASSERT_EQ(single.size(), 1u);
+  EXPECT_EQ(tok.decode(single[0]), "hi");
+}
+
+TEST_F(TokenizerTest, EncodeBatchRunsConcurrently) {
+  // 8 texts at 20ms each: serial encoding would take ~160ms; the pool
+  // plus the caller's thread should land well under that
+  ByteCodeTokenizer tok(/*encode_delay_ms=*/20);
+  std::vector<std::string> texts(8, "payload");
+
+  auto start = std::chrono::steady_clock::now();
+  auto results = tok.encode_batch(texts);
+  auto elapsed_ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+  ASSERT_EQ(results.size(), 8u);
+  for (const auto& ids : results) {
+    EXPECT_EQ(tok.decode(ids), "payload");
+  }
+  EXPECT_LT(elapsed_ms, 120.0);
+}
+
+TEST_F(TokenizerTest, EncodeAsyncDeliversResultOffThread) {
+  ByteCodeTokenizer tok;
+
+  auto future = tok.encode_async("async text");
+  auto ids = future.get();
+
+  EXPECT_EQ(tok.decode(ids), "async text");
+}
+
+TEST_F(TokenizerTest, EncodeAsyncPropagatesEncodeError) {
+  ByteCodeTokenizer tok;
+
+  auto future = tok.encode_async("!!throw!!");
+  EXPECT_THROW(future.get(), std::runtime_error);
+}
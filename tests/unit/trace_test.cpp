@@ -0,0 +1,139 @@
+// Copyright © 2025 MLXR Development
+// Unit tests for the scheduler event trace recorder
+
+#include "telemetry/trace.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mlxr::telemetry;
+
+namespace {
+
+// Count occurrences of a substring (events share one JSON blob)
+int count_occurrences(const std::string& haystack, const std::string& needle) {
+  int count = 0;
+  size_t pos = 0;
+  while ((pos = haystack.find(needle, pos)) != std::string::npos) {
+    count++;
+    pos += needle.size();
+  }
+  return count;
+}
+
+}  // namespace
+
+class TraceRecorderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    TraceRecorder::instance().clear();
+    TraceRecorder::instance().set_enabled(false);
+  }
+
+  void TearDown() override {
+    TraceRecorder::instance().clear();
+    TraceRecorder::instance().set_enabled(false);
+  }
+};
+
+TEST_F(TraceRecorderTest, DisabledRecordsNothing) {
+  EXPECT_FALSE(TraceRecorder::instance().enabled());
+
+  TraceRecorder::instance().record_instant("batch_formed", "tokens", 32);
+  { ScopedTraceSpan span("decode_step"); }
+
+  std::string json = TraceRecorder::instance().dump_json();
+  EXPECT_EQ(json, "{\"traceEvents\":[]}");
+}
+
+TEST_F(TraceRecorderTest, InstantEventFormat) {
+  TraceRecorder::instance().set_enabled(true);
+  TraceRecorder::instance().record_instant("kv_alloc", "blocks", 7);
+
+  std::string json = TraceRecorder::instance().dump_json();
+  EXPECT_NE(json.find("\"name\":\"kv_alloc\""), std::string::npos);
+  EXPECT_NE(json.find("\"ph\":\"i\""), std::string::npos);
+  EXPECT_NE(json.find("\"args\":{\"blocks\":7}"), std::string::npos);
+  EXPECT_NE(json.find("\"ts\":"), std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, SpanRecordsDuration) {
+  TraceRecorder::instance().set_enabled(true);
+  {
+    ScopedTraceSpan span("prefill_chunk", "prompt_tokens", 128);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+
+  std::string json = TraceRecorder::instance().dump_json();
+  EXPECT_NE(json.find("\"name\":\"prefill_chunk\""), std::string::npos);
+  EXPECT_NE(json.find("\"ph\":\"X\""), std::string::npos);
+  EXPECT_NE(json.find("\"dur\":"), std::string::npos);
+  EXPECT_NE(json.find("\"args\":{\"prompt_tokens\":128}"), std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, ClearDropsEvents) {
+  TraceRecorder::instance().set_enabled(true);
+  TraceRecorder::instance().record_instant("batch_formed");
+  ASSERT_NE(TraceRecorder::instance().dump_json().find("batch_formed"),
+            std::string::npos);
+
+  TraceRecorder::instance().clear();
+  EXPECT_EQ(TraceRecorder::instance().dump_json(), "{\"traceEvents\":[]}");
+}
+
+TEST_F(TraceRecorderTest, RingBufferBoundsEventCount) {
+  TraceRecorder::instance().set_enabled(true);
+
+  // Write well past one ring's capacity; the dump must stay bounded
+  // and keep only the newest events
+  const int total = 20000;
+  for (int i = 0; i < total; i++) {
+    TraceRecorder::instance().record_instant("decode_step", "seq", i);
+  }
+
+  std::string json = TraceRecorder::instance().dump_json();
+  int events = count_occurrences(json, "\"name\":\"decode_step\"");
+  EXPECT_GT(events, 0);
+  EXPECT_LT(events, total);
+
+  // The most recent event survived; the oldest was overwritten
+  EXPECT_NE(json.find("{\"seq\":" + std::to_string(total - 1) + "}"),
+            std::string::npos);
+  EXPECT_EQ(json.find("{\"seq\":0}"), std::string::npos);
+}
+
+TEST_F(TraceRecorderTest, ThreadsGetDistinctTids) {
+  TraceRecorder::instance().set_enabled(true);
+
+  const int num_threads = 4;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([]() {
+      for (int j = 0; j < 100; j++) {
+        TraceRecorder::instance().record_instant("sse_flush", "frames", j);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  std::string json = TraceRecorder::instance().dump_json();
+  EXPECT_EQ(count_occurrences(json, "\"name\":\"sse_flush\""),
+            num_threads * 100);
+
+  // Each thread's ring dumps under its own tid lane
+  int distinct_tids = 0;
+  for (int tid = 1; tid <= num_threads + 4; tid++) {
+    if (json.find("\"tid\":" + std::to_string(tid) + "}") !=
+            std::string::npos ||
+        json.find("\"tid\":" + std::to_string(tid) + ",") !=
+            std::string::npos) {
+      distinct_tids++;
+    }
+  }
+  EXPECT_GE(distinct_tids, num_threads);
+}
@@ -0,0 +1,437 @@
+/**
+ * @file mlxr_bench.cpp
+ * @brief Reproducible inference benchmark with JSON output and
+ *        regression gating
+ *
+ * Runs a configurable prompt-length x batch-size x output-length matrix
+ * against a model and reports, per cell: prefill tok/s, decode tok/s,
+ * p50/p95 decode step latency, peak KV arena usage and prefix-cache hit
+ * rate. Results are emitted as machine-readable JSON; with a checked-in
+ * baseline file the run exits nonzero when any cell regresses past the
+ * tolerance, so CI catches performance regressions before users do.
+ *
+ * Usage:
+ *   ./mlxr_bench <model_dir> <tokenizer_path> [options]
+ *
+ * Options:
+ *   --prompt-lengths N,N,...   Prompt sizes in tokens (default 64,256)
+ *   --output-lengths N,N,...   Tokens generated per request (default 32)
+ *   --batch-sizes N,N,...      Concurrent sequences (default 1,4)
+ *   --output FILE              Write results JSON to FILE (default stdout)
+ *   --baseline FILE            Compare against baseline, exit 1 on regression
+ *   --tolerance PCT            Allowed regression percent (default 10)
+ *
+ * Typical CI flow: run once on a known-good build with --output to
+ * produce the baseline, check it in (e.g. tools/mlxr_bench_baseline.json),
+ * then gate subsequent builds with --baseline.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "graph/tensor.h"
+#include "mlx/mlx.h"
+#include "runtime/engine.h"
+#include "runtime/sampler.h"
+
+using namespace mlxr;
+using namespace mlxr::runtime;
+using namespace std::chrono;
+
+namespace {
+
+// ============================================================================
+// Measurement
+// ============================================================================
+
+struct BenchCell {
+  int prompt_tokens = 0;
+  int batch_size = 0;
+  int output_tokens = 0;
+
+  double prefill_tok_s = 0.0;
+  double decode_tok_s = 0.0;
+  double step_p50_ms = 0.0;
+  double step_p95_ms = 0.0;
+  int peak_arena_blocks = 0;
+  double kv_hit_rate = 0.0;
+};
+
+double percentile(std::vector<double> values, double p) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  double rank = p / 100.0 * (values.size() - 1);
+  size_t lo = static_cast<size_t>(rank);
+  size_t hi = std::min(lo + 1, values.size() - 1);
+  double frac = rank - lo;
+  return values[lo] * (1.0 - frac) + values[hi] * frac;
+}
+
+// Deterministic synthetic prompt: the content doesn't matter for
+// throughput, but every run must present identical token streams
+std::vector<int> synthetic_prompt(int num_tokens, int seq_index) {
+  std::vector<int> tokens;
+  tokens.reserve(num_tokens);
+  for (int i = 0; i < num_tokens; i++) {
+    tokens.push_back(2 + ((i * 31 + seq_index * 7) % 1000));
+  }
+  return tokens;
+}
+
+BenchCell run_cell(Engine* engine, int prompt_tokens, int batch_size,
+                   int output_tokens) {
+  BenchCell cell;
+  cell.prompt_tokens = prompt_tokens;
+  cell.batch_size = batch_size;
+  cell.output_tokens = output_tokens;
+
+  SamplerConfig sampler_config;
+  sampler_config.temperature = 0.0f;  // Greedy for determinism
+  sampler_config.top_p = 1.0f;
+  sampler_config.top_k = 0;
+  Sampler sampler(sampler_config);
+
+  // One cache per concurrent sequence; destruction at cell scope exit
+  // releases the pager sequences
+  std::vector<InferenceCache> caches(batch_size);
+  std::vector<int> last_tokens(batch_size);
+
+  // Prefill all sequences, timed together (prefill is GPU-bound and
+  // batch-agnostic in the current engine, so sequential is the real cost)
+  auto prefill_start = high_resolution_clock::now();
+  for (int b = 0; b < batch_size; b++) {
+    auto prompt = synthetic_prompt(prompt_tokens, b);
+    auto logits = engine->forward_prefill(prompt, &caches[b]);
+    last_tokens[b] = sampler.sample(logits);
+  }
+  double prefill_s =
+      duration<double>(high_resolution_clock::now() - prefill_start).count();
+  cell.prefill_tok_s =
+      prefill_s > 0.0 ? (prompt_tokens * batch_size) / prefill_s : 0.0;
+
+  // Decode loop: one step generates one token per sequence
+  std::vector<double> step_latencies_ms;
+  step_latencies_ms.reserve(output_tokens);
+
+  auto pager = engine->pager();
+
+  for (int step = 1; step < output_tokens; step++) {
+    auto step_start = high_resolution_clock::now();
+
+    if (batch_size > 1) {
+      std::vector<InferenceCache*> cache_ptrs;
+      cache_ptrs.reserve(batch_size);
+      for (auto& cache : caches) {
+        cache_ptrs.push_back(&cache);
+      }
+      auto logits = engine->forward_decode_batch(last_tokens, cache_ptrs);
+      for (int b = 0; b < batch_size; b++) {
+        last_tokens[b] = sampler.sample(logits[b]);
+      }
+    } else {
+      auto logits = engine->forward_decode(last_tokens[0], &caches[0]);
+      last_tokens[0] = sampler.sample(logits);
+    }
+
+    step_latencies_ms.push_back(
+        duration<double, std::milli>(high_resolution_clock::now() - step_start)
+            .count());
+
+    if (pager) {
+      auto arena_stats = pager->arena().get_stats();
+      cell.peak_arena_blocks =
+          std::max(cell.peak_arena_blocks, arena_stats.allocated_blocks);
+    }
+  }
+
+  double decode_s = 0.0;
+  for (double ms : step_latencies_ms) {
+    decode_s += ms / 1000.0;
+  }
+  int decoded_tokens = static_cast<int>(step_latencies_ms.size()) * batch_size;
+  cell.decode_tok_s = decode_s > 0.0 ? decoded_tokens / decode_s : 0.0;
+  cell.step_p50_ms = percentile(step_latencies_ms, 50.0);
+  cell.step_p95_ms = percentile(step_latencies_ms, 95.0);
+
+  if (auto prefix_cache = engine->prefix_cache()) {
+    auto stats = prefix_cache->get_stats();
+    cell.kv_hit_rate = stats.lookups > 0
+                           ? static_cast<double>(stats.hits) / stats.lookups
+                           : 0.0;
+  }
+
+  return cell;
+}
+
+// ============================================================================
+// JSON output and baseline comparison
+// ============================================================================
+
+std::string serialize_results(const std::vector<BenchCell>& cells) {
+  std::ostringstream oss;
+  oss << "{\"version\":1,\"cells\":[";
+  for (size_t i = 0; i < cells.size(); i++) {
+    const auto& c = cells[i];
+    if (i > 0) {
+      oss << ",";
+    }
+    oss << "{\"prompt_tokens\":" << c.prompt_tokens
+        << ",\"batch_size\":" << c.batch_size
+        << ",\"output_tokens\":" << c.output_tokens
+        << ",\"prefill_tok_s\":" << c.prefill_tok_s
+        << ",\"decode_tok_s\":" << c.decode_tok_s
+        << ",\"step_p50_ms\":" << c.step_p50_ms
+        << ",\"step_p95_ms\":" << c.step_p95_ms
+        << ",\"peak_arena_blocks\":" << c.peak_arena_blocks
+        << ",\"kv_hit_rate\":" << c.kv_hit_rate << "}";
+  }
+  oss << "]}";
+  return oss.str();
+}
+
+// Minimal parser for the benchmark's own output format (flat numeric
+// fields inside cell objects) — not a general JSON parser
+double extract_number(const std::string& obj, const std::string& key) {
+  size_t pos = obj.find("\"" + key + "\":");
+  if (pos == std::string::npos) {
+    return 0.0;
+  }
+  return std::atof(obj.c_str() + pos + key.size() + 3);
+}
+
+std::vector<BenchCell> parse_baseline(const std::string& json) {
+  std::vector<BenchCell> cells;
+  size_t pos = json.find("\"cells\":[");
+  if (pos == std::string::npos) {
+    return cells;
+  }
+  pos += 9;
+  while (true) {
+    size_t open = json.find('{', pos);
+    size_t close = json.find('}', open);
+    if (open == std::string::npos || close == std::string::npos) {
+      break;
+    }
+    std::string obj = json.substr(open, close - open + 1);
+
+    BenchCell cell;
+    cell.prompt_tokens = static_cast<int>(extract_number(obj, "prompt_tokens"));
+    cell.batch_size = static_cast<int>(extract_number(obj, "batch_size"));
+    cell.output_tokens = static_cast<int>(extract_number(obj, "output_tokens"));
+    cell.prefill_tok_s = extract_number(obj, "prefill_tok_s");
+    cell.decode_tok_s = extract_number(obj, "decode_tok_s");
+    cell.step_p50_ms = extract_number(obj, "step_p50_ms");
+    cell.step_p95_ms = extract_number(obj, "step_p95_ms");
+    cells.push_back(cell);
+
+    pos = close + 1;
+    if (json[pos] != ',') {
+      break;
+    }
+  }
+  return cells;
+}
+
+// Compare a run against the baseline; returns the number of cells that
+// regressed past the tolerance (throughput down or p95 up)
+int check_regressions(const std::vector<BenchCell>& results,
+                      const std::vector<BenchCell>& baseline,
+                      double tolerance_pct) {
+  double down = 1.0 - tolerance_pct / 100.0;
+  double up = 1.0 + tolerance_pct / 100.0;
+  int regressions = 0;
+
+  for (const auto& result : results) {
+    const BenchCell* base = nullptr;
+    for (const auto& candidate : baseline) {
+      if (candidate.prompt_tokens == result.prompt_tokens &&
+          candidate.batch_size == result.batch_size &&
+          candidate.output_tokens == result.output_tokens) {
+        base = &candidate;
+        break;
+      }
+    }
+    if (!base) {
+      std::cerr << "[mlxr_bench] No baseline for cell prompt="
+                << result.prompt_tokens << " batch=" << result.batch_size
+                << " output=" << result.output_tokens << " (skipped)"
+                << std::endl;
+      continue;
+    }
+
+    auto fail = [&](const char* metric, double got, double want) {
+      std::cerr << "[mlxr_bench] REGRESSION: " << metric << " prompt="
+                << result.prompt_tokens << " batch=" << result.batch_size
+                << " output=" << result.output_tokens << ": " << got
+                << " vs baseline " << want << " (tolerance " << tolerance_pct
+                << "%)" << std::endl;
+      regressions++;
+    };
+
+    if (base->prefill_tok_s > 0.0 &&
+        result.prefill_tok_s < base->prefill_tok_s * down) {
+      fail("prefill_tok_s", result.prefill_tok_s, base->prefill_tok_s);
+    }
+    if (base->decode_tok_s > 0.0 &&
+        result.decode_tok_s < base->decode_tok_s * down) {
+      fail("decode_tok_s", result.decode_tok_s, base->decode_tok_s);
+    }
+    if (base->step_p95_ms > 0.0 && result.step_p95_ms > base->step_p95_ms * up) {
+      fail("step_p95_ms", result.step_p95_ms, base->step_p95_ms);
+    }
+  }
+
+  return regressions;
+}
+
+// ============================================================================
+// CLI
+// ============================================================================
+
+std::vector<int> parse_int_list(const std::string& arg) {
+  std::vector<int> values;
+  std::istringstream iss(arg);
+  std::string item;
+  while (std::getline(iss, item, ',')) {
+    if (!item.empty()) {
+      values.push_back(std::atoi(item.c_str()));
+    }
+  }
+  return values;
+}
+
+void print_usage(const char* prog) {
+  std::cerr << "Usage: " << prog << " <model_dir> <tokenizer_path> [options]\n"
+            << "  --prompt-lengths N,N,...   (default 64,256)\n"
+            << "  --output-lengths N,N,...   (default 32)\n"
+            << "  --batch-sizes N,N,...      (default 1,4)\n"
+            << "  --output FILE              results JSON (default stdout)\n"
+            << "  --baseline FILE            gate against baseline JSON\n"
+            << "  --tolerance PCT            allowed regression (default 10)\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  std::string model_dir = argv[1];
+  std::string tokenizer_path = argv[2];
+
+  std::vector<int> prompt_lengths = {64, 256};
+  std::vector<int> output_lengths = {32};
+  std::vector<int> batch_sizes = {1, 4};
+  std::string output_path;
+  std::string baseline_path;
+  double tolerance_pct = 10.0;
+
+  for (int i = 3; i < argc; i++) {
+    std::string arg = argv[i];
+    auto next = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        print_usage(argv[0]);
+        std::exit(1);
+      }
+      return argv[++i];
+    };
+
+    if (arg == "--prompt-lengths") {
+      prompt_lengths = parse_int_list(next());
+    } else if (arg == "--output-lengths") {
+      output_lengths = parse_int_list(next());
+    } else if (arg == "--batch-sizes") {
+      batch_sizes = parse_int_list(next());
+    } else if (arg == "--output") {
+      output_path = next();
+    } else if (arg == "--baseline") {
+      baseline_path = next();
+    } else if (arg == "--tolerance") {
+      tolerance_pct = std::atof(next().c_str());
+    } else {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  // Load engine once; warmup at load keeps the first cell from paying
+  // cold-compilation cost and skewing the matrix
+  GenerationConfig config;
+  config.sampler_config.temperature = 0.0f;
+  config.echo_prompt = false;
+  config.verbose = false;
+
+  std::cerr << "[mlxr_bench] Loading model from " << model_dir << std::endl;
+  auto engine = load_engine(model_dir, tokenizer_path, config);
+  if (!engine) {
+    std::cerr << "[mlxr_bench] Failed to load engine" << std::endl;
+    return 1;
+  }
+
+  std::vector<BenchCell> results;
+  for (int prompt_len : prompt_lengths) {
+    for (int batch : batch_sizes) {
+      for (int out_len : output_lengths) {
+        std::cerr << "[mlxr_bench] prompt=" << prompt_len << " batch=" << batch
+                  << " output=" << out_len << std::endl;
+        results.push_back(run_cell(engine.get(), prompt_len, batch, out_len));
+        const auto& cell = results.back();
+        std::cerr << "  prefill " << cell.prefill_tok_s << " tok/s, decode "
+                  << cell.decode_tok_s << " tok/s, p50 " << cell.step_p50_ms
+                  << " ms, p95 " << cell.step_p95_ms << " ms" << std::endl;
+      }
+    }
+  }
+
+  std::string results_json = serialize_results(results);
+  if (output_path.empty()) {
+    std::cout << results_json << std::endl;
+  } else {
+    std::ofstream out(output_path);
+    if (!out) {
+      std::cerr << "[mlxr_bench] Cannot write " << output_path << std::endl;
+      return 1;
+    }
+    out << results_json << std::endl;
+    std::cerr << "[mlxr_bench] Results written to " << output_path << std::endl;
+  }
+
+  if (!baseline_path.empty()) {
+    std::ifstream in(baseline_path);
+    if (!in) {
+      std::cerr << "[mlxr_bench] Cannot read baseline " << baseline_path
+                << std::endl;
+      return 1;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    auto baseline = parse_baseline(buffer.str());
+    if (baseline.empty()) {
+      std::cerr << "[mlxr_bench] Baseline file has no cells" << std::endl;
+      return 1;
+    }
+
+    int regressions = check_regressions(results, baseline, tolerance_pct);
+    if (regressions > 0) {
+      std::cerr << "[mlxr_bench] " << regressions
+                << " metric(s) regressed past " << tolerance_pct << "%"
+                << std::endl;
+      return 1;
+    }
+    std::cerr << "[mlxr_bench] All cells within tolerance" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,360 @@
+/**
+ * @file mlxr_convert.cpp
+ * @brief Streaming GGUF → MLXR-native snapshot converter
+ *
+ * Converts a GGUF model into the .mlxr-snap format the daemon mmaps on
+ * reload, without ever materializing the full model in RAM: tensors are
+ * read one at a time from the source mmap, converted in bounded scratch
+ * buffers on a worker pool, and written sequentially through the
+ * streaming SnapshotWriter. Peak memory is O(largest tensor), so 30GB+
+ * models convert comfortably on 16GB machines.
+ *
+ * Conversion rules:
+ *   - F32 tensors are narrowed to F16 (MLX's native compute dtype)
+ *     unless --keep-fp32 is given
+ *   - F16 tensors pass through byte-for-byte
+ *   - Quantized tensors keep their packed GGUF block layout: the
+ *     runtime's q_gemm_dequant path consumes packed blocks directly, so
+ *     expanding them here would only waste disk and bandwidth
+ *
+ * Usage:
+ *   ./mlxr_convert <input.gguf> [output.mlxr-snap] [options]
+ *
+ * Options:
+ *   --threads N    Conversion worker threads (default: hardware/2)
+ *   --keep-fp32    Do not narrow F32 tensors to F16
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "registry/gguf_parser.h"
+#include "registry/snapshot.h"
+#include "runtime/mmap_loader.h"
+
+using namespace mlxr;
+using namespace mlxr::registry;
+
+namespace {
+
+// IEEE 754 float32 → float16 with round-to-nearest-even (portable bit
+// manipulation; the pool runs on whatever cores are free, so no NEON
+// dependency here)
+uint16_t float_to_half(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  const uint32_t sign = (bits >> 16) & 0x8000;
+  int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+  uint32_t mantissa = bits & 0x007fffff;
+
+  if (exponent >= 31) {
+    // Overflow → inf; NaN keeps a nonzero mantissa
+    uint32_t nan_bit = ((bits & 0x7f800000) == 0x7f800000 && mantissa) ? 1 : 0;
+    return static_cast<uint16_t>(sign | 0x7c00 | nan_bit);
+  }
+  if (exponent <= 0) {
+    if (exponent < -10) {
+      return static_cast<uint16_t>(sign);  // Underflow → signed zero
+    }
+    // Subnormal: shift in the implicit leading 1, then round
+    mantissa |= 0x00800000;
+    uint32_t shift = static_cast<uint32_t>(14 - exponent);
+    uint32_t half_mantissa = mantissa >> shift;
+    uint32_t round_bit = (mantissa >> (shift - 1)) & 1;
+    uint32_t sticky = (mantissa & ((1u << (shift - 1)) - 1)) != 0;
+    if (round_bit && (sticky || (half_mantissa & 1))) {
+      half_mantissa++;
+    }
+    return static_cast<uint16_t>(sign | half_mantissa);
+  }
+
+  uint32_t half_mantissa = mantissa >> 13;
+  uint32_t round_bit = (mantissa >> 12) & 1;
+  uint32_t sticky = (mantissa & 0x0fff) != 0;
+  if (round_bit && (sticky || (half_mantissa & 1))) {
+    half_mantissa++;
+    if (half_mantissa == 0x400) {  // Mantissa overflowed into the exponent
+      half_mantissa = 0;
+      exponent++;
+      if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7c00);
+      }
+    }
+  }
+  return static_cast<uint16_t>(
+      sign | (static_cast<uint32_t>(exponent) << 10) | half_mantissa);
+}
+
+// Per-tensor conversion plan derived from the GGUF index before any
+// payload bytes are touched
+struct TensorPlan {
+  const GGUFTensorInfo* source = nullptr;
+  SnapshotTensorInfo out;  // Post-conversion index entry (offset unset)
+  bool narrow_f32 = false;
+};
+
+// Bounded hand-off between the conversion pool and the sequential
+// writer: workers park converted buffers here in tensor order, blocking
+// when the in-flight byte budget is exhausted
+struct ConversionQueue {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::map<size_t, std::vector<uint8_t>> ready;  // tensor index → payload
+  size_t next_to_convert = 0;
+  uint64_t in_flight_bytes = 0;
+  uint64_t budget_bytes = 0;
+  bool failed = false;
+};
+
+void print_usage(const char* prog) {
+  std::cerr << "Usage: " << prog << " <input.gguf> [output.mlxr-snap]"
+            << " [--threads N] [--keep-fp32]" << std::endl;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  std::string input_path = argv[1];
+  std::string output_path;
+  int num_threads =
+      std::max(1u, std::thread::hardware_concurrency() / 2);
+  bool keep_fp32 = false;
+
+  for (int i = 2; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--threads" && i + 1 < argc) {
+      num_threads = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--keep-fp32") {
+      keep_fp32 = true;
+    } else if (arg[0] != '-' && output_path.empty()) {
+      output_path = arg;
+    } else {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+  if (output_path.empty()) {
+    output_path = input_path + ".mlxr-snap";
+  }
+
+  GGUFFile gguf;
+  if (!gguf.parse(input_path)) {
+    std::cerr << "Failed to parse " << input_path << ": " << gguf.error()
+              << std::endl;
+    return 1;
+  }
+  std::cout << "Parsed GGUF: " << gguf.tensors().size()
+            << " tensors, arch=" << gguf.get_arch() << std::endl;
+
+  MMapWeightLoader loader(input_path, true);
+  if (!loader.initialize()) {
+    std::cerr << "Failed to open " << input_path << std::endl;
+    return 1;
+  }
+
+  // Build the conversion plan; all post-conversion sizes are known
+  // before any payload bytes move, which is what lets the writer lay
+  // out the index up front
+  const uint64_t data_offset = gguf.data_offset();
+  std::vector<TensorPlan> plans;
+  plans.reserve(gguf.tensors().size());
+  uint64_t largest_tensor = 0;
+  uint64_t total_in = 0;
+  uint64_t total_out = 0;
+
+  for (const auto& tensor : gguf.tensors()) {
+    TensorPlan plan;
+    plan.source = &tensor;
+    plan.out.name = tensor.name;
+    plan.out.shape.reserve(tensor.dimensions.size());
+    for (auto dim : tensor.dimensions) {
+      plan.out.shape.push_back(static_cast<int64_t>(dim));
+    }
+
+    if (tensor.type == GGUFTensorType::F32 && !keep_fp32) {
+      plan.narrow_f32 = true;
+      plan.out.dtype = "float16";
+      plan.out.size = tensor.size / 2;
+    } else {
+      plan.out.dtype = gguf_type_to_mlx_dtype(tensor.type);
+      plan.out.size = tensor.size;
+      if (static_cast<uint32_t>(tensor.type) >=
+          static_cast<uint32_t>(GGUFTensorType::Q4_0)) {
+        plan.out.quant_type = gguf_type_name(tensor.type);
+        plan.out.quant_block_size =
+            static_cast<int>(gguf_block_size(tensor.type));
+      }
+    }
+
+    largest_tensor = std::max(largest_tensor, tensor.size);
+    total_in += tensor.size;
+    total_out += plan.out.size;
+    plans.push_back(std::move(plan));
+  }
+
+  std::error_code ec;
+  const auto source_size = std::filesystem::file_size(input_path, ec);
+  if (ec) {
+    std::cerr << "Cannot stat " << input_path << std::endl;
+    return 1;
+  }
+
+  std::vector<SnapshotTensorInfo> infos;
+  infos.reserve(plans.size());
+  for (const auto& plan : plans) {
+    infos.push_back(plan.out);
+  }
+
+  SnapshotWriter writer;
+  if (!writer.begin(output_path, infos, source_size)) {
+    std::cerr << "Failed to start snapshot: " << writer.error() << std::endl;
+    return 1;
+  }
+
+  // Budget: workers may hold at most two largest-tensor conversions in
+  // flight ahead of the writer (floor keeps small models parallel)
+  ConversionQueue queue;
+  queue.budget_bytes =
+      std::max<uint64_t>(2 * largest_tensor, 256ull * 1024 * 1024);
+
+  auto worker_fn = [&]() {
+    while (true) {
+      size_t idx;
+      {
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        // Skip ahead to the next tensor that needs conversion
+        while (queue.next_to_convert < plans.size() &&
+               !plans[queue.next_to_convert].narrow_f32) {
+          queue.next_to_convert++;
+        }
+        if (queue.failed || queue.next_to_convert >= plans.size()) {
+          return;
+        }
+        // Admit against the budget before claiming, so admission stays
+        // in tensor order: a later tensor can never hold budget the
+        // writer needs freed to reach an earlier one
+        idx = queue.next_to_convert;
+        if (queue.in_flight_bytes + plans[idx].out.size >
+                queue.budget_bytes &&
+            queue.in_flight_bytes != 0) {
+          queue.cv.wait(lock);
+          continue;  // Another worker may have claimed; re-evaluate
+        }
+        queue.next_to_convert++;
+        queue.in_flight_bytes += plans[idx].out.size;
+      }
+
+      const auto& tensor = *plans[idx].source;
+      auto region = loader.map_region(
+          static_cast<size_t>(data_offset + tensor.offset),
+          static_cast<size_t>(tensor.size), false);
+      if (!region.is_valid) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.failed = true;
+        queue.cv.notify_all();
+        return;
+      }
+
+      const uint64_t count = tensor.size / sizeof(float);
+      std::vector<uint8_t> out(static_cast<size_t>(plans[idx].out.size));
+      const float* src = region.as<const float>();
+      uint16_t* dst = reinterpret_cast<uint16_t*>(out.data());
+      for (uint64_t i = 0; i < count; i++) {
+        dst[i] = float_to_half(src[i]);
+      }
+      loader.unmap_region(region);
+
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.ready.emplace(idx, std::move(out));
+      queue.cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(static_cast<size_t>(num_threads));
+  for (int i = 0; i < num_threads; i++) {
+    workers.emplace_back(worker_fn);
+  }
+
+  // Sequential writer: pass-through tensors stream straight from the
+  // source mmap; converted tensors are taken from the pool in order
+  bool ok = true;
+  for (size_t i = 0; i < plans.size() && ok; i++) {
+    if (plans[i].narrow_f32) {
+      std::vector<uint8_t> payload;
+      {
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        queue.cv.wait(lock, [&]() {
+          return queue.failed || queue.ready.count(i) != 0;
+        });
+        if (queue.failed) {
+          ok = false;
+          break;
+        }
+        payload = std::move(queue.ready[i]);
+        queue.ready.erase(i);
+        queue.in_flight_bytes -= payload.size();
+        queue.cv.notify_all();
+      }
+      ok = writer.append(payload.data(), payload.size());
+    } else {
+      const auto& tensor = *plans[i].source;
+      auto region = loader.map_region(
+          static_cast<size_t>(data_offset + tensor.offset),
+          static_cast<size_t>(tensor.size), false);
+      if (!region.is_valid) {
+        ok = false;
+        break;
+      }
+      loader.advise(region, MMapWeightLoader::AdvicePattern::SEQUENTIAL);
+      ok = writer.append(region.data, tensor.size);
+      loader.unmap_region(region);
+    }
+
+    if ((i + 1) % 50 == 0 || i + 1 == plans.size()) {
+      std::cout << "  " << (i + 1) << "/" << plans.size() << " tensors"
+                << std::endl;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.failed = queue.failed || !ok;
+    queue.cv.notify_all();
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  if (!ok) {
+    std::cerr << "Conversion failed"
+              << (writer.error().empty() ? "" : ": " + writer.error())
+              << std::endl;
+    return 1;
+  }
+  if (!writer.finish()) {
+    std::cerr << "Failed to finalize snapshot: " << writer.error()
+              << std::endl;
+    return 1;
+  }
+
+  std::cout << "Wrote " << output_path << " (" << (total_out / 1024 / 1024)
+            << " MB from " << (total_in / 1024 / 1024) << " MB source)"
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,450 @@
+/**
+ * @file mlxr_loadgen.cpp
+ * @brief Concurrent load-generation client for daemon soak and
+ *        saturation testing
+ *
+ * Fires N concurrent OpenAI-style streaming chat completion requests at
+ * a running daemon over TCP or UDS, timestamps every SSE chunk as it
+ * arrives, and reports time-to-first-token and inter-token latency
+ * percentiles plus a histogram. Unlike rest_server_test.cpp (single
+ * request correctness), this finds the knee of the throughput/latency
+ * curve: sweep --concurrency upward until p95 inter-token latency blows
+ * past the target.
+ *
+ * Usage:
+ *   ./mlxr_loadgen [options]
+ *
+ * Options:
+ *   --host HOST            Daemon host (default 127.0.0.1)
+ *   --port PORT            Daemon port (default 11434)
+ *   --uds PATH             Connect over Unix domain socket instead
+ *   --model NAME           Model name in requests (default "default")
+ *   --concurrency N        Concurrent in-flight requests (default 4)
+ *   --requests N           Total requests to send (default 64)
+ *   --prompt-tokens N,N    Prompt sizes, picked per request (default 64)
+ *   --output-tokens N,N    max_tokens values, picked per request (default 32)
+ *   --arrival closed|poisson  closed-loop, or open-loop Poisson arrivals
+ *   --rate R               Poisson arrival rate in req/s (default 10)
+ *   --seed N               RNG seed for reproducible mixes (default 42)
+ *   --output FILE          Write summary JSON to FILE (default stdout)
+ *
+ * Soak testing: run with a large --requests count (or loop the binary)
+ * and watch the daemon's /metrics for KV arena growth and latency drift.
+ */
+
+// Include cpp-httplib FIRST before any other includes (fixes namespace
+// pollution issues from system headers)
+#include <httplib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+
+// ============================================================================
+// Per-request result capture
+// ============================================================================
+
+struct RequestResult {
+  bool success = false;
+  int status = 0;
+  double ttft_ms = 0.0;               // Send -> first content chunk
+  double total_ms = 0.0;              // Send -> stream end
+  std::vector<double> inter_token_ms; // Gaps between successive chunks
+  int chunks = 0;
+};
+
+struct LoadConfig {
+  std::string host = "127.0.0.1";
+  int port = 11434;
+  std::string uds_path;  // Non-empty: connect over AF_UNIX
+  std::string model = "default";
+  int concurrency = 4;
+  int total_requests = 64;
+  std::vector<int> prompt_tokens = {64};
+  std::vector<int> output_tokens = {32};
+  std::string arrival = "closed";  // "closed" or "poisson"
+  double rate = 10.0;              // req/s, poisson only
+  unsigned seed = 42;
+  std::string output_path;
+};
+
+// Synthetic prompt of roughly num_tokens tokens: short common words
+// tokenize near 1:1 on sentencepiece vocabularies
+std::string synthetic_prompt(int num_tokens, std::mt19937& rng) {
+  static const char* kWords[] = {"the", "quick", "brown", "fox", "jumps",
+                                 "over", "lazy", "dog",   "and", "runs"};
+  std::uniform_int_distribution<int> pick(0, 9);
+  std::string prompt;
+  prompt.reserve(num_tokens * 6);
+  for (int i = 0; i < num_tokens; i++) {
+    if (i > 0) {
+      prompt += ' ';
+    }
+    prompt += kWords[pick(rng)];
+  }
+  return prompt;
+}
+
+std::string build_request_body(const LoadConfig& config,
+                               const std::string& prompt, int max_tokens) {
+  std::ostringstream oss;
+  oss << "{\"model\":\"" << config.model << "\","
+      << "\"stream\":true,"
+      << "\"max_tokens\":" << max_tokens << ","
+      << "\"messages\":[{\"role\":\"user\",\"content\":\"" << prompt
+      << "\"}]}";
+  return oss.str();
+}
+
+// ============================================================================
+// SSE stream receiver: timestamps each complete "data:" event
+// ============================================================================
+
+class SSEReceiver {
+ public:
+  explicit SSEReceiver(steady_clock::time_point send_time)
+      : send_time_(send_time) {}
+
+  // ContentReceiver callback: SSE events may arrive split or coalesced
+  // across TCP reads, so accumulate and split on the blank-line delimiter
+  bool on_data(const char* data, size_t length) {
+    buffer_.append(data, length);
+    size_t pos;
+    while ((pos = buffer_.find("\n\n")) != std::string::npos) {
+      handle_event(buffer_.substr(0, pos));
+      buffer_.erase(0, pos + 2);
+    }
+    return true;
+  }
+
+  void finish(RequestResult* result) const {
+    result->chunks = static_cast<int>(chunk_times_.size());
+    if (!chunk_times_.empty()) {
+      result->ttft_ms =
+          duration<double, std::milli>(chunk_times_.front() - send_time_)
+              .count();
+      for (size_t i = 1; i < chunk_times_.size(); i++) {
+        result->inter_token_ms.push_back(
+            duration<double, std::milli>(chunk_times_[i] - chunk_times_[i - 1])
+                .count());
+      }
+    }
+  }
+
+ private:
+  void handle_event(const std::string& event) {
+    // Content chunks only: skip comments, [DONE], and role-only deltas
+    if (event.rfind("data: ", 0) != 0) {
+      return;
+    }
+    std::string payload = event.substr(6);
+    if (payload == "[DONE]") {
+      return;
+    }
+    if (payload.find("\"content\":") == std::string::npos) {
+      return;
+    }
+    chunk_times_.push_back(steady_clock::now());
+  }
+
+  steady_clock::time_point send_time_;
+  std::string buffer_;
+  std::vector<steady_clock::time_point> chunk_times_;
+};
+
+RequestResult run_request(httplib::Client& client, const LoadConfig& config,
+                          const std::string& body) {
+  RequestResult result;
+  auto send_time = steady_clock::now();
+  SSEReceiver receiver(send_time);
+
+  auto response = client.Post(
+      "/v1/chat/completions", body.size(),
+      [&](size_t, size_t, httplib::DataSink& sink) {
+        sink.write(body.data(), body.size());
+        sink.done();
+        return true;
+      },
+      "application/json",
+      [&](const char* data, size_t length) {
+        return receiver.on_data(data, length);
+      });
+
+  result.total_ms =
+      duration<double, std::milli>(steady_clock::now() - send_time).count();
+  if (response) {
+    result.status = response->status;
+    result.success = response->status == 200;
+  }
+  receiver.finish(&result);
+  return result;
+}
+
+// ============================================================================
+// Aggregation
+// ============================================================================
+
+double percentile(std::vector<double> values, double p) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  double rank = p / 100.0 * (values.size() - 1);
+  size_t lo = static_cast<size_t>(rank);
+  size_t hi = std::min(lo + 1, values.size() - 1);
+  double frac = rank - lo;
+  return values[lo] * (1.0 - frac) + values[hi] * frac;
+}
+
+// Fixed log-spaced buckets for the inter-token histogram (ms)
+const double kHistogramBounds[] = {1,  2,   5,   10,  20,   50,
+                                   100, 200, 500, 1000, 2000};
+constexpr int kNumBuckets =
+    sizeof(kHistogramBounds) / sizeof(kHistogramBounds[0]) + 1;
+
+std::string serialize_summary(const std::vector<RequestResult>& results,
+                              double wall_s) {
+  int succeeded = 0;
+  int total_chunks = 0;
+  std::vector<double> ttfts;
+  std::vector<double> gaps;
+  int histogram[kNumBuckets] = {0};
+
+  for (const auto& result : results) {
+    if (result.success) {
+      succeeded++;
+    }
+    total_chunks += result.chunks;
+    if (result.chunks > 0) {
+      ttfts.push_back(result.ttft_ms);
+    }
+    for (double gap : result.inter_token_ms) {
+      gaps.push_back(gap);
+      int bucket = 0;
+      while (bucket < kNumBuckets - 1 && gap > kHistogramBounds[bucket]) {
+        bucket++;
+      }
+      histogram[bucket]++;
+    }
+  }
+
+  std::ostringstream oss;
+  oss << "{\"requests\":" << results.size() << ",\"succeeded\":" << succeeded
+      << ",\"wall_s\":" << wall_s
+      << ",\"req_per_s\":" << (wall_s > 0 ? results.size() / wall_s : 0.0)
+      << ",\"tok_per_s\":" << (wall_s > 0 ? total_chunks / wall_s : 0.0)
+      << ",\"ttft_ms\":{\"p50\":" << percentile(ttfts, 50)
+      << ",\"p95\":" << percentile(ttfts, 95)
+      << ",\"p99\":" << percentile(ttfts, 99) << "}"
+      << ",\"inter_token_ms\":{\"p50\":" << percentile(gaps, 50)
+      << ",\"p95\":" << percentile(gaps, 95)
+      << ",\"p99\":" << percentile(gaps, 99) << "}"
+      << ",\"inter_token_histogram\":[";
+  for (int i = 0; i < kNumBuckets; i++) {
+    if (i > 0) {
+      oss << ",";
+    }
+    double le = i < kNumBuckets - 1 ? kHistogramBounds[i] : -1;
+    oss << "{\"le_ms\":" << le << ",\"count\":" << histogram[i] << "}";
+  }
+  oss << "]}";
+  return oss.str();
+}
+
+// ============================================================================
+// CLI
+// ============================================================================
+
+std::vector<int> parse_int_list(const std::string& arg) {
+  std::vector<int> values;
+  std::istringstream iss(arg);
+  std::string item;
+  while (std::getline(iss, item, ',')) {
+    if (!item.empty()) {
+      values.push_back(std::atoi(item.c_str()));
+    }
+  }
+  return values;
+}
+
+void print_usage(const char* prog) {
+  std::cerr << "Usage: " << prog << " [options]\n"
+            << "  --host HOST / --port PORT   (default 127.0.0.1:11434)\n"
+            << "  --uds PATH                  Unix domain socket\n"
+            << "  --model NAME                (default \"default\")\n"
+            << "  --concurrency N             (default 4)\n"
+            << "  --requests N                (default 64)\n"
+            << "  --prompt-tokens N,N,...     (default 64)\n"
+            << "  --output-tokens N,N,...     (default 32)\n"
+            << "  --arrival closed|poisson    (default closed)\n"
+            << "  --rate R                    poisson req/s (default 10)\n"
+            << "  --seed N                    (default 42)\n"
+            << "  --output FILE               summary JSON (default stdout)\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  LoadConfig config;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    auto next = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        print_usage(argv[0]);
+        std::exit(1);
+      }
+      return argv[++i];
+    };
+
+    if (arg == "--host") {
+      config.host = next();
+    } else if (arg == "--port") {
+      config.port = std::atoi(next().c_str());
+    } else if (arg == "--uds") {
+      config.uds_path = next();
+    } else if (arg == "--model") {
+      config.model = next();
+    } else if (arg == "--concurrency") {
+      config.concurrency = std::atoi(next().c_str());
+    } else if (arg == "--requests") {
+      config.total_requests = std::atoi(next().c_str());
+    } else if (arg == "--prompt-tokens") {
+      config.prompt_tokens = parse_int_list(next());
+    } else if (arg == "--output-tokens") {
+      config.output_tokens = parse_int_list(next());
+    } else if (arg == "--arrival") {
+      config.arrival = next();
+    } else if (arg == "--rate") {
+      config.rate = std::atof(next().c_str());
+    } else if (arg == "--seed") {
+      config.seed = static_cast<unsigned>(std::atoi(next().c_str()));
+    } else if (arg == "--output") {
+      config.output_path = next();
+    } else {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (config.arrival != "closed" && config.arrival != "poisson") {
+    std::cerr << "--arrival must be 'closed' or 'poisson'" << std::endl;
+    return 1;
+  }
+
+  // Pre-generate the request mix so worker scheduling can't change which
+  // request gets which prompt size (reproducible across runs)
+  std::mt19937 rng(config.seed);
+  std::uniform_int_distribution<size_t> pick_prompt(
+      0, config.prompt_tokens.size() - 1);
+  std::uniform_int_distribution<size_t> pick_output(
+      0, config.output_tokens.size() - 1);
+  std::exponential_distribution<double> inter_arrival(config.rate);
+
+  std::vector<std::string> bodies;
+  std::vector<double> start_offsets_s;  // Open-loop arrival schedule
+  bodies.reserve(config.total_requests);
+  double offset = 0.0;
+  for (int i = 0; i < config.total_requests; i++) {
+    int prompt_len = config.prompt_tokens[pick_prompt(rng)];
+    int max_tokens = config.output_tokens[pick_output(rng)];
+    bodies.push_back(
+        build_request_body(config, synthetic_prompt(prompt_len, rng),
+                           max_tokens));
+    start_offsets_s.push_back(offset);
+    if (config.arrival == "poisson") {
+      offset += inter_arrival(rng);
+    }
+  }
+
+  std::cerr << "[mlxr_loadgen] " << config.total_requests << " requests, "
+            << config.concurrency << " workers, " << config.arrival
+            << " arrivals, target "
+            << (config.uds_path.empty()
+                    ? config.host + ":" + std::to_string(config.port)
+                    : config.uds_path)
+            << std::endl;
+
+  std::vector<RequestResult> results(config.total_requests);
+  std::atomic<int> next_request{0};
+  auto epoch = steady_clock::now();
+
+  std::vector<std::thread> workers;
+  for (int w = 0; w < config.concurrency; w++) {
+    workers.emplace_back([&]() {
+      // One connection per worker, reused across requests (matches how
+      // SDK clients behave)
+      std::unique_ptr<httplib::Client> client;
+      if (!config.uds_path.empty()) {
+        client = std::make_unique<httplib::Client>(config.uds_path);
+        client->set_address_family(AF_UNIX);
+      } else {
+        client = std::make_unique<httplib::Client>(config.host, config.port);
+      }
+      client->set_read_timeout(300, 0);
+      client->set_write_timeout(30, 0);
+
+      while (true) {
+        int index = next_request.fetch_add(1);
+        if (index >= config.total_requests) {
+          break;
+        }
+        if (config.arrival == "poisson") {
+          auto scheduled =
+              epoch + duration_cast<steady_clock::duration>(
+                          duration<double>(start_offsets_s[index]));
+          std::this_thread::sleep_until(scheduled);
+        }
+        results[index] = run_request(*client, config, bodies[index]);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  double wall_s = duration<double>(steady_clock::now() - epoch).count();
+  std::string summary = serialize_summary(results, wall_s);
+
+  if (config.output_path.empty()) {
+    std::cout << summary << std::endl;
+  } else {
+    std::ofstream out(config.output_path);
+    if (!out) {
+      std::cerr << "[mlxr_loadgen] Cannot write " << config.output_path
+                << std::endl;
+      return 1;
+    }
+    out << summary << std::endl;
+    std::cerr << "[mlxr_loadgen] Summary written to " << config.output_path
+              << std::endl;
+  }
+
+  int failed = 0;
+  for (const auto& result : results) {
+    if (!result.success) {
+      failed++;
+    }
+  }
+  if (failed > 0) {
+    std::cerr << "[mlxr_loadgen] " << failed << " request(s) failed"
+              << std::endl;
+    return 1;
+  }
+  return 0;
+}